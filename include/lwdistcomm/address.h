@@ -23,7 +23,7 @@ lwdistcomm_address_t *lwdistcomm_address_create(lwdistcomm_addr_type_t type);
 /* Parse address from string */
 bool lwdistcomm_address_parse(lwdistcomm_address_t *addr, const char *addr_str);
 
-/* Set Unix domain socket path */
+/* Set Unix domain socket path (Unix and shared memory addresses) */
 bool lwdistcomm_address_set_unix_path(lwdistcomm_address_t *addr, const char *path);
 
 /* Set IPv4 address and port */
@@ -19,6 +19,28 @@
 extern "C" {
 #endif
 
+/* Max reactors of a server */
+#define LWDISTCOMM_SERVER_MAX_REACTORS  16
+
+/* Slow subscriber policy, applied once a client's output queue is above the high watermark */
+typedef enum {
+    LWDISTCOMM_SERVER_POLICY_DROP,        // Drop the new message
+    LWDISTCOMM_SERVER_POLICY_CONFLATE,    // Replace the queued message with the same URL
+    LWDISTCOMM_SERVER_POLICY_DISCONNECT   // Disconnect the client
+} lwdistcomm_server_policy_t;
+
+/* Per-client output statistics */
+typedef struct {
+    uint32_t queued_msgs;       // Messages waiting in output queue
+    size_t queued_bytes;        // Bytes waiting in output queue
+    uint64_t sent_msgs;         // Messages fully written to socket
+    uint64_t sent_bytes;        // Bytes written to socket
+    uint64_t dropped_msgs;      // Messages dropped by DROP policy
+    uint64_t conflated_msgs;    // Messages replaced by CONFLATE policy
+    uint32_t congestions;       // Times the high watermark was reached
+    bool congested;             // Currently above high watermark (until below low watermark)
+} lwdistcomm_server_cli_stats_t;
+
 /* Create server instance */
 lwdistcomm_server_t *lwdistcomm_server_create(const lwdistcomm_server_options_t *options);
 
@@ -31,9 +53,35 @@ bool lwdistcomm_server_stop(lwdistcomm_server_t *server);
 /* Check if server is running */
 bool lwdistcomm_server_is_running(const lwdistcomm_server_t *server);
 
+/* Set number of reactors before the first start (default 1). Reactor 0 is driven by lwdistcomm_server_process_events,
+   the others run in internal threads with their own listener (SO_REUSEPORT for IP addresses), clients and buffers.
+   With more than one reactor, handlers and callbacks are called concurrently and must be thread-safe */
+bool lwdistcomm_server_set_reactors(lwdistcomm_server_t *server, int count);
+
 /* Publish message to subscribers */
 bool lwdistcomm_server_publish(lwdistcomm_server_t *server, const char *url, const lwdistcomm_message_t *msg);
 
+/* Publish payload buffer to subscribers, slow subscribers keep a reference instead of a copy */
+bool lwdistcomm_server_publish_pbuf(lwdistcomm_server_t *server, const char *url, lwdistcomm_pbuf_t *pbuf);
+
+/* Set client output queue watermarks in bytes (low <= high) */
+bool lwdistcomm_server_set_watermarks(lwdistcomm_server_t *server, size_t high, size_t low);
+
+/* Set max message size accepted from clients in bytes (0 for protocol maximum), larger frames close the connection */
+bool lwdistcomm_server_set_max_msg_size(lwdistcomm_server_t *server, size_t size);
+
+/* Enable shared memory publish to clients connected over Unix domain sockets (default on), ring_size 0 keeps the default */
+bool lwdistcomm_server_set_shm(lwdistcomm_server_t *server, bool enable, size_t ring_size);
+
+/* LZ4 compress payloads of at least threshold bytes (0 for default) sent to clients that support it (default off) */
+bool lwdistcomm_server_set_compression(lwdistcomm_server_t *server, bool enable, size_t threshold);
+
+/* Set slow subscriber policy for URL (exact, prefix ending with '/', or "/" for default) */
+bool lwdistcomm_server_set_topic_policy(lwdistcomm_server_t *server, const char *url, lwdistcomm_server_policy_t policy);
+
+/* Get output statistics of a client */
+bool lwdistcomm_server_get_client_stats(lwdistcomm_server_t *server, uint32_t client_id, lwdistcomm_server_cli_stats_t *stats);
+
 /* Add RPC handler */
 bool lwdistcomm_server_add_handler(lwdistcomm_server_t *server, const char *url, lwdistcomm_server_handler_cb_t callback, void *arg);
 
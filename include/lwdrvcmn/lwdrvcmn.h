@@ -64,6 +64,22 @@ typedef struct _LWTAG
     void *res_pdata2;
 } LWTAG;
 
+// transfer_type of LWTAG
+#define TAG_TRANSFER_NONE       0
+#define TAG_TRANSFER_LINEAR     1 // eng = eng_min + (raw - raw_min) * (eng_max - eng_min) / (raw_max - raw_min)
+#define TAG_TRANSFER_ADVANCED   2 // computed by the advanced_algo_lib plugin
+
+// advanced_algo_lib 插件导出的批量变换接口（C ABI）
+// lwalgo_create: 按点位的 advanced_param1..4 创建变换上下文，失败返回 NULL
+// lwalgo_transform: 一次变换 count 个点位，ctxs[i] 为第 i 个点位的上下文，成功返回 0
+// lwalgo_destroy: 释放上下文（可选）
+#define LWALGO_CREATE_SYMBOL    "lwalgo_create"
+#define LWALGO_TRANSFORM_SYMBOL "lwalgo_transform"
+#define LWALGO_DESTROY_SYMBOL   "lwalgo_destroy"
+typedef void *(*PFN_AlgoCreate)(const char *param1, const char *param2, const char *param3, const char *param4);
+typedef int (*PFN_AlgoTransform)(void *const *ctxs, const double *raw, double *eng, int count);
+typedef void (*PFN_AlgoDestroy)(void *ctx);
+
 struct _LWDRIVER;
 typedef struct _LWDEVICE
 {
@@ -127,6 +143,26 @@ typedef struct _LWTIMER {
     int int_user_data[DRV_USERDATA_MAXNUM];
 } DRVTIMER;
 
+// 点位地址解析结果，用于把相邻地址合并成块读
+typedef struct _DRVADDR {
+    int area; // address area, e.g. modbus function code, different areas are never merged
+    int offset; // start address in the area, unit is defined by the driver (e.g. register)
+    int length; // number of address units occupied by the tag
+} DRVADDR;
+
+// 驱动提供的地址解析函数，成功返回 0
+typedef int (*PFN_DrvParseAddress)(LWTAG *tag, DRVADDR *addr);
+
+// 块读请求，以及应答切片到点位的映射
+typedef struct _DRVREADBLOCK {
+    int area;
+    int offset; // block start address
+    int length; // block length in address units
+    int tag_count;
+    LWTAG **pptags; // tags covered by the block
+    int *tag_offsets; // offset of each tag from the block start, in address units
+} DRVREADBLOCK;
+
 // 主动与设备进行连接。通常不需要显示调用，读写数据时驱动框架会自动和设备建立连接。发生错误时可以手工断开和重新连接
 LWDRIVER_EXPORTS int drv_connect(LWDEVICE *device, int timeout_ms);
 // 主动和设备断开连接。通常不需要显示调用，可以在发生错误时主动断开与设备的连接，以便重新握手时调用
@@ -162,3 +198,32 @@ LWDRIVER_EXPORTS int drv_tagval_str2binary(LWTAG *tag, const char *tag_string_va
 
 LWDRIVER_EXPORTS int drv_set_connect_timeout(LWDEVICE *device, int timeout_ms);
 LWDRIVER_EXPORTS int drv_set_connect_success(LWDEVICE *device, bool success);
+
+// 创建块读计划。max_block 为单块最大地址单位数，max_gap 为可以一起读掉的最大地址空洞
+LWDRIVER_EXPORTS void *drv_create_read_plan(PFN_DrvParseAddress parser, int max_block, int max_gap);
+// 向计划添加点位并重新规划，返回地址无法解析的点位个数
+LWDRIVER_EXPORTS int drv_read_plan_add_tags(void *plan, LWTAG **tags, int tag_count);
+// 获取块读请求列表，返回块个数
+LWDRIVER_EXPORTS int drv_read_plan_get_blocks(void *plan, DRVREADBLOCK **blocks);
+LWDRIVER_EXPORTS void drv_destroy_read_plan(void *plan);
+// 设置设备的块读规则，框架为每个轮询组生成块读计划，OnReadTags 中通过 drv_get_timer_blocks 获取
+LWDRIVER_EXPORTS int drv_set_read_rule(LWDEVICE *device, PFN_DrvParseAddress parser, int max_block, int max_gap);
+LWDRIVER_EXPORTS int drv_get_timer_blocks(DRVTIMER *timer, DRVREADBLOCK **blocks);
+
+// 设置轮询工作线程数及同时访问设备的最大个数。默认 1，所有设备的 OnReadTags 在同一线程中串行执行，与以前的行为相同；
+// 大于 1 或 0（自动：每个设备一个线程，最多 32 个，更多的设备按轮转共用线程）时不同设备并行轮询，
+// 同一设备始终在同一线程上串行读取。只有能处理并发的驱动才应在 InitDriver 中打开。
+// 打开并行轮询后的线程约定：
+//   不同设备的 OnReadTags 可能同时执行，同一设备的回调不会重入。
+//   驱动在设备之间共享的状态（全局变量、静态缓存、共用的连接或串口总线等）需要自行加锁。
+// 任何设置下：
+//   drv_create_timer 创建的定时器回调（OnTimer）在定时器线程中执行，OnControl 在主任务线程中执行，
+//   二者都可能与同一设备的 OnReadTags 同时执行。
+//   drv_settagdata_*、drv_update_tagsdata 等上送接口可以在任意线程中调用，同一点位不要在多个线程中同时写入。
+LWDRIVER_EXPORTS int drv_set_poll_concurrency(int worker_num, int max_inflight_devices);
+
+// 上送过滤：点位值与上次上送相同（或变化不超过死区）时不上送，完整性周期到后补发。
+// 设置完整性周期，默认 60000 毫秒，<= 0 表示只在变化时上送
+LWDRIVER_EXPORTS int drv_set_integrity_period(int period_ms);
+// 设置点位死区，单位与上送值相同（有线性缩放时为工程量），0 表示任何变化都上送
+LWDRIVER_EXPORTS int drv_set_tag_deadband(LWTAG *tag, double deadband);
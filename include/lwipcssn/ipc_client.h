@@ -51,6 +51,10 @@ typedef void (*ipc_client_res_func_t)(void *arg, ipc_client_t *client, bool succ
 /* Client on datagram callback same as on message */
 typedef void (*ipc_client_dat_func_t)(void *arg, ipc_client_t *client, ipc_url_t *url, ipc_payload_t *payload);
 
+/* Client batch drop callback: a pending datagram batch could not be sent,
+ * so datagrams for which `ipc_client_datagram` returned true were lost */
+typedef void (*ipc_client_drop_func_t)(void *arg, ipc_client_t *client);
+
 /* Create IPC client 
  * Warning: This function must be mutually exclusive with the ipc_client_close() call */
 ipc_client_t *ipc_client_create(ipc_client_msg_func_t onmsg, void *arg);
@@ -80,6 +84,14 @@ int ipc_client_fds(ipc_client_t *client, fd_set *rfds);
 /* IPC client input event */
 bool ipc_client_process_events(ipc_client_t *client, const fd_set *rfds);
 
+/* IPC client register its fds with a caller owned epoll instance (Linux), instead of the fd_set calls.
+ * Ready events are handed to ipc_event_dispatch(), a lost connection shows in `ipc_client_is_connect`
+ * and the socket is registered again by the next successful connect */
+bool ipc_client_epoll_add(ipc_client_t *client, int epfd);
+
+/* IPC client unregister from its epoll instance */
+void ipc_client_epoll_del(ipc_client_t *client);
+
 /* Subscribe URL */
 bool ipc_client_subscribe(ipc_client_t *client, const ipc_url_t *url,
                            ipc_client_res_func_t callback, void *arg, const struct timespec *timeout);
@@ -101,6 +113,21 @@ bool ipc_client_datagram(ipc_client_t *client, const ipc_url_t *url, const ipc_p
 /* VSOA client set on datagram callback */
 void ipc_client_set_on_datagram(ipc_client_t *client, ipc_client_dat_func_t callback, void *arg);
 
+/* Datagram batching (default disabled): datagrams to the same URL are merged into one frame,
+ * sent once `max_bytes` are pending, `delay_us` after the first one or on `ipc_client_flush`.
+ * `max_bytes` 0 disables and flushes. Servers without batch support get datagrams one by one */
+bool ipc_client_batch(ipc_client_t *client, size_t max_bytes, unsigned int delay_us);
+
+/* Flush batched datagrams */
+bool ipc_client_flush(ipc_client_t *client);
+
+/* Set batch drop callback, called outside the client lock from the calling or the batch thread */
+void ipc_client_set_on_batch_drop(ipc_client_t *client, ipc_client_drop_func_t callback, void *arg);
+
+/* Request a shared memory ring for datagrams on next connect (default disabled).
+ * Datagrams fall back to the socket when the server does not support it */
+bool ipc_client_set_shm(ipc_client_t *client, bool enable);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,9 @@
 /* VSOA stream keepalive timeout seconds */
 #define VSOA_SERVER_KEEPALIVE_TIMEOUT  10
 
+/* VSOA server per client queued output limit (bytes), a client exceeding it is closed */
+#define VSOA_SERVER_OUTQ_LIMIT  (4 * 1024 * 1024)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -126,12 +129,35 @@ bool ipc_server_cli_datagram(ipc_server_t *server, ipc_cli_id_t id, const ipc_ur
 /* VSOA server set on datagram callback */
 void ipc_server_on_datagram(ipc_server_t *server, ipc_server_dat_func_t callback, void *arg);
 
+/* VSOA server next record of a batched datagram, only valid in the datagram callback.
+ * The callback gets the first record, records it does not take are delivered by further calls */
+bool ipc_server_dat_next(ipc_server_t *server, ipc_payload_t *payload);
+
+/* VSOA server shared memory datagram ring for clients that request it (default enabled).
+ * `ring_size` 0 means default, applies to new connections */
+bool ipc_server_set_shm(ipc_server_t *server, bool enable, size_t ring_size);
+
 /* VSOA server checking event */
 int ipc_server_fds(ipc_server_t *server, fd_set *rfds);
 
 /* VSOA server input event */
 void ipc_server_input_fds(ipc_server_t *server, const fd_set *rfds);
 
+/* VSOA server checking writable event, only clients with queued output are added.
+ * Returns -1 when nothing is queued. Without it queued output is flushed every timer period */
+int ipc_server_wfds(ipc_server_t *server, fd_set *wfds);
+
+/* VSOA server output event */
+void ipc_server_output_fds(ipc_server_t *server, const fd_set *wfds);
+
+/* VSOA server register its fds with a caller owned epoll instance (Linux), instead of the fd_set calls.
+ * Ready events are handed to ipc_event_dispatch() from the thread that waits on `epfd`,
+ * clients are added and removed as they come and go and writable interest follows queued output */
+bool ipc_server_epoll_add(ipc_server_t *server, int epfd);
+
+/* VSOA server unregister from its epoll instance, not from an event callback */
+void ipc_server_epoll_del(ipc_server_t *server);
+
 #ifdef __cplusplus
 }
 #endif
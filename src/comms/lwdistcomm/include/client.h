@@ -19,6 +19,9 @@
 extern "C" {
 #endif
 
+/* Max requests in one batched RPC call */
+#define LWDISTCOMM_CLIENT_RPC_BATCH_MAX  64
+
 /* Create client instance */
 lwdistcomm_client_t *lwdistcomm_client_create(const lwdistcomm_client_options_t *options);
 
@@ -34,6 +37,9 @@ bool lwdistcomm_client_is_connected(const lwdistcomm_client_t *client);
 /* Send RPC request */
 bool lwdistcomm_client_rpc(lwdistcomm_client_t *client, const char *url, const lwdistcomm_message_t *msg, lwdistcomm_client_rpc_cb_t callback, void *arg);
 
+/* Send RPC requests in one write, each reply resolves its own callback, false if none was sent */
+bool lwdistcomm_client_rpc_batch(lwdistcomm_client_t *client, const lwdistcomm_client_rpc_req_t *reqs, int count);
+
 /* Subscribe to topic */
 bool lwdistcomm_client_subscribe(lwdistcomm_client_t *client, const char *url, lwdistcomm_client_message_cb_t callback, void *arg);
 
@@ -52,9 +58,21 @@ bool lwdistcomm_client_process_events(lwdistcomm_client_t *client);
 /* Get file descriptors for event polling */
 int lwdistcomm_client_get_fds(lwdistcomm_client_t *client, fd_set *rfds);
 
-/* Process input events */
+/* Process input events, also expires requests that timed out */
 bool lwdistcomm_client_process_input(lwdistcomm_client_t *client, const fd_set *rfds);
 
+/* Set max message size accepted from server in bytes (0 for protocol maximum), larger frames drop the connection */
+bool lwdistcomm_client_set_max_msg_size(lwdistcomm_client_t *client, size_t size);
+
+/* LZ4 compress payloads of at least threshold bytes (0 for default) sent to servers that support it (default off) */
+bool lwdistcomm_client_set_compression(lwdistcomm_client_t *client, bool enable, size_t threshold);
+
+/* Enable shared memory publish transport for Unix domain socket connections (default on), applies on next connect */
+bool lwdistcomm_client_set_shm(lwdistcomm_client_t *client, bool enable);
+
+/* Get shared memory publish statistics, false if the connection does not use shared memory */
+bool lwdistcomm_client_get_shm_stats(lwdistcomm_client_t *client, uint64_t *msgs, uint64_t *overruns);
+
 /* Start discovery */
 bool lwdistcomm_client_start_discovery(lwdistcomm_client_t *client);
 
@@ -81,12 +81,27 @@ typedef struct {
 } lwdistcomm_dds_domain_participant_options_t;
 
 /**
- * Topic创建选项
+ * 键提取回调，从样本中提取键到key（最多key_size字节），返回键长度，0表示样本无有效键
+ */
+typedef uint32_t (*lwdistcomm_dds_key_extract_cb_t)(const void *data, uint32_t size, void *key, uint32_t key_size, void *arg);
+
+/**
+ * 数值提取回调，用于内容过滤的数值范围，返回false表示样本无数值
+ */
+typedef bool (*lwdistcomm_dds_value_extract_cb_t)(const void *data, uint32_t size, double *value, void *arg);
+
+/**
+ * Topic创建选项，key_extract非NULL时为有键主题，DataReader按实例保存样本；
+ * 内容过滤的键前缀和数值范围分别由key_extract和value_extract求值
  */
 typedef struct {
     char *name;
     char *type_name;
     lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_key_extract_cb_t key_extract;
+    void *key_arg;
+    lwdistcomm_dds_value_extract_cb_t value_extract;
+    void *value_arg;
 } lwdistcomm_dds_topic_options_t;
 
 /**
@@ -128,6 +143,8 @@ typedef struct {
     lwdistcomm_dds_time_t reception_timestamp;
     uint32_t instance_handle;
     uint32_t publication_handle;
+    uint64_t sequence_number;   /* DataWriter分配的序列号 */
+    uint32_t lost_samples;      /* 该样本之前因序列号间隙丢失的样本数 */
 } lwdistcomm_dds_sample_info_t;
 
 /**
@@ -168,6 +185,9 @@ lwdistcomm_dds_data_writer_t *lwdistcomm_dds_data_writer_create(lwdistcomm_dds_p
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_delete(lwdistcomm_dds_data_writer_t *writer);
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_write(lwdistcomm_dds_data_writer_t *writer, const void *data, uint32_t size);
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_dispose(lwdistcomm_dds_data_writer_t *writer, const void *data, uint32_t size);
+/* 小样本打包进同一报文，max_delay为样本最长等待时间，NULL或0关闭打包 */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_set_batching(lwdistcomm_dds_data_writer_t *writer, const lwdistcomm_dds_duration_t *max_delay);
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_flush(lwdistcomm_dds_data_writer_t *writer);
 
 /**
  * DataReader相关API
@@ -176,7 +196,18 @@ lwdistcomm_dds_data_reader_t *lwdistcomm_dds_data_reader_create(lwdistcomm_dds_s
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_delete(lwdistcomm_dds_data_reader_t *reader);
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_read(lwdistcomm_dds_data_reader_t *reader, void *data, uint32_t *size, lwdistcomm_dds_sample_info_t *info);
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_take(lwdistcomm_dds_data_reader_t *reader, void *data, uint32_t *size, lwdistcomm_dds_sample_info_t *info);
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_take_loan(lwdistcomm_dds_data_reader_t *reader, const void **data, uint32_t *size, lwdistcomm_dds_sample_info_t *info);
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_return_loan(lwdistcomm_dds_data_reader_t *reader, const void *data);
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_set_data_available_callback(lwdistcomm_dds_data_reader_t *reader, lwdistcomm_dds_data_available_cb_t callback, void *arg);
+/* 有键主题：查找键对应的实例句柄，读取实例最新样本（非破坏性），
+ * 取走句柄大于previous的第一个有样本的实例的最早样本，previous为HANDLE_NIL时从第一个实例开始 */
+uint32_t lwdistcomm_dds_data_reader_lookup_instance(lwdistcomm_dds_data_reader_t *reader, const void *key, uint32_t key_len);
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_read_instance(lwdistcomm_dds_data_reader_t *reader, uint32_t handle, void *data, uint32_t *size, lwdistcomm_dds_sample_info_t *info);
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_take_next_instance(lwdistcomm_dds_data_reader_t *reader, uint32_t previous, void *data, uint32_t *size, lwdistcomm_dds_sample_info_t *info);
+/* 内容过滤，经发现协议传给DataWriter并在发送前求值，NULL清除过滤 */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_set_content_filter(lwdistcomm_dds_data_reader_t *reader, const lwdistcomm_dds_content_filter_t *filter);
+/* 分片样本重组占用的内存上限和未完成重组的超时，0或NULL使用默认值 */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_set_reassembly_limits(lwdistcomm_dds_data_reader_t *reader, uint32_t max_bytes, const lwdistcomm_dds_duration_t *timeout);
 
 /**
  * QoS相关API
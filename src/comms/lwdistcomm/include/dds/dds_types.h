@@ -201,6 +201,37 @@ typedef struct {
 #define LWDISTCOMM_DDS_DEFAULT_MAX_SAMPLES 1024
 #define LWDISTCOMM_DDS_DEFAULT_MAX_INSTANCES 1024
 #define LWDISTCOMM_DDS_DEFAULT_MAX_SAMPLES_PER_INSTANCE 1
+#define LWDISTCOMM_DDS_DEFAULT_REASSEMBLY_LIMIT (64 * 1024 * 1024)
+#define LWDISTCOMM_DDS_DEFAULT_REASSEMBLY_TIMEOUT_SEC 1
+
+/**
+ * 单个样本的最大长度，超过一个报文的样本分片发送
+ */
+#define LWDISTCOMM_DDS_MAX_SAMPLE_SIZE (64 * 1024 * 1024)
+
+/**
+ * 有键主题的键最大长度，空实例句柄
+ */
+#define LWDISTCOMM_DDS_MAX_KEY_SIZE 128
+#define LWDISTCOMM_DDS_HANDLE_NIL 0
+
+/**
+ * 内容过滤的键前缀数和前缀长度上限
+ */
+#define LWDISTCOMM_DDS_MAX_FILTER_PREFIXES 8
+#define LWDISTCOMM_DDS_MAX_FILTER_PREFIX_LEN 32
+
+/**
+ * 内容过滤条件，样本的键以任一前缀开始且数值在[min_value, max_value]内时通过，
+ * num_prefixes为0时不按键过滤，has_range为false时不按数值过滤
+ */
+typedef struct {
+    uint32_t num_prefixes;
+    char prefixes[LWDISTCOMM_DDS_MAX_FILTER_PREFIXES][LWDISTCOMM_DDS_MAX_FILTER_PREFIX_LEN];
+    bool has_range;
+    double min_value;
+    double max_value;
+} lwdistcomm_dds_content_filter_t;
 
 #ifdef __cplusplus
 }
@@ -14,7 +14,9 @@ typedef enum {
     LWDISTCOMM_DDS_SPDP_MESSAGE_PARTICIPANT_ANNOUNCE,
     LWDISTCOMM_DDS_SPDP_MESSAGE_PARTICIPANT_LEAVE,
     LWDISTCOMM_DDS_SPDP_MESSAGE_TOPIC_ANNOUNCE,
-    LWDISTCOMM_DDS_SPDP_MESSAGE_TOPIC_REMOVE
+    LWDISTCOMM_DDS_SPDP_MESSAGE_TOPIC_REMOVE,
+    LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_ANNOUNCE,
+    LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_REMOVE
 } lwdistcomm_dds_spdp_message_type_t;
 
 /**
@@ -63,6 +65,8 @@ typedef struct {
     uint8_t is_writer;           /* 是否为写入器 */
     char transport_address[128]; /* 传输地址 */
     uint16_t port;               /* 端口号 */
+    uint8_t multicast;           /* 是否接收主题组播 */
+    lwdistcomm_dds_content_filter_t filter; /* DataReader的内容过滤条件 */
 } lwdistcomm_dds_spdp_endpoint_info_t;
 
 /**
@@ -108,6 +112,18 @@ typedef void (*lwdistcomm_dds_spdp_topic_callback_t)(
     void *arg
 );
 
+/**
+ * SPDP端点回调，transport_address为已解析的远端单播地址，is_new为false表示端点已移除或租约过期
+ */
+typedef void (*lwdistcomm_dds_spdp_endpoint_callback_t)(
+    lwdistcomm_dds_domain_participant_t *participant,
+    uint32_t participant_id,
+    const lwdistcomm_dds_spdp_topic_info_t *topic,
+    const lwdistcomm_dds_spdp_endpoint_info_t *endpoint,
+    bool is_new,
+    void *arg
+);
+
 /**
  * 创建SPDP实例
  */
@@ -161,6 +177,24 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_send_topic_announce(
     const lwdistcomm_dds_topic_t *topic
 );
 
+/**
+ * 发送端点宣告消息，transport_address为空时接收方使用报文源地址
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_send_endpoint_announce(
+    lwdistcomm_dds_spdp_t *spdp,
+    const lwdistcomm_dds_topic_t *topic,
+    const lwdistcomm_dds_spdp_endpoint_info_t *endpoint
+);
+
+/**
+ * 发送端点移除消息
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_send_endpoint_remove(
+    lwdistcomm_dds_spdp_t *spdp,
+    const lwdistcomm_dds_topic_t *topic,
+    const lwdistcomm_dds_spdp_endpoint_info_t *endpoint
+);
+
 /**
  * 设置回调函数
  */
@@ -176,6 +210,22 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_set_topic_callback(
     void *arg
 );
 
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_set_endpoint_callback(
+    lwdistcomm_dds_spdp_t *spdp,
+    lwdistcomm_dds_spdp_endpoint_callback_t callback,
+    void *arg
+);
+
+/**
+ * 遍历指定主题下已发现的远端端点，对每个端点以is_new为true调用callback
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_foreach_endpoint(
+    lwdistcomm_dds_spdp_t *spdp,
+    const char *topic_name,
+    lwdistcomm_dds_spdp_endpoint_callback_t callback,
+    void *arg
+);
+
 /**
  * 获取已发现的参与者数量
  */
@@ -11,6 +11,7 @@
 #ifndef LWDISTCOMM_MESSAGE_H
 #define LWDISTCOMM_MESSAGE_H
 
+#include <sys/uio.h>
 #include "types.h"
 
 #ifdef __cplusplus
@@ -25,6 +26,7 @@ extern "C" {
 #define LWDISTCOMM_MSG_TYPE_PUBLISH      0x04
 #define LWDISTCOMM_MSG_TYPE_DATAGRAM     0x05
 #define LWDISTCOMM_MSG_TYPE_AUTH         0x06
+#define LWDISTCOMM_MSG_TYPE_SHMATTACH    0x07
 #define LWDISTCOMM_MSG_FLAG_REPLY        0xfc
 #define LWDISTCOMM_MSG_TYPE_NOOP         0xfe
 #define LWDISTCOMM_MSG_TYPE_PINGECHO     0xff
@@ -39,6 +41,18 @@ extern "C" {
 #define LWDISTCOMM_STATUS_NO_MEMORY      6
 #define LWDISTCOMM_STATUS_AUTH_FAILED    7
 
+/* Service info request payload: client capabilities (network order), empty from older clients.
+ * Service info reply payload: client id (host order), capabilities (network order) */
+#define LWDISTCOMM_SERVINFO_CAP_SHM      0x00000001
+#define LWDISTCOMM_SERVINFO_CAP_LZ4      0x00000002
+
+/* Status flag of a frame with an LZ4 payload: original length (network order) followed by an LZ4 block.
+ * Only sent to peers that announced LWDISTCOMM_SERVINFO_CAP_LZ4, receivers see the inflated frame */
+#define LWDISTCOMM_MSG_FLAG_LZ4          0x80
+
+/* Default payload size from which compression is tried */
+#define LWDISTCOMM_MSG_LZ4_THRESHOLD     1024
+
 /* Message header */
 typedef struct {
     uint8_t magic;          // Magic number
@@ -50,19 +64,36 @@ typedef struct {
     uint32_t data_len;      // Data length
 } lwdistcomm_msg_header_t;
 
-/* Message receive buffer */
+/* Message receive state, only a partial frame is buffered, storage comes from a shared pool */
 typedef struct {
-    uint32_t cur_len;
-    uint32_t total_len;
-    uint8_t buffer[131072];  // 128KB max packet size
+    uint32_t cur_len;   // Buffered bytes
+    uint32_t size;      // Buffer capacity, 0 when idle
+    uint32_t max_len;   // Max message size accepted
+    uint8_t *buffer;
 } lwdistcomm_msg_recv_t;
 
+/* Message scatter-gather vector: header, URL, payload */
+#define LWDISTCOMM_MSG_IOV_MAX  3
+
+/* Reference counted payload buffer, one buffer can be queued to many clients */
+typedef struct lwdistcomm_pbuf {
+    int ref;
+    size_t length;
+    void *payload;
+} lwdistcomm_pbuf_t;
+
 /* Initialize message header */
 lwdistcomm_msg_header_t *lwdistcomm_msg_init_header(void *buffer, uint8_t type, uint8_t status, uint16_t seqno);
 
 /* Initialize receive buffer */
 void lwdistcomm_msg_init_recv(lwdistcomm_msg_recv_t *recv);
 
+/* Set max message size accepted by receive buffer (0 for protocol maximum) */
+void lwdistcomm_msg_set_recv_max(lwdistcomm_msg_recv_t *recv, size_t max_len);
+
+/* Release receive buffer storage to pool */
+void lwdistcomm_msg_free_recv(lwdistcomm_msg_recv_t *recv);
+
 /* Validate message header */
 bool lwdistcomm_msg_validate_header(const lwdistcomm_msg_header_t *header, size_t *total_len);
 
@@ -72,13 +103,16 @@ bool lwdistcomm_msg_set_url(lwdistcomm_msg_header_t *header, const char *url);
 /* Set message payload */
 bool lwdistcomm_msg_set_payload(lwdistcomm_msg_header_t *header, const lwdistcomm_message_t *msg);
 
+/* Set message URL and payload as scatter-gather vector without copying, returns vector count or -1 */
+int lwdistcomm_msg_set_iov(lwdistcomm_msg_header_t *header, const char *url, const lwdistcomm_message_t *msg, struct iovec *iov, size_t *total_len);
+
 /* Get message URL */
 bool lwdistcomm_msg_get_url(const lwdistcomm_msg_header_t *header, char **url, size_t *url_len);
 
 /* Get message payload */
 bool lwdistcomm_msg_get_payload(const lwdistcomm_msg_header_t *header, lwdistcomm_message_t *msg);
 
-/* Process input data */
+/* Process input data, complete frames are dispatched in place and only a trailing partial frame is kept */
 typedef bool (*lwdistcomm_msg_input_cb_t)(void *arg, lwdistcomm_msg_header_t *header);
 bool lwdistcomm_msg_input(lwdistcomm_msg_recv_t *recv, void *buffer, size_t len, lwdistcomm_msg_input_cb_t callback, void *arg);
 
@@ -88,6 +122,21 @@ lwdistcomm_message_t *lwdistcomm_message_create(void *data, size_t data_len);
 /* Destroy message */
 void lwdistcomm_message_destroy(lwdistcomm_message_t *msg);
 
+/* Allocate payload buffer (reference count 1) */
+lwdistcomm_pbuf_t *lwdistcomm_pbuf_alloc(size_t length);
+
+/* Compress payload for a LWDISTCOMM_MSG_FLAG_LZ4 frame, NULL when it does not shrink by at least 1/8 */
+lwdistcomm_pbuf_t *lwdistcomm_msg_compress(const lwdistcomm_message_t *msg);
+
+/* Add payload buffer reference */
+lwdistcomm_pbuf_t *lwdistcomm_pbuf_ref(lwdistcomm_pbuf_t *pbuf);
+
+/* Drop payload buffer reference, freed when the last reference is gone */
+void lwdistcomm_pbuf_free(lwdistcomm_pbuf_t *pbuf);
+
+/* Payload buffer data */
+#define lwdistcomm_pbuf_payload(pbuf, type)  ((type *)(pbuf)->payload)
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,7 +25,8 @@ extern "C" {
 typedef enum {
     LWDISTCOMM_ADDR_TYPE_UNIX,    // Unix domain socket
     LWDISTCOMM_ADDR_TYPE_IPV4,     // IPv4 address
-    LWDISTCOMM_ADDR_TYPE_IPV6      // IPv6 address
+    LWDISTCOMM_ADDR_TYPE_IPV6,     // IPv6 address
+    LWDISTCOMM_ADDR_TYPE_SHM       // Unix domain socket, publish through shared memory
 } lwdistcomm_addr_type_t;
 
 /* Address structure */
@@ -80,6 +81,14 @@ typedef void (*lwdistcomm_client_rpc_cb_t)(void *arg, int status, const lwdistco
 typedef void (*lwdistcomm_client_subscribe_cb_t)(void *arg, bool success);
 typedef void (*lwdistcomm_client_datagram_cb_t)(void *arg, const char *url, const lwdistcomm_message_t *msg);
 
+/* Batched RPC request, callback may be NULL for requests without reply handling */
+typedef struct {
+    const char *url;
+    const lwdistcomm_message_t *msg;
+    lwdistcomm_client_rpc_cb_t callback;
+    void *arg;
+} lwdistcomm_client_rpc_req_t;
+
 /* Server callback types */
 typedef bool (*lwdistcomm_server_auth_cb_t)(void *arg, const char *username, const char *password);
 typedef void (*lwdistcomm_server_handler_cb_t)(void *arg, uint32_t client_id, const char *url, const lwdistcomm_message_t *msg, lwdistcomm_message_t *response);
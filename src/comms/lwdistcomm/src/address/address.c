@@ -27,6 +27,7 @@ lwdistcomm_address_t *lwdistcomm_address_create(lwdistcomm_addr_type_t type)
 
     switch (type) {
     case LWDISTCOMM_ADDR_TYPE_UNIX:
+    case LWDISTCOMM_ADDR_TYPE_SHM:
         addr->addr.unix_addr.sun_family = AF_UNIX;
         addr->addr_len = sizeof(struct sockaddr_un);
         break;
@@ -55,6 +56,7 @@ bool lwdistcomm_address_parse(lwdistcomm_address_t *addr, const char *addr_str)
 
     switch (addr->type) {
     case LWDISTCOMM_ADDR_TYPE_UNIX:
+    case LWDISTCOMM_ADDR_TYPE_SHM:
         return lwdistcomm_address_set_unix_path(addr, addr_str);
     
     case LWDISTCOMM_ADDR_TYPE_IPV4: {
@@ -83,7 +85,7 @@ bool lwdistcomm_address_parse(lwdistcomm_address_t *addr, const char *addr_str)
 /* Set Unix domain socket path */
 bool lwdistcomm_address_set_unix_path(lwdistcomm_address_t *addr, const char *path)
 {
-    if (!addr || !path || addr->type != LWDISTCOMM_ADDR_TYPE_UNIX) {
+    if (!addr || !path || (addr->type != LWDISTCOMM_ADDR_TYPE_UNIX && addr->type != LWDISTCOMM_ADDR_TYPE_SHM)) {
         return false;
     }
 
@@ -143,6 +145,7 @@ struct sockaddr *lwdistcomm_address_get_sockaddr(lwdistcomm_address_t *addr)
 
     switch (addr->type) {
     case LWDISTCOMM_ADDR_TYPE_UNIX:
+    case LWDISTCOMM_ADDR_TYPE_SHM:
         return (struct sockaddr *)&addr->addr.unix_addr;
     case LWDISTCOMM_ADDR_TYPE_IPV4:
         return (struct sockaddr *)&addr->addr.ipv4_addr;
@@ -17,6 +17,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <pthread.h>
+#include <time.h>
 #include "client_impl.h"
 
 /* Include transport functions declarations */
@@ -28,6 +29,8 @@ extern bool lwdistcomm_transport_bind(int sock, const lwdistcomm_address_t *addr
 extern bool lwdistcomm_transport_listen(int sock, int backlog);
 extern int lwdistcomm_transport_accept(int sock, struct sockaddr *addr, socklen_t *addr_len);
 extern ssize_t lwdistcomm_transport_send(int sock, const void *data, size_t len);
+extern bool lwdistcomm_transport_sendv_all(int sock, struct iovec *iov, int iovcnt);
+extern ssize_t lwdistcomm_transport_recv_fds(int sock, void *buffer, size_t len, int *fds, int nfds);
 extern ssize_t lwdistcomm_transport_recv(int sock, void *buffer, size_t len, int flags);
 extern ssize_t lwdistcomm_transport_sendto(int sock, const void *data, size_t len, const lwdistcomm_address_t *addr);
 extern ssize_t lwdistcomm_transport_recvfrom(int sock, void *buffer, size_t len, lwdistcomm_address_t *addr);
@@ -40,15 +43,13 @@ static const struct timeval lwdistcomm_client_def_send_timeout = {
     .tv_usec = (LWDISTCOMM_CLIENT_DEF_SEND_TIMEOUT % 1000) * 1000
 };
 
-/* Clients list lock, header, timer thread */
-static void *lwdistcomm_client_timer = NULL;
+/* Clients list lock, header */
 static lwdistcomm_client_t *lwdistcomm_client_list = NULL;
 static void *lwdistcomm_client_lock = NULL;
 
-/* Client fast pending buffer check */
-#define LWDISTCOMM_CLIENT_PENDING_IS_IN_POOL(client, pending) \
-        ((pending) >= client->pool && \
-        (pending) <= client->pool + LWDISTCOMM_CLIENT_FAST_PENDING_POOL - 1)
+/* Timeout wheel bucket of a pending slot */
+#define LWDISTCOMM_CLIENT_WHEEL_BUCKET(client, pendq) \
+        ((client)->wheel[(pendq)->expire & (LWDISTCOMM_CLIENT_WHEEL_SIZE - 1)])
 
 /* List operations */
 #define LIST_FOREACH(item, head) for (item = head; item; item = item->next)
@@ -59,99 +60,93 @@ static void *lwdistcomm_client_lock = NULL;
     head = (item_ptr); \
     (item_ptr)->prev = NULL; \
 } while (0)
-#define INSERT_TO_FIFO(item_ptr, head, tail) do { \
-    if (!head) { \
-        head = tail = (item_ptr); \
-        (item_ptr)->prev = (item_ptr)->next = NULL; \
-    } else { \
-        tail->next = (item_ptr); \
-        (item_ptr)->prev = tail; \
-        (item_ptr)->next = NULL; \
-        tail = (item_ptr); \
-    } \
-} while (0)
 #define DELETE_FROM_LIST(item_ptr, head) do { \
     if ((item_ptr)->prev) (item_ptr)->prev->next = (item_ptr)->next; \
     else head = (item_ptr)->next; \
     if ((item_ptr)->next) (item_ptr)->next->prev = (item_ptr)->prev; \
 } while (0)
-#define DELETE_FROM_FIFO(item_ptr, head, tail) do { \
-    if ((item_ptr)->prev) (item_ptr)->prev->next = (item_ptr)->next; \
-    else head = (item_ptr)->next; \
-    if ((item_ptr)->next) (item_ptr)->next->prev = (item_ptr)->prev; \
-    else tail = (item_ptr)->prev; \
-} while (0)
 
-/* Client timer thread handle */
-static void *lwdistcomm_client_timer_handle(void *arg)
+/* Current timer tick */
+static uint64_t lwdistcomm_client_tick_now(void)
 {
-    bool emit;
-    lwdistcomm_client_t *client;
-    lwdistcomm_client_pendq_t *pendq, *temp;
+    struct timespec ts;
 
-    (void)arg;
-
-    do {
-        // Sleep for timer period
-        usleep(LWDISTCOMM_CLIENT_TIMER_PERIOD * 1000);
-
-        // Lock client list
-        // TODO: Implement proper locking
-
-        if (!lwdistcomm_client_list) {
-            // No clients, exit loop
-            break;
-        }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000) / LWDISTCOMM_CLIENT_TIMER_PERIOD;
+}
 
-        LIST_FOREACH(client, lwdistcomm_client_list) {
-            emit = false;
+/* Pendq free, the slot must not be queued */
+static void lwdistcomm_client_pendq_free(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *pendq)
+{
+    pendq->busy = false;
+    pendq->next = client->free;
+    client->free = pendq;
+}
 
-            // Lock client
-            // TODO: Implement proper locking
+/* Pendq queue on timeout wheel, waiting for reply */
+static void lwdistcomm_client_pendq_queue(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *pendq)
+{
+    INSERT_TO_HEADER(pendq, LWDISTCOMM_CLIENT_WHEEL_BUCKET(client, pendq));
+    client->queued++;
+    if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC) {
+        client->rpc_pending++;
+    }
+}
 
-            LIST_FOREACH_SAFE(pendq, temp, client->head) {
-                if (pendq->alive > LWDISTCOMM_CLIENT_TIMER_PERIOD) {
-                    pendq->alive -= LWDISTCOMM_CLIENT_TIMER_PERIOD;
-                } else {
-                    pendq->alive = 0;
-                    emit = true;
-                    break;
-                }
-            }
+/* Pendq dequeue from timeout wheel */
+static void lwdistcomm_client_pendq_dequeue(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *pendq)
+{
+    DELETE_FROM_LIST(pendq, LWDISTCOMM_CLIENT_WHEEL_BUCKET(client, pendq));
+    client->queued--;
+    if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC) {
+        client->rpc_pending--;
+    }
+}
 
-            // Unlock client
-            // TODO: Implement proper locking
+/* Pendq callback with no response and free */
+static void lwdistcomm_client_pendq_abort(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *to_head)
+{
+    lwdistcomm_client_pendq_t *pendq, *temp;
 
-            if (emit) {
-                // Signal event
-                uint64_t val = 1;
-                write(client->evtfd[1], &val, sizeof(val));
-            }
+    LIST_FOREACH_SAFE(pendq, temp, to_head) {
+        if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC && pendq->callback.rpc) {
+            pendq->callback.rpc(pendq->arg, LWDISTCOMM_STATUS_NO_RESPONDING, NULL);
         }
-
-        // Unlock client list
-        // TODO: Implement proper locking
-
-    } while (true);
-
-    return NULL;
+        lwdistcomm_client_pendq_free(client, pendq);
+    }
 }
 
-/* Pendq free */
-static void lwdistcomm_client_pendq_free(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *pendq)
+/* Advance timeout wheel to current tick, only the buckets of elapsed ticks are visited */
+static void lwdistcomm_client_expire(lwdistcomm_client_t *client)
 {
-    if (LWDISTCOMM_CLIENT_PENDING_IS_IN_POOL(client, pendq)) {
-        // Lock client
-        // TODO: Implement proper locking
+    lwdistcomm_client_pendq_t *pendq, *temp, *to_head = NULL;
+    uint64_t now = lwdistcomm_client_tick_now();
+    uint64_t tick = client->tick;
 
-        INSERT_TO_HEADER(pendq, client->free);
+    if (now <= tick) {
+        return;
+    }
 
-        // Unlock client
-        // TODO: Implement proper locking
+    client->tick = now;
+    if (!client->queued) {
+        return;
+    }
 
-    } else {
-        free(pendq);
+    // One revolution visits every bucket
+    if (now - tick > LWDISTCOMM_CLIENT_WHEEL_SIZE) {
+        tick = now - LWDISTCOMM_CLIENT_WHEEL_SIZE;
     }
+
+    while (tick++ < now) {
+        LIST_FOREACH_SAFE(pendq, temp, client->wheel[tick & (LWDISTCOMM_CLIENT_WHEEL_SIZE - 1)]) {
+            if (pendq->expire <= now) {
+                lwdistcomm_client_pendq_dequeue(client, pendq);
+                INSERT_TO_HEADER(pendq, to_head);
+            }
+        }
+    }
+
+    lwdistcomm_client_pendq_abort(client, to_head);
 }
 
 /* Create client instance */
@@ -160,8 +155,7 @@ lwdistcomm_client_t *lwdistcomm_client_create(const lwdistcomm_client_options_t
     int i, err = 0;
     lwdistcomm_client_t *client;
 
-    client = (lwdistcomm_client_t *)malloc(sizeof(lwdistcomm_client_t) + 
-                                           (sizeof(lwdistcomm_client_pendq_t) * LWDISTCOMM_CLIENT_FAST_PENDING_POOL));
+    client = (lwdistcomm_client_t *)malloc(sizeof(lwdistcomm_client_t));
     if (!client) {
         return NULL;
     }
@@ -177,18 +171,19 @@ lwdistcomm_client_t *lwdistcomm_client_create(const lwdistcomm_client_options_t
         goto error;
     }
 
-    // Allocate send buffer
-    client->sendbuf = malloc(LWDISTCOMM_MSG_MAX_LEN * 2);
-    if (!client->sendbuf) {
+    // Allocate receive buffer, frames are sent straight from the caller's buffers
+    client->recvbuf = malloc(LWDISTCOMM_MSG_MAX_LEN + LWDISTCOMM_MSG_URL_MAX + 1);
+    if (!client->recvbuf) {
         err = 1;
         goto error;
     }
 
-    // Initialize fast pending pool
-    client->pool = (lwdistcomm_client_pendq_t *)(client + 1);
-    for (i = 0; i < LWDISTCOMM_CLIENT_FAST_PENDING_POOL; i++) {
-        INSERT_TO_HEADER(&client->pool[i], client->free);
+    // Initialize pending slots, the slot index is the low byte of its seqno
+    for (i = LWDISTCOMM_CLIENT_MAX_PENDING; i > 0; i--) {
+        client->pendq[i].seqno = (uint16_t)i;
+        lwdistcomm_client_pendq_free(client, &client->pendq[i]);
     }
+    client->tick = lwdistcomm_client_tick_now();
 
     // Initialize security if options provided
     if (options && options->security_options) {
@@ -198,9 +193,11 @@ lwdistcomm_client_t *lwdistcomm_client_create(const lwdistcomm_client_options_t
         }
     }
 
-    // Initialize receive buffer
-    client->recvbuf = (uint8_t *)client->sendbuf + LWDISTCOMM_MSG_MAX_LEN;
+    // Initialize receive buffer, URLs are copied out of the frame to be NUL terminated
+    client->urlbuf = (char *)client->recvbuf + LWDISTCOMM_MSG_MAX_LEN;
     lwdistcomm_msg_init_recv(&client->recv);
+    client->shm_enable = true;
+    client->lz4_threshold = LWDISTCOMM_MSG_LZ4_THRESHOLD;
     client->send_timeout = lwdistcomm_client_def_send_timeout;
     client->valid = true;
 
@@ -218,11 +215,6 @@ lwdistcomm_client_t *lwdistcomm_client_create(const lwdistcomm_client_options_t
     // TODO: Implement proper locking
     INSERT_TO_HEADER(client, lwdistcomm_client_list);
 
-    // Start timer thread if first client
-    if (lwdistcomm_client_list == client) {
-        // TODO: Start timer thread
-    }
-
     // Start discovery thread
     lwdistcomm_client_start_discovery(client);
 
@@ -230,7 +222,7 @@ lwdistcomm_client_t *lwdistcomm_client_create(const lwdistcomm_client_options_t
 
 error:
     if (err > 1) {
-        free(client->sendbuf);
+        free(client->recvbuf);
     }
     if (err > 0) {
         if (client->evtfd[0] >= 0) close(client->evtfd[0]);
@@ -248,6 +240,9 @@ bool lwdistcomm_client_connect(lwdistcomm_client_t *client, const lwdistcomm_add
     }
 
     client->connected = false;
+    lwdistcomm_msg_free_recv(&client->recv);
+    lwdistcomm_shm_reader_destroy(client->shm);
+    client->shm = NULL;
 
     if (client->sock >= 0) {
         lwdistcomm_transport_close(client->sock);
@@ -272,16 +267,11 @@ bool lwdistcomm_client_connect(lwdistcomm_client_t *client, const lwdistcomm_add
     // Set send timeout
     lwdistcomm_transport_set_timeout(client->sock, LWDISTCOMM_CLIENT_DEF_SEND_TIMEOUT);
 
-    // Send service info request
-    lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(client->sendbuf, LWDISTCOMM_MSG_TYPE_SERVINFO, 0, 0);
-    size_t len;
-    if (!lwdistcomm_msg_validate_header(header, &len)) {
-        lwdistcomm_transport_close(client->sock);
-        client->sock = -1;
-        return false;
-    }
-
-    if (!lwdistcomm_client_send(client, len)) {
+    // Send service info request with our capabilities, frames are not compressed until the server announces support
+    uint32_t caps = htonl(LWDISTCOMM_SERVINFO_CAP_LZ4);
+    lwdistcomm_message_t caps_msg = { &caps, sizeof(caps) };
+    client->caps = 0;
+    if (!lwdistcomm_client_sendmsg(client, LWDISTCOMM_MSG_TYPE_SERVINFO, 0, NULL, &caps_msg)) {
         lwdistcomm_transport_close(client->sock);
         client->sock = -1;
         return false;
@@ -299,7 +289,20 @@ bool lwdistcomm_client_connect(lwdistcomm_client_t *client, const lwdistcomm_add
     // Process response
     lwdistcomm_msg_recv_t recv;
     lwdistcomm_msg_init_recv(&recv);
-    lwdistcomm_msg_input(&recv, buf, num, NULL, NULL);
+    lwdistcomm_msg_input(&recv, buf, num, lwdistcomm_client_servinfo, &client->caps);
+    lwdistcomm_msg_free_recv(&recv);
+
+    // Same host peers take publish traffic from shared memory
+    bool local = (addr->type == LWDISTCOMM_ADDR_TYPE_UNIX || addr->type == LWDISTCOMM_ADDR_TYPE_SHM);
+    if (local && client->shm_enable && (client->caps & LWDISTCOMM_SERVINFO_CAP_SHM)) {
+        lwdistcomm_client_shm_attach(client);
+    }
+
+    if (addr->type == LWDISTCOMM_ADDR_TYPE_SHM && !client->shm) {
+        lwdistcomm_transport_close(client->sock);
+        client->sock = -1;
+        return false;
+    }
 
     client->connected = true;
     return true;
@@ -319,6 +322,9 @@ bool lwdistcomm_client_disconnect(lwdistcomm_client_t *client)
         client->sock = -1;
     }
 
+    lwdistcomm_msg_free_recv(&client->recv);
+    lwdistcomm_shm_reader_destroy(client->shm);
+    client->shm = NULL;
     lwdistcomm_client_timeout_all(client);
     return true;
 }
@@ -340,7 +346,7 @@ bool lwdistcomm_client_rpc(lwdistcomm_client_t *client, const char *url, const l
     uint16_t seqno;
 
     if (callback) {
-        pendq = lwdistcomm_client_prepare_pendq(client, false, arg, LWDISTCOMM_CLIENT_FTYPE_RPC, LWDISTCOMM_CLIENT_DEF_TIMEOUT);
+        pendq = lwdistcomm_client_prepare_pendq(client, arg, LWDISTCOMM_CLIENT_FTYPE_RPC, LWDISTCOMM_CLIENT_DEF_TIMEOUT);
         if (!pendq) {
             return false;
         }
@@ -350,46 +356,87 @@ bool lwdistcomm_client_rpc(lwdistcomm_client_t *client, const char *url, const l
         seqno = lwdistcomm_client_prepare_seqno(client);
     }
 
-    // Initialize message header
-    lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(client->sendbuf, LWDISTCOMM_MSG_TYPE_RPC, 0, seqno);
-
-    // Set URL
-    if (!lwdistcomm_msg_set_url(header, url)) {
+    // Send message
+    if (!lwdistcomm_client_sendmsg(client, LWDISTCOMM_MSG_TYPE_RPC, seqno, url, msg)) {
         if (pendq) {
             lwdistcomm_client_pendq_free(client, pendq);
         }
         return false;
     }
 
-    // Set payload
-    if (msg && !lwdistcomm_msg_set_payload(header, msg)) {
-        if (pendq) {
-            lwdistcomm_client_pendq_free(client, pendq);
-        }
+    // Add to pending queue
+    if (pendq) {
+        lwdistcomm_client_pendq_queue(client, pendq);
+    }
+
+    return true;
+}
+
+/* Send RPC requests in one write */
+bool lwdistcomm_client_rpc_batch(lwdistcomm_client_t *client, const lwdistcomm_client_rpc_req_t *reqs, int count)
+{
+    if (!client || !client->valid || !client->connected || !reqs || count <= 0 || count > LWDISTCOMM_CLIENT_RPC_BATCH_MAX) {
         return false;
     }
 
-    // Validate header
+    lwdistcomm_msg_header_t header[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    struct iovec iov[LWDISTCOMM_CLIENT_RPC_BATCH_MAX * LWDISTCOMM_MSG_IOV_MAX];
+    lwdistcomm_message_t lz4_msg[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    lwdistcomm_pbuf_t *pbuf[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    const lwdistcomm_message_t *msg;
+    uint8_t status;
+    lwdistcomm_client_pendq_t *pendq[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    int i, num, iovcnt = 0;
+    uint16_t seqno;
     size_t len;
-    if (!lwdistcomm_msg_validate_header(header, &len)) {
-        if (pendq) {
-            lwdistcomm_client_pendq_free(client, pendq);
+
+    // Claim all slots first, a failed batch sends nothing
+    for (i = 0; i < count; i++) {
+        pendq[i] = NULL;
+        pbuf[i] = NULL;
+        if (!reqs[i].url) {
+            break;
         }
-        return false;
+
+        if (reqs[i].callback) {
+            pendq[i] = lwdistcomm_client_prepare_pendq(client, reqs[i].arg, LWDISTCOMM_CLIENT_FTYPE_RPC, LWDISTCOMM_CLIENT_DEF_TIMEOUT);
+            if (!pendq[i]) {
+                break;
+            }
+            pendq[i]->callback.rpc = reqs[i].callback;
+            seqno = pendq[i]->seqno;
+        } else {
+            seqno = lwdistcomm_client_prepare_seqno(client);
+        }
+
+        status = 0;
+        msg = lwdistcomm_client_compress(client, reqs[i].msg, &lz4_msg[i], &pbuf[i], &status);
+        lwdistcomm_msg_init_header(&header[i], LWDISTCOMM_MSG_TYPE_RPC, status, seqno);
+        num = lwdistcomm_msg_set_iov(&header[i], reqs[i].url, msg, &iov[iovcnt], &len);
+        if (num < 0) {
+            i++;
+            break;
+        }
+        iovcnt += num;
     }
 
-    // Send message
-    if (!lwdistcomm_client_send(client, len)) {
-        if (pendq) {
-            lwdistcomm_client_pendq_free(client, pendq);
+    // Send all frames in one write
+    if (i < count || !lwdistcomm_transport_sendv_all(client->sock, iov, iovcnt)) {
+        while (i-- > 0) {
+            if (pendq[i]) {
+                lwdistcomm_client_pendq_free(client, pendq[i]);
+            }
+            lwdistcomm_pbuf_free(pbuf[i]);
         }
         return false;
     }
 
     // Add to pending queue
-    if (pendq) {
-        INSERT_TO_FIFO(pendq, client->head, client->tail);
-        client->rpc_pending++;
+    for (i = 0; i < count; i++) {
+        if (pendq[i]) {
+            lwdistcomm_client_pendq_queue(client, pendq[i]);
+        }
+        lwdistcomm_pbuf_free(pbuf[i]);
     }
 
     return true;
@@ -425,27 +472,8 @@ bool lwdistcomm_client_send_datagram(lwdistcomm_client_t *client, const char *ur
         return false;
     }
 
-    // Initialize message header
-    lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(client->sendbuf, LWDISTCOMM_MSG_TYPE_DATAGRAM, 0, 0);
-
-    // Set URL
-    if (!lwdistcomm_msg_set_url(header, url)) {
-        return false;
-    }
-
-    // Set payload
-    if (!lwdistcomm_msg_set_payload(header, msg)) {
-        return false;
-    }
-
-    // Validate header
-    size_t len;
-    if (!lwdistcomm_msg_validate_header(header, &len)) {
-        return false;
-    }
-
     // Send message
-    return lwdistcomm_client_send(client, len);
+    return lwdistcomm_client_sendmsg(client, LWDISTCOMM_MSG_TYPE_DATAGRAM, 0, url, msg);
 }
 
 /* Set datagram callback */
@@ -476,6 +504,8 @@ bool lwdistcomm_client_process_events(lwdistcomm_client_t *client)
         return lwdistcomm_client_process_input(client, &rfds);
     }
 
+    // Expire requests on timeout wheel
+    lwdistcomm_client_expire(client);
     return true;
 }
 
@@ -501,6 +531,13 @@ int lwdistcomm_client_get_fds(lwdistcomm_client_t *client, fd_set *rfds)
         max_fd = client->evtfd[0];
     }
 
+    if (client->shm) {
+        FD_SET(client->shm->evtfd, rfds);
+        if (max_fd < client->shm->evtfd) {
+            max_fd = client->shm->evtfd;
+        }
+    }
+
     return max_fd;
 }
 
@@ -515,48 +552,85 @@ bool lwdistcomm_client_process_input(lwdistcomm_client_t *client, const fd_set *
         if (FD_ISSET(client->sock, rfds)) {
             ssize_t num = lwdistcomm_transport_recv(client->sock, client->recvbuf, LWDISTCOMM_MSG_MAX_LEN, 0);
             if (num > 0) {
-                lwdistcomm_msg_input(&client->recv, client->recvbuf, num, lwdistcomm_client_input, client);
-            } else if (num == 0 || (num < 0 && errno != EWOULDBLOCK)) {
+                if (!lwdistcomm_msg_input(&client->recv, client->recvbuf, num, lwdistcomm_client_input, client)) {
+                    num = -1;
+                    errno = EPROTO;
+                }
+            }
+            if (num == 0 || (num < 0 && errno != EWOULDBLOCK)) {
                 client->connected = false;
+                lwdistcomm_msg_free_recv(&client->recv);
+                lwdistcomm_shm_reader_destroy(client->shm);
+                client->shm = NULL;
                 lwdistcomm_client_timeout_all(client);
                 return false;
             }
         }
+
+        if (client->shm && FD_ISSET(client->shm->evtfd, rfds)) {
+            lwdistcomm_client_shm_input(client);
+        }
     }
 
     if (FD_ISSET(client->evtfd[0], rfds)) {
         uint64_t val;
         read(client->evtfd[0], &val, sizeof(val));
+    }
 
-        lwdistcomm_client_pendq_t *pendq, *to_head = NULL, *to_tail = NULL;
+    // Expire requests on timeout wheel
+    lwdistcomm_client_expire(client);
 
-        // Lock client
-        // TODO: Implement proper locking
+    return true;
+}
 
-        LIST_FOREACH_SAFE(pendq, pendq, client->head) {
-            if (pendq->alive <= 0) {
-                if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC) {
-                    client->rpc_pending--;
-                }
-                DELETE_FROM_FIFO(pendq, client->head, client->tail);
-                INSERT_TO_FIFO(pendq, to_head, to_tail);
-            }
-        }
+/* Set max message size accepted from server */
+bool lwdistcomm_client_set_max_msg_size(lwdistcomm_client_t *client, size_t size)
+{
+    if (!client || !client->valid || size > LWDISTCOMM_MSG_MAX_LEN) {
+        return false;
+    }
 
-        // Unlock client
-        // TODO: Implement proper locking
+    lwdistcomm_msg_set_recv_max(&client->recv, size);
+    return true;
+}
 
-        if (to_head) {
-            LIST_FOREACH_SAFE(pendq, pendq, to_head) {
-                if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC && pendq->callback.rpc) {
-                    pendq->callback.rpc(pendq->arg, LWDISTCOMM_STATUS_NO_RESPONDING, NULL);
-                }
-                DELETE_FROM_FIFO(pendq, to_head, to_tail);
-                lwdistcomm_client_pendq_free(client, pendq);
-            }
-        }
+/* Enable shared memory publish transport */
+bool lwdistcomm_client_set_shm(lwdistcomm_client_t *client, bool enable)
+{
+    if (!client || !client->valid) {
+        return false;
+    }
+
+    // Takes effect on next connect
+    client->shm_enable = enable;
+    return true;
+}
+
+/* Set payload compression towards servers that support it */
+bool lwdistcomm_client_set_compression(lwdistcomm_client_t *client, bool enable, size_t threshold)
+{
+    if (!client || !client->valid) {
+        return false;
     }
 
+    client->lz4_enable = enable;
+    client->lz4_threshold = threshold ? threshold : LWDISTCOMM_MSG_LZ4_THRESHOLD;
+    return true;
+}
+
+/* Get shared memory publish statistics */
+bool lwdistcomm_client_get_shm_stats(lwdistcomm_client_t *client, uint64_t *msgs, uint64_t *overruns)
+{
+    if (!client || !client->valid || !client->shm) {
+        return false;
+    }
+
+    if (msgs) {
+        *msgs = client->shm->msgs;
+    }
+    if (overruns) {
+        *overruns = client->shm->overruns;
+    }
     return true;
 }
 
@@ -567,11 +641,11 @@ void lwdistcomm_client_destroy(lwdistcomm_client_t *client)
         return;
     }
 
-    client->valid = false;
-
-    // Stop discovery thread
+    // Stop discovery thread, it uses the client until joined
     lwdistcomm_client_stop_discovery(client);
 
+    client->valid = false;
+
     // Remove from client list
     // TODO: Implement proper locking
     DELETE_FROM_LIST(client, lwdistcomm_client_list);
@@ -583,17 +657,12 @@ void lwdistcomm_client_destroy(lwdistcomm_client_t *client)
 
     close(client->evtfd[0]);
     close(client->evtfd[1]);
-    free(client->sendbuf);
+    lwdistcomm_msg_free_recv(&client->recv);
+    lwdistcomm_shm_reader_destroy(client->shm);
+    free(client->recvbuf);
 
     // Cleanup pending queue
-    lwdistcomm_client_pendq_t *pendq, *temp;
-    LIST_FOREACH_SAFE(pendq, temp, client->head) {
-        if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC && pendq->callback.rpc) {
-            pendq->callback.rpc(pendq->arg, LWDISTCOMM_STATUS_NO_RESPONDING, NULL);
-        }
-        DELETE_FROM_FIFO(pendq, client->head, client->tail);
-        lwdistcomm_client_pendq_free(client, pendq);
-    }
+    lwdistcomm_client_timeout_all(client);
 
     // Destroy security context
     if (client->security) {
@@ -620,127 +689,114 @@ static uint16_t lwdistcomm_client_prepare_seqno(lwdistcomm_client_t *client)
     return seqno << LWDISTCOMM_CLIENT_MAX_POFFSET;
 }
 
-/* Prepare a pendq */
-static lwdistcomm_client_pendq_t *lwdistcomm_client_prepare_pendq(lwdistcomm_client_t *client, bool fast, void *arg, uint32_t ftype, int timeout)
+/* Prepare a pendq, a free slot is taken and its generation advanced so late replies to the previous user are dropped */
+static lwdistcomm_client_pendq_t *lwdistcomm_client_prepare_pendq(lwdistcomm_client_t *client, void *arg, uint32_t ftype, int timeout)
 {
-    uint16_t i, seqno;
-    lwdistcomm_client_pendq_t *pendq = NULL, *queued;
-
-    if (fast) {
-        // Lock client
-        // TODO: Implement proper locking
-
-        if (client->free) {
-            pendq = client->free;
-            DELETE_FROM_LIST(pendq, client->free);
-        }
-
-        // Unlock client
-        // TODO: Implement proper locking
-    }
-
-    if (!pendq) {
-        pendq = (lwdistcomm_client_pendq_t *)malloc(sizeof(lwdistcomm_client_pendq_t));
-        if (!pendq) {
-            return NULL;
-        }
-    }
+    lwdistcomm_client_pendq_t *pendq;
 
     // Lock client
     // TODO: Implement proper locking
 
-    for (i = 0; i < LWDISTCOMM_CLIENT_MAX_PENDING; i++) {
-        seqno = client->seqno;
-        client->seqno = (seqno + 1) & LWDISTCOMM_CLIENT_MAX_PENDING;
-
-        LIST_FOREACH(queued, client->head) {
-            if (queued->seqno == seqno) {
-                break;
-            }
-        }
-
-        if (!queued) {
-            pendq->seqno = seqno;
-            break;
-        }
+    pendq = client->free;
+    if (pendq) {
+        client->free = pendq->next;
     }
 
     // Unlock client
     // TODO: Implement proper locking
 
-    if (i >= LWDISTCOMM_CLIENT_MAX_PENDING) {
-        lwdistcomm_client_pendq_free(client, pendq);
+    if (!pendq) {
         return NULL;
     }
 
+    pendq->seqno += 1 << LWDISTCOMM_CLIENT_MAX_POFFSET;
+    pendq->busy = true;
     pendq->arg = arg;
     pendq->ftype = ftype;
-    pendq->alive = timeout;
+    if (timeout < LWDISTCOMM_CLIENT_TIMER_PERIOD) {
+        timeout = LWDISTCOMM_CLIENT_TIMER_PERIOD;
+    }
+    pendq->expire = lwdistcomm_client_tick_now() + (timeout + LWDISTCOMM_CLIENT_TIMER_PERIOD - 1) / LWDISTCOMM_CLIENT_TIMER_PERIOD;
 
     return pendq;
 }
 
-/* Client send */
-static bool lwdistcomm_client_send(lwdistcomm_client_t *client, size_t len)
+/* Find the pendq waiting for seqno */
+static lwdistcomm_client_pendq_t *lwdistcomm_client_find_pendq(lwdistcomm_client_t *client, uint16_t seqno)
 {
-    uint8_t *buffer = (uint8_t *)client->sendbuf;
-    ssize_t num, total = 0;
-
-    do {
-        num = lwdistcomm_transport_send(client->sock, &buffer[total], len - total);
-        if (num > 0) {
-            total += num;
-        } else {
-            return false;
-        }
-    } while (total < len);
+    lwdistcomm_client_pendq_t *pendq = &client->pendq[seqno & LWDISTCOMM_CLIENT_MAX_PENDING];
 
-    return true;
+    return (pendq->busy && pendq->seqno == seqno) ? pendq : NULL;
 }
 
-/* Client send message */
-static bool lwdistcomm_client_sendmsg(lwdistcomm_client_t *client, lwdistcomm_msg_header_t *header, const char *url, const lwdistcomm_message_t *msg)
+/* Client send message, header, URL and payload are written without copying */
+static bool lwdistcomm_client_sendmsg(lwdistcomm_client_t *client, uint8_t type, uint16_t seqno, const char *url, const lwdistcomm_message_t *msg)
 {
+    lwdistcomm_msg_header_t header;
+    struct iovec iov[LWDISTCOMM_MSG_IOV_MAX];
+    lwdistcomm_message_t lz4_msg;
+    lwdistcomm_pbuf_t *pbuf = NULL;
+    uint8_t status = 0;
     size_t len;
-    if (!lwdistcomm_msg_validate_header(header, &len)) {
-        return false;
+
+    msg = lwdistcomm_client_compress(client, msg, &lz4_msg, &pbuf, &status);
+    lwdistcomm_msg_init_header(&header, type, status, seqno);
+
+    int iovcnt = lwdistcomm_msg_set_iov(&header, url, msg, iov, &len);
+    bool ret = iovcnt > 0 && lwdistcomm_transport_sendv_all(client->sock, iov, iovcnt);
+
+    lwdistcomm_pbuf_free(pbuf);
+
+    return ret;
+}
+
+/* Payload to send, LZ4 compressed into pbuf when large enough and the server supports it */
+static const lwdistcomm_message_t *lwdistcomm_client_compress(lwdistcomm_client_t *client, const lwdistcomm_message_t *msg, lwdistcomm_message_t *lz4_msg, lwdistcomm_pbuf_t **pbuf, uint8_t *status)
+{
+    if (!client->lz4_enable || !(client->caps & LWDISTCOMM_SERVINFO_CAP_LZ4) ||
+        !msg || msg->data_len < client->lz4_threshold) {
+        return msg;
     }
 
-    return lwdistcomm_client_send(client, len);
+    *pbuf = lwdistcomm_msg_compress(msg);
+    if (!*pbuf) {
+        return msg;
+    }
+
+    lz4_msg->data = (*pbuf)->payload;
+    lz4_msg->data_len = (*pbuf)->length;
+    *status |= LWDISTCOMM_MSG_FLAG_LZ4;
+
+    return lz4_msg;
 }
 
 /* All RPC callback timeout */
 static void lwdistcomm_client_timeout_all(lwdistcomm_client_t *client)
 {
     lwdistcomm_client_pendq_t *pendq, *to_head = NULL, *temp;
+    int i;
 
     // Lock client
     // TODO: Implement proper locking
 
-    to_head = client->head;
-    client->head = client->tail = NULL;
-    client->rpc_pending = 0;
+    for (i = 0; i < LWDISTCOMM_CLIENT_WHEEL_SIZE && client->queued; i++) {
+        LIST_FOREACH_SAFE(pendq, temp, client->wheel[i]) {
+            lwdistcomm_client_pendq_dequeue(client, pendq);
+            INSERT_TO_HEADER(pendq, to_head);
+        }
+    }
 
     // Unlock client
     // TODO: Implement proper locking
 
-    if (to_head) {
-        LIST_FOREACH_SAFE(pendq, temp, to_head) {
-            if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC && pendq->callback.rpc) {
-                pendq->callback.rpc(pendq->arg, LWDISTCOMM_STATUS_NO_RESPONDING, NULL);
-            }
-            DELETE_FROM_LIST(pendq, to_head);
-            lwdistcomm_client_pendq_free(client, pendq);
-        }
-    }
+    lwdistcomm_client_pendq_abort(client, to_head);
 }
 
 /* Client input callback */
 static bool lwdistcomm_client_input(void *arg, lwdistcomm_msg_header_t *header)
 {
     lwdistcomm_client_t *client = (lwdistcomm_client_t *)arg;
-    lwdistcomm_client_pendq_t *pendq, *temp;
-    uint16_t seqno;
+    lwdistcomm_client_pendq_t *pendq;
     char *url;
     size_t url_len;
     lwdistcomm_message_t msg;
@@ -749,6 +805,13 @@ static bool lwdistcomm_client_input(void *arg, lwdistcomm_msg_header_t *header)
         lwdistcomm_msg_get_url(header, &url, &url_len);
         lwdistcomm_msg_get_payload(header, &msg);
 
+        // URL is followed by payload in the frame
+        if (url_len) {
+            memcpy(client->urlbuf, url, url_len);
+        }
+        client->urlbuf[url_len] = '\0';
+        url = client->urlbuf;
+
         if (header->type == LWDISTCOMM_MSG_TYPE_PUBLISH) {
             if (client->onmsg) {
                 client->onmsg(client->marg, url, &msg);
@@ -759,19 +822,12 @@ static bool lwdistcomm_client_input(void *arg, lwdistcomm_msg_header_t *header)
         return true;
     }
 
-    seqno = ntohs(header->seqno);
-
     // Lock client
     // TODO: Implement proper locking
 
-    LIST_FOREACH_SAFE(pendq, temp, client->head) {
-        if (pendq->seqno == seqno) {
-            if (pendq->ftype == LWDISTCOMM_CLIENT_FTYPE_RPC) {
-                client->rpc_pending--;
-            }
-            DELETE_FROM_FIFO(pendq, client->head, client->tail);
-            break;
-        }
+    pendq = lwdistcomm_client_find_pendq(client, ntohs(header->seqno));
+    if (pendq) {
+        lwdistcomm_client_pendq_dequeue(client, pendq);
     }
 
     // Unlock client
@@ -804,6 +860,93 @@ static bool lwdistcomm_client_input(void *arg, lwdistcomm_msg_header_t *header)
     return client->valid;
 }
 
+/* Service info reply input */
+static bool lwdistcomm_client_servinfo(void *arg, lwdistcomm_msg_header_t *header)
+{
+    lwdistcomm_message_t msg;
+    uint32_t caps;
+
+    if (header->type == LWDISTCOMM_MSG_TYPE_SERVINFO && lwdistcomm_msg_get_payload(header, &msg) &&
+        msg.data_len >= sizeof(uint32_t) * 2) {
+        memcpy(&caps, (uint8_t *)msg.data + sizeof(uint32_t), sizeof(caps));
+        *(uint32_t *)arg = ntohl(caps);
+    }
+
+    return true;
+}
+
+/* Attach to server shared memory ring, the socket keeps carrying RPC and control traffic */
+static bool lwdistcomm_client_shm_attach(lwdistcomm_client_t *client)
+{
+    struct {
+        uint32_t slot;
+        uint32_t reserved;
+        uint64_t pos;
+    } info;
+    uint8_t buf[128];
+    int fds[2];
+    size_t total_len;
+    lwdistcomm_message_t msg;
+
+    uint16_t seqno = lwdistcomm_client_prepare_seqno(client);
+    if (!lwdistcomm_client_sendmsg(client, LWDISTCOMM_MSG_TYPE_SHMATTACH, seqno, NULL, NULL)) {
+        return false;
+    }
+
+    ssize_t num = lwdistcomm_transport_recv_fds(client->sock, buf, sizeof(buf), fds, 2);
+    lwdistcomm_msg_header_t *header = (lwdistcomm_msg_header_t *)buf;
+
+    if (num < (ssize_t)LWDISTCOMM_MSG_HDR_LEN || !lwdistcomm_msg_validate_header(header, &total_len) ||
+        (size_t)num != total_len || header->type != LWDISTCOMM_MSG_TYPE_SHMATTACH || header->status != 0 ||
+        !lwdistcomm_msg_get_payload(header, &msg) || msg.data_len != sizeof(info) || fds[0] < 0 || fds[1] < 0) {
+        if (fds[0] >= 0) {
+            close(fds[0]);
+        }
+        if (fds[1] >= 0) {
+            close(fds[1]);
+        }
+        return false;
+    }
+
+    memcpy(&info, msg.data, sizeof(info));
+
+    lwdistcomm_shm_ring_t *ring = lwdistcomm_shm_ring_attach(fds[0]);
+    client->shm = lwdistcomm_shm_reader_create(ring, (int)info.slot, fds[1], info.pos);
+    if (!client->shm) {
+        lwdistcomm_shm_ring_destroy(ring);
+        close(fds[1]);
+        return false;
+    }
+
+    // Sleep until the first publish
+    lwdistcomm_shm_reader_sleep(client->shm);
+    return true;
+}
+
+/* Drain shared memory ring */
+static void lwdistcomm_client_shm_input(lwdistcomm_client_t *client)
+{
+    lwdistcomm_shm_reader_t *shm = client->shm;
+    lwdistcomm_msg_header_t *header = (lwdistcomm_msg_header_t *)client->recvbuf;
+    size_t total_len, len;
+    uint64_t val;
+
+    ssize_t ret = read(shm->evtfd, &val, sizeof(val));
+    (void)ret;
+
+    do {
+        while ((len = lwdistcomm_shm_reader_read(shm, client->recvbuf, LWDISTCOMM_MSG_MAX_LEN)) > 0) {
+            if (lwdistcomm_msg_validate_header(header, &total_len) && total_len == len) {
+                lwdistcomm_client_input(client, header);
+            }
+            if (client->shm != shm) {
+                // Disconnected from callback
+                return;
+            }
+        }
+    } while (!lwdistcomm_shm_reader_sleep(shm));
+}
+
 /* Client request */
 static bool lwdistcomm_client_request(lwdistcomm_client_t *client, uint8_t type, const char *url, const lwdistcomm_message_t *msg, lwdistcomm_client_subscribe_cb_t callback, void *arg, int timeout)
 {
@@ -811,7 +954,7 @@ static bool lwdistcomm_client_request(lwdistcomm_client_t *client, uint8_t type,
     uint16_t seqno;
 
     if (callback) {
-        pendq = lwdistcomm_client_prepare_pendq(client, type == LWDISTCOMM_MSG_TYPE_PINGECHO, arg, LWDISTCOMM_CLIENT_FTYPE_SUB, timeout);
+        pendq = lwdistcomm_client_prepare_pendq(client, arg, LWDISTCOMM_CLIENT_FTYPE_SUB, timeout);
         if (!pendq) {
             return false;
         }
@@ -821,36 +964,8 @@ static bool lwdistcomm_client_request(lwdistcomm_client_t *client, uint8_t type,
         seqno = lwdistcomm_client_prepare_seqno(client);
     }
 
-    // Initialize message header
-    lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(client->sendbuf, type, 0, seqno);
-
-    // Set URL
-    if (!lwdistcomm_msg_set_url(header, url)) {
-        if (pendq) {
-            lwdistcomm_client_pendq_free(client, pendq);
-        }
-        return false;
-    }
-
-    // Set payload
-    if (msg && !lwdistcomm_msg_set_payload(header, msg)) {
-        if (pendq) {
-            lwdistcomm_client_pendq_free(client, pendq);
-        }
-        return false;
-    }
-
-    // Validate header
-    size_t len;
-    if (!lwdistcomm_msg_validate_header(header, &len)) {
-        if (pendq) {
-            lwdistcomm_client_pendq_free(client, pendq);
-        }
-        return false;
-    }
-
     // Send message
-    if (!lwdistcomm_client_send(client, len)) {
+    if (!lwdistcomm_client_sendmsg(client, type, seqno, url, msg)) {
         if (pendq) {
             lwdistcomm_client_pendq_free(client, pendq);
         }
@@ -859,7 +974,7 @@ static bool lwdistcomm_client_request(lwdistcomm_client_t *client, uint8_t type,
 
     // Add to pending queue
     if (pendq) {
-        INSERT_TO_FIFO(pendq, client->head, client->tail);
+        lwdistcomm_client_pendq_queue(client, pendq);
     }
 
     return true;
@@ -967,7 +1082,6 @@ static void *lwdistcomm_client_discovery_thread_func(void *arg)
     }
     
     client->discovery_socket = sockfd;
-    client->discovery_thread_running = true;
     
     /* 主循环 */
     while (client->discovery_thread_running) {
@@ -1035,8 +1149,11 @@ bool lwdistcomm_client_start_discovery(lwdistcomm_client_t *client)
         return true;
     }
     
+    /* 在创建线程前置位，保证stop_discovery总能等待线程退出 */
+    client->discovery_thread_running = true;
     int ret = pthread_create(&client->discovery_thread, NULL, lwdistcomm_client_discovery_thread_func, client);
     if (ret != 0) {
+        client->discovery_thread_running = false;
         return false;
     }
     
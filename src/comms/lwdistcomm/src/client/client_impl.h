@@ -14,6 +14,7 @@
 #include "../../include/client.h"
 #include "../../include/security.h"
 #include "../../include/message.h"
+#include "../shm/shm_impl.h"
 
 /* Include necessary system headers */
 #include <unistd.h>
@@ -23,13 +24,15 @@
 #define LWDISTCOMM_MSG_MAX_LEN  131072
 #define LWDISTCOMM_MSG_HDR_LEN  sizeof(lwdistcomm_msg_header_t)
 #define LWDISTCOMM_MSG_MAX_DATA (LWDISTCOMM_MSG_MAX_LEN - LWDISTCOMM_MSG_HDR_LEN)
+#define LWDISTCOMM_MSG_URL_MAX  0xffff
 
-/* Client pending queue */
+/* Client pending slot, the low byte of seqno is the slot index and the high byte its generation */
 typedef struct lwdistcomm_client_pendq {
     struct lwdistcomm_client_pendq *next;
     struct lwdistcomm_client_pendq *prev;
-    int16_t alive;
+    uint64_t expire;
     uint16_t seqno;
+    bool busy;
     uint32_t ftype;
     union {
         lwdistcomm_client_message_cb_t msg;
@@ -40,23 +43,44 @@ typedef struct lwdistcomm_client_pendq {
     void *arg;
 } lwdistcomm_client_pendq_t;
 
+/* Client callback types */
+#define LWDISTCOMM_CLIENT_FTYPE_MSG  0
+#define LWDISTCOMM_CLIENT_FTYPE_RPC  1
+#define LWDISTCOMM_CLIENT_FTYPE_SUB  2
+#define LWDISTCOMM_CLIENT_FTYPE_DAT  3
+
+/* Client pending slots, slot 0 is reserved for non-queued seqnos */
+#define LWDISTCOMM_CLIENT_MAX_PENDING  0xff
+#define LWDISTCOMM_CLIENT_MAX_POFFSET  8
+
+/* Client timer period and timeout wheel size in periods */
+#define LWDISTCOMM_CLIENT_TIMER_PERIOD  10
+#define LWDISTCOMM_CLIENT_WHEEL_SIZE  256
+#define LWDISTCOMM_CLIENT_DEF_TIMEOUT  60000
+#define LWDISTCOMM_CLIENT_DEF_SEND_TIMEOUT  500
+
 /* Client structure */
 struct lwdistcomm_client {
     bool valid;
     bool connected;
     lwdistcomm_client_t *next;
     lwdistcomm_client_t *prev;
-    lwdistcomm_client_pendq_t *head;
-    lwdistcomm_client_pendq_t *tail;
     lwdistcomm_client_pendq_t *free;
-    lwdistcomm_client_pendq_t *pool;
-    void *sendbuf;
+    lwdistcomm_client_pendq_t *wheel[LWDISTCOMM_CLIENT_WHEEL_SIZE];
+    lwdistcomm_client_pendq_t pendq[LWDISTCOMM_CLIENT_MAX_PENDING + 1];
+    uint64_t tick;
+    uint32_t queued;
     void *recvbuf;
+    char *urlbuf;
     lwdistcomm_msg_recv_t recv;
+    bool shm_enable;
+    bool lz4_enable;
+    size_t lz4_threshold;
+    uint32_t caps;
+    lwdistcomm_shm_reader_t *shm;
     bool cid_valid;
     uint32_t rpc_pending;
     uint32_t cid;
-    uint16_t seqno;
     uint16_t seqno_nq;
     int sock;
     int evtfd[2];
@@ -80,29 +104,20 @@ struct lwdistcomm_client {
     } discovered_server;
 };
 
-/* Client callback types */
-#define LWDISTCOMM_CLIENT_FTYPE_MSG  0
-#define LWDISTCOMM_CLIENT_FTYPE_RPC  1
-#define LWDISTCOMM_CLIENT_FTYPE_SUB  2
-#define LWDISTCOMM_CLIENT_FTYPE_DAT  3
-
-/* Client fast pending buffer */
-#define LWDISTCOMM_CLIENT_FAST_PENDING_POOL  8
-#define LWDISTCOMM_CLIENT_MAX_PENDING  0xff
-#define LWDISTCOMM_CLIENT_MAX_POFFSET  8
-
-/* Client timer period */
-#define LWDISTCOMM_CLIENT_TIMER_PERIOD  10
-#define LWDISTCOMM_CLIENT_DEF_TIMEOUT  60000
-#define LWDISTCOMM_CLIENT_DEF_SEND_TIMEOUT  500
-
 /* Internal functions */
 static void lwdistcomm_client_pendq_free(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *pendq);
-static lwdistcomm_client_pendq_t *lwdistcomm_client_prepare_pendq(lwdistcomm_client_t *client, bool fast, void *arg, uint32_t ftype, int timeout);
-static bool lwdistcomm_client_send(lwdistcomm_client_t *client, size_t len);
-static bool lwdistcomm_client_sendmsg(lwdistcomm_client_t *client, lwdistcomm_msg_header_t *header, const char *url, const lwdistcomm_message_t *msg);
+static void lwdistcomm_client_pendq_queue(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *pendq);
+static void lwdistcomm_client_pendq_dequeue(lwdistcomm_client_t *client, lwdistcomm_client_pendq_t *pendq);
+static lwdistcomm_client_pendq_t *lwdistcomm_client_prepare_pendq(lwdistcomm_client_t *client, void *arg, uint32_t ftype, int timeout);
+static lwdistcomm_client_pendq_t *lwdistcomm_client_find_pendq(lwdistcomm_client_t *client, uint16_t seqno);
+static bool lwdistcomm_client_sendmsg(lwdistcomm_client_t *client, uint8_t type, uint16_t seqno, const char *url, const lwdistcomm_message_t *msg);
+static const lwdistcomm_message_t *lwdistcomm_client_compress(lwdistcomm_client_t *client, const lwdistcomm_message_t *msg, lwdistcomm_message_t *lz4_msg, lwdistcomm_pbuf_t **pbuf, uint8_t *status);
 static void lwdistcomm_client_timeout_all(lwdistcomm_client_t *client);
+static void lwdistcomm_client_expire(lwdistcomm_client_t *client);
 static bool lwdistcomm_client_input(void *arg, lwdistcomm_msg_header_t *header);
+static bool lwdistcomm_client_servinfo(void *arg, lwdistcomm_msg_header_t *header);
+static bool lwdistcomm_client_shm_attach(lwdistcomm_client_t *client);
+static void lwdistcomm_client_shm_input(lwdistcomm_client_t *client);
 static uint16_t lwdistcomm_client_prepare_seqno(lwdistcomm_client_t *client);
 static bool lwdistcomm_client_request(lwdistcomm_client_t *client, uint8_t type, const char *url, const lwdistcomm_message_t *msg, lwdistcomm_client_subscribe_cb_t callback, void *arg, int timeout);
 
@@ -1,6 +1,11 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "data_reader_impl.h"
 #include "subscriber_impl.h"
 #include "topic_impl.h"
+#include "domain_participant_impl.h"
 #include "../../include/dds/dds.h"
 #include "../../include/lwdistcomm.h"
 #include <stdlib.h>
@@ -10,19 +15,926 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <time.h>
+
+#define MAX_SAMPLES 65536
+#define MIN_SAMPLES 16
+#define UDP_RECEIVE_PORT 0  /* 临时端口，通过SPDP端点宣告告知DataWriter */
+
+#define RECEIVE_BATCH 16
+#define RECEIVE_TIMEOUT_MS 100
+
+/* 没有新分片到达时重复发送NACK_FRAG的最小间隔 */
+#define NACK_FRAG_INTERVAL_US 100000
+
+extern lwdistcomm_address_t *lwdistcomm_address_create(lwdistcomm_addr_type_t type);
+extern bool lwdistcomm_address_set_ipv4(lwdistcomm_address_t *addr, const char *ip, uint16_t port);
+extern void lwdistcomm_address_destroy(lwdistcomm_address_t *addr);
+
+/**
+ * 初始化样本槽索引队列
+ */
+static bool sample_ring_init(lwdistcomm_dds_sample_ring_t *ring, uint32_t capacity)
+{
+    ring->cells = (lwdistcomm_dds_sample_cell_t *)malloc(sizeof(lwdistcomm_dds_sample_cell_t) * capacity);
+    if (!ring->cells) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < capacity; i++) {
+        ring->cells[i].seq = i;
+        ring->cells[i].index = LWDISTCOMM_DDS_SAMPLE_NONE;
+    }
+    ring->mask = capacity - 1;
+    ring->enqueue_pos = 0;
+    ring->dequeue_pos = 0;
+    
+    return true;
+}
+
+/**
+ * 入队样本槽索引，队列满时返回false
+ */
+static bool sample_ring_push(lwdistcomm_dds_sample_ring_t *ring, uint32_t index)
+{
+    lwdistcomm_dds_sample_cell_t *cell;
+    uint32_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        int32_t dif = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ring->enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    
+    cell->index = index;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    
+    return true;
+}
+
+/**
+ * 出队样本槽索引，队列空时返回false
+ */
+static bool sample_ring_pop(lwdistcomm_dds_sample_ring_t *ring, uint32_t *index)
+{
+    lwdistcomm_dds_sample_cell_t *cell;
+    uint32_t pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+    
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        int32_t dif = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ring->dequeue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&ring->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    
+    *index = cell->index;
+    __atomic_store_n(&cell->seq, pos + ring->mask + 1, __ATOMIC_RELEASE);
+    
+    return true;
+}
+
+/**
+ * 样本槽起始地址
+ */
+static inline uint8_t *sample_slot(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t index)
+{
+    return impl->sample_slab + (size_t)index * impl->sample_size;
+}
+
+/**
+ * 获取单调时钟微秒数
+ */
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * 释放样本槽持有的重组缓冲区，样本槽归还空闲队列前调用
+ */
+static void release_sample(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t index)
+{
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    uint8_t *slot = sample_slot(impl, index);
+    
+    if ((uint8_t *)sample->data < slot || (uint8_t *)sample->data >= slot + impl->sample_size) {
+        free(sample->data);
+        __atomic_sub_fetch(&impl->fragment_bytes, sample->size, __ATOMIC_RELAXED);
+        sample->data = slot;
+    }
+}
+
+/**
+ * 键哈希（FNV-1a）
+ */
+static uint32_t key_hash(const uint8_t *key, uint32_t len)
+{
+    uint32_t hash = 2166136261u;
+    
+    for (uint32_t i = 0; i < len; i++) {
+        hash ^= key[i];
+        hash *= 16777619u;
+    }
+    
+    return hash;
+}
+
+/**
+ * 查找键对应的实例，create为true时创建新实例，实例表满或未找到返回HANDLE_NIL，调用者持有impl->mutex
+ */
+static uint32_t find_instance(lwdistcomm_dds_data_reader_impl_t *impl, const uint8_t *key, uint32_t len, bool create)
+{
+    uint32_t hash = key_hash(key, len);
+    
+    for (uint32_t pos = hash & impl->index_mask; ; pos = (pos + 1) & impl->index_mask) {
+        uint32_t handle = impl->instance_index[pos];
+        if (handle == LWDISTCOMM_DDS_HANDLE_NIL) {
+            if (!create || impl->num_instances == impl->max_instances) {
+                return LWDISTCOMM_DDS_HANDLE_NIL;
+            }
+            
+            lwdistcomm_dds_instance_t *instance = &impl->instances[impl->num_instances++];
+            instance->hash = hash;
+            instance->key_len = len;
+            memcpy(instance->key, key, len);
+            impl->instance_index[pos] = impl->num_instances;
+            return impl->num_instances;
+        }
+        
+        const lwdistcomm_dds_instance_t *instance = &impl->instances[handle - 1];
+        if (instance->hash == hash && instance->key_len == len && memcmp(instance->key, key, len) == 0) {
+            return handle;
+        }
+    }
+}
+
+/**
+ * 从到达顺序链表中移除样本
+ */
+static void list_unlink(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t index)
+{
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    
+    if (sample->prev != LWDISTCOMM_DDS_SAMPLE_NONE) {
+        impl->samples[sample->prev].next = sample->next;
+    } else {
+        impl->oldest_sample = sample->next;
+    }
+    if (sample->next != LWDISTCOMM_DDS_SAMPLE_NONE) {
+        impl->samples[sample->next].prev = sample->prev;
+    } else {
+        impl->newest_sample = sample->prev;
+    }
+}
+
+/**
+ * 取出实例最早的样本，实例无样本返回LWDISTCOMM_DDS_SAMPLE_NONE，调用者持有impl->mutex
+ */
+static uint32_t instance_pop(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t handle)
+{
+    lwdistcomm_dds_instance_t *instance = &impl->instances[handle - 1];
+    if (!instance->count) {
+        return LWDISTCOMM_DDS_SAMPLE_NONE;
+    }
+    
+    uint32_t index = impl->instance_history[(size_t)(handle - 1) * impl->instance_depth + instance->head];
+    instance->head = (instance->head + 1) % impl->instance_depth;
+    instance->count--;
+    list_unlink(impl, index);
+    
+    return index;
+}
+
+/**
+ * 实例最新的样本，调用者持有impl->mutex
+ */
+static uint32_t instance_newest(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t handle)
+{
+    const lwdistcomm_dds_instance_t *instance = &impl->instances[handle - 1];
+    if (!instance->count) {
+        return LWDISTCOMM_DDS_SAMPLE_NONE;
+    }
+    
+    return impl->instance_history[(size_t)(handle - 1) * impl->instance_depth +
+                                  (instance->head + instance->count - 1) % impl->instance_depth];
+}
+
+/**
+ * 样本加入实例历史，KEEP_LAST时替换实例最早的样本并通过replaced返回，
+ * 无有效键、实例表满或KEEP_ALL实例历史满时返回false
+ */
+static bool instance_push(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t index, const uint8_t *key, uint32_t len, uint32_t *replaced)
+{
+    *replaced = LWDISTCOMM_DDS_SAMPLE_NONE;
+    
+    uint32_t handle = len && len <= LWDISTCOMM_DDS_MAX_KEY_SIZE ? find_instance(impl, key, len, true) : LWDISTCOMM_DDS_HANDLE_NIL;
+    if (handle == LWDISTCOMM_DDS_HANDLE_NIL) {
+        return false;
+    }
+    
+    lwdistcomm_dds_instance_t *instance = &impl->instances[handle - 1];
+    if (instance->count == impl->instance_depth) {
+        if (impl->instance_keep_all) {
+            return false;
+        }
+        *replaced = instance_pop(impl, handle);
+    }
+    
+    impl->instance_history[(size_t)(handle - 1) * impl->instance_depth + (instance->head + instance->count) % impl->instance_depth] = index;
+    instance->count++;
+    
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    sample->info.instance_handle = handle;
+    sample->prev = impl->newest_sample;
+    sample->next = LWDISTCOMM_DDS_SAMPLE_NONE;
+    if (impl->newest_sample != LWDISTCOMM_DDS_SAMPLE_NONE) {
+        impl->samples[impl->newest_sample].next = index;
+    } else {
+        impl->oldest_sample = index;
+    }
+    impl->newest_sample = index;
+    
+    return true;
+}
+
+/**
+ * 分配实例表，实例数由resource_limits.max_instances决定，
+ * 每个实例保留KEEP_LAST的depth或KEEP_ALL的max_samples_per_instance个样本
+ */
+static bool instances_init(lwdistcomm_dds_data_reader_impl_t *impl)
+{
+    uint32_t max_instances = impl->qos.resource_limits.max_instances;
+    if (!max_instances || max_instances > LWDISTCOMM_DDS_MAX_INSTANCES) {
+        max_instances = LWDISTCOMM_DDS_MAX_INSTANCES;
+    }
+    
+    impl->instance_keep_all = impl->qos.history.kind == LWDISTCOMM_DDS_HISTORY_KEEP_ALL;
+    impl->instance_depth = impl->instance_keep_all ? impl->qos.resource_limits.max_samples_per_instance : impl->qos.history.depth;
+    if (!impl->instance_depth) {
+        impl->instance_depth = 1;
+    } else if (impl->instance_depth > impl->max_samples) {
+        impl->instance_depth = impl->max_samples;
+    }
+    
+    uint32_t index_size = 2;
+    while (index_size < max_instances * 2) {
+        index_size <<= 1;
+    }
+    
+    impl->max_instances = max_instances;
+    impl->index_mask = index_size - 1;
+    impl->oldest_sample = LWDISTCOMM_DDS_SAMPLE_NONE;
+    impl->newest_sample = LWDISTCOMM_DDS_SAMPLE_NONE;
+    impl->instances = (lwdistcomm_dds_instance_t *)calloc(max_instances, sizeof(lwdistcomm_dds_instance_t));
+    impl->instance_history = (uint32_t *)malloc((size_t)max_instances * impl->instance_depth * sizeof(uint32_t));
+    impl->instance_index = (uint32_t *)calloc(index_size, sizeof(uint32_t));
+    
+    return impl->instances && impl->instance_history && impl->instance_index;
+}
+
+/**
+ * 分配空闲样本槽
+ */
+bool lwdistcomm_dds_data_reader_impl_acquire_sample(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t *index)
+{
+    if (sample_ring_pop(&impl->free_ring, index)) {
+        return true;
+    }
+    
+    /* 样本槽用尽，覆盖最早的未读样本 */
+    if (impl->instances) {
+        pthread_mutex_lock(&impl->mutex);
+        *index = impl->oldest_sample;
+        if (*index != LWDISTCOMM_DDS_SAMPLE_NONE) {
+            instance_pop(impl, impl->samples[*index].info.instance_handle);
+        }
+        pthread_mutex_unlock(&impl->mutex);
+        
+        if (*index != LWDISTCOMM_DDS_SAMPLE_NONE) {
+            release_sample(impl, *index);
+            __atomic_add_fetch(&impl->lost_samples, 1, __ATOMIC_RELAXED);
+            return true;
+        }
+    } else if (sample_ring_pop(&impl->ready_ring, index)) {
+        release_sample(impl, *index);
+        __atomic_add_fetch(&impl->lost_samples, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    
+    /* 所有样本槽都被借出 */
+    __atomic_add_fetch(&impl->lost_samples, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+/**
+ * 提交样本槽
+ */
+void lwdistcomm_dds_data_reader_impl_commit_sample(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t index)
+{
+    /* 设置过滤条件前已在途或经组播到达的样本 */
+    if (__atomic_load_n(&impl->filtered, __ATOMIC_ACQUIRE)) {
+        lwdistcomm_dds_content_filter_t filter;
+        lwdistcomm_dds_data_reader_impl_get_filter(impl, &filter);
+        if (!lwdistcomm_dds_topic_impl_filter_match(impl->topic->impl, &filter, impl->samples[index].data, impl->samples[index].size)) {
+            release_sample(impl, index);
+            sample_ring_push(&impl->free_ring, index);
+            return;
+        }
+    }
+    
+    if (impl->instances) {
+        /* 有键主题：在互斥锁外提取键，实例历史满时替换该实例最早的样本 */
+        lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+        uint8_t key[LWDISTCOMM_DDS_MAX_KEY_SIZE];
+        uint32_t len = impl->key_extract(sample->data, sample->size, key, sizeof(key), impl->key_arg);
+        uint32_t replaced;
+        
+        pthread_mutex_lock(&impl->mutex);
+        bool accepted = instance_push(impl, index, key, len, &replaced);
+        pthread_mutex_unlock(&impl->mutex);
+        
+        if (replaced != LWDISTCOMM_DDS_SAMPLE_NONE) {
+            release_sample(impl, replaced);
+            sample_ring_push(&impl->free_ring, replaced);
+        }
+        if (!accepted) {
+            release_sample(impl, index);
+            sample_ring_push(&impl->free_ring, index);
+            __atomic_add_fetch(&impl->lost_samples, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } else {
+        /* 队列容量不小于样本槽数，入队不会失败 */
+        sample_ring_push(&impl->ready_ring, index);
+    }
+    
+    /* 调用数据可用回调 */
+    if (impl->data_available_cb && impl->reader) {
+        impl->data_available_cb(impl->reader, impl->data_available_arg);
+    }
+}
+
+/**
+ * 查找或创建远端DataWriter状态，表满时替换一个已有条目
+ */
+static lwdistcomm_dds_writer_proxy_t *find_writer_proxy(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t participant_id, uint32_t endpoint_id, const struct sockaddr_in *from)
+{
+    lwdistcomm_dds_writer_proxy_t *proxy;
+    
+    for (uint32_t i = 0; i < impl->num_writer_proxies; i++) {
+        proxy = &impl->writer_proxies[i];
+        if (proxy->participant_id == participant_id && proxy->endpoint_id == endpoint_id) {
+            proxy->addr = *from;
+            return proxy;
+        }
+    }
+    
+    if (impl->num_writer_proxies < LWDISTCOMM_DDS_MAX_WRITER_PROXIES) {
+        proxy = &impl->writer_proxies[impl->num_writer_proxies++];
+    } else {
+        proxy = &impl->writer_proxies[(participant_id ^ endpoint_id) % LWDISTCOMM_DDS_MAX_WRITER_PROXIES];
+        for (uint64_t mask = proxy->pending_mask; mask; mask &= mask - 1) {
+            uint64_t seqno = proxy->next_seqno + (uint64_t)__builtin_ctzll(mask);
+            release_sample(impl, proxy->pending[seqno % LWDISTCOMM_DDS_REORDER_WINDOW]);
+            sample_ring_push(&impl->free_ring, proxy->pending[seqno % LWDISTCOMM_DDS_REORDER_WINDOW]);
+        }
+    }
+    
+    memset(proxy, 0, sizeof(lwdistcomm_dds_writer_proxy_t));
+    proxy->participant_id = participant_id;
+    proxy->endpoint_id = endpoint_id;
+    proxy->addr = *from;
+    
+    return proxy;
+}
 
-#define MAX_SAMPLES 128
-#define UDP_RECEIVE_PORT 7402
-#define MAX_BUFFER_SIZE 1024
+/**
+ * 交付样本，附带序列号和之前累计的丢失数
+ */
+static void deliver_sample(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, uint32_t index, uint64_t seqno)
+{
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    
+    sample->info.sequence_number = seqno;
+    sample->info.lost_samples = proxy->lost;
+    proxy->lost = 0;
+    
+    lwdistcomm_dds_data_reader_impl_commit_sample(impl, index);
+}
+
+/**
+ * 按序交付从next_seqno开始连续缓存的样本，跳过被过滤的序列号
+ */
+static void proxy_flush(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy)
+{
+    while ((proxy->pending_mask | proxy->gap_mask) & 1) {
+        if (proxy->pending_mask & 1) {
+            deliver_sample(impl, proxy, proxy->pending[proxy->next_seqno % LWDISTCOMM_DDS_REORDER_WINDOW], proxy->next_seqno);
+        }
+        proxy->pending_mask >>= 1;
+        proxy->gap_mask >>= 1;
+        proxy->next_seqno++;
+    }
+}
+
+/**
+ * 放弃seqno之前仍缺失的样本，count_lost为true时计入丢失数，被过滤的序列号不计入
+ */
+static void proxy_skip(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, uint64_t seqno, bool count_lost)
+{
+    while (proxy->next_seqno < seqno && (proxy->pending_mask | proxy->gap_mask)) {
+        if (proxy->pending_mask & 1) {
+            deliver_sample(impl, proxy, proxy->pending[proxy->next_seqno % LWDISTCOMM_DDS_REORDER_WINDOW], proxy->next_seqno);
+        } else if (!(proxy->gap_mask & 1) && count_lost) {
+            proxy->lost++;
+        }
+        proxy->pending_mask >>= 1;
+        proxy->gap_mask >>= 1;
+        proxy->next_seqno++;
+    }
+    
+    if (proxy->next_seqno < seqno) {
+        if (count_lost) {
+            proxy->lost += (uint32_t)(seqno - proxy->next_seqno);
+        }
+        proxy->next_seqno = seqno;
+    }
+    
+    proxy_flush(impl, proxy);
+}
+
+/**
+ * 是否为该DataWriter的重组状态
+ */
+static inline bool reassembly_of(const lwdistcomm_dds_reassembly_t *r, const lwdistcomm_dds_writer_proxy_t *proxy)
+{
+    return r->seqno && r->participant_id == proxy->participant_id && r->endpoint_id == proxy->endpoint_id;
+}
+
+/**
+ * 发送ACKNACK，确认next_seqno之前的样本并请求重传窗口内缺失的样本，
+ * 正在重组的样本不在此请求，由NACK_FRAG请求缺失的分片
+ */
+static void send_acknack(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy)
+{
+    lwdistcomm_dds_acknack_msg_t msg;
+    uint32_t num_bits = 0;
+    uint64_t bitmap = 0;
+    
+    if (proxy->highest_seqno >= proxy->next_seqno) {
+        uint64_t span = proxy->highest_seqno - proxy->next_seqno + 1;
+        num_bits = span < LWDISTCOMM_DDS_ACKNACK_BITS ? (uint32_t)span : LWDISTCOMM_DDS_ACKNACK_BITS;
+        bitmap = ~(proxy->pending_mask | proxy->gap_mask);
+        if (num_bits < LWDISTCOMM_DDS_ACKNACK_BITS) {
+            bitmap &= ((uint64_t)1 << num_bits) - 1;
+        }
+        
+        for (uint32_t i = 0; i < LWDISTCOMM_DDS_MAX_REASSEMBLIES; i++) {
+            const lwdistcomm_dds_reassembly_t *r = &impl->reassemblies[i];
+            if (reassembly_of(r, proxy) && r->seqno >= proxy->next_seqno && r->seqno - proxy->next_seqno < num_bits) {
+                bitmap &= ~((uint64_t)1 << (r->seqno - proxy->next_seqno));
+            }
+        }
+    }
+    
+    lwdistcomm_dds_msg_init_header(&msg.header, LWDISTCOMM_DDS_MSG_ACKNACK, 0, impl->participant_id, impl->endpoint_id, impl->topic_id);
+    msg.writer_id = htonl(proxy->endpoint_id);
+    msg.num_bits = htonl(num_bits);
+    msg.base_seqno = htobe64(proxy->next_seqno);
+    msg.bitmap = htobe64(bitmap);
+    
+    struct iovec iov = { &msg, sizeof(msg) };
+    lwdistcomm_dds_transport_send_addr(impl->transport, &iov, 1, &proxy->addr);
+}
+
+/**
+ * 为该DataWriter未完成的分片样本发送NACK_FRAG，请求从第一个缺失分片起的缺失分片，
+ * 上次请求后没有新分片到达时按NACK_FRAG_INTERVAL_US限速
+ */
+static void send_nack_frags(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy)
+{
+    uint64_t now = monotonic_us();
+    
+    for (uint32_t i = 0; i < LWDISTCOMM_DDS_MAX_REASSEMBLIES; i++) {
+        lwdistcomm_dds_reassembly_t *r = &impl->reassemblies[i];
+        if (!reassembly_of(r, proxy) || (r->received == r->nacked && now - r->nack_us < NACK_FRAG_INTERVAL_US)) {
+            continue;
+        }
+        
+        /* 第一个缺失分片，最后一个字中超出分片数的位为0，不会早于真正缺失的分片 */
+        uint32_t base = 0;
+        for (uint32_t w = 0; w < (r->num_frags + 63) / 64; w++) {
+            if (~r->frag_mask[w]) {
+                base = w * 64 + (uint32_t)__builtin_ctzll(~r->frag_mask[w]);
+                break;
+            }
+        }
+        
+        lwdistcomm_dds_nack_frag_msg_t msg;
+        uint32_t num_bits = r->num_frags - base < LWDISTCOMM_DDS_NACK_FRAG_BITS ? r->num_frags - base : LWDISTCOMM_DDS_NACK_FRAG_BITS;
+        
+        memset(msg.bitmap, 0, sizeof(msg.bitmap));
+        for (uint32_t j = 0; j < num_bits; j++) {
+            uint32_t frag = base + j;
+            if (!(r->frag_mask[frag / 64] & ((uint64_t)1 << (frag % 64)))) {
+                msg.bitmap[j / 64] |= (uint64_t)1 << (j % 64);
+            }
+        }
+        for (uint32_t j = 0; j < LWDISTCOMM_DDS_NACK_FRAG_BITS / 64; j++) {
+            msg.bitmap[j] = htobe64(msg.bitmap[j]);
+        }
+        
+        lwdistcomm_dds_msg_init_header(&msg.header, LWDISTCOMM_DDS_MSG_NACK_FRAG, 0, impl->participant_id, impl->endpoint_id, impl->topic_id);
+        msg.writer_id = htonl(proxy->endpoint_id);
+        msg.num_bits = htonl(num_bits);
+        msg.seqno = htobe64(r->seqno);
+        msg.base_fragment = htonl(base);
+        msg.reserved = 0;
+        
+        struct iovec iov = { &msg, sizeof(msg) };
+        lwdistcomm_dds_transport_send_addr(impl->transport, &iov, 1, &proxy->addr);
+        
+        r->nacked = r->received;
+        r->nack_us = now;
+    }
+}
+
+/**
+ * 处理DATA报文，返回false表示样本槽未被占用可继续接收
+ */
+static bool on_data(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, uint32_t index, uint64_t seqno, bool reliable)
+{
+    if (!proxy->next_seqno) {
+        proxy->next_seqno = seqno;
+    }
+    
+    /* 重复或过期的样本 */
+    if (seqno < proxy->next_seqno) {
+        return false;
+    }
+    
+    if (!reliable) {
+        /* 尽力而为：按到达交付，序列号间隙计为丢失 */
+        proxy->lost += (uint32_t)(seqno - proxy->next_seqno);
+        proxy->next_seqno = seqno + 1;
+        proxy->highest_seqno = seqno;
+        deliver_sample(impl, proxy, index, seqno);
+        return true;
+    }
+    
+    /* 超出乱序窗口，放弃窗口外最早的缺失样本 */
+    if (seqno >= proxy->next_seqno + impl->reorder_window) {
+        proxy_skip(impl, proxy, seqno - impl->reorder_window + 1, true);
+    }
+    
+    uint64_t bit = (uint64_t)1 << (seqno - proxy->next_seqno);
+    if ((proxy->pending_mask | proxy->gap_mask) & bit) {
+        return false;
+    }
+    
+    proxy->pending[seqno % LWDISTCOMM_DDS_REORDER_WINDOW] = index;
+    proxy->pending_mask |= bit;
+    proxy_flush(impl, proxy);
+    
+    /* 新出现间隙时立即请求重传，不等待心跳 */
+    if (seqno > proxy->highest_seqno + 1 && proxy->highest_seqno) {
+        proxy->highest_seqno = seqno;
+        send_acknack(impl, proxy);
+    } else if (seqno > proxy->highest_seqno) {
+        proxy->highest_seqno = seqno;
+    }
+    
+    return true;
+}
+
+/**
+ * 处理HEARTBEAT报文
+ */
+static void on_heartbeat(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, uint64_t first_seqno, uint64_t last_seqno)
+{
+    if (!first_seqno || first_seqno > last_seqno) {
+        return;
+    }
+    
+    /* 尚未收到数据时，VOLATILE只接收之后的样本 */
+    if (!proxy->next_seqno) {
+        proxy->next_seqno = impl->qos.durability.kind == LWDISTCOMM_DDS_DURABILITY_VOLATILE ? last_seqno + 1 : first_seqno;
+    }
+    
+    /* DataWriter已不再保留的样本无法补齐 */
+    if (first_seqno > proxy->next_seqno) {
+        proxy_skip(impl, proxy, first_seqno, true);
+    }
+    
+    if (last_seqno > proxy->highest_seqno) {
+        proxy->highest_seqno = last_seqno;
+    }
+    
+    send_acknack(impl, proxy);
+    send_nack_frags(impl, proxy);
+}
+
+/**
+ * 处理GAP报文，[gap_start, base)及bitmap中的序列号被DataWriter过滤，不再请求也不计为丢失；
+ * 尽力而为时只跳过紧接next_seqno的连续区间
+ */
+static void on_gap(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, uint64_t gap_start, uint64_t base,
+                   uint32_t num_bits, uint64_t bitmap, bool reliable)
+{
+    /* 尚未收到数据时由随后的DATA或心跳确定起点 */
+    if (!proxy->next_seqno || gap_start > base) {
+        return;
+    }
+    
+    if (!reliable) {
+        if (gap_start <= proxy->next_seqno && base > proxy->next_seqno) {
+            proxy->next_seqno = base;
+        }
+        return;
+    }
+    
+    if (gap_start <= proxy->next_seqno && base > proxy->next_seqno) {
+        proxy_skip(impl, proxy, base, false);
+    }
+    
+    /* 窗口内的其余序列号标记为被过滤，窗口外的由之后的ACKNACK再次确认 */
+    for (uint64_t seqno = gap_start > proxy->next_seqno ? gap_start : proxy->next_seqno;
+         seqno < base && seqno < proxy->next_seqno + impl->reorder_window; seqno++) {
+        proxy->gap_mask |= (uint64_t)1 << (seqno - proxy->next_seqno);
+    }
+    for (uint32_t i = 0; i < num_bits && i < LWDISTCOMM_DDS_GAP_BITS; i++) {
+        uint64_t seqno = base + i;
+        if ((bitmap & ((uint64_t)1 << i)) && seqno >= proxy->next_seqno && seqno < proxy->next_seqno + impl->reorder_window) {
+            proxy->gap_mask |= (uint64_t)1 << (seqno - proxy->next_seqno);
+        }
+    }
+    proxy->gap_mask &= ~proxy->pending_mask;
+    
+    if (base - 1 > proxy->highest_seqno) {
+        proxy->highest_seqno = base - 1;
+    }
+    
+    proxy_flush(impl, proxy);
+}
+
+/**
+ * 填充样本数据位置和样本信息
+ */
+static void fill_sample(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, uint32_t index, void *data, uint32_t size)
+{
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    
+    sample->data = data;
+    sample->size = size;
+    memset(&sample->info, 0, sizeof(lwdistcomm_dds_sample_info_t));
+    sample->info.valid_data = true;
+    sample->info.publication_handle = proxy->endpoint_id;
+}
+
+/**
+ * 放弃重组，释放重组缓冲区
+ */
+static void reassembly_drop(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_reassembly_t *r)
+{
+    free(r->data);
+    free(r->frag_mask);
+    __atomic_sub_fetch(&impl->fragment_bytes, r->size, __ATOMIC_RELAXED);
+    memset(r, 0, sizeof(*r));
+}
+
+/**
+ * 放弃超时的重组
+ */
+static void expire_reassemblies(lwdistcomm_dds_data_reader_impl_t *impl, uint64_t now)
+{
+    for (uint32_t i = 0; i < LWDISTCOMM_DDS_MAX_REASSEMBLIES; i++) {
+        if (impl->reassemblies[i].seqno && now >= impl->reassemblies[i].deadline_us) {
+            reassembly_drop(impl, &impl->reassemblies[i]);
+        }
+    }
+}
+
+/**
+ * 查找或开始样本的重组，重组表满时替换最早超时的条目，超出内存上限时返回NULL
+ */
+static lwdistcomm_dds_reassembly_t *find_reassembly(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, uint64_t seqno, uint32_t size, bool reliable)
+{
+    lwdistcomm_dds_reassembly_t *r = NULL;
+    
+    for (uint32_t i = 0; i < LWDISTCOMM_DDS_MAX_REASSEMBLIES; i++) {
+        lwdistcomm_dds_reassembly_t *entry = &impl->reassemblies[i];
+        if (!reassembly_of(entry, proxy)) {
+            continue;
+        }
+        if (entry->seqno == seqno) {
+            return entry->size == size ? entry : NULL;
+        }
+        /* 尽力而为不重传，同一DataWriter更早的未完成样本不会再补齐 */
+        if (!reliable && entry->seqno < seqno) {
+            reassembly_drop(impl, entry);
+        }
+    }
+    
+    for (uint32_t i = 0; i < LWDISTCOMM_DDS_MAX_REASSEMBLIES; i++) {
+        lwdistcomm_dds_reassembly_t *entry = &impl->reassemblies[i];
+        if (!entry->seqno) {
+            r = entry;
+            break;
+        }
+        if (!r || entry->deadline_us < r->deadline_us) {
+            r = entry;
+        }
+    }
+    
+    if (r->seqno) {
+        reassembly_drop(impl, r);
+    }
+    
+    if (__atomic_load_n(&impl->fragment_bytes, __ATOMIC_RELAXED) + size > __atomic_load_n(&impl->reassembly_limit, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    
+    r->num_frags = lwdistcomm_dds_fragment_count(size);
+    r->data = (uint8_t *)malloc(size);
+    r->frag_mask = (uint64_t *)calloc((r->num_frags + 63) / 64, sizeof(uint64_t));
+    if (!r->data || !r->frag_mask) {
+        free(r->data);
+        free(r->frag_mask);
+        memset(r, 0, sizeof(*r));
+        return NULL;
+    }
+    
+    __atomic_add_fetch(&impl->fragment_bytes, size, __ATOMIC_RELAXED);
+    r->participant_id = proxy->participant_id;
+    r->endpoint_id = proxy->endpoint_id;
+    r->seqno = seqno;
+    r->size = size;
+    
+    return r;
+}
+
+/**
+ * 处理DATA_FRAG报文，样本的全部分片到齐后交付，重组缓冲区直接作为样本数据
+ */
+static void on_data_frag(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_writer_proxy_t *proxy, const uint8_t *buffer, size_t len, bool reliable)
+{
+    lwdistcomm_dds_data_frag_t frag;
+    size_t off = sizeof(lwdistcomm_dds_msg_header_t) + sizeof(frag);
+    
+    memcpy(&frag, buffer + sizeof(lwdistcomm_dds_msg_header_t), sizeof(frag));
+    uint64_t seqno = be64toh(frag.seqno);
+    uint32_t size = ntohl(frag.sample_size);
+    uint32_t offset = ntohl(frag.offset);
+    size_t chunk = len - off;
+    
+    if (!seqno || size > LWDISTCOMM_DDS_MAX_SAMPLE_SIZE || offset >= size || offset % LWDISTCOMM_DDS_FRAGMENT_SIZE ||
+        chunk != (size - offset < LWDISTCOMM_DDS_FRAGMENT_SIZE ? size - offset : LWDISTCOMM_DDS_FRAGMENT_SIZE)) {
+        return;
+    }
+    
+    /* 已交付、已放弃或已在乱序窗口中的样本 */
+    if (proxy->next_seqno && (seqno < proxy->next_seqno ||
+        (seqno - proxy->next_seqno < impl->reorder_window && (proxy->pending_mask & ((uint64_t)1 << (seqno - proxy->next_seqno)))))) {
+        return;
+    }
+    
+    lwdistcomm_dds_reassembly_t *r = find_reassembly(impl, proxy, seqno, size, reliable);
+    if (!r) {
+        return;
+    }
+    
+    uint32_t index = offset / (uint32_t)LWDISTCOMM_DDS_FRAGMENT_SIZE;
+    if (r->frag_mask[index / 64] & ((uint64_t)1 << (index % 64))) {
+        return;
+    }
+    
+    r->frag_mask[index / 64] |= (uint64_t)1 << (index % 64);
+    memcpy(r->data + offset, buffer + off, chunk);
+    r->received++;
+    r->deadline_us = monotonic_us() + __atomic_load_n(&impl->reassembly_timeout_us, __ATOMIC_RELAXED);
+    if (r->received < r->num_frags) {
+        return;
+    }
+    
+    /* 全部分片到齐，重组缓冲区交给样本槽，样本取走时释放 */
+    uint8_t *data = r->data;
+    uint32_t slot;
+    
+    free(r->frag_mask);
+    memset(r, 0, sizeof(*r));
+    
+    if (!lwdistcomm_dds_data_reader_impl_acquire_sample(impl, &slot)) {
+        free(data);
+        __atomic_sub_fetch(&impl->fragment_bytes, size, __ATOMIC_RELAXED);
+        return;
+    }
+    
+    fill_sample(impl, proxy, slot, data, size);
+    if (!on_data(impl, proxy, slot, seqno, reliable)) {
+        release_sample(impl, slot);
+        sample_ring_push(&impl->free_ring, slot);
+    }
+}
 
-/* Transport functions declarations */
-extern int lwdistcomm_transport_create_udp_socket(lwdistcomm_addr_type_t type, bool non_blocking);
-extern bool lwdistcomm_transport_bind(int sock, const lwdistcomm_address_t *addr);
-extern ssize_t lwdistcomm_transport_recvfrom(int sock, void *buffer, size_t len, lwdistcomm_address_t *addr);
-extern void lwdistcomm_transport_close(int sock);
-extern lwdistcomm_address_t *lwdistcomm_address_create(lwdistcomm_addr_type_t type);
-extern bool lwdistcomm_address_set_ipv4(lwdistcomm_address_t *addr, const char *ip, uint16_t port);
-extern void lwdistcomm_address_destroy(lwdistcomm_address_t *addr);
+/**
+ * 处理一个接收到的报文，返回true表示接收所用的样本槽已被样本占用
+ */
+static bool process_datagram(lwdistcomm_dds_data_reader_impl_t *impl, uint8_t *buffer, size_t len, const struct sockaddr_in *from, uint32_t index)
+{
+    uint8_t kind = lwdistcomm_dds_msg_validate(buffer, len);
+    if (!kind || kind == LWDISTCOMM_DDS_MSG_ACKNACK || kind == LWDISTCOMM_DDS_MSG_NACK_FRAG) {
+        return false;
+    }
+    
+    /* 组播组由多个主题共用，只处理本主题的报文 */
+    const lwdistcomm_dds_msg_header_t *header = (const lwdistcomm_dds_msg_header_t *)buffer;
+    if (ntohl(header->topic_id) != impl->topic_id) {
+        return false;
+    }
+    
+    lwdistcomm_dds_writer_proxy_t *proxy = find_writer_proxy(impl, ntohl(header->participant_id), ntohl(header->endpoint_id), from);
+    bool reliable = impl->qos.reliability.kind == LWDISTCOMM_DDS_RELIABILITY_RELIABLE &&
+                    (header->flags & LWDISTCOMM_DDS_MSG_FLAG_RELIABLE);
+    
+    if (kind == LWDISTCOMM_DDS_MSG_HEARTBEAT) {
+        const lwdistcomm_dds_heartbeat_msg_t *msg = (const lwdistcomm_dds_heartbeat_msg_t *)buffer;
+        if (reliable) {
+            on_heartbeat(impl, proxy, be64toh(msg->first_seqno), be64toh(msg->last_seqno));
+        }
+        return false;
+    }
+    
+    if (kind == LWDISTCOMM_DDS_MSG_GAP) {
+        const lwdistcomm_dds_gap_msg_t *msg = (const lwdistcomm_dds_gap_msg_t *)buffer;
+        on_gap(impl, proxy, be64toh(msg->gap_start), be64toh(msg->base_seqno), ntohl(msg->num_bits), be64toh(msg->bitmap), reliable);
+        return false;
+    }
+    
+    if (kind == LWDISTCOMM_DDS_MSG_DATA_FRAG) {
+        on_data_frag(impl, proxy, buffer, len, reliable);
+        return false;
+    }
+    
+    size_t off = sizeof(lwdistcomm_dds_msg_header_t);
+    lwdistcomm_dds_data_record_t record;
+    
+    memcpy(&record, buffer + off, sizeof(record));
+    uint32_t length = ntohl(record.length);
+    if (length > len - off - sizeof(record)) {
+        return false;
+    }
+    
+    /* 只含一个样本的报文原地交付，不复制负载 */
+    if (index != LWDISTCOMM_DDS_SAMPLE_NONE && off + lwdistcomm_dds_record_len(length) + sizeof(record) > len) {
+        uint64_t seqno = be64toh(record.seqno);
+        if (!seqno) {
+            return false;
+        }
+        fill_sample(impl, proxy, index, buffer + off + sizeof(record), length);
+        return on_data(impl, proxy, index, seqno, reliable);
+    }
+    
+    /* 打包的报文，每个样本复制到独立的样本槽 */
+    while (off + sizeof(record) <= len) {
+        memcpy(&record, buffer + off, sizeof(record));
+        length = ntohl(record.length);
+        uint64_t seqno = be64toh(record.seqno);
+        if (length > len - off - sizeof(record) || length > LWDISTCOMM_DDS_MAX_RECORD_SIZE) {
+            break;
+        }
+        
+        uint32_t slot;
+        if (seqno && lwdistcomm_dds_data_reader_impl_acquire_sample(impl, &slot)) {
+            memcpy(sample_slot(impl, slot), buffer + off + sizeof(record), length);
+            fill_sample(impl, proxy, slot, sample_slot(impl, slot), length);
+            if (!on_data(impl, proxy, slot, seqno, reliable)) {
+                release_sample(impl, slot);
+                sample_ring_push(&impl->free_ring, slot);
+            }
+        }
+        
+        off += lwdistcomm_dds_record_len(length);
+    }
+    
+    return false;
+}
 
 /**
  * 数据接收线程函数
@@ -34,27 +946,58 @@ void *lwdistcomm_dds_data_reader_receive_thread(void *arg)
         return NULL;
     }
     
-    char buffer[MAX_BUFFER_SIZE];
-    lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_IPV4);
-    if (!addr) {
-        return NULL;
-    }
+    uint8_t discard[LWDISTCOMM_DDS_MAX_DATAGRAM_SIZE];
+    uint32_t slots[RECEIVE_BATCH];
+    uint32_t held = 0;
+    struct sockaddr_in from[RECEIVE_BATCH];
+    struct iovec iov[RECEIVE_BATCH];
+    struct mmsghdr msgs[RECEIVE_BATCH];
     
     while (impl->receive_thread_running) {
-        ssize_t received = lwdistcomm_transport_recvfrom(impl->udp_socket, buffer, MAX_BUFFER_SIZE, addr);
-        if (received > 0) {
-            printf("DataReader: Received %zd bytes of data\n", received);
-            /* 创建样本信息 */
-            lwdistcomm_dds_sample_info_t info;
-            memset(&info, 0, sizeof(lwdistcomm_dds_sample_info_t));
-            info.valid_data = true;
-            
-            /* 添加数据样本 */
-            lwdistcomm_dds_data_reader_impl_add_sample(impl, buffer, (uint32_t)received, &info);
+        /* 每批报文直接接收到空闲样本槽，无空闲槽时至少覆盖一个最早的样本，
+         * 仍无可用槽时接收到丢弃缓冲区，仍处理控制报文 */
+        while (held < RECEIVE_BATCH && sample_ring_pop(&impl->free_ring, &slots[held])) {
+            held++;
+        }
+        if (!held && lwdistcomm_dds_data_reader_impl_acquire_sample(impl, &slots[0])) {
+            held = 1;
+        }
+        
+        uint32_t count = held ? held : 1;
+        memset(msgs, 0, sizeof(struct mmsghdr) * count);
+        for (uint32_t i = 0; i < count; i++) {
+            iov[i].iov_base = held ? sample_slot(impl, slots[i]) : discard;
+            iov[i].iov_len = impl->sample_size;
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        
+        int n = lwdistcomm_dds_transport_recv_batch(impl->transport, msgs, count, RECEIVE_TIMEOUT_MS);
+        expire_reassemblies(impl, monotonic_us());
+        if (n <= 0) {
+            continue;
+        }
+        
+        /* 未被样本占用的样本槽留给下一批 */
+        uint32_t keep = 0;
+        for (uint32_t i = 0; i < (uint32_t)n; i++) {
+            uint32_t index = held ? slots[i] : LWDISTCOMM_DDS_SAMPLE_NONE;
+            if (!process_datagram(impl, (uint8_t *)iov[i].iov_base, msgs[i].msg_len, &from[i], index) && held) {
+                slots[keep++] = slots[i];
+            }
+        }
+        for (uint32_t i = (uint32_t)n; i < held; i++) {
+            slots[keep++] = slots[i];
         }
+        held = keep;
+    }
+    
+    for (uint32_t i = 0; i < held; i++) {
+        sample_ring_push(&impl->free_ring, slots[i]);
     }
     
-    lwdistcomm_address_destroy(addr);
     return NULL;
 }
 
@@ -79,29 +1022,91 @@ lwdistcomm_dds_data_reader_impl_t *lwdistcomm_dds_data_reader_impl_create(const
     impl->matched_writers = 0;
     impl->data_available_cb = NULL;
     impl->data_available_arg = NULL;
+    impl->topic_id = lwdistcomm_dds_topic_id(options->topic->impl->name);
+    impl->reassembly_limit = LWDISTCOMM_DDS_DEFAULT_REASSEMBLY_LIMIT;
+    impl->reassembly_timeout_us = (uint64_t)LWDISTCOMM_DDS_DEFAULT_REASSEMBLY_TIMEOUT_SEC * 1000000;
+    
+    /* 按resource_limits预分配样本槽 */
+    uint32_t max_samples = impl->qos.resource_limits.max_samples;
+    if (max_samples < MIN_SAMPLES) {
+        max_samples = MIN_SAMPLES;
+    } else if (max_samples > MAX_SAMPLES) {
+        max_samples = MAX_SAMPLES;
+    }
+    /* 接收线程至少持有一个待接收的样本槽，批量接收只使用空闲样本槽 */
+    max_samples++;
+    uint32_t capacity = MIN_SAMPLES;
+    while (capacity < max_samples) {
+        capacity <<= 1;
+    }
+    
+    impl->max_samples = max_samples;
+    impl->sample_size = LWDISTCOMM_DDS_MAX_DATAGRAM_SIZE;
+    impl->held_sample = LWDISTCOMM_DDS_SAMPLE_NONE;
+    impl->samples = (lwdistcomm_dds_sample_t *)calloc(max_samples, sizeof(lwdistcomm_dds_sample_t));
+    impl->sample_slab = (uint8_t *)malloc((size_t)max_samples * impl->sample_size);
+    if (!impl->samples || !impl->sample_slab ||
+        !sample_ring_init(&impl->free_ring, capacity) || !sample_ring_init(&impl->ready_ring, capacity)) {
+        free(impl->free_ring.cells);
+        free(impl->sample_slab);
+        free(impl->samples);
+        free(impl);
+        return NULL;
+    }
+    
+    for (uint32_t i = 0; i < max_samples; i++) {
+        impl->samples[i].data = sample_slot(impl, i);
+        sample_ring_push(&impl->free_ring, i);
+    }
     
-    /* 初始化数据样本队列 */
-    impl->samples = (lwdistcomm_dds_sample_t *)malloc(sizeof(lwdistcomm_dds_sample_t) * MAX_SAMPLES);
-    impl->max_samples = MAX_SAMPLES;
-    impl->num_samples = 0;
-    impl->next_sample_index = 0;
+    /* 乱序缓存占用样本槽，窗口不超过样本槽数的一半 */
+    impl->reorder_window = (max_samples - 1) / 2 < LWDISTCOMM_DDS_REORDER_WINDOW ?
+                           (max_samples - 1) / 2 : LWDISTCOMM_DDS_REORDER_WINDOW;
+    
+    /* 有键主题分配实例表 */
+    impl->key_extract = options->topic->impl->key_extract;
+    impl->key_arg = options->topic->impl->key_arg;
+    if (impl->key_extract && !instances_init(impl)) {
+        free(impl->instance_index);
+        free(impl->instance_history);
+        free(impl->instances);
+        free(impl->ready_ring.cells);
+        free(impl->free_ring.cells);
+        free(impl->sample_slab);
+        free(impl->samples);
+        free(impl);
+        return NULL;
+    }
     
     /* 初始化互斥锁 */
     pthread_mutex_init(&impl->mutex, NULL);
     
-    /* 创建UDP套接字 */
-    impl->udp_socket = lwdistcomm_transport_create_udp_socket(LWDISTCOMM_ADDR_TYPE_IPV4, true);
-    if (impl->udp_socket >= 0) {
+    /* 创建UDP传输适配器 */
+    impl->transport = lwdistcomm_dds_transport_create(LWDISTCOMM_ADDR_TYPE_IPV4, true);
+    if (impl->transport) {
         /* 创建并设置地址 */
         lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_IPV4);
         if (addr) {
             if (lwdistcomm_address_set_ipv4(addr, "0.0.0.0", UDP_RECEIVE_PORT)) {
                 /* 绑定套接字 */
-                if (lwdistcomm_transport_bind(impl->udp_socket, addr)) {
+                if (lwdistcomm_dds_transport_bind(impl->transport, addr) == LWDISTCOMM_DDS_RETCODE_OK) {
+                    /* 记录实际绑定端口 */
+                    struct sockaddr_in bound;
+                    socklen_t bound_len = sizeof(bound);
+                    if (getsockname(impl->transport->udp_socket, (struct sockaddr *)&bound, &bound_len) == 0) {
+                        impl->port = ntohs(bound.sin_port);
+                    }
+                    
+                    /* 加入主题组播组，失败时仅接收单播 */
+                    lwdistcomm_dds_domain_participant_impl_t *participant_impl = options->topic->impl->participant->impl;
+                    lwdistcomm_dds_transport_multicast_addr(participant_impl->domain_id, (uint16_t)participant_impl->discovery_port,
+                                                            impl->topic_id, &impl->group);
+                    impl->multicast = lwdistcomm_dds_transport_join_multicast(impl->transport, &impl->group) == LWDISTCOMM_DDS_RETCODE_OK;
+                    
                     /* 启动接收线程 */
                     impl->receive_thread_running = true;
                     pthread_create(&impl->receive_thread, NULL, lwdistcomm_dds_data_reader_receive_thread, impl);
-                    printf("DataReader: UDP socket bound to port %d, receive thread started\n", UDP_RECEIVE_PORT);
+                    printf("DataReader: UDP socket bound to port %u, receive thread started\n", impl->port);
                 } else {
                     printf("DataReader: Failed to bind UDP socket to port %d\n", UDP_RECEIVE_PORT);
                 }
@@ -134,15 +1139,28 @@ void lwdistcomm_dds_data_reader_impl_destroy(lwdistcomm_dds_data_reader_impl_t *
         pthread_join(impl->receive_thread, NULL);
     }
     
-    /* 关闭UDP套接字 */
-    if (impl->udp_socket >= 0) {
-        lwdistcomm_transport_close(impl->udp_socket);
+    /* 销毁传输适配器 */
+    if (impl->transport) {
+        lwdistcomm_dds_transport_destroy(impl->transport);
     }
     
-    /* 释放数据样本 */
-    for (uint32_t i = 0; i < impl->num_samples; i++) {
-        free(impl->samples[i].data);
+    /* 释放重组缓冲区和样本持有的大样本 */
+    for (uint32_t i = 0; i < LWDISTCOMM_DDS_MAX_REASSEMBLIES; i++) {
+        if (impl->reassemblies[i].seqno) {
+            reassembly_drop(impl, &impl->reassemblies[i]);
+        }
     }
+    for (uint32_t i = 0; i < impl->max_samples; i++) {
+        release_sample(impl, i);
+    }
+    
+    /* 释放实例表和样本槽 */
+    free(impl->instance_index);
+    free(impl->instance_history);
+    free(impl->instances);
+    free(impl->free_ring.cells);
+    free(impl->ready_ring.cells);
+    free(impl->sample_slab);
     free(impl->samples);
     
     /* 销毁互斥锁 */
@@ -151,6 +1169,16 @@ void lwdistcomm_dds_data_reader_impl_destroy(lwdistcomm_dds_data_reader_impl_t *
     free(impl);
 }
 
+/**
+ * 获取内容过滤条件
+ */
+void lwdistcomm_dds_data_reader_impl_get_filter(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_content_filter_t *filter)
+{
+    pthread_mutex_lock(&impl->mutex);
+    *filter = impl->filter;
+    pthread_mutex_unlock(&impl->mutex);
+}
+
 /**
  * 添加数据样本到DataReader
  */
@@ -160,45 +1188,29 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_impl_add_sample(lwdistcomm_d
         return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
     }
     
-    pthread_mutex_lock(&impl->mutex);
-    
-    /* 检查样本队列是否已满 */
-    if (impl->num_samples >= impl->max_samples) {
-        /* 如果队列已满，移除最早的样本 */
-        free(impl->samples[impl->next_sample_index].data);
-        impl->num_samples--;
-    } else {
-        /* 否则，使用下一个可用位置 */
-        impl->next_sample_index = impl->num_samples;
+    if (size > impl->sample_size) {
+        return LWDISTCOMM_DDS_RETCODE_OUT_OF_RESOURCES;
     }
     
-    /* 添加新样本 */
-    impl->samples[impl->next_sample_index].data = malloc(size);
-    if (!impl->samples[impl->next_sample_index].data) {
-        pthread_mutex_unlock(&impl->mutex);
+    uint32_t index;
+    if (!lwdistcomm_dds_data_reader_impl_acquire_sample(impl, &index)) {
         return LWDISTCOMM_DDS_RETCODE_OUT_OF_RESOURCES;
     }
     
-    memcpy(impl->samples[impl->next_sample_index].data, data, size);
-    impl->samples[impl->next_sample_index].size = size;
+    /* 复制到样本槽 */
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    sample->data = sample_slot(impl, index);
+    memcpy(sample->data, data, size);
+    sample->size = size;
     
     if (info) {
-        memcpy(&impl->samples[impl->next_sample_index].info, info, sizeof(lwdistcomm_dds_sample_info_t));
+        memcpy(&sample->info, info, sizeof(lwdistcomm_dds_sample_info_t));
     } else {
-        memset(&impl->samples[impl->next_sample_index].info, 0, sizeof(lwdistcomm_dds_sample_info_t));
-        impl->samples[impl->next_sample_index].info.valid_data = true;
+        memset(&sample->info, 0, sizeof(lwdistcomm_dds_sample_info_t));
+        sample->info.valid_data = true;
     }
     
-    impl->num_samples++;
-    impl->next_sample_index = (impl->next_sample_index + 1) % impl->max_samples;
-    
-    /* 释放互斥锁，因为回调函数可能会调用take/read等需要获取互斥锁的函数 */
-    pthread_mutex_unlock(&impl->mutex);
-    
-    /* 调用数据可用回调 */
-    if (impl->data_available_cb && impl->reader) {
-        impl->data_available_cb(impl->reader, impl->data_available_arg);
-    }
+    lwdistcomm_dds_data_reader_impl_commit_sample(impl, index);
     
     return LWDISTCOMM_DDS_RETCODE_OK;
 }
@@ -251,6 +1263,9 @@ lwdistcomm_dds_data_reader_t *lwdistcomm_dds_data_reader_create(lwdistcomm_dds_s
         return NULL;
     }
     
+    /* 注册端点，更新匹配DataWriter的定位器 */
+    lwdistcomm_dds_domain_participant_impl_add_reader_endpoint(options->topic->impl->participant->impl, reader);
+    
     /* 启用DataReader */
     reader->impl->enabled = true;
     
@@ -272,6 +1287,9 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_delete(lwdistcomm_dds_data_r
     /* 禁用DataReader */
     reader->impl->enabled = false;
     
+    /* 注销端点，DataWriter不再向其发送 */
+    lwdistcomm_dds_domain_participant_impl_remove_reader_endpoint(topic->impl->participant->impl, reader);
+    
     /* 从Topic移除DataReader */
     lwdistcomm_dds_topic_impl_remove_data_reader(topic->impl, reader);
     
@@ -287,6 +1305,34 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_delete(lwdistcomm_dds_data_r
     return LWDISTCOMM_DDS_RETCODE_OK;
 }
 
+/**
+ * 最早的未取走样本，无键主题从就绪队列出队到held_sample，调用者持有impl->mutex
+ */
+static uint32_t oldest_sample(lwdistcomm_dds_data_reader_impl_t *impl)
+{
+    if (impl->instances) {
+        return impl->oldest_sample;
+    }
+    
+    if (impl->held_sample == LWDISTCOMM_DDS_SAMPLE_NONE && !sample_ring_pop(&impl->ready_ring, &impl->held_sample)) {
+        return LWDISTCOMM_DDS_SAMPLE_NONE;
+    }
+    
+    return impl->held_sample;
+}
+
+/**
+ * 移除oldest_sample返回的样本，调用者持有impl->mutex
+ */
+static void remove_oldest_sample(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t index)
+{
+    if (impl->instances) {
+        instance_pop(impl, impl->samples[index].info.instance_handle);
+    } else {
+        impl->held_sample = LWDISTCOMM_DDS_SAMPLE_NONE;
+    }
+}
+
 /**
  * 读取数据（非破坏性）
  */
@@ -300,33 +1346,35 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_read(lwdistcomm_dds_data_rea
         return LWDISTCOMM_DDS_RETCODE_NOT_ENABLED;
     }
     
-    pthread_mutex_lock(&reader->impl->mutex);
+    lwdistcomm_dds_data_reader_impl_t *impl = reader->impl;
     
-    if (reader->impl->num_samples == 0) {
-        pthread_mutex_unlock(&reader->impl->mutex);
+    pthread_mutex_lock(&impl->mutex);
+    
+    uint32_t index = oldest_sample(impl);
+    if (index == LWDISTCOMM_DDS_SAMPLE_NONE) {
+        pthread_mutex_unlock(&impl->mutex);
         return LWDISTCOMM_DDS_RETCODE_NO_DATA;
     }
     
-    /* 计算最早样本的索引 */
-    uint32_t oldest_index = (reader->impl->next_sample_index - reader->impl->num_samples + reader->impl->max_samples) % reader->impl->max_samples;
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
     
     /* 检查数据缓冲区大小 */
-    if (*size < reader->impl->samples[oldest_index].size) {
-        *size = reader->impl->samples[oldest_index].size;
-        pthread_mutex_unlock(&reader->impl->mutex);
+    if (*size < sample->size) {
+        *size = sample->size;
+        pthread_mutex_unlock(&impl->mutex);
         return LWDISTCOMM_DDS_RETCODE_ERROR;
     }
     
-    /* 复制数据 */
-    memcpy(data, reader->impl->samples[oldest_index].data, reader->impl->samples[oldest_index].size);
-    *size = reader->impl->samples[oldest_index].size;
+    /* 复制数据，样本保留供下次读取 */
+    memcpy(data, sample->data, sample->size);
+    *size = sample->size;
     
     /* 复制样本信息 */
     if (info) {
-        memcpy(info, &reader->impl->samples[oldest_index].info, sizeof(lwdistcomm_dds_sample_info_t));
+        memcpy(info, &sample->info, sizeof(lwdistcomm_dds_sample_info_t));
     }
     
-    pthread_mutex_unlock(&reader->impl->mutex);
+    pthread_mutex_unlock(&impl->mutex);
     
     return LWDISTCOMM_DDS_RETCODE_OK;
 }
@@ -344,37 +1392,111 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_take(lwdistcomm_dds_data_rea
         return LWDISTCOMM_DDS_RETCODE_NOT_ENABLED;
     }
     
-    pthread_mutex_lock(&reader->impl->mutex);
+    lwdistcomm_dds_data_reader_impl_t *impl = reader->impl;
     
-    if (reader->impl->num_samples == 0) {
-        pthread_mutex_unlock(&reader->impl->mutex);
+    pthread_mutex_lock(&impl->mutex);
+    
+    uint32_t index = oldest_sample(impl);
+    if (index == LWDISTCOMM_DDS_SAMPLE_NONE) {
+        pthread_mutex_unlock(&impl->mutex);
         return LWDISTCOMM_DDS_RETCODE_NO_DATA;
     }
     
-    /* 计算最早样本的索引 */
-    uint32_t oldest_index = (reader->impl->next_sample_index - reader->impl->num_samples + reader->impl->max_samples) % reader->impl->max_samples;
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
     
     /* 检查数据缓冲区大小 */
-    if (*size < reader->impl->samples[oldest_index].size) {
-        *size = reader->impl->samples[oldest_index].size;
-        pthread_mutex_unlock(&reader->impl->mutex);
+    if (*size < sample->size) {
+        *size = sample->size;
+        pthread_mutex_unlock(&impl->mutex);
         return LWDISTCOMM_DDS_RETCODE_ERROR;
     }
     
     /* 复制数据 */
-    memcpy(data, reader->impl->samples[oldest_index].data, reader->impl->samples[oldest_index].size);
-    *size = reader->impl->samples[oldest_index].size;
+    memcpy(data, sample->data, sample->size);
+    *size = sample->size;
     
     /* 复制样本信息 */
     if (info) {
-        memcpy(info, &reader->impl->samples[oldest_index].info, sizeof(lwdistcomm_dds_sample_info_t));
+        memcpy(info, &sample->info, sizeof(lwdistcomm_dds_sample_info_t));
     }
     
-    /* 移除样本 */
-    free(reader->impl->samples[oldest_index].data);
-    reader->impl->num_samples--;
+    /* 归还样本槽 */
+    remove_oldest_sample(impl, index);
+    release_sample(impl, index);
+    sample_ring_push(&impl->free_ring, index);
     
-    pthread_mutex_unlock(&reader->impl->mutex);
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 借出最早的样本（破坏性，无拷贝）
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_take_loan(lwdistcomm_dds_data_reader_t *reader, const void **data, uint32_t *size, lwdistcomm_dds_sample_info_t *info)
+{
+    if (!reader || !reader->impl || !data || !size) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    if (!reader->impl->enabled) {
+        return LWDISTCOMM_DDS_RETCODE_NOT_ENABLED;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *impl = reader->impl;
+    
+    pthread_mutex_lock(&impl->mutex);
+    
+    uint32_t index = oldest_sample(impl);
+    if (index == LWDISTCOMM_DDS_SAMPLE_NONE) {
+        pthread_mutex_unlock(&impl->mutex);
+        return LWDISTCOMM_DDS_RETCODE_NO_DATA;
+    }
+    
+    /* 借出的样本槽不在任何队列或实例中，归还前不会被接收线程覆盖 */
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    *data = sample->data;
+    *size = sample->size;
+    if (info) {
+        memcpy(info, &sample->info, sizeof(lwdistcomm_dds_sample_info_t));
+    }
+    remove_oldest_sample(impl, index);
+    
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 归还借出的样本
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_return_loan(lwdistcomm_dds_data_reader_t *reader, const void *data)
+{
+    if (!reader || !reader->impl || !data) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *impl = reader->impl;
+    const uint8_t *ptr = (const uint8_t *)data;
+    
+    uint32_t index;
+    
+    /* 由数据指针定位样本槽，重组的大样本不在样本槽内，按数据指针查找 */
+    if (ptr >= impl->sample_slab && ptr < impl->sample_slab + (size_t)impl->max_samples * impl->sample_size) {
+        index = (uint32_t)((size_t)(ptr - impl->sample_slab) / impl->sample_size);
+        if (ptr != impl->samples[index].data) {
+            return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+        }
+    } else {
+        for (index = 0; index < impl->max_samples && impl->samples[index].data != ptr; index++) {
+        }
+        if (index == impl->max_samples) {
+            return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+        }
+    }
+    
+    release_sample(impl, index);
+    sample_ring_push(&impl->free_ring, index);
     
     return LWDISTCOMM_DDS_RETCODE_OK;
 }
@@ -397,3 +1519,168 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_set_data_available_callback(
     
     return LWDISTCOMM_DDS_RETCODE_OK;
 }
+
+/**
+ * 查找键对应的实例句柄
+ */
+uint32_t lwdistcomm_dds_data_reader_lookup_instance(lwdistcomm_dds_data_reader_t *reader, const void *key, uint32_t key_len)
+{
+    if (!reader || !reader->impl || !reader->impl->instances || !key || !key_len || key_len > LWDISTCOMM_DDS_MAX_KEY_SIZE) {
+        return LWDISTCOMM_DDS_HANDLE_NIL;
+    }
+    
+    pthread_mutex_lock(&reader->impl->mutex);
+    uint32_t handle = find_instance(reader->impl, (const uint8_t *)key, key_len, false);
+    pthread_mutex_unlock(&reader->impl->mutex);
+    
+    return handle;
+}
+
+/**
+ * 读取实例最新的样本（非破坏性）
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_read_instance(lwdistcomm_dds_data_reader_t *reader, uint32_t handle, void *data, uint32_t *size, lwdistcomm_dds_sample_info_t *info)
+{
+    if (!reader || !reader->impl || !data || !size) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *impl = reader->impl;
+    if (!impl->instances) {
+        return LWDISTCOMM_DDS_RETCODE_PRECONDITION_NOT_MET;
+    }
+    
+    pthread_mutex_lock(&impl->mutex);
+    
+    if (handle == LWDISTCOMM_DDS_HANDLE_NIL || handle > impl->num_instances) {
+        pthread_mutex_unlock(&impl->mutex);
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    uint32_t index = instance_newest(impl, handle);
+    if (index == LWDISTCOMM_DDS_SAMPLE_NONE) {
+        pthread_mutex_unlock(&impl->mutex);
+        return LWDISTCOMM_DDS_RETCODE_NO_DATA;
+    }
+    
+    lwdistcomm_dds_sample_t *sample = &impl->samples[index];
+    if (*size < sample->size) {
+        *size = sample->size;
+        pthread_mutex_unlock(&impl->mutex);
+        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    memcpy(data, sample->data, sample->size);
+    *size = sample->size;
+    if (info) {
+        memcpy(info, &sample->info, sizeof(lwdistcomm_dds_sample_info_t));
+    }
+    
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 取走句柄大于previous的第一个有样本的实例的最早样本
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_take_next_instance(lwdistcomm_dds_data_reader_t *reader, uint32_t previous, void *data, uint32_t *size, lwdistcomm_dds_sample_info_t *info)
+{
+    if (!reader || !reader->impl || !data || !size) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *impl = reader->impl;
+    if (!impl->instances) {
+        return LWDISTCOMM_DDS_RETCODE_PRECONDITION_NOT_MET;
+    }
+    
+    pthread_mutex_lock(&impl->mutex);
+    
+    /* 句柄按实例创建顺序分配，遍历全部实例为O(实例数) */
+    uint32_t handle = previous + 1;
+    while (handle <= impl->num_instances && !impl->instances[handle - 1].count) {
+        handle++;
+    }
+    if (handle > impl->num_instances) {
+        pthread_mutex_unlock(&impl->mutex);
+        return LWDISTCOMM_DDS_RETCODE_NO_DATA;
+    }
+    
+    const lwdistcomm_dds_instance_t *instance = &impl->instances[handle - 1];
+    lwdistcomm_dds_sample_t *sample = &impl->samples[impl->instance_history[(size_t)(handle - 1) * impl->instance_depth + instance->head]];
+    if (*size < sample->size) {
+        *size = sample->size;
+        pthread_mutex_unlock(&impl->mutex);
+        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    uint32_t index = instance_pop(impl, handle);
+    memcpy(data, sample->data, sample->size);
+    *size = sample->size;
+    if (info) {
+        memcpy(info, &sample->info, sizeof(lwdistcomm_dds_sample_info_t));
+    }
+    release_sample(impl, index);
+    sample_ring_push(&impl->free_ring, index);
+    
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 设置分片样本重组的内存上限和超时
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_set_reassembly_limits(lwdistcomm_dds_data_reader_t *reader, uint32_t max_bytes, const lwdistcomm_dds_duration_t *timeout)
+{
+    if (!reader || !reader->impl) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    uint64_t timeout_us = timeout ? (uint64_t)timeout->sec * 1000000 + timeout->nanosec / 1000 : 0;
+    
+    __atomic_store_n(&reader->impl->reassembly_limit, max_bytes ? (uint64_t)max_bytes : LWDISTCOMM_DDS_DEFAULT_REASSEMBLY_LIMIT, __ATOMIC_RELAXED);
+    __atomic_store_n(&reader->impl->reassembly_timeout_us,
+                     timeout_us ? timeout_us : (uint64_t)LWDISTCOMM_DDS_DEFAULT_REASSEMBLY_TIMEOUT_SEC * 1000000, __ATOMIC_RELAXED);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 设置内容过滤条件
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_set_content_filter(lwdistcomm_dds_data_reader_t *reader, const lwdistcomm_dds_content_filter_t *filter)
+{
+    if (!reader || !reader->impl || !reader->topic) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    if (filter && (filter->num_prefixes > LWDISTCOMM_DDS_MAX_FILTER_PREFIXES ||
+                   (filter->has_range && !(filter->min_value <= filter->max_value)))) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *impl = reader->impl;
+    bool active = lwdistcomm_dds_content_filter_active(filter);
+    
+    pthread_mutex_lock(&impl->mutex);
+    if (active) {
+        impl->filter = *filter;
+    } else {
+        memset(&impl->filter, 0, sizeof(impl->filter));
+    }
+    __atomic_store_n(&impl->filtered, active, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&impl->mutex);
+    
+    /* 带过滤的DataReader退出主题组播组，DataWriter只单播通过过滤的样本；取消过滤后重新加入 */
+    if (impl->transport && impl->transport->multicast_socket >= 0 && impl->multicast == active &&
+        lwdistcomm_dds_transport_set_multicast_membership(impl->transport, &impl->group, !active) == LWDISTCOMM_DDS_RETCODE_OK) {
+        impl->multicast = !active;
+    }
+    
+    /* 更新本地DataWriter并经SPDP传播到远端DataWriter */
+    lwdistcomm_dds_domain_participant_impl_update_reader_endpoint(reader->topic->impl->participant->impl, reader);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
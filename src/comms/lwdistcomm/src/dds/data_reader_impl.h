@@ -3,6 +3,8 @@
 
 #include "../../include/dds/dds.h"
 #include "../../include/lwdistcomm.h"
+#include "dds_protocol.h"
+#include "dds_transport.h"
 #include <pthread.h>
 
 #ifdef __cplusplus
@@ -10,14 +12,91 @@ extern "C" {
 #endif
 
 /**
- * 数据样本结构
+ * 数据样本结构，data指向预分配样本槽，分片重组的大样本指向重组缓冲区，
+ * 有键主题的样本按到达顺序以prev/next链接
  */
 typedef struct {
     void *data;
     uint32_t size;
     lwdistcomm_dds_sample_info_t info;
+    uint32_t prev;
+    uint32_t next;
 } lwdistcomm_dds_sample_t;
 
+/**
+ * 无锁样本槽索引队列单元
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t index;
+} lwdistcomm_dds_sample_cell_t;
+
+/**
+ * 有界无锁样本槽索引队列（多生产者多消费者）
+ */
+typedef struct {
+    lwdistcomm_dds_sample_cell_t *cells;
+    uint32_t mask;
+    uint32_t enqueue_pos __attribute__((aligned(64)));
+    uint32_t dequeue_pos __attribute__((aligned(64)));
+} lwdistcomm_dds_sample_ring_t;
+
+/* 无样本槽 */
+#define LWDISTCOMM_DDS_SAMPLE_NONE  UINT32_MAX
+
+/* 可跟踪的DataWriter数量和乱序缓存窗口 */
+#define LWDISTCOMM_DDS_MAX_WRITER_PROXIES   32
+#define LWDISTCOMM_DDS_REORDER_WINDOW       64
+
+/**
+ * 远端DataWriter的接收状态，仅由接收线程访问
+ */
+typedef struct {
+    uint32_t participant_id;
+    uint32_t endpoint_id;
+    struct sockaddr_in addr;    /* ACKNACK目的地址 */
+    uint64_t next_seqno;        /* 下一个按序交付的序列号，0表示尚未收到数据 */
+    uint64_t highest_seqno;     /* 已知的最大序列号 */
+    uint64_t pending_mask;      /* 第i位表示next_seqno + i已缓存 */
+    uint64_t gap_mask;          /* 第i位表示next_seqno + i被DataWriter过滤，不再等待 */
+    uint32_t pending[LWDISTCOMM_DDS_REORDER_WINDOW];
+    uint32_t lost;              /* 尚未通过sample_info报告的丢失样本数 */
+} lwdistcomm_dds_writer_proxy_t;
+
+/* 同时重组的分片样本数 */
+#define LWDISTCOMM_DDS_MAX_REASSEMBLIES     8
+
+/**
+ * 分片样本的重组状态，仅由接收线程访问
+ */
+typedef struct {
+    uint32_t participant_id;
+    uint32_t endpoint_id;
+    uint64_t seqno;             /* 0表示空闲 */
+    uint8_t *data;
+    uint64_t *frag_mask;        /* 第i位表示分片i已收到 */
+    uint32_t size;
+    uint32_t num_frags;
+    uint32_t received;
+    uint32_t nacked;            /* 上次发送NACK_FRAG时已收到的分片数 */
+    uint64_t deadline_us;       /* 超过该时刻仍无新分片到达则放弃 */
+    uint64_t nack_us;           /* 上次发送NACK_FRAG的时刻 */
+} lwdistcomm_dds_reassembly_t;
+
+/* 实例数上限 */
+#define LWDISTCOMM_DDS_MAX_INSTANCES        65536
+
+/**
+ * 有键主题的实例，保存最近instance_depth个样本的样本槽索引，句柄为实例表下标加1
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t key_len;
+    uint32_t head;              /* 最早样本在实例历史中的位置 */
+    uint32_t count;
+    uint8_t key[LWDISTCOMM_DDS_MAX_KEY_SIZE];
+} lwdistcomm_dds_instance_t;
+
 /**
  * DataReader内部实现结构
  */
@@ -35,17 +114,62 @@ struct lwdistcomm_dds_data_reader_impl_s {
     lwdistcomm_dds_data_available_cb_t data_available_cb;
     void *data_available_arg;
     
-    /* 数据样本队列 */
+    /* 预分配样本槽，数量由resource_limits.max_samples决定 */
     lwdistcomm_dds_sample_t *samples;
-    uint32_t num_samples;
+    uint8_t *sample_slab;
     uint32_t max_samples;
-    uint32_t next_sample_index;
+    uint32_t sample_size;
+    
+    /* 空闲槽队列和就绪样本队列，接收线程不持有互斥锁 */
+    lwdistcomm_dds_sample_ring_t free_ring;
+    lwdistcomm_dds_sample_ring_t ready_ring;
     
-    /* 互斥锁 */
+    /* 已出队但未取走的最早样本，受互斥锁保护 */
+    uint32_t held_sample;
+    
+    /* 因队列满被覆盖或丢弃的样本数 */
+    uint64_t lost_samples;
+    
+    /* 互斥锁，仅串行化读取方 */
     pthread_mutex_t mutex;
     
+    /* 有键主题按实例保存样本，不经过就绪队列，受互斥锁保护 */
+    lwdistcomm_dds_key_extract_cb_t key_extract;
+    void *key_arg;
+    lwdistcomm_dds_instance_t *instances;
+    uint32_t *instance_history;     /* 每个实例instance_depth个样本槽索引 */
+    uint32_t *instance_index;       /* 键哈希开放寻址表，保存实例句柄 */
+    uint32_t index_mask;
+    uint32_t num_instances;
+    uint32_t max_instances;
+    uint32_t instance_depth;
+    bool instance_keep_all;         /* KEEP_ALL时实例历史满则拒绝新样本 */
+    uint32_t oldest_sample;         /* 按到达顺序的样本链表 */
+    uint32_t newest_sample;
+    
+    /* 内容过滤条件，由DataWriter求值；从其他途径到达的样本在提交时再次过滤，受互斥锁保护 */
+    lwdistcomm_dds_content_filter_t filter;
+    bool filtered;
+    
+    /* 远端DataWriter状态，RELIABLE时乱序样本在窗口内等待重传补齐 */
+    lwdistcomm_dds_writer_proxy_t writer_proxies[LWDISTCOMM_DDS_MAX_WRITER_PROXIES];
+    uint32_t num_writer_proxies;
+    uint32_t reorder_window;
+    
+    /* 分片重组，重组中和未取走的大样本占用的内存不超过reassembly_limit */
+    lwdistcomm_dds_reassembly_t reassemblies[LWDISTCOMM_DDS_MAX_REASSEMBLIES];
+    uint64_t reassembly_limit;
+    uint64_t reassembly_timeout_us;
+    uint64_t fragment_bytes;
+    
     /* 网络接收 */
-    int udp_socket;
+    lwdistcomm_dds_transport_t *transport;
+    uint16_t port;
+    uint32_t participant_id;
+    uint32_t endpoint_id;
+    uint32_t topic_id;
+    bool multicast;             /* 已加入主题组播组 */
+    struct sockaddr_in group;
     pthread_t receive_thread;
     bool receive_thread_running;
 };
@@ -65,6 +189,21 @@ void lwdistcomm_dds_data_reader_impl_destroy(lwdistcomm_dds_data_reader_impl_t *
  */
 lwdistcomm_dds_retcode_t lwdistcomm_dds_data_reader_impl_add_sample(lwdistcomm_dds_data_reader_impl_t *impl, const void *data, uint32_t size, const lwdistcomm_dds_sample_info_t *info);
 
+/**
+ * 分配空闲样本槽，无空闲槽时覆盖最早的就绪样本
+ */
+bool lwdistcomm_dds_data_reader_impl_acquire_sample(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t *index);
+
+/**
+ * 提交已填充的样本槽并通知数据可用
+ */
+void lwdistcomm_dds_data_reader_impl_commit_sample(lwdistcomm_dds_data_reader_impl_t *impl, uint32_t index);
+
+/**
+ * 获取内容过滤条件，未设置时返回空条件
+ */
+void lwdistcomm_dds_data_reader_impl_get_filter(lwdistcomm_dds_data_reader_impl_t *impl, lwdistcomm_dds_content_filter_t *filter);
+
 /**
  * 数据接收线程函数
  */
@@ -1,22 +1,45 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "data_writer_impl.h"
 #include "publisher_impl.h"
 #include "topic_impl.h"
+#include "domain_participant_impl.h"
+#include "dds_protocol.h"
 #include "../../include/dds/dds.h"
 #include "../../include/lwdistcomm.h"
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
 #include <pthread.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <arpa/inet.h>
+
+#define MAX_MATCHED_READERS 64
+#define MAX_HISTORY_DEPTH 65536
+#define HEARTBEAT_PERIOD_US 100000
+#define ACKNACK_BATCH 16
+#define FRAGMENT_BATCH 32
+
+/* 至少有这么多DataReader加入组播组时才使用组播 */
+#define MULTICAST_MIN_READERS 2
 
-/* DDS transport functions declarations */
-extern lwdistcomm_dds_transport_t *lwdistcomm_dds_transport_create(lwdistcomm_addr_type_t type, bool non_blocking);
-extern void lwdistcomm_dds_transport_destroy(lwdistcomm_dds_transport_t *transport);
-extern lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_send(lwdistcomm_dds_transport_t *transport, const void *data, uint32_t size, const lwdistcomm_address_t *addr);
+/* 历史缓存中每个样本记录的缓冲区大小 */
+#define HISTORY_ENTRY_SIZE lwdistcomm_dds_record_len(LWDISTCOMM_DDS_MAX_RECORD_SIZE)
 
-/* Transport functions declarations */
-extern int lwdistcomm_transport_create_udp_socket(lwdistcomm_addr_type_t type, bool non_blocking);
-extern lwdistcomm_address_t *lwdistcomm_address_create(lwdistcomm_addr_type_t type);
-extern bool lwdistcomm_address_set_ipv4(lwdistcomm_address_t *addr, const char *ip, uint16_t port);
-extern void lwdistcomm_address_destroy(lwdistcomm_address_t *addr);
+/**
+ * DataReader发送的控制报文
+ */
+typedef union {
+    lwdistcomm_dds_msg_header_t header;
+    lwdistcomm_dds_acknack_msg_t acknack;
+    lwdistcomm_dds_nack_frag_msg_t nack_frag;
+} control_msg_t;
 
 /**
  * 创建DataWriter内部实现
@@ -38,11 +61,53 @@ lwdistcomm_dds_data_writer_impl_t *lwdistcomm_dds_data_writer_impl_create(const
     impl->topic = options->topic;
     impl->matched_readers = 0;
     
+    /* 初始化定位器列表 */
+    impl->locators = (lwdistcomm_dds_locator_t *)malloc(sizeof(lwdistcomm_dds_locator_t) * MAX_MATCHED_READERS);
+    if (!impl->locators) {
+        free(impl);
+        return NULL;
+    }
+    impl->max_locators = MAX_MATCHED_READERS;
+    
+    /* 主题组播地址 */
+    lwdistcomm_dds_domain_participant_impl_t *participant_impl = options->topic->impl->participant->impl;
+    impl->topic_id = lwdistcomm_dds_topic_id(options->topic->impl->name);
+    lwdistcomm_dds_transport_multicast_addr(participant_impl->domain_id, (uint16_t)participant_impl->discovery_port,
+                                            impl->topic_id, &impl->group);
+    
+    /* 可靠传输按history策略预分配历史缓存 */
+    if (impl->qos.reliability.kind == LWDISTCOMM_DDS_RELIABILITY_RELIABLE) {
+        uint32_t depth = impl->qos.history.kind == LWDISTCOMM_DDS_HISTORY_KEEP_ALL ?
+                         impl->qos.resource_limits.max_samples : impl->qos.history.depth;
+        if (depth == 0) {
+            depth = 1;
+        } else if (depth > MAX_HISTORY_DEPTH) {
+            depth = MAX_HISTORY_DEPTH;
+        }
+        
+        impl->history.depth = depth;
+        impl->history.slab = (uint8_t *)malloc((size_t)depth * HISTORY_ENTRY_SIZE);
+        impl->history.lengths = (uint32_t *)calloc(depth, sizeof(uint32_t));
+        impl->history.large = (void **)calloc(depth, sizeof(void *));
+        if (!impl->history.slab || !impl->history.lengths || !impl->history.large) {
+            free(impl->history.slab);
+            free(impl->history.lengths);
+            free(impl->history.large);
+            free(impl->locators);
+            free(impl);
+            return NULL;
+        }
+    }
+    
     /* 创建传输适配器 */
     impl->transport = lwdistcomm_dds_transport_create(LWDISTCOMM_ADDR_TYPE_IPV4, true);
     
+    /* 事件线程唤醒通知 */
+    impl->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    
     /* 初始化互斥锁 */
     pthread_mutex_init(&impl->mutex, NULL);
+    pthread_cond_init(&impl->history_cond, NULL);
     
     return impl;
 }
@@ -56,17 +121,815 @@ void lwdistcomm_dds_data_writer_impl_destroy(lwdistcomm_dds_data_writer_impl_t *
         return;
     }
     
+    /* 停止事件线程 */
+    if (impl->event_thread_running) {
+        uint64_t val = 1;
+        impl->event_thread_running = false;
+        if (write(impl->wake_fd, &val, sizeof(val)) < 0) {
+            /* 事件线程最迟在下一个心跳周期退出 */
+        }
+        pthread_join(impl->event_thread, NULL);
+    }
+    
+    if (impl->wake_fd >= 0) {
+        close(impl->wake_fd);
+    }
+    
     /* 销毁传输适配器 */
     if (impl->transport) {
         lwdistcomm_dds_transport_destroy(impl->transport);
     }
     
+    /* 释放定位器列表和历史缓存 */
+    for (uint32_t i = 0; i < impl->matched_readers; i++) {
+        free(impl->locators[i].filter);
+    }
+    for (uint32_t i = 0; i < impl->history.depth; i++) {
+        free(impl->history.large[i]);
+    }
+    free(impl->locators);
+    free(impl->history.slab);
+    free(impl->history.lengths);
+    free(impl->history.large);
+    
     /* 销毁互斥锁 */
+    pthread_cond_destroy(&impl->history_cond);
     pthread_mutex_destroy(&impl->mutex);
     
     free(impl);
 }
 
+/**
+ * 获取单调时钟微秒数
+ */
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * 历史缓存中序列号对应的样本记录
+ */
+static inline uint8_t *history_entry(lwdistcomm_dds_history_t *history, uint64_t seqno)
+{
+    return history->slab + (size_t)(seqno % history->depth) * HISTORY_ENTRY_SIZE;
+}
+
+/**
+ * 填充本DataWriter的DATA或DATA_FRAG报文头
+ */
+static void init_data_header(lwdistcomm_dds_data_writer_impl_t *impl, lwdistcomm_dds_msg_header_t *header, uint8_t kind)
+{
+    lwdistcomm_dds_msg_init_header(header, kind, impl->history.depth ? LWDISTCOMM_DDS_MSG_FLAG_RELIABLE : 0,
+                                   impl->participant_id, impl->endpoint_id, impl->topic_id);
+}
+
+/**
+ * 发送到全部已匹配DataReader时使用的组播组，加入组播组的DataReader不足时返回NULL，调用者持有impl->mutex
+ */
+static const struct sockaddr_in *reader_group(lwdistcomm_dds_data_writer_impl_t *impl)
+{
+    return impl->multicast_readers >= MULTICAST_MIN_READERS ? &impl->group : NULL;
+}
+
+/**
+ * 发送报文到addr，addr为NULL时发送到所有不带内容过滤的DataReader，调用者持有impl->mutex
+ */
+static lwdistcomm_dds_retcode_t send_to_readers(lwdistcomm_dds_data_writer_impl_t *impl, const struct iovec *iov, int iovcnt, uint32_t nmsgs, const struct sockaddr_in *addr)
+{
+    if (addr) {
+        lwdistcomm_dds_locator_t target;
+        memset(&target, 0, sizeof(target));
+        target.addr = *addr;
+        return lwdistcomm_dds_transport_send_locators(impl->transport, iov, iovcnt, nmsgs, &target, 1, NULL);
+    }
+    
+    return lwdistcomm_dds_transport_send_locators(impl->transport, iov, iovcnt, nmsgs, impl->locators, impl->unfiltered_readers, reader_group(impl));
+}
+
+/**
+ * 已发送的最大序列号，打包缓冲区中的样本尚未发送，调用者持有impl->mutex
+ */
+static uint64_t last_sent_seqno(lwdistcomm_dds_data_writer_impl_t *impl)
+{
+    return impl->batch_len ? impl->batch_first_seqno - 1 : impl->last_seqno;
+}
+
+/**
+ * 发送打包缓冲区中的样本，调用者持有impl->mutex
+ */
+static lwdistcomm_dds_retcode_t batch_flush(lwdistcomm_dds_data_writer_impl_t *impl)
+{
+    if (!impl->batch_len) {
+        return LWDISTCOMM_DDS_RETCODE_OK;
+    }
+    
+    struct iovec iov = { impl->batch_buf, impl->batch_len };
+    init_data_header(impl, (lwdistcomm_dds_msg_header_t *)impl->batch_buf, LWDISTCOMM_DDS_MSG_DATA);
+    impl->batch_len = 0;
+    
+    return send_to_readers(impl, &iov, 1, 1, NULL);
+}
+
+/**
+ * 追加样本记录到打包缓冲区，缓冲区放不下时先发送，调用者持有impl->mutex
+ */
+static lwdistcomm_dds_retcode_t batch_append(lwdistcomm_dds_data_writer_impl_t *impl, const lwdistcomm_dds_data_record_t *record, const void *data, uint32_t size)
+{
+    lwdistcomm_dds_retcode_t ret = LWDISTCOMM_DDS_RETCODE_OK;
+    size_t record_len = lwdistcomm_dds_record_len(size);
+    
+    if (impl->batch_len && impl->batch_len + record_len > sizeof(impl->batch_buf)) {
+        ret = batch_flush(impl);
+    }
+    
+    if (!impl->batch_len) {
+        /* 第一个样本决定发送期限，唤醒事件线程重新计算超时 */
+        uint64_t val = 1;
+        impl->batch_len = sizeof(lwdistcomm_dds_msg_header_t);
+        impl->batch_first_seqno = be64toh(record->seqno);
+        impl->batch_deadline_us = monotonic_us() + impl->batch_delay_us;
+        if (write(impl->wake_fd, &val, sizeof(val)) < 0) {
+            /* 计数器溢出时事件线程已处于待唤醒状态 */
+        }
+    }
+    
+    uint8_t *dst = impl->batch_buf + impl->batch_len;
+    memcpy(dst, record, sizeof(*record));
+    memcpy(dst + sizeof(*record), data, size);
+    memset(dst + sizeof(*record) + size, 0, record_len - sizeof(*record) - size);
+    impl->batch_len += (uint32_t)record_len;
+    
+    return ret;
+}
+
+/**
+ * 重排定位器使不带过滤的定位器在前，并重新统计其中加入组播组的DataReader，调用者持有impl->mutex
+ */
+static void partition_locators(lwdistcomm_dds_data_writer_impl_t *impl)
+{
+    uint32_t unfiltered = 0;
+    
+    impl->multicast_readers = 0;
+    for (uint32_t i = 0; i < impl->matched_readers; i++) {
+        if (impl->locators[i].filter) {
+            continue;
+        }
+        if (impl->locators[i].multicast) {
+            impl->multicast_readers++;
+        }
+        if (i != unfiltered) {
+            lwdistcomm_dds_locator_t tmp = impl->locators[unfiltered];
+            impl->locators[unfiltered] = impl->locators[i];
+            impl->locators[i] = tmp;
+        }
+        unfiltered++;
+    }
+    
+    impl->unfiltered_readers = unfiltered;
+}
+
+/**
+ * 填充GAP报文，[gap_start, base)及bitmap中的序列号不发送给目标DataReader
+ */
+static void init_gap(lwdistcomm_dds_data_writer_impl_t *impl, lwdistcomm_dds_gap_msg_t *msg, uint64_t gap_start, uint64_t base, uint32_t num_bits, uint64_t bitmap)
+{
+    lwdistcomm_dds_msg_init_header(&msg->header, LWDISTCOMM_DDS_MSG_GAP, impl->history.depth ? LWDISTCOMM_DDS_MSG_FLAG_RELIABLE : 0,
+                                   impl->participant_id, impl->endpoint_id, impl->topic_id);
+    msg->gap_start = htobe64(gap_start);
+    msg->base_seqno = htobe64(base);
+    msg->num_bits = htonl(num_bits);
+    msg->reserved = 0;
+    msg->bitmap = htobe64(bitmap);
+}
+
+/**
+ * 添加已匹配DataReader的定位器
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_impl_add_locator(lwdistcomm_dds_data_writer_impl_t *impl, uint32_t participant_id, uint32_t endpoint_id, const char *ip, uint16_t port,
+                                                                    bool multicast, const lwdistcomm_dds_content_filter_t *filter)
+{
+    if (!impl || !ip || port == 0) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    /* 发现时解析一次地址，写入路径直接使用 */
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_content_filter_t *copy = NULL;
+    if (lwdistcomm_dds_content_filter_active(filter)) {
+        copy = (lwdistcomm_dds_content_filter_t *)malloc(sizeof(*copy));
+        if (!copy) {
+            return LWDISTCOMM_DDS_RETCODE_OUT_OF_RESOURCES;
+        }
+        *copy = *filter;
+    }
+    
+    pthread_mutex_lock(&impl->mutex);
+    
+    for (uint32_t i = 0; i < impl->matched_readers; i++) {
+        lwdistcomm_dds_locator_t *locator = &impl->locators[i];
+        if (locator->participant_id == participant_id && locator->endpoint_id == endpoint_id) {
+            if (!locator->filter != !copy) {
+                /* 打包中的样本按原分组发送，新分组从下一个序列号开始 */
+                batch_flush(impl);
+                if (locator->filter) {
+                    /* 取消过滤前未发送的样本仍按旧条件跳过 */
+                    lwdistcomm_dds_gap_msg_t gap;
+                    struct iovec iov = { &gap, sizeof(gap) };
+                    if (locator->sent_seqno < impl->last_seqno) {
+                        init_gap(impl, &gap, locator->sent_seqno + 1, impl->last_seqno + 1, 0, 0);
+                        lwdistcomm_dds_transport_send_addr(impl->transport, &iov, 1, &locator->addr);
+                    }
+                } else {
+                    locator->sent_seqno = impl->last_seqno;
+                }
+            }
+            free(locator->filter);
+            locator->filter = copy;
+            locator->addr = addr;
+            locator->multicast = multicast;
+            partition_locators(impl);
+            pthread_mutex_unlock(&impl->mutex);
+            return LWDISTCOMM_DDS_RETCODE_OK;
+        }
+    }
+    
+    if (impl->matched_readers >= impl->max_locators) {
+        pthread_mutex_unlock(&impl->mutex);
+        free(copy);
+        return LWDISTCOMM_DDS_RETCODE_OUT_OF_RESOURCES;
+    }
+    
+    lwdistcomm_dds_locator_t *locator = &impl->locators[impl->matched_readers];
+    locator->participant_id = participant_id;
+    locator->endpoint_id = endpoint_id;
+    locator->addr = addr;
+    locator->acked_seqno = 0;
+    locator->multicast = multicast;
+    locator->filter = copy;
+    locator->sent_seqno = impl->last_seqno;
+    impl->matched_readers++;
+    partition_locators(impl);
+    
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 移除已匹配DataReader的定位器
+ */
+void lwdistcomm_dds_data_writer_impl_remove_locator(lwdistcomm_dds_data_writer_impl_t *impl, uint32_t participant_id, uint32_t endpoint_id)
+{
+    if (!impl) {
+        return;
+    }
+    
+    pthread_mutex_lock(&impl->mutex);
+    
+    for (uint32_t i = 0; i < impl->matched_readers; i++) {
+        if (impl->locators[i].participant_id == participant_id && impl->locators[i].endpoint_id == endpoint_id) {
+            free(impl->locators[i].filter);
+            impl->matched_readers--;
+            if (i < impl->matched_readers) {
+                impl->locators[i] = impl->locators[impl->matched_readers];
+            }
+            partition_locators(impl);
+            /* 被移除的DataReader不再阻塞KEEP_ALL写入 */
+            pthread_cond_broadcast(&impl->history_cond);
+            break;
+        }
+    }
+    
+    pthread_mutex_unlock(&impl->mutex);
+}
+
+/**
+ * 检查最早的历史样本是否已被所有已匹配DataReader确认，调用者持有impl->mutex
+ */
+static bool history_oldest_acked(lwdistcomm_dds_data_writer_impl_t *impl)
+{
+    for (uint32_t i = 0; i < impl->matched_readers; i++) {
+        if (impl->locators[i].acked_seqno < impl->history.first_seqno) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * 发送心跳，addr为NULL时发送到所有定位器，调用者持有impl->mutex
+ */
+static void send_heartbeat(lwdistcomm_dds_data_writer_impl_t *impl, const struct sockaddr_in *addr)
+{
+    lwdistcomm_dds_heartbeat_msg_t msg;
+    struct iovec iov = { &msg, sizeof(msg) };
+    
+    if (!impl->history.count || (!addr && !impl->matched_readers)) {
+        return;
+    }
+    
+    /* 心跳之前发送打包中的样本，心跳范围只包含已发送的样本 */
+    if (!addr) {
+        batch_flush(impl);
+    }
+    
+    uint64_t last_seqno = last_sent_seqno(impl);
+    if (last_seqno < impl->history.first_seqno) {
+        return;
+    }
+    
+    lwdistcomm_dds_msg_init_header(&msg.header, LWDISTCOMM_DDS_MSG_HEARTBEAT, LWDISTCOMM_DDS_MSG_FLAG_RELIABLE,
+                                   impl->participant_id, impl->endpoint_id, impl->topic_id);
+    msg.first_seqno = htobe64(impl->history.first_seqno);
+    msg.last_seqno = htobe64(last_seqno);
+    
+    send_to_readers(impl, &iov, 1, 1, addr);
+    
+    /* 带过滤的DataReader据心跳请求尾部缺失的序列号，未通过过滤的以GAP答复 */
+    if (!addr && impl->matched_readers > impl->unfiltered_readers) {
+        lwdistcomm_dds_transport_send_locators(impl->transport, &iov, 1, 1, impl->locators + impl->unfiltered_readers,
+                                               impl->matched_readers - impl->unfiltered_readers, NULL);
+    }
+}
+
+/**
+ * 发送大样本中[base, base + num_bits)范围内的分片，mask非NULL时只发送对应位为1的分片，
+ * addr为NULL时发送到所有已匹配DataReader，调用者持有impl->mutex
+ */
+static lwdistcomm_dds_retcode_t send_fragments(lwdistcomm_dds_data_writer_impl_t *impl, uint64_t seqno, const uint8_t *data, uint32_t size,
+                                               uint32_t base, uint32_t num_bits, const uint64_t *mask, const struct sockaddr_in *addr)
+{
+    lwdistcomm_dds_msg_header_t header;
+    lwdistcomm_dds_data_frag_t frags[FRAGMENT_BATCH];
+    struct iovec iov[3 * FRAGMENT_BATCH];
+    lwdistcomm_dds_retcode_t ret = LWDISTCOMM_DDS_RETCODE_OK;
+    uint32_t num_frags = lwdistcomm_dds_fragment_count(size);
+    uint32_t n = 0;
+    
+    if (base >= num_frags) {
+        return LWDISTCOMM_DDS_RETCODE_OK;
+    }
+    
+    uint32_t end = num_frags - base < num_bits ? num_frags : base + num_bits;
+    init_data_header(impl, &header, LWDISTCOMM_DDS_MSG_DATA_FRAG);
+    
+    /* 每个分片由共用的报文头、分片头和样本中的负载组成，不复制负载 */
+    for (uint32_t i = base; i < end; i++) {
+        if (mask && !(mask[(i - base) / 64] & ((uint64_t)1 << ((i - base) % 64)))) {
+            continue;
+        }
+        
+        uint32_t offset = i * (uint32_t)LWDISTCOMM_DDS_FRAGMENT_SIZE;
+        uint32_t len = size - offset < LWDISTCOMM_DDS_FRAGMENT_SIZE ? size - offset : (uint32_t)LWDISTCOMM_DDS_FRAGMENT_SIZE;
+        
+        frags[n].seqno = htobe64(seqno);
+        frags[n].sample_size = htonl(size);
+        frags[n].offset = htonl(offset);
+        iov[3 * n].iov_base = &header;
+        iov[3 * n].iov_len = sizeof(header);
+        iov[3 * n + 1].iov_base = &frags[n];
+        iov[3 * n + 1].iov_len = sizeof(frags[n]);
+        iov[3 * n + 2].iov_base = (void *)(data + offset);
+        iov[3 * n + 2].iov_len = len;
+        
+        if (++n == FRAGMENT_BATCH) {
+            if (send_to_readers(impl, iov, 3, n, addr) != LWDISTCOMM_DDS_RETCODE_OK) {
+                ret = LWDISTCOMM_DDS_RETCODE_ERROR;
+            }
+            n = 0;
+        }
+    }
+    
+    if (n && send_to_readers(impl, iov, 3, n, addr) != LWDISTCOMM_DDS_RETCODE_OK) {
+        ret = LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    return ret;
+}
+
+/**
+ * 历史缓存中分片发送的大样本，不存在时返回NULL，调用者持有impl->mutex
+ */
+static const uint8_t *history_large(lwdistcomm_dds_data_writer_impl_t *impl, uint64_t seqno, uint32_t *size)
+{
+    lwdistcomm_dds_history_t *history = &impl->history;
+    lwdistcomm_dds_data_record_t record;
+    
+    if (!history->depth || !history->count || seqno < history->first_seqno || seqno > last_sent_seqno(impl) ||
+        history->lengths[seqno % history->depth] || !history->large[seqno % history->depth]) {
+        return NULL;
+    }
+    
+    memcpy(&record, history_entry(history, seqno), sizeof(record));
+    *size = ntohl(record.length);
+    
+    return (const uint8_t *)history->large[seqno % history->depth];
+}
+
+/**
+ * 发送样本到过滤条件匹配的DataReader，此前未发送给该DataReader的序列号以GAP告知，
+ * GAP与DATA一次批量发送，调用者持有impl->mutex
+ */
+static void send_filtered(lwdistcomm_dds_data_writer_impl_t *impl, const lwdistcomm_dds_data_record_t *record, const void *data, uint32_t size)
+{
+    lwdistcomm_dds_topic_impl_t *topic = impl->topic->impl;
+    uint64_t seqno = be64toh(record->seqno);
+    bool fragmented = size > LWDISTCOMM_DDS_MAX_RECORD_SIZE;
+    lwdistcomm_dds_msg_header_t header;
+    lwdistcomm_dds_gap_msg_t gaps[MAX_MATCHED_READERS];
+    struct iovec iov[4 * MAX_MATCHED_READERS];
+    struct mmsghdr msgs[2 * MAX_MATCHED_READERS];
+    uint32_t matched[MAX_MATCHED_READERS];
+    uint32_t nmatched = 0, nmsgs = 0, niov = 0;
+    
+    init_data_header(impl, &header, LWDISTCOMM_DDS_MSG_DATA);
+    
+    for (uint32_t i = impl->unfiltered_readers; i < impl->matched_readers && nmatched < MAX_MATCHED_READERS; i++) {
+        lwdistcomm_dds_locator_t *locator = &impl->locators[i];
+        if (!lwdistcomm_dds_topic_impl_filter_match(topic, locator->filter, data, size)) {
+            continue;
+        }
+        
+        if (locator->sent_seqno + 1 < seqno) {
+            init_gap(impl, &gaps[nmatched], locator->sent_seqno + 1, seqno, 0, 0);
+            memset(&msgs[nmsgs], 0, sizeof(msgs[nmsgs]));
+            msgs[nmsgs].msg_hdr.msg_name = &locator->addr;
+            msgs[nmsgs].msg_hdr.msg_namelen = sizeof(locator->addr);
+            msgs[nmsgs].msg_hdr.msg_iov = &iov[niov];
+            msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+            iov[niov].iov_base = &gaps[nmatched];
+            iov[niov].iov_len = sizeof(gaps[nmatched]);
+            niov++;
+            nmsgs++;
+        }
+        locator->sent_seqno = seqno;
+        matched[nmatched++] = i;
+        
+        if (fragmented) {
+            continue;
+        }
+        
+        memset(&msgs[nmsgs], 0, sizeof(msgs[nmsgs]));
+        msgs[nmsgs].msg_hdr.msg_name = &locator->addr;
+        msgs[nmsgs].msg_hdr.msg_namelen = sizeof(locator->addr);
+        msgs[nmsgs].msg_hdr.msg_iov = &iov[niov];
+        msgs[nmsgs].msg_hdr.msg_iovlen = 3;
+        iov[niov].iov_base = &header;
+        iov[niov].iov_len = sizeof(header);
+        iov[niov + 1].iov_base = (void *)record;
+        iov[niov + 1].iov_len = sizeof(*record);
+        iov[niov + 2].iov_base = (void *)data;
+        iov[niov + 2].iov_len = size;
+        niov += 3;
+        nmsgs++;
+    }
+    
+    if (nmsgs) {
+        lwdistcomm_dds_transport_send_batch(impl->transport, msgs, nmsgs);
+    }
+    
+    for (uint32_t i = 0; fragmented && i < nmatched; i++) {
+        send_fragments(impl, seqno, (const uint8_t *)data, size, 0, lwdistcomm_dds_fragment_count(size), NULL, &impl->locators[matched[i]].addr);
+    }
+}
+
+/**
+ * 历史缓存中的样本是否通过DataReader的过滤条件，调用者持有impl->mutex
+ */
+static bool history_filter_match(lwdistcomm_dds_data_writer_impl_t *impl, const lwdistcomm_dds_locator_t *locator, uint64_t seqno)
+{
+    uint32_t record_len = impl->history.lengths[seqno % impl->history.depth];
+    const uint8_t *data;
+    uint32_t size;
+    
+    if (record_len) {
+        lwdistcomm_dds_data_record_t record;
+        memcpy(&record, history_entry(&impl->history, seqno), sizeof(record));
+        data = history_entry(&impl->history, seqno) + sizeof(record);
+        size = ntohl(record.length);
+    } else {
+        data = history_large(impl, seqno, &size);
+        if (!data) {
+            return true;
+        }
+    }
+    
+    return lwdistcomm_dds_topic_impl_filter_match(impl->topic->impl, locator->filter, data, size);
+}
+
+/**
+ * 处理DataReader的ACKNACK，更新确认位置并重传缺失样本，调用者持有impl->mutex
+ */
+static void process_acknack(lwdistcomm_dds_data_writer_impl_t *impl, const lwdistcomm_dds_acknack_msg_t *msg, const struct sockaddr_in *from)
+{
+    if (ntohl(msg->writer_id) != impl->endpoint_id) {
+        return;
+    }
+    
+    uint32_t participant_id = ntohl(msg->header.participant_id);
+    uint32_t endpoint_id = ntohl(msg->header.endpoint_id);
+    uint64_t base = be64toh(msg->base_seqno);
+    uint64_t bitmap = be64toh(msg->bitmap);
+    uint32_t num_bits = ntohl(msg->num_bits);
+    uint64_t last_seqno = last_sent_seqno(impl);
+    const lwdistcomm_dds_locator_t *reader = NULL;
+    uint64_t gap_bitmap = 0;
+    bool skipped = false;
+    
+    if (num_bits > LWDISTCOMM_DDS_ACKNACK_BITS) {
+        num_bits = LWDISTCOMM_DDS_ACKNACK_BITS;
+    }
+    
+    for (uint32_t i = 0; i < impl->matched_readers; i++) {
+        lwdistcomm_dds_locator_t *locator = &impl->locators[i];
+        if (locator->participant_id == participant_id && locator->endpoint_id == endpoint_id) {
+            if (base && base - 1 > locator->acked_seqno) {
+                locator->acked_seqno = base - 1;
+                pthread_cond_broadcast(&impl->history_cond);
+            }
+            reader = locator;
+            break;
+        }
+    }
+    
+    /* 只重传DataReader报告缺失的样本，多个样本打包进同一报文，一次批量发送 */
+    lwdistcomm_dds_msg_header_t header;
+    struct mmsghdr msgs[LWDISTCOMM_DDS_ACKNACK_BITS];
+    struct iovec iov[2 * LWDISTCOMM_DDS_ACKNACK_BITS];
+    uint64_t large[LWDISTCOMM_DDS_ACKNACK_BITS];
+    uint32_t nmsgs = 0, niov = 0, nlarge = 0;
+    size_t len = 0;
+    
+    init_data_header(impl, &header, LWDISTCOMM_DDS_MSG_DATA);
+    
+    for (uint32_t i = 0; i < num_bits; i++) {
+        if (!(bitmap & ((uint64_t)1 << i))) {
+            continue;
+        }
+        
+        uint64_t seqno = base + i;
+        if (seqno < impl->history.first_seqno) {
+            skipped = true;
+            continue;
+        }
+        if (seqno > last_seqno) {
+            break;
+        }
+        
+        /* 未通过过滤的样本不重传，以GAP告知 */
+        if (reader && reader->filter && !history_filter_match(impl, reader, seqno)) {
+            gap_bitmap |= (uint64_t)1 << i;
+            continue;
+        }
+        
+        uint32_t record_len = impl->history.lengths[seqno % impl->history.depth];
+        if (!record_len) {
+            large[nlarge++] = seqno;
+            continue;
+        }
+        
+        if (!nmsgs || len + record_len > LWDISTCOMM_DDS_MAX_DATAGRAM_SIZE) {
+            memset(&msgs[nmsgs], 0, sizeof(msgs[nmsgs]));
+            msgs[nmsgs].msg_hdr.msg_name = (void *)from;
+            msgs[nmsgs].msg_hdr.msg_namelen = sizeof(*from);
+            msgs[nmsgs].msg_hdr.msg_iov = &iov[niov];
+            iov[niov].iov_base = &header;
+            iov[niov].iov_len = sizeof(header);
+            niov++;
+            msgs[nmsgs].msg_hdr.msg_iovlen = 1;
+            nmsgs++;
+            len = sizeof(header);
+        }
+        
+        iov[niov].iov_base = history_entry(&impl->history, seqno);
+        iov[niov].iov_len = record_len;
+        niov++;
+        msgs[nmsgs - 1].msg_hdr.msg_iovlen++;
+        len += record_len;
+    }
+    
+    if (gap_bitmap) {
+        lwdistcomm_dds_gap_msg_t gap;
+        struct iovec gap_iov = { &gap, sizeof(gap) };
+        init_gap(impl, &gap, base, base, num_bits, gap_bitmap);
+        lwdistcomm_dds_transport_send_addr(impl->transport, &gap_iov, 1, from);
+    }
+    
+    if (nmsgs) {
+        lwdistcomm_dds_transport_send_batch(impl->transport, msgs, nmsgs);
+    }
+    
+    /* 完全缺失的大样本只重传第一批分片，其余分片由DataReader通过NACK_FRAG请求 */
+    for (uint32_t i = 0; i < nlarge; i++) {
+        uint32_t size;
+        const uint8_t *data = history_large(impl, large[i], &size);
+        if (data) {
+            send_fragments(impl, large[i], data, size, 0, LWDISTCOMM_DDS_NACK_FRAG_BITS, NULL, from);
+        }
+    }
+    
+    /* 已移出历史的样本无法重传，通过心跳让DataReader跳过；重传分片后心跳促使DataReader请求下一批 */
+    if (skipped || nlarge || (impl->history.count && base < impl->history.first_seqno)) {
+        send_heartbeat(impl, from);
+    }
+}
+
+/**
+ * 处理DataReader的NACK_FRAG，重传大样本缺失的分片，调用者持有impl->mutex
+ */
+static void process_nack_frag(lwdistcomm_dds_data_writer_impl_t *impl, const lwdistcomm_dds_nack_frag_msg_t *msg, const struct sockaddr_in *from)
+{
+    if (ntohl(msg->writer_id) != impl->endpoint_id) {
+        return;
+    }
+    
+    uint64_t seqno = be64toh(msg->seqno);
+    uint32_t num_bits = ntohl(msg->num_bits);
+    uint64_t mask[LWDISTCOMM_DDS_NACK_FRAG_BITS / 64];
+    uint32_t size;
+    
+    if (num_bits > LWDISTCOMM_DDS_NACK_FRAG_BITS) {
+        num_bits = LWDISTCOMM_DDS_NACK_FRAG_BITS;
+    }
+    for (uint32_t i = 0; i < LWDISTCOMM_DDS_NACK_FRAG_BITS / 64; i++) {
+        mask[i] = be64toh(msg->bitmap[i]);
+    }
+    
+    /* 已移出历史的样本由心跳通知DataReader放弃 */
+    const uint8_t *data = history_large(impl, seqno, &size);
+    if (data) {
+        send_fragments(impl, seqno, data, size, ntohl(msg->base_fragment), num_bits, mask, from);
+    }
+    
+    send_heartbeat(impl, from);
+}
+
+/**
+ * 计算事件线程下次唤醒的超时，调用者持有impl->mutex
+ */
+static int event_timeout_ms(lwdistcomm_dds_data_writer_impl_t *impl, uint64_t next_heartbeat)
+{
+    uint64_t deadline = UINT64_MAX;
+    uint64_t now = monotonic_us();
+    
+    if (impl->history.depth) {
+        deadline = next_heartbeat;
+    }
+    if (impl->batch_len && impl->batch_deadline_us < deadline) {
+        deadline = impl->batch_deadline_us;
+    }
+    
+    if (deadline == UINT64_MAX) {
+        return -1;
+    }
+    
+    return deadline > now ? (int)((deadline - now + 999) / 1000) : 0;
+}
+
+/**
+ * 事件线程，发送心跳、处理ACKNACK和NACK_FRAG并在发送期限到达时发送打包的样本
+ */
+static void *event_thread(void *arg)
+{
+    lwdistcomm_dds_data_writer_impl_t *impl = (lwdistcomm_dds_data_writer_impl_t *)arg;
+    control_msg_t controls[ACKNACK_BATCH];
+    struct sockaddr_in from[ACKNACK_BATCH];
+    struct iovec iov[ACKNACK_BATCH];
+    struct mmsghdr msgs[ACKNACK_BATCH];
+    uint64_t next_heartbeat = monotonic_us() + HEARTBEAT_PERIOD_US;
+    
+    while (impl->event_thread_running) {
+        pthread_mutex_lock(&impl->mutex);
+        int timeout = event_timeout_ms(impl, next_heartbeat);
+        pthread_mutex_unlock(&impl->mutex);
+        
+        struct pollfd pfds[2] = { { impl->transport->udp_socket, POLLIN, 0 }, { impl->wake_fd, POLLIN, 0 } };
+        if (poll(pfds, 2, timeout) > 0) {
+            if (pfds[1].revents & POLLIN) {
+                uint64_t val;
+                if (read(impl->wake_fd, &val, sizeof(val)) < 0) {
+                    /* 已被清零 */
+                }
+            }
+            
+            if (pfds[0].revents & POLLIN) {
+                for (uint32_t i = 0; i < ACKNACK_BATCH; i++) {
+                    iov[i].iov_base = &controls[i];
+                    iov[i].iov_len = sizeof(controls[i]);
+                    memset(&msgs[i], 0, sizeof(msgs[i]));
+                    msgs[i].msg_hdr.msg_name = &from[i];
+                    msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+                    msgs[i].msg_hdr.msg_iov = &iov[i];
+                    msgs[i].msg_hdr.msg_iovlen = 1;
+                }
+                
+                int n = lwdistcomm_dds_transport_recv_batch(impl->transport, msgs, ACKNACK_BATCH, 0);
+                if (n > 0) {
+                    pthread_mutex_lock(&impl->mutex);
+                    for (int i = 0; i < n; i++) {
+                        uint8_t kind = lwdistcomm_dds_msg_validate(&controls[i], msgs[i].msg_len);
+                        if (kind == LWDISTCOMM_DDS_MSG_ACKNACK) {
+                            process_acknack(impl, &controls[i].acknack, &from[i]);
+                        } else if (kind == LWDISTCOMM_DDS_MSG_NACK_FRAG) {
+                            process_nack_frag(impl, &controls[i].nack_frag, &from[i]);
+                        }
+                    }
+                    pthread_mutex_unlock(&impl->mutex);
+                }
+            }
+        }
+        
+        uint64_t now = monotonic_us();
+        pthread_mutex_lock(&impl->mutex);
+        if (impl->batch_len && now >= impl->batch_deadline_us) {
+            batch_flush(impl);
+        }
+        if (impl->history.depth && now >= next_heartbeat) {
+            send_heartbeat(impl, NULL);
+            next_heartbeat = now + HEARTBEAT_PERIOD_US;
+        }
+        pthread_mutex_unlock(&impl->mutex);
+    }
+    
+    return NULL;
+}
+
+/**
+ * 按需启动事件线程
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_impl_start(lwdistcomm_dds_data_writer_impl_t *impl)
+{
+    if (!impl || !impl->transport || impl->wake_fd < 0) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_retcode_t ret = LWDISTCOMM_DDS_RETCODE_OK;
+    
+    pthread_mutex_lock(&impl->mutex);
+    if ((impl->history.depth || impl->batch_delay_us) && !impl->event_thread_running) {
+        impl->event_thread_running = true;
+        if (pthread_create(&impl->event_thread, NULL, event_thread, impl) != 0) {
+            impl->event_thread_running = false;
+            ret = LWDISTCOMM_DDS_RETCODE_ERROR;
+        }
+    }
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return ret;
+}
+
+/**
+ * 为新样本腾出历史缓存位置，KEEP_ALL时等待DataReader确认，调用者持有impl->mutex
+ */
+static lwdistcomm_dds_retcode_t history_reserve(lwdistcomm_dds_data_writer_impl_t *impl)
+{
+    lwdistcomm_dds_history_t *history = &impl->history;
+    
+    if (history->count < history->depth) {
+        return LWDISTCOMM_DDS_RETCODE_OK;
+    }
+    
+    if (impl->qos.history.kind == LWDISTCOMM_DDS_HISTORY_KEEP_ALL && !history_oldest_acked(impl)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += impl->qos.reliability.max_blocking_time.sec;
+        deadline.tv_nsec += impl->qos.reliability.max_blocking_time.nanosec;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+        }
+        
+        /* 立即请求确认，不等待下一个心跳周期 */
+        send_heartbeat(impl, NULL);
+        
+        while (!history_oldest_acked(impl)) {
+            if (pthread_cond_timedwait(&impl->history_cond, &impl->mutex, &deadline) == ETIMEDOUT &&
+                !history_oldest_acked(impl)) {
+                return LWDISTCOMM_DDS_RETCODE_TIMEOUT;
+            }
+        }
+    }
+    
+    /* 移除最早的样本，仍在打包缓冲区中的样本不受影响 */
+    free(history->large[history->first_seqno % history->depth]);
+    history->large[history->first_seqno % history->depth] = NULL;
+    history->first_seqno++;
+    history->count--;
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
 /**
  * 创建DataWriter
  */
@@ -112,6 +975,18 @@ lwdistcomm_dds_data_writer_t *lwdistcomm_dds_data_writer_create(lwdistcomm_dds_p
         return NULL;
     }
     
+    /* 匹配已存在的本地和远端DataReader */
+    lwdistcomm_dds_domain_participant_impl_match_writer(options->topic->impl->participant->impl, writer);
+    
+    /* 心跳和重传需要端点标识，匹配后启动事件线程 */
+    if (lwdistcomm_dds_data_writer_impl_start(writer->impl) != LWDISTCOMM_DDS_RETCODE_OK) {
+        lwdistcomm_dds_topic_impl_remove_data_writer(options->topic->impl, writer);
+        lwdistcomm_dds_publisher_impl_remove_data_writer(publisher->impl, writer);
+        lwdistcomm_dds_data_writer_impl_destroy(writer->impl);
+        free(writer);
+        return NULL;
+    }
+    
     /* 启用DataWriter */
     writer->impl->enabled = true;
     
@@ -130,7 +1005,8 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_delete(lwdistcomm_dds_data_w
     lwdistcomm_dds_publisher_t *publisher = writer->impl->publisher;
     lwdistcomm_dds_topic_t *topic = writer->topic;
     
-    /* 禁用DataWriter */
+    /* 发送打包中的样本后禁用DataWriter */
+    lwdistcomm_dds_data_writer_flush(writer);
     writer->impl->enabled = false;
     
     /* 从Topic移除DataWriter */
@@ -161,37 +1037,134 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_write(lwdistcomm_dds_data_wr
         return LWDISTCOMM_DDS_RETCODE_NOT_ENABLED;
     }
     
+    if (size > LWDISTCOMM_DDS_MAX_SAMPLE_SIZE) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_data_writer_impl_t *impl = writer->impl;
+    
     /* 检查传输适配器是否存在 */
-    if (!writer->impl->transport) {
+    if (!impl->transport) {
         return LWDISTCOMM_DDS_RETCODE_ERROR;
     }
     
-    /* TODO: 实现数据写入逻辑
-     * 1. 序列化数据
-     * 2. 发送数据到匹配的DataReader
-     * 3. 处理可靠性保证
-     * 
-     * 目前简化实现：
-     * - 假设已经有一个匹配的DataReader，地址为127.0.0.1:7401
-     */
+    lwdistcomm_dds_retcode_t ret = LWDISTCOMM_DDS_RETCODE_OK;
+    lwdistcomm_dds_data_record_t record;
+    bool fragmented = size > LWDISTCOMM_DDS_MAX_RECORD_SIZE;
+    void *copy = NULL;
     
-    /* 创建目标地址 */
-    lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_IPV4);
-    if (!addr) {
-        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    /* 可靠传输的大样本在加锁前复制，供重传使用 */
+    if (fragmented && impl->history.depth) {
+        copy = malloc(size);
+        if (!copy) {
+            return LWDISTCOMM_DDS_RETCODE_OUT_OF_RESOURCES;
+        }
+        memcpy(copy, data, size);
     }
     
-    /* 设置IPv4地址和端口 */
-    if (!lwdistcomm_address_set_ipv4(addr, "127.0.0.1", 7402)) {
-        lwdistcomm_address_destroy(addr);
-        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    pthread_mutex_lock(&impl->mutex);
+    
+    /* 可靠传输：先为新样本腾出历史缓存位置 */
+    if (impl->history.depth) {
+        ret = history_reserve(impl);
+        if (ret != LWDISTCOMM_DDS_RETCODE_OK) {
+            pthread_mutex_unlock(&impl->mutex);
+            free(copy);
+            return ret;
+        }
     }
     
-    /* 发送数据 */
-    lwdistcomm_dds_retcode_t ret = lwdistcomm_dds_transport_send(writer->impl->transport, data, size, addr);
+    uint64_t seqno = ++impl->last_seqno;
+    record.seqno = htobe64(seqno);
+    record.length = htonl(size);
+    record.reserved = 0;
+    
+    /* 可靠传输：编码后的样本记录写入历史缓存，重传时直接发送；大样本只记录长度，负载保留在副本中 */
+    if (impl->history.depth) {
+        uint8_t *entry = history_entry(&impl->history, seqno);
+        uint32_t index = (uint32_t)(seqno % impl->history.depth);
+        memcpy(entry, &record, sizeof(record));
+        if (fragmented) {
+            impl->history.lengths[index] = 0;
+            impl->history.large[index] = copy;
+        } else {
+            uint32_t record_len = (uint32_t)lwdistcomm_dds_record_len(size);
+            memcpy(entry + sizeof(record), data, size);
+            memset(entry + sizeof(record) + size, 0, record_len - sizeof(record) - size);
+            impl->history.lengths[index] = record_len;
+        }
+        if (!impl->history.count) {
+            impl->history.first_seqno = seqno;
+        }
+        impl->history.count++;
+    }
+    
+    if (fragmented) {
+        /* 大样本：先发送打包中的样本保持顺序，再分片发送；可靠传输随后发送心跳，DataReader据此请求缺失分片 */
+        batch_flush(impl);
+        ret = send_fragments(impl, seqno, (const uint8_t *)data, size, 0, lwdistcomm_dds_fragment_count(size), NULL, NULL);
+        send_filtered(impl, &record, data, size);
+        if (impl->history.depth) {
+            send_heartbeat(impl, NULL);
+        }
+    } else if (impl->batch_delay_us) {
+        /* 打包：小样本合并发送，由缓冲区满或发送期限触发；带过滤的DataReader逐个样本发送 */
+        ret = batch_append(impl, &record, data, size);
+        send_filtered(impl, &record, data, size);
+    } else {
+        /* 报文头、记录头与用户数据分散发送，不复制负载 */
+        lwdistcomm_dds_msg_header_t header;
+        init_data_header(impl, &header, LWDISTCOMM_DDS_MSG_DATA);
+        
+        struct iovec iov[3] = { { &header, sizeof(header) }, { &record, sizeof(record) }, { (void *)data, size } };
+        ret = send_to_readers(impl, iov, 3, 1, NULL);
+        send_filtered(impl, &record, data, size);
+    }
+    
+    /* 丢失的样本由ACKNACK触发重传，发送失败不影响可靠写入结果 */
+    if (impl->history.depth) {
+        ret = LWDISTCOMM_DDS_RETCODE_OK;
+    }
+    
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return ret;
+}
+
+/**
+ * 设置样本打包
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_set_batching(lwdistcomm_dds_data_writer_t *writer, const lwdistcomm_dds_duration_t *max_delay)
+{
+    if (!writer || !writer->impl) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    lwdistcomm_dds_data_writer_impl_t *impl = writer->impl;
+    uint64_t delay_us = max_delay ? (uint64_t)max_delay->sec * 1000000 + max_delay->nanosec / 1000 : 0;
+    
+    pthread_mutex_lock(&impl->mutex);
+    if (!delay_us) {
+        batch_flush(impl);
+    }
+    impl->batch_delay_us = delay_us;
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return lwdistcomm_dds_data_writer_impl_start(impl);
+}
+
+/**
+ * 立即发送打包的样本
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_flush(lwdistcomm_dds_data_writer_t *writer)
+{
+    if (!writer || !writer->impl) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
     
-    /* 销毁地址 */
-    lwdistcomm_address_destroy(addr);
+    pthread_mutex_lock(&writer->impl->mutex);
+    lwdistcomm_dds_retcode_t ret = batch_flush(writer->impl);
+    pthread_mutex_unlock(&writer->impl->mutex);
     
     return ret;
 }
@@ -3,18 +3,26 @@
 
 #include "../../include/dds/dds.h"
 #include "../../include/lwdistcomm.h"
+#include "dds_transport.h"
+#include "dds_protocol.h"
 #include <pthread.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* DDS transport type declaration */
+/**
+ * 可靠传输历史缓存，按序列号取模存放已编码的样本记录以便直接重传，
+ * 分片发送的大样本在large中保留副本，lengths为0
+ */
 typedef struct {
-    int udp_socket;
-    lwdistcomm_addr_type_t addr_type;
-    bool non_blocking;
-} lwdistcomm_dds_transport_t;
+    uint8_t *slab;
+    uint32_t *lengths;
+    void **large;
+    uint32_t depth;
+    uint32_t count;
+    uint64_t first_seqno;
+} lwdistcomm_dds_history_t;
 
 /**
  * DataWriter内部实现结构
@@ -25,12 +33,45 @@ struct lwdistcomm_dds_data_writer_impl_s {
     lwdistcomm_dds_publisher_t *publisher;
     lwdistcomm_dds_topic_t *topic;
     
+    /* 端点标识，匹配时由DomainParticipant分配 */
+    uint32_t participant_id;
+    uint32_t endpoint_id;
+    
+    /* 上一个已分配的序列号 */
+    uint64_t last_seqno;
+    
     /* 已匹配的DataReader数量 */
     uint32_t matched_readers;
     
+    /* 已匹配DataReader的定位器列表，不带内容过滤的unfiltered_readers个定位器在前 */
+    lwdistcomm_dds_locator_t *locators;
+    uint32_t max_locators;
+    uint32_t unfiltered_readers;
+    
+    /* 主题组播组，加入组播组的DataReader足够多时共用一次发送 */
+    uint32_t topic_id;
+    struct sockaddr_in group;
+    uint32_t multicast_readers;
+    
     /* 传输适配器 */
     lwdistcomm_dds_transport_t *transport;
     
+    /* RELIABLE时的历史缓存 */
+    lwdistcomm_dds_history_t history;
+    pthread_cond_t history_cond;
+    
+    /* 样本打包：报文头之后追加样本记录，超过MTU或到达发送期限时发送 */
+    uint8_t batch_buf[LWDISTCOMM_DDS_MAX_DATAGRAM_SIZE];
+    uint32_t batch_len;
+    uint64_t batch_first_seqno;
+    uint64_t batch_delay_us;
+    uint64_t batch_deadline_us;
+    
+    /* 事件线程：心跳、ACKNACK和打包发送期限 */
+    pthread_t event_thread;
+    bool event_thread_running;
+    int wake_fd;
+    
     /* 互斥锁 */
     pthread_mutex_t mutex;
 };
@@ -45,6 +86,23 @@ lwdistcomm_dds_data_writer_impl_t *lwdistcomm_dds_data_writer_impl_create(const
  */
 void lwdistcomm_dds_data_writer_impl_destroy(lwdistcomm_dds_data_writer_impl_t *impl);
 
+/**
+ * 添加已匹配DataReader的定位器，相同端点重复添加时更新地址和过滤条件，
+ * multicast表示该DataReader已加入主题组播组，filter为NULL或不生效时接收全部样本
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_impl_add_locator(lwdistcomm_dds_data_writer_impl_t *impl, uint32_t participant_id, uint32_t endpoint_id, const char *ip, uint16_t port,
+                                                                    bool multicast, const lwdistcomm_dds_content_filter_t *filter);
+
+/**
+ * 移除已匹配DataReader的定位器
+ */
+void lwdistcomm_dds_data_writer_impl_remove_locator(lwdistcomm_dds_data_writer_impl_t *impl, uint32_t participant_id, uint32_t endpoint_id);
+
+/**
+ * 按需启动事件线程，端点标识分配后调用
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_data_writer_impl_start(lwdistcomm_dds_data_writer_impl_t *impl);
+
 #ifdef __cplusplus
 }
 #endif
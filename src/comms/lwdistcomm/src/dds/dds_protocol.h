@@ -0,0 +1,222 @@
+#ifndef LWDISTCOMM_DDS_PROTOCOL_H
+#define LWDISTCOMM_DDS_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <endian.h>
+#include <arpa/inet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * DDS数据通道报文，DataWriter与DataReader之间的UDP报文均以报文头开始，
+ * 所有多字节字段为网络字节序
+ */
+#define LWDISTCOMM_DDS_PROTO_MAGIC      0x4c444453  /* "LDDS" */
+#define LWDISTCOMM_DDS_PROTO_VERSION    3
+
+/* 报文最大长度，以太网MTU减去IP和UDP头部 */
+#define LWDISTCOMM_DDS_MAX_DATAGRAM_SIZE    1472
+
+/* 不分片样本的最大负载长度，超过时以DATA_FRAG分片发送 */
+#define LWDISTCOMM_DDS_MAX_RECORD_SIZE  (LWDISTCOMM_DDS_MAX_DATAGRAM_SIZE - sizeof(lwdistcomm_dds_msg_header_t) - sizeof(lwdistcomm_dds_data_record_t))
+
+/* 每个分片的负载长度，最后一个分片可以更短 */
+#define LWDISTCOMM_DDS_FRAGMENT_SIZE    (LWDISTCOMM_DDS_MAX_DATAGRAM_SIZE - sizeof(lwdistcomm_dds_msg_header_t) - sizeof(lwdistcomm_dds_data_frag_t))
+
+/* 样本记录对齐 */
+#define LWDISTCOMM_DDS_RECORD_ALIGN     8
+
+/* ACKNACK位图覆盖的最大序列号个数 */
+#define LWDISTCOMM_DDS_ACKNACK_BITS     64
+
+/* GAP位图覆盖的最大序列号个数 */
+#define LWDISTCOMM_DDS_GAP_BITS         64
+
+/* NACK_FRAG位图覆盖的最大分片个数 */
+#define LWDISTCOMM_DDS_NACK_FRAG_BITS   256
+
+/**
+ * 报文类型
+ */
+typedef enum {
+    LWDISTCOMM_DDS_MSG_DATA = 1,        /* 样本数据，DataWriter -> DataReader */
+    LWDISTCOMM_DDS_MSG_HEARTBEAT = 2,   /* 可用序列号范围，DataWriter -> DataReader */
+    LWDISTCOMM_DDS_MSG_ACKNACK = 3,     /* 确认与缺失序列号，DataReader -> DataWriter */
+    LWDISTCOMM_DDS_MSG_DATA_FRAG = 4,   /* 大样本的一个分片，DataWriter -> DataReader */
+    LWDISTCOMM_DDS_MSG_NACK_FRAG = 5,   /* 缺失的分片，DataReader -> DataWriter */
+    LWDISTCOMM_DDS_MSG_GAP = 6          /* 被内容过滤的序列号，DataWriter -> DataReader */
+} lwdistcomm_dds_msg_kind_t;
+
+/* 报文标志 */
+#define LWDISTCOMM_DDS_MSG_FLAG_RELIABLE    0x01    /* DataWriter保留历史并响应重传 */
+
+/**
+ * 报文头，participant_id/endpoint_id标识发送端点，
+ * topic_id区分共用同一组播组的主题
+ */
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t kind;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t participant_id;
+    uint32_t endpoint_id;
+    uint32_t topic_id;
+    uint32_t padding;       /* 保持样本记录8字节对齐 */
+} lwdistcomm_dds_msg_header_t;
+
+/**
+ * DATA报文在报文头之后依次排列一个或多个样本记录，
+ * 每个记录的负载紧随记录头，记录按LWDISTCOMM_DDS_RECORD_ALIGN对齐
+ */
+typedef struct {
+    uint64_t seqno;
+    uint32_t length;
+    uint32_t reserved;
+} lwdistcomm_dds_data_record_t;
+
+/**
+ * DATA_FRAG报文在报文头之后为分片头和分片负载，
+ * offset为分片在样本中的偏移，必须是LWDISTCOMM_DDS_FRAGMENT_SIZE的整数倍
+ */
+typedef struct {
+    uint64_t seqno;
+    uint32_t sample_size;
+    uint32_t offset;
+} lwdistcomm_dds_data_frag_t;
+
+/**
+ * HEARTBEAT报文，DataWriter历史中可重传的序列号范围[first_seqno, last_seqno]
+ */
+typedef struct {
+    lwdistcomm_dds_msg_header_t header;
+    uint64_t first_seqno;
+    uint64_t last_seqno;
+} lwdistcomm_dds_heartbeat_msg_t;
+
+/**
+ * ACKNACK报文，小于base_seqno的样本均已收到或放弃，
+ * bitmap第i位表示base_seqno + i缺失
+ */
+typedef struct {
+    lwdistcomm_dds_msg_header_t header;
+    uint32_t writer_id;
+    uint32_t num_bits;
+    uint64_t base_seqno;
+    uint64_t bitmap;
+} lwdistcomm_dds_acknack_msg_t;
+
+/**
+ * NACK_FRAG报文，请求重传样本seqno的分片，
+ * bitmap第i位表示分片base_fragment + i缺失
+ */
+typedef struct {
+    lwdistcomm_dds_msg_header_t header;
+    uint32_t writer_id;
+    uint32_t num_bits;
+    uint64_t seqno;
+    uint32_t base_fragment;
+    uint32_t reserved;
+    uint64_t bitmap[LWDISTCOMM_DDS_NACK_FRAG_BITS / 64];
+} lwdistcomm_dds_nack_frag_msg_t;
+
+/**
+ * GAP报文，[gap_start, base_seqno)及bitmap第i位对应的base_seqno + i
+ * 不发送给该DataReader，DataReader不再请求也不计为丢失
+ */
+typedef struct {
+    lwdistcomm_dds_msg_header_t header;
+    uint64_t gap_start;
+    uint64_t base_seqno;
+    uint32_t num_bits;
+    uint32_t reserved;
+    uint64_t bitmap;
+} lwdistcomm_dds_gap_msg_t;
+
+/**
+ * 填充报文头
+ */
+static inline void lwdistcomm_dds_msg_init_header(lwdistcomm_dds_msg_header_t *header, uint8_t kind, uint8_t flags, uint32_t participant_id, uint32_t endpoint_id, uint32_t topic_id)
+{
+    header->magic = htonl(LWDISTCOMM_DDS_PROTO_MAGIC);
+    header->version = LWDISTCOMM_DDS_PROTO_VERSION;
+    header->kind = kind;
+    header->flags = flags;
+    header->reserved = 0;
+    header->participant_id = htonl(participant_id);
+    header->endpoint_id = htonl(endpoint_id);
+    header->topic_id = htonl(topic_id);
+    header->padding = 0;
+}
+
+/**
+ * 由主题名计算主题ID（FNV-1a）
+ */
+static inline uint32_t lwdistcomm_dds_topic_id(const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (name && *name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * 长度为size的样本的分片数
+ */
+static inline uint32_t lwdistcomm_dds_fragment_count(uint32_t size)
+{
+    return (uint32_t)((size + LWDISTCOMM_DDS_FRAGMENT_SIZE - 1) / LWDISTCOMM_DDS_FRAGMENT_SIZE);
+}
+
+/**
+ * 负载长度为len的样本记录在报文中占用的长度
+ */
+static inline size_t lwdistcomm_dds_record_len(size_t len)
+{
+    return (sizeof(lwdistcomm_dds_data_record_t) + len + LWDISTCOMM_DDS_RECORD_ALIGN - 1) & ~(size_t)(LWDISTCOMM_DDS_RECORD_ALIGN - 1);
+}
+
+/**
+ * 校验报文头并返回报文类型，无效报文返回0
+ */
+static inline uint8_t lwdistcomm_dds_msg_validate(const void *data, size_t len)
+{
+    const lwdistcomm_dds_msg_header_t *header = (const lwdistcomm_dds_msg_header_t *)data;
+
+    if (len < sizeof(lwdistcomm_dds_msg_header_t) || header->magic != htonl(LWDISTCOMM_DDS_PROTO_MAGIC) ||
+        header->version != LWDISTCOMM_DDS_PROTO_VERSION) {
+        return 0;
+    }
+
+    switch (header->kind) {
+    case LWDISTCOMM_DDS_MSG_DATA:
+        return len >= sizeof(lwdistcomm_dds_msg_header_t) + sizeof(lwdistcomm_dds_data_record_t) ? header->kind : 0;
+    case LWDISTCOMM_DDS_MSG_HEARTBEAT:
+        return len >= sizeof(lwdistcomm_dds_heartbeat_msg_t) ? header->kind : 0;
+    case LWDISTCOMM_DDS_MSG_ACKNACK:
+        return len >= sizeof(lwdistcomm_dds_acknack_msg_t) ? header->kind : 0;
+    case LWDISTCOMM_DDS_MSG_DATA_FRAG:
+        return len > sizeof(lwdistcomm_dds_msg_header_t) + sizeof(lwdistcomm_dds_data_frag_t) ? header->kind : 0;
+    case LWDISTCOMM_DDS_MSG_NACK_FRAG:
+        return len >= sizeof(lwdistcomm_dds_nack_frag_msg_t) ? header->kind : 0;
+    case LWDISTCOMM_DDS_MSG_GAP:
+        return len >= sizeof(lwdistcomm_dds_gap_msg_t) ? header->kind : 0;
+    default:
+        return 0;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWDISTCOMM_DDS_PROTOCOL_H */
@@ -1,8 +1,19 @@
-#include "../../include/dds/dds.h"
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "dds_transport.h"
 #include "../../include/address.h"
-#include "../../include/lwdistcomm.h"
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+/* 发送缓冲区满时等待可写的最长时间 */
+#define SEND_WAIT_MS 10
 
 /* Transport functions declarations */
 extern int lwdistcomm_transport_create_udp_socket(lwdistcomm_addr_type_t type, bool non_blocking);
@@ -12,15 +23,6 @@ extern bool lwdistcomm_transport_bind(int sock, const lwdistcomm_address_t *addr
 extern bool lwdistcomm_transport_set_timeout(int sock, int timeout_ms);
 extern void lwdistcomm_transport_close(int sock);
 
-/**
- * DDS传输适配器结构
- */
-typedef struct {
-    int udp_socket;
-    lwdistcomm_addr_type_t addr_type;
-    bool non_blocking;
-} lwdistcomm_dds_transport_t;
-
 /**
  * 创建DDS传输适配器
  */
@@ -38,6 +40,12 @@ lwdistcomm_dds_transport_t *lwdistcomm_dds_transport_create(lwdistcomm_addr_type
         return NULL;
     }
     
+    /* 尽量增大收发缓冲区，超过系统上限时由内核截断 */
+    int size = LWDISTCOMM_DDS_SOCKET_BUFFER_SIZE;
+    setsockopt(transport->udp_socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    setsockopt(transport->udp_socket, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    
+    transport->multicast_socket = -1;
     transport->addr_type = type;
     transport->non_blocking = non_blocking;
     
@@ -57,6 +65,10 @@ void lwdistcomm_dds_transport_destroy(lwdistcomm_dds_transport_t *transport)
         lwdistcomm_transport_close(transport->udp_socket);
     }
     
+    if (transport->multicast_socket >= 0) {
+        close(transport->multicast_socket);
+    }
+    
     free(transport);
 }
 
@@ -77,6 +89,244 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_send(lwdistcomm_dds_transport_
     return LWDISTCOMM_DDS_RETCODE_OK;
 }
 
+/**
+ * 计算主题组播地址，组地址239.255.<域>.<主题>，端口为基准端口按域ID偏移
+ */
+void lwdistcomm_dds_transport_multicast_addr(uint32_t domain_id, uint16_t base_port, uint32_t topic_id, struct sockaddr_in *addr)
+{
+    uint32_t domain = domain_id % LWDISTCOMM_DDS_MULTICAST_MAX_DOMAINS;
+    
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(0xefff0000u | (domain << 8) | (1 + topic_id % 254));
+    addr->sin_port = htons((uint16_t)(base_port + LWDISTCOMM_DDS_MULTICAST_DOMAIN_GAIN * domain + LWDISTCOMM_DDS_MULTICAST_PORT_OFFSET));
+}
+
+/**
+ * 创建接收套接字并加入组播组，套接字绑定到组地址，只接收本组的报文
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_join_multicast(lwdistcomm_dds_transport_t *transport, const struct sockaddr_in *group)
+{
+    if (!transport || !group || transport->multicast_socket >= 0) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    int opt = 1;
+    int size = LWDISTCOMM_DDS_SOCKET_BUFFER_SIZE;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+#ifdef IP_MULTICAST_ALL
+    /* 不接收本机其他套接字加入的组播组的报文 */
+    opt = 0;
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_ALL, &opt, sizeof(opt));
+#endif
+    
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr = group->sin_addr;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    
+    if (bind(sock, (const struct sockaddr *)group, sizeof(*group)) < 0 ||
+        setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        close(sock);
+        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    transport->multicast_socket = sock;
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 加入或退出组播组，套接字保持绑定，退出后不再收到组播报文
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_set_multicast_membership(lwdistcomm_dds_transport_t *transport, const struct sockaddr_in *group, bool member)
+{
+    if (!transport || !group || transport->multicast_socket < 0) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    struct ip_mreq mreq;
+    mreq.imr_multiaddr = group->sin_addr;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    
+    if (setsockopt(transport->multicast_socket, IPPROTO_IP, member ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 发送报文到定位器列表，报文按目的地址展开后批量发送，任一目的地址发送成功即返回成功
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_send_locators(lwdistcomm_dds_transport_t *transport, const struct iovec *iov, int iovcnt, uint32_t nmsgs,
+                                                                 const lwdistcomm_dds_locator_t *locators, uint32_t count, const struct sockaddr_in *group)
+{
+    if (!transport || !iov || iovcnt <= 0 || (count && !locators)) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    struct mmsghdr msgs[LWDISTCOMM_DDS_TRANSPORT_BATCH];
+    uint32_t n = 0, sent = 0;
+    bool group_sent = false;
+    
+    /* 组播：每个报文只发送一次 */
+    if (group) {
+        for (uint32_t i = 0; i < nmsgs; i++) {
+            memset(&msgs[n], 0, sizeof(msgs[n]));
+            msgs[n].msg_hdr.msg_name = (void *)group;
+            msgs[n].msg_hdr.msg_namelen = sizeof(*group);
+            msgs[n].msg_hdr.msg_iov = (struct iovec *)&iov[i * (uint32_t)iovcnt];
+            msgs[n].msg_hdr.msg_iovlen = (size_t)iovcnt;
+            if (++n == LWDISTCOMM_DDS_TRANSPORT_BATCH || i + 1 == nmsgs) {
+                sent += lwdistcomm_dds_transport_send_batch(transport, msgs, n);
+                n = 0;
+            }
+        }
+        group_sent = sent > 0;
+    }
+    
+    /* 单播：未加入组播组的定位器，组播失败时包括全部定位器 */
+    for (uint32_t i = 0; i < nmsgs; i++) {
+        for (uint32_t j = 0; j < count; j++) {
+            if (group_sent && locators[j].multicast) {
+                continue;
+            }
+            
+            memset(&msgs[n], 0, sizeof(msgs[n]));
+            msgs[n].msg_hdr.msg_name = (void *)&locators[j].addr;
+            msgs[n].msg_hdr.msg_namelen = sizeof(locators[j].addr);
+            msgs[n].msg_hdr.msg_iov = (struct iovec *)&iov[i * (uint32_t)iovcnt];
+            msgs[n].msg_hdr.msg_iovlen = (size_t)iovcnt;
+            if (++n == LWDISTCOMM_DDS_TRANSPORT_BATCH) {
+                sent += lwdistcomm_dds_transport_send_batch(transport, msgs, n);
+                n = 0;
+            }
+        }
+    }
+    
+    if (n) {
+        sent += lwdistcomm_dds_transport_send_batch(transport, msgs, n);
+    }
+    
+    if ((group || count) && nmsgs && !sent) {
+        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 发送报文到单个地址，报文头与负载分散存放时无需拼接
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_send_addr(lwdistcomm_dds_transport_t *transport, const struct iovec *iov, int iovcnt, const struct sockaddr_in *addr)
+{
+    if (!transport || !iov || iovcnt <= 0 || !addr) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    struct msghdr msg;
+    size_t len = 0;
+    
+    for (int i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+    
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = (void *)addr;
+    msg.msg_namelen = sizeof(*addr);
+    msg.msg_iov = (struct iovec *)iov;
+    msg.msg_iovlen = (size_t)iovcnt;
+    
+    ssize_t sent = sendmsg(transport->udp_socket, &msg, MSG_NOSIGNAL);
+    if (sent < 0 || (size_t)sent != len) {
+        return LWDISTCOMM_DDS_RETCODE_ERROR;
+    }
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 批量发送报文
+ */
+uint32_t lwdistcomm_dds_transport_send_batch(lwdistcomm_dds_transport_t *transport, struct mmsghdr *msgs, uint32_t count)
+{
+    if (!transport || !msgs) {
+        return 0;
+    }
+    
+    uint32_t sent = 0;
+    uint32_t i = 0;
+    
+    while (i < count) {
+        int n = sendmmsg(transport->udp_socket, msgs + i, count - i, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            /* 发送缓冲区满时等待可写，分片突发不因瞬时拥塞丢弃 */
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = { transport->udp_socket, POLLOUT, 0 };
+                if (poll(&pfd, 1, SEND_WAIT_MS) > 0) {
+                    continue;
+                }
+            }
+            /* 第一个报文发送失败，跳过后继续发送其余报文 */
+            i++;
+            continue;
+        }
+        
+        sent += (uint32_t)n;
+        i += (uint32_t)n;
+    }
+    
+    return sent;
+}
+
+/**
+ * 批量接收报文
+ */
+int lwdistcomm_dds_transport_recv_batch(lwdistcomm_dds_transport_t *transport, struct mmsghdr *msgs, uint32_t count, int timeout_ms)
+{
+    if (!transport || !msgs || !count) {
+        return -1;
+    }
+    
+    /* revents预置为POLLIN，不等待时两个套接字都尝试接收 */
+    struct pollfd pfds[2] = { { transport->udp_socket, POLLIN, POLLIN }, { transport->multicast_socket, POLLIN, POLLIN } };
+    int nfds = transport->multicast_socket >= 0 ? 2 : 1;
+    
+    if (timeout_ms != 0) {
+        int ret = poll(pfds, (nfds_t)nfds, timeout_ms);
+        if (ret <= 0) {
+            return ret < 0 && errno != EINTR ? -1 : 0;
+        }
+    }
+    
+    int received = 0;
+    for (int i = 0; i < nfds && (uint32_t)received < count; i++) {
+        if (!(pfds[i].revents & POLLIN)) {
+            continue;
+        }
+        
+        int n = recvmmsg(pfds[i].fd, msgs + received, count - (uint32_t)received, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && !received) {
+                return -1;
+            }
+            continue;
+        }
+        received += n;
+    }
+    
+    return received;
+}
+
 /**
  * 接收DDS数据
  */
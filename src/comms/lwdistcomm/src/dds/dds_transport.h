@@ -0,0 +1,122 @@
+#ifndef LWDISTCOMM_DDS_TRANSPORT_H
+#define LWDISTCOMM_DDS_TRANSPORT_H
+
+#include "../../include/dds/dds.h"
+#include "../../include/lwdistcomm.h"
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 批量收发接口需要_GNU_SOURCE，未定义时仅作不完整类型声明 */
+struct mmsghdr;
+
+/* 单次批量收发的最大报文数 */
+#define LWDISTCOMM_DDS_TRANSPORT_BATCH  64
+
+/* 套接字收发缓冲区大小，容纳分片大样本的突发 */
+#define LWDISTCOMM_DDS_SOCKET_BUFFER_SIZE   (4 * 1024 * 1024)
+
+/* 主题组播地址：组地址由主题ID决定，端口按域ID偏移，与SPDP端口规则一致 */
+#define LWDISTCOMM_DDS_MULTICAST_DOMAIN_GAIN    250
+#define LWDISTCOMM_DDS_MULTICAST_PORT_OFFSET    1
+#define LWDISTCOMM_DDS_MULTICAST_MAX_DOMAINS    232
+
+/**
+ * DDS传输适配器，multicast_socket为加入主题组播组的接收套接字
+ */
+typedef struct {
+    int udp_socket;
+    int multicast_socket;
+    lwdistcomm_addr_type_t addr_type;
+    bool non_blocking;
+} lwdistcomm_dds_transport_t;
+
+/**
+ * 已匹配DataReader的定位器，地址在发现时预先解析
+ */
+typedef struct {
+    uint32_t participant_id;
+    uint32_t endpoint_id;
+    struct sockaddr_in addr;
+    uint64_t acked_seqno;   /* 该DataReader确认已连续收到的最大序列号 */
+    bool multicast;         /* 该DataReader已加入主题组播组 */
+    lwdistcomm_dds_content_filter_t *filter;   /* 内容过滤条件，NULL表示接收全部样本 */
+    uint64_t sent_seqno;    /* 已向带过滤的DataReader发送或告知的最大序列号 */
+} lwdistcomm_dds_locator_t;
+
+/**
+ * 创建DDS传输适配器
+ */
+lwdistcomm_dds_transport_t *lwdistcomm_dds_transport_create(lwdistcomm_addr_type_t type, bool non_blocking);
+
+/**
+ * 销毁DDS传输适配器
+ */
+void lwdistcomm_dds_transport_destroy(lwdistcomm_dds_transport_t *transport);
+
+/**
+ * 发送DDS数据
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_send(lwdistcomm_dds_transport_t *transport, const void *data, uint32_t size, const lwdistcomm_address_t *addr);
+
+/**
+ * 计算主题组播地址
+ */
+void lwdistcomm_dds_transport_multicast_addr(uint32_t domain_id, uint16_t base_port, uint32_t topic_id, struct sockaddr_in *addr);
+
+/**
+ * 创建接收套接字并加入组播组
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_join_multicast(lwdistcomm_dds_transport_t *transport, const struct sockaddr_in *group);
+
+/**
+ * 加入或退出已创建的组播接收套接字的组播组
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_set_multicast_membership(lwdistcomm_dds_transport_t *transport, const struct sockaddr_in *group, bool member);
+
+/**
+ * 发送nmsgs个报文到定位器列表，第i个报文由iov[i * iovcnt]起的iovcnt个分段组成。
+ * group非NULL时已加入组播组的定位器共用一次组播发送，组播失败时退回单播
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_send_locators(lwdistcomm_dds_transport_t *transport, const struct iovec *iov, int iovcnt, uint32_t nmsgs,
+                                                                 const lwdistcomm_dds_locator_t *locators, uint32_t count, const struct sockaddr_in *group);
+
+/**
+ * 发送报文到单个地址
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_send_addr(lwdistcomm_dds_transport_t *transport, const struct iovec *iov, int iovcnt, const struct sockaddr_in *addr);
+
+/**
+ * 批量发送报文，返回成功发送的报文数，发送缓冲区满时短暂等待，仍失败的报文被跳过
+ */
+uint32_t lwdistcomm_dds_transport_send_batch(lwdistcomm_dds_transport_t *transport, struct mmsghdr *msgs, uint32_t count);
+
+/**
+ * 从单播和组播套接字批量接收报文，最多等待timeout_ms毫秒，返回接收的报文数，超时返回0，出错返回-1
+ */
+int lwdistcomm_dds_transport_recv_batch(lwdistcomm_dds_transport_t *transport, struct mmsghdr *msgs, uint32_t count, int timeout_ms);
+
+/**
+ * 接收DDS数据
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_recv(lwdistcomm_dds_transport_t *transport, void *buffer, uint32_t *size, lwdistcomm_address_t *addr);
+
+/**
+ * 绑定DDS传输适配器到地址
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_bind(lwdistcomm_dds_transport_t *transport, const lwdistcomm_address_t *addr);
+
+/**
+ * 设置DDS传输适配器的超时
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_transport_set_timeout(lwdistcomm_dds_transport_t *transport, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWDISTCOMM_DDS_TRANSPORT_H */
@@ -1,4 +1,7 @@
 #include "domain_participant_impl.h"
+#include "topic_impl.h"
+#include "data_writer_impl.h"
+#include "data_reader_impl.h"
 #include "../../include/dds/spdp.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,6 +11,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <time.h>
 
 /**
  * 发现线程函数声明
@@ -20,6 +24,12 @@ extern void *lwdistcomm_dds_discovery_thread_func(void *arg);
 #define MAX_PUBLISHERS 32
 #define MAX_SUBSCRIBERS 32
 #define DEFAULT_DISCOVERY_PORT 7400
+#define LOCAL_READER_ADDRESS "127.0.0.1"
+
+/**
+ * 进程内参与者序号，用于区分同一秒内创建的参与者
+ */
+static uint32_t participant_seq = 0;
 
 /**
  * 发现线程函数
@@ -85,6 +95,8 @@ lwdistcomm_dds_domain_participant_impl_t *lwdistcomm_dds_domain_participant_impl
     memset(impl, 0, sizeof(lwdistcomm_dds_domain_participant_impl_t));
     
     impl->domain_id = options->domain_id;
+    impl->participant_id = ((uint32_t)time(NULL) << 20) ^ ((uint32_t)getpid() << 8) ^
+                           __atomic_add_fetch(&participant_seq, 1, __ATOMIC_RELAXED);
     impl->enabled = false;
     impl->automatic_discovery = options->enable_automatic_discovery;
     impl->discovery_port = options->discovery_port > 0 ? options->discovery_port : DEFAULT_DISCOVERY_PORT;
@@ -326,6 +338,224 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_domain_participant_impl_remove_subscribe
     return LWDISTCOMM_DDS_RETCODE_ERROR;
 }
 
+/**
+ * SPDP端点发现回调，远端DataReader出现或消失时更新本地DataWriter的定位器
+ */
+static void spdp_endpoint_callback(lwdistcomm_dds_domain_participant_t *participant, uint32_t participant_id,
+                                   const lwdistcomm_dds_spdp_topic_info_t *topic,
+                                   const lwdistcomm_dds_spdp_endpoint_info_t *endpoint,
+                                   bool is_new, void *arg)
+{
+    (void)arg;
+    
+    if (!participant || !participant->impl || endpoint->is_writer) {
+        return;
+    }
+    
+    lwdistcomm_dds_domain_participant_impl_match_reader(participant->impl, topic->topic_name, participant_id,
+                                                        endpoint->endpoint_id, endpoint->transport_address,
+                                                        endpoint->port, endpoint->multicast != 0, &endpoint->filter, is_new);
+}
+
+/**
+ * 新DataWriter匹配已发现的远端DataReader
+ */
+static void spdp_match_writer_callback(lwdistcomm_dds_domain_participant_t *participant, uint32_t participant_id,
+                                       const lwdistcomm_dds_spdp_topic_info_t *topic,
+                                       const lwdistcomm_dds_spdp_endpoint_info_t *endpoint,
+                                       bool is_new, void *arg)
+{
+    (void)participant;
+    (void)topic;
+    
+    if (is_new && !endpoint->is_writer) {
+        lwdistcomm_dds_data_writer_impl_add_locator((lwdistcomm_dds_data_writer_impl_t *)arg, participant_id,
+                                                    endpoint->endpoint_id, endpoint->transport_address,
+                                                    endpoint->port, endpoint->multicast != 0, &endpoint->filter);
+    }
+}
+
+/**
+ * 为新DataWriter建立定位器
+ */
+void lwdistcomm_dds_domain_participant_impl_match_writer(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_writer_t *writer)
+{
+    if (!impl || !writer || !writer->impl || !writer->topic) {
+        return;
+    }
+    
+    const char *topic_name = writer->topic->name;
+    
+    /* 本参与者内的DataReader走回环地址 */
+    pthread_mutex_lock(&impl->mutex);
+    writer->impl->participant_id = impl->participant_id;
+    writer->impl->endpoint_id = ++impl->next_endpoint_id;
+    for (uint32_t i = 0; i < impl->num_topics; i++) {
+        lwdistcomm_dds_topic_impl_t *topic_impl = impl->topics[i]->impl;
+        if (strcmp(topic_impl->name, topic_name) != 0) {
+            continue;
+        }
+        
+        pthread_mutex_lock(&topic_impl->mutex);
+        for (uint32_t j = 0; j < topic_impl->num_data_readers; j++) {
+            lwdistcomm_dds_data_reader_impl_t *reader_impl = topic_impl->data_readers[j]->impl;
+            if (reader_impl->endpoint_id && reader_impl->port) {
+                lwdistcomm_dds_content_filter_t filter;
+                lwdistcomm_dds_data_reader_impl_get_filter(reader_impl, &filter);
+                lwdistcomm_dds_data_writer_impl_add_locator(writer->impl, impl->participant_id, reader_impl->endpoint_id,
+                                                            LOCAL_READER_ADDRESS, reader_impl->port, reader_impl->multicast, &filter);
+            }
+        }
+        pthread_mutex_unlock(&topic_impl->mutex);
+    }
+    pthread_mutex_unlock(&impl->mutex);
+    
+    /* SPDP回调会先持有SPDP锁再获取参与者锁，此处不能持有参与者锁 */
+    if (impl->spdp) {
+        lwdistcomm_dds_spdp_foreach_endpoint(impl->spdp, topic_name, spdp_match_writer_callback, writer->impl);
+    }
+}
+
+/**
+ * 更新同名主题下所有DataWriter的定位器
+ */
+void lwdistcomm_dds_domain_participant_impl_match_reader(lwdistcomm_dds_domain_participant_impl_t *impl, const char *topic_name, uint32_t participant_id, uint32_t endpoint_id, const char *ip, uint16_t port,
+                                                         bool multicast, const lwdistcomm_dds_content_filter_t *filter, bool matched)
+{
+    if (!impl || !topic_name) {
+        return;
+    }
+    
+    pthread_mutex_lock(&impl->mutex);
+    for (uint32_t i = 0; i < impl->num_topics; i++) {
+        lwdistcomm_dds_topic_impl_t *topic_impl = impl->topics[i]->impl;
+        if (strcmp(topic_impl->name, topic_name) != 0) {
+            continue;
+        }
+        
+        pthread_mutex_lock(&topic_impl->mutex);
+        for (uint32_t j = 0; j < topic_impl->num_data_writers; j++) {
+            lwdistcomm_dds_data_writer_impl_t *writer_impl = topic_impl->data_writers[j]->impl;
+            if (matched) {
+                lwdistcomm_dds_data_writer_impl_add_locator(writer_impl, participant_id, endpoint_id, ip, port, multicast, filter);
+            } else {
+                lwdistcomm_dds_data_writer_impl_remove_locator(writer_impl, participant_id, endpoint_id);
+            }
+        }
+        pthread_mutex_unlock(&topic_impl->mutex);
+    }
+    pthread_mutex_unlock(&impl->mutex);
+}
+
+/**
+ * 填充本地DataReader端点信息，地址留空由接收方使用报文源地址
+ */
+static void fill_reader_endpoint(lwdistcomm_dds_data_reader_impl_t *reader_impl, lwdistcomm_dds_spdp_endpoint_info_t *endpoint)
+{
+    memset(endpoint, 0, sizeof(*endpoint));
+    endpoint->endpoint_id = reader_impl->endpoint_id;
+    endpoint->is_writer = 0;
+    endpoint->port = reader_impl->port;
+    endpoint->multicast = reader_impl->multicast;
+    lwdistcomm_dds_data_reader_impl_get_filter(reader_impl, &endpoint->filter);
+}
+
+/**
+ * 注册本地DataReader端点
+ */
+void lwdistcomm_dds_domain_participant_impl_add_reader_endpoint(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_reader_t *reader)
+{
+    if (!impl || !reader || !reader->impl || !reader->topic) {
+        return;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *reader_impl = reader->impl;
+    
+    pthread_mutex_lock(&impl->mutex);
+    reader_impl->participant_id = impl->participant_id;
+    reader_impl->endpoint_id = ++impl->next_endpoint_id;
+    pthread_mutex_unlock(&impl->mutex);
+    
+    lwdistcomm_dds_domain_participant_impl_update_reader_endpoint(impl, reader);
+}
+
+/**
+ * 更新本地DataReader端点
+ */
+void lwdistcomm_dds_domain_participant_impl_update_reader_endpoint(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_reader_t *reader)
+{
+    if (!impl || !reader || !reader->impl || !reader->topic) {
+        return;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *reader_impl = reader->impl;
+    
+    /* 未绑定接收端口的DataReader无法被路由 */
+    if (!reader_impl->endpoint_id || !reader_impl->port) {
+        return;
+    }
+    
+    lwdistcomm_dds_spdp_endpoint_info_t endpoint;
+    fill_reader_endpoint(reader_impl, &endpoint);
+    
+    lwdistcomm_dds_domain_participant_impl_match_reader(impl, reader->topic->name, impl->participant_id,
+                                                        reader_impl->endpoint_id, LOCAL_READER_ADDRESS,
+                                                        reader_impl->port, reader_impl->multicast, &endpoint.filter, true);
+    
+    if (impl->spdp && impl->enabled) {
+        lwdistcomm_dds_spdp_send_endpoint_announce(impl->spdp, reader->topic, &endpoint);
+    }
+}
+
+/**
+ * 注销本地DataReader端点
+ */
+void lwdistcomm_dds_domain_participant_impl_remove_reader_endpoint(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_reader_t *reader)
+{
+    if (!impl || !reader || !reader->impl || !reader->topic || !reader->impl->port) {
+        return;
+    }
+    
+    lwdistcomm_dds_data_reader_impl_t *reader_impl = reader->impl;
+    
+    lwdistcomm_dds_domain_participant_impl_match_reader(impl, reader->topic->name, impl->participant_id,
+                                                        reader_impl->endpoint_id, NULL, 0, false, NULL, false);
+    
+    if (impl->spdp && impl->enabled) {
+        lwdistcomm_dds_spdp_endpoint_info_t endpoint;
+        fill_reader_endpoint(reader_impl, &endpoint);
+        lwdistcomm_dds_spdp_send_endpoint_remove(impl->spdp, reader->topic, &endpoint);
+    }
+}
+
+/**
+ * 重新宣告所有本地DataReader端点
+ */
+void lwdistcomm_dds_domain_participant_impl_announce_endpoints(lwdistcomm_dds_domain_participant_impl_t *impl)
+{
+    if (!impl || !impl->spdp) {
+        return;
+    }
+    
+    pthread_mutex_lock(&impl->mutex);
+    for (uint32_t i = 0; i < impl->num_topics; i++) {
+        lwdistcomm_dds_topic_t *topic = impl->topics[i];
+        lwdistcomm_dds_topic_impl_t *topic_impl = topic->impl;
+        
+        pthread_mutex_lock(&topic_impl->mutex);
+        for (uint32_t j = 0; j < topic_impl->num_data_readers; j++) {
+            lwdistcomm_dds_data_reader_impl_t *reader_impl = topic_impl->data_readers[j]->impl;
+            if (reader_impl->endpoint_id && reader_impl->port) {
+                lwdistcomm_dds_spdp_endpoint_info_t endpoint;
+                fill_reader_endpoint(reader_impl, &endpoint);
+                lwdistcomm_dds_spdp_send_endpoint_announce(impl->spdp, topic, &endpoint);
+            }
+        }
+        pthread_mutex_unlock(&topic_impl->mutex);
+    }
+    pthread_mutex_unlock(&impl->mutex);
+}
+
 /**
  * 启动发现线程
  */
@@ -430,7 +660,7 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_domain_participant_enable(lwdistcomm_dds
         lwdistcomm_dds_spdp_config_t spdp_config;
         memset(&spdp_config, 0, sizeof(spdp_config));
         spdp_config.domain_id = participant->domain_id;
-        spdp_config.participant_id = (uint32_t)time(NULL);
+        spdp_config.participant_id = participant->impl->participant_id;
         snprintf(spdp_config.participant_name, sizeof(spdp_config.participant_name), "Participant_%u", spdp_config.participant_id);
         strcpy(spdp_config.multicast_address, "239.255.0.1");
         spdp_config.multicast_port = participant->impl->discovery_port;
@@ -439,6 +669,7 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_domain_participant_enable(lwdistcomm_dds
         
         participant->impl->spdp = lwdistcomm_dds_spdp_create(&spdp_config, participant);
         if (participant->impl->spdp) {
+            lwdistcomm_dds_spdp_set_endpoint_callback(participant->impl->spdp, spdp_endpoint_callback, NULL);
             lwdistcomm_dds_spdp_start(participant->impl->spdp);
         }
     }
@@ -13,6 +13,7 @@ extern "C" {
  */
 struct lwdistcomm_dds_domain_participant_impl_s {
     lwdistcomm_dds_domainid_t domain_id;
+    uint32_t participant_id;
     bool enabled;
     bool automatic_discovery;
     uint32_t discovery_port;
@@ -58,6 +59,9 @@ struct lwdistcomm_dds_domain_participant_impl_s {
     /* SPDP相关 */
     lwdistcomm_dds_spdp_t *spdp;
     
+    /* 本地端点ID分配 */
+    uint32_t next_endpoint_id;
+    
     /* 互斥锁 */
     pthread_mutex_t mutex;
 };
@@ -102,6 +106,38 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_domain_participant_impl_add_subscriber(l
  */
 lwdistcomm_dds_retcode_t lwdistcomm_dds_domain_participant_impl_remove_subscriber(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_subscriber_t *subscriber);
 
+/**
+ * 为新DataWriter分配端点ID，并建立本地和已发现远端DataReader的定位器
+ */
+void lwdistcomm_dds_domain_participant_impl_match_writer(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_writer_t *writer);
+
+/**
+ * DataReader匹配或移除时更新同名主题下所有DataWriter的定位器，multicast表示DataReader已加入主题组播组，
+ * filter为DataReader的内容过滤条件
+ */
+void lwdistcomm_dds_domain_participant_impl_match_reader(lwdistcomm_dds_domain_participant_impl_t *impl, const char *topic_name, uint32_t participant_id, uint32_t endpoint_id, const char *ip, uint16_t port,
+                                                         bool multicast, const lwdistcomm_dds_content_filter_t *filter, bool matched);
+
+/**
+ * 注册本地DataReader端点：分配端点ID，匹配本地DataWriter并通过SPDP宣告
+ */
+void lwdistcomm_dds_domain_participant_impl_add_reader_endpoint(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_reader_t *reader);
+
+/**
+ * 本地DataReader的组播状态或过滤条件变化后更新本地DataWriter的定位器并通过SPDP重新宣告
+ */
+void lwdistcomm_dds_domain_participant_impl_update_reader_endpoint(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_reader_t *reader);
+
+/**
+ * 注销本地DataReader端点
+ */
+void lwdistcomm_dds_domain_participant_impl_remove_reader_endpoint(lwdistcomm_dds_domain_participant_impl_t *impl, lwdistcomm_dds_data_reader_t *reader);
+
+/**
+ * 通过SPDP重新宣告所有本地DataReader端点
+ */
+void lwdistcomm_dds_domain_participant_impl_announce_endpoints(lwdistcomm_dds_domain_participant_impl_t *impl);
+
 /**
  * 启动发现线程
  */
@@ -8,9 +8,10 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <time.h>
+#include <endian.h>
 
 #define SPDP_MAGIC "SPDP"
-#define SPDP_VERSION 1
+#define SPDP_VERSION 3
 #define SPDP_DEFAULT_MULTICAST_ADDRESS "239.255.0.1"
 #define SPDP_DEFAULT_MULTICAST_PORT 7400
 #define SPDP_DEFAULT_ANNOUNCE_INTERVAL_SEC 3
@@ -18,6 +19,7 @@
 #define SPDP_MAX_MESSAGE_SIZE 4096
 #define SPDP_MAX_DISCOVERED_PARTICIPANTS 128
 #define SPDP_MAX_DISCOVERED_TOPICS 256
+#define SPDP_MAX_DISCOVERED_ENDPOINTS 256
 
 /**
  * SPDP内部实现结构
@@ -31,6 +33,7 @@ struct lwdistcomm_dds_spdp_impl_s {
     pthread_t thread;
     bool running;
     bool thread_running;
+    bool announce_pending;
     pthread_mutex_t mutex;
     
     /* 已发现的参与者 */
@@ -50,11 +53,22 @@ struct lwdistcomm_dds_spdp_impl_s {
     } discovered_topics[SPDP_MAX_DISCOVERED_TOPICS];
     uint32_t num_discovered_topics;
     
+    /* 已发现的远端端点 */
+    struct spdp_discovered_endpoint {
+        lwdistcomm_dds_spdp_topic_info_t topic;
+        lwdistcomm_dds_spdp_endpoint_info_t info;
+        time_t last_seen;
+        uint32_t participant_id;
+    } discovered_endpoints[SPDP_MAX_DISCOVERED_ENDPOINTS];
+    uint32_t num_discovered_endpoints;
+    
     /* 回调函数 */
     lwdistcomm_dds_spdp_participant_callback_t participant_callback;
     void *participant_callback_arg;
     lwdistcomm_dds_spdp_topic_callback_t topic_callback;
     void *topic_callback_arg;
+    lwdistcomm_dds_spdp_endpoint_callback_t endpoint_callback;
+    void *endpoint_callback_arg;
 };
 
 /**
@@ -179,6 +193,32 @@ static int serialize_spdp_message(const lwdistcomm_dds_spdp_message_t *msg, char
     memcpy(buffer + offset, &port, sizeof(port));
     offset += sizeof(port);
     
+    memcpy(buffer + offset, &msg->endpoint.multicast, sizeof(msg->endpoint.multicast));
+    offset += sizeof(msg->endpoint.multicast);
+    
+    /* 序列化内容过滤条件，数值范围以IEEE 754位模式传输 */
+    uint8_t num_prefixes = (uint8_t)msg->endpoint.filter.num_prefixes;
+    memcpy(buffer + offset, &num_prefixes, sizeof(num_prefixes));
+    offset += sizeof(num_prefixes);
+    
+    memcpy(buffer + offset, msg->endpoint.filter.prefixes, sizeof(msg->endpoint.filter.prefixes));
+    offset += sizeof(msg->endpoint.filter.prefixes);
+    
+    uint8_t has_range = msg->endpoint.filter.has_range ? 1 : 0;
+    memcpy(buffer + offset, &has_range, sizeof(has_range));
+    offset += sizeof(has_range);
+    
+    uint64_t bits;
+    memcpy(&bits, &msg->endpoint.filter.min_value, sizeof(bits));
+    bits = htobe64(bits);
+    memcpy(buffer + offset, &bits, sizeof(bits));
+    offset += sizeof(bits);
+    
+    memcpy(&bits, &msg->endpoint.filter.max_value, sizeof(bits));
+    bits = htobe64(bits);
+    memcpy(buffer + offset, &bits, sizeof(bits));
+    offset += sizeof(bits);
+    
     /* 序列化主题数量 */
     uint32_t num_topics = htonl(msg->num_topics);
     memcpy(buffer + offset, &num_topics, sizeof(num_topics));
@@ -339,6 +379,34 @@ static int deserialize_spdp_message(const char *buffer, size_t buffer_size, lwdi
     msg->endpoint.port = ntohs(port);
     offset += sizeof(port);
     
+    memcpy(&msg->endpoint.multicast, buffer + offset, sizeof(msg->endpoint.multicast));
+    offset += sizeof(msg->endpoint.multicast);
+    
+    /* 反序列化内容过滤条件 */
+    uint8_t num_prefixes;
+    memcpy(&num_prefixes, buffer + offset, sizeof(num_prefixes));
+    msg->endpoint.filter.num_prefixes = num_prefixes < LWDISTCOMM_DDS_MAX_FILTER_PREFIXES ? num_prefixes : LWDISTCOMM_DDS_MAX_FILTER_PREFIXES;
+    offset += sizeof(num_prefixes);
+    
+    memcpy(msg->endpoint.filter.prefixes, buffer + offset, sizeof(msg->endpoint.filter.prefixes));
+    offset += sizeof(msg->endpoint.filter.prefixes);
+    
+    uint8_t has_range;
+    memcpy(&has_range, buffer + offset, sizeof(has_range));
+    msg->endpoint.filter.has_range = has_range != 0;
+    offset += sizeof(has_range);
+    
+    uint64_t bits;
+    memcpy(&bits, buffer + offset, sizeof(bits));
+    bits = be64toh(bits);
+    memcpy(&msg->endpoint.filter.min_value, &bits, sizeof(bits));
+    offset += sizeof(bits);
+    
+    memcpy(&bits, buffer + offset, sizeof(bits));
+    bits = be64toh(bits);
+    memcpy(&msg->endpoint.filter.max_value, &bits, sizeof(bits));
+    offset += sizeof(bits);
+    
     /* 反序列化主题数量 */
     uint32_t num_topics;
     memcpy(&num_topics, buffer + offset, sizeof(num_topics));
@@ -369,6 +437,25 @@ static int deserialize_spdp_message(const char *buffer, size_t buffer_size, lwdi
     return offset;
 }
 
+/**
+ * 比较内容过滤条件，前缀只比较有效部分
+ */
+static bool filter_equal(const lwdistcomm_dds_content_filter_t *a, const lwdistcomm_dds_content_filter_t *b)
+{
+    if (a->num_prefixes != b->num_prefixes || a->has_range != b->has_range ||
+        (a->has_range && (a->min_value != b->min_value || a->max_value != b->max_value))) {
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < a->num_prefixes && i < LWDISTCOMM_DDS_MAX_FILTER_PREFIXES; i++) {
+        if (strncmp(a->prefixes[i], b->prefixes[i], LWDISTCOMM_DDS_MAX_FILTER_PREFIX_LEN) != 0) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
 /**
  * 发送SPDP消息
  */
@@ -392,6 +479,78 @@ static int send_spdp_message(struct lwdistcomm_dds_spdp_impl_s *impl, const lwdi
     return ret;
 }
 
+/**
+ * 处理端点宣告和移除消息，调用者持有impl->mutex
+ */
+static void process_endpoint_message(struct lwdistcomm_dds_spdp_impl_s *impl, lwdistcomm_dds_spdp_message_t *msg, const struct sockaddr_in *sender_addr)
+{
+    lwdistcomm_dds_spdp_endpoint_info_t *endpoint = &msg->endpoint;
+    
+    /* 未携带单播地址时使用报文源地址，发现时解析一次，写入路径不再处理地址 */
+    endpoint->transport_address[sizeof(endpoint->transport_address) - 1] = '\0';
+    if (endpoint->transport_address[0] == '\0' || strcmp(endpoint->transport_address, "0.0.0.0") == 0) {
+        inet_ntop(AF_INET, &sender_addr->sin_addr, endpoint->transport_address, sizeof(endpoint->transport_address));
+    }
+    msg->topic.topic_name[sizeof(msg->topic.topic_name) - 1] = '\0';
+    
+    for (uint32_t i = 0; i < impl->num_discovered_endpoints; i++) {
+        struct spdp_discovered_endpoint *entry = &impl->discovered_endpoints[i];
+        if (entry->participant_id != msg->header.participant_id || entry->info.endpoint_id != endpoint->endpoint_id) {
+            continue;
+        }
+        
+        if (msg->header.message_type == LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_REMOVE) {
+            /* 移除端点 */
+            if (impl->endpoint_callback) {
+                impl->endpoint_callback(impl->participant, entry->participant_id, &entry->topic, &entry->info, false, impl->endpoint_callback_arg);
+            }
+            impl->num_discovered_endpoints--;
+            if (i < impl->num_discovered_endpoints) {
+                impl->discovered_endpoints[i] = impl->discovered_endpoints[impl->num_discovered_endpoints];
+            }
+            return;
+        }
+        
+        /* 地址或端口变化时视为重新发现 */
+        if (strcmp(entry->info.transport_address, endpoint->transport_address) != 0 || entry->info.port != endpoint->port ||
+            entry->info.multicast != endpoint->multicast) {
+            if (impl->endpoint_callback) {
+                impl->endpoint_callback(impl->participant, entry->participant_id, &entry->topic, &entry->info, false, impl->endpoint_callback_arg);
+            }
+            entry->info = *endpoint;
+            entry->topic = msg->topic;
+            if (impl->endpoint_callback) {
+                impl->endpoint_callback(impl->participant, entry->participant_id, &entry->topic, &entry->info, true, impl->endpoint_callback_arg);
+            }
+        } else if (!filter_equal(&entry->info.filter, &endpoint->filter)) {
+            /* 只有过滤条件变化时原地更新，DataWriter保留该DataReader的确认状态 */
+            entry->info = *endpoint;
+            if (impl->endpoint_callback) {
+                impl->endpoint_callback(impl->participant, entry->participant_id, &entry->topic, &entry->info, true, impl->endpoint_callback_arg);
+            }
+        }
+        entry->last_seen = time(NULL);
+        return;
+    }
+    
+    if (msg->header.message_type != LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_ANNOUNCE ||
+        impl->num_discovered_endpoints >= SPDP_MAX_DISCOVERED_ENDPOINTS) {
+        return;
+    }
+    
+    /* 添加新端点 */
+    struct spdp_discovered_endpoint *entry = &impl->discovered_endpoints[impl->num_discovered_endpoints++];
+    entry->topic = msg->topic;
+    entry->info = *endpoint;
+    entry->participant_id = msg->header.participant_id;
+    entry->last_seen = time(NULL);
+    
+    /* 调用端点回调 */
+    if (impl->endpoint_callback) {
+        impl->endpoint_callback(impl->participant, entry->participant_id, &entry->topic, &entry->info, true, impl->endpoint_callback_arg);
+    }
+}
+
 /**
  * 处理接收到的SPDP消息
  */
@@ -444,6 +603,9 @@ static void process_spdp_message(struct lwdistcomm_dds_spdp_impl_s *impl, const
             impl->discovered_participants[impl->num_discovered_participants].port = msg.endpoint.port;
             impl->num_discovered_participants++;
             
+            /* 新参与者加入时立即重新宣告，使其无需等待宣告周期即可匹配本地端点 */
+            impl->announce_pending = true;
+            
             /* 调用参与者回调 */
             if (impl->participant_callback) {
                 impl->participant_callback(impl->participant, &msg.participant, true, impl->participant_callback_arg);
@@ -508,6 +670,12 @@ static void process_spdp_message(struct lwdistcomm_dds_spdp_impl_s *impl, const
         }
     }
     
+    /* 处理端点宣告和移除消息 */
+    if (msg.header.message_type == LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_ANNOUNCE ||
+        msg.header.message_type == LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_REMOVE) {
+        process_endpoint_message(impl, &msg, sender_addr);
+    }
+    
     pthread_mutex_unlock(&impl->mutex);
     
 cleanup:
@@ -549,6 +717,22 @@ static void cleanup_expired_entries(struct lwdistcomm_dds_spdp_impl_s *impl)
         }
     }
     
+    /* 清理过期的端点，通知匹配的写入器移除定位器 */
+    for (uint32_t i = 0; i < impl->num_discovered_endpoints; i++) {
+        if (now - impl->discovered_endpoints[i].last_seen > SPDP_DEFAULT_LEASE_DURATION_SEC) {
+            if (impl->endpoint_callback) {
+                impl->endpoint_callback(impl->participant, impl->discovered_endpoints[i].participant_id,
+                                        &impl->discovered_endpoints[i].topic, &impl->discovered_endpoints[i].info,
+                                        false, impl->endpoint_callback_arg);
+            }
+            impl->num_discovered_endpoints--;
+            if (i < impl->num_discovered_endpoints) {
+                impl->discovered_endpoints[i] = impl->discovered_endpoints[impl->num_discovered_endpoints];
+            }
+            i--;
+        }
+    }
+    
     pthread_mutex_unlock(&impl->mutex);
 }
 
@@ -628,13 +812,19 @@ static void *spdp_thread_func(void *arg)
         time_t now = time(NULL);
         
         /* 定期发送宣告消息 */
-        if (now - last_announce >= impl->config.announce_interval_sec) {
+        if (now - last_announce >= impl->config.announce_interval_sec || impl->announce_pending) {
+            impl->announce_pending = false;
             lwdistcomm_dds_spdp_message_t msg;
             build_participant_announce_message(impl, &msg);
             send_spdp_message(impl, &msg);
             if (msg.topics) {
                 free(msg.topics);
             }
+            
+            /* 重新宣告本地读取器端点，供后加入的参与者建立定位器 */
+            if (impl->participant && impl->participant->impl) {
+                lwdistcomm_dds_domain_participant_impl_announce_endpoints(impl->participant->impl);
+            }
             last_announce = now;
         }
         
@@ -720,12 +910,16 @@ lwdistcomm_dds_spdp_t *lwdistcomm_dds_spdp_create(
     impl->participant = participant;
     impl->running = false;
     impl->thread_running = false;
+    impl->announce_pending = false;
     impl->num_discovered_participants = 0;
     impl->num_discovered_topics = 0;
     impl->participant_callback = NULL;
     impl->participant_callback_arg = NULL;
     impl->topic_callback = NULL;
     impl->topic_callback_arg = NULL;
+    impl->num_discovered_endpoints = 0;
+    impl->endpoint_callback = NULL;
+    impl->endpoint_callback_arg = NULL;
     
     pthread_mutex_init(&impl->mutex, NULL);
     
@@ -950,6 +1144,73 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_send_topic_announce(
     return ret >= 0 ? LWDISTCOMM_DDS_RETCODE_OK : LWDISTCOMM_DDS_RETCODE_ERROR;
 }
 
+/**
+ * 发送端点宣告或移除消息
+ */
+static lwdistcomm_dds_retcode_t send_endpoint_message(
+    lwdistcomm_dds_spdp_t *spdp,
+    const lwdistcomm_dds_topic_t *topic,
+    const lwdistcomm_dds_spdp_endpoint_info_t *endpoint,
+    lwdistcomm_dds_spdp_message_type_t message_type
+)
+{
+    if (!spdp || !spdp->impl || !topic || !endpoint) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    struct lwdistcomm_dds_spdp_impl_s *impl = spdp->impl;
+    
+    lwdistcomm_dds_spdp_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    
+    /* 填充消息头部 */
+    memcpy(msg.header.magic, SPDP_MAGIC, 4);
+    msg.header.version = SPDP_VERSION;
+    msg.header.message_type = message_type;
+    msg.header.domain_id = impl->config.domain_id;
+    msg.header.participant_id = impl->config.participant_id;
+    
+    /* 设置时间戳 */
+    get_current_timestamp(&msg.header.timestamp_sec, &msg.header.timestamp_nsec);
+    
+    /* 填充参与者信息 */
+    strncpy(msg.participant.participant_name, impl->config.participant_name, sizeof(msg.participant.participant_name) - 1);
+    
+    /* 填充主题和端点信息 */
+    strncpy(msg.topic.topic_name, topic->name, sizeof(msg.topic.topic_name) - 1);
+    strncpy(msg.topic.type_name, topic->type_name, sizeof(msg.topic.type_name) - 1);
+    msg.topic.topic_id = 1;
+    memcpy(&msg.endpoint, endpoint, sizeof(msg.endpoint));
+    
+    int ret = send_spdp_message(impl, &msg);
+    
+    return ret >= 0 ? LWDISTCOMM_DDS_RETCODE_OK : LWDISTCOMM_DDS_RETCODE_ERROR;
+}
+
+/**
+ * 发送端点宣告消息
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_send_endpoint_announce(
+    lwdistcomm_dds_spdp_t *spdp,
+    const lwdistcomm_dds_topic_t *topic,
+    const lwdistcomm_dds_spdp_endpoint_info_t *endpoint
+)
+{
+    return send_endpoint_message(spdp, topic, endpoint, LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_ANNOUNCE);
+}
+
+/**
+ * 发送端点移除消息
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_send_endpoint_remove(
+    lwdistcomm_dds_spdp_t *spdp,
+    const lwdistcomm_dds_topic_t *topic,
+    const lwdistcomm_dds_spdp_endpoint_info_t *endpoint
+)
+{
+    return send_endpoint_message(spdp, topic, endpoint, LWDISTCOMM_DDS_SPDP_MESSAGE_ENDPOINT_REMOVE);
+}
+
 /**
  * 设置参与者回调函数
  */
@@ -996,6 +1257,58 @@ lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_set_topic_callback(
     return LWDISTCOMM_DDS_RETCODE_OK;
 }
 
+/**
+ * 设置端点回调函数
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_set_endpoint_callback(
+    lwdistcomm_dds_spdp_t *spdp,
+    lwdistcomm_dds_spdp_endpoint_callback_t callback,
+    void *arg
+)
+{
+    if (!spdp || !spdp->impl) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    struct lwdistcomm_dds_spdp_impl_s *impl = spdp->impl;
+    
+    pthread_mutex_lock(&impl->mutex);
+    impl->endpoint_callback = callback;
+    impl->endpoint_callback_arg = arg;
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
+/**
+ * 遍历指定主题下已发现的远端端点
+ */
+lwdistcomm_dds_retcode_t lwdistcomm_dds_spdp_foreach_endpoint(
+    lwdistcomm_dds_spdp_t *spdp,
+    const char *topic_name,
+    lwdistcomm_dds_spdp_endpoint_callback_t callback,
+    void *arg
+)
+{
+    if (!spdp || !spdp->impl || !topic_name || !callback) {
+        return LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER;
+    }
+    
+    struct lwdistcomm_dds_spdp_impl_s *impl = spdp->impl;
+    
+    pthread_mutex_lock(&impl->mutex);
+    for (uint32_t i = 0; i < impl->num_discovered_endpoints; i++) {
+        if (strcmp(impl->discovered_endpoints[i].topic.topic_name, topic_name) == 0) {
+            callback(impl->participant, impl->discovered_endpoints[i].participant_id,
+                     &impl->discovered_endpoints[i].topic, &impl->discovered_endpoints[i].info,
+                     true, arg);
+        }
+    }
+    pthread_mutex_unlock(&impl->mutex);
+    
+    return LWDISTCOMM_DDS_RETCODE_OK;
+}
+
 /**
  * 获取已发现的参与者数量
  */
@@ -184,6 +184,35 @@ static void send_topic_remove(lwdistcomm_dds_topic_t *topic)
     send_discovery_msg(dp_impl->discovery_socket, &msg, &broadcast_addr);
 }
 
+/**
+ * 对样本求值内容过滤
+ */
+bool lwdistcomm_dds_topic_impl_filter_match(const lwdistcomm_dds_topic_impl_t *impl, const lwdistcomm_dds_content_filter_t *filter, const void *data, uint32_t size)
+{
+    if (filter->num_prefixes && impl->key_extract) {
+        uint8_t key[LWDISTCOMM_DDS_MAX_KEY_SIZE];
+        uint32_t len = impl->key_extract(data, size, key, sizeof(key), impl->key_arg);
+        bool matched = false;
+        
+        for (uint32_t i = 0; i < filter->num_prefixes && i < LWDISTCOMM_DDS_MAX_FILTER_PREFIXES && !matched; i++) {
+            size_t prefix_len = strnlen(filter->prefixes[i], LWDISTCOMM_DDS_MAX_FILTER_PREFIX_LEN);
+            matched = len <= sizeof(key) && prefix_len <= len && memcmp(key, filter->prefixes[i], prefix_len) == 0;
+        }
+        if (!matched) {
+            return false;
+        }
+    }
+    
+    if (filter->has_range && impl->value_extract) {
+        double value;
+        if (!impl->value_extract(data, size, &value, impl->value_arg) || value < filter->min_value || value > filter->max_value) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
 /**
  * 创建Topic内部实现
  */
@@ -215,6 +244,10 @@ lwdistcomm_dds_topic_impl_t *lwdistcomm_dds_topic_impl_create(const lwdistcomm_d
     
     impl->enabled = false;
     impl->participant = participant;
+    impl->key_extract = options->key_extract;
+    impl->key_arg = options->key_arg;
+    impl->value_extract = options->value_extract;
+    impl->value_arg = options->value_arg;
     
     /* 初始化数据写入器列表 */
     impl->data_writers = (lwdistcomm_dds_data_writer_t **)malloc(sizeof(lwdistcomm_dds_data_writer_t *) * MAX_DATA_WRITERS);
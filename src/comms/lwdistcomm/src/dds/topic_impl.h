@@ -17,6 +17,14 @@ struct lwdistcomm_dds_topic_impl_s {
     bool enabled;
     lwdistcomm_dds_domain_participant_t *participant;
     
+    /* 键提取回调，NULL表示无键主题 */
+    lwdistcomm_dds_key_extract_cb_t key_extract;
+    void *key_arg;
+    
+    /* 数值提取回调，用于内容过滤 */
+    lwdistcomm_dds_value_extract_cb_t value_extract;
+    void *value_arg;
+    
     /* 数据写入器列表 */
     lwdistcomm_dds_data_writer_t **data_writers;
     uint32_t num_data_writers;
@@ -41,6 +49,19 @@ lwdistcomm_dds_topic_impl_t *lwdistcomm_dds_topic_impl_create(const lwdistcomm_d
  */
 void lwdistcomm_dds_topic_impl_destroy(lwdistcomm_dds_topic_impl_t *impl);
 
+/**
+ * 内容过滤条件是否生效
+ */
+static inline bool lwdistcomm_dds_content_filter_active(const lwdistcomm_dds_content_filter_t *filter)
+{
+    return filter && (filter->num_prefixes || filter->has_range);
+}
+
+/**
+ * 按主题的键和数值提取回调对样本求值内容过滤，主题缺少对应回调时该条件视为通过
+ */
+bool lwdistcomm_dds_topic_impl_filter_match(const lwdistcomm_dds_topic_impl_t *impl, const lwdistcomm_dds_content_filter_t *filter, const void *data, uint32_t size);
+
 /**
  * 添加DataWriter到Topic
  */
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2026 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: lz4.c LZ4 block codec implementation for LwDistComm.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "lz4_impl.h"
+
+/* Block format constants */
+#define LWDISTCOMM_LZ4_MINMATCH      4
+#define LWDISTCOMM_LZ4_LASTLITERALS  5      // Last bytes of a block are always literals
+#define LWDISTCOMM_LZ4_MFLIMIT       12     // Last match starts at least this far from the end
+#define LWDISTCOMM_LZ4_MAX_DISTANCE  65535
+#define LWDISTCOMM_LZ4_RUN_MASK      15
+#define LWDISTCOMM_LZ4_SKIP_TRIGGER  6      // Search step grows every 64 misses on incompressible data
+
+/* Unaligned loads */
+static inline uint32_t lwdistcomm_lz4_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t lwdistcomm_lz4_read64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Hash of 4 input bytes */
+static inline uint32_t lwdistcomm_lz4_hash(uint32_t seq)
+{
+    return (seq * 2654435761U) >> (32 - LWDISTCOMM_LZ4_HASH_LOG);
+}
+
+/* Length of the common prefix of ip and match, ip stops at limit */
+static inline size_t lwdistcomm_lz4_count(const uint8_t *ip, const uint8_t *match, const uint8_t *limit)
+{
+    const uint8_t *start = ip;
+
+    while (ip + sizeof(uint64_t) <= limit) {
+        uint64_t diff = lwdistcomm_lz4_read64(ip) ^ lwdistcomm_lz4_read64(match);
+        if (diff) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            return (size_t)(ip - start) + ((size_t)__builtin_ctzll(diff) >> 3);
+#else
+            return (size_t)(ip - start) + ((size_t)__builtin_clzll(diff) >> 3);
+#endif
+        }
+        ip += sizeof(uint64_t);
+        match += sizeof(uint64_t);
+    }
+
+    while (ip < limit && *ip == *match) {
+        ip++;
+        match++;
+    }
+
+    return (size_t)(ip - start);
+}
+
+/* Write length extension bytes of a token field */
+static inline uint8_t *lwdistcomm_lz4_put_len(uint8_t *op, size_t len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+
+    return op;
+}
+
+/* Write the literal run of a sequence, returns the token */
+static inline uint8_t *lwdistcomm_lz4_put_literals(uint8_t **op, const uint8_t *anchor, size_t lit)
+{
+    uint8_t *token = (*op)++;
+
+    if (lit >= LWDISTCOMM_LZ4_RUN_MASK) {
+        *token = LWDISTCOMM_LZ4_RUN_MASK << 4;
+        *op = lwdistcomm_lz4_put_len(*op, lit - LWDISTCOMM_LZ4_RUN_MASK);
+    } else {
+        *token = (uint8_t)(lit << 4);
+    }
+    memcpy(*op, anchor, lit);
+    *op += lit;
+
+    return token;
+}
+
+/* Compress */
+size_t lwdistcomm_lz4_compress(const void *src, size_t len, void *dst, size_t cap)
+{
+    const uint8_t *base = (const uint8_t *)src;
+    const uint8_t *ip = base;
+    const uint8_t *anchor = base;
+    const uint8_t *iend = base + len;
+    uint8_t *op = (uint8_t *)dst;
+    uint8_t *oend = op + cap;
+    size_t lit;
+
+    if (len > LWDISTCOMM_LZ4_MAX_INPUT) {
+        return 0;
+    }
+
+    // Inputs shorter than a minimal match plus the literal tail are stored as literals
+    if (len > LWDISTCOMM_LZ4_MFLIMIT) {
+        const uint8_t *mflimit = iend - LWDISTCOMM_LZ4_MFLIMIT;
+        const uint8_t *matchlimit = iend - LWDISTCOMM_LZ4_LASTLITERALS;
+        uint32_t table[1 << LWDISTCOMM_LZ4_HASH_LOG];
+
+        memset(table, 0, sizeof(table));
+        ip++;
+
+        for (;;) {
+            const uint8_t *match;
+            unsigned attempts = 1 << LWDISTCOMM_LZ4_SKIP_TRIGGER;
+
+            // Find a match, empty table slots point at the block start and fail the compare
+            for (;;) {
+                if (ip > mflimit) {
+                    goto last;
+                }
+                uint32_t seq = lwdistcomm_lz4_read32(ip);
+                uint32_t h = lwdistcomm_lz4_hash(seq);
+                match = base + table[h];
+                table[h] = (uint32_t)(ip - base);
+                if (match < ip && ip - match <= LWDISTCOMM_LZ4_MAX_DISTANCE && lwdistcomm_lz4_read32(match) == seq) {
+                    break;
+                }
+                ip += attempts++ >> LWDISTCOMM_LZ4_SKIP_TRIGGER;
+            }
+
+            // Extend backwards into pending literals
+            while (ip > anchor && match > base && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+
+            lit = (size_t)(ip - anchor);
+            size_t mlen = lwdistcomm_lz4_count(ip + LWDISTCOMM_LZ4_MINMATCH, match + LWDISTCOMM_LZ4_MINMATCH, matchlimit);
+            if ((size_t)(oend - op) < lit + lit / 255 + mlen / 255 + 5) {
+                return 0;
+            }
+
+            uint8_t *token = lwdistcomm_lz4_put_literals(&op, anchor, lit);
+            uint16_t offset = (uint16_t)(ip - match);
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            if (mlen >= LWDISTCOMM_LZ4_RUN_MASK) {
+                *token |= LWDISTCOMM_LZ4_RUN_MASK;
+                op = lwdistcomm_lz4_put_len(op, mlen - LWDISTCOMM_LZ4_RUN_MASK);
+            } else {
+                *token |= (uint8_t)mlen;
+            }
+
+            ip += LWDISTCOMM_LZ4_MINMATCH + mlen;
+            anchor = ip;
+            if (ip > mflimit) {
+                break;
+            }
+            table[lwdistcomm_lz4_hash(lwdistcomm_lz4_read32(ip - 2))] = (uint32_t)(ip - 2 - base);
+        }
+    }
+
+last:
+    lit = (size_t)(iend - anchor);
+    if ((size_t)(oend - op) < lit + lit / 255 + 2) {
+        return 0;
+    }
+    lwdistcomm_lz4_put_literals(&op, anchor, lit);
+
+    return (size_t)(op - (uint8_t *)dst);
+}
+
+/* Read length extension bytes of a token field */
+static inline bool lwdistcomm_lz4_get_len(const uint8_t **ip, const uint8_t *iend, size_t *len)
+{
+    uint8_t b;
+
+    do {
+        if (*ip >= iend) {
+            return false;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+
+    return true;
+}
+
+/* Decompress */
+long lwdistcomm_lz4_decompress(const void *src, size_t len, void *dst, size_t cap)
+{
+    const uint8_t *ip = (const uint8_t *)src;
+    const uint8_t *iend = ip + len;
+    uint8_t *op = (uint8_t *)dst;
+    uint8_t *oend = op + cap;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        // Literal run
+        size_t lit = token >> 4;
+        if (lit == LWDISTCOMM_LZ4_RUN_MASK && !lwdistcomm_lz4_get_len(&ip, iend, &lit)) {
+            return -1;
+        }
+        if (lit > (size_t)(iend - ip) || lit > (size_t)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+
+        // The last sequence has no match
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - (uint8_t *)dst)) {
+            return -1;
+        }
+
+        size_t mlen = token & LWDISTCOMM_LZ4_RUN_MASK;
+        if (mlen == LWDISTCOMM_LZ4_RUN_MASK && !lwdistcomm_lz4_get_len(&ip, iend, &mlen)) {
+            return -1;
+        }
+        mlen += LWDISTCOMM_LZ4_MINMATCH;
+        if (mlen > (size_t)(oend - op)) {
+            return -1;
+        }
+
+        // Overlapping copies repeat the last offset bytes
+        const uint8_t *match = op - offset;
+        if (offset >= mlen) {
+            memcpy(op, match, mlen);
+            op += mlen;
+        } else {
+            while (mlen--) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return (long)(op - (uint8_t *)dst);
+}
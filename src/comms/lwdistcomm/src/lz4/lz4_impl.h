@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2026 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: lz4_impl.h LZ4 block codec internal implementation for LwDistComm.
+ *
+ */
+
+#ifndef LWDISTCOMM_LZ4_IMPL_H
+#define LWDISTCOMM_LZ4_IMPL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * LZ4 block format (no frame header, no checksum), interoperable with
+ * LZ4_compress_default() / LZ4_decompress_safe() of the reference library.
+ * The compressor is the single pass greedy variant, tuned for speed.
+ */
+
+/* Hash table of the compressor, 4K positions on the stack */
+#define LWDISTCOMM_LZ4_HASH_LOG     12
+
+/* Max input accepted */
+#define LWDISTCOMM_LZ4_MAX_INPUT    0x7e000000
+
+/* Worst case compressed size */
+#define LWDISTCOMM_LZ4_BOUND(len)   ((len) + (len) / 255 + 16)
+
+/* Compress len bytes into dst, returns compressed length or 0 when it does not fit in cap */
+size_t lwdistcomm_lz4_compress(const void *src, size_t len, void *dst, size_t cap);
+
+/* Decompress len bytes into dst, returns decompressed length or -1 on malformed input or overflow of cap */
+long lwdistcomm_lz4_decompress(const void *src, size_t len, void *dst, size_t cap);
+
+#endif /* LWDISTCOMM_LZ4_IMPL_H */
@@ -11,8 +11,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 #include "../../include/message.h"
+#include "../lz4/lz4_impl.h"
 
 #define LWDISTCOMM_MSG_MAGIC    0x9
 #define LWDISTCOMM_MSG_VERSION  0x1
@@ -20,6 +22,106 @@
 #define LWDISTCOMM_MSG_MAX_LEN  131072
 #define LWDISTCOMM_MSG_MAX_DATA (LWDISTCOMM_MSG_MAX_LEN - LWDISTCOMM_MSG_HDR_LEN)
 
+/* Receive buffer pool, power of two size classes from 1 KiB to max packet size */
+#define LWDISTCOMM_MSG_POOL_MIN_SHIFT  10
+#define LWDISTCOMM_MSG_POOL_MAX_SHIFT  17
+#define LWDISTCOMM_MSG_POOL_CLASSES    (LWDISTCOMM_MSG_POOL_MAX_SHIFT - LWDISTCOMM_MSG_POOL_MIN_SHIFT + 1)
+#define LWDISTCOMM_MSG_POOL_CACHE      8
+
+/* Frames dispatched in place may start at any offset, strict alignment targets bounce them */
+#if defined(__i386__) || defined(__x86_64__) || defined(__aarch64__)
+#define LWDISTCOMM_MSG_ALIGN_MASK  0
+#else
+#define LWDISTCOMM_MSG_ALIGN_MASK  (sizeof(uint32_t) - 1)
+#endif
+
+/* Pool free block */
+typedef struct lwdistcomm_msg_pool_blk {
+    struct lwdistcomm_msg_pool_blk *next;
+} lwdistcomm_msg_pool_blk_t;
+
+/* Receive buffer pool */
+static struct {
+    pthread_mutex_t lock;
+    lwdistcomm_msg_pool_blk_t *free[LWDISTCOMM_MSG_POOL_CLASSES];
+    uint32_t count[LWDISTCOMM_MSG_POOL_CLASSES];
+} lwdistcomm_msg_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/* Pool size class of a buffer length */
+static int lwdistcomm_msg_pool_class(size_t len)
+{
+    int cls = 0;
+
+    while (cls < LWDISTCOMM_MSG_POOL_CLASSES - 1 && ((size_t)1 << (cls + LWDISTCOMM_MSG_POOL_MIN_SHIFT)) < len) {
+        cls++;
+    }
+
+    return cls;
+}
+
+/* Pool allocate */
+static void *lwdistcomm_msg_pool_alloc(int cls)
+{
+    lwdistcomm_msg_pool_blk_t *blk;
+
+    pthread_mutex_lock(&lwdistcomm_msg_pool.lock);
+    blk = lwdistcomm_msg_pool.free[cls];
+    if (blk) {
+        lwdistcomm_msg_pool.free[cls] = blk->next;
+        lwdistcomm_msg_pool.count[cls]--;
+    }
+    pthread_mutex_unlock(&lwdistcomm_msg_pool.lock);
+
+    if (!blk) {
+        blk = (lwdistcomm_msg_pool_blk_t *)malloc((size_t)1 << (cls + LWDISTCOMM_MSG_POOL_MIN_SHIFT));
+    }
+
+    return blk;
+}
+
+/* Pool free, keep a few buffers of each class cached */
+static void lwdistcomm_msg_pool_free(int cls, void *buffer)
+{
+    lwdistcomm_msg_pool_blk_t *blk = (lwdistcomm_msg_pool_blk_t *)buffer;
+
+    pthread_mutex_lock(&lwdistcomm_msg_pool.lock);
+    if (lwdistcomm_msg_pool.count[cls] < LWDISTCOMM_MSG_POOL_CACHE) {
+        blk->next = lwdistcomm_msg_pool.free[cls];
+        lwdistcomm_msg_pool.free[cls] = blk;
+        lwdistcomm_msg_pool.count[cls]++;
+        blk = NULL;
+    }
+    pthread_mutex_unlock(&lwdistcomm_msg_pool.lock);
+
+    free(blk);
+}
+
+/* Make receive buffer hold at least len bytes, buffered data is preserved */
+static bool lwdistcomm_msg_recv_reserve(lwdistcomm_msg_recv_t *recv, size_t len)
+{
+    if (recv->size >= len) {
+        return true;
+    }
+
+    int cls = lwdistcomm_msg_pool_class(len);
+    uint8_t *buffer = (uint8_t *)lwdistcomm_msg_pool_alloc(cls);
+    if (!buffer) {
+        return false;
+    }
+
+    if (recv->buffer) {
+        memcpy(buffer, recv->buffer, recv->cur_len);
+        lwdistcomm_msg_pool_free(lwdistcomm_msg_pool_class(recv->size), recv->buffer);
+    }
+
+    recv->buffer = buffer;
+    recv->size = (uint32_t)1 << (cls + LWDISTCOMM_MSG_POOL_MIN_SHIFT);
+
+    return true;
+}
+
 /* Initialize message header */
 lwdistcomm_msg_header_t *lwdistcomm_msg_init_header(void *buffer, uint8_t type, uint8_t status, uint16_t seqno)
 {
@@ -42,6 +144,31 @@ void lwdistcomm_msg_init_recv(lwdistcomm_msg_recv_t *recv)
 {
     if (recv) {
         memset(recv, 0, sizeof(lwdistcomm_msg_recv_t));
+        recv->max_len = LWDISTCOMM_MSG_MAX_LEN;
+    }
+}
+
+/* Set max message size accepted by receive buffer */
+void lwdistcomm_msg_set_recv_max(lwdistcomm_msg_recv_t *recv, size_t max_len)
+{
+    if (recv) {
+        if (max_len == 0 || max_len > LWDISTCOMM_MSG_MAX_LEN) {
+            max_len = LWDISTCOMM_MSG_MAX_LEN;
+        } else if (max_len < LWDISTCOMM_MSG_HDR_LEN) {
+            max_len = LWDISTCOMM_MSG_HDR_LEN;
+        }
+        recv->max_len = (uint32_t)max_len;
+    }
+}
+
+/* Release receive buffer storage to pool */
+void lwdistcomm_msg_free_recv(lwdistcomm_msg_recv_t *recv)
+{
+    if (recv && recv->buffer) {
+        lwdistcomm_msg_pool_free(lwdistcomm_msg_pool_class(recv->size), recv->buffer);
+        recv->buffer = NULL;
+        recv->size = 0;
+        recv->cur_len = 0;
     }
 }
 
@@ -111,6 +238,46 @@ bool lwdistcomm_msg_set_payload(lwdistcomm_msg_header_t *header, const lwdistcom
     return true;
 }
 
+/* Set message URL and payload as scatter-gather vector */
+int lwdistcomm_msg_set_iov(lwdistcomm_msg_header_t *header, const char *url, const lwdistcomm_message_t *msg, struct iovec *iov, size_t *total_len)
+{
+    int iovcnt = 0;
+    size_t url_len = url ? strlen(url) : 0;
+    size_t data_len = (msg && msg->data) ? msg->data_len : 0;
+
+    if (!header || !iov || !total_len) {
+        return -1;
+    }
+
+    if (url_len > 0xFFFF || data_len > LWDISTCOMM_MSG_MAX_DATA ||
+        LWDISTCOMM_MSG_HDR_LEN + url_len + data_len > LWDISTCOMM_MSG_MAX_LEN) {
+        return -1;
+    }
+
+    header->url_len = htons((uint16_t)url_len);
+    header->data_len = htonl((uint32_t)data_len);
+
+    iov[iovcnt].iov_base = header;
+    iov[iovcnt].iov_len = LWDISTCOMM_MSG_HDR_LEN;
+    iovcnt++;
+
+    if (url_len) {
+        iov[iovcnt].iov_base = (void *)url;
+        iov[iovcnt].iov_len = url_len;
+        iovcnt++;
+    }
+
+    if (data_len) {
+        iov[iovcnt].iov_base = msg->data;
+        iov[iovcnt].iov_len = data_len;
+        iovcnt++;
+    }
+
+    *total_len = LWDISTCOMM_MSG_HDR_LEN + url_len + data_len;
+
+    return iovcnt;
+}
+
 /* Get message URL */
 bool lwdistcomm_msg_get_url(const lwdistcomm_msg_header_t *header, char **url, size_t *url_len)
 {
@@ -150,46 +317,160 @@ bool lwdistcomm_msg_get_payload(const lwdistcomm_msg_header_t *header, lwdistcom
     return true;
 }
 
+/* Dispatch a complete frame, LZ4 payloads are inflated into a pool buffer first */
+static bool lwdistcomm_msg_dispatch(lwdistcomm_msg_recv_t *recv, lwdistcomm_msg_header_t *header, lwdistcomm_msg_input_cb_t callback, void *arg)
+{
+    if (!(header->status & LWDISTCOMM_MSG_FLAG_LZ4)) {
+        return callback(arg, header);
+    }
+
+    size_t url_len = ntohs(header->url_len);
+    size_t data_len = ntohl(header->data_len);
+    const uint8_t *data = (const uint8_t *)header + LWDISTCOMM_MSG_HDR_LEN + url_len;
+    uint32_t orig_len;
+
+    if (data_len < sizeof(orig_len)) {
+        return false;
+    }
+    memcpy(&orig_len, data, sizeof(orig_len));
+    orig_len = ntohl(orig_len);
+
+    size_t total_len = LWDISTCOMM_MSG_HDR_LEN + url_len + orig_len;
+    if (total_len > recv->max_len) {
+        return false;
+    }
+
+    int cls = lwdistcomm_msg_pool_class(total_len);
+    uint8_t *buffer = (uint8_t *)lwdistcomm_msg_pool_alloc(cls);
+    if (!buffer) {
+        return false;
+    }
+
+    memcpy(buffer, header, LWDISTCOMM_MSG_HDR_LEN + url_len);
+    bool ret = lwdistcomm_lz4_decompress(data + sizeof(orig_len), data_len - sizeof(orig_len),
+                                         buffer + LWDISTCOMM_MSG_HDR_LEN + url_len, orig_len) == (long)orig_len;
+    if (ret) {
+        header = (lwdistcomm_msg_header_t *)buffer;
+        header->status &= (uint8_t)~LWDISTCOMM_MSG_FLAG_LZ4;
+        header->data_len = htonl(orig_len);
+        ret = callback(arg, header);
+    }
+
+    lwdistcomm_msg_pool_free(cls, buffer);
+
+    return ret;
+}
+
 /* Process input data */
 bool lwdistcomm_msg_input(lwdistcomm_msg_recv_t *recv, void *buffer, size_t len, lwdistcomm_msg_input_cb_t callback, void *arg)
 {
     if (!recv || !buffer || len == 0) {
         return false;
     }
-    
-    size_t copy_len = len;
-    if (recv->cur_len + len > sizeof(recv->buffer)) {
-        copy_len = sizeof(recv->buffer) - recv->cur_len;
-    }
-    
-    memcpy(recv->buffer + recv->cur_len, buffer, copy_len);
-    recv->cur_len += copy_len;
-    
-    while (recv->cur_len >= LWDISTCOMM_MSG_HDR_LEN) {
-        lwdistcomm_msg_header_t *header = (lwdistcomm_msg_header_t *)recv->buffer;
-        size_t total_len;
-        
-        if (!lwdistcomm_msg_validate_header(header, &total_len)) {
+
+    uint8_t *data = (uint8_t *)buffer;
+    lwdistcomm_msg_header_t *header;
+    size_t total_len, copy_len;
+
+    // Complete the buffered partial frame first
+    if (recv->cur_len) {
+        if (recv->cur_len < LWDISTCOMM_MSG_HDR_LEN) {
+            copy_len = LWDISTCOMM_MSG_HDR_LEN - recv->cur_len;
+            if (copy_len > len) {
+                copy_len = len;
+            }
+            memcpy(recv->buffer + recv->cur_len, data, copy_len);
+            recv->cur_len += copy_len;
+            data += copy_len;
+            len -= copy_len;
+            if (recv->cur_len < LWDISTCOMM_MSG_HDR_LEN) {
+                return true;
+            }
+        }
+
+        header = (lwdistcomm_msg_header_t *)recv->buffer;
+        if (!lwdistcomm_msg_validate_header(header, &total_len) || total_len > recv->max_len) {
+            lwdistcomm_msg_free_recv(recv);
+            return false;
+        }
+
+        if (!lwdistcomm_msg_recv_reserve(recv, total_len)) {
+            lwdistcomm_msg_free_recv(recv);
             return false;
         }
-        
+
+        copy_len = total_len - recv->cur_len;
+        if (copy_len > len) {
+            copy_len = len;
+        }
+        memcpy(recv->buffer + recv->cur_len, data, copy_len);
+        recv->cur_len += copy_len;
+        data += copy_len;
+        len -= copy_len;
         if (recv->cur_len < total_len) {
+            return true;
+        }
+
+        recv->cur_len = 0;
+        if (callback && !lwdistcomm_msg_dispatch(recv, (lwdistcomm_msg_header_t *)recv->buffer, callback, arg)) {
+            lwdistcomm_msg_free_recv(recv);
+            return false;
+        }
+    }
+
+    // Dispatch complete frames in place
+    while (len >= LWDISTCOMM_MSG_HDR_LEN) {
+        header = (lwdistcomm_msg_header_t *)data;
+        if ((uintptr_t)data & LWDISTCOMM_MSG_ALIGN_MASK) {
+            // Keep header access aligned, bounce the frame through the receive buffer
+            if (!lwdistcomm_msg_recv_reserve(recv, LWDISTCOMM_MSG_HDR_LEN)) {
+                return false;
+            }
+            memcpy(recv->buffer, data, LWDISTCOMM_MSG_HDR_LEN);
+            header = (lwdistcomm_msg_header_t *)recv->buffer;
+        }
+
+        if (!lwdistcomm_msg_validate_header(header, &total_len) || total_len > recv->max_len) {
+            lwdistcomm_msg_free_recv(recv);
+            return false;
+        }
+
+        if (len < total_len) {
             break;
         }
-        
-        if (callback) {
-            if (!callback(arg, header)) {
+
+        if (header != (lwdistcomm_msg_header_t *)data) {
+            if (!lwdistcomm_msg_recv_reserve(recv, total_len)) {
                 return false;
             }
+            memcpy(recv->buffer, data, total_len);
+            header = (lwdistcomm_msg_header_t *)recv->buffer;
         }
-        
-        size_t remaining = recv->cur_len - total_len;
-        if (remaining > 0) {
-            memmove(recv->buffer, recv->buffer + total_len, remaining);
+
+        data += total_len;
+        len -= total_len;
+
+        if (callback && !lwdistcomm_msg_dispatch(recv, header, callback, arg)) {
+            lwdistcomm_msg_free_recv(recv);
+            return false;
         }
-        recv->cur_len = remaining;
     }
-    
+
+    // Keep trailing partial frame, an idle connection holds no buffer
+    if (len) {
+        size_t need = LWDISTCOMM_MSG_HDR_LEN;
+        if (len >= LWDISTCOMM_MSG_HDR_LEN) {
+            need = total_len;
+        }
+        if (!lwdistcomm_msg_recv_reserve(recv, need > len ? need : len)) {
+            return false;
+        }
+        memcpy(recv->buffer, data, len);
+        recv->cur_len = len;
+    } else {
+        lwdistcomm_msg_free_recv(recv);
+    }
+
     return true;
 }
 
@@ -227,3 +508,64 @@ void lwdistcomm_message_destroy(lwdistcomm_message_t *msg)
         free(msg);
     }
 }
+
+/* Allocate payload buffer */
+lwdistcomm_pbuf_t *lwdistcomm_pbuf_alloc(size_t length)
+{
+    lwdistcomm_pbuf_t *pbuf = (lwdistcomm_pbuf_t *)malloc(sizeof(lwdistcomm_pbuf_t) + length);
+    if (!pbuf) {
+        return NULL;
+    }
+
+    pbuf->ref = 1;
+    pbuf->length = length;
+    pbuf->payload = pbuf + 1;
+
+    return pbuf;
+}
+
+/* Compress payload */
+lwdistcomm_pbuf_t *lwdistcomm_msg_compress(const lwdistcomm_message_t *msg)
+{
+    if (!msg || !msg->data || msg->data_len <= sizeof(uint32_t) || msg->data_len > LWDISTCOMM_MSG_MAX_DATA) {
+        return NULL;
+    }
+
+    // Not worth the receiver's inflate below 1/8 savings
+    size_t cap = msg->data_len - msg->data_len / 8;
+    lwdistcomm_pbuf_t *pbuf = lwdistcomm_pbuf_alloc(cap);
+    if (!pbuf) {
+        return NULL;
+    }
+
+    uint8_t *payload = lwdistcomm_pbuf_payload(pbuf, uint8_t);
+    size_t len = lwdistcomm_lz4_compress(msg->data, msg->data_len, payload + sizeof(uint32_t), cap - sizeof(uint32_t));
+    if (len == 0) {
+        lwdistcomm_pbuf_free(pbuf);
+        return NULL;
+    }
+
+    uint32_t orig_len = htonl((uint32_t)msg->data_len);
+    memcpy(payload, &orig_len, sizeof(orig_len));
+    pbuf->length = sizeof(orig_len) + len;
+
+    return pbuf;
+}
+
+/* Add payload buffer reference */
+lwdistcomm_pbuf_t *lwdistcomm_pbuf_ref(lwdistcomm_pbuf_t *pbuf)
+{
+    if (pbuf) {
+        __atomic_add_fetch(&pbuf->ref, 1, __ATOMIC_RELAXED);
+    }
+
+    return pbuf;
+}
+
+/* Drop payload buffer reference */
+void lwdistcomm_pbuf_free(lwdistcomm_pbuf_t *pbuf)
+{
+    if (pbuf && __atomic_sub_fetch(&pbuf->ref, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(pbuf);
+    }
+}
@@ -10,10 +10,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/eventfd.h>
+#include <sys/epoll.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <netinet/tcp.h>
 #include <net/if.h>
 #include <pthread.h>
@@ -32,6 +35,8 @@ extern bool lwdistcomm_transport_bind(int sock, const lwdistcomm_address_t *addr
 extern bool lwdistcomm_transport_listen(int sock, int backlog);
 extern int lwdistcomm_transport_accept(int sock, struct sockaddr *addr, socklen_t *addr_len);
 extern ssize_t lwdistcomm_transport_send(int sock, const void *data, size_t len);
+extern ssize_t lwdistcomm_transport_trysendv(int sock, const struct iovec *iov, int iovcnt);
+extern bool lwdistcomm_transport_sendv_fds(int sock, struct iovec *iov, int iovcnt, const int *fds, int nfds);
 extern ssize_t lwdistcomm_transport_recv(int sock, void *buffer, size_t len, int flags);
 extern ssize_t lwdistcomm_transport_sendto(int sock, const void *data, size_t len, const lwdistcomm_address_t *addr);
 extern ssize_t lwdistcomm_transport_recvfrom(int sock, void *buffer, size_t len, lwdistcomm_address_t *addr);
@@ -103,30 +108,31 @@ static void *lwdistcomm_server_timer_handle(void *arg)
         }
 
         LIST_FOREACH(server, lwdistcomm_server_list) {
-            if (!server->hst_h) {
-                continue;
-            }
+            for (uint32_t i = 0; i < server->nreactors; i++) {
+                lwdistcomm_server_reactor_t *reactor = &server->reactors[i];
+                if (!reactor->hst_h) {
+                    continue;
+                }
 
-            emit = false;
+                emit = false;
 
-            // Lock server
-            // TODO: Implement proper locking
+                pthread_mutex_lock(&reactor->lock);
 
-            LIST_FOREACH(hst, server->hst_h) {
-                if (hst->alive > LWDISTCOMM_SERVER_TIMER_PERIOD) {
-                    hst->alive -= LWDISTCOMM_SERVER_TIMER_PERIOD;
-                } else {
-                    emit = true;
+                LIST_FOREACH(hst, reactor->hst_h) {
+                    if (hst->alive > LWDISTCOMM_SERVER_TIMER_PERIOD) {
+                        hst->alive -= LWDISTCOMM_SERVER_TIMER_PERIOD;
+                    } else {
+                        emit = true;
+                    }
                 }
-            }
 
-            // Unlock server
-            // TODO: Implement proper locking
+                pthread_mutex_unlock(&reactor->lock);
 
-            if (emit) {
-                // Signal event
-                uint64_t val = 1;
-                write(server->evtfd[1], &val, sizeof(val));
+                if (emit) {
+                    // Signal event
+                    uint64_t val = 1;
+                    write(reactor->evtfd[1], &val, sizeof(val));
+                }
             }
         }
 
@@ -145,12 +151,12 @@ static uint32_t lwdistcomm_server_cli_hash(uint32_t id)
 }
 
 /* Find client */
-static lwdistcomm_server_cli_t *lwdistcomm_server_cli_find(lwdistcomm_server_t *server, uint32_t id)
+static lwdistcomm_server_cli_t *lwdistcomm_server_cli_find(lwdistcomm_server_reactor_t *reactor, uint32_t id)
 {
     int hash = lwdistcomm_server_cli_hash(id);
     lwdistcomm_server_cli_t *cli;
 
-    LIST_FOREACH(cli, server->clis[hash]) {
+    LIST_FOREACH(cli, reactor->clis[hash]) {
         if (cli->id == id) {
             break;
         }
@@ -159,30 +165,31 @@ static lwdistcomm_server_cli_t *lwdistcomm_server_cli_find(lwdistcomm_server_t *
     return cli;
 }
 
-/* Assign new client ID */
-static uint32_t lwdistcomm_server_cli_newid(lwdistcomm_server_t *server)
+/* Assign new client ID, IDs of a reactor are congruent to its index modulo the reactor count */
+static uint32_t lwdistcomm_server_cli_newid(lwdistcomm_server_reactor_t *reactor)
 {
     uint32_t id;
 
     do {
-        id = server->ncid;
-        server->ncid++;
-    } while (lwdistcomm_server_cli_find(server, id));
+        id = reactor->ncid;
+        reactor->ncid += reactor->server->nreactors;
+    } while (lwdistcomm_server_cli_find(reactor, id));
 
     return id;
 }
 
-/* Initialize a client */
-static void lwdistcomm_server_cli_init(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli)
+/* Initialize a client (reactor locked) */
+static void lwdistcomm_server_cli_init(lwdistcomm_server_reactor_t *reactor, lwdistcomm_server_cli_t *cli)
 {
     int hash;
 
-    cli->id = lwdistcomm_server_cli_newid(server);
+    cli->reactor = reactor;
+    cli->id = lwdistcomm_server_cli_newid(reactor);
     hash = lwdistcomm_server_cli_hash(cli->id);
-    INSERT_TO_HEADER(cli, server->clis[hash]);
+    INSERT_TO_HEADER(cli, reactor->clis[hash]);
 
     cli->hst.alive = LWDISTCOMM_SERVER_DEF_HANDSHAKE_TIMEOUT;
-    INSERT_TO_HEADER(&cli->hst, server->hst_h);
+    INSERT_TO_HEADER(&cli->hst, reactor->hst_h);
 
     // Set TCP_NODELAY for better performance
     int nodelay = 1;
@@ -192,25 +199,56 @@ static void lwdistcomm_server_cli_init(lwdistcomm_server_t *server, lwdistcomm_s
 /* Destroy a client */
 static void lwdistcomm_server_cli_destroy(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli)
 {
+    lwdistcomm_server_reactor_t *reactor = cli->reactor;
     int hash = lwdistcomm_server_cli_hash(cli->id);
     lwdistcomm_server_sub_t *sub, *sub_temp;
+    lwdistcomm_server_outq_t *outq, *outq_temp;
+
+    pthread_mutex_lock(&server->lock);
+    pthread_mutex_lock(&reactor->lock);
 
     LIST_FOREACH_SAFE(sub, sub_temp, cli->subscribed) {
         DELETE_FROM_LIST(sub, cli->subscribed);
         free(sub);
     }
 
-    DELETE_FROM_LIST(cli, server->clis[hash]);
+    LIST_FOREACH_SAFE(outq, outq_temp, cli->outq_h) {
+        lwdistcomm_pbuf_free(outq->pbuf);
+        free(outq);
+    }
+    cli->outq_h = cli->outq_t = NULL;
+
+    lwdistcomm_msg_free_recv(&cli->recv);
+    lwdistcomm_server_shm_detach(server, cli);
+
+    if (cli->epollout) {
+        epoll_ctl(reactor->epfd, EPOLL_CTL_DEL, cli->sock, NULL);
+        cli->epollout = false;
+    }
+
+    DELETE_FROM_LIST(cli, reactor->clis[hash]);
 
     if (cli->hst.alive) {
         cli->hst.alive = 0;
-        DELETE_FROM_LIST(&cli->hst, server->hst_h);
+        DELETE_FROM_LIST(&cli->hst, reactor->hst_h);
     }
 
+    pthread_mutex_unlock(&reactor->lock);
+    pthread_mutex_unlock(&server->lock);
+
     lwdistcomm_transport_close(cli->sock);
     free(cli);
 }
 
+/* Mark a client for disconnection, the processing thread destroys it on EOF */
+static void lwdistcomm_server_cli_close(lwdistcomm_server_cli_t *cli)
+{
+    if (!cli->closing) {
+        cli->closing = true;
+        shutdown(cli->sock, SHUT_RDWR);
+    }
+}
+
 /* Client subscribe match */
 static bool lwdistcomm_server_cli_sub_match(lwdistcomm_server_cli_t *cli, const char *url)
 {
@@ -236,30 +274,380 @@ static bool lwdistcomm_server_cli_sub_match(lwdistcomm_server_cli_t *cli, const
     return false;
 }
 
-/* Client send message */
-static bool lwdistcomm_server_cli_sendmsg(lwdistcomm_server_cli_t *cli, lwdistcomm_msg_header_t *header, const char *url, const lwdistcomm_message_t *msg)
+/* Prepare outgoing frame */
+static bool lwdistcomm_server_frame_init(lwdistcomm_server_frame_t *frame, uint8_t type, uint8_t status, uint16_t seqno, const char *url, const lwdistcomm_message_t *msg)
+{
+    lwdistcomm_msg_init_header(&frame->header, type, status, seqno);
+
+    frame->iovcnt = lwdistcomm_msg_set_iov(&frame->header, url, msg, frame->iov, &frame->len);
+    frame->url = url;
+    frame->msg = (msg && msg->data && msg->data_len) ? msg : NULL;
+    frame->pbuf = NULL;
+    frame->pbuf_owned = false;
+    frame->lz4_tried = false;
+    frame->lz4 = NULL;
+
+    return frame->iovcnt > 0;
+}
+
+/* Get shared payload buffer of a frame, copy the caller's payload once */
+static lwdistcomm_pbuf_t *lwdistcomm_server_frame_pbuf(lwdistcomm_server_frame_t *frame)
+{
+    if (!frame->pbuf && frame->msg) {
+        frame->pbuf = lwdistcomm_pbuf_alloc(frame->msg->data_len);
+        if (frame->pbuf) {
+            memcpy(frame->pbuf->payload, frame->msg->data, frame->msg->data_len);
+            frame->pbuf_owned = true;
+        }
+    }
+
+    return frame->pbuf;
+}
+
+/* Release frame */
+static void lwdistcomm_server_frame_release(lwdistcomm_server_frame_t *frame)
+{
+    if (frame->pbuf_owned) {
+        lwdistcomm_pbuf_free(frame->pbuf);
+    }
+    frame->pbuf = NULL;
+    frame->pbuf_owned = false;
+
+    if (frame->lz4) {
+        lwdistcomm_server_frame_release(frame->lz4);
+        free(frame->lz4);
+        frame->lz4 = NULL;
+    }
+}
+
+/* Frame to send to a client (reactor locked), the payload is compressed at most once per frame */
+static lwdistcomm_server_frame_t *lwdistcomm_server_frame_select(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, lwdistcomm_server_frame_t *frame)
 {
-    size_t len;
-    if (!lwdistcomm_msg_validate_header(header, &len)) {
+    if (!server->lz4_enable || !(cli->caps & LWDISTCOMM_SERVINFO_CAP_LZ4) ||
+        !frame->msg || frame->msg->data_len < server->lz4_threshold) {
+        return frame;
+    }
+
+    if (!frame->lz4_tried) {
+        frame->lz4_tried = true;
+
+        lwdistcomm_pbuf_t *pbuf = lwdistcomm_msg_compress(frame->msg);
+        if (!pbuf) {
+            return frame;
+        }
+
+        lwdistcomm_server_frame_t *lz4 = (lwdistcomm_server_frame_t *)malloc(sizeof(lwdistcomm_server_frame_t));
+        if (!lz4) {
+            lwdistcomm_pbuf_free(pbuf);
+            return frame;
+        }
+
+        lz4->lz4_msg.data = pbuf->payload;
+        lz4->lz4_msg.data_len = pbuf->length;
+        lwdistcomm_server_frame_init(lz4, frame->header.type, frame->header.status | LWDISTCOMM_MSG_FLAG_LZ4,
+                                     ntohs(frame->header.seqno), frame->url, &lz4->lz4_msg);
+        lz4->pbuf = pbuf;
+        lz4->pbuf_owned = true;
+        frame->lz4 = lz4;
+    }
+
+    return frame->lz4 ? frame->lz4 : frame;
+}
+
+/* Client drain output queue (reactor locked) */
+static bool lwdistcomm_server_cli_flush(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli)
+{
+    lwdistcomm_server_outq_t *outq;
+    struct iovec iov[2];
+    int iovcnt;
+    ssize_t num;
+
+    while ((outq = cli->outq_h) != NULL) {
+        iovcnt = 0;
+        if (outq->offset < outq->hlen) {
+            iov[iovcnt].iov_base = &outq->head[outq->offset];
+            iov[iovcnt].iov_len = outq->hlen - outq->offset;
+            iovcnt++;
+        }
+        if (outq->pbuf) {
+            size_t poff = outq->offset > outq->hlen ? outq->offset - outq->hlen : 0;
+            iov[iovcnt].iov_base = (uint8_t *)outq->pbuf->payload + poff;
+            iov[iovcnt].iov_len = outq->pbuf->length - poff;
+            iovcnt++;
+        }
+
+        num = lwdistcomm_transport_trysendv(cli->sock, iov, iovcnt);
+        if (num < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break;
+            }
+            return false;
+        }
+
+        outq->offset += num;
+        cli->stats.sent_bytes += num;
+        cli->stats.queued_bytes -= num;
+        if (outq->offset < outq->len) {
+            break;
+        }
+
+        DELETE_FROM_FIFO(outq, cli->outq_h, cli->outq_t);
+        cli->stats.queued_msgs--;
+        cli->stats.sent_msgs++;
+        lwdistcomm_pbuf_free(outq->pbuf);
+        free(outq);
+    }
+
+    if (!cli->outq_h && cli->epollout) {
+        epoll_ctl(cli->reactor->epfd, EPOLL_CTL_DEL, cli->sock, NULL);
+        cli->epollout = false;
+    }
+
+    if (cli->stats.congested && cli->stats.queued_bytes <= server->low_watermark) {
+        cli->stats.congested = false;
+    }
+
+    return true;
+}
+
+/* Client output a frame (reactor locked), frames without URL are replies which are never dropped */
+static bool lwdistcomm_server_cli_output(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, lwdistcomm_server_frame_t *frame, lwdistcomm_server_policy_t policy)
+{
+    lwdistcomm_server_outq_t *outq, *queued = NULL;
+    size_t hlen = frame->len - (frame->msg ? frame->msg->data_len : 0);
+    ssize_t num = 0;
+
+    if (cli->closing) {
         return false;
     }
 
-    uint8_t *buffer = (uint8_t *)header;
-    ssize_t num, total = 0;
+    // Fast path: nothing queued, write directly from the caller's buffers
+    if (!cli->outq_h) {
+        num = lwdistcomm_transport_trysendv(cli->sock, frame->iov, frame->iovcnt);
+        if (num < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                return false;
+            }
+            num = 0;
+        }
 
-    do {
-        num = lwdistcomm_transport_send(cli->sock, &buffer[total], len - total);
-        if (num > 0) {
-            total += num;
-        } else {
-            // Send failed, client is disconnected
+        cli->stats.sent_bytes += num;
+        if ((size_t)num == frame->len) {
+            cli->stats.sent_msgs++;
+            return true;
+        }
+    }
+
+    // Slow subscriber, apply topic policy to untouched frames only
+    if (frame->url && frame->header.type == LWDISTCOMM_MSG_TYPE_PUBLISH && num == 0 && cli->stats.congested) {
+        switch (policy) {
+        case LWDISTCOMM_SERVER_POLICY_DISCONNECT:
             return false;
+
+        case LWDISTCOMM_SERVER_POLICY_CONFLATE:
+            LIST_FOREACH(queued, cli->outq_h) {
+                const lwdistcomm_msg_header_t *header = (const lwdistcomm_msg_header_t *)queued->head;
+                if (queued->offset == 0 && queued->hlen == hlen && header->type == LWDISTCOMM_MSG_TYPE_PUBLISH &&
+                    !memcmp(queued->head + LWDISTCOMM_MSG_HDR_LEN, frame->url, hlen - LWDISTCOMM_MSG_HDR_LEN)) {
+                    break;
+                }
+            }
+            break;
+
+        case LWDISTCOMM_SERVER_POLICY_DROP:
+        default:
+            cli->stats.dropped_msgs++;
+            return true;
         }
-    } while (total < len);
+    }
+
+    // Queue a private copy of header and URL, share the payload
+    outq = (lwdistcomm_server_outq_t *)malloc(sizeof(lwdistcomm_server_outq_t) + hlen);
+    if (!outq) {
+        return false;
+    }
+
+    outq->pbuf = NULL;
+    if (frame->msg) {
+        outq->pbuf = lwdistcomm_pbuf_ref(lwdistcomm_server_frame_pbuf(frame));
+        if (!outq->pbuf) {
+            free(outq);
+            return false;
+        }
+    }
+
+    memcpy(outq->head, &frame->header, LWDISTCOMM_MSG_HDR_LEN);
+    if (hlen > LWDISTCOMM_MSG_HDR_LEN) {
+        memcpy(outq->head + LWDISTCOMM_MSG_HDR_LEN, frame->url, hlen - LWDISTCOMM_MSG_HDR_LEN);
+    }
+    outq->hlen = hlen;
+    outq->len = frame->len;
+    outq->offset = num;
+
+    if (queued) {
+        // Take over the queue position of the stale message
+        outq->prev = queued->prev;
+        outq->next = queued->next;
+        if (queued->prev) queued->prev->next = outq;
+        else cli->outq_h = outq;
+        if (queued->next) queued->next->prev = outq;
+        else cli->outq_t = outq;
+        cli->stats.queued_bytes += outq->len;
+        cli->stats.queued_bytes -= queued->len;
+        cli->stats.conflated_msgs++;
+        lwdistcomm_pbuf_free(queued->pbuf);
+        free(queued);
+    } else {
+        INSERT_TO_FIFO(outq, cli->outq_h, cli->outq_t);
+        cli->stats.queued_msgs++;
+        cli->stats.queued_bytes += outq->len - outq->offset;
+    }
+
+    if (!cli->stats.congested && cli->stats.queued_bytes >= server->high_watermark) {
+        cli->stats.congested = true;
+        cli->stats.congestions++;
+    }
+
+    if (!cli->epollout) {
+        struct epoll_event event;
+        event.events = EPOLLOUT;
+        event.data.ptr = cli;
+        if (epoll_ctl(cli->reactor->epfd, EPOLL_CTL_ADD, cli->sock, &event) < 0) {
+            return false;
+        }
+        cli->epollout = true;
+    }
 
     return true;
 }
 
+/* Client send reply */
+static bool lwdistcomm_server_cli_reply(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, uint8_t type, uint8_t status, uint16_t seqno, const lwdistcomm_message_t *msg)
+{
+    lwdistcomm_server_frame_t frame;
+    bool ret;
+
+    pthread_mutex_lock(&cli->reactor->lock);
+
+    ret = lwdistcomm_server_frame_init(&frame, type, status, seqno, NULL, msg) &&
+          lwdistcomm_server_cli_output(server, cli, lwdistcomm_server_frame_select(server, cli, &frame), LWDISTCOMM_SERVER_POLICY_DROP);
+    if (!ret) {
+        lwdistcomm_server_cli_close(cli);
+    }
+
+    pthread_mutex_unlock(&cli->reactor->lock);
+
+    lwdistcomm_server_frame_release(&frame);
+
+    return ret;
+}
+
+/* Topic policy match (server locked) */
+static lwdistcomm_server_policy_t lwdistcomm_server_policy_match(lwdistcomm_server_t *server, const char *url)
+{
+    size_t url_len = strlen(url);
+    lwdistcomm_server_pol_t *pol;
+
+    // Exact match
+    LIST_FOREACH(pol, server->policies) {
+        if (pol->len == url_len && !memcmp(pol->url, url, url_len)) {
+            return pol->policy;
+        }
+    }
+
+    // Prefix match
+    LIST_FOREACH(pol, server->policies) {
+        if (pol->url[pol->len - 1] == '/') {
+            size_t path_len = pol->len - 1;
+            if (url_len >= path_len && !memcmp(pol->url, url, path_len)) {
+                if (url_len == path_len || url[path_len] == '/') {
+                    return pol->policy;
+                }
+            }
+        }
+    }
+
+    return server->def_policy;
+}
+
+/* Move client publish traffic to the shared memory ring, the reply carries the ring and wakeup descriptors */
+static bool lwdistcomm_server_shm_attach(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, uint16_t seqno)
+{
+    struct {
+        uint32_t slot;
+        uint32_t reserved;
+        uint64_t pos;
+    } info;
+    uint8_t status = LWDISTCOMM_STATUS_SUCCESS;
+    int fds[2] = { -1, -1 };
+
+    pthread_mutex_lock(&server->lock);
+    pthread_mutex_lock(&cli->reactor->lock);
+
+    if (!server->shm_local || !server->shm_enable || cli->shm_slot >= 0 || cli->outq_h) {
+        status = LWDISTCOMM_STATUS_ARGUMENTS;
+    } else {
+        if (!server->shm) {
+            server->shm = lwdistcomm_shm_ring_create(server->shm_size);
+        }
+        if (server->shm && ~server->shm_used) {
+            fds[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        }
+        if (fds[1] < 0) {
+            status = LWDISTCOMM_STATUS_NO_MEMORY;
+        }
+    }
+
+    if (status == LWDISTCOMM_STATUS_SUCCESS) {
+        int slot = __builtin_ctzll(~server->shm_used);
+        memset(&info, 0, sizeof(info));
+        info.slot = slot;
+        info.pos = lwdistcomm_shm_ring_head(server->shm);
+        lwdistcomm_shm_ring_reset_slot(server->shm, slot);
+        server->shm_used |= (uint64_t)1 << slot;
+        server->shm_evtfds[slot] = fds[1];
+        cli->shm_slot = slot;
+        fds[0] = server->shm->fd;
+    }
+
+    pthread_mutex_unlock(&cli->reactor->lock);
+    pthread_mutex_unlock(&server->lock);
+
+    if (status != LWDISTCOMM_STATUS_SUCCESS) {
+        return lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_SHMATTACH, status, seqno, NULL);
+    }
+
+    lwdistcomm_server_frame_t frame;
+    lwdistcomm_message_t msg = { &info, sizeof(info) };
+    bool ret = lwdistcomm_server_frame_init(&frame, LWDISTCOMM_MSG_TYPE_SHMATTACH, status, seqno, NULL, &msg) &&
+               lwdistcomm_transport_sendv_fds(cli->sock, frame.iov, frame.iovcnt, fds, 2);
+    lwdistcomm_server_frame_release(&frame);
+
+    if (!ret) {
+        pthread_mutex_lock(&server->lock);
+        pthread_mutex_lock(&cli->reactor->lock);
+        lwdistcomm_server_shm_detach(server, cli);
+        lwdistcomm_server_cli_close(cli);
+        pthread_mutex_unlock(&cli->reactor->lock);
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    return ret;
+}
+
+/* Release client shared memory slot (server locked) */
+static void lwdistcomm_server_shm_detach(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli)
+{
+    if (cli->shm_slot >= 0) {
+        int slot = cli->shm_slot;
+        close(server->shm_evtfds[slot]);
+        server->shm_evtfds[slot] = -1;
+        server->shm_used &= ~((uint64_t)1 << slot);
+        lwdistcomm_shm_ring_reset_slot(server->shm, slot);
+        cli->shm_slot = -1;
+    }
+}
+
 /* Command match */
 static bool lwdistcomm_server_cmd_match(lwdistcomm_server_t *server, const char *url, lwdistcomm_server_handler_cb_t *callback, void **arg)
 {
@@ -273,39 +661,42 @@ static bool lwdistcomm_server_cmd_match(lwdistcomm_server_t *server, const char
     }
     hash &= LWDISTCOMM_SERVER_CMD_HASH_MASK;
 
+    pthread_rwlock_rdlock(&server->cmd_lock);
+
     LIST_FOREACH(cmd, server->cmds[hash]) {
         if (cmd->len == url_len && !memcmp(cmd->url, url, url_len)) {
-            *callback = cmd->callback;
-            *arg = cmd->arg;
-            return true;
+            break;
         }
     }
 
     // Prefix match
-    LIST_FOREACH(cmd, server->prefix_h) {
-        if (cmd->len <= url_len && !memcmp(cmd->url, url, cmd->len)) {
-            if (cmd->len == url_len || url[cmd->len] == '/') {
-                *callback = cmd->callback;
-                *arg = cmd->arg;
-                return true;
+    if (!cmd) {
+        LIST_FOREACH(cmd, server->prefix_h) {
+            if (cmd->len <= url_len && !memcmp(cmd->url, url, cmd->len) &&
+                (cmd->len == url_len || url[cmd->len] == '/')) {
+                break;
             }
         }
     }
 
     // Default handler
-    if (server->def_cmd) {
-        *callback = server->def_cmd->callback;
-        *arg = server->def_cmd->arg;
-        return true;
+    if (!cmd) {
+        cmd = server->def_cmd;
     }
 
-    return false;
+    if (cmd) {
+        *callback = cmd->callback;
+        *arg = cmd->arg;
+    }
+
+    pthread_rwlock_unlock(&server->cmd_lock);
+
+    return cmd != NULL;
 }
 
 /* Create server instance */
 lwdistcomm_server_t *lwdistcomm_server_create(const lwdistcomm_server_options_t *options)
 {
-    int err = 0;
     lwdistcomm_server_t *server;
 
     server = (lwdistcomm_server_t *)malloc(sizeof(lwdistcomm_server_t));
@@ -315,20 +706,11 @@ lwdistcomm_server_t *lwdistcomm_server_create(const lwdistcomm_server_options_t
 
     memset(server, 0, sizeof(lwdistcomm_server_t));
 
-    server->sock = -1;
-
-    // Create event fd pair
-    server->evtfd[0] = eventfd(0, EFD_NONBLOCK);
-    server->evtfd[1] = eventfd(0, EFD_NONBLOCK);
-    if (server->evtfd[0] < 0 || server->evtfd[1] < 0) {
-        goto error;
-    }
-
-    // Allocate send buffer
-    server->sendbuf = malloc(LWDISTCOMM_MSG_MAX_LEN * 2);
-    if (!server->sendbuf) {
-        err = 1;
-        goto error;
+    // Reactor 0 is driven by the caller's event loop
+    server->nreactors = 1;
+    if (!lwdistcomm_server_reactor_init(server, 0)) {
+        free(server);
+        return NULL;
     }
 
     // Initialize security if options provided
@@ -336,9 +718,18 @@ lwdistcomm_server_t *lwdistcomm_server_create(const lwdistcomm_server_options_t
         server->security = lwdistcomm_security_create(options->security_options);
     }
 
-    // Initialize receive buffer
-    server->recvbuf = (uint8_t *)server->sendbuf + LWDISTCOMM_MSG_MAX_LEN;
     server->send_timeout = lwdistcomm_server_def_send_timeout;
+    server->high_watermark = LWDISTCOMM_SERVER_DEF_HIGH_WATERMARK;
+    server->low_watermark = LWDISTCOMM_SERVER_DEF_LOW_WATERMARK;
+    server->def_policy = LWDISTCOMM_SERVER_POLICY_DROP;
+    server->shm_enable = true;
+    server->shm_size = LWDISTCOMM_SHM_DEF_SIZE;
+    server->lz4_threshold = LWDISTCOMM_MSG_LZ4_THRESHOLD;
+    for (int i = 0; i < LWDISTCOMM_SHM_SLOTS; i++) {
+        server->shm_evtfds[i] = -1;
+    }
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_rwlock_init(&server->cmd_lock, NULL);
     server->valid = true;
 
     // Initialize discovery fields
@@ -358,41 +749,14 @@ lwdistcomm_server_t *lwdistcomm_server_create(const lwdistcomm_server_options_t
     }
 
     return server;
-
-error:
-    if (err > 1) {
-        free(server->sendbuf);
-    }
-    if (err > 0) {
-        if (server->evtfd[0] >= 0) close(server->evtfd[0]);
-        if (server->evtfd[1] >= 0) close(server->evtfd[1]);
-    }
-    free(server);
-    return NULL;
 }
 
 /* Start server */
 bool lwdistcomm_server_start(lwdistcomm_server_t *server, const lwdistcomm_address_t *addr)
 {
-    if (!server || !server->valid || !addr) {
-        return false;
-    }
+    uint32_t i;
 
-    // Create socket based on address type
-    server->sock = lwdistcomm_transport_create_socket(addr->type, false, SOCK_STREAM);
-    if (server->sock < 0) {
-        return false;
-    }
-
-    // Set socket options
-    int en = 1;
-    setsockopt(server->sock, SOL_SOCKET, SO_REUSEADDR, &en, sizeof(en));
-    setsockopt(server->sock, IPPROTO_TCP, TCP_NODELAY, &en, sizeof(en));
-
-    // Bind to address
-    if (!lwdistcomm_transport_bind(server->sock, addr)) {
-        lwdistcomm_transport_close(server->sock);
-        server->sock = -1;
+    if (!server || !server->valid || !addr || server->reactors[0].sock >= 0) {
         return false;
     }
 
@@ -401,13 +765,32 @@ bool lwdistcomm_server_start(lwdistcomm_server_t *server, const lwdistcomm_addre
         // TODO: Implement interface binding
     }
 
-    // Start listening
-    if (!lwdistcomm_transport_listen(server->sock, LWDISTCOMM_SERVER_BACKLOG)) {
-        lwdistcomm_transport_close(server->sock);
-        server->sock = -1;
+    // Reactors after the first bind the same address and run in their own threads
+    for (i = 0; i < server->nreactors; i++) {
+        lwdistcomm_server_reactor_t *reactor = &server->reactors[i];
+
+        if ((!reactor->recvbuf && !lwdistcomm_server_reactor_init(server, i)) ||
+            !lwdistcomm_server_reactor_listen(reactor, addr)) {
+            break;
+        }
+
+        if (i) {
+            reactor->running = true;
+            if (pthread_create(&reactor->thread, NULL, lwdistcomm_server_reactor_thread, reactor) != 0) {
+                reactor->running = false;
+                break;
+            }
+        }
+    }
+
+    if (i < server->nreactors) {
+        lwdistcomm_server_stop(server);
         return false;
     }
 
+    // Local clients may move publish traffic to shared memory
+    server->shm_local = (addr->type == LWDISTCOMM_ADDR_TYPE_UNIX || addr->type == LWDISTCOMM_ADDR_TYPE_SHM);
+
     // Start discovery thread
     lwdistcomm_server_start_discovery(server);
 
@@ -421,9 +804,18 @@ bool lwdistcomm_server_stop(lwdistcomm_server_t *server)
         return false;
     }
 
-    if (server->sock >= 0) {
-        lwdistcomm_transport_close(server->sock);
-        server->sock = -1;
+    for (uint32_t i = 0; i < server->nreactors; i++) {
+        lwdistcomm_server_reactor_t *reactor = &server->reactors[i];
+
+        if (reactor->running) {
+            reactor->running = false;
+            pthread_join(reactor->thread, NULL);
+        }
+
+        if (reactor->sock >= 0) {
+            lwdistcomm_transport_close(reactor->sock);
+            reactor->sock = -1;
+        }
     }
 
     return true;
@@ -432,51 +824,263 @@ bool lwdistcomm_server_stop(lwdistcomm_server_t *server)
 /* Check if server is running */
 bool lwdistcomm_server_is_running(const lwdistcomm_server_t *server)
 {
-    return (server && server->valid && server->sock >= 0);
+    return (server && server->valid && server->reactors[0].sock >= 0);
+}
+
+/* Set number of reactors */
+bool lwdistcomm_server_set_reactors(lwdistcomm_server_t *server, int count)
+{
+    if (!server || !server->valid || count < 1 || count > LWDISTCOMM_SERVER_MAX_REACTORS) {
+        return false;
+    }
+
+    // Client IDs depend on the reactor count, only allowed before the first client is accepted
+    if (server->reactors[0].sock >= 0 || server->reactors[0].ncid) {
+        return false;
+    }
+    for (int i = 1; i < LWDISTCOMM_SERVER_MAX_REACTORS; i++) {
+        if (server->reactors[i].recvbuf) {
+            return false;
+        }
+    }
+
+    server->nreactors = (uint32_t)count;
+    return true;
+}
+
+/* Publish frame to subscribers */
+static bool lwdistcomm_server_publish_frame(lwdistcomm_server_t *server, lwdistcomm_server_frame_t *frame)
+{
+    pthread_mutex_lock(&server->lock);
+
+    lwdistcomm_server_policy_t policy = lwdistcomm_server_policy_match(server, frame->url);
+    uint64_t shm_mask = 0;
+
+    // Send to subscribed clients of every reactor, slow clients never block the others
+    for (uint32_t r = 0; r < server->nreactors; r++) {
+        lwdistcomm_server_reactor_t *reactor = &server->reactors[r];
+
+        pthread_mutex_lock(&reactor->lock);
+
+        for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
+            lwdistcomm_server_cli_t *cli;
+            LIST_FOREACH(cli, reactor->clis[i]) {
+                if (cli->active && !cli->closing && lwdistcomm_server_cli_sub_match(cli, frame->url)) {
+                    if (cli->shm_slot >= 0) {
+                        shm_mask |= (uint64_t)1 << cli->shm_slot;
+                        cli->stats.sent_msgs++;
+                        cli->stats.sent_bytes += frame->len;
+                    } else if (!lwdistcomm_server_cli_output(server, cli, lwdistcomm_server_frame_select(server, cli, frame), policy)) {
+                        lwdistcomm_server_cli_close(cli);
+                    }
+                }
+            }
+        }
+
+        pthread_mutex_unlock(&reactor->lock);
+    }
+
+    // Shared memory subscribers get one copy between them
+    if (shm_mask) {
+        lwdistcomm_shm_ring_write(server->shm, frame->iov, frame->iovcnt, frame->len, shm_mask, server->shm_evtfds);
+    }
+
+    pthread_mutex_unlock(&server->lock);
+
+    lwdistcomm_server_frame_release(frame);
+
+    return true;
 }
 
 /* Publish message to subscribers */
 bool lwdistcomm_server_publish(lwdistcomm_server_t *server, const char *url, const lwdistcomm_message_t *msg)
 {
+    lwdistcomm_server_frame_t frame;
+
     if (!server || !server->valid || !url) {
         return false;
     }
 
-    // Initialize message header
-    lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_PUBLISH, 0, 0);
+    if (!lwdistcomm_server_frame_init(&frame, LWDISTCOMM_MSG_TYPE_PUBLISH, 0, 0, url, msg)) {
+        return false;
+    }
 
-    // Set URL
-    if (!lwdistcomm_msg_set_url(header, url)) {
+    return lwdistcomm_server_publish_frame(server, &frame);
+}
+
+/* Publish payload buffer to subscribers */
+bool lwdistcomm_server_publish_pbuf(lwdistcomm_server_t *server, const char *url, lwdistcomm_pbuf_t *pbuf)
+{
+    lwdistcomm_server_frame_t frame;
+    lwdistcomm_message_t msg;
+
+    if (!server || !server->valid || !url || !pbuf) {
         return false;
     }
 
-    // Set payload
-    if (msg && !lwdistcomm_msg_set_payload(header, msg)) {
+    msg.data = pbuf->payload;
+    msg.data_len = pbuf->length;
+    if (!lwdistcomm_server_frame_init(&frame, LWDISTCOMM_MSG_TYPE_PUBLISH, 0, 0, url, &msg)) {
         return false;
     }
 
-    // Validate header
-    size_t len;
-    if (!lwdistcomm_msg_validate_header(header, &len)) {
+    // Queued clients reference the caller's buffer instead of a copy
+    frame.pbuf = pbuf;
+
+    return lwdistcomm_server_publish_frame(server, &frame);
+}
+
+/* Set client output queue watermarks */
+bool lwdistcomm_server_set_watermarks(lwdistcomm_server_t *server, size_t high, size_t low)
+{
+    if (!server || !server->valid || high == 0 || low > high) {
         return false;
     }
 
-    // Send to subscribed clients
-    for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
-        lwdistcomm_server_cli_t *cli, *cli_temp;
-        LIST_FOREACH_SAFE(cli, cli_temp, server->clis[i]) {
-            if (cli->active && lwdistcomm_server_cli_sub_match(cli, url)) {
-                if (!lwdistcomm_server_cli_sendmsg(cli, header, url, msg)) {
-                    // Send failed, client is disconnected
-                    lwdistcomm_server_cli_destroy(server, cli);
-                }
+    pthread_mutex_lock(&server->lock);
+    server->high_watermark = high;
+    server->low_watermark = low;
+    pthread_mutex_unlock(&server->lock);
+
+    return true;
+}
+
+/* Set max message size accepted from clients */
+bool lwdistcomm_server_set_max_msg_size(lwdistcomm_server_t *server, size_t size)
+{
+    if (!server || !server->valid || size > LWDISTCOMM_MSG_MAX_LEN) {
+        return false;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->max_msg_size = size;
+    for (uint32_t r = 0; r < server->nreactors; r++) {
+        lwdistcomm_server_reactor_t *reactor = &server->reactors[r];
+
+        pthread_mutex_lock(&reactor->lock);
+        for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
+            lwdistcomm_server_cli_t *cli;
+            LIST_FOREACH(cli, reactor->clis[i]) {
+                lwdistcomm_msg_set_recv_max(&cli->recv, size);
             }
         }
+        pthread_mutex_unlock(&reactor->lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    return true;
+}
+
+/* Set shared memory publish transport for local clients */
+bool lwdistcomm_server_set_shm(lwdistcomm_server_t *server, bool enable, size_t ring_size)
+{
+    if (!server || !server->valid) {
+        return false;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->shm_enable = enable;
+    if (ring_size) {
+        // Takes effect when the ring is created for the first local client
+        server->shm_size = ring_size;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    return true;
+}
+
+/* Set payload compression towards clients that support it */
+bool lwdistcomm_server_set_compression(lwdistcomm_server_t *server, bool enable, size_t threshold)
+{
+    if (!server || !server->valid) {
+        return false;
+    }
+
+    // Read by the reactors with only their own lock held
+    pthread_mutex_lock(&server->lock);
+    for (uint32_t r = 0; r < server->nreactors; r++) {
+        pthread_mutex_lock(&server->reactors[r].lock);
+    }
+    server->lz4_enable = enable;
+    server->lz4_threshold = threshold ? threshold : LWDISTCOMM_MSG_LZ4_THRESHOLD;
+    for (uint32_t r = 0; r < server->nreactors; r++) {
+        pthread_mutex_unlock(&server->reactors[r].lock);
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    return true;
+}
+
+/* Set slow subscriber policy */
+bool lwdistcomm_server_set_topic_policy(lwdistcomm_server_t *server, const char *url, lwdistcomm_server_policy_t policy)
+{
+    if (!server || !server->valid || !url || !url[0]) {
+        return false;
+    }
+
+    if (policy != LWDISTCOMM_SERVER_POLICY_DROP &&
+        policy != LWDISTCOMM_SERVER_POLICY_CONFLATE &&
+        policy != LWDISTCOMM_SERVER_POLICY_DISCONNECT) {
+        return false;
+    }
+
+    size_t url_len = strlen(url);
+    lwdistcomm_server_pol_t *pol;
+
+    pthread_mutex_lock(&server->lock);
+
+    if (url_len == 1 && url[0] == '/') {
+        server->def_policy = policy;
+        pthread_mutex_unlock(&server->lock);
+        return true;
+    }
+
+    LIST_FOREACH(pol, server->policies) {
+        if (pol->len == url_len && !memcmp(pol->url, url, url_len)) {
+            break;
+        }
+    }
+
+    if (!pol) {
+        pol = (lwdistcomm_server_pol_t *)malloc(sizeof(lwdistcomm_server_pol_t) + url_len);
+        if (!pol) {
+            pthread_mutex_unlock(&server->lock);
+            return false;
+        }
+        pol->len = url_len;
+        memcpy(pol->url, url, url_len);
+        pol->url[url_len] = '\0';
+        INSERT_TO_HEADER(pol, server->policies);
     }
+    pol->policy = policy;
+
+    pthread_mutex_unlock(&server->lock);
 
     return true;
 }
 
+/* Get output statistics of a client */
+bool lwdistcomm_server_get_client_stats(lwdistcomm_server_t *server, uint32_t client_id, lwdistcomm_server_cli_stats_t *stats)
+{
+    if (!server || !server->valid || !stats) {
+        return false;
+    }
+
+    // Client IDs encode the reactor that owns the client
+    lwdistcomm_server_reactor_t *reactor = &server->reactors[client_id % server->nreactors];
+
+    pthread_mutex_lock(&reactor->lock);
+
+    lwdistcomm_server_cli_t *cli = lwdistcomm_server_cli_find(reactor, client_id);
+    if (cli) {
+        *stats = cli->stats;
+    }
+
+    pthread_mutex_unlock(&reactor->lock);
+
+    return cli != NULL;
+}
+
 /* Add RPC handler */
 bool lwdistcomm_server_add_handler(lwdistcomm_server_t *server, const char *url, lwdistcomm_server_handler_cb_t callback, void *arg)
 {
@@ -500,8 +1104,7 @@ bool lwdistcomm_server_add_handler(lwdistcomm_server_t *server, const char *url,
     memcpy(cmd->url, url, cmd->len);
     cmd->url[cmd->len] = '\0';
 
-    // Lock server
-    // TODO: Implement proper locking
+    pthread_rwlock_wrlock(&server->cmd_lock);
 
     if (is_default) {
         if (server->def_cmd) {
@@ -519,8 +1122,7 @@ bool lwdistcomm_server_add_handler(lwdistcomm_server_t *server, const char *url,
         INSERT_TO_HEADER(cmd, server->cmds[hash]);
     }
 
-    // Unlock server
-    // TODO: Implement proper locking
+    pthread_rwlock_unlock(&server->cmd_lock);
 
     return true;
 }
@@ -539,8 +1141,7 @@ bool lwdistcomm_server_remove_handler(lwdistcomm_server_t *server, const char *u
 
     lwdistcomm_server_cmd_t *cmd = NULL;
 
-    // Lock server
-    // TODO: Implement proper locking
+    pthread_rwlock_wrlock(&server->cmd_lock);
 
     if (is_default) {
         cmd = server->def_cmd;
@@ -569,8 +1170,7 @@ bool lwdistcomm_server_remove_handler(lwdistcomm_server_t *server, const char *u
         }
     }
 
-    // Unlock server
-    // TODO: Implement proper locking
+    pthread_rwlock_unlock(&server->cmd_lock);
 
     if (cmd) {
         free(cmd);
@@ -615,13 +1215,19 @@ int lwdistcomm_server_get_client_count(const lwdistcomm_server_t *server)
     }
 
     int count = 0;
-    for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
-        lwdistcomm_server_cli_t *cli;
-        LIST_FOREACH(cli, server->clis[i]) {
-            if (cli->active) {
-                count++;
+    for (uint32_t r = 0; r < server->nreactors; r++) {
+        lwdistcomm_server_reactor_t *reactor = (lwdistcomm_server_reactor_t *)&server->reactors[r];
+
+        pthread_mutex_lock(&reactor->lock);
+        for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
+            lwdistcomm_server_cli_t *cli;
+            LIST_FOREACH(cli, reactor->clis[i]) {
+                if (cli->active) {
+                    count++;
+                }
             }
         }
+        pthread_mutex_unlock(&reactor->lock);
     }
 
     return count;
@@ -652,24 +1258,183 @@ bool lwdistcomm_server_process_events(lwdistcomm_server_t *server)
 /* Get file descriptors for event polling */
 int lwdistcomm_server_get_fds(lwdistcomm_server_t *server, fd_set *rfds)
 {
-    if (!server || !server->valid || !rfds || server->sock < 0) {
+    if (!server || !server->valid || !rfds) {
+        return -1;
+    }
+
+    return lwdistcomm_server_reactor_get_fds(&server->reactors[0], rfds);
+}
+
+/* Process input events */
+bool lwdistcomm_server_process_input(lwdistcomm_server_t *server, const fd_set *rfds)
+{
+    if (!server || !server->valid || !rfds) {
+        return false;
+    }
+
+    return lwdistcomm_server_reactor_input(&server->reactors[0], rfds);
+}
+
+/* Initialize reactor event descriptors and receive buffer */
+static bool lwdistcomm_server_reactor_init(lwdistcomm_server_t *server, uint32_t index)
+{
+    lwdistcomm_server_reactor_t *reactor = &server->reactors[index];
+
+    memset(reactor, 0, sizeof(lwdistcomm_server_reactor_t));
+    reactor->server = server;
+    reactor->index = index;
+    reactor->ncid = index;
+    reactor->sock = -1;
+
+    // Create event fd pair
+    reactor->evtfd[0] = eventfd(0, EFD_NONBLOCK);
+    reactor->evtfd[1] = eventfd(0, EFD_NONBLOCK);
+
+    // Create output readiness poller
+    reactor->epfd = epoll_create1(EPOLL_CLOEXEC);
+
+    // Allocate receive buffer, frames are sent straight from the caller's buffers
+    reactor->recvbuf = malloc(LWDISTCOMM_MSG_MAX_LEN + LWDISTCOMM_MSG_URL_MAX + 1);
+
+    if (reactor->evtfd[0] < 0 || reactor->evtfd[1] < 0 || reactor->epfd < 0 || !reactor->recvbuf) {
+        if (reactor->evtfd[0] >= 0) close(reactor->evtfd[0]);
+        if (reactor->evtfd[1] >= 0) close(reactor->evtfd[1]);
+        if (reactor->epfd >= 0) close(reactor->epfd);
+        free(reactor->recvbuf);
+        reactor->recvbuf = NULL;
+        return false;
+    }
+
+    // URLs are copied out of the frame to be NUL terminated
+    reactor->urlbuf = (char *)reactor->recvbuf + LWDISTCOMM_MSG_MAX_LEN;
+    pthread_mutex_init(&reactor->lock, NULL);
+
+    return true;
+}
+
+/* Free reactor, its thread is stopped and listener closed */
+static void lwdistcomm_server_reactor_free(lwdistcomm_server_reactor_t *reactor)
+{
+    if (!reactor->recvbuf) {
+        return;
+    }
+
+    // Cleanup clients
+    for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
+        lwdistcomm_server_cli_t *cli, *cli_temp;
+        LIST_FOREACH_SAFE(cli, cli_temp, reactor->clis[i]) {
+            lwdistcomm_server_cli_destroy(reactor->server, cli);
+        }
+    }
+
+    close(reactor->epfd);
+    close(reactor->evtfd[0]);
+    close(reactor->evtfd[1]);
+    free(reactor->recvbuf);
+    reactor->recvbuf = NULL;
+    pthread_mutex_destroy(&reactor->lock);
+}
+
+/* Reactor listen on address, reactors after the first share the port with SO_REUSEPORT */
+static bool lwdistcomm_server_reactor_listen(lwdistcomm_server_reactor_t *reactor, const lwdistcomm_address_t *addr)
+{
+    lwdistcomm_server_t *server = reactor->server;
+    bool local = (addr->type == LWDISTCOMM_ADDR_TYPE_UNIX || addr->type == LWDISTCOMM_ADDR_TYPE_SHM);
+    int en = 1;
+
+    // Unix domain sockets can not share a path, local reactors poll a duplicate of the first listener
+    if (reactor->index && local) {
+        reactor->sock = dup(server->reactors[0].sock);
+        return reactor->sock >= 0;
+    }
+
+    // Create socket based on address type
+    reactor->sock = lwdistcomm_transport_create_socket(addr->type, false, SOCK_STREAM);
+    if (reactor->sock < 0) {
+        return false;
+    }
+
+    // Set socket options
+    setsockopt(reactor->sock, SOL_SOCKET, SO_REUSEADDR, &en, sizeof(en));
+    setsockopt(reactor->sock, IPPROTO_TCP, TCP_NODELAY, &en, sizeof(en));
+    if (server->nreactors > 1 && !local) {
+        setsockopt(reactor->sock, SOL_SOCKET, SO_REUSEPORT, &en, sizeof(en));
+    }
+
+    bool ret;
+    if (reactor->index) {
+        // Bind to the address the first reactor got, the port may have been chosen by the kernel
+        struct sockaddr_storage saddr;
+        socklen_t saddr_len = sizeof(saddr);
+        ret = getsockname(server->reactors[0].sock, (struct sockaddr *)&saddr, &saddr_len) == 0 &&
+              bind(reactor->sock, (struct sockaddr *)&saddr, saddr_len) == 0;
+    } else {
+        ret = lwdistcomm_transport_bind(reactor->sock, addr);
+    }
+
+    // Start listening
+    if (!ret || !lwdistcomm_transport_listen(reactor->sock, LWDISTCOMM_SERVER_BACKLOG)) {
+        lwdistcomm_transport_close(reactor->sock);
+        reactor->sock = -1;
+        return false;
+    }
+
+    // A shared listener is polled by several reactors, accept must not block the one that lost the race
+    if (server->nreactors > 1 && local) {
+        fcntl(reactor->sock, F_SETFL, fcntl(reactor->sock, F_GETFL) | O_NONBLOCK);
+    }
+
+    return true;
+}
+
+/* Reactor thread handle */
+static void *lwdistcomm_server_reactor_thread(void *arg)
+{
+    lwdistcomm_server_reactor_t *reactor = (lwdistcomm_server_reactor_t *)arg;
+    fd_set rfds;
+
+    while (reactor->running) {
+        int max_fd = lwdistcomm_server_reactor_get_fds(reactor, &rfds);
+        if (max_fd < 0) {
+            break;
+        }
+
+        struct timeval timeout = {0, 10000}; // 10ms timeout
+        if (select(max_fd + 1, &rfds, NULL, NULL, &timeout) > 0) {
+            lwdistcomm_server_reactor_input(reactor, &rfds);
+        }
+    }
+
+    return NULL;
+}
+
+/* Get reactor file descriptors for event polling */
+static int lwdistcomm_server_reactor_get_fds(lwdistcomm_server_reactor_t *reactor, fd_set *rfds)
+{
+    if (reactor->sock < 0) {
         return -1;
     }
 
     FD_ZERO(rfds);
 
-    FD_SET(server->sock, rfds);
-    int max_fd = server->sock;
+    FD_SET(reactor->sock, rfds);
+    int max_fd = reactor->sock;
+
+    FD_SET(reactor->evtfd[0], rfds);
+    if (max_fd < reactor->evtfd[0]) {
+        max_fd = reactor->evtfd[0];
+    }
 
-    FD_SET(server->evtfd[0], rfds);
-    if (max_fd < server->evtfd[0]) {
-        max_fd = server->evtfd[0];
+    // Readable when a client with queued output becomes writable
+    FD_SET(reactor->epfd, rfds);
+    if (max_fd < reactor->epfd) {
+        max_fd = reactor->epfd;
     }
 
-    // Add client sockets
+    // Add client sockets, only this reactor's thread adds or removes them
     for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
         lwdistcomm_server_cli_t *cli;
-        LIST_FOREACH(cli, server->clis[i]) {
+        LIST_FOREACH(cli, reactor->clis[i]) {
             FD_SET(cli->sock, rfds);
             if (max_fd < cli->sock) {
                 max_fd = cli->sock;
@@ -680,29 +1445,24 @@ int lwdistcomm_server_get_fds(lwdistcomm_server_t *server, fd_set *rfds)
     return max_fd;
 }
 
-/* Process input events */
-bool lwdistcomm_server_process_input(lwdistcomm_server_t *server, const fd_set *rfds)
+/* Process reactor input events */
+static bool lwdistcomm_server_reactor_input(lwdistcomm_server_reactor_t *reactor, const fd_set *rfds)
 {
-    if (!server || !server->valid || !rfds) {
-        return false;
-    }
+    lwdistcomm_server_t *server = reactor->server;
 
     // Process client sockets
     for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
         lwdistcomm_server_cli_t *cli, *cli_temp;
-        LIST_FOREACH_SAFE(cli, cli_temp, server->clis[i]) {
+        LIST_FOREACH_SAFE(cli, cli_temp, reactor->clis[i]) {
             if (FD_ISSET(cli->sock, rfds)) {
-                ssize_t num = lwdistcomm_transport_recv(cli->sock, server->recvbuf, LWDISTCOMM_MSG_MAX_LEN, 0);
+                ssize_t num = lwdistcomm_transport_recv(cli->sock, reactor->recvbuf, LWDISTCOMM_MSG_MAX_LEN, 0);
                 if (num > 0) {
-                    struct {
-                        lwdistcomm_server_t *server;
-                        lwdistcomm_server_cli_t *cli;
-                    } input_arg = {server, cli};
-
-                    lwdistcomm_msg_input(&cli->recv, server->recvbuf, num, lwdistcomm_server_input, &input_arg);
+                    if (!lwdistcomm_msg_input(&cli->recv, reactor->recvbuf, num, lwdistcomm_server_input, cli)) {
+                        cli->closing = true;
+                    }
                 }
 
-                if (num == 0 || (num < 0 && errno != EWOULDBLOCK)) {
+                if (num == 0 || (num < 0 && errno != EWOULDBLOCK) || cli->closing) {
                     if (cli->onconn) {
                         cli->onconn = false;
                         if (server->oncli) {
@@ -710,39 +1470,31 @@ bool lwdistcomm_server_process_input(lwdistcomm_server_t *server, const fd_set *
                         }
                     }
 
-                    // Lock server
-                    // TODO: Implement proper locking
-
                     lwdistcomm_server_cli_destroy(server, cli);
-
-                    // Unlock server
-                    // TODO: Implement proper locking
                 }
             }
         }
     }
 
     // Process server socket (new connections)
-    if (server->sock >= 0 && FD_ISSET(server->sock, rfds)) {
+    if (reactor->sock >= 0 && FD_ISSET(reactor->sock, rfds)) {
         struct sockaddr_storage addr;
         socklen_t addr_len = sizeof(addr);
-        int sock = lwdistcomm_transport_accept(server->sock, (struct sockaddr *)&addr, &addr_len);
+        int sock = lwdistcomm_transport_accept(reactor->sock, (struct sockaddr *)&addr, &addr_len);
         if (sock >= 0) {
             lwdistcomm_server_cli_t *cli = (lwdistcomm_server_cli_t *)malloc(sizeof(lwdistcomm_server_cli_t));
             if (cli) {
                 memset(cli, 0, sizeof(lwdistcomm_server_cli_t));
                 cli->sock = sock;
+                cli->shm_slot = -1;
                 cli->active = false;
                 lwdistcomm_msg_init_recv(&cli->recv);
+                lwdistcomm_msg_set_recv_max(&cli->recv, server->max_msg_size);
                 lwdistcomm_transport_set_timeout(sock, LWDISTCOMM_SERVER_DEF_SEND_TIMEOUT);
 
-                // Lock server
-                // TODO: Implement proper locking
-
-                lwdistcomm_server_cli_init(server, cli);
-
-                // Unlock server
-                // TODO: Implement proper locking
+                pthread_mutex_lock(&reactor->lock);
+                lwdistcomm_server_cli_init(reactor, cli);
+                pthread_mutex_unlock(&reactor->lock);
 
             } else {
                 lwdistcomm_transport_close(sock);
@@ -750,28 +1502,41 @@ bool lwdistcomm_server_process_input(lwdistcomm_server_t *server, const fd_set *
         }
     }
 
+    // Drain output queues of writable clients
+    if (FD_ISSET(reactor->epfd, rfds)) {
+        struct epoll_event events[LWDISTCOMM_SERVER_MAX_EVENTS];
+
+        pthread_mutex_lock(&reactor->lock);
+
+        int num = epoll_wait(reactor->epfd, events, LWDISTCOMM_SERVER_MAX_EVENTS, 0);
+        for (int i = 0; i < num; i++) {
+            lwdistcomm_server_cli_t *cli = (lwdistcomm_server_cli_t *)events[i].data.ptr;
+            if (!lwdistcomm_server_cli_flush(server, cli)) {
+                lwdistcomm_server_cli_close(cli);
+            }
+        }
+
+        pthread_mutex_unlock(&reactor->lock);
+    }
+
     // Process event fd
-    if (FD_ISSET(server->evtfd[0], rfds)) {
+    if (FD_ISSET(reactor->evtfd[0], rfds)) {
         uint64_t val;
-        read(server->evtfd[0], &val, sizeof(val));
-
-        // Lock server
-        // TODO: Implement proper locking
+        read(reactor->evtfd[0], &val, sizeof(val));
 
         lwdistcomm_server_hst_t *hst, *hst_temp;
-        LIST_FOREACH_SAFE(hst, hst_temp, server->hst_h) {
+        LIST_FOREACH_SAFE(hst, hst_temp, reactor->hst_h) {
             if (hst->alive <= 0) {
+                pthread_mutex_lock(&reactor->lock);
                 hst->alive = 0;
-                DELETE_FROM_LIST(hst, server->hst_h);
+                DELETE_FROM_LIST(hst, reactor->hst_h);
+                pthread_mutex_unlock(&reactor->lock);
 
                 // Get client from handshake timer
                 lwdistcomm_server_cli_t *cli = (lwdistcomm_server_cli_t *)((char *)hst - offsetof(lwdistcomm_server_cli_t, hst));
                 lwdistcomm_server_cli_destroy(server, cli);
             }
         }
-
-        // Unlock server
-        // TODO: Implement proper locking
     }
 
     return true;
@@ -897,7 +1662,6 @@ static void *lwdistcomm_server_discovery_thread_func(void *arg)
     }
     
     server->discovery_socket = sockfd;
-    server->discovery_thread_running = true;
     
     /* 发送服务器宣告消息 */
     discovery_msg_t announce_msg;
@@ -974,8 +1738,11 @@ bool lwdistcomm_server_start_discovery(lwdistcomm_server_t *server)
         return true;
     }
     
+    /* 在创建线程前置位，保证stop_discovery总能等待线程退出 */
+    server->discovery_thread_running = true;
     int ret = pthread_create(&server->discovery_thread, NULL, lwdistcomm_server_discovery_thread_func, server);
     if (ret != 0) {
+        server->discovery_thread_running = false;
         return false;
     }
     
@@ -1008,32 +1775,32 @@ void lwdistcomm_server_destroy(lwdistcomm_server_t *server)
         return;
     }
 
-    server->valid = false;
+    // Stop reactor threads and close listeners
+    lwdistcomm_server_stop(server);
 
-    // Stop discovery thread
+    // Stop discovery thread, it uses the server until joined
     lwdistcomm_server_stop_discovery(server);
 
+    server->valid = false;
+
     // Remove from server list
     // TODO: Implement proper locking
     DELETE_FROM_LIST(server, lwdistcomm_server_list);
 
-    if (server->sock >= 0) {
-        lwdistcomm_transport_close(server->sock);
-        server->sock = -1;
+    // Cleanup reactors and their clients
+    for (int i = 0; i < LWDISTCOMM_SERVER_MAX_REACTORS; i++) {
+        lwdistcomm_server_reactor_free(&server->reactors[i]);
     }
 
-    close(server->evtfd[0]);
-    close(server->evtfd[1]);
-    free(server->sendbuf);
-
-    // Cleanup clients
-    for (int i = 0; i < LWDISTCOMM_SERVER_CLI_HASH_SIZE; i++) {
-        lwdistcomm_server_cli_t *cli, *cli_temp;
-        LIST_FOREACH_SAFE(cli, cli_temp, server->clis[i]) {
-            lwdistcomm_server_cli_destroy(server, cli);
-        }
+    // Cleanup topic policies
+    lwdistcomm_server_pol_t *pol, *pol_temp;
+    LIST_FOREACH_SAFE(pol, pol_temp, server->policies) {
+        DELETE_FROM_LIST(pol, server->policies);
+        free(pol);
     }
 
+    lwdistcomm_shm_ring_destroy(server->shm);
+
     // Cleanup commands
     for (int i = 0; i < LWDISTCOMM_SERVER_CMD_HASH_SIZE; i++) {
         lwdistcomm_server_cmd_t *cmd, *cmd_temp;
@@ -1060,18 +1827,17 @@ void lwdistcomm_server_destroy(lwdistcomm_server_t *server)
         lwdistcomm_security_destroy(server->security);
     }
 
+    pthread_rwlock_destroy(&server->cmd_lock);
+    pthread_mutex_destroy(&server->lock);
     free(server);
 }
 
 /* Server input callback */
 static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
 {
-    struct {
-        lwdistcomm_server_t *server;
-        lwdistcomm_server_cli_t *cli;
-    } *input_arg = arg;
-    lwdistcomm_server_t *server = input_arg->server;
-    lwdistcomm_server_cli_t *cli = input_arg->cli;
+    lwdistcomm_server_cli_t *cli = (lwdistcomm_server_cli_t *)arg;
+    lwdistcomm_server_reactor_t *reactor = cli->reactor;
+    lwdistcomm_server_t *server = reactor->server;
 
     if (header->type == LWDISTCOMM_MSG_TYPE_NOOP || header->type == LWDISTCOMM_MSG_FLAG_REPLY) {
         return true;
@@ -1084,6 +1850,13 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
     lwdistcomm_msg_get_url(header, &url, &url_len);
     lwdistcomm_msg_get_payload(header, &msg);
 
+    // URL is followed by payload in the frame
+    if (url_len) {
+        memcpy(reactor->urlbuf, url, url_len);
+    }
+    reactor->urlbuf[url_len] = '\0';
+    url = reactor->urlbuf;
+
     if (!cli->active) {
         cli->active = true;
     }
@@ -1098,21 +1871,32 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
     switch (header->type) {
     case LWDISTCOMM_MSG_TYPE_SERVINFO:
     {
-        // Send service info response
-        lwdistcomm_msg_header_t *response = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_SERVINFO, 0, ntohs(header->seqno));
+        // Client capabilities, older clients send none
+        if (msg.data_len >= sizeof(uint32_t)) {
+            uint32_t caps;
+            memcpy(&caps, msg.data, sizeof(caps));
+            pthread_mutex_lock(&reactor->lock);
+            cli->caps = ntohl(caps);
+            pthread_mutex_unlock(&reactor->lock);
+        }
+
+        // Send service info response, the capability word is ignored by older clients
+        uint32_t info[2] = { cli->id, htonl((server->shm_local && server->shm_enable ? LWDISTCOMM_SERVINFO_CAP_SHM : 0) | LWDISTCOMM_SERVINFO_CAP_LZ4) };
         lwdistcomm_message_t response_msg;
-        response_msg.data = &cli->id;
-        response_msg.data_len = sizeof(cli->id);
-        lwdistcomm_msg_set_payload(response, &response_msg);
-        if (!lwdistcomm_server_cli_sendmsg(cli, response, NULL, &response_msg)) {
+        response_msg.data = info;
+        response_msg.data_len = sizeof(info);
+        if (!lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_SERVINFO, 0, ntohs(header->seqno), &response_msg)) {
             // Send failed, client is disconnected
-            lwdistcomm_server_cli_destroy(server, cli);
-            return true;
+            return false;
         }
 
         // Remove from handshake list
-        cli->hst.alive = 0;
-        DELETE_FROM_LIST(&cli->hst, server->hst_h);
+        pthread_mutex_lock(&reactor->lock);
+        if (cli->hst.alive) {
+            cli->hst.alive = 0;
+            DELETE_FROM_LIST(&cli->hst, reactor->hst_h);
+        }
+        pthread_mutex_unlock(&reactor->lock);
 
         // Notify client connected
         if (!cli->onconn) {
@@ -1132,24 +1916,17 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
             lwdistcomm_message_t response;
             memset(&response, 0, sizeof(response));
             callback(cb_arg, cli->id, url, &msg, &response);
-            
+
             // Send response
-            lwdistcomm_msg_header_t *response_header = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_RPC, 0, ntohs(header->seqno));
-            if (response.data) {
-                lwdistcomm_msg_set_payload(response_header, &response);
-            }
-            if (!lwdistcomm_server_cli_sendmsg(cli, response_header, NULL, response.data ? &response : NULL)) {
+            if (!lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_RPC, 0, ntohs(header->seqno), response.data ? &response : NULL)) {
                 // Send failed, client is disconnected
-                lwdistcomm_server_cli_destroy(server, cli);
-                return true;
+                return false;
             }
         } else {
             // Send error response
-            lwdistcomm_msg_header_t *response = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_RPC, LWDISTCOMM_STATUS_INVALID_URL, ntohs(header->seqno));
-            if (!lwdistcomm_server_cli_sendmsg(cli, response, NULL, NULL)) {
+            if (!lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_RPC, LWDISTCOMM_STATUS_INVALID_URL, ntohs(header->seqno), NULL)) {
                 // Send failed, client is disconnected
-                lwdistcomm_server_cli_destroy(server, cli);
-                return true;
+                return false;
             }
         }
         break;
@@ -1158,6 +1935,9 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
     case LWDISTCOMM_MSG_TYPE_SUBSCRIBE:
     {
         lwdistcomm_server_sub_t *sub;
+
+        pthread_mutex_lock(&reactor->lock);
+
         LIST_FOREACH(sub, cli->subscribed) {
             if (sub->len == url_len && !memcmp(sub->url, url, sub->len)) {
                 break;
@@ -1175,12 +1955,12 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
             }
         }
 
+        pthread_mutex_unlock(&reactor->lock);
+
         // Send response
-        lwdistcomm_msg_header_t *response = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_SUBSCRIBE, 0, ntohs(header->seqno));
-        if (!lwdistcomm_server_cli_sendmsg(cli, response, NULL, NULL)) {
+        if (!lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_SUBSCRIBE, 0, ntohs(header->seqno), NULL)) {
             // Send failed, client is disconnected
-            lwdistcomm_server_cli_destroy(server, cli);
-            return true;
+            return false;
         }
         break;
     }
@@ -1188,6 +1968,9 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
     case LWDISTCOMM_MSG_TYPE_UNSUBSCRIBE:
     {
         lwdistcomm_server_sub_t *sub, *sub_temp;
+
+        pthread_mutex_lock(&reactor->lock);
+
         LIST_FOREACH_SAFE(sub, sub_temp, cli->subscribed) {
             if (sub->len == url_len && !memcmp(sub->url, url, sub->len)) {
                 DELETE_FROM_LIST(sub, cli->subscribed);
@@ -1196,12 +1979,12 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
             }
         }
 
+        pthread_mutex_unlock(&reactor->lock);
+
         // Send response
-        lwdistcomm_msg_header_t *response = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_UNSUBSCRIBE, 0, ntohs(header->seqno));
-        if (!lwdistcomm_server_cli_sendmsg(cli, response, NULL, NULL)) {
+        if (!lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_UNSUBSCRIBE, 0, ntohs(header->seqno), NULL)) {
             // Send failed, client is disconnected
-            lwdistcomm_server_cli_destroy(server, cli);
-            return true;
+            return false;
         }
         break;
     }
@@ -1217,11 +2000,18 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
         }
 
         // Send response
-        lwdistcomm_msg_header_t *response = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_AUTH, auth_success ? 0 : LWDISTCOMM_STATUS_AUTH_FAILED, ntohs(header->seqno));
-        if (!lwdistcomm_server_cli_sendmsg(cli, response, NULL, NULL)) {
+        if (!lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_AUTH, auth_success ? 0 : LWDISTCOMM_STATUS_AUTH_FAILED, ntohs(header->seqno), NULL)) {
             // Send failed, client is disconnected
-            lwdistcomm_server_cli_destroy(server, cli);
-            return true;
+            return false;
+        }
+        break;
+    }
+
+    case LWDISTCOMM_MSG_TYPE_SHMATTACH:
+    {
+        if (!lwdistcomm_server_shm_attach(server, cli, ntohs(header->seqno))) {
+            // Send failed, client is disconnected
+            return false;
         }
         break;
     }
@@ -1229,11 +2019,9 @@ static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header)
     case LWDISTCOMM_MSG_TYPE_PINGECHO:
     {
         // Send ping response
-        lwdistcomm_msg_header_t *response = lwdistcomm_msg_init_header(server->sendbuf, LWDISTCOMM_MSG_TYPE_PINGECHO, 0, ntohs(header->seqno));
-        if (!lwdistcomm_server_cli_sendmsg(cli, response, NULL, NULL)) {
+        if (!lwdistcomm_server_cli_reply(server, cli, LWDISTCOMM_MSG_TYPE_PINGECHO, 0, ntohs(header->seqno), NULL)) {
             // Send failed, client is disconnected
-            lwdistcomm_server_cli_destroy(server, cli);
-            return true;
+            return false;
         }
         break;
     }
@@ -11,14 +11,17 @@
 #ifndef LWDISTCOMM_SERVER_IMPL_H
 #define LWDISTCOMM_SERVER_IMPL_H
 
+#include <pthread.h>
 #include "../../include/server.h"
 #include "../../include/security.h"
 #include "../../include/message.h"
+#include "../shm/shm_impl.h"
 
 /* Message constants */
 #define LWDISTCOMM_MSG_MAX_LEN  131072
 #define LWDISTCOMM_MSG_HDR_LEN  sizeof(lwdistcomm_msg_header_t)
 #define LWDISTCOMM_MSG_MAX_DATA (LWDISTCOMM_MSG_MAX_LEN - LWDISTCOMM_MSG_HDR_LEN)
+#define LWDISTCOMM_MSG_URL_MAX  0xffff
 
 /* Client hash */
 #define LWDISTCOMM_SERVER_CLI_HASH_SIZE  64
@@ -36,6 +39,42 @@ typedef struct lwdistcomm_server_sub {
     char url[1];
 } lwdistcomm_server_sub_t;
 
+/* Outgoing frame, the payload is copied into a shared pbuf only when a client has to queue it,
+ * its LZ4 twin is compressed on first use and shared by all clients that negotiated compression */
+typedef struct lwdistcomm_server_frame {
+    lwdistcomm_msg_header_t header;
+    struct iovec iov[LWDISTCOMM_MSG_IOV_MAX];
+    int iovcnt;
+    size_t len;
+    const char *url;
+    const lwdistcomm_message_t *msg;
+    lwdistcomm_pbuf_t *pbuf;
+    bool pbuf_owned;
+    bool lz4_tried;
+    struct lwdistcomm_server_frame *lz4;
+    lwdistcomm_message_t lz4_msg;
+} lwdistcomm_server_frame_t;
+
+/* Client output queue node (one pending frame: private header and URL, shared payload) */
+typedef struct lwdistcomm_server_outq {
+    struct lwdistcomm_server_outq *next;
+    struct lwdistcomm_server_outq *prev;
+    lwdistcomm_pbuf_t *pbuf;
+    size_t len;
+    size_t offset;
+    size_t hlen;
+    uint8_t head[1];
+} lwdistcomm_server_outq_t;
+
+/* Topic overflow policy node */
+typedef struct lwdistcomm_server_pol {
+    struct lwdistcomm_server_pol *next;
+    struct lwdistcomm_server_pol *prev;
+    lwdistcomm_server_policy_t policy;
+    size_t len;
+    char url[1];
+} lwdistcomm_server_pol_t;
+
 /* Client handshake timer */
 typedef struct lwdistcomm_server_hst {
     struct lwdistcomm_server_hst *next;
@@ -43,19 +82,46 @@ typedef struct lwdistcomm_server_hst {
     int alive;
 } lwdistcomm_server_hst_t;
 
+struct lwdistcomm_server_reactor;
+
 /* Client node */
 typedef struct lwdistcomm_server_cli {
     bool active;
     bool onconn;
+    bool closing;
+    bool epollout;
     struct lwdistcomm_server_cli *next;
     struct lwdistcomm_server_cli *prev;
     lwdistcomm_server_sub_t *subscribed;
+    lwdistcomm_server_outq_t *outq_h;
+    lwdistcomm_server_outq_t *outq_t;
+    lwdistcomm_server_cli_stats_t stats;
     lwdistcomm_server_hst_t hst;
     lwdistcomm_msg_recv_t recv;
+    struct lwdistcomm_server_reactor *reactor;
     int sock;
+    int shm_slot;
     uint32_t id;
+    uint32_t caps;
 } lwdistcomm_server_cli_t;
 
+/* Reactor, owns a listener and the clients it accepted, lock protects its clients and their output queues */
+typedef struct lwdistcomm_server_reactor {
+    lwdistcomm_server_t *server;
+    uint32_t index;
+    uint32_t ncid;
+    lwdistcomm_server_hst_t *hst_h;
+    lwdistcomm_server_cli_t *clis[LWDISTCOMM_SERVER_CLI_HASH_SIZE];
+    pthread_mutex_t lock;
+    pthread_t thread;
+    bool running;
+    int sock;
+    int epfd;
+    int evtfd[2];
+    void *recvbuf;
+    char *urlbuf;
+} lwdistcomm_server_reactor_t;
+
 /* Server command */
 typedef struct lwdistcomm_server_cmd {
     struct lwdistcomm_server_cmd *next;
@@ -70,11 +136,11 @@ typedef struct lwdistcomm_server_cmd {
 struct lwdistcomm_server {
     bool valid;
     char ifname[IF_NAMESIZE];
-    uint32_t ncid;
     lwdistcomm_server_t *next;
     lwdistcomm_server_t *prev;
-    lwdistcomm_server_hst_t *hst_h;
-    lwdistcomm_server_cli_t *clis[LWDISTCOMM_SERVER_CLI_HASH_SIZE];
+    lwdistcomm_server_reactor_t reactors[LWDISTCOMM_SERVER_MAX_REACTORS];
+    uint32_t nreactors;
+    pthread_rwlock_t cmd_lock;
     lwdistcomm_server_cmd_t *cmds[LWDISTCOMM_SERVER_CMD_HASH_SIZE];
     lwdistcomm_server_cmd_t *def_cmd;
     lwdistcomm_server_cmd_t *prefix_h;
@@ -85,12 +151,21 @@ struct lwdistcomm_server {
     void *carg;
     lwdistcomm_server_auth_cb_t onauth;
     void *aarg;
-    void *lock;
+    pthread_mutex_t lock;
     struct timeval send_timeout;
-    int sock;
-    int evtfd[2];
-    void *sendbuf;
-    void *recvbuf;
+    size_t high_watermark;
+    size_t low_watermark;
+    size_t max_msg_size;
+    lwdistcomm_server_policy_t def_policy;
+    lwdistcomm_server_pol_t *policies;
+    bool shm_local;
+    bool shm_enable;
+    size_t shm_size;
+    uint64_t shm_used;
+    lwdistcomm_shm_ring_t *shm;
+    int shm_evtfds[LWDISTCOMM_SHM_SLOTS];
+    bool lz4_enable;
+    size_t lz4_threshold;
     lwdistcomm_security_t *security;
     bool enable_discovery;
     int discovery_port;
@@ -107,15 +182,37 @@ struct lwdistcomm_server {
 #define LWDISTCOMM_SERVER_KEEPALIVE_TIMEOUT  10
 #define LWDISTCOMM_SERVER_BACKLOG  32
 
+/* Client output queue watermarks (bytes) */
+#define LWDISTCOMM_SERVER_DEF_HIGH_WATERMARK  (1024 * 1024)
+#define LWDISTCOMM_SERVER_DEF_LOW_WATERMARK   (256 * 1024)
+#define LWDISTCOMM_SERVER_MAX_EVENTS  64
+
 /* Internal functions */
 static uint32_t lwdistcomm_server_cli_hash(uint32_t id);
-static lwdistcomm_server_cli_t *lwdistcomm_server_cli_find(lwdistcomm_server_t *server, uint32_t id);
-static uint32_t lwdistcomm_server_cli_newid(lwdistcomm_server_t *server);
-static void lwdistcomm_server_cli_init(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli);
+static lwdistcomm_server_cli_t *lwdistcomm_server_cli_find(lwdistcomm_server_reactor_t *reactor, uint32_t id);
+static uint32_t lwdistcomm_server_cli_newid(lwdistcomm_server_reactor_t *reactor);
+static void lwdistcomm_server_cli_init(lwdistcomm_server_reactor_t *reactor, lwdistcomm_server_cli_t *cli);
 static void lwdistcomm_server_cli_destroy(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli);
+static void lwdistcomm_server_cli_close(lwdistcomm_server_cli_t *cli);
 static bool lwdistcomm_server_cli_sub_match(lwdistcomm_server_cli_t *cli, const char *url);
-static bool lwdistcomm_server_cli_sendmsg(lwdistcomm_server_cli_t *cli, lwdistcomm_msg_header_t *header, const char *url, const lwdistcomm_message_t *msg);
+static bool lwdistcomm_server_cli_flush(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli);
+static bool lwdistcomm_server_frame_init(lwdistcomm_server_frame_t *frame, uint8_t type, uint8_t status, uint16_t seqno, const char *url, const lwdistcomm_message_t *msg);
+static lwdistcomm_pbuf_t *lwdistcomm_server_frame_pbuf(lwdistcomm_server_frame_t *frame);
+static void lwdistcomm_server_frame_release(lwdistcomm_server_frame_t *frame);
+static lwdistcomm_server_frame_t *lwdistcomm_server_frame_select(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, lwdistcomm_server_frame_t *frame);
+static bool lwdistcomm_server_cli_output(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, lwdistcomm_server_frame_t *frame, lwdistcomm_server_policy_t policy);
+static bool lwdistcomm_server_publish_frame(lwdistcomm_server_t *server, lwdistcomm_server_frame_t *frame);
+static bool lwdistcomm_server_cli_reply(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, uint8_t type, uint8_t status, uint16_t seqno, const lwdistcomm_message_t *msg);
+static lwdistcomm_server_policy_t lwdistcomm_server_policy_match(lwdistcomm_server_t *server, const char *url);
+static bool lwdistcomm_server_shm_attach(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli, uint16_t seqno);
+static void lwdistcomm_server_shm_detach(lwdistcomm_server_t *server, lwdistcomm_server_cli_t *cli);
 static bool lwdistcomm_server_cmd_match(lwdistcomm_server_t *server, const char *url, lwdistcomm_server_handler_cb_t *callback, void **arg);
 static bool lwdistcomm_server_input(void *arg, lwdistcomm_msg_header_t *header);
+static bool lwdistcomm_server_reactor_init(lwdistcomm_server_t *server, uint32_t index);
+static void lwdistcomm_server_reactor_free(lwdistcomm_server_reactor_t *reactor);
+static bool lwdistcomm_server_reactor_listen(lwdistcomm_server_reactor_t *reactor, const lwdistcomm_address_t *addr);
+static int lwdistcomm_server_reactor_get_fds(lwdistcomm_server_reactor_t *reactor, fd_set *rfds);
+static bool lwdistcomm_server_reactor_input(lwdistcomm_server_reactor_t *reactor, const fd_set *rfds);
+static void *lwdistcomm_server_reactor_thread(void *arg);
 
 #endif /* LWDISTCOMM_SERVER_IMPL_H */
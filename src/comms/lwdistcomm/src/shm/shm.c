@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2026 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: shm.c Shared memory publish ring implementation for LwDistComm.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shm_impl.h"
+
+/* Data area offset, page aligned */
+#define LWDISTCOMM_SHM_DATA_OFFSET  ((sizeof(lwdistcomm_shm_hdr_t) + 4095) & ~(size_t)4095)
+
+/* Record length rounded to alignment */
+static inline size_t lwdistcomm_shm_rec_len(size_t len)
+{
+    return (LWDISTCOMM_SHM_REC_HDR_LEN + len + LWDISTCOMM_SHM_ALIGN - 1) & ~(size_t)(LWDISTCOMM_SHM_ALIGN - 1);
+}
+
+/* Map ring file */
+static lwdistcomm_shm_ring_t *lwdistcomm_shm_ring_map(int fd, size_t map_len)
+{
+    lwdistcomm_shm_ring_t *ring = (lwdistcomm_shm_ring_t *)malloc(sizeof(lwdistcomm_shm_ring_t));
+    if (!ring) {
+        return NULL;
+    }
+
+    void *addr = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->fd = fd;
+    ring->map_len = map_len;
+    ring->hdr = (lwdistcomm_shm_hdr_t *)addr;
+    ring->data = (uint8_t *)addr + LWDISTCOMM_SHM_DATA_OFFSET;
+    ring->size = 0;
+
+    return ring;
+}
+
+/* Create ring */
+lwdistcomm_shm_ring_t *lwdistcomm_shm_ring_create(size_t size)
+{
+    size_t ring_size = LWDISTCOMM_SHM_MIN_SIZE;
+
+    while (ring_size < size && ring_size < ((size_t)1 << 30)) {
+        ring_size <<= 1;
+    }
+
+    int fd = memfd_create("lwdistcomm-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    size_t map_len = LWDISTCOMM_SHM_DATA_OFFSET + ring_size;
+    if (ftruncate(fd, (off_t)map_len) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // Consumers must not be able to resize the mapping under the producer
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+    lwdistcomm_shm_ring_t *ring = lwdistcomm_shm_ring_map(fd, map_len);
+    if (!ring) {
+        close(fd);
+        return NULL;
+    }
+
+    ring->size = (uint32_t)ring_size;
+    ring->hdr->magic = LWDISTCOMM_SHM_MAGIC;
+    ring->hdr->version = LWDISTCOMM_SHM_VERSION;
+    ring->hdr->size = (uint32_t)ring_size;
+    ring->hdr->offset = (uint32_t)LWDISTCOMM_SHM_DATA_OFFSET;
+
+    return ring;
+}
+
+/* Map ring received from producer */
+lwdistcomm_shm_ring_t *lwdistcomm_shm_ring_attach(int fd)
+{
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) < 0 || (size_t)st.st_size <= LWDISTCOMM_SHM_DATA_OFFSET) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    lwdistcomm_shm_ring_t *ring = lwdistcomm_shm_ring_map(fd, (size_t)st.st_size);
+    if (!ring) {
+        close(fd);
+        return NULL;
+    }
+
+    lwdistcomm_shm_hdr_t *hdr = ring->hdr;
+    if (hdr->magic != LWDISTCOMM_SHM_MAGIC || hdr->version != LWDISTCOMM_SHM_VERSION ||
+        hdr->offset != LWDISTCOMM_SHM_DATA_OFFSET || hdr->size < LWDISTCOMM_SHM_MIN_SIZE ||
+        (hdr->size & (hdr->size - 1)) || hdr->offset + (size_t)hdr->size > ring->map_len) {
+        lwdistcomm_shm_ring_destroy(ring);
+        return NULL;
+    }
+
+    ring->size = hdr->size;
+
+    return ring;
+}
+
+/* Unmap ring */
+void lwdistcomm_shm_ring_destroy(lwdistcomm_shm_ring_t *ring)
+{
+    if (ring) {
+        munmap(ring->hdr, ring->map_len);
+        close(ring->fd);
+        free(ring);
+    }
+}
+
+/* Current producer position */
+uint64_t lwdistcomm_shm_ring_head(const lwdistcomm_shm_ring_t *ring)
+{
+    return __atomic_load_n(&ring->hdr->head, __ATOMIC_ACQUIRE);
+}
+
+/* Write one frame */
+bool lwdistcomm_shm_ring_write(lwdistcomm_shm_ring_t *ring, const struct iovec *iov, int iovcnt, size_t len, uint64_t mask, const int *evtfds)
+{
+    if (!ring || !mask || LWDISTCOMM_SHM_REC_HDR_LEN + len > LWDISTCOMM_SHM_REC_MAX) {
+        return false;
+    }
+
+    uint64_t head = __atomic_load_n(&ring->hdr->head, __ATOMIC_RELAXED);
+    size_t off = head & (ring->size - 1);
+    size_t rec_len = lwdistcomm_shm_rec_len(len);
+    lwdistcomm_shm_rec_t *rec;
+
+    // Records never wrap, pad the tail of the data area
+    if (off + rec_len > ring->size) {
+        rec = (lwdistcomm_shm_rec_t *)(ring->data + off);
+        rec->len = 0;
+        rec->flags = LWDISTCOMM_SHM_REC_PAD;
+        rec->mask = 0;
+        head += ring->size - off;
+        off = 0;
+    }
+
+    rec = (lwdistcomm_shm_rec_t *)(ring->data + off);
+    rec->len = (uint32_t)len;
+    rec->flags = 0;
+    rec->mask = mask;
+
+    uint8_t *dst = ring->data + off + LWDISTCOMM_SHM_REC_HDR_LEN;
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+        dst += iov[i].iov_len;
+    }
+
+    // Publish record, then wake only consumers that went to sleep
+    __atomic_store_n(&ring->hdr->head, head + rec_len, __ATOMIC_SEQ_CST);
+
+    while (mask) {
+        int slot = __builtin_ctzll(mask);
+        mask &= mask - 1;
+        if (__atomic_exchange_n(&ring->hdr->slot[slot].waiting, 0, __ATOMIC_SEQ_CST) && evtfds[slot] >= 0) {
+            uint64_t val = 1;
+            ssize_t ret = write(evtfds[slot], &val, sizeof(val));
+            (void)ret;
+        }
+    }
+
+    return true;
+}
+
+/* Reset consumer slot */
+void lwdistcomm_shm_ring_reset_slot(lwdistcomm_shm_ring_t *ring, int slot)
+{
+    if (ring && slot >= 0 && slot < LWDISTCOMM_SHM_SLOTS) {
+        __atomic_store_n(&ring->hdr->slot[slot].waiting, 0, __ATOMIC_RELAXED);
+    }
+}
+
+/* Create consumer */
+lwdistcomm_shm_reader_t *lwdistcomm_shm_reader_create(lwdistcomm_shm_ring_t *ring, int slot, int evtfd, uint64_t pos)
+{
+    if (!ring || slot < 0 || slot >= LWDISTCOMM_SHM_SLOTS || evtfd < 0) {
+        return NULL;
+    }
+
+    lwdistcomm_shm_reader_t *reader = (lwdistcomm_shm_reader_t *)malloc(sizeof(lwdistcomm_shm_reader_t));
+    if (!reader) {
+        return NULL;
+    }
+
+    memset(reader, 0, sizeof(lwdistcomm_shm_reader_t));
+    reader->ring = ring;
+    reader->pos = pos;
+    reader->bit = (uint64_t)1 << slot;
+    reader->slot = slot;
+    reader->evtfd = evtfd;
+
+    return reader;
+}
+
+/* Destroy consumer */
+void lwdistcomm_shm_reader_destroy(lwdistcomm_shm_reader_t *reader)
+{
+    if (reader) {
+        lwdistcomm_shm_ring_destroy(reader->ring);
+        close(reader->evtfd);
+        free(reader);
+    }
+}
+
+/* Check whether the producer may be overwriting the record at pos */
+static inline bool lwdistcomm_shm_reader_lapped(lwdistcomm_shm_reader_t *reader, uint64_t head)
+{
+    return head - reader->pos > reader->ring->size - LWDISTCOMM_SHM_GUARD;
+}
+
+/* Copy next frame for this consumer */
+size_t lwdistcomm_shm_reader_read(lwdistcomm_shm_reader_t *reader, void *buffer, size_t size)
+{
+    lwdistcomm_shm_ring_t *ring = reader->ring;
+    lwdistcomm_shm_rec_t rec;
+    uint64_t head;
+
+    for (;;) {
+        head = lwdistcomm_shm_ring_head(ring);
+        if (reader->pos == head) {
+            return 0;
+        }
+
+        if (lwdistcomm_shm_reader_lapped(reader, head)) {
+            reader->overruns++;
+            reader->pos = head;
+            return 0;
+        }
+
+        size_t off = reader->pos & (ring->size - 1);
+        memcpy(&rec, ring->data + off, sizeof(rec));
+
+        if (rec.flags & LWDISTCOMM_SHM_REC_PAD) {
+            reader->pos += ring->size - off;
+            continue;
+        }
+
+        size_t rec_len = lwdistcomm_shm_rec_len(rec.len);
+        if (off + rec_len > ring->size) {
+            // Torn record header, the producer lapped us
+            reader->overruns++;
+            reader->pos = lwdistcomm_shm_ring_head(ring);
+            return 0;
+        }
+
+        if (!(rec.mask & reader->bit) || rec.len > size) {
+            reader->pos += rec_len;
+            continue;
+        }
+
+        memcpy(buffer, ring->data + off + LWDISTCOMM_SHM_REC_HDR_LEN, rec.len);
+
+        // Validate the copy was not overwritten while reading
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        head = __atomic_load_n(&ring->hdr->head, __ATOMIC_RELAXED);
+        if (lwdistcomm_shm_reader_lapped(reader, head)) {
+            reader->overruns++;
+            reader->pos = head;
+            return 0;
+        }
+
+        reader->pos += rec_len;
+        reader->msgs++;
+        return rec.len;
+    }
+}
+
+/* Arm eventfd wakeup */
+bool lwdistcomm_shm_reader_sleep(lwdistcomm_shm_reader_t *reader)
+{
+    lwdistcomm_shm_hdr_t *hdr = reader->ring->hdr;
+
+    __atomic_store_n(&hdr->slot[reader->slot].waiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&hdr->head, __ATOMIC_SEQ_CST) != reader->pos) {
+        __atomic_store_n(&hdr->slot[reader->slot].waiting, 0, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: shm_impl.h Shared memory publish ring internal implementation for LwDistComm.
+ *
+ */
+
+#ifndef LWDISTCOMM_SHM_IMPL_H
+#define LWDISTCOMM_SHM_IMPL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/uio.h>
+
+/*
+ * Single producer, multi consumer ring in a memfd mapping.
+ * The server writes each published frame once, tagged with a mask of the
+ * consumer slots subscribed to it. Consumers never block the producer, a
+ * consumer lapped by the producer skips ahead and counts an overrun.
+ */
+
+/* Ring constants */
+#define LWDISTCOMM_SHM_MAGIC        0x4c534852
+#define LWDISTCOMM_SHM_VERSION      1
+#define LWDISTCOMM_SHM_SLOTS        64
+#define LWDISTCOMM_SHM_DEF_SIZE     (4 * 1024 * 1024)
+#define LWDISTCOMM_SHM_ALIGN        16
+#define LWDISTCOMM_SHM_REC_HDR_LEN  sizeof(lwdistcomm_shm_rec_t)
+#define LWDISTCOMM_SHM_REC_MAX      ((131072 + LWDISTCOMM_SHM_REC_HDR_LEN + LWDISTCOMM_SHM_ALIGN - 1) & ~(size_t)(LWDISTCOMM_SHM_ALIGN - 1))
+#define LWDISTCOMM_SHM_GUARD        (2 * LWDISTCOMM_SHM_REC_MAX)
+#define LWDISTCOMM_SHM_MIN_SIZE     (2 * 1024 * 1024)  // Power of two, at least 8 max records
+
+/* Record flags */
+#define LWDISTCOMM_SHM_REC_PAD      0x1
+
+/* Consumer slot, one cache line each */
+typedef struct {
+    uint32_t waiting;   // Consumer sleeps on its eventfd
+    uint32_t reserved;
+} __attribute__((aligned(64))) lwdistcomm_shm_slot_t;
+
+/* Shared ring header */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;      // Data area size, power of two
+    uint32_t offset;    // Data area offset
+    uint64_t head __attribute__((aligned(64)));
+    lwdistcomm_shm_slot_t slot[LWDISTCOMM_SHM_SLOTS];
+} lwdistcomm_shm_hdr_t;
+
+/* Record header, the frame follows */
+typedef struct {
+    uint32_t len;
+    uint32_t flags;
+    uint64_t mask;
+} lwdistcomm_shm_rec_t;
+
+/* Ring mapping */
+typedef struct {
+    int fd;
+    size_t map_len;
+    lwdistcomm_shm_hdr_t *hdr;
+    uint8_t *data;
+    uint32_t size;
+} lwdistcomm_shm_ring_t;
+
+/* Ring consumer */
+typedef struct {
+    lwdistcomm_shm_ring_t *ring;
+    uint64_t pos;
+    uint64_t bit;
+    int slot;
+    int evtfd;
+    uint64_t msgs;
+    uint64_t overruns;
+} lwdistcomm_shm_reader_t;
+
+/* Create ring (producer) */
+lwdistcomm_shm_ring_t *lwdistcomm_shm_ring_create(size_t size);
+
+/* Map ring received from producer (consumer), takes ownership of fd */
+lwdistcomm_shm_ring_t *lwdistcomm_shm_ring_attach(int fd);
+
+/* Unmap ring */
+void lwdistcomm_shm_ring_destroy(lwdistcomm_shm_ring_t *ring);
+
+/* Current producer position */
+uint64_t lwdistcomm_shm_ring_head(const lwdistcomm_shm_ring_t *ring);
+
+/* Write one frame for the consumers in mask and wake the sleeping ones */
+bool lwdistcomm_shm_ring_write(lwdistcomm_shm_ring_t *ring, const struct iovec *iov, int iovcnt, size_t len, uint64_t mask, const int *evtfds);
+
+/* Reset consumer slot */
+void lwdistcomm_shm_ring_reset_slot(lwdistcomm_shm_ring_t *ring, int slot);
+
+/* Create consumer, takes ownership of ring and evtfd */
+lwdistcomm_shm_reader_t *lwdistcomm_shm_reader_create(lwdistcomm_shm_ring_t *ring, int slot, int evtfd, uint64_t pos);
+
+/* Destroy consumer */
+void lwdistcomm_shm_reader_destroy(lwdistcomm_shm_reader_t *reader);
+
+/* Copy next frame for this consumer into buffer, returns frame length or 0 when drained */
+size_t lwdistcomm_shm_reader_read(lwdistcomm_shm_reader_t *reader, void *buffer, size_t size);
+
+/* Arm eventfd wakeup, returns false if frames arrived meanwhile and the consumer must drain again */
+bool lwdistcomm_shm_reader_sleep(lwdistcomm_shm_reader_t *reader);
+
+#endif /* LWDISTCOMM_SHM_IMPL_H */
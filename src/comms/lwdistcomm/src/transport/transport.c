@@ -14,12 +14,16 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/fcntl.h>
 #include <netinet/tcp.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include "../../include/address.h"
 
+/* Max descriptors passed in one message */
+#define LWDISTCOMM_TRANSPORT_MAX_FDS  4
+
 /* Create socket based on address type */
 int lwdistcomm_transport_create_socket(lwdistcomm_addr_type_t type, bool non_blocking, int sock_type)
 {
@@ -28,6 +32,7 @@ int lwdistcomm_transport_create_socket(lwdistcomm_addr_type_t type, bool non_blo
 
     switch (type) {
     case LWDISTCOMM_ADDR_TYPE_UNIX:
+    case LWDISTCOMM_ADDR_TYPE_SHM:
         domain = AF_UNIX;
         break;
     case LWDISTCOMM_ADDR_TYPE_IPV4:
@@ -116,7 +121,7 @@ bool lwdistcomm_transport_bind(int sock, const lwdistcomm_address_t *addr)
     }
 
     // For Unix domain socket, remove existing path
-    if (addr->type == LWDISTCOMM_ADDR_TYPE_UNIX) {
+    if (addr->type == LWDISTCOMM_ADDR_TYPE_UNIX || addr->type == LWDISTCOMM_ADDR_TYPE_SHM) {
         unlink(addr->addr.unix_addr.sun_path);
     }
 
@@ -164,6 +169,148 @@ ssize_t lwdistcomm_transport_send(int sock, const void *data, size_t len)
     return send(sock, data, len, MSG_NOSIGNAL);
 }
 
+/* Send scatter-gather data without blocking */
+ssize_t lwdistcomm_transport_trysendv(int sock, const struct iovec *iov, int iovcnt)
+{
+    if (sock < 0 || !iov || iovcnt <= 0) {
+        return -1;
+    }
+
+    struct msghdr mhdr;
+    memset(&mhdr, 0, sizeof(mhdr));
+    mhdr.msg_iov = (struct iovec *)iov;
+    mhdr.msg_iovlen = iovcnt;
+
+    return sendmsg(sock, &mhdr, MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+/* Send whole scatter-gather data, iov is consumed */
+bool lwdistcomm_transport_sendv_all(int sock, struct iovec *iov, int iovcnt)
+{
+    if (sock < 0 || !iov || iovcnt <= 0) {
+        return false;
+    }
+
+    struct msghdr mhdr;
+    memset(&mhdr, 0, sizeof(mhdr));
+
+    while (iovcnt > 0) {
+        mhdr.msg_iov = iov;
+        mhdr.msg_iovlen = iovcnt;
+
+        ssize_t num = sendmsg(sock, &mhdr, MSG_NOSIGNAL);
+        if (num <= 0) {
+            return false;
+        }
+
+        // Skip what has been written
+        while (iovcnt > 0 && (size_t)num >= iov->iov_len) {
+            num -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + num;
+            iov->iov_len -= num;
+        }
+    }
+
+    return true;
+}
+
+/* Send scatter-gather data with file descriptors over a Unix domain socket */
+bool lwdistcomm_transport_sendv_fds(int sock, struct iovec *iov, int iovcnt, const int *fds, int nfds)
+{
+    if (sock < 0 || !iov || iovcnt <= 0 || !fds || nfds <= 0 || nfds > LWDISTCOMM_TRANSPORT_MAX_FDS) {
+        return false;
+    }
+
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * LWDISTCOMM_TRANSPORT_MAX_FDS)];
+    } control;
+    struct msghdr mhdr;
+
+    memset(&control, 0, sizeof(control));
+    memset(&mhdr, 0, sizeof(mhdr));
+    mhdr.msg_iov = iov;
+    mhdr.msg_iovlen = iovcnt;
+    mhdr.msg_control = control.buf;
+    mhdr.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mhdr);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+
+    // Descriptors ride on the first byte, the rest goes out as plain data
+    ssize_t num = sendmsg(sock, &mhdr, MSG_NOSIGNAL);
+    if (num <= 0) {
+        return false;
+    }
+
+    while (iovcnt > 0 && (size_t)num >= iov->iov_len) {
+        num -= iov->iov_len;
+        iov++;
+        iovcnt--;
+    }
+    if (iovcnt > 0) {
+        iov->iov_base = (uint8_t *)iov->iov_base + num;
+        iov->iov_len -= num;
+        return lwdistcomm_transport_sendv_all(sock, iov, iovcnt);
+    }
+
+    return true;
+}
+
+/* Receive data with file descriptors, unused descriptor slots are set to -1 */
+ssize_t lwdistcomm_transport_recv_fds(int sock, void *buffer, size_t len, int *fds, int nfds)
+{
+    if (sock < 0 || !buffer || len == 0 || !fds || nfds <= 0 || nfds > LWDISTCOMM_TRANSPORT_MAX_FDS) {
+        return -1;
+    }
+
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int) * LWDISTCOMM_TRANSPORT_MAX_FDS)];
+    } control;
+    struct iovec iov = { buffer, len };
+    struct msghdr mhdr;
+    int i, n = 0;
+
+    memset(&mhdr, 0, sizeof(mhdr));
+    mhdr.msg_iov = &iov;
+    mhdr.msg_iovlen = 1;
+    mhdr.msg_control = control.buf;
+    mhdr.msg_controllen = sizeof(control.buf);
+
+    for (i = 0; i < nfds; i++) {
+        fds[i] = -1;
+    }
+
+    ssize_t num = recvmsg(sock, &mhdr, MSG_CMSG_CLOEXEC);
+    if (num < 0) {
+        return num;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&mhdr); cmsg; cmsg = CMSG_NXTHDR(&mhdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            int cnt = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            int *cfds = (int *)CMSG_DATA(cmsg);
+            for (i = 0; i < cnt; i++) {
+                if (n < nfds) {
+                    fds[n++] = cfds[i];
+                } else {
+                    close(cfds[i]);
+                }
+            }
+        }
+    }
+
+    return num;
+}
+
 /* Receive data */
 ssize_t lwdistcomm_transport_recv(int sock, void *buffer, size_t len, int flags)
 {
@@ -0,0 +1,988 @@
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/address.h"
+#include "../include/dds/dds.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+
+#define BENCH_SOCKET_PATH       "/tmp/lwdistcomm_bench.sock"
+#define BENCH_TCP_PORT          17661
+#define BENCH_TOPIC             "/bench/data"
+#define BENCH_RPC_URL           "/bench/echo"
+#define BENCH_DEF_BUDGET        20000       /* 每个用例的默认投递次数 */
+#define BENCH_MIN_COUNT         20          /* 每个用例至少发布的消息数 */
+#define BENCH_MAX_BYTES         (512UL * 1024 * 1024)
+#define BENCH_MAX_SUBS          1000
+#define BENCH_SUBS_PER_CHILD    200         /* 每个订阅进程的客户端数，fd_set容纳其全部描述符 */
+#define BENCH_MAX_CHILDREN      ((BENCH_MAX_SUBS + BENCH_SUBS_PER_CHILD - 1) / BENCH_SUBS_PER_CHILD)
+#define BENCH_SHM_SLOTS         64          /* 共享内存环的消费者槽数，超过时其余订阅者退回套接字 */
+#define BENCH_WINDOW_BYTES      (1024 * 1024)
+#define BENCH_MAX_WINDOW        256
+#define BENCH_DDS_WINDOW        32
+#define BENCH_DDS_DEPTH         256
+#define BENCH_TIMEOUT_NS        (10ULL * 1000000000ULL)
+
+/**
+ * 对数线性延迟直方图，每个2的幂区间分32个桶，相对误差约3%
+ */
+#define BENCH_HIST_SUB_BITS     5
+#define BENCH_HIST_SUB          (1 << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS      (60 << BENCH_HIST_SUB_BITS)
+
+typedef struct {
+    uint64_t count;
+    uint64_t bucket[BENCH_HIST_BUCKETS];
+} bench_hist_t;
+
+/**
+ * 传输方式
+ */
+typedef enum {
+    BENCH_TRANSPORT_UNIX,
+    BENCH_TRANSPORT_TCP,
+    BENCH_TRANSPORT_SHM,
+    BENCH_TRANSPORT_COUNT
+} bench_transport_t;
+
+static const char *bench_transport_names[BENCH_TRANSPORT_COUNT] = { "unix", "tcp", "shm" };
+
+/**
+ * 发布订阅用例的阶段，由发布进程推进
+ */
+typedef enum {
+    BENCH_PHASE_IDLE,
+    BENCH_PHASE_CONNECT,
+    BENCH_PHASE_RUN,
+    BENCH_PHASE_DONE
+} bench_phase_t;
+
+/**
+ * 发布进程与订阅进程共享的状态，fork前以匿名共享映射创建
+ */
+typedef struct {
+    int phase;
+    int connected;
+    int failed;
+    uint64_t received[BENCH_MAX_SUBS];
+    uint8_t warm[BENCH_MAX_SUBS];
+    uint64_t cpu_ns[BENCH_MAX_CHILDREN];
+    bench_hist_t hist[BENCH_MAX_CHILDREN];
+} bench_shared_t;
+
+/**
+ * 订阅客户端的回调上下文
+ */
+typedef struct {
+    bench_shared_t *shared;
+    bench_hist_t *hist;
+    int index;
+} bench_sub_ctx_t;
+
+/**
+ * 单个用例的测量结果
+ */
+typedef struct {
+    const char *scenario;
+    const char *transport;
+    int subs;
+    size_t payload;
+    uint64_t msgs;          /* 送达的消息数 */
+    uint64_t lost;          /* 发出但未送达的消息数 */
+    uint64_t elapsed_ns;
+    uint64_t cpu_ns;
+    bench_hist_t *hist;
+} bench_result_t;
+
+/**
+ * 命令行选项
+ */
+typedef struct {
+    bool pubsub;
+    bool rpc;
+    bool dds;
+    int transport;          /* -1表示全部 */
+    int subs;               /* 0表示全部 */
+    size_t payload;         /* 0表示全部 */
+    uint64_t budget;
+    int reactors;
+} bench_options_t;
+
+static const int bench_subs[] = { 1, 10, 100, 1000 };
+static const size_t bench_payloads[] = { 64, 1024, 16384, 65536 };
+
+#define BENCH_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * 服务器事件线程控制
+ */
+static volatile bool server_running = true;
+
+/**
+ * 单调时钟，纳秒
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * 进程CPU时间（用户态加内核态，含全部线程），纳秒
+ */
+static uint64_t cpu_ns(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return ((uint64_t)usage.ru_utime.tv_sec + (uint64_t)usage.ru_stime.tv_sec) * 1000000000ULL +
+           ((uint64_t)usage.ru_utime.tv_usec + (uint64_t)usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+/**
+ * 记录一个延迟样本
+ */
+static void hist_add(bench_hist_t *hist, uint64_t value)
+{
+    int index;
+
+    if (value < BENCH_HIST_SUB) {
+        index = (int)value;
+    } else {
+        int exp = 63 - __builtin_clzll(value);
+        index = ((exp - BENCH_HIST_SUB_BITS + 1) << BENCH_HIST_SUB_BITS) +
+                (int)((value >> (exp - BENCH_HIST_SUB_BITS)) & (BENCH_HIST_SUB - 1));
+    }
+
+    hist->bucket[index]++;
+    hist->count++;
+}
+
+/**
+ * 合并直方图
+ */
+static void hist_merge(bench_hist_t *dst, const bench_hist_t *src)
+{
+    for (int i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        dst->bucket[i] += src->bucket[i];
+    }
+    dst->count += src->count;
+}
+
+/**
+ * 百分位数，返回所在桶的下界
+ */
+static uint64_t hist_percentile(const bench_hist_t *hist, double percentile)
+{
+    uint64_t target = (uint64_t)(percentile * (double)hist->count);
+    uint64_t seen = 0;
+
+    if (!hist->count) {
+        return 0;
+    }
+    if (target >= hist->count) {
+        target = hist->count - 1;
+    }
+
+    for (int i = 0; i < BENCH_HIST_BUCKETS; i++) {
+        seen += hist->bucket[i];
+        if (seen > target) {
+            if (i < BENCH_HIST_SUB) {
+                return (uint64_t)i;
+            }
+            int exp = (i >> BENCH_HIST_SUB_BITS) + BENCH_HIST_SUB_BITS - 1;
+            return (uint64_t)(BENCH_HIST_SUB + (i & (BENCH_HIST_SUB - 1))) << (exp - BENCH_HIST_SUB_BITS);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * 打印结果表头
+ */
+static void report_header(void)
+{
+    printf("%-10s %-5s %5s %7s %9s %11s %9s %9s %9s %9s %11s %7s\n",
+           "scenario", "trans", "subs", "payload", "msgs", "msgs/s", "MB/s",
+           "p50(us)", "p99(us)", "p999(us)", "cpu/msg(us)", "lost");
+}
+
+/**
+ * 打印一个用例的结果
+ */
+static void report(const bench_result_t *result)
+{
+    double seconds = (double)result->elapsed_ns / 1e9;
+    double rate = seconds > 0 ? (double)result->msgs / seconds : 0;
+    double cpu = result->msgs ? (double)result->cpu_ns / 1e3 / (double)result->msgs : 0;
+
+    printf("%-10s %-5s %5d %7zu %9llu %11.0f %9.1f %9.1f %9.1f %9.1f %11.2f %7llu\n",
+           result->scenario, result->transport, result->subs, result->payload,
+           (unsigned long long)result->msgs, rate, rate * (double)result->payload / 1e6,
+           (double)hist_percentile(result->hist, 0.50) / 1e3,
+           (double)hist_percentile(result->hist, 0.99) / 1e3,
+           (double)hist_percentile(result->hist, 0.999) / 1e3,
+           cpu, (unsigned long long)result->lost);
+    fflush(stdout);
+}
+
+/**
+ * 打印跳过的用例
+ */
+static void report_skip(const char *scenario, const char *transport, int subs, size_t payload, const char *reason)
+{
+    printf("%-10s %-5s %5d %7zu   skipped: %s\n", scenario, transport, subs, payload, reason);
+    fflush(stdout);
+}
+
+/**
+ * 创建传输方式对应的地址，SHM为服务器的Unix地址，由客户端以SHM地址类型连接
+ */
+static lwdistcomm_address_t *bench_address(int transport, bool client)
+{
+    lwdistcomm_address_t *addr;
+
+    if (transport == BENCH_TRANSPORT_TCP) {
+        addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_IPV4);
+        if (addr && !lwdistcomm_address_set_ipv4(addr, "127.0.0.1", BENCH_TCP_PORT)) {
+            lwdistcomm_address_destroy(addr);
+            return NULL;
+        }
+        return addr;
+    }
+
+    addr = lwdistcomm_address_create(transport == BENCH_TRANSPORT_SHM && client ? LWDISTCOMM_ADDR_TYPE_SHM : LWDISTCOMM_ADDR_TYPE_UNIX);
+    if (addr && !lwdistcomm_address_set_unix_path(addr, BENCH_SOCKET_PATH)) {
+        lwdistcomm_address_destroy(addr);
+        return NULL;
+    }
+    return addr;
+}
+
+/**
+ * 服务器事件线程
+ */
+static void *server_thread(void *arg)
+{
+    lwdistcomm_server_t *server = (lwdistcomm_server_t *)arg;
+    while (server_running) {
+        lwdistcomm_server_process_events(server);
+    }
+    return NULL;
+}
+
+/**
+ * 创建并启动服务器和事件线程
+ */
+static lwdistcomm_server_t *server_start(int transport, int reactors, pthread_t *tid)
+{
+    lwdistcomm_address_t *addr = bench_address(transport, false);
+    lwdistcomm_server_t *server = lwdistcomm_server_create(NULL);
+
+    unlink(BENCH_SOCKET_PATH);
+    if (!addr || !server) {
+        lwdistcomm_address_destroy(addr);
+        lwdistcomm_server_destroy(server);
+        return NULL;
+    }
+
+    /* 有流量控制窗口时队列不会接近高水位，放宽水位只为避免突发被丢弃 */
+    lwdistcomm_server_set_watermarks(server, 64 * 1024 * 1024, 32 * 1024 * 1024);
+    lwdistcomm_server_set_shm(server, transport == BENCH_TRANSPORT_SHM, 0);
+    if (reactors > 1) {
+        lwdistcomm_server_set_reactors(server, reactors);
+    }
+
+    if (!lwdistcomm_server_start(server, addr)) {
+        lwdistcomm_address_destroy(addr);
+        lwdistcomm_server_destroy(server);
+        return NULL;
+    }
+    lwdistcomm_address_destroy(addr);
+
+    server_running = true;
+    pthread_create(tid, NULL, server_thread, server);
+    return server;
+}
+
+/**
+ * 停止事件线程并销毁服务器
+ */
+static void server_finish(lwdistcomm_server_t *server, pthread_t tid)
+{
+    server_running = false;
+    pthread_join(tid, NULL);
+    lwdistcomm_server_destroy(server);
+    unlink(BENCH_SOCKET_PATH);
+}
+
+/**
+ * 订阅消息回调，负载前8字节为发布时刻，0表示预热消息
+ */
+static void sub_callback(void *arg, const char *url, const lwdistcomm_message_t *msg)
+{
+    bench_sub_ctx_t *ctx = (bench_sub_ctx_t *)arg;
+    uint64_t stamp;
+
+    (void)url;
+
+    if (!msg || msg->data_len < sizeof(stamp)) {
+        return;
+    }
+
+    memcpy(&stamp, msg->data, sizeof(stamp));
+    if (!stamp) {
+        __atomic_store_n(&ctx->shared->warm[ctx->index], 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    hist_add(ctx->hist, now_ns() - stamp);
+    __atomic_store_n(&ctx->shared->received[ctx->index], ctx->shared->received[ctx->index] + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * 等待发布进程推进到指定阶段，返回false表示用例已结束
+ */
+static bool sub_wait_phase(bench_shared_t *shared, int phase)
+{
+    int current;
+
+    while ((current = __atomic_load_n(&shared->phase, __ATOMIC_ACQUIRE)) < phase) {
+        usleep(1000);
+    }
+    return current == phase;
+}
+
+/**
+ * 订阅进程：连接count个客户端，以一次select处理全部客户端，直到发布进程结束用例
+ */
+static void sub_process(bench_shared_t *shared, int child, int first, int count, int transport)
+{
+    lwdistcomm_client_t **clients = calloc(count, sizeof(*clients));
+    bench_sub_ctx_t *ctxs = calloc(count, sizeof(*ctxs));
+    fd_set all;
+    int max_fd = -1;
+    int connected = 0;
+
+    if (!clients || !ctxs || !sub_wait_phase(shared, BENCH_PHASE_CONNECT)) {
+        _exit(1);
+    }
+
+    lwdistcomm_address_t *addr = bench_address(transport, true);
+    FD_ZERO(&all);
+    for (int i = 0; i < count; i++) {
+        fd_set rfds;
+
+        ctxs[i].shared = shared;
+        ctxs[i].hist = &shared->hist[child];
+        ctxs[i].index = first + i;
+        clients[i] = lwdistcomm_client_create(NULL);
+        if (!clients[i] || !lwdistcomm_client_connect(clients[i], addr) ||
+            !lwdistcomm_client_subscribe(clients[i], BENCH_TOPIC, sub_callback, &ctxs[i])) {
+            __atomic_add_fetch(&shared->failed, 1, __ATOMIC_RELEASE);
+            break;
+        }
+
+        /* 连接期间描述符不变，预先合并全部客户端的读集合 */
+        int fd = lwdistcomm_client_get_fds(clients[i], &rfds);
+        for (int j = 0; j <= fd; j++) {
+            if (FD_ISSET(j, &rfds)) {
+                FD_SET(j, &all);
+            }
+        }
+        if (max_fd < fd) {
+            max_fd = fd;
+        }
+        connected++;
+        __atomic_add_fetch(&shared->connected, 1, __ATOMIC_RELEASE);
+    }
+    lwdistcomm_address_destroy(addr);
+
+    uint64_t cpu_start = 0;
+    bool running = false;
+    int phase;
+    while ((phase = __atomic_load_n(&shared->phase, __ATOMIC_ACQUIRE)) != BENCH_PHASE_DONE) {
+        if (phase == BENCH_PHASE_RUN && !running) {
+            cpu_start = cpu_ns();
+            running = true;
+        }
+
+        fd_set rfds = all;
+        struct timeval timeout = {0, 10000};
+        if (max_fd < 0 || select(max_fd + 1, &rfds, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+        for (int i = 0; i < connected; i++) {
+            lwdistcomm_client_process_input(clients[i], &rfds);
+        }
+    }
+    shared->cpu_ns[child] = running ? cpu_ns() - cpu_start : 0;
+
+    for (int i = 0; i < count; i++) {
+        lwdistcomm_client_destroy(clients[i]);
+    }
+    free(clients);
+    free(ctxs);
+    _exit(0);
+}
+
+/**
+ * 订阅者已收到消息数的最小值
+ */
+static uint64_t min_received(bench_shared_t *shared, int subs)
+{
+    uint64_t min = UINT64_MAX;
+
+    for (int i = 0; i < subs; i++) {
+        uint64_t received = __atomic_load_n(&shared->received[i], __ATOMIC_ACQUIRE);
+        if (received < min) {
+            min = received;
+        }
+    }
+    return min;
+}
+
+/**
+ * 发布带时间戳的消息，stamp为0时发送预热消息
+ */
+static bool publish_stamped(lwdistcomm_server_t *server, uint8_t *buffer, size_t payload, uint64_t stamp)
+{
+    lwdistcomm_message_t msg = { buffer, payload };
+
+    memcpy(buffer, &stamp, sizeof(stamp));
+    return lwdistcomm_server_publish(server, BENCH_TOPIC, &msg);
+}
+
+/**
+ * 发布订阅扇出：订阅者分布在多个子进程中，发布进程最多领先最慢的订阅者window条消息
+ */
+static bool bench_pubsub(const bench_options_t *options, int transport, int subs, size_t payload)
+{
+    const char *name = bench_transport_names[transport];
+    int children = (subs + BENCH_SUBS_PER_CHILD - 1) / BENCH_SUBS_PER_CHILD;
+    uint64_t count = options->budget / (uint64_t)subs;
+    uint64_t cap = BENCH_MAX_BYTES / ((uint64_t)subs * payload);
+    uint64_t window = BENCH_WINDOW_BYTES / payload;
+    pid_t pids[BENCH_MAX_CHILDREN];
+    bool ok = false;
+
+    if (transport == BENCH_TRANSPORT_SHM && subs > BENCH_SHM_SLOTS) {
+        report_skip("pubsub", name, subs, payload, "more subscribers than shared memory ring slots");
+        return true;
+    }
+
+    count = count < cap ? count : cap;
+    count = count > BENCH_MIN_COUNT ? count : BENCH_MIN_COUNT;
+    window = window < BENCH_MAX_WINDOW ? window : BENCH_MAX_WINDOW;
+    window = window > 4 ? window : 4;
+
+    bench_shared_t *shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        return false;
+    }
+    memset(shared, 0, sizeof(*shared));
+
+    /* 先于服务器创建子进程，子进程不继承服务器的描述符和线程 */
+    for (int i = 0; i < children; i++) {
+        int first = i * BENCH_SUBS_PER_CHILD;
+        int n = subs - first < BENCH_SUBS_PER_CHILD ? subs - first : BENCH_SUBS_PER_CHILD;
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            sub_process(shared, i, first, n, transport);
+        }
+    }
+
+    pthread_t tid;
+    lwdistcomm_server_t *server = server_start(transport, options->reactors, &tid);
+    uint8_t *buffer = calloc(1, payload);
+    if (!server || !buffer) {
+        goto out;
+    }
+
+    __atomic_store_n(&shared->phase, BENCH_PHASE_CONNECT, __ATOMIC_RELEASE);
+    uint64_t deadline = now_ns() + BENCH_TIMEOUT_NS * 3;
+    while (__atomic_load_n(&shared->connected, __ATOMIC_ACQUIRE) + __atomic_load_n(&shared->failed, __ATOMIC_ACQUIRE) < subs &&
+           now_ns() < deadline) {
+        usleep(1000);
+    }
+    if (shared->connected != subs) {
+        report_skip("pubsub", name, subs, payload, "subscribers failed to connect");
+        goto out;
+    }
+
+    /* 订阅在服务器处理订阅帧后才生效，预热直到每个订阅者都收到消息 */
+    int warm = 0;
+    deadline = now_ns() + BENCH_TIMEOUT_NS;
+    while (warm < subs && now_ns() < deadline) {
+        publish_stamped(server, buffer, payload, 0);
+        usleep(1000);
+        for (warm = 0; warm < subs && __atomic_load_n(&shared->warm[warm], __ATOMIC_ACQUIRE); warm++) {
+        }
+    }
+    if (warm < subs) {
+        report_skip("pubsub", name, subs, payload, "subscriptions not established");
+        goto out;
+    }
+
+    __atomic_store_n(&shared->phase, BENCH_PHASE_RUN, __ATOMIC_RELEASE);
+    usleep(20000);
+
+    uint64_t cpu_start = cpu_ns();
+    uint64_t start = now_ns();
+    uint64_t acked = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        while (i >= acked + window) {
+            acked = min_received(shared, subs);
+            if (i >= acked + window) {
+                sched_yield();
+            }
+        }
+        publish_stamped(server, buffer, payload, now_ns());
+    }
+
+    deadline = now_ns() + BENCH_TIMEOUT_NS;
+    while (min_received(shared, subs) < count && now_ns() < deadline) {
+        sched_yield();
+    }
+    uint64_t elapsed = now_ns() - start;
+    uint64_t cpu = cpu_ns() - cpu_start;
+
+    __atomic_store_n(&shared->phase, BENCH_PHASE_DONE, __ATOMIC_RELEASE);
+    for (int i = 0; i < children; i++) {
+        waitpid(pids[i], NULL, 0);
+        cpu += shared->cpu_ns[i];
+        pids[i] = -1;
+    }
+
+    bench_hist_t *hist = calloc(1, sizeof(*hist));
+    uint64_t delivered = 0;
+    for (int i = 0; i < subs; i++) {
+        delivered += shared->received[i];
+    }
+    for (int i = 0; hist && i < children; i++) {
+        hist_merge(hist, &shared->hist[i]);
+    }
+
+    bench_result_t result = {
+        "pubsub", name, subs, payload, delivered, count * (uint64_t)subs - delivered, elapsed, cpu, hist
+    };
+    if (hist) {
+        report(&result);
+        free(hist);
+        ok = true;
+    }
+
+out:
+    __atomic_store_n(&shared->phase, BENCH_PHASE_DONE, __ATOMIC_RELEASE);
+    for (int i = 0; i < children; i++) {
+        if (pids[i] > 0) {
+            waitpid(pids[i], NULL, 0);
+        }
+    }
+    if (server) {
+        server_finish(server, tid);
+    }
+    free(buffer);
+    munmap(shared, sizeof(*shared));
+    return ok;
+}
+
+/**
+ * 回显处理函数，应答在处理函数返回后立即发送，可直接引用请求负载
+ */
+static void echo_handler(void *arg, uint32_t client_id, const char *url, const lwdistcomm_message_t *msg, lwdistcomm_message_t *response)
+{
+    (void)arg;
+    (void)client_id;
+    (void)url;
+
+    response->data = msg->data;
+    response->data_len = msg->data_len;
+}
+
+/**
+ * RPC应答统计
+ */
+typedef struct {
+    bench_hist_t *hist;
+    uint64_t replied;
+    uint64_t errors;
+} bench_rpc_stat_t;
+
+/**
+ * RPC应答回调，负载前8字节为请求发出时刻
+ */
+static void rpc_callback(void *arg, int status, const lwdistcomm_message_t *msg)
+{
+    bench_rpc_stat_t *stat = (bench_rpc_stat_t *)arg;
+    uint64_t stamp;
+
+    if (status != LWDISTCOMM_STATUS_SUCCESS || !msg || msg->data_len < sizeof(stamp)) {
+        stat->errors++;
+        return;
+    }
+
+    memcpy(&stamp, msg->data, sizeof(stamp));
+    hist_add(stat->hist, now_ns() - stamp);
+    stat->replied++;
+}
+
+/**
+ * RPC往返：depth为1时逐个请求测量往返时延，否则以批量RPC保持depth个请求在途
+ */
+static bool bench_rpc(const bench_options_t *options, int transport, size_t payload, int depth)
+{
+    const char *scenario = depth > 1 ? "rpc-batch" : "rpc";
+    const char *name = bench_transport_names[transport];
+    uint64_t count = options->budget;
+    uint64_t cap = BENCH_MAX_BYTES / payload;
+    bool ok = false;
+
+    count = count < cap ? count : cap;
+    count = count > BENCH_MIN_COUNT ? count : BENCH_MIN_COUNT;
+
+    pthread_t tid;
+    lwdistcomm_server_t *server = server_start(transport, 1, &tid);
+    if (!server) {
+        report_skip(scenario, name, 1, payload, "server failed to start");
+        return false;
+    }
+    lwdistcomm_server_add_handler(server, BENCH_RPC_URL, echo_handler, NULL);
+
+    lwdistcomm_address_t *addr = bench_address(transport, true);
+    lwdistcomm_client_t *client = lwdistcomm_client_create(NULL);
+    uint8_t *buffers = calloc(depth, payload);
+    bench_rpc_stat_t stat = { calloc(1, sizeof(bench_hist_t)), 0, 0 };
+    if (!addr || !client || !buffers || !stat.hist || !lwdistcomm_client_connect(client, addr)) {
+        report_skip(scenario, name, 1, payload, "client failed to connect");
+        goto out;
+    }
+
+    lwdistcomm_message_t msgs[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    lwdistcomm_client_rpc_req_t reqs[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    for (int i = 0; i < depth; i++) {
+        msgs[i].data = buffers + (size_t)i * payload;
+        msgs[i].data_len = payload;
+        reqs[i].url = BENCH_RPC_URL;
+        reqs[i].msg = &msgs[i];
+        reqs[i].callback = rpc_callback;
+        reqs[i].arg = &stat;
+    }
+
+    uint64_t cpu_start = cpu_ns();
+    uint64_t start = now_ns();
+    uint64_t sent = 0;
+    uint64_t deadline = start + BENCH_TIMEOUT_NS * 3;
+    while (sent < count && now_ns() < deadline) {
+        int n = count - sent < (uint64_t)depth ? (int)(count - sent) : depth;
+        uint64_t stamp = now_ns();
+        for (int i = 0; i < n; i++) {
+            memcpy(msgs[i].data, &stamp, sizeof(stamp));
+        }
+        if (!(n == 1 ? lwdistcomm_client_rpc(client, BENCH_RPC_URL, &msgs[0], rpc_callback, &stat) :
+                       lwdistcomm_client_rpc_batch(client, reqs, n))) {
+            break;
+        }
+        sent += n;
+        while (stat.replied + stat.errors < sent && lwdistcomm_client_is_connected(client) && now_ns() < deadline) {
+            lwdistcomm_client_process_events(client);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    uint64_t cpu = cpu_ns() - cpu_start;
+
+    bench_result_t result = {
+        scenario, name, 1, payload, stat.replied, count - stat.replied, elapsed, cpu, stat.hist
+    };
+    report(&result);
+    ok = stat.replied == count;
+
+out:
+    lwdistcomm_client_destroy(client);
+    lwdistcomm_address_destroy(addr);
+    server_finish(server, tid);
+    free(buffers);
+    free(stat.hist);
+    return ok;
+}
+
+/**
+ * DDS接收统计，由DataReader接收线程更新
+ */
+typedef struct {
+    bench_hist_t *hist;
+    uint64_t received;
+} bench_dds_stat_t;
+
+/**
+ * 数据可用回调，借出全部样本并记录写入到取出的时延
+ */
+static void dds_callback(lwdistcomm_dds_data_reader_t *reader, void *arg)
+{
+    bench_dds_stat_t *stat = (bench_dds_stat_t *)arg;
+    const void *sample;
+    uint32_t size;
+    lwdistcomm_dds_sample_info_t info;
+    uint64_t stamp;
+
+    while (lwdistcomm_dds_data_reader_take_loan(reader, &sample, &size, &info) == LWDISTCOMM_DDS_RETCODE_OK) {
+        if (info.valid_data && size >= sizeof(stamp)) {
+            memcpy(&stamp, sample, sizeof(stamp));
+            hist_add(stat->hist, now_ns() - stamp);
+            __atomic_add_fetch(&stat->received, 1, __ATOMIC_RELEASE);
+        }
+        lwdistcomm_dds_data_reader_return_loan(reader, sample);
+    }
+}
+
+/**
+ * DDS UDP DataWriter到DataReader：可靠传输，写入端最多领先BENCH_DDS_WINDOW个样本
+ */
+static bool bench_dds(const bench_options_t *options, size_t payload)
+{
+    uint64_t count = options->budget;
+    uint64_t cap = BENCH_MAX_BYTES / payload;
+    bool ok = false;
+
+    count = count < cap ? count : cap;
+    count = count > BENCH_MIN_COUNT ? count : BENCH_MIN_COUNT;
+
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    lwdistcomm_dds_qos_set_reliability(&qos, LWDISTCOMM_DDS_RELIABILITY_RELIABLE, NULL);
+    lwdistcomm_dds_qos_set_history(&qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, BENCH_DDS_DEPTH);
+    lwdistcomm_dds_qos_set_resource_limits(&qos, BENCH_DDS_DEPTH, 1, BENCH_DDS_DEPTH);
+
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = { .name = "BenchTopic", .type_name = "bench_sample_t", .qos = qos };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = participant ? lwdistcomm_dds_topic_create(participant, &topic_options) : NULL;
+    lwdistcomm_dds_publisher_t *publisher = topic ? lwdistcomm_dds_publisher_create(participant, &publisher_options) : NULL;
+    lwdistcomm_dds_subscriber_t *subscriber = publisher ? lwdistcomm_dds_subscriber_create(participant, &subscriber_options) : NULL;
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = qos };
+    lwdistcomm_dds_data_reader_options_t dr_options = { .topic = topic, .qos = qos };
+    lwdistcomm_dds_data_reader_t *reader = subscriber ? lwdistcomm_dds_data_reader_create(subscriber, &dr_options) : NULL;
+    lwdistcomm_dds_data_writer_t *writer = reader ? lwdistcomm_dds_data_writer_create(publisher, &dw_options) : NULL;
+    bench_dds_stat_t stat = { calloc(1, sizeof(bench_hist_t)), 0 };
+    uint8_t *buffer = calloc(1, payload);
+
+    if (!writer || !stat.hist || !buffer) {
+        report_skip("dds", "udp", 1, payload, "failed to create DDS entities");
+        goto out;
+    }
+    lwdistcomm_dds_data_reader_set_data_available_callback(reader, dds_callback, &stat);
+
+    uint64_t cpu_start = cpu_ns();
+    uint64_t start = now_ns();
+    uint64_t deadline = start + BENCH_TIMEOUT_NS * 3;
+    uint64_t written = 0;
+    while (written < count && now_ns() < deadline) {
+        if (written >= __atomic_load_n(&stat.received, __ATOMIC_ACQUIRE) + BENCH_DDS_WINDOW) {
+            sched_yield();
+            continue;
+        }
+        uint64_t stamp = now_ns();
+        memcpy(buffer, &stamp, sizeof(stamp));
+        if (lwdistcomm_dds_data_writer_write(writer, buffer, (uint32_t)payload) == LWDISTCOMM_DDS_RETCODE_OK) {
+            written++;
+        }
+    }
+
+    deadline = now_ns() + BENCH_TIMEOUT_NS;
+    while (__atomic_load_n(&stat.received, __ATOMIC_ACQUIRE) < written && now_ns() < deadline) {
+        usleep(100);
+    }
+    uint64_t elapsed = now_ns() - start;
+    uint64_t cpu = cpu_ns() - cpu_start;
+
+    /* 停止接收线程后再读取直方图 */
+    lwdistcomm_dds_data_reader_delete(reader);
+    reader = NULL;
+
+    bench_result_t result = {
+        "dds", "udp", 1, payload, stat.received, count - stat.received, elapsed, cpu, stat.hist
+    };
+    report(&result);
+    ok = stat.received == count;
+
+out:
+    if (reader) {
+        lwdistcomm_dds_data_reader_delete(reader);
+    }
+    if (writer) {
+        lwdistcomm_dds_data_writer_delete(writer);
+    }
+    if (subscriber) {
+        lwdistcomm_dds_subscriber_delete(subscriber);
+    }
+    if (publisher) {
+        lwdistcomm_dds_publisher_delete(publisher);
+    }
+    if (topic) {
+        lwdistcomm_dds_topic_delete(topic);
+    }
+    if (participant) {
+        lwdistcomm_dds_domain_participant_delete(participant);
+    }
+    free(buffer);
+    free(stat.hist);
+    return ok;
+}
+
+/**
+ * 打印用法
+ */
+static void usage(const char *prog)
+{
+    printf("Usage: %s [options]\n", prog);
+    printf("  -s pubsub|rpc|dds   Run only one scenario (default all)\n");
+    printf("  -t unix|tcp|shm     Run only one transport (default all)\n");
+    printf("  -n subscribers      Fan-out subscriber count (default 1, 10, 100, 1000)\n");
+    printf("  -p bytes            Payload size, 64 to 65536 (default 64, 1024, 16384, 65536)\n");
+    printf("  -c deliveries       Message deliveries per case (default %d)\n", BENCH_DEF_BUDGET);
+    printf("  -r reactors         Server reactors for fan-out (default 1)\n");
+}
+
+/**
+ * 解析命令行选项
+ */
+static bool parse_options(int argc, char *argv[], bench_options_t *options)
+{
+    int opt;
+
+    memset(options, 0, sizeof(*options));
+    options->pubsub = options->rpc = options->dds = true;
+    options->transport = -1;
+    options->budget = BENCH_DEF_BUDGET;
+    options->reactors = 1;
+
+    while ((opt = getopt(argc, argv, "s:t:n:p:c:r:h")) != -1) {
+        switch (opt) {
+        case 's':
+            options->pubsub = strcmp(optarg, "pubsub") == 0;
+            options->rpc = strcmp(optarg, "rpc") == 0;
+            options->dds = strcmp(optarg, "dds") == 0;
+            if (!options->pubsub && !options->rpc && !options->dds) {
+                return false;
+            }
+            break;
+        case 't':
+            for (options->transport = 0; options->transport < BENCH_TRANSPORT_COUNT; options->transport++) {
+                if (strcmp(optarg, bench_transport_names[options->transport]) == 0) {
+                    break;
+                }
+            }
+            if (options->transport == BENCH_TRANSPORT_COUNT) {
+                return false;
+            }
+            break;
+        case 'n':
+            options->subs = atoi(optarg);
+            if (options->subs < 1 || options->subs > BENCH_MAX_SUBS) {
+                return false;
+            }
+            break;
+        case 'p':
+            options->payload = (size_t)strtoul(optarg, NULL, 0);
+            if (options->payload < 64 || options->payload > 65536) {
+                return false;
+            }
+            break;
+        case 'c':
+            options->budget = strtoull(optarg, NULL, 0);
+            if (!options->budget) {
+                return false;
+            }
+            break;
+        case 'r':
+            options->reactors = atoi(optarg);
+            if (options->reactors < 1 || options->reactors > LWDISTCOMM_SERVER_MAX_REACTORS) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * 主函数
+ */
+int main(int argc, char *argv[])
+{
+    bench_options_t options;
+    bool ok = true;
+
+    if (!parse_options(argc, argv, &options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    /* 千路扇出时服务器端需要千余个描述符 */
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("LwDistComm Benchmark\n");
+    printf("====================\n");
+    report_header();
+
+    for (size_t p = 0; p < BENCH_ARRAY_SIZE(bench_payloads); p++) {
+        size_t payload = options.payload ? options.payload : bench_payloads[p];
+
+        for (int t = 0; options.pubsub && t < BENCH_TRANSPORT_COUNT; t++) {
+            if (options.transport >= 0 && options.transport != t) {
+                continue;
+            }
+            for (size_t s = 0; s < BENCH_ARRAY_SIZE(bench_subs); s++) {
+                ok = bench_pubsub(&options, t, options.subs ? options.subs : bench_subs[s], payload) && ok;
+                if (options.subs) {
+                    break;
+                }
+            }
+        }
+
+        /* RPC不经共享内存环，只测套接字传输 */
+        for (int t = 0; options.rpc && t < BENCH_TRANSPORT_SHM; t++) {
+            if (options.transport >= 0 && options.transport != t) {
+                continue;
+            }
+            ok = bench_rpc(&options, t, payload, 1) && ok;
+            ok = bench_rpc(&options, t, payload, LWDISTCOMM_CLIENT_RPC_BATCH_MAX) && ok;
+        }
+
+        if (options.dds && options.transport < 0) {
+            ok = bench_dds(&options, payload) && ok;
+        }
+
+        if (options.payload) {
+            break;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
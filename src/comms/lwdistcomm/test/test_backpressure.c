@@ -0,0 +1,259 @@
+#include "../include/server.h"
+#include "../include/address.h"
+#include "../include/message.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define TEST_SOCKET_PATH    "/tmp/test_backpressure.sock"
+#define TEST_HIGH_WATERMARK (64 * 1024)
+#define TEST_LOW_WATERMARK  (16 * 1024)
+#define TEST_PAYLOAD_SIZE   1024
+#define TEST_PUBLISH_COUNT  2000
+
+/**
+ * 连接回调记录的客户端ID
+ */
+static uint32_t connected_id = 0;
+static bool connected = false;
+
+/**
+ * 客户端连接回调
+ */
+static void client_callback(void *arg, uint32_t client_id, bool is_connected)
+{
+    (void)arg;
+    if (is_connected) {
+        connected_id = client_id;
+        connected = true;
+    } else {
+        connected = false;
+    }
+}
+
+/**
+ * 获取当前时间（毫秒）
+ */
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/**
+ * 原始套接字发送一个请求帧
+ */
+static bool raw_send_request(int sock, uint8_t type, const char *url)
+{
+    uint8_t buffer[256];
+    size_t len;
+
+    lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(buffer, type, 0, 1);
+    if (url && !lwdistcomm_msg_set_url(header, url)) {
+        return false;
+    }
+    if (!lwdistcomm_msg_validate_header(header, &len)) {
+        return false;
+    }
+
+    return send(sock, buffer, len, MSG_NOSIGNAL) == (ssize_t)len;
+}
+
+/**
+ * 创建一个不读取数据的慢速订阅者
+ */
+static int create_slow_subscriber(lwdistcomm_server_t *server, const char *url)
+{
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+
+    int rcvbuf = 4096;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, TEST_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(sock);
+        return -1;
+    }
+
+    for (int i = 0; i < 10 && lwdistcomm_server_get_client_count(server) == 0; i++) {
+        lwdistcomm_server_process_events(server);
+    }
+
+    if (!raw_send_request(sock, LWDISTCOMM_MSG_TYPE_SERVINFO, NULL) ||
+        !raw_send_request(sock, LWDISTCOMM_MSG_TYPE_SUBSCRIBE, url)) {
+        close(sock);
+        return -1;
+    }
+
+    for (int i = 0; i < 10 && !connected; i++) {
+        lwdistcomm_server_process_events(server);
+    }
+
+    return connected ? sock : (close(sock), -1);
+}
+
+/**
+ * 测试慢速订阅者不会阻塞发布，并按DROP策略丢弃
+ */
+static bool test_drop_policy(lwdistcomm_server_t *server)
+{
+    printf("\n=== Testing DROP Policy ===\n");
+
+    int sock = create_slow_subscriber(server, "/test/");
+    if (sock < 0) {
+        printf("Failed to create slow subscriber\n");
+        return false;
+    }
+
+    char payload[TEST_PAYLOAD_SIZE];
+    memset(payload, 'x', sizeof(payload));
+    lwdistcomm_message_t msg = { payload, sizeof(payload) };
+
+    double start = now_ms();
+    for (int i = 0; i < TEST_PUBLISH_COUNT; i++) {
+        if (!lwdistcomm_server_publish(server, "/test/data", &msg)) {
+            printf("Publish failed at %d\n", i);
+            close(sock);
+            return false;
+        }
+    }
+    double elapsed = now_ms() - start;
+    printf("Published %d messages in %.2f ms\n", TEST_PUBLISH_COUNT, elapsed);
+
+    lwdistcomm_server_cli_stats_t stats;
+    if (!lwdistcomm_server_get_client_stats(server, connected_id, &stats)) {
+        printf("Failed to get client stats\n");
+        close(sock);
+        return false;
+    }
+    printf("queued=%u/%zu bytes sent=%llu dropped=%llu congested=%d\n",
+           stats.queued_msgs, stats.queued_bytes,
+           (unsigned long long)stats.sent_msgs, (unsigned long long)stats.dropped_msgs, stats.congested);
+
+    if (elapsed > 1000.0 || !stats.congested || stats.dropped_msgs == 0 ||
+        stats.queued_bytes > TEST_HIGH_WATERMARK + TEST_PAYLOAD_SIZE * 2) {
+        printf("DROP policy test FAILED\n");
+        close(sock);
+        return false;
+    }
+
+    // 订阅者开始读取，队列应被排空
+    char buffer[65536];
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+    for (int i = 0; i < 200 && (stats.queued_bytes > 0 || stats.congested); i++) {
+        while (recv(sock, buffer, sizeof(buffer), 0) > 0) {
+        }
+        lwdistcomm_server_process_events(server);
+        lwdistcomm_server_get_client_stats(server, connected_id, &stats);
+    }
+    printf("After drain: queued=%u/%zu bytes congested=%d\n", stats.queued_msgs, stats.queued_bytes, stats.congested);
+
+    close(sock);
+    for (int i = 0; i < 10 && connected; i++) {
+        lwdistcomm_server_process_events(server);
+    }
+
+    if (stats.queued_bytes != 0 || stats.congested) {
+        printf("DROP policy test FAILED: queue not drained\n");
+        return false;
+    }
+
+    printf("DROP policy test PASSED\n");
+    return true;
+}
+
+/**
+ * 测试DISCONNECT策略会断开慢速订阅者
+ */
+static bool test_disconnect_policy(lwdistcomm_server_t *server)
+{
+    printf("\n=== Testing DISCONNECT Policy ===\n");
+
+    lwdistcomm_server_set_topic_policy(server, "/slow/", LWDISTCOMM_SERVER_POLICY_DISCONNECT);
+
+    int sock = create_slow_subscriber(server, "/slow/");
+    if (sock < 0) {
+        printf("Failed to create slow subscriber\n");
+        return false;
+    }
+
+    char payload[TEST_PAYLOAD_SIZE];
+    memset(payload, 'y', sizeof(payload));
+    lwdistcomm_message_t msg = { payload, sizeof(payload) };
+
+    for (int i = 0; i < TEST_PUBLISH_COUNT; i++) {
+        lwdistcomm_server_publish(server, "/slow/data", &msg);
+    }
+
+    for (int i = 0; i < 10 && connected; i++) {
+        lwdistcomm_server_process_events(server);
+    }
+
+    close(sock);
+
+    if (connected || lwdistcomm_server_get_client_count(server) != 0) {
+        printf("DISCONNECT policy test FAILED\n");
+        return false;
+    }
+
+    printf("DISCONNECT policy test PASSED\n");
+    return true;
+}
+
+/**
+ * 主函数
+ */
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Publish Backpressure Test\n");
+    printf("=========================\n");
+
+    lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_UNIX);
+    if (!addr || !lwdistcomm_address_set_unix_path(addr, TEST_SOCKET_PATH)) {
+        printf("Failed to create server address\n");
+        return 1;
+    }
+
+    lwdistcomm_server_t *server = lwdistcomm_server_create(NULL);
+    if (!server || !lwdistcomm_server_start(server, addr)) {
+        printf("Failed to start server\n");
+        lwdistcomm_address_destroy(addr);
+        return 1;
+    }
+
+    lwdistcomm_server_set_client_callback(server, client_callback, NULL);
+    lwdistcomm_server_set_watermarks(server, TEST_HIGH_WATERMARK, TEST_LOW_WATERMARK);
+
+    bool drop_passed = test_drop_policy(server);
+    bool disconnect_passed = test_disconnect_policy(server);
+
+    lwdistcomm_server_destroy(server);
+    lwdistcomm_address_destroy(addr);
+
+    printf("\n=== Test Summary ===\n");
+    printf("DROP policy test: %s\n", drop_passed ? "PASSED" : "FAILED");
+    printf("DISCONNECT policy test: %s\n", disconnect_passed ? "PASSED" : "FAILED");
+
+    if (drop_passed && disconnect_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return 1;
+    }
+}
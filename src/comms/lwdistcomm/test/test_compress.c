@@ -0,0 +1,427 @@
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/address.h"
+#include "../include/message.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+
+#define TEST_PORT           18740
+#define TEST_PAYLOAD_SIZE   65536
+#define TEST_SMALL_SIZE     512
+#define TEST_PUBLISH_COUNT  20
+
+/**
+ * 服务器事件线程控制
+ */
+static volatile bool server_running = true;
+
+/**
+ * 连接回调记录的客户端ID
+ */
+static uint32_t connected_id = 0;
+
+/**
+ * 订阅者接收统计
+ */
+typedef struct {
+    int received;
+    int errors;
+    const uint8_t *expect;
+    size_t expect_len;
+} test_sub_stat_t;
+
+/**
+ * RPC应答统计
+ */
+typedef struct {
+    int replies;
+    int errors;
+} test_rpc_stat_t;
+
+/**
+ * 服务器事件线程
+ */
+static void *server_thread(void *arg)
+{
+    lwdistcomm_server_t *server = (lwdistcomm_server_t *)arg;
+    while (server_running) {
+        lwdistcomm_server_process_events(server);
+    }
+    return NULL;
+}
+
+/**
+ * 客户端连接回调
+ */
+static void client_callback(void *arg, uint32_t client_id, bool is_connected)
+{
+    (void)arg;
+    if (is_connected) {
+        __atomic_store_n(&connected_id, client_id, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * 填充可压缩负载（类似JSON快照的重复文本）
+ */
+static void fill_text(uint8_t *buffer, size_t len)
+{
+    size_t off = 0;
+    int tag = 0;
+
+    while (off < len) {
+        char line[64];
+        int n = snprintf(line, sizeof(line), "{\"tag\":\"dev1.tag%d\",\"value\":%d,\"quality\":192},", tag, tag * 7 % 100);
+        size_t copy = (size_t)n < len - off ? (size_t)n : len - off;
+        memcpy(buffer + off, line, copy);
+        off += copy;
+        tag++;
+    }
+}
+
+/**
+ * 填充不可压缩负载
+ */
+static void fill_random(uint8_t *buffer, size_t len)
+{
+    uint32_t seed = 0x12345678;
+
+    for (size_t i = 0; i < len; i++) {
+        seed = seed * 1103515245 + 12345;
+        buffer[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/**
+ * 帧输入回调，校验解压后的负载
+ */
+static bool test_input(void *arg, lwdistcomm_msg_header_t *header)
+{
+    test_sub_stat_t *stat = (test_sub_stat_t *)arg;
+    lwdistcomm_message_t msg;
+
+    if (header->status != 0 || !lwdistcomm_msg_get_payload(header, &msg) ||
+        msg.data_len != stat->expect_len || memcmp(msg.data, stat->expect, msg.data_len) != 0) {
+        stat->errors++;
+    }
+    stat->received++;
+    return true;
+}
+
+/**
+ * 订阅消息回调，校验负载内容
+ */
+static void message_callback(void *arg, const char *url, const lwdistcomm_message_t *msg)
+{
+    test_sub_stat_t *stat = (test_sub_stat_t *)arg;
+
+    (void)url;
+    if (msg->data_len != stat->expect_len || memcmp(msg->data, stat->expect, msg->data_len) != 0) {
+        stat->errors++;
+    }
+    stat->received++;
+}
+
+/**
+ * 回显处理函数
+ */
+static void echo_handler(void *arg, uint32_t client_id, const char *url, const lwdistcomm_message_t *msg, lwdistcomm_message_t *response)
+{
+    static uint8_t buffer[TEST_PAYLOAD_SIZE];
+
+    (void)arg;
+    (void)client_id;
+    (void)url;
+
+    if (msg->data && msg->data_len <= sizeof(buffer)) {
+        memcpy(buffer, msg->data, msg->data_len);
+        response->data = buffer;
+        response->data_len = msg->data_len;
+    }
+}
+
+/**
+ * RPC应答回调
+ */
+static void rpc_callback(void *arg, int status, const lwdistcomm_message_t *msg)
+{
+    test_rpc_stat_t *stat = (test_rpc_stat_t *)arg;
+    static uint8_t expect[TEST_PAYLOAD_SIZE];
+
+    fill_text(expect, sizeof(expect));
+    if (status != 0 || msg->data_len != sizeof(expect) || memcmp(msg->data, expect, sizeof(expect)) != 0) {
+        stat->errors++;
+    }
+    stat->replies++;
+}
+
+/**
+ * 测试压缩帧在接收端解压，损坏或超长的帧被拒绝
+ */
+static bool test_inflate(void)
+{
+    printf("\n=== Testing Frame Inflate ===\n");
+
+    static uint8_t payload[TEST_PAYLOAD_SIZE];
+    static uint8_t frame[TEST_PAYLOAD_SIZE + 256];
+    test_sub_stat_t stat = { 0, 0, payload, sizeof(payload) };
+    lwdistcomm_msg_recv_t recv;
+    size_t total;
+
+    fill_text(payload, sizeof(payload));
+    lwdistcomm_message_t msg = { payload, sizeof(payload) };
+    lwdistcomm_pbuf_t *pbuf = lwdistcomm_msg_compress(&msg);
+    if (!pbuf) {
+        printf("Compress FAILED\n");
+        return false;
+    }
+
+    lwdistcomm_message_t zmsg = { pbuf->payload, pbuf->length };
+    lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(frame, LWDISTCOMM_MSG_TYPE_PUBLISH, LWDISTCOMM_MSG_FLAG_LZ4, 1);
+    lwdistcomm_msg_set_url(header, "/lz4/data");
+    lwdistcomm_msg_set_payload(header, &zmsg);
+    lwdistcomm_msg_validate_header(header, &total);
+    printf("payload=%zu compressed=%zu\n", sizeof(payload), pbuf->length);
+    lwdistcomm_pbuf_free(pbuf);
+
+    // 整帧和逐字节输入
+    lwdistcomm_msg_init_recv(&recv);
+    bool whole = lwdistcomm_msg_input(&recv, frame, total, test_input, &stat);
+    for (size_t i = 0; i < total; i++) {
+        lwdistcomm_msg_input(&recv, frame + i, 1, test_input, &stat);
+    }
+    lwdistcomm_msg_free_recv(&recv);
+
+    // 解压后超过接收上限
+    lwdistcomm_msg_init_recv(&recv);
+    lwdistcomm_msg_set_recv_max(&recv, total + 64);
+    bool limited = lwdistcomm_msg_input(&recv, frame, total, test_input, &stat);
+    lwdistcomm_msg_free_recv(&recv);
+
+    // 原始长度与压缩数据不符
+    frame[sizeof(lwdistcomm_msg_header_t) + strlen("/lz4/data") + 3] ^= 0x01;
+    lwdistcomm_msg_init_recv(&recv);
+    bool corrupt = lwdistcomm_msg_input(&recv, frame, total, test_input, &stat);
+    lwdistcomm_msg_free_recv(&recv);
+
+    // 不可压缩的负载不生成压缩帧
+    fill_random(payload, sizeof(payload));
+    pbuf = lwdistcomm_msg_compress(&msg);
+    lwdistcomm_pbuf_free(pbuf);
+
+    printf("whole=%d received=%d errors=%d limited=%d corrupt=%d random=%d\n",
+           whole, stat.received, stat.errors, limited, corrupt, pbuf != NULL);
+    if (!whole || stat.received != 2 || stat.errors || limited || corrupt || pbuf) {
+        printf("Frame inflate test FAILED\n");
+        return false;
+    }
+
+    printf("Frame inflate test PASSED\n");
+    return true;
+}
+
+/**
+ * 创建并连接客户端，等待服务器报告新连接
+ */
+static lwdistcomm_client_t *connect_client(lwdistcomm_address_t *addr, bool compress)
+{
+    lwdistcomm_client_t *client = lwdistcomm_client_create(NULL);
+    if (!client) {
+        return NULL;
+    }
+
+    __atomic_store_n(&connected_id, 0, __ATOMIC_RELEASE);
+    lwdistcomm_client_set_compression(client, compress, 0);
+    if (!lwdistcomm_client_connect(client, addr)) {
+        lwdistcomm_client_destroy(client);
+        return NULL;
+    }
+
+    for (int i = 0; i < 1000 && __atomic_load_n(&connected_id, __ATOMIC_ACQUIRE) == 0; i++) {
+        usleep(1000);
+    }
+
+    return client;
+}
+
+/**
+ * 发布一批消息并等待订阅者收齐，返回服务器统计的发送字节数
+ */
+static uint64_t publish_batch(lwdistcomm_server_t *server, lwdistcomm_client_t *client, test_sub_stat_t *stat, const lwdistcomm_message_t *msg)
+{
+    lwdistcomm_server_cli_stats_t before, after;
+    int target = stat->received + TEST_PUBLISH_COUNT;
+
+    lwdistcomm_server_get_client_stats(server, connected_id, &before);
+    stat->expect = msg->data;
+    stat->expect_len = msg->data_len;
+    for (int i = 0; i < TEST_PUBLISH_COUNT; i++) {
+        lwdistcomm_server_publish(server, "/lz4/data", msg);
+        for (int j = 0; j < 100 && stat->received < target - TEST_PUBLISH_COUNT + i + 1; j++) {
+            lwdistcomm_client_process_events(client);
+        }
+    }
+    lwdistcomm_server_get_client_stats(server, connected_id, &after);
+
+    return after.sent_bytes - before.sent_bytes;
+}
+
+/**
+ * 测试发布压缩：大负载压缩发送，小负载和不可压缩负载原样发送
+ */
+static bool test_publish(lwdistcomm_server_t *server, lwdistcomm_address_t *addr)
+{
+    printf("\n=== Testing Compressed Publish ===\n");
+
+    static uint8_t payload[TEST_PAYLOAD_SIZE];
+    static uint8_t noise[TEST_PAYLOAD_SIZE];
+    test_sub_stat_t stat = { 0, 0, NULL, 0 };
+
+    lwdistcomm_client_t *client = connect_client(addr, false);
+    if (!client || !lwdistcomm_client_subscribe(client, "/lz4/", message_callback, &stat)) {
+        printf("Failed to connect client\n");
+        lwdistcomm_client_destroy(client);
+        return false;
+    }
+    for (int i = 0; i < 10; i++) {
+        lwdistcomm_client_process_events(client);
+    }
+
+    fill_text(payload, sizeof(payload));
+    fill_random(noise, sizeof(noise));
+    lwdistcomm_message_t text = { payload, sizeof(payload) };
+    lwdistcomm_message_t small = { payload, TEST_SMALL_SIZE };
+    lwdistcomm_message_t random = { noise, sizeof(noise) };
+
+    lwdistcomm_server_set_compression(server, false, 0);
+    uint64_t plain = publish_batch(server, client, &stat, &text);
+    lwdistcomm_server_set_compression(server, true, 0);
+    uint64_t packed = publish_batch(server, client, &stat, &text);
+    uint64_t below = publish_batch(server, client, &stat, &small);
+    uint64_t noisy = publish_batch(server, client, &stat, &random);
+
+    printf("received=%d errors=%d plain=%llu compressed=%llu small=%llu random=%llu\n",
+           stat.received, stat.errors, (unsigned long long)plain, (unsigned long long)packed,
+           (unsigned long long)below, (unsigned long long)noisy);
+
+    lwdistcomm_server_set_compression(server, false, 0);
+    lwdistcomm_client_destroy(client);
+
+    if (stat.received != TEST_PUBLISH_COUNT * 4 || stat.errors || packed * 4 > plain ||
+        below < (uint64_t)TEST_PUBLISH_COUNT * TEST_SMALL_SIZE || noisy < plain) {
+        printf("Compressed publish test FAILED\n");
+        return false;
+    }
+
+    printf("Compressed publish test PASSED\n");
+    return true;
+}
+
+/**
+ * 测试客户端压缩请求，服务器压缩应答
+ */
+static bool test_rpc(lwdistcomm_server_t *server, lwdistcomm_address_t *addr)
+{
+    printf("\n=== Testing Compressed RPC ===\n");
+
+    static uint8_t payload[TEST_PAYLOAD_SIZE];
+    test_rpc_stat_t stat = { 0, 0 };
+    lwdistcomm_server_cli_stats_t stats;
+
+    memset(&stats, 0, sizeof(stats));
+    lwdistcomm_client_t *client = connect_client(addr, true);
+    if (!client) {
+        printf("Failed to connect client\n");
+        lwdistcomm_client_destroy(client);
+        return false;
+    }
+    lwdistcomm_server_set_compression(server, true, 0);
+
+    fill_text(payload, sizeof(payload));
+    lwdistcomm_message_t msg = { payload, sizeof(payload) };
+    lwdistcomm_client_rpc_req_t reqs[2] = {
+        { "/lz4/echo", &msg, rpc_callback, &stat },
+        { "/lz4/echo", &msg, rpc_callback, &stat }
+    };
+
+    for (int i = 0; i < TEST_PUBLISH_COUNT; i++) {
+        if (!lwdistcomm_client_rpc(client, "/lz4/echo", &msg, rpc_callback, &stat)) {
+            break;
+        }
+    }
+    lwdistcomm_client_rpc_batch(client, reqs, 2);
+    for (int i = 0; i < 1000 && stat.replies < TEST_PUBLISH_COUNT + 2; i++) {
+        lwdistcomm_client_process_events(client);
+    }
+
+    bool found = lwdistcomm_server_get_client_stats(server, connected_id, &stats);
+    printf("replies=%d errors=%d reply bytes=%llu\n", stat.replies, stat.errors, (unsigned long long)stats.sent_bytes);
+
+    lwdistcomm_server_set_compression(server, false, 0);
+    lwdistcomm_client_destroy(client);
+
+    if (stat.replies != TEST_PUBLISH_COUNT + 2 || stat.errors || !found ||
+        stats.sent_bytes * 4 > (uint64_t)(TEST_PUBLISH_COUNT + 2) * TEST_PAYLOAD_SIZE) {
+        printf("Compressed RPC test FAILED\n");
+        return false;
+    }
+
+    printf("Compressed RPC test PASSED\n");
+    return true;
+}
+
+/**
+ * 主函数
+ */
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Payload Compression Test\n");
+    printf("========================\n");
+
+    lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_IPV4);
+    if (!addr || !lwdistcomm_address_set_ipv4(addr, "127.0.0.1", TEST_PORT)) {
+        printf("Failed to create server address\n");
+        return 1;
+    }
+
+    lwdistcomm_server_t *server = lwdistcomm_server_create(NULL);
+    if (!server || !lwdistcomm_server_start(server, addr)) {
+        printf("Failed to start server\n");
+        lwdistcomm_address_destroy(addr);
+        return 1;
+    }
+    lwdistcomm_server_set_client_callback(server, client_callback, NULL);
+    lwdistcomm_server_add_handler(server, "/lz4/echo", echo_handler, NULL);
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, server_thread, server);
+
+    bool inflate_passed = test_inflate();
+    bool publish_passed = test_publish(server, addr);
+    bool rpc_passed = test_rpc(server, addr);
+
+    server_running = false;
+    pthread_join(tid, NULL);
+    lwdistcomm_server_destroy(server);
+    lwdistcomm_address_destroy(addr);
+
+    printf("\n=== Test Summary ===\n");
+    printf("Frame inflate test: %s\n", inflate_passed ? "PASSED" : "FAILED");
+    printf("Compressed publish test: %s\n", publish_passed ? "PASSED" : "FAILED");
+    printf("Compressed RPC test: %s\n", rpc_passed ? "PASSED" : "FAILED");
+
+    if (inflate_passed && publish_passed && rpc_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return 1;
+    }
+}
@@ -220,6 +220,371 @@ static bool test_dds_basic_functionality(void)
     return data_received;
 }
 
+/**
+ * 多读取器接收计数回调
+ */
+static void count_callback(lwdistcomm_dds_data_reader_t *reader, void *arg)
+{
+    test_data_t data;
+    uint32_t size = sizeof(test_data_t);
+    lwdistcomm_dds_sample_info_t info;
+    
+    while (lwdistcomm_dds_data_reader_take(reader, &data, &size, &info) == LWDISTCOMM_DDS_RETCODE_OK) {
+        __atomic_add_fetch((int *)arg, 1, __ATOMIC_RELAXED);
+        size = sizeof(test_data_t);
+    }
+}
+
+/**
+ * 测试DataWriter按匹配的DataReader定位器路由
+ */
+static bool test_dds_matched_readers(void)
+{
+    printf("\n=== Testing DDS Matched Reader Routing ===\n");
+    
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = { .name = "RoutingTopic", .type_name = "test_data_t", .qos = qos };
+    lwdistcomm_dds_topic_options_t other_options = { .name = "OtherTopic", .type_name = "test_data_t", .qos = qos };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = lwdistcomm_dds_topic_create(participant, &topic_options);
+    lwdistcomm_dds_topic_t *other = lwdistcomm_dds_topic_create(participant, &other_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = qos };
+    lwdistcomm_dds_data_reader_options_t dr_options = { .topic = topic, .qos = qos };
+    lwdistcomm_dds_data_reader_options_t other_dr_options = { .topic = other, .qos = qos };
+    
+    /* 先创建一个读取器，再创建写入器，再创建第二个读取器，覆盖两种匹配顺序 */
+    lwdistcomm_dds_data_reader_t *reader1 = lwdistcomm_dds_data_reader_create(subscriber, &dr_options);
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &dw_options);
+    lwdistcomm_dds_data_reader_t *reader2 = lwdistcomm_dds_data_reader_create(subscriber, &dr_options);
+    lwdistcomm_dds_data_reader_t *reader3 = lwdistcomm_dds_data_reader_create(subscriber, &other_dr_options);
+    
+    int count1 = 0, count2 = 0, count3 = 0;
+    lwdistcomm_dds_data_reader_set_data_available_callback(reader1, count_callback, &count1);
+    lwdistcomm_dds_data_reader_set_data_available_callback(reader2, count_callback, &count2);
+    lwdistcomm_dds_data_reader_set_data_available_callback(reader3, count_callback, &count3);
+    
+    test_data_t test_data = { .id = 1, .message = "routing" };
+    for (int i = 0; i < 10; i++) {
+        lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data));
+    }
+    usleep(200000);
+    
+    /* 删除读取器后写入器不再向其发送 */
+    lwdistcomm_dds_data_reader_delete(reader1);
+    for (int i = 0; i < 10; i++) {
+        lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data));
+    }
+    usleep(200000);
+    
+    int received1 = __atomic_load_n(&count1, __ATOMIC_RELAXED);
+    int received2 = __atomic_load_n(&count2, __ATOMIC_RELAXED);
+    int received3 = __atomic_load_n(&count3, __ATOMIC_RELAXED);
+    printf("reader1=%d reader2=%d other=%d\n", received1, received2, received3);
+    
+    lwdistcomm_dds_data_reader_delete(reader2);
+    lwdistcomm_dds_data_reader_delete(reader3);
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(other);
+    lwdistcomm_dds_topic_delete(topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    bool passed = received1 == 10 && received2 == 20 && received3 == 0;
+    printf("DDS matched reader routing test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
+/**
+ * 测试借出式take和样本槽用尽时覆盖最早样本
+ */
+static bool test_dds_loan(void)
+{
+    printf("\n=== Testing DDS Sample Loan ===\n");
+    
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = { .name = "LoanTopic", .type_name = "test_data_t", .qos = qos };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = lwdistcomm_dds_topic_create(participant, &topic_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    /* 读取器只预分配16个样本槽 */
+    lwdistcomm_dds_qos_t reader_qos = qos;
+    lwdistcomm_dds_qos_set_resource_limits(&reader_qos, 16, 1, 16);
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = qos };
+    lwdistcomm_dds_data_reader_options_t dr_options = { .topic = topic, .qos = reader_qos };
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &dw_options);
+    lwdistcomm_dds_data_reader_t *reader = lwdistcomm_dds_data_reader_create(subscriber, &dr_options);
+    
+    bool passed = true;
+    test_data_t test_data = { .id = 0, .message = "loan" };
+    
+    for (int round = 0; round < 2 && passed; round++) {
+        for (int i = 0; i < 40; i++) {
+            test_data.id = round * 100 + i;
+            lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data));
+        }
+        usleep(200000);
+        
+        /* 同时借出全部样本，应为最新的16个且按序 */
+        const void *loans[16];
+        int loaned = 0;
+        const void *sample;
+        uint32_t size;
+        lwdistcomm_dds_sample_info_t info;
+        while (loaned < 16 && lwdistcomm_dds_data_reader_take_loan(reader, &sample, &size, &info) == LWDISTCOMM_DDS_RETCODE_OK) {
+            if (size != sizeof(test_data_t) || ((const test_data_t *)sample)->id != round * 100 + 24 + loaned) {
+                passed = false;
+            }
+            loans[loaned++] = sample;
+        }
+        
+        if (loaned != 16 || lwdistcomm_dds_data_reader_take_loan(reader, &sample, &size, &info) != LWDISTCOMM_DDS_RETCODE_NO_DATA) {
+            passed = false;
+        }
+        printf("round=%d loaned=%d\n", round, loaned);
+        
+        for (int i = 0; i < loaned; i++) {
+            if (lwdistcomm_dds_data_reader_return_loan(reader, loans[i]) != LWDISTCOMM_DDS_RETCODE_OK) {
+                passed = false;
+            }
+        }
+    }
+    
+    lwdistcomm_dds_data_reader_delete(reader);
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    printf("DDS sample loan test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
+/**
+ * 可靠传输按序接收统计
+ */
+typedef struct {
+    int received;
+    int errors;
+    uint32_t lost;
+} test_reliable_stat_t;
+
+/**
+ * 可靠传输接收回调，校验样本和序列号连续
+ */
+static void reliable_callback(lwdistcomm_dds_data_reader_t *reader, void *arg)
+{
+    test_reliable_stat_t *stat = (test_reliable_stat_t *)arg;
+    test_data_t data;
+    uint32_t size = sizeof(test_data_t);
+    lwdistcomm_dds_sample_info_t info;
+    
+    while (lwdistcomm_dds_data_reader_take(reader, &data, &size, &info) == LWDISTCOMM_DDS_RETCODE_OK) {
+        if (data.id != stat->received || info.sequence_number != (uint64_t)stat->received + 1) {
+            stat->errors++;
+        }
+        stat->lost += info.lost_samples;
+        __atomic_store_n(&stat->received, stat->received + 1, __ATOMIC_RELEASE);
+        size = sizeof(test_data_t);
+    }
+}
+
+/**
+ * 测试RELIABLE + KEEP_ALL下突发写入全部按序送达
+ */
+static bool test_dds_reliable(void)
+{
+    printf("\n=== Testing DDS Reliable Delivery ===\n");
+    
+    const int total = 5000;
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = { .name = "ReliableTopic", .type_name = "test_data_t", .qos = qos };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = lwdistcomm_dds_topic_create(participant, &topic_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    /* 写入器历史只保留64个样本，未确认时阻塞写入 */
+    lwdistcomm_dds_qos_t reliable_qos = qos;
+    lwdistcomm_dds_qos_set_reliability(&reliable_qos, LWDISTCOMM_DDS_RELIABILITY_RELIABLE, NULL);
+    lwdistcomm_dds_qos_set_history(&reliable_qos, LWDISTCOMM_DDS_HISTORY_KEEP_ALL, 0);
+    lwdistcomm_dds_qos_set_resource_limits(&reliable_qos, 64, 1, 64);
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = reliable_qos };
+    lwdistcomm_dds_data_reader_options_t dr_options = { .topic = topic, .qos = reliable_qos };
+    lwdistcomm_dds_data_reader_t *reader = lwdistcomm_dds_data_reader_create(subscriber, &dr_options);
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &dw_options);
+    
+    test_reliable_stat_t stat = { 0, 0, 0 };
+    lwdistcomm_dds_data_reader_set_data_available_callback(reader, reliable_callback, &stat);
+    
+    int failed_writes = 0;
+    test_data_t test_data = { .id = 0, .message = "reliable" };
+    for (int i = 0; i < total; i++) {
+        test_data.id = i;
+        if (lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data)) != LWDISTCOMM_DDS_RETCODE_OK) {
+            failed_writes++;
+        }
+    }
+    
+    for (int i = 0; i < 50 && __atomic_load_n(&stat.received, __ATOMIC_ACQUIRE) < total; i++) {
+        usleep(100000);
+    }
+    
+    lwdistcomm_dds_data_reader_delete(reader);
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    printf("written=%d failed=%d received=%d errors=%d lost=%u\n",
+           total - failed_writes, failed_writes, stat.received, stat.errors, stat.lost);
+    
+    bool passed = failed_writes == 0 && stat.received == total && stat.errors == 0 && stat.lost == 0;
+    printf("DDS reliable delivery test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
+/**
+ * 等待接收数达到期望值
+ */
+static int wait_received(test_reliable_stat_t *stat, int expected, int timeout_ms)
+{
+    for (int i = 0; i < timeout_ms / 10 && __atomic_load_n(&stat->received, __ATOMIC_ACQUIRE) < expected; i++) {
+        usleep(10000);
+    }
+    
+    return __atomic_load_n(&stat->received, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * 测试样本打包：发送期限到达自动发送、显式flush和打包报文的可靠传输
+ */
+static bool test_dds_batching(void)
+{
+    printf("\n=== Testing DDS Sample Batching ===\n");
+    
+    const int total = 2000;
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = { .name = "BatchTopic", .type_name = "test_data_t", .qos = qos };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = lwdistcomm_dds_topic_create(participant, &topic_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    lwdistcomm_dds_qos_t reliable_qos = qos;
+    lwdistcomm_dds_qos_set_reliability(&reliable_qos, LWDISTCOMM_DDS_RELIABILITY_RELIABLE, NULL);
+    lwdistcomm_dds_qos_set_history(&reliable_qos, LWDISTCOMM_DDS_HISTORY_KEEP_ALL, 0);
+    lwdistcomm_dds_qos_set_resource_limits(&reliable_qos, 256, 1, 256);
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = reliable_qos };
+    lwdistcomm_dds_data_reader_options_t dr_options = { .topic = topic, .qos = reliable_qos };
+    lwdistcomm_dds_data_reader_t *reader = lwdistcomm_dds_data_reader_create(subscriber, &dr_options);
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &dw_options);
+    
+    test_reliable_stat_t stat = { 0, 0, 0 };
+    lwdistcomm_dds_data_reader_set_data_available_callback(reader, reliable_callback, &stat);
+    
+    test_data_t test_data = { .id = 0, .message = "batch" };
+    lwdistcomm_dds_duration_t short_delay = { .sec = 0, .nanosec = 2000000 };
+    lwdistcomm_dds_duration_t long_delay = { .sec = 10, .nanosec = 0 };
+    
+    /* 发送期限到达后自动发送 */
+    lwdistcomm_dds_data_writer_set_batching(writer, &short_delay);
+    for (int i = 0; i < 3; i++) {
+        lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data));
+        test_data.id++;
+    }
+    int deadline_received = wait_received(&stat, 3, 1000);
+    
+    /* 发送期限很长时只有flush才发送 */
+    lwdistcomm_dds_data_writer_set_batching(writer, &long_delay);
+    for (int i = 0; i < 2; i++) {
+        lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data));
+        test_data.id++;
+    }
+    usleep(50000);
+    int before_flush = __atomic_load_n(&stat.received, __ATOMIC_ACQUIRE);
+    lwdistcomm_dds_data_writer_flush(writer);
+    int after_flush = wait_received(&stat, 5, 1000);
+    
+    /* 突发写入，多个样本打包进同一报文 */
+    lwdistcomm_dds_data_writer_set_batching(writer, &short_delay);
+    for (int i = 0; i < total; i++) {
+        lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data));
+        test_data.id++;
+    }
+    int burst_received = wait_received(&stat, total + 5, 5000);
+    
+    lwdistcomm_dds_data_reader_delete(reader);
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    printf("deadline=%d before_flush=%d after_flush=%d burst=%d errors=%d lost=%u\n",
+           deadline_received, before_flush, after_flush, burst_received, stat.errors, stat.lost);
+    
+    bool passed = deadline_received == 3 && before_flush == 3 && after_flush == 5 &&
+                  burst_received == total + 5 && stat.errors == 0 && stat.lost == 0;
+    printf("DDS sample batching test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
 /**
  * 测试DDS QoS策略
  */
@@ -278,6 +643,599 @@ static bool test_dds_qos(void)
     return true;
 }
 
+/**
+ * 测试同一主题的多个DataReader经主题组播全部收到样本
+ */
+static bool test_dds_multicast(void)
+{
+    printf("\n=== Testing DDS Multicast Fan-out ===\n");
+    
+    const int total = 200;
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = { .name = "MulticastTopic", .type_name = "test_data_t", .qos = qos };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = lwdistcomm_dds_topic_create(participant, &topic_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    lwdistcomm_dds_qos_t reader_qos = qos;
+    lwdistcomm_dds_qos_set_resource_limits(&reader_qos, 256, 1, 256);
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = qos };
+    lwdistcomm_dds_data_reader_options_t dr_options = { .topic = topic, .qos = reader_qos };
+    lwdistcomm_dds_data_reader_t *readers[3];
+    int counts[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++) {
+        readers[i] = lwdistcomm_dds_data_reader_create(subscriber, &dr_options);
+        lwdistcomm_dds_data_reader_set_data_available_callback(readers[i], count_callback, &counts[i]);
+    }
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &dw_options);
+    
+    test_data_t test_data = { .id = 0, .message = "multicast" };
+    for (int i = 0; i < total; i++) {
+        test_data.id = i;
+        lwdistcomm_dds_data_writer_write(writer, &test_data, sizeof(test_data));
+        if (i % 20 == 19) {
+            usleep(1000);
+        }
+    }
+    usleep(200000);
+    
+    bool passed = true;
+    for (int i = 0; i < 3; i++) {
+        int received = __atomic_load_n(&counts[i], __ATOMIC_RELAXED);
+        printf("reader%d=%d\n", i + 1, received);
+        if (received != total) {
+            passed = false;
+        }
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        lwdistcomm_dds_data_reader_delete(readers[i]);
+    }
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    printf("DDS multicast fan-out test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
+/**
+ * 填充大样本内容
+ */
+static void fill_pattern(uint8_t *data, uint32_t size, uint32_t seed)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        data[i] = (uint8_t)(i * 7 + seed + (i >> 12));
+    }
+}
+
+/**
+ * 借出大样本并校验长度和内容，超时返回false
+ */
+static bool check_large_sample(lwdistcomm_dds_data_reader_t *reader, uint32_t size, uint32_t seed, int timeout_ms)
+{
+    const void *sample;
+    uint32_t sample_size;
+    lwdistcomm_dds_sample_info_t info;
+    int waited = 0;
+    
+    while (lwdistcomm_dds_data_reader_take_loan(reader, &sample, &sample_size, &info) != LWDISTCOMM_DDS_RETCODE_OK) {
+        if (waited >= timeout_ms) {
+            return false;
+        }
+        usleep(10000);
+        waited += 10;
+    }
+    
+    uint8_t *expected = (uint8_t *)malloc(size);
+    fill_pattern(expected, size, seed);
+    bool ok = sample_size == size && memcmp(sample, expected, size) == 0;
+    free(expected);
+    
+    return lwdistcomm_dds_data_reader_return_loan(reader, sample) == LWDISTCOMM_DDS_RETCODE_OK && ok;
+}
+
+/**
+ * 测试超过单个报文的大样本分片发送和重组：可靠传输的数MB快照送达两个DataReader，
+ * 尽力而为的中等样本按序送达
+ */
+static bool test_dds_fragmentation(void)
+{
+    printf("\n=== Testing DDS Large Sample Fragmentation ===\n");
+    
+    const uint32_t large_size = 4 * 1024 * 1024 + 123;
+    const uint32_t medium_size = 100 * 1024;
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t reliable_options = { .name = "SnapshotTopic", .type_name = "snapshot", .qos = qos };
+    lwdistcomm_dds_topic_options_t best_effort_options = { .name = "FrameTopic", .type_name = "frame", .qos = qos };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *reliable_topic = lwdistcomm_dds_topic_create(participant, &reliable_options);
+    lwdistcomm_dds_topic_t *best_effort_topic = lwdistcomm_dds_topic_create(participant, &best_effort_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    lwdistcomm_dds_qos_t reliable_qos = qos;
+    lwdistcomm_dds_qos_set_reliability(&reliable_qos, LWDISTCOMM_DDS_RELIABILITY_RELIABLE, NULL);
+    lwdistcomm_dds_qos_set_history(&reliable_qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, 4);
+    lwdistcomm_dds_data_writer_options_t reliable_dw = { .topic = reliable_topic, .qos = reliable_qos };
+    lwdistcomm_dds_data_reader_options_t reliable_dr = { .topic = reliable_topic, .qos = reliable_qos };
+    lwdistcomm_dds_data_writer_options_t best_effort_dw = { .topic = best_effort_topic, .qos = qos };
+    lwdistcomm_dds_data_reader_options_t best_effort_dr = { .topic = best_effort_topic, .qos = qos };
+    
+    lwdistcomm_dds_data_reader_t *reader1 = lwdistcomm_dds_data_reader_create(subscriber, &reliable_dr);
+    lwdistcomm_dds_data_reader_t *reader2 = lwdistcomm_dds_data_reader_create(subscriber, &reliable_dr);
+    lwdistcomm_dds_data_reader_t *frame_reader = lwdistcomm_dds_data_reader_create(subscriber, &best_effort_dr);
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &reliable_dw);
+    lwdistcomm_dds_data_writer_t *frame_writer = lwdistcomm_dds_data_writer_create(publisher, &best_effort_dw);
+    
+    bool passed = true;
+    uint8_t *data = (uint8_t *)malloc(large_size);
+    
+    /* 可靠传输：丢失的分片由NACK_FRAG补齐 */
+    fill_pattern(data, large_size, 1);
+    if (lwdistcomm_dds_data_writer_write(writer, data, large_size) != LWDISTCOMM_DDS_RETCODE_OK) {
+        passed = false;
+    }
+    
+    /* 缓冲区不足时返回所需长度 */
+    uint8_t small[64];
+    uint32_t size = sizeof(small);
+    lwdistcomm_dds_retcode_t small_ret = LWDISTCOMM_DDS_RETCODE_NO_DATA;
+    for (int i = 0; i < 500 && small_ret == LWDISTCOMM_DDS_RETCODE_NO_DATA; i++) {
+        small_ret = lwdistcomm_dds_data_reader_take(reader1, small, &size, NULL);
+        if (small_ret == LWDISTCOMM_DDS_RETCODE_NO_DATA) {
+            usleep(10000);
+        }
+    }
+    if (small_ret != LWDISTCOMM_DDS_RETCODE_ERROR || size != large_size) {
+        passed = false;
+    }
+    
+    bool reliable1 = check_large_sample(reader1, large_size, 1, 5000);
+    bool reliable2 = check_large_sample(reader2, large_size, 1, 5000);
+    
+    /* 尽力而为：逐个写入中等样本 */
+    int frames = 0;
+    for (uint32_t i = 0; i < 3; i++) {
+        fill_pattern(data, medium_size, 10 + i);
+        lwdistcomm_dds_data_writer_write(frame_writer, data, medium_size);
+        if (check_large_sample(frame_reader, medium_size, 10 + i, 1000)) {
+            frames++;
+        }
+    }
+    
+    printf("small_ret=%d needed=%u reliable1=%d reliable2=%d frames=%d\n", small_ret, size, reliable1, reliable2, frames);
+    passed = passed && reliable1 && reliable2 && frames == 3;
+    
+    free(data);
+    lwdistcomm_dds_data_writer_delete(frame_writer);
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_data_reader_delete(frame_reader);
+    lwdistcomm_dds_data_reader_delete(reader2);
+    lwdistcomm_dds_data_reader_delete(reader1);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(best_effort_topic);
+    lwdistcomm_dds_topic_delete(reliable_topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    printf("DDS large sample fragmentation test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
+/**
+ * 标签样本，以标签名为键
+ */
+typedef struct {
+    char name[32];
+    int seq;
+    double value;
+} test_tag_t;
+
+/**
+ * 标签名键提取回调，空标签名无有效键
+ */
+static uint32_t tag_key_extract(const void *data, uint32_t size, void *key, uint32_t key_size, void *arg)
+{
+    (void)arg;
+    
+    if (size != sizeof(test_tag_t)) {
+        return 0;
+    }
+    
+    const test_tag_t *tag = (const test_tag_t *)data;
+    uint32_t len = (uint32_t)strnlen(tag->name, sizeof(tag->name));
+    if (len > key_size) {
+        return 0;
+    }
+    
+    memcpy(key, tag->name, len);
+    return len;
+}
+
+/**
+ * 逐实例取走样本，校验每个实例只保留最新的depth个样本，返回取走的样本数
+ */
+static int take_instances(lwdistcomm_dds_data_reader_t *reader, int tags, int updates, int depth, bool *ok)
+{
+    uint32_t previous = LWDISTCOMM_DDS_HANDLE_NIL;
+    uint32_t current = LWDISTCOMM_DDS_HANDLE_NIL;
+    int taken = 0;
+    int per_instance = 0;
+    test_tag_t tag;
+    uint32_t size = sizeof(tag);
+    lwdistcomm_dds_sample_info_t info;
+    
+    /* 以当前句柄减1继续取走，实例的样本取完后自动前进到下一个实例 */
+    while (lwdistcomm_dds_data_reader_take_next_instance(reader, previous, &tag, &size, &info) == LWDISTCOMM_DDS_RETCODE_OK) {
+        if (info.instance_handle != current) {
+            if (info.instance_handle < current || (current != LWDISTCOMM_DDS_HANDLE_NIL && per_instance != depth)) {
+                *ok = false;
+            }
+            current = info.instance_handle;
+            per_instance = 0;
+        }
+        if (tag.seq != updates - depth + per_instance) {
+            *ok = false;
+        }
+        
+        previous = current - 1;
+        per_instance++;
+        taken++;
+        size = sizeof(tag);
+    }
+    
+    if (taken != tags * depth) {
+        *ok = false;
+    }
+    
+    return taken;
+}
+
+/**
+ * 测试有键主题：DataReader按实例保留最新depth个样本，按实例读取和取走，
+ * 迟加入的DataReader由可靠传输历史得到每个实例的当前值
+ */
+static bool test_dds_keyed(void)
+{
+    printf("\n=== Testing DDS Keyed Topic ===\n");
+    
+    const int tags = 10;
+    const int updates = 20;
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = {
+        .name = "TagTopic",
+        .type_name = "test_tag_t",
+        .qos = qos,
+        .key_extract = tag_key_extract
+    };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = lwdistcomm_dds_topic_create(participant, &topic_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    /* 写入器历史保留全部更新，供迟加入的读取器补齐 */
+    lwdistcomm_dds_qos_t writer_qos = qos;
+    lwdistcomm_dds_qos_set_reliability(&writer_qos, LWDISTCOMM_DDS_RELIABILITY_RELIABLE, NULL);
+    lwdistcomm_dds_qos_set_durability(&writer_qos, LWDISTCOMM_DDS_DURABILITY_TRANSIENT_LOCAL);
+    lwdistcomm_dds_qos_set_history(&writer_qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, 256);
+    lwdistcomm_dds_qos_t last_qos = writer_qos;
+    lwdistcomm_dds_qos_set_history(&last_qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, 1);
+    lwdistcomm_dds_qos_t depth_qos = writer_qos;
+    lwdistcomm_dds_qos_set_history(&depth_qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, 3);
+    
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = writer_qos };
+    lwdistcomm_dds_data_reader_options_t last_options = { .topic = topic, .qos = last_qos };
+    lwdistcomm_dds_data_reader_options_t depth_options = { .topic = topic, .qos = depth_qos };
+    lwdistcomm_dds_data_reader_t *last_reader = lwdistcomm_dds_data_reader_create(subscriber, &last_options);
+    lwdistcomm_dds_data_reader_t *depth_reader = lwdistcomm_dds_data_reader_create(subscriber, &depth_options);
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &dw_options);
+    
+    test_tag_t tag;
+    memset(&tag, 0, sizeof(tag));
+    for (int seq = 0; seq < updates; seq++) {
+        for (int i = 0; i < tags; i++) {
+            snprintf(tag.name, sizeof(tag.name), "tag.%d", i);
+            tag.seq = seq;
+            tag.value = i * 1000 + seq;
+            lwdistcomm_dds_data_writer_write(writer, &tag, sizeof(tag));
+        }
+    }
+    
+    /* 无有效键的样本被丢弃 */
+    memset(&tag, 0, sizeof(tag));
+    lwdistcomm_dds_data_writer_write(writer, &tag, sizeof(tag));
+    usleep(300000);
+    
+    bool passed = true;
+    
+    /* 按键读取实例当前值，非破坏性 */
+    uint32_t handle = lwdistcomm_dds_data_reader_lookup_instance(last_reader, "tag.7", 5);
+    uint32_t size = sizeof(tag);
+    lwdistcomm_dds_sample_info_t info;
+    for (int i = 0; i < 2; i++) {
+        size = sizeof(tag);
+        if (handle == LWDISTCOMM_DDS_HANDLE_NIL ||
+            lwdistcomm_dds_data_reader_read_instance(last_reader, handle, &tag, &size, &info) != LWDISTCOMM_DDS_RETCODE_OK ||
+            strcmp(tag.name, "tag.7") != 0 || tag.seq != updates - 1 || info.instance_handle != handle) {
+            passed = false;
+        }
+    }
+    if (lwdistcomm_dds_data_reader_lookup_instance(last_reader, "tag.99", 6) != LWDISTCOMM_DDS_HANDLE_NIL) {
+        passed = false;
+    }
+    
+    int last_taken = take_instances(last_reader, tags, updates, 1, &passed);
+    int depth_taken = take_instances(depth_reader, tags, updates, 3, &passed);
+    
+    /* 迟加入的读取器从写入器历史得到每个实例的当前值 */
+    lwdistcomm_dds_data_reader_t *late_reader = lwdistcomm_dds_data_reader_create(subscriber, &last_options);
+    for (int i = 0; i < 300; i++) {
+        usleep(10000);
+        handle = lwdistcomm_dds_data_reader_lookup_instance(late_reader, "tag.9", 5);
+        size = sizeof(tag);
+        if (handle != LWDISTCOMM_DDS_HANDLE_NIL &&
+            lwdistcomm_dds_data_reader_read_instance(late_reader, handle, &tag, &size, &info) == LWDISTCOMM_DDS_RETCODE_OK &&
+            tag.seq == updates - 1) {
+            break;
+        }
+    }
+    bool late_ok = true;
+    int late_taken = take_instances(late_reader, tags, updates, 1, &late_ok);
+    
+    printf("last=%d depth=%d late=%d\n", last_taken, depth_taken, late_taken);
+    passed = passed && late_ok;
+    
+    lwdistcomm_dds_data_reader_delete(late_reader);
+    lwdistcomm_dds_data_reader_delete(depth_reader);
+    lwdistcomm_dds_data_reader_delete(last_reader);
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    printf("DDS keyed topic test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
+/**
+ * 标签值提取回调，用于内容过滤的数值范围
+ */
+static bool tag_value_extract(const void *data, uint32_t size, double *value, void *arg)
+{
+    (void)arg;
+    
+    if (size != sizeof(test_tag_t)) {
+        return false;
+    }
+    
+    *value = ((const test_tag_t *)data)->value;
+    return true;
+}
+
+/**
+ * 按过滤条件检查标签
+ */
+static bool tag_matches(const lwdistcomm_dds_content_filter_t *filter, const test_tag_t *tag)
+{
+    bool matched = filter->num_prefixes == 0;
+    
+    for (uint32_t i = 0; i < filter->num_prefixes && !matched; i++) {
+        matched = strncmp(tag->name, filter->prefixes[i], strlen(filter->prefixes[i])) == 0;
+    }
+    
+    return matched && (!filter->has_range || (tag->value >= filter->min_value && tag->value <= filter->max_value));
+}
+
+/**
+ * 取走全部样本，校验样本通过过滤条件、按写入顺序到达且没有丢失，返回取走的样本数
+ */
+static int take_filtered(lwdistcomm_dds_data_reader_t *reader, const lwdistcomm_dds_content_filter_t *filter, int first_seq, bool *ok)
+{
+    test_tag_t tag;
+    uint32_t size = sizeof(tag);
+    lwdistcomm_dds_sample_info_t info;
+    int last_seq = first_seq - 1;
+    int taken = 0;
+    
+    while (lwdistcomm_dds_data_reader_take(reader, &tag, &size, &info) == LWDISTCOMM_DDS_RETCODE_OK) {
+        if (tag.seq <= last_seq || info.lost_samples || (filter && !tag_matches(filter, &tag))) {
+            *ok = false;
+        }
+        last_seq = tag.seq;
+        taken++;
+        size = sizeof(tag);
+    }
+    
+    return taken;
+}
+
+/**
+ * 写入seq从first到first + count - 1的标签，返回通过各过滤条件的样本数
+ */
+static void write_tags(lwdistcomm_dds_data_writer_t *writer, int first, int count, const lwdistcomm_dds_content_filter_t *filters, int num_filters, int *expected)
+{
+    test_tag_t tag;
+    
+    memset(&tag, 0, sizeof(tag));
+    for (int seq = first; seq < first + count; seq++) {
+        snprintf(tag.name, sizeof(tag.name), "line%d.tag%d", seq % 4, (seq / 4) % 10);
+        tag.seq = seq;
+        tag.value = seq % 100;
+        lwdistcomm_dds_data_writer_write(writer, &tag, sizeof(tag));
+        for (int i = 0; i < num_filters; i++) {
+            if (tag_matches(&filters[i], &tag)) {
+                expected[i]++;
+            }
+        }
+    }
+}
+
+/**
+ * 测试内容过滤：DataWriter只发送通过过滤条件的样本，被过滤的序列号不计为丢失；
+ * 过滤条件在DataWriter创建前后设置均生效，取消过滤后恢复接收全部样本
+ */
+static bool test_dds_content_filter(void)
+{
+    printf("\n=== Testing DDS Content Filter ===\n");
+    
+    const int total = 400;
+    const int more = 40;
+    lwdistcomm_dds_qos_t qos;
+    lwdistcomm_dds_qos_default(&qos);
+    
+    lwdistcomm_dds_domain_participant_options_t dp_options = {
+        .domain_id = 0,
+        .qos = qos,
+        .enable_automatic_discovery = false,
+        .discovery_port = 7400
+    };
+    lwdistcomm_dds_topic_options_t topic_options = {
+        .name = "FilterTopic",
+        .type_name = "test_tag_t",
+        .qos = qos,
+        .key_extract = tag_key_extract,
+        .value_extract = tag_value_extract
+    };
+    lwdistcomm_dds_publisher_options_t publisher_options = { .qos = qos };
+    lwdistcomm_dds_subscriber_options_t subscriber_options = { .qos = qos };
+    
+    lwdistcomm_dds_domain_participant_t *participant = lwdistcomm_dds_domain_participant_create(&dp_options);
+    lwdistcomm_dds_topic_t *topic = lwdistcomm_dds_topic_create(participant, &topic_options);
+    lwdistcomm_dds_publisher_t *publisher = lwdistcomm_dds_publisher_create(participant, &publisher_options);
+    lwdistcomm_dds_subscriber_t *subscriber = lwdistcomm_dds_subscriber_create(participant, &subscriber_options);
+    
+    lwdistcomm_dds_qos_t reliable_qos = qos;
+    lwdistcomm_dds_qos_set_reliability(&reliable_qos, LWDISTCOMM_DDS_RELIABILITY_RELIABLE, NULL);
+    lwdistcomm_dds_qos_set_history(&reliable_qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, 64);
+    lwdistcomm_dds_qos_t best_effort_qos = qos;
+    lwdistcomm_dds_qos_set_history(&best_effort_qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, 64);
+    lwdistcomm_dds_qos_t writer_qos = reliable_qos;
+    lwdistcomm_dds_qos_set_history(&writer_qos, LWDISTCOMM_DDS_HISTORY_KEEP_LAST, 256);
+    
+    /* 两个不带过滤的读取器使DataWriter使用组播，带过滤的读取器退出组播组 */
+    lwdistcomm_dds_data_reader_options_t reliable_options = { .topic = topic, .qos = reliable_qos };
+    lwdistcomm_dds_data_reader_options_t best_effort_options = { .topic = topic, .qos = best_effort_qos };
+    lwdistcomm_dds_data_reader_t *all_readers[2];
+    all_readers[0] = lwdistcomm_dds_data_reader_create(subscriber, &reliable_options);
+    all_readers[1] = lwdistcomm_dds_data_reader_create(subscriber, &reliable_options);
+    lwdistcomm_dds_data_reader_t *range_reader = lwdistcomm_dds_data_reader_create(subscriber, &reliable_options);
+    lwdistcomm_dds_data_reader_t *prefix_reader = lwdistcomm_dds_data_reader_create(subscriber, &best_effort_options);
+    
+    lwdistcomm_dds_content_filter_t filters[2];
+    memset(filters, 0, sizeof(filters));
+    filters[0].num_prefixes = 1;
+    strcpy(filters[0].prefixes[0], "line1.");
+    filters[0].has_range = true;
+    filters[0].min_value = 10;
+    filters[0].max_value = 49;
+    filters[1].num_prefixes = 2;
+    strcpy(filters[1].prefixes[0], "line2.");
+    strcpy(filters[1].prefixes[1], "line3.");
+    
+    bool passed = true;
+    
+    /* 无效的过滤条件 */
+    lwdistcomm_dds_content_filter_t invalid = filters[0];
+    invalid.min_value = 50;
+    if (lwdistcomm_dds_data_reader_set_content_filter(range_reader, &invalid) != LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER) {
+        passed = false;
+    }
+    invalid = filters[1];
+    invalid.num_prefixes = LWDISTCOMM_DDS_MAX_FILTER_PREFIXES + 1;
+    if (lwdistcomm_dds_data_reader_set_content_filter(prefix_reader, &invalid) != LWDISTCOMM_DDS_RETCODE_BAD_PARAMETER) {
+        passed = false;
+    }
+    
+    /* 一个过滤条件在DataWriter创建前设置，另一个在创建后更新 */
+    if (lwdistcomm_dds_data_reader_set_content_filter(range_reader, &filters[0]) != LWDISTCOMM_DDS_RETCODE_OK) {
+        passed = false;
+    }
+    lwdistcomm_dds_data_writer_options_t dw_options = { .topic = topic, .qos = writer_qos };
+    lwdistcomm_dds_data_writer_t *writer = lwdistcomm_dds_data_writer_create(publisher, &dw_options);
+    if (lwdistcomm_dds_data_reader_set_content_filter(prefix_reader, &filters[1]) != LWDISTCOMM_DDS_RETCODE_OK) {
+        passed = false;
+    }
+    
+    int expected[2] = { 0, 0 };
+    write_tags(writer, 0, total, filters, 2, expected);
+    usleep(500000);
+    
+    int all_taken[2];
+    for (int i = 0; i < 2; i++) {
+        all_taken[i] = take_filtered(all_readers[i], NULL, 0, &passed);
+    }
+    int range_taken = take_filtered(range_reader, &filters[0], 0, &passed);
+    int prefix_taken = take_filtered(prefix_reader, &filters[1], 0, &passed);
+    
+    /* 取消过滤后接收全部新样本 */
+    int unused[2] = { 0, 0 };
+    lwdistcomm_dds_data_reader_set_content_filter(prefix_reader, NULL);
+    write_tags(writer, total, more, filters, 2, unused);
+    usleep(300000);
+    int cleared_taken = take_filtered(prefix_reader, NULL, total, &passed);
+    
+    printf("all=%d/%d range=%d/%d prefix=%d/%d cleared=%d/%d\n", all_taken[0], all_taken[1],
+           range_taken, expected[0], prefix_taken, expected[1], cleared_taken, more);
+    
+    passed = passed && all_taken[0] == total && all_taken[1] == total && range_taken == expected[0] &&
+             prefix_taken == expected[1] && cleared_taken == more;
+    
+    lwdistcomm_dds_data_reader_delete(prefix_reader);
+    lwdistcomm_dds_data_reader_delete(range_reader);
+    lwdistcomm_dds_data_reader_delete(all_readers[1]);
+    lwdistcomm_dds_data_reader_delete(all_readers[0]);
+    lwdistcomm_dds_data_writer_delete(writer);
+    lwdistcomm_dds_subscriber_delete(subscriber);
+    lwdistcomm_dds_publisher_delete(publisher);
+    lwdistcomm_dds_topic_delete(topic);
+    lwdistcomm_dds_domain_participant_delete(participant);
+    
+    printf("DDS content filter test %s\n", passed ? "PASSED" : "FAILED");
+    
+    return passed;
+}
+
 /**
  * 主函数
  */
@@ -287,13 +1245,31 @@ int main(int argc, char *argv[])
     printf("====================\n");
     
     bool basic_test_passed = test_dds_basic_functionality();
+    bool routing_test_passed = test_dds_matched_readers();
+    bool loan_test_passed = test_dds_loan();
+    bool reliable_test_passed = test_dds_reliable();
+    bool batching_test_passed = test_dds_batching();
     bool qos_test_passed = test_dds_qos();
+    bool multicast_test_passed = test_dds_multicast();
+    bool fragmentation_test_passed = test_dds_fragmentation();
+    bool keyed_test_passed = test_dds_keyed();
+    bool filter_test_passed = test_dds_content_filter();
     
     printf("\n=== Test Summary ===\n");
     printf("Basic functionality test: %s\n", basic_test_passed ? "PASSED" : "FAILED");
+    printf("Matched reader routing test: %s\n", routing_test_passed ? "PASSED" : "FAILED");
+    printf("Sample loan test: %s\n", loan_test_passed ? "PASSED" : "FAILED");
+    printf("Reliable delivery test: %s\n", reliable_test_passed ? "PASSED" : "FAILED");
+    printf("Sample batching test: %s\n", batching_test_passed ? "PASSED" : "FAILED");
     printf("QoS policies test: %s\n", qos_test_passed ? "PASSED" : "FAILED");
+    printf("Multicast fan-out test: %s\n", multicast_test_passed ? "PASSED" : "FAILED");
+    printf("Large sample fragmentation test: %s\n", fragmentation_test_passed ? "PASSED" : "FAILED");
+    printf("Keyed topic test: %s\n", keyed_test_passed ? "PASSED" : "FAILED");
+    printf("Content filter test: %s\n", filter_test_passed ? "PASSED" : "FAILED");
     
-    if (basic_test_passed && qos_test_passed) {
+    if (basic_test_passed && routing_test_passed && loan_test_passed && reliable_test_passed &&
+        batching_test_passed && qos_test_passed && multicast_test_passed && fragmentation_test_passed &&
+        keyed_test_passed && filter_test_passed) {
         printf("\nAll tests PASSED!\n");
         return 0;
     } else {
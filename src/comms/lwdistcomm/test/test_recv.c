@@ -0,0 +1,179 @@
+#include "../include/message.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#define TEST_FRAME_COUNT   64
+#define TEST_STREAM_SIZE   (TEST_FRAME_COUNT * 70000)
+
+/**
+ * 接收回调统计
+ */
+typedef struct {
+    int frames;
+    int errors;
+    uint16_t next_seqno;
+} test_input_stat_t;
+
+/**
+ * 帧输入回调，校验序号、URL和负载内容
+ */
+static bool test_input(void *arg, lwdistcomm_msg_header_t *header)
+{
+    test_input_stat_t *stat = (test_input_stat_t *)arg;
+    lwdistcomm_message_t msg;
+    char *url;
+    size_t url_len;
+    char expect[32];
+    uint16_t seqno = ntohs(header->seqno);
+
+    snprintf(expect, sizeof(expect), "/recv/%u", seqno);
+    if (seqno != stat->next_seqno ||
+        !lwdistcomm_msg_get_url(header, &url, &url_len) ||
+        url_len != strlen(expect) || memcmp(url, expect, url_len) != 0 ||
+        !lwdistcomm_msg_get_payload(header, &msg)) {
+        stat->errors++;
+        return true;
+    }
+
+    for (size_t i = 0; i < msg.data_len; i++) {
+        if (((uint8_t *)msg.data)[i] != (uint8_t)(seqno + i)) {
+            stat->errors++;
+            return true;
+        }
+    }
+
+    stat->next_seqno++;
+    stat->frames++;
+    return true;
+}
+
+/**
+ * 构造测试数据流，帧大小从0到64KiB变化
+ */
+static size_t build_stream(uint8_t *stream)
+{
+    size_t off = 0;
+    uint8_t *payload = (uint8_t *)malloc(65536);
+
+    for (int i = 0; i < TEST_FRAME_COUNT; i++) {
+        char url[32];
+        size_t len = (i * 7919) % 65536;
+        size_t total;
+
+        for (size_t j = 0; j < len; j++) {
+            payload[j] = (uint8_t)(i + j);
+        }
+
+        snprintf(url, sizeof(url), "/recv/%d", i);
+        lwdistcomm_message_t msg = { payload, len };
+        lwdistcomm_msg_header_t *header = lwdistcomm_msg_init_header(stream + off, LWDISTCOMM_MSG_TYPE_PUBLISH, 0, (uint16_t)i);
+        lwdistcomm_msg_set_url(header, url);
+        lwdistcomm_msg_set_payload(header, &msg);
+        lwdistcomm_msg_validate_header(header, &total);
+        off += total;
+    }
+
+    free(payload);
+    return off;
+}
+
+/**
+ * 测试任意分片（含非对齐起始地址）输入
+ */
+static bool test_split_input(uint8_t *stream, size_t len)
+{
+    printf("\n=== Testing Split Input ===\n");
+
+    static const size_t chunks[] = { 1, 5, 12, 13, 1000, 4096, 65537 };
+    uint8_t *copy = (uint8_t *)malloc(len + 1);
+
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        test_input_stat_t stat = { 0, 0, 0 };
+        lwdistcomm_msg_recv_t recv;
+
+        // 非对齐地址
+        memcpy(copy + 1, stream, len);
+        lwdistcomm_msg_init_recv(&recv);
+        for (size_t off = 0; off < len; off += chunks[c]) {
+            size_t n = len - off < chunks[c] ? len - off : chunks[c];
+            if (!lwdistcomm_msg_input(&recv, copy + 1 + off, n, test_input, &stat)) {
+                stat.errors++;
+                break;
+            }
+        }
+
+        printf("chunk=%zu frames=%d errors=%d buffered=%u size=%u\n",
+               chunks[c], stat.frames, stat.errors, recv.cur_len, recv.size);
+        if (stat.frames != TEST_FRAME_COUNT || stat.errors || recv.cur_len || recv.size) {
+            printf("Split input test FAILED\n");
+            lwdistcomm_msg_free_recv(&recv);
+            free(copy);
+            return false;
+        }
+    }
+
+    free(copy);
+    printf("Split input test PASSED\n");
+    return true;
+}
+
+/**
+ * 测试超过最大消息长度的帧被拒绝
+ */
+static bool test_max_size(uint8_t *stream, size_t len)
+{
+    printf("\n=== Testing Max Message Size ===\n");
+
+    test_input_stat_t stat = { 0, 0, 0 };
+    lwdistcomm_msg_recv_t recv;
+    bool ok;
+
+    lwdistcomm_msg_init_recv(&recv);
+    lwdistcomm_msg_set_recv_max(&recv, 1024);
+    ok = lwdistcomm_msg_input(&recv, stream, len, test_input, &stat);
+    printf("accepted=%d frames=%d buffered=%u size=%u\n", ok, stat.frames, recv.cur_len, recv.size);
+
+    if (ok || stat.errors || recv.size) {
+        printf("Max message size test FAILED\n");
+        return false;
+    }
+
+    printf("Max message size test PASSED\n");
+    return true;
+}
+
+/**
+ * 主函数
+ */
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Message Receive Buffer Test\n");
+    printf("===========================\n");
+
+    uint8_t *stream = (uint8_t *)malloc(TEST_STREAM_SIZE);
+    if (!stream) {
+        return 1;
+    }
+
+    size_t len = build_stream(stream);
+    bool split_passed = test_split_input(stream, len);
+    bool max_passed = test_max_size(stream, len);
+    free(stream);
+
+    printf("\n=== Test Summary ===\n");
+    printf("Split input test: %s\n", split_passed ? "PASSED" : "FAILED");
+    printf("Max message size test: %s\n", max_passed ? "PASSED" : "FAILED");
+
+    if (split_passed && max_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return 1;
+    }
+}
@@ -0,0 +1,492 @@
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/address.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define TEST_SOCKET_PATH    "/tmp/test_rpc.sock"
+#define TEST_REACTOR_PATH   "/tmp/test_rpc_reactor.sock"
+#define TEST_REACTOR_PORT   17651
+#define TEST_BATCH_ROUNDS   100
+#define TEST_MAX_PENDING    255
+#define TEST_REACTORS       4
+#define TEST_CLIENTS        8
+#define TEST_PUBLISH_COUNT  100
+
+/**
+ * 服务器事件线程控制
+ */
+static volatile bool server_running = true;
+
+/**
+ * RPC应答统计
+ */
+typedef struct {
+    int replied;
+    int errors;
+    int no_response;
+} test_rpc_stat_t;
+
+/**
+ * 单个请求的应答上下文
+ */
+typedef struct {
+    test_rpc_stat_t *stat;
+    uint32_t id;
+} test_rpc_ctx_t;
+
+/**
+ * 调用过处理函数的线程
+ */
+static pthread_mutex_t handler_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t handler_threads[TEST_REACTORS];
+static int handler_thread_count = 0;
+
+/**
+ * 服务器事件线程
+ */
+static void *server_thread(void *arg)
+{
+    lwdistcomm_server_t *server = (lwdistcomm_server_t *)arg;
+    while (server_running) {
+        lwdistcomm_server_process_events(server);
+    }
+    return NULL;
+}
+
+/**
+ * 记录调用处理函数的线程
+ */
+static void record_handler_thread(void)
+{
+    pthread_t self = pthread_self();
+    int i;
+
+    pthread_mutex_lock(&handler_lock);
+    for (i = 0; i < handler_thread_count; i++) {
+        if (pthread_equal(handler_threads[i], self)) {
+            break;
+        }
+    }
+    if (i == handler_thread_count && handler_thread_count < TEST_REACTORS) {
+        handler_threads[handler_thread_count++] = self;
+    }
+    pthread_mutex_unlock(&handler_lock);
+}
+
+/**
+ * 回显处理函数，多个reactor并发调用，应答缓冲区按线程独立，应答在调用线程内发送完成
+ */
+static void echo_handler(void *arg, uint32_t client_id, const char *url, const lwdistcomm_message_t *msg, lwdistcomm_message_t *response)
+{
+    static __thread uint8_t buffer[256];
+
+    (void)client_id;
+    (void)url;
+
+    if (arg) {
+        record_handler_thread();
+    }
+
+    if (msg->data && msg->data_len <= sizeof(buffer)) {
+        memcpy(buffer, msg->data, msg->data_len);
+        response->data = buffer;
+        response->data_len = msg->data_len;
+    }
+}
+
+/**
+ * RPC应答回调，校验应答与请求对应
+ */
+static void rpc_callback(void *arg, int status, const lwdistcomm_message_t *msg)
+{
+    test_rpc_ctx_t *ctx = (test_rpc_ctx_t *)arg;
+    uint32_t id;
+
+    if (status == LWDISTCOMM_STATUS_NO_RESPONDING) {
+        ctx->stat->no_response++;
+        return;
+    }
+
+    if (status != 0 || !msg || msg->data_len != sizeof(id)) {
+        ctx->stat->errors++;
+        return;
+    }
+
+    memcpy(&id, msg->data, sizeof(id));
+    if (id != ctx->id) {
+        ctx->stat->errors++;
+    }
+    ctx->stat->replied++;
+}
+
+/**
+ * 处理客户端事件直到收到expected个应答
+ */
+static void wait_replies(lwdistcomm_client_t *client, test_rpc_stat_t *stat, int expected)
+{
+    for (int i = 0; i < 1000 && stat->replied + stat->errors < expected; i++) {
+        lwdistcomm_client_process_events(client);
+    }
+}
+
+/**
+ * 测试批量RPC一次写出多个请求，每个应答回调各自的请求
+ */
+static bool test_rpc_batch(lwdistcomm_client_t *client)
+{
+    printf("\n=== Testing Batched RPC ===\n");
+
+    test_rpc_stat_t stat = { 0, 0, 0 };
+    test_rpc_ctx_t ctx[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    uint32_t ids[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    lwdistcomm_message_t msgs[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    lwdistcomm_client_rpc_req_t reqs[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    int expected = 0;
+
+    for (int round = 0; round < TEST_BATCH_ROUNDS; round++) {
+        for (int i = 0; i < LWDISTCOMM_CLIENT_RPC_BATCH_MAX; i++) {
+            ids[i] = (uint32_t)(round * LWDISTCOMM_CLIENT_RPC_BATCH_MAX + i);
+            ctx[i].stat = &stat;
+            ctx[i].id = ids[i];
+            msgs[i].data = &ids[i];
+            msgs[i].data_len = sizeof(ids[i]);
+            reqs[i].url = "/rpc/echo";
+            reqs[i].msg = &msgs[i];
+            // 每8个请求中有一个不关心应答
+            reqs[i].callback = (i % 8 == 7) ? NULL : rpc_callback;
+            reqs[i].arg = &ctx[i];
+            if (reqs[i].callback) {
+                expected++;
+            }
+        }
+
+        if (!lwdistcomm_client_rpc_batch(client, reqs, LWDISTCOMM_CLIENT_RPC_BATCH_MAX)) {
+            printf("Batch %d send FAILED\n", round);
+            return false;
+        }
+        wait_replies(client, &stat, expected);
+    }
+
+    // 超出批量上限或含无效请求时不发送任何请求
+    bool oversize = lwdistcomm_client_rpc_batch(client, reqs, LWDISTCOMM_CLIENT_RPC_BATCH_MAX + 1);
+    reqs[1].url = NULL;
+    bool invalid = lwdistcomm_client_rpc_batch(client, reqs, 2);
+
+    printf("batch: replied=%d expected=%d errors=%d oversize=%d invalid=%d\n",
+           stat.replied, expected, stat.errors, oversize, invalid);
+
+    if (stat.replied != expected || stat.errors || stat.no_response || oversize || invalid) {
+        printf("Batched RPC test FAILED\n");
+        return false;
+    }
+
+    printf("Batched RPC test PASSED\n");
+    return true;
+}
+
+/**
+ * 测试固定等待槽位耗尽后拒绝请求，应答释放槽位后可再次使用
+ */
+static bool test_rpc_pending_slots(lwdistcomm_client_t *client)
+{
+    printf("\n=== Testing RPC Pending Slots ===\n");
+
+    test_rpc_stat_t stat = { 0, 0, 0 };
+    static test_rpc_ctx_t ctx[TEST_MAX_PENDING + 1];
+    static uint32_t ids[TEST_MAX_PENDING + 1];
+    lwdistcomm_message_t msg;
+    int sent = 0;
+
+    // 不处理应答，连续发送直到槽位耗尽
+    for (int i = 0; i <= TEST_MAX_PENDING; i++) {
+        ids[i] = 1000000 + i;
+        ctx[i].stat = &stat;
+        ctx[i].id = ids[i];
+        msg.data = &ids[i];
+        msg.data_len = sizeof(ids[i]);
+        if (!lwdistcomm_client_rpc(client, "/rpc/echo", &msg, rpc_callback, &ctx[i])) {
+            break;
+        }
+        sent++;
+    }
+
+    wait_replies(client, &stat, sent);
+
+    // 槽位释放后可再次发送
+    int before = stat.replied;
+    ids[0] = 2000000;
+    ctx[0].id = ids[0];
+    msg.data = &ids[0];
+    bool again = lwdistcomm_client_rpc(client, "/rpc/echo", &msg, rpc_callback, &ctx[0]);
+    wait_replies(client, &stat, before + 1);
+
+    printf("pending: sent=%d replied=%d errors=%d again=%d\n", sent, stat.replied, stat.errors, again);
+
+    if (sent != TEST_MAX_PENDING || stat.replied != sent + 1 || stat.errors || !again) {
+        printf("RPC pending slots test FAILED\n");
+        return false;
+    }
+
+    printf("RPC pending slots test PASSED\n");
+    return true;
+}
+
+/**
+ * 测试断开连接时所有等待中的请求以无应答回调
+ */
+static bool test_rpc_disconnect(lwdistcomm_client_t *client, lwdistcomm_address_t *addr)
+{
+    printf("\n=== Testing RPC Disconnect ===\n");
+
+    test_rpc_stat_t stat = { 0, 0, 0 };
+    test_rpc_ctx_t ctx[16];
+    uint32_t id = 0;
+    lwdistcomm_message_t msg = { &id, sizeof(id) };
+
+    for (int i = 0; i < 16; i++) {
+        ctx[i].stat = &stat;
+        ctx[i].id = id;
+        lwdistcomm_client_rpc(client, "/rpc/echo", &msg, rpc_callback, &ctx[i]);
+    }
+
+    lwdistcomm_client_disconnect(client);
+    int aborted = stat.no_response;
+
+    // 重新连接后旧请求的应答不再回调
+    bool reconnected = lwdistcomm_client_connect(client, addr);
+    stat.replied = 0;
+    ctx[0].id = id;
+    bool sent = reconnected && lwdistcomm_client_rpc(client, "/rpc/echo", &msg, rpc_callback, &ctx[0]);
+    wait_replies(client, &stat, 1);
+
+    printf("disconnect: aborted=%d reconnected=%d replied=%d errors=%d\n", aborted, reconnected, stat.replied, stat.errors);
+
+    if (aborted != 16 || !sent || stat.replied != 1 || stat.errors || stat.no_response != 16) {
+        printf("RPC disconnect test FAILED\n");
+        return false;
+    }
+
+    printf("RPC disconnect test PASSED\n");
+    return true;
+}
+
+/**
+ * 多reactor测试客户端
+ */
+typedef struct {
+    lwdistcomm_client_t *client;
+    test_rpc_stat_t stat;
+    int expected;
+    int published;
+    uint32_t base;
+} test_reactor_client_t;
+
+/**
+ * 多reactor订阅回调
+ */
+static void reactor_message_callback(void *arg, const char *url, const lwdistcomm_message_t *msg)
+{
+    (void)url;
+    (void)msg;
+    ((test_reactor_client_t *)arg)->published++;
+}
+
+/**
+ * 多reactor测试客户端线程，以批量RPC并发访问服务器
+ */
+static void *reactor_client_thread(void *arg)
+{
+    test_reactor_client_t *tc = (test_reactor_client_t *)arg;
+    test_rpc_ctx_t ctx[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    uint32_t ids[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    lwdistcomm_message_t msgs[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+    lwdistcomm_client_rpc_req_t reqs[LWDISTCOMM_CLIENT_RPC_BATCH_MAX];
+
+    for (int round = 0; round < TEST_BATCH_ROUNDS / 2; round++) {
+        for (int i = 0; i < LWDISTCOMM_CLIENT_RPC_BATCH_MAX; i++) {
+            ids[i] = tc->base + (uint32_t)(round * LWDISTCOMM_CLIENT_RPC_BATCH_MAX + i);
+            ctx[i].stat = &tc->stat;
+            ctx[i].id = ids[i];
+            msgs[i].data = &ids[i];
+            msgs[i].data_len = sizeof(ids[i]);
+            reqs[i].url = "/rpc/echo";
+            reqs[i].msg = &msgs[i];
+            reqs[i].callback = rpc_callback;
+            reqs[i].arg = &ctx[i];
+        }
+
+        if (!lwdistcomm_client_rpc_batch(tc->client, reqs, LWDISTCOMM_CLIENT_RPC_BATCH_MAX)) {
+            break;
+        }
+        tc->expected += LWDISTCOMM_CLIENT_RPC_BATCH_MAX;
+        wait_replies(tc->client, &tc->stat, tc->expected);
+    }
+
+    return NULL;
+}
+
+/**
+ * 测试多reactor服务器：客户端分布到各reactor，处理函数并发执行，发布送达所有reactor的订阅者
+ */
+static bool test_rpc_reactors(lwdistcomm_addr_type_t type)
+{
+    bool tcp = (type == LWDISTCOMM_ADDR_TYPE_IPV4);
+
+    printf("\n=== Testing Multi-Reactor Server (%s) ===\n", tcp ? "TCP" : "Unix");
+
+    lwdistcomm_address_t *addr = lwdistcomm_address_create(type);
+    if (tcp) {
+        lwdistcomm_address_set_ipv4(addr, "127.0.0.1", TEST_REACTOR_PORT);
+    } else {
+        lwdistcomm_address_set_unix_path(addr, TEST_REACTOR_PATH);
+    }
+
+    lwdistcomm_server_t *server = lwdistcomm_server_create(NULL);
+    if (!server || !lwdistcomm_server_set_reactors(server, TEST_REACTORS) ||
+        !lwdistcomm_server_add_handler(server, "/rpc/echo", echo_handler, server) ||
+        !lwdistcomm_server_start(server, addr)) {
+        printf("Failed to start multi-reactor server\n");
+        lwdistcomm_server_destroy(server);
+        lwdistcomm_address_destroy(addr);
+        return false;
+    }
+
+    pthread_mutex_lock(&handler_lock);
+    handler_thread_count = 0;
+    pthread_mutex_unlock(&handler_lock);
+
+    server_running = true;
+    pthread_t tid;
+    pthread_create(&tid, NULL, server_thread, server);
+
+    test_reactor_client_t tcs[TEST_CLIENTS];
+    pthread_t ctids[TEST_CLIENTS];
+    int connected = 0;
+
+    memset(tcs, 0, sizeof(tcs));
+    for (int i = 0; i < TEST_CLIENTS; i++) {
+        tcs[i].base = (uint32_t)i << 24;
+        tcs[i].client = lwdistcomm_client_create(NULL);
+        if (tcs[i].client && lwdistcomm_client_connect(tcs[i].client, addr) &&
+            lwdistcomm_client_subscribe(tcs[i].client, "/rpc/pub", reactor_message_callback, &tcs[i])) {
+            connected++;
+        }
+    }
+
+    for (int i = 0; i < TEST_CLIENTS; i++) {
+        pthread_create(&ctids[i], NULL, reactor_client_thread, &tcs[i]);
+    }
+    for (int i = 0; i < TEST_CLIENTS; i++) {
+        pthread_join(ctids[i], NULL);
+    }
+
+    // 订阅在RPC应答之前已处理，发布送达所有reactor上的客户端
+    uint32_t value = 0;
+    lwdistcomm_message_t msg = { &value, sizeof(value) };
+    for (int i = 0; i < TEST_PUBLISH_COUNT; i++) {
+        lwdistcomm_server_publish(server, "/rpc/pub", &msg);
+    }
+
+    int replied = 0, expected = 0, errors = 0, published = 0;
+    for (int i = 0; i < TEST_CLIENTS; i++) {
+        for (int j = 0; j < 100 && tcs[i].published < TEST_PUBLISH_COUNT; j++) {
+            lwdistcomm_client_process_events(tcs[i].client);
+        }
+        replied += tcs[i].stat.replied;
+        expected += tcs[i].expected;
+        errors += tcs[i].stat.errors + tcs[i].stat.no_response;
+        published += tcs[i].published;
+    }
+
+    int clients = lwdistcomm_server_get_client_count(server);
+
+    for (int i = 0; i < TEST_CLIENTS; i++) {
+        lwdistcomm_client_destroy(tcs[i].client);
+    }
+
+    server_running = false;
+    pthread_join(tid, NULL);
+    lwdistcomm_server_destroy(server);
+    lwdistcomm_address_destroy(addr);
+
+    printf("reactors: connected=%d clients=%d replied=%d expected=%d errors=%d published=%d handler_threads=%d\n",
+           connected, clients, replied, expected, errors, published, handler_thread_count);
+
+    // SO_REUSEPORT分散TCP连接，Unix域套接字由竞争accept的reactor接收
+    if (connected != TEST_CLIENTS || clients != TEST_CLIENTS ||
+        expected != TEST_CLIENTS * (TEST_BATCH_ROUNDS / 2) * LWDISTCOMM_CLIENT_RPC_BATCH_MAX ||
+        replied != expected || errors || published != TEST_CLIENTS * TEST_PUBLISH_COUNT || (tcp && handler_thread_count < 2)) {
+        printf("Multi-reactor server test FAILED\n");
+        return false;
+    }
+
+    printf("Multi-reactor server test PASSED\n");
+    return true;
+}
+
+/**
+ * 主函数
+ */
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Client RPC Test\n");
+    printf("===============\n");
+
+    lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_UNIX);
+    if (!addr || !lwdistcomm_address_set_unix_path(addr, TEST_SOCKET_PATH)) {
+        printf("Failed to create server address\n");
+        return 1;
+    }
+
+    lwdistcomm_server_t *server = lwdistcomm_server_create(NULL);
+    if (!server || !lwdistcomm_server_add_handler(server, "/rpc/echo", echo_handler, NULL) ||
+        !lwdistcomm_server_start(server, addr)) {
+        printf("Failed to start server\n");
+        lwdistcomm_address_destroy(addr);
+        return 1;
+    }
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, server_thread, server);
+
+    lwdistcomm_client_t *client = lwdistcomm_client_create(NULL);
+    bool connected = client && lwdistcomm_client_connect(client, addr);
+    if (!connected) {
+        printf("Failed to connect client\n");
+    }
+
+    bool batch_passed = connected && test_rpc_batch(client);
+    bool slots_passed = connected && test_rpc_pending_slots(client);
+    bool disconnect_passed = connected && test_rpc_disconnect(client, addr);
+
+    lwdistcomm_client_destroy(client);
+    server_running = false;
+    pthread_join(tid, NULL);
+    lwdistcomm_server_destroy(server);
+    lwdistcomm_address_destroy(addr);
+
+    bool reactor_tcp_passed = test_rpc_reactors(LWDISTCOMM_ADDR_TYPE_IPV4);
+    bool reactor_unix_passed = test_rpc_reactors(LWDISTCOMM_ADDR_TYPE_UNIX);
+
+    printf("\n=== Test Summary ===\n");
+    printf("Batched RPC test: %s\n", batch_passed ? "PASSED" : "FAILED");
+    printf("RPC pending slots test: %s\n", slots_passed ? "PASSED" : "FAILED");
+    printf("RPC disconnect test: %s\n", disconnect_passed ? "PASSED" : "FAILED");
+    printf("Multi-reactor TCP server test: %s\n", reactor_tcp_passed ? "PASSED" : "FAILED");
+    printf("Multi-reactor Unix server test: %s\n", reactor_unix_passed ? "PASSED" : "FAILED");
+
+    if (batch_passed && slots_passed && disconnect_passed && reactor_tcp_passed && reactor_unix_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return 1;
+    }
+}
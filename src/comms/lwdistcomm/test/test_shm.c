@@ -0,0 +1,225 @@
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/address.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define TEST_SOCKET_PATH    "/tmp/test_shm.sock"
+#define TEST_PUBLISH_COUNT  10000
+#define TEST_PAYLOAD_SIZE   256
+
+/**
+ * 服务器事件线程控制
+ */
+static volatile bool server_running = true;
+
+/**
+ * 订阅者接收统计
+ */
+typedef struct {
+    int received;
+    int errors;
+    int unexpected;
+} test_sub_stat_t;
+
+/**
+ * 服务器事件线程
+ */
+static void *server_thread(void *arg)
+{
+    lwdistcomm_server_t *server = (lwdistcomm_server_t *)arg;
+    while (server_running) {
+        lwdistcomm_server_process_events(server);
+    }
+    return NULL;
+}
+
+/**
+ * 订阅消息回调，校验负载内容
+ */
+static void message_callback(void *arg, const char *url, const lwdistcomm_message_t *msg)
+{
+    test_sub_stat_t *stat = (test_sub_stat_t *)arg;
+
+    if (strcmp(url, "/shm/data") != 0) {
+        stat->unexpected++;
+        return;
+    }
+
+    if (msg->data_len != TEST_PAYLOAD_SIZE || *(int *)msg->data != stat->received) {
+        stat->errors++;
+    }
+    stat->received++;
+}
+
+/**
+ * 创建并连接客户端
+ */
+static lwdistcomm_client_t *connect_client(lwdistcomm_address_t *addr, bool shm, test_sub_stat_t *stat)
+{
+    lwdistcomm_client_t *client = lwdistcomm_client_create(NULL);
+    if (!client) {
+        return NULL;
+    }
+
+    lwdistcomm_client_set_shm(client, shm);
+    if (!lwdistcomm_client_connect(client, addr) ||
+        !lwdistcomm_client_subscribe(client, "/shm/", message_callback, stat)) {
+        lwdistcomm_client_destroy(client);
+        return NULL;
+    }
+
+    // 等待订阅应答
+    for (int i = 0; i < 10; i++) {
+        lwdistcomm_client_process_events(client);
+    }
+
+    return client;
+}
+
+/**
+ * 测试同机客户端自动协商共享内存，并与套接字订阅者收到相同数据
+ */
+static bool test_shm_publish(lwdistcomm_server_t *server, lwdistcomm_address_t *addr)
+{
+    printf("\n=== Testing Shared Memory Publish ===\n");
+
+    test_sub_stat_t shm_stat = { 0, 0, 0 };
+    test_sub_stat_t sock_stat = { 0, 0, 0 };
+    uint64_t msgs = 0, overruns = 0;
+
+    lwdistcomm_client_t *shm_client = connect_client(addr, true, &shm_stat);
+    lwdistcomm_client_t *sock_client = connect_client(addr, false, &sock_stat);
+    if (!shm_client || !sock_client) {
+        printf("Failed to connect clients\n");
+        lwdistcomm_client_destroy(shm_client);
+        lwdistcomm_client_destroy(sock_client);
+        return false;
+    }
+
+    if (!lwdistcomm_client_get_shm_stats(shm_client, NULL, NULL) ||
+        lwdistcomm_client_get_shm_stats(sock_client, NULL, NULL)) {
+        printf("Shared memory negotiation FAILED\n");
+        lwdistcomm_client_destroy(shm_client);
+        lwdistcomm_client_destroy(sock_client);
+        return false;
+    }
+
+    char payload[TEST_PAYLOAD_SIZE];
+    memset(payload, 0, sizeof(payload));
+    lwdistcomm_message_t msg = { payload, sizeof(payload) };
+
+    // 未订阅的主题不应送达
+    lwdistcomm_server_publish(server, "/other/data", &msg);
+
+    // 分批发布，避免超出环形缓冲区和套接字队列
+    for (int i = 0; i < TEST_PUBLISH_COUNT; i++) {
+        memcpy(payload, &i, sizeof(i));
+        lwdistcomm_server_publish(server, "/shm/data", &msg);
+        if (i % 100 == 99) {
+            for (int j = 0; j < 100 && (shm_stat.received <= i || sock_stat.received <= i); j++) {
+                lwdistcomm_client_process_events(shm_client);
+                lwdistcomm_client_process_events(sock_client);
+            }
+        }
+    }
+
+    lwdistcomm_client_get_shm_stats(shm_client, &msgs, &overruns);
+    printf("shm: received=%d errors=%d unexpected=%d msgs=%llu overruns=%llu\n",
+           shm_stat.received, shm_stat.errors, shm_stat.unexpected,
+           (unsigned long long)msgs, (unsigned long long)overruns);
+    printf("socket: received=%d errors=%d unexpected=%d\n",
+           sock_stat.received, sock_stat.errors, sock_stat.unexpected);
+
+    lwdistcomm_client_destroy(shm_client);
+    lwdistcomm_client_destroy(sock_client);
+
+    if (shm_stat.received != TEST_PUBLISH_COUNT || shm_stat.errors || shm_stat.unexpected || overruns ||
+        sock_stat.received != TEST_PUBLISH_COUNT || sock_stat.errors || sock_stat.unexpected) {
+        printf("Shared memory publish test FAILED\n");
+        return false;
+    }
+
+    printf("Shared memory publish test PASSED\n");
+    return true;
+}
+
+/**
+ * 测试SHM地址类型要求服务器支持共享内存
+ */
+static bool test_shm_required(lwdistcomm_server_t *server)
+{
+    printf("\n=== Testing SHM Address Type ===\n");
+
+    lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_SHM);
+    lwdistcomm_address_set_unix_path(addr, TEST_SOCKET_PATH);
+    lwdistcomm_client_t *client = lwdistcomm_client_create(NULL);
+
+    bool with_shm = lwdistcomm_client_connect(client, addr);
+    lwdistcomm_server_set_shm(server, false, 0);
+    bool without_shm = lwdistcomm_client_connect(client, addr);
+    lwdistcomm_server_set_shm(server, true, 0);
+
+    lwdistcomm_client_destroy(client);
+    lwdistcomm_address_destroy(addr);
+
+    printf("connect with shm=%d without shm=%d\n", with_shm, without_shm);
+    if (!with_shm || without_shm) {
+        printf("SHM address type test FAILED\n");
+        return false;
+    }
+
+    printf("SHM address type test PASSED\n");
+    return true;
+}
+
+/**
+ * 主函数
+ */
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Shared Memory Transport Test\n");
+    printf("============================\n");
+
+    lwdistcomm_address_t *addr = lwdistcomm_address_create(LWDISTCOMM_ADDR_TYPE_UNIX);
+    if (!addr || !lwdistcomm_address_set_unix_path(addr, TEST_SOCKET_PATH)) {
+        printf("Failed to create server address\n");
+        return 1;
+    }
+
+    lwdistcomm_server_t *server = lwdistcomm_server_create(NULL);
+    if (!server || !lwdistcomm_server_start(server, addr)) {
+        printf("Failed to start server\n");
+        lwdistcomm_address_destroy(addr);
+        return 1;
+    }
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, server_thread, server);
+
+    bool publish_passed = test_shm_publish(server, addr);
+    bool required_passed = test_shm_required(server);
+
+    server_running = false;
+    pthread_join(tid, NULL);
+    lwdistcomm_server_destroy(server);
+    lwdistcomm_address_destroy(addr);
+
+    printf("\n=== Test Summary ===\n");
+    printf("Shared memory publish test: %s\n", publish_passed ? "PASSED" : "FAILED");
+    printf("SHM address type test: %s\n", required_passed ? "PASSED" : "FAILED");
+
+    if (publish_passed && required_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return 1;
+    }
+}
@@ -11,6 +11,7 @@
 */
 
 #include <errno.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +21,7 @@
 #include "ipc_client.h"
 #include "ipc_parser.h"
 #include "ipc_platform.h"
+#include "ipc_shm.h"
 
 /* Client max pending */
 #define VSOA_CLIENT_MAX_PENDING  0xff
@@ -69,6 +71,22 @@ struct ipc_client {
     uint16_t seqno_nq;
     int sock;
     int evtfd[2];
+    int epfd;
+    bool ep_reg;
+    ipc_event_handle_t ev_sock;
+    ipc_event_handle_t ev_evt;
+    bool shm_enable;
+    ipc_shm_ring_t shm;
+    uint32_t caps;
+    size_t batch_max;
+    int64_t batch_delay;
+    int64_t batch_deadline;
+    size_t batch_len;
+    uint8_t *batch_buf;
+    bool batch_run;
+    bool batch_drop;
+    vsoa_sem_t batch_sem;
+    vsoa_thread_t batch_thread;
     struct timeval send_timeout;
     vsoa_spin_t spin;
     vsoa_mutex_t lock;
@@ -76,6 +94,8 @@ struct ipc_client {
     void *marg;
     ipc_client_dat_func_t ondat;
     void *darg;
+    ipc_client_drop_func_t ondrop;
+    void *droparg;
 };
 
 
@@ -172,6 +192,28 @@ static void ipc_client_pendq_free (ipc_client_t *client, ipc_client_pendq_t *pen
     }
 }
 
+/*
+* Client epoll socket register or unregister (client->lock locked)
+*/
+static void ipc_client_ep_sock (ipc_client_t *client, bool reg)
+{
+#if defined(VSOA_HAS_EPOLL)
+    if (client->epfd < 0 || client->ep_reg == reg) {
+        return;
+    }
+
+    if (reg) {
+        client->ep_reg = vsoa_epoll_ctl(client->epfd, EPOLL_CTL_ADD, client->sock, EPOLLIN, &client->ev_sock);
+    } else {
+        vsoa_epoll_ctl(client->epfd, EPOLL_CTL_DEL, client->sock, 0, NULL);
+        client->ep_reg = false;
+    }
+#else
+    (void)client;
+    (void)reg;
+#endif
+}
+
 /*
 * Create VSOA client
 * Warning: This function must be mutually exclusive with the ipc_client_close() call
@@ -190,6 +232,8 @@ ipc_client_t *ipc_client_create (ipc_client_msg_func_t onmsg, void *arg)
     bzero(client, sizeof(ipc_client_t));
 
     client->sock   = -1;
+    client->epfd   = -1;
+    ipc_shm_ring_init(&client->shm);
 
     if (!vsoa_event_pair_create(client->evtfd)) {
         goto    error;
@@ -268,6 +312,16 @@ void ipc_client_close (ipc_client_t *client)
      */
     client->valid     = false;
 
+    if (client->batch_buf) {
+        vsoa_mutex_lock(&client->lock);
+        client->batch_run = false;
+        vsoa_mutex_unlock(&client->lock);
+        vsoa_sem_post(&client->batch_sem);
+        vsoa_thread_wait(&client->batch_thread);
+        vsoa_sem_destroy(&client->batch_sem);
+        free(client->batch_buf);
+    }
+
     vsoa_mutex_lock(&ipc_client_lock);
 
     DELETE_FROM_LIST(client, ipc_client_list);
@@ -280,11 +334,20 @@ void ipc_client_close (ipc_client_t *client)
     client->connected = false;
     vsoa_memory_barrier();
 
+    ipc_client_ep_sock(client, false);
+#if defined(VSOA_HAS_EPOLL)
+    if (client->epfd >= 0) {
+        vsoa_epoll_ctl(client->epfd, EPOLL_CTL_DEL, client->evtfd[0], 0, NULL);
+        client->epfd = -1;
+    }
+#endif
+
     if (client->sock >= 0) {
         close_socket(client->sock);
         client->sock = -1;
     }
 
+    ipc_shm_ring_destroy(&client->shm);
     vsoa_event_pair_close(client->evtfd);
     free(client->sendbuf);
 
@@ -364,6 +427,19 @@ static bool ipc_client_sendmsg (ipc_client_t *client, ipc_header_t *ipc_hdr,
     return true;
 }
 
+/*
+* Take the pending batch drop report (client->lock locked)
+* The caller calls `ondrop` after unlocking when this returns true
+*/
+static bool ipc_client_batch_dropped (ipc_client_t *client)
+{
+    bool dropped = client->batch_drop;
+
+    client->batch_drop = false;
+
+    return  (dropped && client->ondrop);
+}
+
 /*
 * All RPC callback timeout.
 */
@@ -421,6 +497,15 @@ static bool ipc_client_conn_input (void *varg, ipc_header_t *ipc_hdr)
         arg->client->cid_valid = true;
     }
 
+    /* Server capabilities follow the client id, older servers send none */
+    if (payload.data_len >= sizeof(uint32_t) * 2) {
+        nid = (uint8_t *)payload.data + sizeof(uint32_t);
+        arg->client->caps = ((uint32_t)nid[0] << 24) + ((uint32_t)nid[1] << 16)
+                          + ((uint32_t)nid[2] << 8)  +  (uint32_t)nid[3];
+    } else {
+        arg->client->caps = 0;
+    }
+
     return  (true);
 }
 
@@ -431,15 +516,24 @@ bool ipc_client_connect (ipc_client_t *client, const char* ipc_path,
                         const struct timespec *timeout)
 {
     int errcode, ret, on = 1, off = 0;
-    bool suc;
+    bool suc, dropped;
     char *opt;
     fd_set fds;
     size_t len = 0;
     ssize_t num;
+    uint32_t flags;
+    int i, nfds, shm_fds[IPC_SHM_FD_NUM];
     ipc_header_t *ipc_hdr;
     ipc_payload_t payload;
     struct sockaddr_un server;
     struct conn_input_arg arg;
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int) * IPC_SHM_FD_NUM)];
+    } cmsg_buf;
 
     if (!client || !client->valid) {
         return  (false);
@@ -448,11 +542,28 @@ bool ipc_client_connect (ipc_client_t *client, const char* ipc_path,
     client->connected = false;
     vsoa_memory_barrier();
 
+    vsoa_mutex_lock(&client->lock);
+    ipc_client_ep_sock(client, false);
+    vsoa_mutex_unlock(&client->lock);
+
     if (client->sock >= 0) {
         close_socket(client->sock);
         client->sock = -1;
     }
 
+    vsoa_mutex_lock(&client->lock);
+    ipc_shm_ring_destroy(&client->shm);
+    if (client->batch_len) {
+        client->batch_len  = 0;
+        client->batch_drop = true;
+    }
+    dropped = ipc_client_batch_dropped(client);
+    vsoa_mutex_unlock(&client->lock);
+
+    if (dropped) {
+        client->ondrop(client->droparg, client);
+    }
+
     ipc_client_timeout_all(client);
 
     client->sock = create_socket(AF_UNIX, SOCK_STREAM, 0, true);
@@ -465,6 +576,15 @@ bool ipc_client_connect (ipc_client_t *client, const char* ipc_path,
     server.sun_family = AF_UNIX;
     ipc_hdr = ipc_parser_init_header(client->sendbuf, IPC_TYPE_SERVINFO, 0, 0);
 
+    /* Request a shared memory datagram ring, older servers ignore the payload */
+    if (client->shm_enable) {
+        flags = htonl(IPC_SERVINFO_REQ_SHM);
+        memcpy((uint8_t *)ipc_hdr + IPC_HDR_LENGTH, &flags, sizeof(uint32_t));
+        payload.data     = (uint8_t *)ipc_hdr + IPC_HDR_LENGTH;
+        payload.data_len = sizeof(uint32_t);
+        ipc_parser_set_payload(ipc_hdr, &payload);
+    }
+
     if (!ipc_parser_validate_header(ipc_hdr, &len)) {
         return  (false);
     }
@@ -496,7 +616,43 @@ bool ipc_client_connect (ipc_client_t *client, const char* ipc_path,
         return  (false);
     }
 
-    num = recv(client->sock, client->recvbuf, IPC_MAX_PACKET_LENGTH, 0);
+    /* Service info reply may carry the shared memory ring fds */
+    iov.iov_base = client->recvbuf;
+    iov.iov_len  = IPC_MAX_PACKET_LENGTH;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = cmsg_buf.buf;
+    msg.msg_controllen = sizeof(cmsg_buf.buf);
+
+    num = recvmsg(client->sock, &msg, MSG_CMSG_CLOEXEC);
+
+    nfds = 0;
+    if (num > 0) {
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                nfds = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+                if (nfds > IPC_SHM_FD_NUM) {
+                    nfds = IPC_SHM_FD_NUM;
+                }
+                memcpy(shm_fds, CMSG_DATA(cmsg), sizeof(int) * nfds);
+                break;
+            }
+        }
+    }
+
+    if (nfds == IPC_SHM_FD_NUM && client->shm_enable) {
+        vsoa_mutex_lock(&client->lock);
+        ipc_shm_ring_attach(&client->shm, shm_fds);
+        vsoa_mutex_unlock(&client->lock);
+    } else {
+        for (i = 0; i < nfds; i++) {
+            close(shm_fds[i]);
+        }
+    }
+
+    /* Drop a partial packet of the previous connection */
+    ipc_parser_init_recv(&client->recv);
 
     if (num > 0) {
         arg.client     = client;
@@ -516,6 +672,10 @@ bool ipc_client_connect (ipc_client_t *client, const char* ipc_path,
     /* Set send timeout */
     vsoa_socket_sndto(client->sock, &client->send_timeout);
 
+    vsoa_mutex_lock(&client->lock);
+    ipc_client_ep_sock(client, true);
+    vsoa_mutex_unlock(&client->lock);
+
     return  (true);
 }
 
@@ -533,9 +693,12 @@ bool ipc_client_disconnect (ipc_client_t *client)
     vsoa_memory_barrier();
 
     if (client->sock >= 0) {
+        ipc_client_ep_sock(client, false);
         shutdown_socket(client->sock);
     }
 
+    ipc_shm_ring_destroy(&client->shm);
+
     vsoa_mutex_unlock(&client->lock);
 
     ipc_client_timeout_all(client);
@@ -679,71 +842,194 @@ out:
 }
 
 /*
-* VSOA client input event
+* Client socket input, false when the connection is lost
 */
-bool ipc_client_process_events (ipc_client_t *client, const fd_set *rfds)
+static bool ipc_client_sock_input (ipc_client_t *client)
 {
-    bool pkt_e;
+    bool pkt_e = false;
     ssize_t num;
-    ipc_header_t *ipc_hdr;
+
+    num = recv(client->sock, client->recvbuf, IPC_MAX_PACKET_LENGTH, MSG_DONTWAIT);
+    if (num > 0) {
+        // TODO: deal recv msg;
+        if (!ipc_parser_input(&client->recv, client->recvbuf,
+                            num, ipc_client_input, client)) {
+            pkt_e = true;
+        }
+    }
+
+    if (pkt_e || num == 0 || (num < 0 && errno != EWOULDBLOCK)) {
+        /* A lost connection stays quiet until the next connect */
+        vsoa_mutex_lock(&client->lock);
+        ipc_client_ep_sock(client, false);
+        client->connected = false;
+        vsoa_mutex_unlock(&client->lock);
+        vsoa_memory_barrier();
+
+        ipc_client_timeout_all(client);
+        return  (false);
+    }
+
+    return  (true);
+}
+
+/*
+* Client event pair input, expire timed out requests
+*/
+static void ipc_client_evt_input (ipc_client_t *client)
+{
     ipc_client_pendq_t *pendq, *to_head, *to_tail, *temp;
 
+    to_head = to_tail = NULL;
+
+    vsoa_event_pair_fetch(client->evtfd[0]);
+
+    vsoa_mutex_lock(&client->lock);
+
+    LIST_FOREACH_SAFE(pendq, temp, client->head) {
+        if (pendq->alive <= 0) {
+            if (pendq->ftype == VSOA_CLIENT_FTYPE_RPC) {
+                client->rpc_pending--;
+            }
+            DELETE_FROM_FIFO(pendq, client->head, client->tail);
+            INSERT_TO_FIFO(pendq, to_head, to_tail);
+        }
+    }
+
+    vsoa_mutex_unlock(&client->lock);
+
+    if (to_head) {
+        LIST_FOREACH_SAFE(pendq, temp, to_head) {
+            if (pendq->callback.dat) {
+                pendq->callback.dat(pendq->arg, client, NULL, NULL);
+            }
+            DELETE_FROM_FIFO(pendq, to_head, to_tail);
+            ipc_client_pendq_free(client, pendq);
+        }
+    }
+}
+
+/*
+* VSOA client input event
+*/
+bool ipc_client_process_events (ipc_client_t *client, const fd_set *rfds)
+{
     if (!client || !client->valid) {
         return  (false);
     }
     if (client->connected) {
         if (FD_ISSET(client->sock, rfds)) {
-            pkt_e = false;
-            num = recv(client->sock, client->recvbuf, IPC_MAX_PACKET_LENGTH, MSG_DONTWAIT);
-            if (num > 0) {
-                // TODO: deal recv msg;
-                if (!ipc_parser_input(&client->recv, client->recvbuf,
-                                    num, ipc_client_input, client)) {
-                    pkt_e = true;
-                }
-            }
-
-            if (pkt_e || num == 0 || (num < 0 && errno != EWOULDBLOCK)) {
-                client->connected = false;
-                vsoa_memory_barrier();
-
-                ipc_client_timeout_all(client);
+            if (!ipc_client_sock_input(client)) {
                 return  (false);
             }
         }
     }
 
     if (FD_ISSET(client->evtfd[0], rfds)) {
-        to_head = to_tail = NULL;
+        ipc_client_evt_input(client);
+    }
 
-        vsoa_event_pair_fetch(client->evtfd[0]);
+    return  (true);
+}
 
-        vsoa_mutex_lock(&client->lock);
+#if defined(VSOA_HAS_EPOLL)
+/*
+* Client socket epoll event
+*/
+static void ipc_client_ep_sock_event (ipc_event_handle_t *handle, uint32_t events)
+{
+    ipc_client_t *client = (ipc_client_t *)((char *)handle - offsetof(ipc_client_t, ev_sock));
 
-        LIST_FOREACH_SAFE(pendq, temp, client->head) {
-            if (pendq->alive <= 0) {
-                if (pendq->ftype == VSOA_CLIENT_FTYPE_RPC) {
-                    client->rpc_pending--;
-                }
-                DELETE_FROM_FIFO(pendq, client->head, client->tail);
-                INSERT_TO_FIFO(pendq, to_head, to_tail);
-            }
-        }
+    (void)events;
 
-        vsoa_mutex_unlock(&client->lock);
+    if (client->valid && client->connected) {
+        ipc_client_sock_input(client);
+    }
+}
 
-        if (to_head) {
-            LIST_FOREACH_SAFE(pendq, temp, to_head) {
-                if (pendq->callback.dat) {
-                    pendq->callback.dat(pendq->arg, client, NULL, NULL);
-                }
-                DELETE_FROM_FIFO(pendq, to_head, to_tail);
-                ipc_client_pendq_free(client, pendq);
-            }
+/*
+* Client event pair epoll event
+*/
+static void ipc_client_ep_evt_event (ipc_event_handle_t *handle, uint32_t events)
+{
+    ipc_client_t *client = (ipc_client_t *)((char *)handle - offsetof(ipc_client_t, ev_evt));
+
+    (void)events;
+
+    if (client->valid) {
+        ipc_client_evt_input(client);
+    }
+}
+#endif
+
+/*
+* VSOA client register with an epoll instance
+*/
+bool ipc_client_epoll_add (ipc_client_t *client, int epfd)
+{
+#if defined(VSOA_HAS_EPOLL)
+    bool ret = false;
+
+    if (!client || !client->valid || epfd < 0) {
+        return  (false);
+    }
+
+    vsoa_mutex_lock(&client->lock);
+
+    if (client->epfd >= 0) {
+        goto    out;
+    }
+
+    client->ev_sock.callback = ipc_client_ep_sock_event;
+    client->ev_evt.callback  = ipc_client_ep_evt_event;
+
+    if (!vsoa_epoll_ctl(epfd, EPOLL_CTL_ADD, client->evtfd[0], EPOLLIN, &client->ev_evt)) {
+        goto    out;
+    }
+
+    client->epfd = epfd;
+    ret = true;
+
+    if (client->connected) {
+        ipc_client_ep_sock(client, true);
+        if (!client->ep_reg) {
+            vsoa_epoll_ctl(epfd, EPOLL_CTL_DEL, client->evtfd[0], 0, NULL);
+            client->epfd = -1;
+            ret = false;
         }
     }
 
-    return  (true);
+out:
+    vsoa_mutex_unlock(&client->lock);
+
+    return  (ret);
+#else
+    (void)client;
+    (void)epfd;
+    return  (false);
+#endif
+}
+
+/*
+* VSOA client unregister from its epoll instance
+*/
+void ipc_client_epoll_del (ipc_client_t *client)
+{
+    if (!client || !client->valid) {
+        return;
+    }
+
+    vsoa_mutex_lock(&client->lock);
+
+#if defined(VSOA_HAS_EPOLL)
+    if (client->epfd >= 0) {
+        ipc_client_ep_sock(client, false);
+        vsoa_epoll_ctl(client->epfd, EPOLL_CTL_DEL, client->evtfd[0], 0, NULL);
+        client->epfd = -1;
+    }
+#endif
+
+    vsoa_mutex_unlock(&client->lock);
 }
 
 /*
@@ -1000,12 +1286,143 @@ bool ipc_client_call (ipc_client_t *client, const ipc_url_t *url, const ipc_payl
     return  (ipc_client_call_ex(client, url, payload, callback, arg, timeout, NULL));
 }
 
+/*
+* Send datagram frame (client->lock locked)
+*/
+static bool ipc_client_datagram_send (ipc_client_t *client, ipc_header_t *ipc_hdr,
+                                      const ipc_url_t *url, const ipc_payload_t *payload)
+{
+    if (ipc_shm_ring_valid(&client->shm)) {
+        return  (ipc_shm_ring_write(&client->shm, ipc_hdr, url, payload, &client->send_timeout));
+    } else {
+        return  (ipc_client_sendmsg(client, ipc_hdr, url, payload));
+    }
+}
+
+/*
+* Flush pending datagram batch (client->lock locked)
+* Batch frame: [header][url][record]... record: [length][data]
+*/
+static bool ipc_client_batch_flush (ipc_client_t *client)
+{
+    ipc_header_t *ipc_hdr = (ipc_header_t *)client->batch_buf;
+    ipc_url_t url;
+    ipc_payload_t payload;
+
+    if (!client->batch_len) {
+        return  (true);
+    }
+
+    url.url_len      = ipc_parser_get_url_len(ipc_hdr);
+    url.url          = (char *)client->batch_buf + IPC_HDR_LENGTH;
+    payload.data     = url.url + url.url_len;
+    payload.data_len = client->batch_len - IPC_HDR_LENGTH - url.url_len;
+    client->batch_len = 0;
+
+    if (!client->connected) {
+        client->batch_drop = true;
+        return  (false);
+    }
+
+    ipc_parser_set_payload(ipc_hdr, &payload);
+
+    if (!ipc_client_datagram_send(client, ipc_hdr, &url, &payload)) {
+        client->batch_drop = true;
+        return  (false);
+    }
+
+    return  (true);
+}
+
+/*
+* Append datagram to the pending batch (client->lock locked)
+*/
+static bool ipc_client_batch_append (ipc_client_t *client, const ipc_url_t *url, const ipc_payload_t *payload)
+{
+    uint32_t len;
+    size_t rec_len = IPC_BATCH_REC_HDR + payload->data_len;
+    ipc_header_t *ipc_hdr = (ipc_header_t *)client->batch_buf;
+
+    /* One URL per batch */
+    if (client->batch_len) {
+        if (ipc_parser_get_url_len(ipc_hdr) != url->url_len ||
+            memcmp(client->batch_buf + IPC_HDR_LENGTH, url->url, url->url_len) ||
+            client->batch_len + rec_len > IPC_MAX_PACKET_LENGTH) {
+            /* False always means not queued, so callers may retry */
+            if (!ipc_client_batch_flush(client)) {
+                return  (false);
+            }
+        }
+    }
+
+    if (!client->batch_len) {
+        ipc_hdr = ipc_parser_init_header(client->batch_buf, IPC_TYPE_DATAGRAM_BATCH, 0, 0);
+        if (!ipc_parser_set_url(ipc_hdr, url)) {
+            return  (false);
+        }
+        memcpy(client->batch_buf + IPC_HDR_LENGTH, url->url, url->url_len);
+        client->batch_len      = IPC_HDR_LENGTH + url->url_len;
+        client->batch_deadline = vsoa_current_time() + client->batch_delay;
+        vsoa_sem_post(&client->batch_sem);
+    }
+
+    len = htonl((uint32_t)payload->data_len);
+    memcpy(client->batch_buf + client->batch_len, &len, IPC_BATCH_REC_HDR);
+    if (payload->data_len) {
+        memcpy(client->batch_buf + client->batch_len + IPC_BATCH_REC_HDR, payload->data, payload->data_len);
+    }
+    client->batch_len += rec_len;
+
+    if (client->batch_len >= client->batch_max) {
+        return  (ipc_client_batch_flush(client));
+    }
+
+    return  (true);
+}
+
+/*
+* Batch deadline flush thread
+*/
+static void *ipc_client_batch_handle (void *arg)
+{
+    ipc_client_t *client = (ipc_client_t *)arg;
+    int64_t wait;
+    bool run, dropped;
+
+    do {
+        vsoa_sem_wait(&client->batch_sem, -1);
+
+        vsoa_mutex_lock(&client->lock);
+        while (client->batch_run && client->batch_len) {
+            wait = client->batch_deadline - vsoa_current_time();
+            if (wait <= 0) {
+                ipc_client_batch_flush(client);
+                break;
+            }
+            vsoa_mutex_unlock(&client->lock);
+
+            /* Close posts to interrupt the wait */
+            vsoa_sem_wait(&client->batch_sem, wait);
+            vsoa_mutex_lock(&client->lock);
+        }
+        run = client->batch_run;
+        dropped = ipc_client_batch_dropped(client);
+        vsoa_mutex_unlock(&client->lock);
+
+        if (dropped) {
+            client->ondrop(client->droparg, client);
+        }
+    } while (run);
+
+    return  (NULL);
+}
+
 /*
 * Send datagram to server
 */
 bool ipc_client_datagram (ipc_client_t *client, const ipc_url_t *url, const ipc_payload_t *payload)
 {
-    bool ret;
+    bool ret = false, dropped;
     size_t len;
     ipc_header_t *ipc_hdr;
 
@@ -1021,30 +1438,43 @@ bool ipc_client_datagram (ipc_client_t *client, const ipc_url_t *url, const ipc_
 
     vsoa_mutex_lock(&client->lock);
 
+    /* Small datagrams are batched when the server understands batch frames */
+    if (client->batch_max && (client->caps & IPC_SERVINFO_CAP_BATCH) &&
+        IPC_HDR_LENGTH + url->url_len + IPC_BATCH_REC_HDR + payload->data_len <= IPC_MAX_PACKET_LENGTH) {
+        ret = ipc_client_batch_append(client, url, payload);
+        goto    out;
+    }
+
+    /* Keep order with a pending batch */
+    if (client->batch_len && !ipc_client_batch_flush(client)) {
+        goto    out;
+    }
+
     ipc_hdr = ipc_parser_init_header(client->sendbuf, IPC_TYPE_DATAGRAM, 0, 0);
 
     if (!ipc_parser_set_url(ipc_hdr, url)) {
-        goto    error;
+        goto    out;
     }
 
     if (!ipc_parser_set_payload(ipc_hdr, payload)) {
-        goto    error;
+        goto    out;
     }
 
     if (!ipc_parser_validate_header(ipc_hdr, &len)) {
-        goto    error;
+        goto    out;
     }
 
-    ret = ipc_client_sendmsg(client, ipc_hdr, url, payload);
+    ret = ipc_client_datagram_send(client, ipc_hdr, url, payload);
 
+out:
+    dropped = ipc_client_batch_dropped(client);
     vsoa_mutex_unlock(&client->lock);
 
-    return  (ret);
-
-error:
-    vsoa_mutex_unlock(&client->lock);
+    if (dropped) {
+        client->ondrop(client->droparg, client);
+    }
 
-    return  (false);
+    return  (ret);
 }
 
 void ipc_client_set_on_datagram (ipc_client_t *client, ipc_client_dat_func_t callback, void *arg)
@@ -1055,6 +1485,106 @@ void ipc_client_set_on_datagram (ipc_client_t *client, ipc_client_dat_func_t cal
     }
 }
 
+void ipc_client_set_on_batch_drop (ipc_client_t *client, ipc_client_drop_func_t callback, void *arg)
+{
+    if (client) {
+        vsoa_mutex_lock(&client->lock);
+        client->ondrop  = callback;
+        client->droparg = arg;
+        vsoa_mutex_unlock(&client->lock);
+    }
+}
+
+/*
+* VSOA client datagram batching
+*/
+bool ipc_client_batch (ipc_client_t *client, size_t max_bytes, unsigned int delay_us)
+{
+    bool ret = true, dropped;
+
+    if (!client || !client->valid) {
+        return  (false);
+    }
+
+    if (max_bytes && !client->batch_buf) {
+        client->batch_buf = (uint8_t *)malloc(IPC_MAX_PACKET_LENGTH);
+        if (!client->batch_buf) {
+            return  (false);
+        }
+        if (vsoa_sem_init(&client->batch_sem, 0)) {
+            goto    error;
+        }
+        client->batch_run = true;
+        if (vsoa_thread_create(&client->batch_thread, ipc_client_batch_handle, client)) {
+            vsoa_sem_destroy(&client->batch_sem);
+            goto    error;
+        }
+    }
+
+    vsoa_mutex_lock(&client->lock);
+
+    if (!max_bytes) {
+        ret = ipc_client_batch_flush(client);
+    }
+    client->batch_max   = max_bytes;
+    client->batch_delay = (int64_t)delay_us * 1000;
+    dropped = ipc_client_batch_dropped(client);
+
+    vsoa_mutex_unlock(&client->lock);
+
+    if (dropped) {
+        client->ondrop(client->droparg, client);
+    }
+
+    return  (ret);
+
+error:
+    free(client->batch_buf);
+    client->batch_buf = NULL;
+    client->batch_run = false;
+    return  (false);
+}
+
+/*
+* VSOA client flush batched datagrams
+*/
+bool ipc_client_flush (ipc_client_t *client)
+{
+    bool ret, dropped;
+
+    if (!client || !client->valid) {
+        return  (false);
+    }
+
+    vsoa_mutex_lock(&client->lock);
+    ret = ipc_client_batch_flush(client);
+    dropped = ipc_client_batch_dropped(client);
+    vsoa_mutex_unlock(&client->lock);
+
+    if (dropped) {
+        client->ondrop(client->droparg, client);
+    }
+
+    return  (ret);
+}
+
+/*
+* VSOA client request shared memory datagram ring
+*/
+bool ipc_client_set_shm (ipc_client_t *client, bool enable)
+{
+    if (!client || !client->valid) {
+        return  (false);
+    }
+
+#if IPC_SHM_SUPPORT
+    client->shm_enable = enable;
+    return  (true);
+#else
+    return  (!enable);
+#endif
+}
+
 /*
 * end
 */
@@ -33,6 +33,7 @@
 #define IPC_TYPE_UNSUBSCRIBE  0x03
 #define IPC_TYPE_PUBLISH      0x04
 #define IPC_TYPE_DATAGRAM     0x05
+#define IPC_TYPE_DATAGRAM_BATCH  0x06
 #define IPC_FLAG_REPLY        0xfc
 #define IPC_TYPE_NOOP         0xfe
 #define IPC_TYPE_PINGECHO     0xff
@@ -46,6 +47,15 @@
 #define IPC_STATUS_NO_PERMISSIONS 5
 #define IPC_STATUS_NO_MEMORY      6
 
+/* VSOA service info request flags (optional 4 bytes payload, network byte order) */
+#define IPC_SERVINFO_REQ_SHM      0x00000001
+
+/* VSOA service info reply capabilities (4 bytes after the client id, network byte order) */
+#define IPC_SERVINFO_CAP_BATCH    0x00000001
+
+/* VSOA batched datagram record: 4 bytes length (network byte order) then data */
+#define IPC_BATCH_REC_HDR         4
+
 /* Headers */
 #include <stdint.h>
 #include <stdbool.h>
@@ -86,6 +96,20 @@ typedef struct {
 /* VSOA packet input callback */
 typedef bool (*vsoa_input_callback_t)(void *arg, ipc_header_t *ipc_hdr);
 
+/* VSOA event loop handle, the `data.ptr` of fds registered with a caller owned epoll instance.
+ * Callers may put it first in their own fd contexts and share the same dispatch loop */
+typedef struct ipc_event_handle {
+    void (*callback)(struct ipc_event_handle *handle, uint32_t events);
+} ipc_event_handle_t;
+
+/* VSOA event loop dispatch of a ready epoll event: ipc_event_dispatch(ev.data.ptr, ev.events) */
+static inline void ipc_event_dispatch (void *ptr, uint32_t events)
+{
+    ipc_event_handle_t *handle = (ipc_event_handle_t *)ptr;
+
+    handle->callback(handle, events);
+}
+
 /* Initialize VSOA header (`outb` must have at least IPC_MAX_PACKET_LENGTH bytes) */
 ipc_header_t *ipc_parser_init_header(void *outb, uint8_t type, uint8_t status, uint16_t seqno);
 
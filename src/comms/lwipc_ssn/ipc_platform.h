@@ -49,6 +49,11 @@
 #include <sys/eventfd.h>
 #endif
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define VSOA_HAS_EPOLL  1
+#endif
+
 #if defined(SYLIXOS) || defined(__APPLE__)
 #define VSOA_HAS_SIN_LEN  1
 #endif
@@ -296,6 +301,10 @@ typedef pthread_t                       vsoa_thread_t;
 #define MSG_NOSIGNAL    0
 #endif
 
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC    0
+#endif
+
 /*
  * Ioctl socket
  */
@@ -512,6 +521,21 @@ static inline int vsoa_select (int w, fd_set *rfds, fd_set *wfds, fd_set *efds,
 #endif
 }
 
+#if defined(VSOA_HAS_EPOLL)
+/*
+ * Caller owned epoll instance control, `ptr` is the event handle
+ */
+static inline bool vsoa_epoll_ctl (int epfd, int op, int fd, uint32_t events, void *ptr)
+{
+    struct epoll_event event;
+
+    event.events   = events;
+    event.data.ptr = ptr;
+
+    return  (epoll_ctl(epfd, op, fd, &event) == 0);
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,6 +17,7 @@
 #include "ipc_server.h"
 #include "ipc_parser.h"
 #include "ipc_platform.h"
+#include "ipc_shm.h"
 
 /* Client hash */
 #define VSOA_CLI_HASH_SIZE  64
@@ -26,14 +27,39 @@
 #define VSOA_CMD_HASH_SIZE  32
 #define VSOA_CMD_HASH_MASK  0x1f
 
+/* Subscription index hash */
+#define VSOA_SUB_HASH_SIZE  256
+#define VSOA_SUB_HASH_MASK  0xff
+
+/* Publish fan-out clients on stack */
+#define VSOA_PUB_FAST_CLIS  32
+
+/* Subscription index node */
+typedef struct ipc_server_sidx {
+    struct ipc_server_sidx *next;
+    struct ipc_server_sidx *prev;
+    struct ipc_server_cli *cli;
+    uint32_t hash;
+} ipc_server_sidx_t;
+
 /* Subscription node */
 typedef struct ipc_server_sub {
     struct ipc_server_sub *next;
     struct ipc_server_sub *prev;
+    ipc_server_sidx_t idx;
     size_t len;
     char url[1];
 } ipc_server_sub_t;
 
+/* Client outbound packet (unsent part) */
+typedef struct ipc_server_out {
+    struct ipc_server_out *next;
+    struct ipc_server_out *prev;
+    size_t len;
+    size_t off;
+    uint8_t data[1];
+} ipc_server_out_t;
+
 /* Client handshake timer */
 typedef struct ipc_server_hst {
     struct ipc_server_hst *next;
@@ -50,6 +76,24 @@ typedef struct ipc_server_cli {
     ipc_server_sub_t *subscribed;
     ipc_server_hst_t hst;
     ipc_recv_t recv;
+    ipc_shm_ring_t shm;
+    int ref;
+    uint32_t pub_gen;
+    vsoa_mutex_t out_lock;
+    bool out_broken;
+    ipc_server_out_t *out_h;
+    ipc_server_out_t *out_t;
+    size_t out_bytes;
+    int64_t out_since;
+    int64_t out_timeout;
+    ipc_event_handle_t ev_sock;
+    ipc_event_handle_t ev_door;
+    ipc_server_t *server;
+    bool closed;
+    bool ep_reg;
+    bool ep_door;
+    bool ep_out;
+    uint32_t ep_gen;
     int sock;
     ipc_cli_id_t id;
 } ipc_server_cli_t;
@@ -73,18 +117,31 @@ struct ipc_server {
     ipc_server_t *prev;
     ipc_server_hst_t *hst_h;
     ipc_server_cli_t *clis[VSOA_CLI_HASH_SIZE];
+    ipc_server_sidx_t *subs[VSOA_SUB_HASH_SIZE];
     ipc_server_cmd_t *cmds[VSOA_CMD_HASH_SIZE];
     ipc_server_cmd_t *def_cmd;
     ipc_server_cmd_t *prefix_h;
     ipc_server_cmd_t *prefix_t;
     ipc_server_dat_func_t ondat;
     void *darg;
+    const uint8_t *dat_pos;
+    const uint8_t *dat_end;
     ipc_server_cli_func_t oncli;
     void *carg;
     vsoa_mutex_t lock;
     struct timeval send_timeout;
+    bool shm_enable;
+    size_t shm_size;
+    uint32_t pub_gen;
+    int ncli;
+    int out_pending;
     int sock;
     int evtfd[2];
+    int epfd;
+    uint32_t ep_gen;
+    ipc_server_cli_t *retired;
+    ipc_event_handle_t ev_sock;
+    ipc_event_handle_t ev_evt;
     void *sendbuf;
     void *recvbuf;
 };
@@ -100,6 +157,11 @@ struct input_arg {
  */
 #define ipc_server_cli_hash(id)  (int)(id & VSOA_CLI_HASH_MASK)
 
+/*
+ * Send timeout (ns)
+ */
+#define ipc_server_timeout_ns(tv)  ((int64_t)(tv)->tv_sec * 1000000000 + (int64_t)(tv)->tv_usec * 1000)
+
 /* Default send timeout */
 static const struct timeval ipc_server_def_send_timeout = {
     .tv_sec  = (VSOA_SERVER_DEF_SEND_TIMEOUT / 1000),
@@ -136,12 +198,16 @@ static void *ipc_server_timer_handle (void *arg)
         }
 
         LIST_FOREACH(server, ipc_server_list) {
+            /* Clients with queued output are flushed and expired by the server thread */
+            emit = __atomic_load_n(&server->out_pending, __ATOMIC_RELAXED) > 0;
+
             if (!server->hst_h) {
+                if (emit) {
+                    vsoa_event_pair_signal(server->evtfd[1]);
+                }
                 continue;
             }
 
-            emit = false;
-
             vsoa_mutex_lock(&server->lock);
 
             LIST_FOREACH(hst, server->hst_h) {
@@ -224,6 +290,10 @@ static void ipc_server_cli_init (ipc_server_t *server, ipc_server_cli_t *cli)
     cli->id = ipc_server_cli_newid(server);
     hash = ipc_server_cli_hash(cli->id);
     INSERT_TO_HEADER(cli, server->clis[hash]);
+    server->ncli++;
+
+    cli->ref         = 1;
+    cli->out_timeout = ipc_server_timeout_ns(&server->send_timeout);
 
     cli->hst.alive = VSOA_SERVER_DEF_HANDSHAKE_TIMEOUT;
     INSERT_TO_HEADER(&cli->hst, server->hst_h);
@@ -236,6 +306,254 @@ static void ipc_server_cli_init (ipc_server_t *server, ipc_server_cli_t *cli)
 #endif
 }
 
+/*
+ * Client output queue release (`out_lock` locked)
+ */
+static void ipc_server_cli_out_free (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+    ipc_server_out_t *out, *out_temp;
+
+    if (!cli->out_h) {
+        return;
+    }
+
+    LIST_FOREACH_SAFE(out, out_temp, cli->out_h) {
+        free(out);
+    }
+
+    cli->out_h = cli->out_t = NULL;
+    cli->out_bytes = 0;
+    __atomic_sub_fetch(&server->out_pending, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Client reference
+ */
+static void ipc_server_cli_get (ipc_server_cli_t *cli)
+{
+    __atomic_add_fetch(&cli->ref, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Client unreference, the last one frees it
+ */
+static void ipc_server_cli_put (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+    if (__atomic_sub_fetch(&cli->ref, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+
+    ipc_server_cli_out_free(server, cli);
+    vsoa_mutex_destroy(&cli->out_lock);
+    ipc_shm_ring_destroy(&cli->shm);
+    close_socket(cli->sock);
+    free(cli);
+}
+
+/*
+ * Client epoll writable interest follows its output queue (`out_lock` locked)
+ */
+static void ipc_server_cli_ep_sync (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+#if defined(VSOA_HAS_EPOLL)
+    bool want = cli->out_h != NULL;
+
+    if (cli->ep_reg && cli->ep_out != want) {
+        if (vsoa_epoll_ctl(server->epfd, EPOLL_CTL_MOD, cli->sock,
+                           want ? EPOLLIN | EPOLLOUT : EPOLLIN, &cli->ev_sock)) {
+            cli->ep_out = want;
+        }
+    }
+#else
+    (void)server;
+    (void)cli;
+#endif
+}
+
+/*
+ * Client epoll register shared memory doorbell, the ring comes with the handshake (server thread)
+ */
+static void ipc_server_cli_ep_door (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+#if defined(VSOA_HAS_EPOLL)
+    if (cli->ep_reg && !cli->ep_door && ipc_shm_ring_valid(&cli->shm)) {
+        cli->ep_door = vsoa_epoll_ctl(server->epfd, EPOLL_CTL_ADD, cli->shm.doorfd, EPOLLIN, &cli->ev_door);
+    }
+#else
+    (void)server;
+    (void)cli;
+#endif
+}
+
+/*
+ * Client epoll unregister (`out_lock` locked)
+ */
+static void ipc_server_cli_ep_del (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+#if defined(VSOA_HAS_EPOLL)
+    if (cli->ep_reg) {
+        vsoa_epoll_ctl(server->epfd, EPOLL_CTL_DEL, cli->sock, 0, NULL);
+        if (cli->ep_door) {
+            vsoa_epoll_ctl(server->epfd, EPOLL_CTL_DEL, cli->shm.doorfd, 0, NULL);
+        }
+        cli->ep_reg  = false;
+        cli->ep_door = false;
+        cli->ep_out  = false;
+    }
+#else
+    (void)server;
+    (void)cli;
+#endif
+}
+
+/*
+ * Release retired clients (`server->lock` locked). Events already returned by
+ * the epoll wait that retired a client may still point to it, so it is kept
+ * until the event pair fires in a later wait, or `all`.
+ */
+static void ipc_server_ep_release (ipc_server_t *server, bool all)
+{
+    ipc_server_cli_t *cli, *cli_temp;
+
+    LIST_FOREACH_SAFE(cli, cli_temp, server->retired) {
+        if (all || cli->ep_gen != server->ep_gen) {
+            DELETE_FROM_LIST(cli, server->retired);
+            ipc_server_cli_put(server, cli);
+        }
+    }
+
+    server->ep_gen++;
+    if (server->retired) {
+        vsoa_event_pair_signal(server->evtfd[1]);
+    }
+}
+
+/*
+ * Server epoll unregister all (`server->lock` locked)
+ */
+static void ipc_server_ep_unregister (ipc_server_t *server)
+{
+#if defined(VSOA_HAS_EPOLL)
+    int i;
+    ipc_server_cli_t *cli;
+
+    if (server->epfd < 0) {
+        return;
+    }
+
+    for (i = 0; i < VSOA_CLI_HASH_SIZE; i++) {
+        LIST_FOREACH(cli, server->clis[i]) {
+            vsoa_mutex_lock(&cli->out_lock);
+            ipc_server_cli_ep_del(server, cli);
+            vsoa_mutex_unlock(&cli->out_lock);
+        }
+    }
+
+    if (server->sock >= 0) {
+        vsoa_epoll_ctl(server->epfd, EPOLL_CTL_DEL, server->sock, 0, NULL);
+    }
+    vsoa_epoll_ctl(server->epfd, EPOLL_CTL_DEL, server->evtfd[0], 0, NULL);
+
+    ipc_server_ep_release(server, true);
+    server->epfd = -1;
+#else
+    (void)server;
+#endif
+}
+
+/*
+ * Subscription url hash (FNV-1a), `h` chains a prefix
+ */
+static uint32_t ipc_server_sub_hash (uint32_t h, const char *url, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)url[i]) * 16777619U;
+    }
+
+    return  (h);
+}
+
+#define VSOA_SUB_HASH_INIT  2166136261U
+
+/*
+ * Subscription index add
+ */
+static void ipc_server_sub_index (ipc_server_t *server, ipc_server_cli_t *cli, ipc_server_sub_t *sub)
+{
+    sub->idx.cli  = cli;
+    sub->idx.hash = ipc_server_sub_hash(VSOA_SUB_HASH_INIT, sub->url, sub->len);
+    INSERT_TO_HEADER(&sub->idx, server->subs[sub->idx.hash & VSOA_SUB_HASH_MASK]);
+}
+
+/*
+ * Subscription index delete and free
+ */
+static void ipc_server_sub_delete (ipc_server_t *server, ipc_server_cli_t *cli, ipc_server_sub_t *sub)
+{
+    DELETE_FROM_LIST(&sub->idx, server->subs[sub->idx.hash & VSOA_SUB_HASH_MASK]);
+    DELETE_FROM_LIST(sub, cli->subscribed);
+    free(sub);
+}
+
+/*
+ * Subscription index lookup of `url[0, len)` followed by `tail` (if not 0)
+ */
+static int ipc_server_sub_lookup (ipc_server_t *server, uint32_t hash, const char *url, size_t len, char tail,
+                                  ipc_server_cli_t **clis, int cnt, int max_cnt)
+{
+    size_t sub_len = tail ? len + 1 : len;
+    ipc_server_sidx_t *idx;
+    ipc_server_sub_t *sub;
+
+    LIST_FOREACH(idx, server->subs[hash & VSOA_SUB_HASH_MASK]) {
+        if (cnt >= max_cnt) {
+            break;
+        }
+        if (idx->hash != hash || idx->cli->pub_gen == server->pub_gen || !idx->cli->active) {
+            continue;
+        }
+        sub = (ipc_server_sub_t *)((char *)idx - offsetof(ipc_server_sub_t, idx));
+        if (sub->len != sub_len || memcmp(sub->url, url, len) || (tail && sub->url[len] != tail)) {
+            continue;
+        }
+        idx->cli->pub_gen = server->pub_gen;
+        clis[cnt++] = idx->cli;
+    }
+
+    return  (cnt);
+}
+
+/*
+ * Active clients subscribed to `url` (`server->lock` locked), at most `max_cnt`.
+ * Subscription "/a/" matches "/a" and "/a/...", "/" matches all, others match exactly,
+ * so only the '/' terminated prefixes of `url` and `url` itself are looked up
+ */
+static int ipc_server_sub_match (ipc_server_t *server, const ipc_url_t *url, ipc_server_cli_t **clis, int max_cnt)
+{
+    int cnt = 0;
+    size_t i;
+    uint32_t hash = VSOA_SUB_HASH_INIT;
+
+    server->pub_gen++;
+
+    for (i = 0; i < url->url_len && cnt < max_cnt; i++) {
+        hash = ipc_server_sub_hash(hash, &url->url[i], 1);
+        if (url->url[i] == '/') {
+            cnt = ipc_server_sub_lookup(server, hash, url->url, i + 1, 0, clis, cnt, max_cnt);
+        }
+    }
+
+    if (cnt < max_cnt) {
+        cnt = ipc_server_sub_lookup(server, hash, url->url, url->url_len, 0, clis, cnt, max_cnt);
+        hash = ipc_server_sub_hash(hash, "/", 1);
+        cnt = ipc_server_sub_lookup(server, hash, url->url, url->url_len, '/', clis, cnt, max_cnt);
+    }
+
+    return  (cnt);
+}
+
 /*
  * Destroy a client
  */
@@ -245,19 +563,31 @@ static void ipc_server_cli_destroy (ipc_server_t *server, ipc_server_cli_t *cli)
     ipc_server_sub_t *sub, *sub_temp;
 
     LIST_FOREACH_SAFE(sub, sub_temp, cli->subscribed) {
-        DELETE_FROM_LIST(sub, cli->subscribed);
-        free(sub);
+        ipc_server_sub_delete(server, cli, sub);
     }
 
     DELETE_FROM_LIST(cli, server->clis[hash]);
+    server->ncli--;
 
     if (cli->hst.alive) {
         cli->hst.alive = 0;
         DELETE_FROM_LIST(&cli->hst, server->hst_h);
     }
 
-    close_socket(cli->sock);
-    free(cli);
+    cli->closed = true;
+    if (cli->ep_reg) {
+        vsoa_mutex_lock(&cli->out_lock);
+        ipc_server_cli_ep_del(server, cli);
+        vsoa_mutex_unlock(&cli->out_lock);
+
+        ipc_server_cli_get(cli);
+        cli->ep_gen = server->ep_gen;
+        INSERT_TO_HEADER(cli, server->retired);
+        vsoa_event_pair_signal(server->evtfd[1]);
+    }
+
+    /* Publishers may still hold the client */
+    ipc_server_cli_put(server, cli);
 }
 
 /*
@@ -287,14 +617,73 @@ bool ipc_server_cli_close (ipc_server_t *server, ipc_cli_id_t id)
     return  (ret);
 }
 
+/*
+ * Client is broken, drop its queued output (`out_lock` locked)
+ */
+static void ipc_server_cli_out_broken (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+    cli->out_broken = true;
+    shutdown_socket(cli->sock);
+    ipc_server_cli_out_free(server, cli);
+}
 
 /*
- * Client send
+ * Client output queue flush (`out_lock` locked), a client making no progress
+ * for its send timeout is closed as a blocking send would have been
+ */
+static void ipc_server_cli_out_flush (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+    ssize_t num;
+    ipc_server_out_t *out;
+
+    while ((out = cli->out_h) != NULL) {
+        num = send(cli->sock, &out->data[out->off], out->len - out->off, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (num < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break;
+            }
+            ipc_server_cli_out_broken(server, cli);
+            return;
+        }
+
+        cli->out_since  = vsoa_current_time();
+        cli->out_bytes -= num;
+        out->off       += num;
+        if (out->off < out->len) {
+            break;
+        }
+
+        DELETE_FROM_FIFO(out, cli->out_h, cli->out_t);
+        free(out);
+        if (!cli->out_h) {
+            __atomic_sub_fetch(&server->out_pending, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (cli->out_h && vsoa_current_time() - cli->out_since > cli->out_timeout) {
+        ipc_server_cli_out_broken(server, cli);
+    }
+
+    ipc_server_cli_ep_sync(server, cli);
+}
+
+/*
+ * Client send with file descriptors, never blocks: what the socket does not take
+ * is queued and flushed when writable. `fds` must go with the first byte.
  */
-static bool ipc_server_cli_sendmsg(ipc_server_cli_t *cli, ipc_header_t *ipc_hdr, 
-    const ipc_url_t *url, const ipc_payload_t *payload)
+static bool ipc_server_cli_sendmsg_fds (ipc_server_t *server, ipc_server_cli_t *cli, ipc_header_t *ipc_hdr,
+                                        const ipc_url_t *url, const ipc_payload_t *payload, const int *fds, int nfds)
 {
-    ssize_t len;
+    int i;
+    bool ret = true;
+    ssize_t num;
+    size_t total, sent, skip;
+    uint8_t *copy;
+    ipc_server_out_t *out;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int) * IPC_SHM_FD_NUM)];
+    } cmsg;
     struct iovec iov[4] = {
         {
             .iov_base = (void*)ipc_hdr,
@@ -318,43 +707,114 @@ static bool ipc_server_cli_sendmsg(ipc_server_cli_t *cli, ipc_header_t *ipc_hdr,
         }
     }
 
-    len = sendmsg(cli->sock, &msg, 0); 
+    if (nfds > 0) {
+        msg.msg_control    = cmsg.buf;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        cmsg.hdr.cmsg_level = SOL_SOCKET;
+        cmsg.hdr.cmsg_type  = SCM_RIGHTS;
+        cmsg.hdr.cmsg_len   = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(&cmsg.hdr), fds, sizeof(int) * nfds);
+    }
+
+    for (i = 0, total = 0; i < (int)msg.msg_iovlen; i++) {
+        total += iov[i].iov_len;
+    }
+
+    vsoa_mutex_lock(&cli->out_lock);
 
-    if (len < 0) {
-        shutdown_socket(cli->sock);
-        return false;
+    if (cli->out_h) {
+        ipc_server_cli_out_flush(server, cli);
+    }
+    if (cli->out_broken) {
+        ret = false;
+        goto    out;
+    }
+
+    sent = 0;
+    if (!cli->out_h) {
+        num = sendmsg(cli->sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (num < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                ipc_server_cli_out_broken(server, cli);
+                ret = false;
+                goto    out;
+            }
+            num = 0;
+        }
+        sent = (size_t)num;
+    }
+
+    if (sent < total) {
+        if ((nfds > 0 && !sent) || cli->out_bytes + (total - sent) > VSOA_SERVER_OUTQ_LIMIT) {
+            ipc_server_cli_out_broken(server, cli);
+            ret = false;
+            goto    out;
+        }
+
+        out = (ipc_server_out_t *)malloc(sizeof(ipc_server_out_t) + (total - sent));
+        if (!out) {
+            ret = false;
+            goto    out;
+        }
+
+        out->len = total - sent;
+        out->off = 0;
+        copy = out->data;
+        skip = sent;
+        for (i = 0; i < (int)msg.msg_iovlen; i++) {
+            if (skip >= iov[i].iov_len) {
+                skip -= iov[i].iov_len;
+                continue;
+            }
+            memcpy(copy, (uint8_t *)iov[i].iov_base + skip, iov[i].iov_len - skip);
+            copy += iov[i].iov_len - skip;
+            skip  = 0;
+        }
+
+        if (!cli->out_h) {
+            cli->out_since = vsoa_current_time();
+            __atomic_add_fetch(&server->out_pending, 1, __ATOMIC_RELAXED);
+        }
+        INSERT_TO_FIFO(out, cli->out_h, cli->out_t);
+        cli->out_bytes += out->len;
     }
-    return true;
+
+out:
+    ipc_server_cli_ep_sync(server, cli);
+    vsoa_mutex_unlock(&cli->out_lock);
+
+    return  (ret);
 }
 
 /*
  * Client send
  */
-static bool ipc_server_cli_send (ipc_server_t *server, ipc_server_cli_t *cli, size_t len)
+static bool ipc_server_cli_sendmsg (ipc_server_t *server, ipc_server_cli_t *cli, ipc_header_t *ipc_hdr,
+                                    const ipc_url_t *url, const ipc_payload_t *payload)
 {
-    uint8_t *buffer = (uint8_t *)server->sendbuf;
-    ssize_t num, total = 0;
+    return  (ipc_server_cli_sendmsg_fds(server, cli, ipc_hdr, url, payload, NULL, 0));
+}
 
-    if (len == 0) {
-        if (!ipc_parser_validate_header((ipc_header_t *)server->sendbuf, &len)) {
-            return  (false);
-        }
-        if (len == 0) {
-            return  (true);
-        }
-    }
+/*
+ * Flush clients queued output (`server->lock` locked)
+ */
+static void ipc_server_out_flush_all (ipc_server_t *server, const fd_set *wfds)
+{
+    int i;
+    ipc_server_cli_t *cli;
 
-    do {
-        num = send(cli->sock, &buffer[total], len - total, MSG_NOSIGNAL);
-        if (num > 0) {
-            total += num;
-        } else {
-            shutdown_socket(cli->sock);
-            break;
+    for (i = 0; i < VSOA_CLI_HASH_SIZE; i++) {
+        LIST_FOREACH(cli, server->clis[i]) {
+            if (wfds && !FD_ISSET(cli->sock, wfds)) {
+                continue;
+            }
+            vsoa_mutex_lock(&cli->out_lock);
+            if (cli->out_h) {
+                ipc_server_cli_out_flush(server, cli);
+            }
+            vsoa_mutex_unlock(&cli->out_lock);
         }
-    } while (total < len);
-
-    return  (total == len);
+    }
 }
 
 /*
@@ -400,6 +860,7 @@ ipc_server_t *ipc_server_create (const char *server_info)
     bzero(server, sizeof(ipc_server_t));
 
     server->sock   = -1;
+    server->epfd   = -1;
 
     if (vsoa_mutex_init(&server->lock)) {
         goto    error;
@@ -417,6 +878,8 @@ ipc_server_t *ipc_server_create (const char *server_info)
     }
 
     server->send_timeout = ipc_server_def_send_timeout;
+    server->shm_enable   = true;
+    server->shm_size     = IPC_SHM_DEF_SIZE;
     server->recvbuf      = (uint8_t *)server->sendbuf + IPC_MAX_PACKET_LENGTH;
     server->valid        = true;
 
@@ -571,6 +1034,8 @@ void ipc_server_close (ipc_server_t *server)
     server->valid = false;
     vsoa_memory_barrier();
 
+    ipc_server_ep_unregister(server);
+
     if (server->sock >= 0) {
         close_socket(server->sock);
         server->sock = -1;
@@ -673,6 +1138,7 @@ bool ipc_server_send_timeout (ipc_server_t *server, bool cur_clis, const struct
         for (i = 0; i < VSOA_CLI_HASH_SIZE; i++) {
             LIST_FOREACH(cli, server->clis[i]) {
                 vsoa_socket_sndto(cli->sock, &timeval);
+                cli->out_timeout = ipc_server_timeout_ns(&timeval);
             }
         }
     }
@@ -682,13 +1148,32 @@ bool ipc_server_send_timeout (ipc_server_t *server, bool cur_clis, const struct
     return  (true);
 }
 
+/*
+ * VSOA server shared memory datagram ring
+ */
+bool ipc_server_set_shm (ipc_server_t *server, bool enable, size_t ring_size)
+{
+    if (!server || !server->valid) {
+        return  (false);
+    }
+
+    vsoa_mutex_lock(&server->lock);
+
+    server->shm_enable = enable;
+    server->shm_size   = ring_size ? ring_size : IPC_SHM_DEF_SIZE;
+
+    vsoa_mutex_unlock(&server->lock);
+
+    return  (true);
+}
+
 /*
  * VSOA server is subscribed
  */
 bool ipc_server_is_subscribed (ipc_server_t *server, const ipc_url_t *url)
 {
+    int cnt;
     ipc_server_cli_t *cli;
-    int i;
 
     if (!server || !server->valid) {
         return  (false);
@@ -699,21 +1184,11 @@ bool ipc_server_is_subscribed (ipc_server_t *server, const ipc_url_t *url)
 
     vsoa_mutex_lock(&server->lock);
 
-    for (i = 0; i < VSOA_CLI_HASH_SIZE; i++) {
-        LIST_FOREACH(cli, server->clis[i]) {
-            if (!cli->active) {
-                continue;
-            }
-            if (ipc_server_cli_sub_match(cli, url)) {
-                vsoa_mutex_unlock(&server->lock);
-                return  (true);
-            }
-        }
-    }
+    cnt = ipc_server_sub_match(server, url, &cli, 1);
 
     vsoa_mutex_unlock(&server->lock);
 
-    return  (false);
+    return  (cnt > 0);
 }
 
 /*
@@ -721,10 +1196,10 @@ bool ipc_server_is_subscribed (ipc_server_t *server, const ipc_url_t *url)
  */
 static bool ipc_server_do_publish (ipc_server_t *server, const ipc_url_t *url, const ipc_payload_t *payload)
 {
-    int i;
+    int i, cnt, max_cnt;
     size_t len;
-    ipc_header_t *ipc_hdr;
-    ipc_server_cli_t *cli;
+    ipc_header_t hdr, *ipc_hdr;
+    ipc_server_cli_t *fast[VSOA_PUB_FAST_CLIS], **clis;
 
     if (!server || !server->valid) {
         return  (false);
@@ -733,39 +1208,52 @@ static bool ipc_server_do_publish (ipc_server_t *server, const ipc_url_t *url, c
         return  (false);
     }
 
-    vsoa_mutex_lock(&server->lock);
-
-    ipc_hdr = ipc_parser_init_header(server->sendbuf, IPC_TYPE_PUBLISH, 0, 0);
+    /* Header on stack, concurrent publishers share nothing but the client table */
+    ipc_hdr = ipc_parser_init_header(&hdr, IPC_TYPE_PUBLISH, 0, 0);
 
     if (!ipc_parser_set_url(ipc_hdr, url)) {
-        vsoa_mutex_unlock(&server->lock);
         return  (false);
     }
     if (payload) {
         if (!ipc_parser_set_payload(ipc_hdr, payload)) {
-            vsoa_mutex_unlock(&server->lock);
             return  (false);
         }
     }
 
     if (!ipc_parser_validate_header(ipc_hdr, &len)) {
-        vsoa_mutex_unlock(&server->lock);
         return  (false);
     }
 
-    for (i = 0; i < VSOA_CLI_HASH_SIZE; i++) {
-        LIST_FOREACH(cli, server->clis[i]) {
-            if (!cli->active) {
-                continue;
-            }
-            if (ipc_server_cli_sub_match(cli, url)) {
-                ipc_server_cli_sendmsg(cli, ipc_hdr, url, payload);
-            }
+    /* Only the subscriber lookup holds the lock, sends never block */
+    vsoa_mutex_lock(&server->lock);
+
+    clis    = fast;
+    max_cnt = VSOA_PUB_FAST_CLIS;
+    if (server->ncli > VSOA_PUB_FAST_CLIS) {
+        clis = (ipc_server_cli_t **)malloc(sizeof(ipc_server_cli_t *) * server->ncli);
+        if (clis) {
+            max_cnt = server->ncli;
+        } else {
+            clis = fast;
         }
     }
 
+    cnt = ipc_server_sub_match(server, url, clis, max_cnt);
+    for (i = 0; i < cnt; i++) {
+        ipc_server_cli_get(clis[i]);
+    }
+
     vsoa_mutex_unlock(&server->lock);
 
+    for (i = 0; i < cnt; i++) {
+        ipc_server_cli_sendmsg(server, clis[i], ipc_hdr, url, payload);
+        ipc_server_cli_put(server, clis[i]);
+    }
+
+    if (clis != fast) {
+        free(clis);
+    }
+
     return  (true);
 }
 
@@ -956,33 +1444,36 @@ bool ipc_server_cli_reply (ipc_server_t *server, ipc_cli_id_t id,
 {
     bool ret;
     ipc_server_cli_t *cli;
-    ipc_header_t *ipc_hdr;
+    ipc_header_t hdr, *ipc_hdr;
 
     if (!server || !server->valid) {
         return  (false);
     }
 
-    vsoa_mutex_lock(&server->lock);
-
-    cli = ipc_server_cli_find(server, id);
-    if (!cli) {
-        vsoa_mutex_unlock(&server->lock);
-        return  (false);
-    }
-
-    ipc_hdr = ipc_parser_init_header(server->sendbuf, IPC_TYPE_RPC, status, seqno);
+    ipc_hdr = ipc_parser_init_header(&hdr, IPC_TYPE_RPC, status, seqno);
 
     if (payload) {
         if (!ipc_parser_set_payload(ipc_hdr, payload)) {
-            vsoa_mutex_unlock(&server->lock);
             return  (false);
         }
     }
 
-    ret = ipc_server_cli_sendmsg(cli, ipc_hdr, NULL, payload);
+    vsoa_mutex_lock(&server->lock);
+
+    cli = ipc_server_cli_find(server, id);
+    if (cli) {
+        ipc_server_cli_get(cli);
+    }
 
     vsoa_mutex_unlock(&server->lock);
 
+    if (!cli) {
+        return  (false);
+    }
+
+    ret = ipc_server_cli_sendmsg(server, cli, ipc_hdr, NULL, payload);
+    ipc_server_cli_put(server, cli);
+
     return  (ret);
 }
 
@@ -1081,6 +1572,7 @@ bool ipc_server_cli_send_timeout (ipc_server_t *server, ipc_cli_id_t id, const s
     cli = ipc_server_cli_find(server, id);
     if (cli) {
         vsoa_socket_sndto(cli->sock, &timeval);
+        cli->out_timeout = ipc_server_timeout_ns(&timeval);
     }
 
     vsoa_mutex_unlock(&server->lock);
@@ -1096,7 +1588,7 @@ bool ipc_server_cli_do_datagram (ipc_server_t *server, ipc_cli_id_t id, const ip
     bool ret;
     size_t len;
     ipc_server_cli_t *cli;
-    ipc_header_t *ipc_hdr;
+    ipc_header_t hdr, *ipc_hdr;
 
     if (!server || !server->valid) {
         return  (false);
@@ -1108,35 +1600,36 @@ bool ipc_server_cli_do_datagram (ipc_server_t *server, ipc_cli_id_t id, const ip
         return  (false);
     }
 
-    vsoa_mutex_lock(&server->lock);
-
-    cli = ipc_server_cli_find(server, id);
-    if (!cli) {
-        vsoa_mutex_unlock(&server->lock);
-        return  (false);
-    }
-
-    ipc_hdr = ipc_parser_init_header(server->sendbuf, IPC_TYPE_DATAGRAM, 0, 0);
+    ipc_hdr = ipc_parser_init_header(&hdr, IPC_TYPE_DATAGRAM, 0, 0);
 
     if (!ipc_parser_set_url(ipc_hdr, url)) {
-        vsoa_mutex_unlock(&server->lock);
         return  (false);
     }
 
     if (!ipc_parser_set_payload(ipc_hdr, payload)) {
-        vsoa_mutex_unlock(&server->lock);
         return  (false);
     }
 
     if (!ipc_parser_validate_header(ipc_hdr, &len)) {
-        vsoa_mutex_unlock(&server->lock);
         return  (false);
     }
 
-    ret = ipc_server_cli_sendmsg(cli, ipc_hdr, url, payload);
+    vsoa_mutex_lock(&server->lock);
+
+    cli = ipc_server_cli_find(server, id);
+    if (cli) {
+        ipc_server_cli_get(cli);
+    }
 
     vsoa_mutex_unlock(&server->lock);
 
+    if (!cli) {
+        return  (false);
+    }
+
+    ret = ipc_server_cli_sendmsg(server, cli, ipc_hdr, url, payload);
+    ipc_server_cli_put(server, cli);
+
     return  (ret);
 }
 
@@ -1159,6 +1652,48 @@ void ipc_server_on_datagram (ipc_server_t *server, ipc_server_dat_func_t callbac
     }
 }
 
+/*
+ * VSOA server next record of a batched datagram
+ */
+bool ipc_server_dat_next (ipc_server_t *server, ipc_payload_t *payload)
+{
+    uint32_t len;
+
+    if (!server || !server->dat_pos || server->dat_end - server->dat_pos < IPC_BATCH_REC_HDR) {
+        return  (false);
+    }
+
+    memcpy(&len, server->dat_pos, sizeof(uint32_t));
+    len = ntohl(len);
+    if (len > (size_t)(server->dat_end - server->dat_pos - IPC_BATCH_REC_HDR)) {
+        server->dat_pos = server->dat_end;
+        return  (false);
+    }
+
+    payload->data     = (void *)(server->dat_pos + IPC_BATCH_REC_HDR);
+    payload->data_len = len;
+    server->dat_pos  += IPC_BATCH_REC_HDR + len;
+
+    return  (true);
+}
+
+/*
+ * VSOA server deliver batched datagram records
+ */
+static void ipc_server_dat_batch (ipc_server_t *server, ipc_server_cli_t *cli, ipc_url_t *url, ipc_payload_t *payload)
+{
+    ipc_payload_t record;
+
+    server->dat_pos = (const uint8_t *)payload->data;
+    server->dat_end = server->dat_pos + payload->data_len;
+
+    while (server->valid && ipc_server_dat_next(server, &record)) {
+        server->ondat(server->darg, server, cli->id, url, &record);
+    }
+
+    server->dat_pos = server->dat_end = NULL;
+}
+
 /*
  * VSOA server checking event
  */
@@ -1187,6 +1722,12 @@ int ipc_server_fds (ipc_server_t *server, fd_set *rfds)
             if (max_fd < cli->sock) {
                 max_fd = cli->sock;
             }
+            if (ipc_shm_ring_valid(&cli->shm)) {
+                FD_SET(cli->shm.doorfd, rfds);
+                if (max_fd < cli->shm.doorfd) {
+                    max_fd = cli->shm.doorfd;
+                }
+            }
         }
     }
 
@@ -1226,8 +1767,10 @@ static ipc_server_cmd_t *ipc_server_cmd_match (ipc_server_t *server, const ipc_u
 static bool ipc_server_input (void *arg, ipc_header_t *ipc_hdr)
 {
     bool pass;
+    int memfd, fds[IPC_SHM_FD_NUM], nfds;
     uint8_t status, hs_buf[6];
-    uint16_t seqno, cid;
+    uint16_t seqno;
+    uint32_t servinfo[2], flags;
     struct input_arg *input_arg = arg;
     ipc_server_t *server  = input_arg->server;
     ipc_server_cli_t *cli = input_arg->cli;
@@ -1257,17 +1800,46 @@ static bool ipc_server_input (void *arg, ipc_header_t *ipc_hdr)
         return  (server->valid);
     }
 
+    if (ipc_hdr->type == IPC_TYPE_DATAGRAM_BATCH) {
+        if (server->ondat) {
+            ipc_server_dat_batch(server, cli, &url, &payload);
+        }
+        return  (server->valid);
+    }
+
     vsoa_mutex_lock(&server->lock);
 
     switch (ipc_hdr->type) {
 
     case IPC_TYPE_SERVINFO:
         send_hdr = ipc_parser_init_header(server->sendbuf, ipc_hdr->type, 0, seqno);
-        cid = htonl(cli->id);
-        payload_reply.data = &cid;
-        payload_reply.data_len = sizeof(uint32_t);
+        servinfo[0] = htonl(cli->id);
+        servinfo[1] = htonl(IPC_SERVINFO_CAP_BATCH);
+        payload_reply.data = servinfo;
+        payload_reply.data_len = sizeof(servinfo);
         ipc_parser_set_payload(send_hdr, &payload_reply);
-        ipc_server_cli_sendmsg(cli, send_hdr, NULL, &payload_reply);
+
+        /* Client may request a shared memory datagram ring, its fds ride on the reply */
+        nfds = 0;
+        if (payload.data_len >= sizeof(uint32_t)) {
+            memcpy(&flags, payload.data, sizeof(uint32_t));
+            flags = ntohl(flags);
+        } else {
+            flags = 0;
+        }
+        if ((flags & IPC_SERVINFO_REQ_SHM) && server->shm_enable && !ipc_shm_ring_valid(&cli->shm)) {
+            memfd = ipc_shm_ring_create(&cli->shm, server->shm_size);
+            if (memfd >= 0) {
+                fds[IPC_SHM_FD_MEM]   = memfd;
+                fds[IPC_SHM_FD_DOOR]  = cli->shm.doorfd;
+                fds[IPC_SHM_FD_SPACE] = cli->shm.spacefd;
+                nfds = IPC_SHM_FD_NUM;
+            }
+        }
+        ipc_server_cli_sendmsg_fds(server, cli, send_hdr, NULL, &payload_reply, fds, nfds);
+        if (nfds) {
+            close(fds[IPC_SHM_FD_MEM]);
+        }
         if (cli->hst.alive) {
             cli->hst.alive = 0;
             DELETE_FROM_LIST(&cli->hst, server->hst_h);
@@ -1290,13 +1862,13 @@ static bool ipc_server_input (void *arg, ipc_header_t *ipc_hdr)
                 vsoa_mutex_unlock(&server->lock);
                 callback(arg, server, cli->id, ipc_hdr, &url, &payload);
             } else {
-                ipc_parser_init_header(server->sendbuf, ipc_hdr->type, IPC_STATUS_INVALID_URL, seqno);
-                ipc_server_cli_sendmsg(cli, ipc_hdr, NULL, NULL);
+                send_hdr = ipc_parser_init_header(server->sendbuf, ipc_hdr->type, IPC_STATUS_INVALID_URL, seqno);
+                ipc_server_cli_sendmsg(server, cli, send_hdr, NULL, NULL);
                 vsoa_mutex_unlock(&server->lock);
             }
         } else {
-            ipc_parser_init_header(server->sendbuf, ipc_hdr->type, IPC_STATUS_ARGUMENTS, seqno);
-            ipc_server_cli_sendmsg(cli, ipc_hdr, NULL, NULL);
+            send_hdr = ipc_parser_init_header(server->sendbuf, ipc_hdr->type, IPC_STATUS_ARGUMENTS, seqno);
+            ipc_server_cli_sendmsg(server, cli, send_hdr, NULL, NULL);
             vsoa_mutex_unlock(&server->lock);
         }
         break;
@@ -1318,6 +1890,7 @@ static bool ipc_server_input (void *arg, ipc_header_t *ipc_hdr)
                     memcpy(sub->url, url.url, sub->len);
                     sub->url[sub->len] = '\0';
                     INSERT_TO_HEADER(sub, cli->subscribed);
+                    ipc_server_sub_index(server, cli, sub);
                     status = 0;
                 }
             } else {
@@ -1326,8 +1899,8 @@ static bool ipc_server_input (void *arg, ipc_header_t *ipc_hdr)
         } else {
             status = IPC_STATUS_ARGUMENTS;
         }
-        ipc_parser_init_header(server->sendbuf, ipc_hdr->type, status, seqno);
-        ipc_server_cli_sendmsg(cli, ipc_hdr, NULL, NULL);
+        send_hdr = ipc_parser_init_header(server->sendbuf, ipc_hdr->type, status, seqno);
+        ipc_server_cli_sendmsg(server, cli, send_hdr, NULL, NULL);
         vsoa_mutex_unlock(&server->lock);
         break;
 
@@ -1337,26 +1910,24 @@ static bool ipc_server_input (void *arg, ipc_header_t *ipc_hdr)
                 if (url.url_len != sub->len || memcmp(sub->url, url.url, sub->len)) {
                     continue;
                 }
-                DELETE_FROM_LIST(sub, cli->subscribed);
-                free(sub);
+                ipc_server_sub_delete(server, cli, sub);
                 break;
             }
             status = 0;
         } else {
             LIST_FOREACH_SAFE(sub, sub_temp, cli->subscribed) {
-                DELETE_FROM_LIST(sub, cli->subscribed);
-                free(sub);
+                ipc_server_sub_delete(server, cli, sub);
             }
             status = 0;
         }
-        ipc_parser_init_header(server->sendbuf, ipc_hdr->type, status, seqno);
-        ipc_server_cli_sendmsg(cli, ipc_hdr, NULL, NULL);
+        send_hdr = ipc_parser_init_header(server->sendbuf, ipc_hdr->type, status, seqno);
+        ipc_server_cli_sendmsg(server, cli, send_hdr, NULL, NULL);
         vsoa_mutex_unlock(&server->lock);
         break;
 
     case IPC_TYPE_PINGECHO:
-        ipc_parser_init_header(server->sendbuf, ipc_hdr->type, 0, seqno);
-        ipc_server_cli_sendmsg(cli, ipc_hdr, NULL, NULL);
+        send_hdr = ipc_parser_init_header(server->sendbuf, ipc_hdr->type, 0, seqno);
+        ipc_server_cli_sendmsg(server, cli, send_hdr, NULL, NULL);
         vsoa_mutex_unlock(&server->lock);
         break;
 
@@ -1369,20 +1940,235 @@ static bool ipc_server_input (void *arg, ipc_header_t *ipc_hdr)
 }
 
 /*
- * VSOA server input event
+ * VSOA server shared memory ring packet input, only datagrams use the ring
  */
-void ipc_server_input_fds (ipc_server_t *server, const fd_set *rfds)
+static bool ipc_server_shm_input (void *arg, ipc_header_t *ipc_hdr)
+{
+    if (ipc_hdr->type != IPC_TYPE_DATAGRAM && ipc_hdr->type != IPC_TYPE_DATAGRAM_BATCH) {
+        return  (true);
+    }
+
+    return  (ipc_server_input(arg, ipc_hdr));
+}
+
+/*
+ * Client shared memory ring input
+ */
+static void ipc_server_cli_door_input (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+    struct input_arg input_arg;
+
+    input_arg.server = server;
+    input_arg.cli    = cli;
+
+    if (!ipc_shm_ring_input(&cli->shm, server->recvbuf, ipc_server_shm_input, &input_arg)) {
+        shutdown_socket(cli->sock);
+    }
+}
+
+/*
+ * Client socket input, a lost client is destroyed
+ */
+static void ipc_server_cli_sock_input (ipc_server_t *server, ipc_server_cli_t *cli)
 {
-    int i;
-    int sock;
     ssize_t num;
+    struct input_arg input_arg;
+
+    input_arg.server = server;
+    input_arg.cli    = cli;
+
+    num   = recv(cli->sock, server->recvbuf, IPC_MAX_PACKET_LENGTH, MSG_DONTWAIT);
+    if (num > 0) {
+        ipc_parser_input(&cli->recv, server->recvbuf,
+                            num, ipc_server_input, &input_arg);
+    }
+
+    if (num == 0 || (num < 0 && errno != EWOULDBLOCK)) {
+        /* Datagrams still queued in the ring precede the disconnect */
+        if (ipc_shm_ring_valid(&cli->shm)) {
+            ipc_shm_ring_input(&cli->shm, server->recvbuf, ipc_server_shm_input, &input_arg);
+        }
+
+        if (cli->onconn) {
+            cli->onconn = false;
+            if (server->oncli) {
+                server->oncli(server->carg, server, cli->id, false);
+            }
+        }
+
+        vsoa_mutex_lock(&server->lock);
+
+        ipc_server_cli_destroy(server, cli);
+
+        vsoa_mutex_unlock(&server->lock);
+        return;
+    }
+
+    ipc_server_cli_ep_door(server, cli);
+}
+
+/*
+ * Server event pair input: handshake timeout, queued output flush, retired clients
+ */
+static void ipc_server_evt_input (ipc_server_t *server)
+{
+    ipc_server_cli_t *cli;
+    ipc_server_hst_t *hst, *hst_temp;
+
+    vsoa_event_pair_fetch(server->evtfd[0]);
+
+    vsoa_mutex_lock(&server->lock);
+
+    LIST_FOREACH_SAFE(hst, hst_temp, server->hst_h) {
+        if (hst->alive <= VSOA_SERVER_TIMER_PERIOD) {
+            hst->alive = 0;
+            DELETE_FROM_LIST(hst, server->hst_h);
+
+            cli = (ipc_server_cli_t *)((char *)hst - offsetof(ipc_server_cli_t, hst));
+            shutdown_socket(cli->sock);
+        }
+    }
+
+    /* Periodic flush when the caller does not wait for writable events */
+    if (__atomic_load_n(&server->out_pending, __ATOMIC_RELAXED)) {
+        ipc_server_out_flush_all(server, NULL);
+    }
+
+    if (server->retired) {
+        ipc_server_ep_release(server, false);
+    }
+
+    vsoa_mutex_unlock(&server->lock);
+}
+
+#if defined(VSOA_HAS_EPOLL)
+/*
+ * Client socket epoll event
+ */
+static void ipc_server_ep_cli_sock (ipc_event_handle_t *handle, uint32_t events)
+{
+    ipc_server_cli_t *cli = (ipc_server_cli_t *)((char *)handle - offsetof(ipc_server_cli_t, ev_sock));
+    ipc_server_t *server  = cli->server;
+
+    if (cli->closed || !server->valid) {
+        return;
+    }
+
+    if (events & EPOLLOUT) {
+        vsoa_mutex_lock(&cli->out_lock);
+        if (cli->out_h) {
+            ipc_server_cli_out_flush(server, cli);
+        } else {
+            ipc_server_cli_ep_sync(server, cli);
+        }
+        vsoa_mutex_unlock(&cli->out_lock);
+    }
+
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        ipc_server_cli_sock_input(server, cli);
+    }
+}
+
+/*
+ * Client shared memory doorbell epoll event
+ */
+static void ipc_server_ep_cli_door (ipc_event_handle_t *handle, uint32_t events)
+{
+    ipc_server_cli_t *cli = (ipc_server_cli_t *)((char *)handle - offsetof(ipc_server_cli_t, ev_door));
+
+    (void)events;
+
+    if (cli->closed || !cli->server->valid) {
+        return;
+    }
+
+    ipc_server_cli_door_input(cli->server, cli);
+}
+#endif
+
+/*
+ * Client epoll register (`server->lock` locked)
+ */
+static bool ipc_server_cli_ep_add (ipc_server_t *server, ipc_server_cli_t *cli)
+{
+#if defined(VSOA_HAS_EPOLL)
+    if (server->epfd < 0) {
+        return  (true);
+    }
+
+    cli->server = server;
+    cli->ev_sock.callback = ipc_server_ep_cli_sock;
+    cli->ev_door.callback = ipc_server_ep_cli_door;
+
+    vsoa_mutex_lock(&cli->out_lock);
+    cli->ep_out = cli->out_h != NULL;
+    cli->ep_reg = vsoa_epoll_ctl(server->epfd, EPOLL_CTL_ADD, cli->sock,
+                                 cli->ep_out ? EPOLLIN | EPOLLOUT : EPOLLIN, &cli->ev_sock);
+    vsoa_mutex_unlock(&cli->out_lock);
+
+    if (!cli->ep_reg) {
+        return  (false);
+    }
+
+    ipc_server_cli_ep_door(server, cli);
+#else
+    (void)server;
+    (void)cli;
+#endif
+
+    return  (true);
+}
+
+/*
+ * Accept a new client
+ */
+static void ipc_server_accept (ipc_server_t *server)
+{
+    int sock;
     socklen_t addr_len = sizeof(struct sockaddr_storage);
     struct sockaddr_storage addr;
-    ipc_header_t *ipc_hdr;
-    ipc_cli_id_t id;
+    ipc_server_cli_t *cli;
+
+    sock = accept(server->sock, (struct sockaddr *)&addr, &addr_len);
+    if (sock < 0) {
+        return;
+    }
+
+    cli = (ipc_server_cli_t *)malloc(sizeof(ipc_server_cli_t));
+    if (!cli) {
+        close_socket(sock);
+        return;
+    }
+
+    bzero(cli, sizeof(ipc_server_cli_t));
+    ipc_shm_ring_init(&cli->shm);
+    cli->sock   = sock;
+    cli->active = false;
+    /* TODO: deal with init recv buffer. */
+    ipc_parser_init_recv(&cli->recv);
+    vsoa_socket_sndto(sock, &server->send_timeout);
+
+    if (vsoa_mutex_init(&cli->out_lock)) {
+        free(cli);
+        close_socket(sock);
+        return;
+    }
+
+    vsoa_mutex_lock(&server->lock);
+    ipc_server_cli_init(server, cli);
+    if (!ipc_server_cli_ep_add(server, cli)) {
+        ipc_server_cli_destroy(server, cli);
+    }
+    vsoa_mutex_unlock(&server->lock);
+}
+
+/*
+ * VSOA server input event
+ */
+void ipc_server_input_fds (ipc_server_t *server, const fd_set *rfds)
+{
+    int i;
     ipc_server_cli_t *cli, *cli_temp;
-    ipc_server_hst_t *hst, *hst_temp;
-    struct input_arg input_arg;
 
     if (!server || !server->valid) {
         return;
@@ -1390,72 +2176,176 @@ void ipc_server_input_fds (ipc_server_t *server, const fd_set *rfds)
 
     for (i = 0; i < VSOA_CLI_HASH_SIZE; i++) {
         LIST_FOREACH_SAFE(cli, cli_temp, server->clis[i]) {
+            if (ipc_shm_ring_valid(&cli->shm) && FD_ISSET(cli->shm.doorfd, rfds)) {
+                ipc_server_cli_door_input(server, cli);
+            }
+
             if (FD_ISSET(cli->sock, rfds)) {
-                num   = recv(cli->sock, server->recvbuf, IPC_MAX_PACKET_LENGTH, MSG_DONTWAIT);
-                if (num > 0) {
-                    input_arg.server = server;
-                    input_arg.cli    = cli;
-                    ipc_parser_input(&cli->recv, server->recvbuf,
-                                        num, ipc_server_input, &input_arg);
-                }
+                ipc_server_cli_sock_input(server, cli);
+            }
+        }
+    }
+
+    if (server->sock >= 0 && FD_ISSET(server->sock, rfds)) {
+        ipc_server_accept(server);
+    }
+
+    if (FD_ISSET(server->evtfd[0], rfds)) {
+        ipc_server_evt_input(server);
+    }
+}
+
+/*
+ * VSOA server checking writable event
+ */
+int ipc_server_wfds (ipc_server_t *server, fd_set *wfds)
+{
+    int i, max_fd = -1;
+    ipc_server_cli_t *cli;
 
-                if (num == 0 || (num < 0 && errno != EWOULDBLOCK)) {
-                    if (cli->onconn) {
-                        cli->onconn = false;
-                        if (server->oncli) {
-                            server->oncli(server->carg, server, cli->id, false);
-                        }
-                    }
+    if (!server || !server->valid || server->sock < 0) {
+        return  (-1);
+    }
 
-                    vsoa_mutex_lock(&server->lock);
+    if (!__atomic_load_n(&server->out_pending, __ATOMIC_RELAXED)) {
+        return  (-1);
+    }
 
-                    ipc_server_cli_destroy(server, cli);
+    vsoa_mutex_lock(&server->lock);
 
-                    vsoa_mutex_unlock(&server->lock);
+    for (i = 0; i < VSOA_CLI_HASH_SIZE; i++) {
+        LIST_FOREACH(cli, server->clis[i]) {
+            vsoa_mutex_lock(&cli->out_lock);
+            if (cli->out_h) {
+                FD_SET(cli->sock, wfds);
+                if (max_fd < cli->sock) {
+                    max_fd = cli->sock;
                 }
             }
+            vsoa_mutex_unlock(&cli->out_lock);
         }
     }
 
-    if (server->sock >= 0 && FD_ISSET(server->sock, rfds)) {
-        sock = accept(server->sock, (struct sockaddr *)&addr, &addr_len);
-        if (sock >= 0) {
-            cli = (ipc_server_cli_t *)malloc(sizeof(ipc_server_cli_t));
-            if (cli) {
-                bzero(cli, sizeof(ipc_server_cli_t));
-                cli->sock   = sock;
-                cli->active = false;
-                /* TODO: deal with init recv buffer. */
-                ipc_parser_init_recv(&cli->recv);
-                vsoa_socket_sndto(sock, &server->send_timeout);
-
-                vsoa_mutex_lock(&server->lock);
-                ipc_server_cli_init(server, cli);
-                vsoa_mutex_unlock(&server->lock);
+    vsoa_mutex_unlock(&server->lock);
 
-            } else {
-                close_socket(sock);
-            }
-        }
+    return  (max_fd);
+}
+
+/*
+ * VSOA server output event
+ */
+void ipc_server_output_fds (ipc_server_t *server, const fd_set *wfds)
+{
+    if (!server || !server->valid) {
+        return;
     }
 
-    if (FD_ISSET(server->evtfd[0], rfds)) {
-        vsoa_event_pair_fetch(server->evtfd[0]);
+    vsoa_mutex_lock(&server->lock);
 
-        vsoa_mutex_lock(&server->lock);
+    ipc_server_out_flush_all(server, wfds);
 
-        LIST_FOREACH_SAFE(hst, hst_temp, server->hst_h) {
-            if (hst->alive <= VSOA_SERVER_DEF_HANDSHAKE_TIMEOUT) {
-                hst->alive = 0;
-                DELETE_FROM_LIST(hst, server->hst_h);
+    vsoa_mutex_unlock(&server->lock);
+}
+
+#if defined(VSOA_HAS_EPOLL)
+/*
+ * Server listener epoll event
+ */
+static void ipc_server_ep_sock (ipc_event_handle_t *handle, uint32_t events)
+{
+    ipc_server_t *server = (ipc_server_t *)((char *)handle - offsetof(ipc_server_t, ev_sock));
+
+    (void)events;
+
+    if (server->valid && server->sock >= 0) {
+        ipc_server_accept(server);
+    }
+}
 
-                cli = (ipc_server_cli_t *)((char *)hst - offsetof(ipc_server_cli_t, hst));
-                shutdown_socket(cli->sock);
+/*
+ * Server event pair epoll event
+ */
+static void ipc_server_ep_evt (ipc_event_handle_t *handle, uint32_t events)
+{
+    ipc_server_t *server = (ipc_server_t *)((char *)handle - offsetof(ipc_server_t, ev_evt));
+
+    (void)events;
+
+    if (server->valid) {
+        ipc_server_evt_input(server);
+    }
+}
+#endif
+
+/*
+ * VSOA server register with an epoll instance
+ */
+bool ipc_server_epoll_add (ipc_server_t *server, int epfd)
+{
+#if defined(VSOA_HAS_EPOLL)
+    int i;
+    bool ret = false;
+    ipc_server_cli_t *cli;
+
+    if (!server || !server->valid || server->sock < 0 || epfd < 0) {
+        return  (false);
+    }
+
+    vsoa_mutex_lock(&server->lock);
+
+    if (server->epfd >= 0) {
+        goto    out;
+    }
+
+    server->ev_sock.callback = ipc_server_ep_sock;
+    server->ev_evt.callback  = ipc_server_ep_evt;
+
+    if (!vsoa_epoll_ctl(epfd, EPOLL_CTL_ADD, server->sock, EPOLLIN, &server->ev_sock)) {
+        goto    out;
+    }
+    if (!vsoa_epoll_ctl(epfd, EPOLL_CTL_ADD, server->evtfd[0], EPOLLIN, &server->ev_evt)) {
+        vsoa_epoll_ctl(epfd, EPOLL_CTL_DEL, server->sock, 0, NULL);
+        goto    out;
+    }
+
+    server->epfd = epfd;
+    ret = true;
+
+    for (i = 0; i < VSOA_CLI_HASH_SIZE && ret; i++) {
+        LIST_FOREACH(cli, server->clis[i]) {
+            if (!ipc_server_cli_ep_add(server, cli)) {
+                ipc_server_ep_unregister(server);
+                ret = false;
+                break;
             }
         }
+    }
 
-        vsoa_mutex_unlock(&server->lock);
+out:
+    vsoa_mutex_unlock(&server->lock);
+
+    return  (ret);
+#else
+    (void)server;
+    (void)epfd;
+    return  (false);
+#endif
+}
+
+/*
+ * VSOA server unregister from its epoll instance
+ */
+void ipc_server_epoll_del (ipc_server_t *server)
+{
+    if (!server || !server->valid) {
+        return;
     }
+
+    vsoa_mutex_lock(&server->lock);
+
+    ipc_server_ep_unregister(server);
+
+    vsoa_mutex_unlock(&server->lock);
 }
 
 /*
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2021 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: ipc_shm.c IPC shared memory datagram ring.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include "ipc_shm.h"
+#include "ipc_platform.h"
+
+#if IPC_SHM_SUPPORT
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Ring magic */
+#define IPC_SHM_MAGIC     0x49504353
+
+/* Record: [u32 len][u32 frame len][frame], `len` includes the record header
+ * and is 8 bytes aligned. A pad record fills the tail at wrap around */
+#define IPC_SHM_REC_HDR   8
+#define IPC_SHM_REC_PAD   0x80000000U
+#define IPC_SHM_ALIGN(n)  (((n) + 7) & ~(size_t)7)
+
+/* Cache line */
+#define IPC_SHM_CACHE_LINE  64
+
+/* Shared control block, producer and consumer fields on separate lines */
+struct ipc_shm_ctrl {
+    uint32_t magic;
+    uint32_t size;
+    uint8_t  pad0[IPC_SHM_CACHE_LINE - 8];
+
+    uint64_t head;         // Producer write position
+    uint32_t prod_wait;    // Producer waits on `spacefd`
+    uint8_t  pad1[IPC_SHM_CACHE_LINE - 12];
+
+    uint64_t tail;         // Consumer read position
+    uint32_t cons_sleep;   // Consumer needs a doorbell
+    uint8_t  pad2[IPC_SHM_CACHE_LINE - 12];
+};
+
+/* Mapping length */
+#define IPC_SHM_MAP_LEN(size)  (sizeof(struct ipc_shm_ctrl) + (size))
+
+/*
+ * Ring event signal
+ */
+static void ipc_shm_signal (int fd)
+{
+    uint64_t v = 1;
+
+    while (write(fd, &v, sizeof(v)) < 0 && errno == EINTR);
+}
+
+/*
+ * Ring event fetch
+ */
+static void ipc_shm_fetch (int fd)
+{
+    uint64_t v;
+
+    while (read(fd, &v, sizeof(v)) < 0 && errno == EINTR);
+}
+
+/*
+ * Ring map
+ */
+static bool ipc_shm_ring_map (ipc_shm_ring_t *ring, int memfd, size_t size)
+{
+    void *addr;
+
+    addr = mmap(NULL, IPC_SHM_MAP_LEN(size), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (addr == MAP_FAILED) {
+        return  (false);
+    }
+
+    ring->ctrl = (struct ipc_shm_ctrl *)addr;
+    ring->data = (uint8_t *)addr + sizeof(struct ipc_shm_ctrl);
+    ring->size = size;
+
+    return  (true);
+}
+
+/*
+ * Initialize an unattached ring
+ */
+void ipc_shm_ring_init (ipc_shm_ring_t *ring)
+{
+    ring->ctrl    = NULL;
+    ring->data    = NULL;
+    ring->size    = 0;
+    ring->doorfd  = -1;
+    ring->spacefd = -1;
+}
+
+/*
+ * Create ring (consumer)
+ */
+int ipc_shm_ring_create (ipc_shm_ring_t *ring, size_t size)
+{
+    int memfd;
+
+    ipc_shm_ring_init(ring);
+
+    /* Power of two data size */
+    if (size < IPC_SHM_MIN_SIZE) {
+        size = IPC_SHM_MIN_SIZE;
+    }
+    if (size & (size - 1)) {
+        size = (size_t)1 << (64 - __builtin_clzll(size));
+    }
+
+    memfd = memfd_create("ipc_shm", MFD_CLOEXEC);
+    if (memfd < 0) {
+        return  (-1);
+    }
+    if (ftruncate(memfd, IPC_SHM_MAP_LEN(size))) {
+        goto    error;
+    }
+    if (!ipc_shm_ring_map(ring, memfd, size)) {
+        goto    error;
+    }
+
+    ring->doorfd  = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ring->spacefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ring->doorfd < 0 || ring->spacefd < 0) {
+        goto    error;
+    }
+
+    /* New mapping is zero filled, consumer starts idle */
+    ring->ctrl->size       = (uint32_t)size;
+    ring->ctrl->cons_sleep = 1;
+    __atomic_store_n(&ring->ctrl->magic, IPC_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return  (memfd);
+
+error:
+    close(memfd);
+    ipc_shm_ring_destroy(ring);
+    return  (-1);
+}
+
+/*
+ * Attach ring (producer)
+ */
+bool ipc_shm_ring_attach (ipc_shm_ring_t *ring, int fds[IPC_SHM_FD_NUM])
+{
+    struct stat st;
+    size_t size;
+
+    ipc_shm_ring_init(ring);
+
+    ring->doorfd  = fds[IPC_SHM_FD_DOOR];
+    ring->spacefd = fds[IPC_SHM_FD_SPACE];
+
+    if (fstat(fds[IPC_SHM_FD_MEM], &st) || (size_t)st.st_size <= sizeof(struct ipc_shm_ctrl)) {
+        goto    error;
+    }
+
+    size = (size_t)st.st_size - sizeof(struct ipc_shm_ctrl);
+    if (size < IPC_SHM_MIN_SIZE || (size & (size - 1))) {
+        goto    error;
+    }
+    if (!ipc_shm_ring_map(ring, fds[IPC_SHM_FD_MEM], size)) {
+        goto    error;
+    }
+    if (__atomic_load_n(&ring->ctrl->magic, __ATOMIC_ACQUIRE) != IPC_SHM_MAGIC ||
+        ring->ctrl->size != size) {
+        goto    error;
+    }
+
+    close(fds[IPC_SHM_FD_MEM]);
+    return  (true);
+
+error:
+    close(fds[IPC_SHM_FD_MEM]);
+    ipc_shm_ring_destroy(ring);
+    return  (false);
+}
+
+/*
+ * Unmap ring and close its fds
+ */
+void ipc_shm_ring_destroy (ipc_shm_ring_t *ring)
+{
+    if (ring->ctrl) {
+        munmap(ring->ctrl, IPC_SHM_MAP_LEN(ring->size));
+    }
+    if (ring->doorfd >= 0) {
+        close(ring->doorfd);
+    }
+    if (ring->spacefd >= 0) {
+        close(ring->spacefd);
+    }
+
+    ipc_shm_ring_init(ring);
+}
+
+/*
+ * Ring free space check, a record may not wrap so the tail gap counts as used
+ */
+static bool ipc_shm_ring_fits (ipc_shm_ring_t *ring, uint64_t head, size_t rec_len)
+{
+    uint64_t tail = __atomic_load_n(&ring->ctrl->tail, __ATOMIC_ACQUIRE);
+    size_t   off  = (size_t)head & (ring->size - 1);
+    size_t   need = rec_len;
+
+    if (ring->size - off < rec_len) {
+        need += ring->size - off;
+    }
+
+    return  (ring->size - (size_t)(head - tail) >= need);
+}
+
+/*
+ * Wait ring free space
+ */
+static bool ipc_shm_ring_wait (ipc_shm_ring_t *ring, uint64_t head, size_t rec_len, const struct timeval *timeout)
+{
+    struct ipc_shm_ctrl *ctrl = ring->ctrl;
+    struct pollfd pfd;
+    int64_t deadline, now;
+    int ms;
+
+    deadline = vsoa_current_time() + (int64_t)timeout->tv_sec * 1000000000 + (int64_t)timeout->tv_usec * 1000;
+
+    for (;;) {
+        /* Announce waiting before the final check, the consumer checks after moving tail */
+        __atomic_store_n(&ctrl->prod_wait, 1, __ATOMIC_SEQ_CST);
+        if (ipc_shm_ring_fits(ring, head, rec_len)) {
+            __atomic_store_n(&ctrl->prod_wait, 0, __ATOMIC_RELAXED);
+            return  (true);
+        }
+
+        now = vsoa_current_time();
+        if (now >= deadline) {
+            __atomic_store_n(&ctrl->prod_wait, 0, __ATOMIC_RELAXED);
+            return  (false);
+        }
+
+        ms = (int)((deadline - now + 999999) / 1000000);
+        pfd.fd      = ring->spacefd;
+        pfd.events  = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, ms) > 0) {
+            ipc_shm_fetch(ring->spacefd);
+        }
+    }
+}
+
+/*
+ * Write a packet (producer)
+ */
+bool ipc_shm_ring_write (ipc_shm_ring_t *ring, const ipc_header_t *ipc_hdr,
+                          const ipc_url_t *url, const ipc_payload_t *payload, const struct timeval *timeout)
+{
+    struct ipc_shm_ctrl *ctrl = ring->ctrl;
+    uint64_t head = __atomic_load_n(&ctrl->head, __ATOMIC_RELAXED);
+    size_t url_len   = url ? url->url_len : 0;
+    size_t data_len  = payload ? payload->data_len : 0;
+    size_t frame_len = IPC_HDR_LENGTH + url_len + data_len;
+    size_t rec_len   = IPC_SHM_ALIGN(IPC_SHM_REC_HDR + frame_len);
+    size_t off, gap;
+    uint8_t *rec;
+
+    if (frame_len > IPC_MAX_PACKET_LENGTH) {
+        return  (false);
+    }
+
+    if (!ipc_shm_ring_fits(ring, head, rec_len) &&
+        !ipc_shm_ring_wait(ring, head, rec_len, timeout)) {
+        return  (false);
+    }
+
+    off = (size_t)head & (ring->size - 1);
+    gap = ring->size - off;
+    if (gap < rec_len) {
+        *(uint32_t *)(ring->data + off) = IPC_SHM_REC_PAD | (uint32_t)gap;
+        head += gap;
+        off   = 0;
+    }
+
+    rec = ring->data + off;
+    ((uint32_t *)rec)[0] = (uint32_t)rec_len;
+    ((uint32_t *)rec)[1] = (uint32_t)frame_len;
+    rec += IPC_SHM_REC_HDR;
+    memcpy(rec, ipc_hdr, IPC_HDR_LENGTH);
+    rec += IPC_HDR_LENGTH;
+    if (url_len) {
+        memcpy(rec, url->url, url_len);
+        rec += url_len;
+    }
+    if (data_len) {
+        memcpy(rec, payload->data, data_len);
+    }
+
+    /* Publish, then ring the doorbell only if the consumer went idle */
+    __atomic_store_n(&ctrl->head, head + rec_len, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ctrl->cons_sleep, __ATOMIC_SEQ_CST) &&
+        __atomic_exchange_n(&ctrl->cons_sleep, 0, __ATOMIC_SEQ_CST)) {
+        ipc_shm_signal(ring->doorfd);
+    }
+
+    return  (true);
+}
+
+/*
+ * Dispatch all queued packets (consumer)
+ */
+bool ipc_shm_ring_input (ipc_shm_ring_t *ring, void *buf, vsoa_input_callback_t callback, void *arg)
+{
+    struct ipc_shm_ctrl *ctrl = ring->ctrl;
+    uint64_t head, tail, start;
+    uint32_t rec_len, frame_len;
+    size_t off, total_len;
+    ipc_header_t *ipc_hdr;
+
+    ipc_shm_fetch(ring->doorfd);
+
+    tail  = __atomic_load_n(&ctrl->tail, __ATOMIC_RELAXED);
+    start = tail;
+
+    for (;;) {
+        /* One ring worth per call, a busy producer must not starve other clients */
+        if (tail - start >= ring->size) {
+            ipc_shm_signal(ring->doorfd);
+            break;
+        }
+
+        head = __atomic_load_n(&ctrl->head, __ATOMIC_ACQUIRE);
+        if (head - tail > ring->size) {
+            return  (false);
+        }
+
+        while (tail != head) {
+            off     = (size_t)tail & (ring->size - 1);
+            rec_len = ((uint32_t *)(ring->data + off))[0];
+
+            ipc_hdr = NULL;
+            if (rec_len & IPC_SHM_REC_PAD) {
+                rec_len &= ~IPC_SHM_REC_PAD;
+                if (rec_len != ring->size - off || rec_len > head - tail) {
+                    return  (false);
+                }
+
+            } else {
+                frame_len = ((uint32_t *)(ring->data + off))[1];
+                if ((rec_len & 7) || rec_len > ring->size - off || rec_len > head - tail ||
+                    frame_len < IPC_HDR_LENGTH || frame_len > IPC_MAX_PACKET_LENGTH ||
+                    IPC_SHM_REC_HDR + (size_t)frame_len > rec_len) {
+                    return  (false);
+                }
+
+                /* Validate a private copy, the producer can still write the mapping */
+                ipc_hdr = (ipc_header_t *)buf;
+                memcpy(ipc_hdr, ring->data + off + IPC_SHM_REC_HDR, frame_len);
+                if (!ipc_parser_validate_header(ipc_hdr, &total_len) || total_len != frame_len) {
+                    return  (false);
+                }
+            }
+
+            tail += rec_len;
+            __atomic_store_n(&ctrl->tail, tail, __ATOMIC_SEQ_CST);
+
+            /* Callback returns false when the consumer is going away */
+            if (ipc_hdr && !callback(arg, ipc_hdr)) {
+                return  (true);
+            }
+        }
+
+        /* Wake a producer waiting for space */
+        if (__atomic_load_n(&ctrl->prod_wait, __ATOMIC_SEQ_CST) &&
+            __atomic_exchange_n(&ctrl->prod_wait, 0, __ATOMIC_SEQ_CST)) {
+            ipc_shm_signal(ring->spacefd);
+        }
+
+        /* Go idle, recheck for a producer that missed the flag */
+        __atomic_store_n(&ctrl->cons_sleep, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ctrl->head, __ATOMIC_SEQ_CST) == tail) {
+            break;
+        }
+        __atomic_store_n(&ctrl->cons_sleep, 0, __ATOMIC_RELAXED);
+    }
+
+    return  (true);
+}
+
+#else /* IPC_SHM_SUPPORT */
+
+void ipc_shm_ring_init (ipc_shm_ring_t *ring)
+{
+    ring->ctrl    = NULL;
+    ring->data    = NULL;
+    ring->size    = 0;
+    ring->doorfd  = -1;
+    ring->spacefd = -1;
+}
+
+int ipc_shm_ring_create (ipc_shm_ring_t *ring, size_t size)
+{
+    ipc_shm_ring_init(ring);
+    return  (-1);
+}
+
+bool ipc_shm_ring_attach (ipc_shm_ring_t *ring, int fds[IPC_SHM_FD_NUM])
+{
+    int i;
+
+    for (i = 0; i < IPC_SHM_FD_NUM; i++) {
+        close(fds[i]);
+    }
+    ipc_shm_ring_init(ring);
+    return  (false);
+}
+
+void ipc_shm_ring_destroy (ipc_shm_ring_t *ring)
+{
+    ipc_shm_ring_init(ring);
+}
+
+bool ipc_shm_ring_write (ipc_shm_ring_t *ring, const ipc_header_t *ipc_hdr,
+                          const ipc_url_t *url, const ipc_payload_t *payload, const struct timeval *timeout)
+{
+    return  (false);
+}
+
+bool ipc_shm_ring_input (ipc_shm_ring_t *ring, void *buf, vsoa_input_callback_t callback, void *arg)
+{
+    return  (true);
+}
+
+#endif /* IPC_SHM_SUPPORT */
+/*
+ * end
+ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2021 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: ipc_shm.h IPC shared memory datagram ring.
+ *
+ */
+
+#ifndef IPC_SHM_H
+#define IPC_SHM_H
+
+#include <sys/time.h>
+#include "ipc_parser.h"
+
+/* Shared memory ring needs memfd, eventfd and SCM_RIGHTS */
+#if defined(__linux__)
+#define IPC_SHM_SUPPORT  1
+#endif
+
+/* Default ring data size, the minimum holds two max packets */
+#define IPC_SHM_DEF_SIZE  (1024 * 1024)
+#define IPC_SHM_MIN_SIZE  (IPC_MAX_PACKET_LENGTH * 2)
+
+/* Ring file descriptors passed to the client */
+#define IPC_SHM_FD_MEM    0
+#define IPC_SHM_FD_DOOR   1
+#define IPC_SHM_FD_SPACE  2
+#define IPC_SHM_FD_NUM    3
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Shared control block */
+struct ipc_shm_ctrl;
+
+/* Single producer (client) single consumer (server) ring.
+ * `doorfd` wakes the consumer and is only signaled when it went idle,
+ * `spacefd` wakes a producer waiting for free space */
+typedef struct {
+    struct ipc_shm_ctrl *ctrl;
+    uint8_t *data;
+    size_t size;
+    int doorfd;
+    int spacefd;
+} ipc_shm_ring_t;
+
+/* Initialize an unattached ring */
+void ipc_shm_ring_init(ipc_shm_ring_t *ring);
+
+/* Create ring (consumer), returns the memory fd to pass to the producer or -1,
+ * the caller closes it once sent */
+int ipc_shm_ring_create(ipc_shm_ring_t *ring, size_t size);
+
+/* Attach ring (producer), takes ownership of `fds` even on failure */
+bool ipc_shm_ring_attach(ipc_shm_ring_t *ring, int fds[IPC_SHM_FD_NUM]);
+
+/* Unmap ring and close its fds */
+void ipc_shm_ring_destroy(ipc_shm_ring_t *ring);
+
+/* Ring is attached */
+#define ipc_shm_ring_valid(ring)  ((ring)->ctrl != NULL)
+
+/* Write a packet (producer), waits up to `timeout` for free space */
+bool ipc_shm_ring_write(ipc_shm_ring_t *ring, const ipc_header_t *ipc_hdr,
+                         const ipc_url_t *url, const ipc_payload_t *payload, const struct timeval *timeout);
+
+/* Dispatch all queued packets (consumer) through `buf` of IPC_MAX_PACKET_LENGTH bytes,
+ * false if the ring is corrupted */
+bool ipc_shm_ring_input(ipc_shm_ring_t *ring, void *buf, vsoa_input_callback_t callback, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IPC_SHM_H */
+/*
+ * end
+ */
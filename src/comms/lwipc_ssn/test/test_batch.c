@@ -0,0 +1,549 @@
+/*
+ * Copyright (c) 2021 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: test_batch.c IPC client datagram batching test.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../ipc_server.h"
+#include "../ipc_client.h"
+#include "../ipc_platform.h"
+
+#define TEST_SERVER_PATH    "/tmp/test_ipc_batch.sock"
+#define TEST_URL_A          "/batch/a"
+#define TEST_URL_B          "/batch/b"
+#define TEST_DATAGRAM_NUM   2000
+#define TEST_LEGACY_NUM     200
+
+/* Server datagram check state */
+typedef struct {
+    bool iterate;           /* Callback takes the remaining records with ipc_server_dat_next */
+    volatile int received;
+    int calls;
+    int errors;
+} test_dat_stat_t;
+
+/* Legacy server state */
+typedef struct {
+    int listen_fd;
+    volatile int datagrams;
+    volatile int batches;
+    int errors;
+    volatile bool done;
+} test_legacy_t;
+
+static volatile bool server_running;
+
+/*
+ * Record `seq` goes to URL A or B in runs, so batches are split on URL changes
+ */
+static const char *test_url (int seq)
+{
+    return  ((seq / 100) % 3 == 2 ? TEST_URL_B : TEST_URL_A);
+}
+
+/*
+ * Record payload: sequence number then `seq % 13` filler bytes
+ */
+static size_t test_fill (uint8_t *buf, int seq)
+{
+    size_t len = sizeof(int) + seq % 13;
+
+    memcpy(buf, &seq, sizeof(int));
+    memset(buf + sizeof(int), seq & 0xff, len - sizeof(int));
+    return  (len);
+}
+
+/*
+ * Check record `seq`
+ */
+static bool test_check (const ipc_url_t *url, const ipc_payload_t *payload, int seq)
+{
+    const char *expect = test_url(seq);
+    const uint8_t *buf = (const uint8_t *)payload->data;
+    size_t i;
+    int val;
+
+    if (url->url_len != strlen(expect) || memcmp(url->url, expect, url->url_len)) {
+        return  (false);
+    }
+    if (payload->data_len != sizeof(int) + seq % 13) {
+        return  (false);
+    }
+    memcpy(&val, buf, sizeof(int));
+    if (val != seq) {
+        return  (false);
+    }
+    for (i = sizeof(int); i < payload->data_len; i++) {
+        if (buf[i] != (seq & 0xff)) {
+            return  (false);
+        }
+    }
+    return  (true);
+}
+
+/*
+ * Server datagram callback
+ */
+static void server_on_datagram (void *arg, ipc_server_t *server, ipc_cli_id_t id,
+                                ipc_url_t *url, ipc_payload_t *payload)
+{
+    test_dat_stat_t *stat = (test_dat_stat_t *)arg;
+    ipc_payload_t record;
+    int received = stat->received;
+
+    stat->calls++;
+    if (!test_check(url, payload, received)) {
+        stat->errors++;
+    }
+    received++;
+
+    if (stat->iterate) {
+        while (ipc_server_dat_next(server, &record)) {
+            if (!test_check(url, &record, received)) {
+                stat->errors++;
+            }
+            received++;
+        }
+    }
+    stat->received = received;
+}
+
+/*
+ * Server event thread
+ */
+static void *server_thread (void *arg)
+{
+    ipc_server_t *server = (ipc_server_t *)arg;
+    struct timespec timeout = { 0, 10000000 };
+    fd_set fds;
+    int max_fd;
+
+    while (server_running) {
+        FD_ZERO(&fds);
+        max_fd = ipc_server_fds(server, &fds);
+        if (pselect(max_fd + 1, &fds, NULL, NULL, &timeout, NULL) > 0) {
+            ipc_server_input_fds(server, &fds);
+        }
+    }
+    return  (NULL);
+}
+
+/*
+ * Send records [from, to)
+ */
+static int send_records (ipc_client_t *client, int from, int to)
+{
+    uint8_t buf[64];
+    ipc_url_t url;
+    ipc_payload_t payload;
+    int i, fail = 0;
+
+    for (i = from; i < to; i++) {
+        url.url          = (char *)test_url(i);
+        url.url_len      = strlen(url.url);
+        payload.data     = buf;
+        payload.data_len = test_fill(buf, i);
+        if (!ipc_client_datagram(client, &url, &payload)) {
+            fail++;
+        }
+    }
+    return  (fail);
+}
+
+/*
+ * Wait until `count` records are received
+ */
+static void wait_received (test_dat_stat_t *stat, int count, int64_t timeout_ns)
+{
+    int64_t deadline = vsoa_current_time() + timeout_ns;
+
+    while (stat->received < count && vsoa_current_time() < deadline) {
+        usleep(1000);
+    }
+}
+
+/*
+ * Batched records reach the server callback in order, by iterating or one call per record,
+ * and a pending batch is flushed by its deadline without an explicit flush
+ */
+static bool test_batch_records (bool iterate)
+{
+    ipc_server_t *server;
+    ipc_client_t *client;
+    test_dat_stat_t stat;
+    struct timespec timeout = { 1, 0 };
+    pthread_t tid;
+    int64_t start, deadline_ns;
+    int fail, tail_num;
+    bool ret = false;
+
+    printf("\n=== Testing Batch Records (%s) ===\n", iterate ? "iterator" : "per record");
+
+    memset(&stat, 0, sizeof(stat));
+    stat.iterate = iterate;
+
+    unlink(TEST_SERVER_PATH);
+    server = ipc_server_create("test_batch");
+    ipc_server_on_datagram(server, server_on_datagram, &stat);
+    if (!ipc_server_start(server, TEST_SERVER_PATH)) {
+        printf("Batch records test FAILED (server start)\n");
+        ipc_server_close(server);
+        return  (false);
+    }
+    server_running = true;
+    pthread_create(&tid, NULL, server_thread, server);
+
+    client = ipc_client_create(NULL, NULL);
+    if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+        printf("Batch records test FAILED (connect)\n");
+        goto    out;
+    }
+
+    /* Size threshold and explicit flush, the deadline is far away */
+    ipc_client_batch(client, 4096, 10000000);
+    fail = send_records(client, 0, TEST_DATAGRAM_NUM);
+    if (!ipc_client_flush(client)) {
+        fail++;
+    }
+    wait_received(&stat, TEST_DATAGRAM_NUM, 5000000000LL);
+
+    /* A short deadline flushes a partial batch by itself */
+    ipc_client_batch(client, 4096, 20000);
+    tail_num = 10;
+    start = vsoa_current_time();
+    fail += send_records(client, TEST_DATAGRAM_NUM, TEST_DATAGRAM_NUM + tail_num);
+    wait_received(&stat, TEST_DATAGRAM_NUM + tail_num, 2000000000LL);
+    deadline_ns = vsoa_current_time() - start;
+
+    printf("sent=%d failed=%d received=%d calls=%d errors=%d deadline_flush=%lld ms\n",
+           TEST_DATAGRAM_NUM + tail_num, fail, stat.received, stat.calls, stat.errors,
+           (long long)(deadline_ns / 1000000));
+
+    ret = fail == 0 && stat.errors == 0 && stat.received == TEST_DATAGRAM_NUM + tail_num &&
+          deadline_ns >= 15000000LL && deadline_ns < 1000000000LL &&
+          (iterate ? stat.calls < stat.received / 10 : stat.calls == stat.received);
+
+out:
+    printf("Batch records test %s\n", ret ? "PASSED" : "FAILED");
+
+    ipc_client_close(client);
+    server_running = false;
+    pthread_join(tid, NULL);
+    ipc_server_close(server);
+    unlink(TEST_SERVER_PATH);
+    return  (ret);
+}
+
+/*
+ * Batch drop callback
+ */
+static void client_on_drop (void *arg, ipc_client_t *client)
+{
+    (*(volatile int *)arg)++;
+}
+
+/*
+ * Wait until `count` drops are reported
+ */
+static void wait_dropped (volatile int *drops, int count, int64_t timeout_ns)
+{
+    int64_t deadline = vsoa_current_time() + timeout_ns;
+
+    while (*drops < count && vsoa_current_time() < deadline) {
+        usleep(1000);
+    }
+}
+
+/*
+ * A batch lost by a failed deadline flush, a failed explicit flush or a reconnect
+ * is reported through the drop callback, and later batches still go through
+ */
+static bool test_batch_drop (void)
+{
+    ipc_server_t *server;
+    ipc_client_t *client;
+    test_dat_stat_t stat;
+    struct timespec timeout = { 1, 0 };
+    pthread_t tid;
+    volatile int drops = 0;
+    int fail = 0, deadline_drops = -1, flush_drops = -1, connect_drops = -1;
+    bool flushed = true, ret = false;
+
+    printf("\n=== Testing Batch Drop ===\n");
+
+    memset(&stat, 0, sizeof(stat));
+
+    unlink(TEST_SERVER_PATH);
+    server = ipc_server_create("test_batch");
+    ipc_server_on_datagram(server, server_on_datagram, &stat);
+    if (!ipc_server_start(server, TEST_SERVER_PATH)) {
+        printf("Batch drop test FAILED (server start)\n");
+        ipc_server_close(server);
+        return  (false);
+    }
+    server_running = true;
+    pthread_create(&tid, NULL, server_thread, server);
+
+    client = ipc_client_create(NULL, NULL);
+    ipc_client_set_on_batch_drop(client, client_on_drop, (void *)&drops);
+
+    /* The deadline flush finds the link down */
+    if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+        printf("Batch drop test FAILED (connect)\n");
+        goto    out;
+    }
+    ipc_client_batch(client, 4096, 50000);
+    fail += send_records(client, 0, 5);
+    ipc_client_disconnect(client);
+    wait_dropped(&drops, 1, 2000000000LL);
+    deadline_drops = drops;
+
+    /* An explicit flush finds the link down */
+    if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+        printf("Batch drop test FAILED (reconnect)\n");
+        goto    out;
+    }
+    ipc_client_batch(client, 4096, 10000000);
+    fail += send_records(client, 0, 5);
+    ipc_client_disconnect(client);
+    flushed = ipc_client_flush(client);
+    flush_drops = drops;
+
+    /* Reconnecting discards the pending batch */
+    if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+        printf("Batch drop test FAILED (reconnect)\n");
+        goto    out;
+    }
+    fail += send_records(client, 0, 5);
+    if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+        printf("Batch drop test FAILED (reconnect)\n");
+        goto    out;
+    }
+    connect_drops = drops;
+
+    /* Nothing was delivered, the next batch starts from the first record */
+    fail += send_records(client, 0, 3);
+    if (!ipc_client_flush(client)) {
+        fail++;
+    }
+    wait_received(&stat, 3, 2000000000LL);
+
+    printf("failed=%d drops=%d/%d/%d received=%d errors=%d\n",
+           fail, deadline_drops, flush_drops, connect_drops, stat.received, stat.errors);
+
+    ret = fail == 0 && deadline_drops == 1 && !flushed && flush_drops == 2 && connect_drops == 3 &&
+          drops == 3 && stat.received == 3 && stat.errors == 0;
+
+out:
+    printf("Batch drop test %s\n", ret ? "PASSED" : "FAILED");
+
+    ipc_client_close(client);
+    server_running = false;
+    pthread_join(tid, NULL);
+    ipc_server_close(server);
+    unlink(TEST_SERVER_PATH);
+    return  (ret);
+}
+
+/*
+ * Legacy server frame input
+ */
+static bool legacy_input (void *arg, ipc_header_t *ipc_hdr)
+{
+    test_legacy_t *legacy = (test_legacy_t *)arg;
+    ipc_url_t url;
+    ipc_payload_t payload;
+
+    if (ipc_hdr->type == IPC_TYPE_DATAGRAM_BATCH) {
+        legacy->batches++;
+        return  (true);
+    }
+    if (ipc_hdr->type != IPC_TYPE_DATAGRAM) {
+        return  (true);
+    }
+    if (!ipc_parser_get_url(ipc_hdr, &url) || !ipc_parser_get_payload(ipc_hdr, &payload) ||
+        !test_check(&url, &payload, legacy->datagrams)) {
+        legacy->errors++;
+    }
+    legacy->datagrams++;
+    return  (true);
+}
+
+/*
+ * Legacy server handshake input
+ */
+static bool legacy_servinfo (void *arg, ipc_header_t *ipc_hdr)
+{
+    *(bool *)arg = ipc_hdr->type == IPC_TYPE_SERVINFO;
+    return  (true);
+}
+
+/*
+ * A server from before batching: the service info reply carries only the client id
+ */
+static void *legacy_thread (void *arg)
+{
+    test_legacy_t *legacy = (test_legacy_t *)arg;
+    ipc_recv_t *recv;
+    ipc_header_t *ipc_hdr;
+    ipc_payload_t payload;
+    uint8_t *buf;
+    uint32_t cid = htonl(1);
+    struct timeval tv = { 0, 10000 };
+    bool servinfo = false;
+    size_t len;
+    ssize_t num;
+    int fd;
+
+    recv = malloc(sizeof(ipc_recv_t));
+    buf  = malloc(IPC_MAX_PACKET_LENGTH);
+    ipc_parser_init_recv(recv);
+
+    /* The listener has a receive timeout, accept gives up if the client never comes */
+    fd = accept(legacy->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        legacy->errors++;
+        goto    out;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    while (!servinfo && !legacy->done) {
+        num = read(fd, buf, IPC_MAX_PACKET_LENGTH);
+        if (num > 0 && !ipc_parser_input(recv, buf, num, legacy_servinfo, &servinfo)) {
+            legacy->errors++;
+            break;
+        }
+    }
+
+    ipc_hdr = ipc_parser_init_header(buf, IPC_TYPE_SERVINFO, 0, 0);
+    memcpy(buf + IPC_HDR_LENGTH, &cid, sizeof(cid));
+    payload.data     = buf + IPC_HDR_LENGTH;
+    payload.data_len = sizeof(cid);
+    ipc_parser_set_payload(ipc_hdr, &payload);
+    ipc_parser_validate_header(ipc_hdr, &len);
+    if (write(fd, buf, len) != (ssize_t)len) {
+        legacy->errors++;
+    }
+
+    while (!legacy->done) {
+        num = read(fd, buf, IPC_MAX_PACKET_LENGTH);
+        if (num == 0) {
+            break;
+        }
+        if (num > 0 && !ipc_parser_input(recv, buf, num, legacy_input, legacy)) {
+            legacy->errors++;
+            break;
+        }
+    }
+    close(fd);
+
+out:
+    free(recv);
+    free(buf);
+    return  (NULL);
+}
+
+/*
+ * A batching client talking to a server without IPC_SERVINFO_CAP_BATCH sends plain datagrams
+ */
+static bool test_legacy_server (void)
+{
+    test_legacy_t legacy;
+    ipc_client_t *client;
+    struct sockaddr_un addr;
+    struct timespec timeout = { 1, 0 };
+    struct timeval accept_timeout = { 2, 0 };
+    pthread_t tid;
+    int64_t deadline;
+    int fail = 0;
+    bool ret = false;
+
+    printf("\n=== Testing Server Without Batch Support ===\n");
+
+    memset(&legacy, 0, sizeof(legacy));
+    unlink(TEST_SERVER_PATH);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, TEST_SERVER_PATH);
+    legacy.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (legacy.listen_fd < 0 || bind(legacy.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(legacy.listen_fd, 1)) {
+        printf("Legacy server test FAILED (listen)\n");
+        return  (false);
+    }
+    setsockopt(legacy.listen_fd, SOL_SOCKET, SO_RCVTIMEO, &accept_timeout, sizeof(accept_timeout));
+    pthread_create(&tid, NULL, legacy_thread, &legacy);
+
+    client = ipc_client_create(NULL, NULL);
+    if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+        printf("Legacy server test FAILED (connect)\n");
+        fail++;
+    } else {
+        ipc_client_batch(client, 4096, 10000000);
+        fail += send_records(client, 0, TEST_LEGACY_NUM);
+        if (!ipc_client_flush(client)) {
+            fail++;
+        }
+
+        deadline = vsoa_current_time() + 5000000000LL;
+        while (legacy.datagrams < TEST_LEGACY_NUM && vsoa_current_time() < deadline) {
+            usleep(1000);
+        }
+    }
+
+    legacy.done = true;
+    ipc_client_close(client);
+    pthread_join(tid, NULL);
+    close(legacy.listen_fd);
+    unlink(TEST_SERVER_PATH);
+
+    printf("sent=%d failed=%d datagrams=%d batches=%d errors=%d\n",
+           TEST_LEGACY_NUM, fail, legacy.datagrams, legacy.batches, legacy.errors);
+
+    ret = fail == 0 && legacy.datagrams == TEST_LEGACY_NUM && legacy.batches == 0 && legacy.errors == 0;
+    printf("Legacy server test %s\n", ret ? "PASSED" : "FAILED");
+    return  (ret);
+}
+
+int main (int argc, char **argv)
+{
+    bool iterate_passed, record_passed, drop_passed, legacy_passed;
+
+    printf("IPC Datagram Batch Test\n");
+    printf("=======================\n");
+
+    iterate_passed = test_batch_records(true);
+    record_passed  = test_batch_records(false);
+    drop_passed    = test_batch_drop();
+    legacy_passed  = test_legacy_server();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Batch iterator test: %s\n", iterate_passed ? "PASSED" : "FAILED");
+    printf("Batch per record test: %s\n", record_passed ? "PASSED" : "FAILED");
+    printf("Batch drop test: %s\n", drop_passed ? "PASSED" : "FAILED");
+    printf("Legacy server test: %s\n", legacy_passed ? "PASSED" : "FAILED");
+
+    if (iterate_passed && record_passed && drop_passed && legacy_passed) {
+        printf("\nAll tests PASSED!\n");
+        return  (0);
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return  (1);
+    }
+}
+/*
+ * end
+ */
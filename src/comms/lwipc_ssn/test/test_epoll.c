@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2021 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: test_epoll.c IPC epoll integration test.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include "../ipc_server.h"
+#include "../ipc_client.h"
+#include "../ipc_platform.h"
+
+#define TEST_SERVER_PATH    "/tmp/test_ipc_epoll.sock"
+#define TEST_URL            "/epoll/data"
+#define TEST_CHURN_NUM      300
+#define TEST_RETIRE_NUM     200
+#define TEST_RETIRE_DATS    8
+#define TEST_RECONNECT_NUM  50
+#define TEST_MAX_EVENTS     64
+
+/* Caller owned epoll reactor */
+typedef struct {
+    int epfd;
+    volatile bool running;
+    volatile bool pause;    /* Set to hold the reactor between waits */
+    volatile bool idle;     /* Reactor is holding */
+    pthread_t tid;
+} test_reactor_t;
+
+/* Server side counters */
+typedef struct {
+    volatile int connects;
+    volatile int losts;
+    volatile int datagrams;
+} test_srv_stat_t;
+
+/* Client side counters */
+typedef struct {
+    volatile int messages;
+    int errors;
+} test_cli_stat_t;
+
+/*
+ * Reactor thread, dispatches every ready event to its handle
+ */
+static void *reactor_thread (void *arg)
+{
+    test_reactor_t *reactor = (test_reactor_t *)arg;
+    struct epoll_event evs[TEST_MAX_EVENTS];
+    int i, num;
+
+    while (reactor->running) {
+        if (reactor->pause) {
+            reactor->idle = true;
+            usleep(1000);
+            continue;
+        }
+        reactor->idle = false;
+
+        num = epoll_wait(reactor->epfd, evs, TEST_MAX_EVENTS, 10);
+        for (i = 0; i < num; i++) {
+            ipc_event_dispatch(evs[i].data.ptr, evs[i].events);
+        }
+    }
+    return  (NULL);
+}
+
+static void reactor_start (test_reactor_t *reactor)
+{
+    reactor->epfd    = epoll_create1(EPOLL_CLOEXEC);
+    reactor->running = true;
+    reactor->pause   = false;
+    reactor->idle    = false;
+    pthread_create(&reactor->tid, NULL, reactor_thread, reactor);
+}
+
+static void reactor_stop (test_reactor_t *reactor)
+{
+    reactor->running = false;
+    pthread_join(reactor->tid, NULL);
+    close(reactor->epfd);
+}
+
+/*
+ * Hold the reactor outside epoll_wait, so the next wait returns everything that became ready meanwhile
+ */
+static void reactor_hold (test_reactor_t *reactor)
+{
+    reactor->idle  = false;
+    reactor->pause = true;
+    while (!reactor->idle) {
+        usleep(100);
+    }
+}
+
+static void reactor_release (test_reactor_t *reactor)
+{
+    reactor->pause = false;
+}
+
+/*
+ * Wait for `*value >= expect`
+ */
+static bool wait_value (volatile int *value, int expect, int64_t timeout_ns)
+{
+    int64_t deadline = vsoa_current_time() + timeout_ns;
+
+    while (*value < expect) {
+        if (vsoa_current_time() > deadline) {
+            return  (false);
+        }
+        usleep(500);
+    }
+    return  (true);
+}
+
+/*
+ * Wait for the server client count
+ */
+static bool wait_count (ipc_server_t *server, int expect, int64_t timeout_ns)
+{
+    int64_t deadline = vsoa_current_time() + timeout_ns;
+
+    while (ipc_server_count(server) != expect) {
+        if (vsoa_current_time() > deadline) {
+            return  (false);
+        }
+        usleep(500);
+    }
+    return  (true);
+}
+
+static void server_on_cli (void *arg, ipc_server_t *server, ipc_cli_id_t id, bool connect)
+{
+    test_srv_stat_t *stat = (test_srv_stat_t *)arg;
+
+    if (connect) {
+        stat->connects++;
+    } else {
+        stat->losts++;
+    }
+}
+
+static void server_on_datagram (void *arg, ipc_server_t *server, ipc_cli_id_t id,
+                                ipc_url_t *url, ipc_payload_t *payload)
+{
+    test_srv_stat_t *stat = (test_srv_stat_t *)arg;
+
+    stat->datagrams++;
+}
+
+static void client_on_message (void *arg, ipc_client_t *client, ipc_url_t *url, ipc_payload_t *payload)
+{
+    test_cli_stat_t *stat = (test_cli_stat_t *)arg;
+
+    if (url->url_len != strlen(TEST_URL) || memcmp(url->url, TEST_URL, url->url_len)) {
+        stat->errors++;
+    }
+    stat->messages++;
+}
+
+/*
+ * Create a server registered with the reactor
+ */
+static ipc_server_t *server_start (test_reactor_t *reactor, test_srv_stat_t *stat)
+{
+    ipc_server_t *server;
+
+    unlink(TEST_SERVER_PATH);
+    server = ipc_server_create("test_epoll");
+    if (!server) {
+        return  (NULL);
+    }
+    ipc_server_on_cli(server, server_on_cli, stat);
+    ipc_server_on_datagram(server, server_on_datagram, stat);
+    if (!ipc_server_start(server, TEST_SERVER_PATH) || !ipc_server_epoll_add(server, reactor->epfd)) {
+        ipc_server_close(server);
+        return  (NULL);
+    }
+    return  (server);
+}
+
+static void server_stop (test_reactor_t *reactor, ipc_server_t *server)
+{
+    reactor_hold(reactor);
+    ipc_server_epoll_del(server);
+    ipc_server_close(server);
+    unlink(TEST_SERVER_PATH);
+}
+
+/*
+ * Send one datagram
+ */
+static bool send_datagram (ipc_client_t *client, int seq)
+{
+    ipc_url_t url;
+    ipc_payload_t payload;
+
+    url.url          = TEST_URL;
+    url.url_len      = strlen(TEST_URL);
+    payload.data     = &seq;
+    payload.data_len = sizeof(seq);
+    return  (ipc_client_datagram(client, &url, &payload));
+}
+
+/*
+ * Clients connect, send and close in a loop, the server registers and drops each of them
+ */
+static bool test_connect_churn (void)
+{
+    test_reactor_t reactor;
+    test_srv_stat_t stat;
+    ipc_server_t *server;
+    ipc_client_t *client;
+    struct timespec timeout = { 1, 0 };
+    int i, fail = 0;
+    bool ret;
+
+    printf("\n=== Testing Connect Churn ===\n");
+
+    memset(&stat, 0, sizeof(stat));
+    reactor_start(&reactor);
+    server = server_start(&reactor, &stat);
+    if (!server) {
+        printf("Connect churn test FAILED (server start)\n");
+        reactor_stop(&reactor);
+        return  (false);
+    }
+
+    for (i = 0; i < TEST_CHURN_NUM; i++) {
+        client = ipc_client_create(NULL, NULL);
+        if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout) || !send_datagram(client, i)) {
+            fail++;
+        }
+        ipc_client_close(client);
+    }
+
+    wait_value(&stat.losts, TEST_CHURN_NUM, 5000000000LL);
+    wait_count(server, 0, 1000000000LL);
+
+    printf("cycles=%d failed=%d connects=%d losts=%d datagrams=%d clients=%d\n",
+           TEST_CHURN_NUM, fail, stat.connects, stat.losts, stat.datagrams, ipc_server_count(server));
+
+    ret = fail == 0 && stat.connects == TEST_CHURN_NUM && stat.losts == TEST_CHURN_NUM &&
+          stat.datagrams == TEST_CHURN_NUM && ipc_server_count(server) == 0;
+    printf("Connect churn test %s\n", ret ? "PASSED" : "FAILED");
+
+    server_stop(&reactor, server);
+    reactor_stop(&reactor);
+    return  (ret);
+}
+
+/*
+ * A client closes with records still in its ring: one epoll wait returns both
+ * its socket hangup and its doorbell. Whichever runs first destroys the client,
+ * the other event must find it retired, not freed. Run under a memory checker.
+ */
+static bool test_retired_client (void)
+{
+    test_reactor_t reactor;
+    test_srv_stat_t stat;
+    ipc_server_t *server;
+    ipc_client_t *client;
+    struct timespec timeout = { 1, 0 };
+    int i, j, fail = 0;
+    bool ret;
+
+    printf("\n=== Testing Retired Client ===\n");
+
+    memset(&stat, 0, sizeof(stat));
+    reactor_start(&reactor);
+    server = server_start(&reactor, &stat);
+    if (!server) {
+        printf("Retired client test FAILED (server start)\n");
+        reactor_stop(&reactor);
+        return  (false);
+    }
+
+    for (i = 0; i < TEST_RETIRE_NUM; i++) {
+        client = ipc_client_create(NULL, NULL);
+        ipc_client_set_shm(client, true);
+        if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+            fail++;
+            ipc_client_close(client);
+            continue;
+        }
+
+        reactor_hold(&reactor);
+        for (j = 0; j < TEST_RETIRE_DATS; j++) {
+            if (!send_datagram(client, j)) {
+                fail++;
+            }
+        }
+        ipc_client_close(client);
+        reactor_release(&reactor);
+
+        /* Ring records are drained before the client goes away */
+        if (!wait_value(&stat.losts, i + 1, 2000000000LL)) {
+            fail++;
+        }
+    }
+
+    wait_count(server, 0, 1000000000LL);
+
+    printf("cycles=%d failed=%d connects=%d losts=%d datagrams=%d clients=%d\n",
+           TEST_RETIRE_NUM, fail, stat.connects, stat.losts, stat.datagrams, ipc_server_count(server));
+
+    ret = fail == 0 && stat.connects == TEST_RETIRE_NUM && stat.losts == TEST_RETIRE_NUM &&
+          stat.datagrams == TEST_RETIRE_NUM * TEST_RETIRE_DATS && ipc_server_count(server) == 0;
+    printf("Retired client test %s\n", ret ? "PASSED" : "FAILED");
+
+    server_stop(&reactor, server);
+    reactor_stop(&reactor);
+    return  (ret);
+}
+
+/*
+ * A client registered with its own epoll instance keeps receiving across reconnects,
+ * each successful connect registers the new socket
+ */
+static bool test_client_reconnect (void)
+{
+    test_reactor_t srv_reactor, cli_reactor;
+    test_srv_stat_t srv_stat;
+    test_cli_stat_t cli_stat = { 0, 0 };
+    ipc_server_t *server;
+    ipc_client_t *client;
+    struct timespec timeout = { 1, 0 };
+    ipc_url_t url;
+    ipc_payload_t payload;
+    int i, seq = 0, fail = 0;
+    bool ret;
+
+    printf("\n=== Testing Client Reconnect ===\n");
+
+    memset(&srv_stat, 0, sizeof(srv_stat));
+    reactor_start(&srv_reactor);
+    reactor_start(&cli_reactor);
+    server = server_start(&srv_reactor, &srv_stat);
+    if (!server) {
+        printf("Client reconnect test FAILED (server start)\n");
+        reactor_stop(&cli_reactor);
+        reactor_stop(&srv_reactor);
+        return  (false);
+    }
+
+    url.url          = TEST_URL;
+    url.url_len      = strlen(TEST_URL);
+    payload.data     = &seq;
+    payload.data_len = sizeof(seq);
+
+    client = ipc_client_create(client_on_message, &cli_stat);
+    if (!ipc_client_epoll_add(client, cli_reactor.epfd)) {
+        fail++;
+    }
+
+    for (i = 0; i < TEST_RECONNECT_NUM && !fail; i++) {
+        if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout) ||
+            !ipc_client_subscribe(client, &url, NULL, NULL, NULL) ||
+            !wait_value(&srv_stat.connects, i + 1, 2000000000LL)) {
+            fail++;
+            break;
+        }
+        while (!ipc_server_is_subscribed(server, &url)) {
+            usleep(200);
+        }
+
+        seq = i;
+        ipc_server_publish(server, &url, &payload);
+        if (!wait_value(&cli_stat.messages, i + 1, 2000000000LL)) {
+            fail++;
+        }
+
+        ipc_client_disconnect(client);
+        if (!wait_value(&srv_stat.losts, i + 1, 2000000000LL)) {
+            fail++;
+        }
+    }
+
+    printf("reconnects=%d failed=%d messages=%d errors=%d\n",
+           TEST_RECONNECT_NUM, fail, cli_stat.messages, cli_stat.errors);
+
+    ret = fail == 0 && cli_stat.messages == TEST_RECONNECT_NUM && cli_stat.errors == 0;
+    printf("Client reconnect test %s\n", ret ? "PASSED" : "FAILED");
+
+    reactor_hold(&cli_reactor);
+    ipc_client_epoll_del(client);
+    ipc_client_close(client);
+    reactor_stop(&cli_reactor);
+    server_stop(&srv_reactor, server);
+    reactor_stop(&srv_reactor);
+    return  (ret);
+}
+
+int main (int argc, char **argv)
+{
+    bool churn_passed, retired_passed, reconnect_passed;
+
+    printf("IPC Epoll Integration Test\n");
+    printf("==========================\n");
+
+    churn_passed     = test_connect_churn();
+    retired_passed   = test_retired_client();
+    reconnect_passed = test_client_reconnect();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Connect churn test: %s\n", churn_passed ? "PASSED" : "FAILED");
+    printf("Retired client test: %s\n", retired_passed ? "PASSED" : "FAILED");
+    printf("Client reconnect test: %s\n", reconnect_passed ? "PASSED" : "FAILED");
+
+    if (churn_passed && retired_passed && reconnect_passed) {
+        printf("\nAll tests PASSED!\n");
+        return  (0);
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return  (1);
+    }
+}
+/*
+ * end
+ */
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2021 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: test_publish.c IPC server publish fan-out test.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include "../ipc_server.h"
+#include "../ipc_client.h"
+#include "../ipc_platform.h"
+
+#define TEST_SERVER_PATH    "/tmp/test_ipc_publish.sock"
+#define TEST_URL            "/publish/data"
+#define TEST_PUBLISH_NUM    400
+#define TEST_PAYLOAD_SIZE   (32 * 1024)
+#define TEST_MAX_LAG        32          /* Publisher waits for the healthy subscriber beyond this */
+#define TEST_PUBLISH_MAX_NS 50000000LL  /* A blocking send waits VSOA_SERVER_DEF_SEND_TIMEOUT */
+
+/* Server client connect state */
+typedef struct {
+    ipc_cli_id_t ids[2];
+    volatile int connected;
+    volatile bool lost[2];
+} test_cli_stat_t;
+
+/* Subscriber receive state */
+typedef struct {
+    volatile int received;
+    int errors;
+} test_sub_stat_t;
+
+static volatile bool server_running;
+static volatile bool client_running;
+
+/*
+ * Server event thread, queued output is flushed on writable events
+ */
+static void *server_thread (void *arg)
+{
+    ipc_server_t *server = (ipc_server_t *)arg;
+    struct timespec timeout = { 0, 10000000 };
+    fd_set rfds, wfds;
+    int max_fd, max_wfd;
+
+    while (server_running) {
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        max_fd  = ipc_server_fds(server, &rfds);
+        max_wfd = ipc_server_wfds(server, &wfds);
+        if (max_wfd > max_fd) {
+            max_fd = max_wfd;
+        }
+        if (pselect(max_fd + 1, &rfds, max_wfd >= 0 ? &wfds : NULL, NULL, &timeout, NULL) > 0) {
+            if (max_wfd >= 0) {
+                ipc_server_output_fds(server, &wfds);
+            }
+            ipc_server_input_fds(server, &rfds);
+        }
+    }
+    return  (NULL);
+}
+
+/*
+ * Healthy subscriber event thread
+ */
+static void *client_thread (void *arg)
+{
+    ipc_client_t *client = (ipc_client_t *)arg;
+    struct timespec timeout = { 0, 10000000 };
+    fd_set fds;
+    int max_fd;
+
+    while (client_running) {
+        FD_ZERO(&fds);
+        max_fd = ipc_client_fds(client, &fds);
+        if (max_fd < 0) {
+            usleep(1000);
+            continue;
+        }
+        if (pselect(max_fd + 1, &fds, NULL, NULL, &timeout, NULL) >= 0) {
+            ipc_client_process_events(client, &fds);
+        }
+    }
+    return  (NULL);
+}
+
+/*
+ * Server client connect or lost callback
+ */
+static void server_on_cli (void *arg, ipc_server_t *server, ipc_cli_id_t id, bool connect)
+{
+    test_cli_stat_t *stat = (test_cli_stat_t *)arg;
+    int i;
+
+    if (connect) {
+        if (stat->connected < 2) {
+            stat->ids[stat->connected] = id;
+        }
+        stat->connected++;
+        return;
+    }
+    for (i = 0; i < 2; i++) {
+        if (i < stat->connected && stat->ids[i] == id) {
+            stat->lost[i] = true;
+        }
+    }
+}
+
+/*
+ * Subscriber message callback, payloads carry their sequence number
+ */
+static void client_on_message (void *arg, ipc_client_t *client, ipc_url_t *url, ipc_payload_t *payload)
+{
+    test_sub_stat_t *stat = (test_sub_stat_t *)arg;
+    int seq = -1;
+
+    if (payload->data_len >= sizeof(seq)) {
+        memcpy(&seq, payload->data, sizeof(seq));
+    }
+    if (payload->data_len != TEST_PAYLOAD_SIZE || seq != stat->received) {
+        stat->errors++;
+    }
+    stat->received++;
+}
+
+/*
+ * Wait until `id` is subscribed to the test URL
+ */
+static bool wait_subscribed (ipc_server_t *server, ipc_cli_id_t id, const ipc_url_t *url)
+{
+    int64_t deadline = vsoa_current_time() + 2000000000LL;
+
+    while (!ipc_server_cli_is_subscribed(server, id, url)) {
+        if (vsoa_current_time() > deadline) {
+            return  (false);
+        }
+        usleep(1000);
+    }
+    return  (true);
+}
+
+/*
+ * Wait until client `index` connected
+ */
+static bool wait_connected (test_cli_stat_t *stat, int index)
+{
+    int64_t deadline = vsoa_current_time() + 2000000000LL;
+
+    while (stat->connected <= index) {
+        if (vsoa_current_time() > deadline) {
+            return  (false);
+        }
+        usleep(1000);
+    }
+    return  (true);
+}
+
+/*
+ * A subscriber that stops reading is disconnected, publish never blocks on it
+ * and the healthy subscriber keeps receiving every message in order
+ */
+static bool test_stalled_subscriber (void)
+{
+    ipc_server_t *server;
+    ipc_client_t *healthy, *stalled;
+    test_cli_stat_t cli_stat;
+    test_sub_stat_t healthy_stat = { 0, 0 };
+    test_sub_stat_t stalled_stat = { 0, 0 };
+    struct timespec timeout = { 1, 0 };
+    pthread_t server_tid, client_tid;
+    ipc_url_t url;
+    ipc_payload_t payload;
+    int64_t start, elapsed, max_ns = 0, deadline;
+    int i, publish_fail = 0;
+    uint8_t *data;
+    bool ret = false;
+
+    printf("\n=== Testing Stalled Subscriber ===\n");
+
+    memset(&cli_stat, 0, sizeof(cli_stat));
+    url.url     = TEST_URL;
+    url.url_len = strlen(TEST_URL);
+
+    unlink(TEST_SERVER_PATH);
+    server = ipc_server_create("test_publish");
+    ipc_server_on_cli(server, server_on_cli, &cli_stat);
+    if (!ipc_server_start(server, TEST_SERVER_PATH)) {
+        printf("Stalled subscriber test FAILED (server start)\n");
+        ipc_server_close(server);
+        return  (false);
+    }
+    server_running = true;
+    pthread_create(&server_tid, NULL, server_thread, server);
+
+    healthy = ipc_client_create(client_on_message, &healthy_stat);
+    stalled = ipc_client_create(client_on_message, &stalled_stat);
+
+    if (!ipc_client_connect(healthy, TEST_SERVER_PATH, &timeout) || !wait_connected(&cli_stat, 0) ||
+        !ipc_client_connect(stalled, TEST_SERVER_PATH, &timeout) || !wait_connected(&cli_stat, 1)) {
+        printf("Stalled subscriber test FAILED (connect)\n");
+        goto    out;
+    }
+
+    /* The stalled client sends its subscription and never reads again */
+    ipc_client_subscribe(healthy, &url, NULL, NULL, NULL);
+    ipc_client_subscribe(stalled, &url, NULL, NULL, NULL);
+    if (!wait_subscribed(server, cli_stat.ids[0], &url) || !wait_subscribed(server, cli_stat.ids[1], &url)) {
+        printf("Stalled subscriber test FAILED (subscribe)\n");
+        goto    out;
+    }
+
+    client_running = true;
+    pthread_create(&client_tid, NULL, client_thread, healthy);
+
+    data = malloc(TEST_PAYLOAD_SIZE);
+    memset(data, 0x5a, TEST_PAYLOAD_SIZE);
+    payload.data     = data;
+    payload.data_len = TEST_PAYLOAD_SIZE;
+    for (i = 0; i < TEST_PUBLISH_NUM; i++) {
+        deadline = vsoa_current_time() + 2000000000LL;
+        while (i - healthy_stat.received > TEST_MAX_LAG && vsoa_current_time() < deadline) {
+            usleep(100);
+        }
+
+        memcpy(data, &i, sizeof(i));
+        start = vsoa_current_time();
+        if (!ipc_server_publish(server, &url, &payload)) {
+            publish_fail++;
+        }
+        elapsed = vsoa_current_time() - start;
+        if (elapsed > max_ns) {
+            max_ns = elapsed;
+        }
+    }
+    free(data);
+
+    deadline = vsoa_current_time() + 5000000000LL;
+    while ((healthy_stat.received < TEST_PUBLISH_NUM || !cli_stat.lost[1]) && vsoa_current_time() < deadline) {
+        usleep(1000);
+    }
+
+    client_running = false;
+    pthread_join(client_tid, NULL);
+
+    printf("published=%d failed=%d max_publish=%lld us healthy=%d errors=%d healthy_lost=%d stalled_lost=%d\n",
+           TEST_PUBLISH_NUM, publish_fail, (long long)(max_ns / 1000), healthy_stat.received,
+           healthy_stat.errors, cli_stat.lost[0], cli_stat.lost[1]);
+
+    ret = publish_fail == 0 && max_ns < TEST_PUBLISH_MAX_NS &&
+          healthy_stat.received == TEST_PUBLISH_NUM && healthy_stat.errors == 0 &&
+          !cli_stat.lost[0] && cli_stat.lost[1] && ipc_server_count(server) == 1;
+
+out:
+    printf("Stalled subscriber test %s\n", ret ? "PASSED" : "FAILED");
+
+    ipc_client_close(stalled);
+    ipc_client_close(healthy);
+    server_running = false;
+    pthread_join(server_tid, NULL);
+    ipc_server_close(server);
+    unlink(TEST_SERVER_PATH);
+    return  (ret);
+}
+
+int main (int argc, char **argv)
+{
+    bool stalled_passed;
+
+    printf("IPC Server Publish Test\n");
+    printf("=======================\n");
+
+    stalled_passed = test_stalled_subscriber();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Stalled subscriber test: %s\n", stalled_passed ? "PASSED" : "FAILED");
+
+    if (stalled_passed) {
+        printf("\nAll tests PASSED!\n");
+        return  (0);
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return  (1);
+    }
+}
+/*
+ * end
+ */
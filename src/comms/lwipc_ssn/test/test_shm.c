@@ -0,0 +1,474 @@
+/*
+ * Copyright (c) 2021 ACOAUTO Team.
+ * All rights reserved.
+ *
+ * Detailed license information can be found in the LICENSE file.
+ *
+ * File: test_shm.c IPC shared memory datagram ring test.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include "../ipc_server.h"
+#include "../ipc_client.h"
+#include "../ipc_shm.h"
+#include "../ipc_platform.h"
+
+#define TEST_SERVER_PATH    "/tmp/test_ipc_shm.sock"
+#define TEST_URL            "/shm/data"
+#define TEST_DATAGRAM_NUM   5000
+#define TEST_MAX_RECORD     (40 * 1024)
+
+/* Sequence number at the start of every payload */
+typedef struct {
+    uint32_t seq;
+    uint32_t len;
+} test_record_t;
+
+/* Ring consumer check state */
+typedef struct {
+    uint32_t next;
+    int errors;
+} test_ring_stat_t;
+
+/* Server datagram check state */
+typedef struct {
+    volatile int received;
+    int errors;
+} test_dat_stat_t;
+
+static volatile bool server_running;
+
+/*
+ * Payload length of record `seq`, a mix of empty, small and large records
+ */
+static size_t test_record_len (uint32_t seq)
+{
+    switch (seq % 5) {
+    case 0:
+        return  (sizeof(test_record_t));
+    case 1:
+        return  (sizeof(test_record_t) + (seq * 7919) % 512);
+    case 2:
+        return  (TEST_MAX_RECORD - (seq * 104729) % 4096);
+    case 3:
+        return  (sizeof(test_record_t) + (seq * 31) % 8192);
+    default:
+        return  (sizeof(test_record_t) + 3);
+    }
+}
+
+/*
+ * Fill record payload
+ */
+static void test_record_fill (uint8_t *buf, uint32_t seq, size_t len)
+{
+    test_record_t *rec = (test_record_t *)buf;
+    size_t i;
+
+    rec->seq = seq;
+    rec->len = (uint32_t)len;
+    for (i = sizeof(test_record_t); i < len; i++) {
+        buf[i] = (uint8_t)(seq + i);
+    }
+}
+
+/*
+ * Check record payload
+ */
+static bool test_record_check (const ipc_payload_t *payload, uint32_t seq)
+{
+    const uint8_t *buf = (const uint8_t *)payload->data;
+    const test_record_t *rec = (const test_record_t *)buf;
+    size_t i;
+
+    if (payload->data_len < sizeof(test_record_t) || rec->seq != seq ||
+        rec->len != payload->data_len || payload->data_len != test_record_len(seq)) {
+        return  (false);
+    }
+    for (i = sizeof(test_record_t); i < payload->data_len; i++) {
+        if (buf[i] != (uint8_t)(seq + i)) {
+            return  (false);
+        }
+    }
+    return  (true);
+}
+
+/*
+ * Ring consumer callback
+ */
+static bool ring_input (void *arg, ipc_header_t *ipc_hdr)
+{
+    test_ring_stat_t *stat = (test_ring_stat_t *)arg;
+    ipc_payload_t payload;
+    ipc_url_t url;
+
+    if (ipc_hdr->type != IPC_TYPE_DATAGRAM ||
+        !ipc_parser_get_url(ipc_hdr, &url) || url.url_len != strlen(TEST_URL) ||
+        memcmp(url.url, TEST_URL, url.url_len) ||
+        !ipc_parser_get_payload(ipc_hdr, &payload) || !test_record_check(&payload, stat->next)) {
+        stat->errors++;
+    }
+    stat->next++;
+    return  (true);
+}
+
+/*
+ * Write one record to the ring
+ */
+static bool ring_write (ipc_shm_ring_t *ring, uint8_t *frame, uint8_t *data, uint32_t seq,
+                        const struct timeval *timeout)
+{
+    ipc_header_t *ipc_hdr;
+    ipc_url_t url;
+    ipc_payload_t payload;
+
+    url.url          = TEST_URL;
+    url.url_len      = strlen(TEST_URL);
+    payload.data     = data;
+    payload.data_len = test_record_len(seq);
+    test_record_fill(data, seq, payload.data_len);
+
+    ipc_hdr = ipc_parser_init_header(frame, IPC_TYPE_DATAGRAM, 0, 0);
+    ipc_parser_set_url(ipc_hdr, &url);
+    ipc_parser_set_payload(ipc_hdr, &payload);
+
+    return  (ipc_shm_ring_write(ring, ipc_hdr, &url, &payload, timeout));
+}
+
+/*
+ * Create a consumer ring and attach a producer to it
+ */
+static bool ring_pair (ipc_shm_ring_t *cons, ipc_shm_ring_t *prod, size_t size)
+{
+    int fds[IPC_SHM_FD_NUM];
+
+    fds[IPC_SHM_FD_MEM] = ipc_shm_ring_create(cons, size);
+    if (fds[IPC_SHM_FD_MEM] < 0) {
+        return  (false);
+    }
+    fds[IPC_SHM_FD_DOOR]  = dup(cons->doorfd);
+    fds[IPC_SHM_FD_SPACE] = dup(cons->spacefd);
+
+    if (!ipc_shm_ring_attach(prod, fds)) {
+        ipc_shm_ring_destroy(cons);
+        return  (false);
+    }
+    return  (true);
+}
+
+/*
+ * Records of varying size wrap around a small ring many times
+ */
+static bool test_ring_wrap (void)
+{
+    ipc_shm_ring_t cons, prod;
+    test_ring_stat_t stat = { 0, 0 };
+    struct timeval no_wait = { 0, 0 };
+    uint8_t *frame, *data, *buf;
+    uint64_t bytes = 0;
+    uint32_t seq = 0;
+    int full = 0;
+    bool ret;
+
+    printf("\n=== Testing Ring Wrap ===\n");
+
+    frame = malloc(IPC_MAX_PACKET_LENGTH);
+    data  = malloc(IPC_MAX_PACKET_LENGTH);
+    buf   = malloc(IPC_MAX_PACKET_LENGTH);
+    if (!ring_pair(&cons, &prod, IPC_SHM_MIN_SIZE)) {
+        printf("Ring wrap test FAILED (create)\n");
+        free(frame);
+        free(data);
+        free(buf);
+        return  (false);
+    }
+
+    /* Drain only when the producer reports a full ring, so every wrap position is hit */
+    while (bytes < (uint64_t)prod.size * 16) {
+        if (ring_write(&prod, frame, data, seq, &no_wait)) {
+            bytes += test_record_len(seq);
+            seq++;
+            continue;
+        }
+        full++;
+        if (!ipc_shm_ring_input(&cons, buf, ring_input, &stat)) {
+            stat.errors++;
+            break;
+        }
+    }
+    if (!ipc_shm_ring_input(&cons, buf, ring_input, &stat)) {
+        stat.errors++;
+    }
+
+    printf("ring=%zu records=%u bytes=%llu full=%d received=%u errors=%d\n",
+           prod.size, seq, (unsigned long long)bytes, full, stat.next, stat.errors);
+
+    ret = stat.errors == 0 && stat.next == seq && full > 0;
+    printf("Ring wrap test %s\n", ret ? "PASSED" : "FAILED");
+
+    ipc_shm_ring_destroy(&prod);
+    ipc_shm_ring_destroy(&cons);
+    free(frame);
+    free(data);
+    free(buf);
+    return  (ret);
+}
+
+/* Delayed consumer */
+typedef struct {
+    ipc_shm_ring_t *ring;
+    test_ring_stat_t *stat;
+    int delay_ms;
+} test_drain_arg_t;
+
+static void *drain_thread (void *arg)
+{
+    test_drain_arg_t *drain = (test_drain_arg_t *)arg;
+    void *buf = malloc(IPC_MAX_PACKET_LENGTH);
+
+    usleep(drain->delay_ms * 1000);
+    if (!ipc_shm_ring_input(drain->ring, buf, ring_input, drain->stat)) {
+        drain->stat->errors++;
+    }
+    free(buf);
+    return  (NULL);
+}
+
+/*
+ * A full ring bounds the producer wait by its timeout, and a consumer wakes a waiting producer
+ */
+static bool test_ring_overflow (void)
+{
+    ipc_shm_ring_t cons, prod;
+    test_ring_stat_t stat = { 0, 0 };
+    test_drain_arg_t drain;
+    struct timeval no_wait = { 0, 0 };
+    struct timeval short_wait = { 0, 50000 };
+    struct timeval long_wait = { 5, 0 };
+    uint8_t *frame, *data, *buf;
+    int64_t start, full_ns, wake_ns;
+    uint32_t seq = 0;
+    bool full_ok, wake_ok, ret;
+    pthread_t tid;
+
+    printf("\n=== Testing Ring Overflow ===\n");
+
+    frame = malloc(IPC_MAX_PACKET_LENGTH);
+    data  = malloc(IPC_MAX_PACKET_LENGTH);
+    buf   = malloc(IPC_MAX_PACKET_LENGTH);
+    if (!ring_pair(&cons, &prod, IPC_SHM_MIN_SIZE)) {
+        printf("Ring overflow test FAILED (create)\n");
+        free(frame);
+        free(data);
+        free(buf);
+        return  (false);
+    }
+
+    while (ring_write(&prod, frame, data, seq, &no_wait)) {
+        seq++;
+    }
+
+    /* Nobody consumes: the write gives up after its timeout and leaves the ring intact */
+    start   = vsoa_current_time();
+    full_ok = !ring_write(&prod, frame, data, seq, &short_wait);
+    full_ns = vsoa_current_time() - start;
+
+    /* Consumer drains later: the waiting producer is woken well before its timeout */
+    drain.ring     = &cons;
+    drain.stat     = &stat;
+    drain.delay_ms = 100;
+    pthread_create(&tid, NULL, drain_thread, &drain);
+    start   = vsoa_current_time();
+    wake_ok = ring_write(&prod, frame, data, seq, &long_wait);
+    wake_ns = vsoa_current_time() - start;
+    pthread_join(tid, NULL);
+    if (wake_ok) {
+        seq++;
+    }
+    if (!ipc_shm_ring_input(&cons, buf, ring_input, &stat)) {
+        stat.errors++;
+    }
+
+    printf("queued=%u full_wait=%lld ms woken_after=%lld ms received=%u errors=%d\n",
+           seq, (long long)(full_ns / 1000000), (long long)(wake_ns / 1000000), stat.next, stat.errors);
+
+    ret = full_ok && full_ns >= 40000000LL && full_ns < 1000000000LL &&
+          wake_ok && wake_ns < 2000000000LL &&
+          stat.errors == 0 && stat.next == seq;
+    printf("Ring overflow test %s\n", ret ? "PASSED" : "FAILED");
+
+    ipc_shm_ring_destroy(&prod);
+    ipc_shm_ring_destroy(&cons);
+    free(frame);
+    free(data);
+    free(buf);
+    return  (ret);
+}
+
+/*
+ * Server datagram callback
+ */
+static void server_on_datagram (void *arg, ipc_server_t *server, ipc_cli_id_t id,
+                                ipc_url_t *url, ipc_payload_t *payload)
+{
+    test_dat_stat_t *stat = (test_dat_stat_t *)arg;
+
+    if (url->url_len != strlen(TEST_URL) || memcmp(url->url, TEST_URL, url->url_len) ||
+        !test_record_check(payload, (uint32_t)stat->received)) {
+        stat->errors++;
+    }
+    stat->received++;
+}
+
+/*
+ * Server event thread
+ */
+static void *server_thread (void *arg)
+{
+    ipc_server_t *server = (ipc_server_t *)arg;
+    struct timespec timeout = { 0, 10000000 };
+    fd_set fds;
+    int max_fd;
+
+    while (server_running) {
+        FD_ZERO(&fds);
+        max_fd = ipc_server_fds(server, &fds);
+        if (pselect(max_fd + 1, &fds, NULL, NULL, &timeout, NULL) > 0) {
+            ipc_server_input_fds(server, &fds);
+        }
+    }
+    return  (NULL);
+}
+
+/*
+ * Count shared memory ring mappings of this process (server and client side each map it)
+ */
+static int test_shm_map_count (void)
+{
+    char line[PATH_MAX + 128];
+    int count = 0;
+    FILE *fp;
+
+    fp = fopen("/proc/self/maps", "r");
+    if (!fp) {
+        return  (-1);
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (strstr(line, "memfd:ipc_shm")) {
+            count++;
+        }
+    }
+    fclose(fp);
+    return  (count);
+}
+
+/*
+ * Client datagrams reach the server through the ring, or through the socket when the server has it disabled
+ */
+static bool test_client_server (bool server_shm)
+{
+    ipc_server_t *server;
+    ipc_client_t *client;
+    test_dat_stat_t stat = { 0, 0 };
+    struct timespec timeout = { 1, 0 };
+    ipc_url_t url;
+    ipc_payload_t payload;
+    uint8_t *data;
+    pthread_t tid;
+    int i, send_fail = 0, rings;
+    int64_t deadline;
+    bool ret;
+
+    printf("\n=== Testing Client Datagrams (server shm %s) ===\n", server_shm ? "enabled" : "disabled");
+
+    unlink(TEST_SERVER_PATH);
+    server = ipc_server_create("test_shm");
+    ipc_server_set_shm(server, server_shm, 0);
+    ipc_server_on_datagram(server, server_on_datagram, &stat);
+    if (!ipc_server_start(server, TEST_SERVER_PATH)) {
+        printf("Client datagram test FAILED (server start)\n");
+        ipc_server_close(server);
+        return  (false);
+    }
+    server_running = true;
+    pthread_create(&tid, NULL, server_thread, server);
+
+    client = ipc_client_create(NULL, NULL);
+    ipc_client_set_shm(client, true);
+    if (!ipc_client_connect(client, TEST_SERVER_PATH, &timeout)) {
+        printf("Client datagram test FAILED (connect)\n");
+        ret = false;
+        goto    out;
+    }
+    rings = test_shm_map_count();
+
+    url.url     = TEST_URL;
+    url.url_len = strlen(TEST_URL);
+    data = malloc(IPC_MAX_PACKET_LENGTH);
+    for (i = 0; i < TEST_DATAGRAM_NUM; i++) {
+        payload.data     = data;
+        payload.data_len = test_record_len(i);
+        test_record_fill(data, i, payload.data_len);
+        if (!ipc_client_datagram(client, &url, &payload)) {
+            send_fail++;
+        }
+    }
+    free(data);
+
+    deadline = vsoa_current_time() + 5000000000LL;
+    while (stat.received < TEST_DATAGRAM_NUM - send_fail && vsoa_current_time() < deadline) {
+        usleep(1000);
+    }
+
+    printf("sent=%d failed=%d received=%d errors=%d rings=%d\n",
+           TEST_DATAGRAM_NUM, send_fail, stat.received, stat.errors, rings);
+
+    ret = send_fail == 0 && stat.received == TEST_DATAGRAM_NUM && stat.errors == 0 &&
+          (server_shm ? rings > 0 : rings == 0);
+    printf("Client datagram test %s\n", ret ? "PASSED" : "FAILED");
+
+out:
+    ipc_client_close(client);
+    server_running = false;
+    pthread_join(tid, NULL);
+    ipc_server_close(server);
+    unlink(TEST_SERVER_PATH);
+    return  (ret);
+}
+
+int main (int argc, char **argv)
+{
+    bool wrap_passed, overflow_passed, shm_passed, socket_passed;
+
+    printf("IPC Shared Memory Ring Test\n");
+    printf("===========================\n");
+
+    wrap_passed     = test_ring_wrap();
+    overflow_passed = test_ring_overflow();
+    shm_passed      = test_client_server(true);
+    socket_passed   = test_client_server(false);
+
+    printf("\n=== Test Summary ===\n");
+    printf("Ring wrap test: %s\n", wrap_passed ? "PASSED" : "FAILED");
+    printf("Ring overflow test: %s\n", overflow_passed ? "PASSED" : "FAILED");
+    printf("Shared memory datagram test: %s\n", shm_passed ? "PASSED" : "FAILED");
+    printf("Socket fallback datagram test: %s\n", socket_passed ? "PASSED" : "FAILED");
+
+    if (wrap_passed && overflow_passed && shm_passed && socket_passed) {
+        printf("\nAll tests PASSED!\n");
+        return  (0);
+    } else {
+        printf("\nSome tests FAILED!\n");
+        return  (1);
+    }
+}
+/*
+ * end
+ */
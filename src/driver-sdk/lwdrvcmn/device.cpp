@@ -110,16 +110,17 @@ void CDevice::InitDeviceInterface()
         device_info_->pptags = nullptr;
     }
     // TODO: copy tags.
-    if (device_all_tags_.size() > 0) {
-        device_info_->pptags = (LWTAG**)malloc(sizeof(LWTAG*) * device_all_tags_.size());
+    std::vector<LWTAG *> all_tags = GetTags();
+    if (all_tags.size() > 0) {
+        device_info_->pptags = (LWTAG**)malloc(sizeof(LWTAG*) * all_tags.size());
         if (device_info_->pptags == nullptr) {
             g_logger.LogMessage(LW_LOGLEVEL_ERROR, "Failed to allocate memory for device tags");
             return;
         }
-        for (size_t i = 0; i < device_all_tags_.size(); ++i) {
-            device_info_->pptags[i] = device_all_tags_[i];
+        for (size_t i = 0; i < all_tags.size(); ++i) {
+            device_info_->pptags[i] = all_tags[i];
         }
-        device_info_->tag_count = static_cast<int>(device_all_tags_.size());
+        device_info_->tag_count = static_cast<int>(all_tags.size());
     } else {
         device_info_->pptags = nullptr;
     }
@@ -127,6 +128,7 @@ void CDevice::InitDeviceInterface()
 
 int CDevice::AddTagOfDevice (const LWTAG *tag)
 {
+    std::lock_guard<std::mutex> guard(tags_lock_);
     device_all_tags_.push_back(const_cast<LWTAG *>(tag));
     name_to_tags_[tag->name] = const_cast<LWTAG *>(tag);
     auto addr = addr_to_tags_.find(tag->address);
@@ -137,10 +139,32 @@ int CDevice::AddTagOfDevice (const LWTAG *tag)
     } else {
         addr->second.push_back(const_cast<LWTAG *>(tag));
     }
+    ++tag_version_;
 
     return 0;
 }
 
+void CDevice::SetReadRule(PFN_DrvParseAddress parser, int max_block, int max_gap)
+{
+    std::lock_guard<std::mutex> guard(tags_lock_);
+    read_parser_ = parser;
+    read_max_block_ = max_block;
+    read_max_gap_ = max_gap;
+    ++tag_version_;
+}
+
+DeviceReadRule CDevice::GetReadRule() const
+{
+    std::lock_guard<std::mutex> guard(tags_lock_);
+    return DeviceReadRule{read_parser_, read_max_block_, read_max_gap_};
+}
+
+std::vector<LWTAG *> CDevice::GetTags() const
+{
+    std::lock_guard<std::mutex> guard(tags_lock_);
+    return device_all_tags_;
+}
+
 void CDevice::OnWriteCommand(LWTAG *pTag, std::string data)
 {
     if (DRV_FRAMEWORK->pfnOnControl_) {
@@ -157,6 +181,7 @@ void CDevice::OnWriteCommand(LWTAG *pTag, std::string data)
 }
 int CDevice::GetTagsByName(const char* name, LWTAG **ppTags, int tag_count)
 {
+    std::lock_guard<std::mutex> guard(tags_lock_);
     auto itMapT = name_to_tags_.find(name);
     if (itMapT == name_to_tags_.end())
     {
@@ -173,12 +198,14 @@ int CDevice::GetTagsByName(const char* name, LWTAG **ppTags, int tag_count)
 }
 std::map<std::string, LWTAG *> CDevice::GetALLTags() const
 {
+    std::lock_guard<std::mutex> guard(tags_lock_);
     return name_to_tags_;
 }
 
 int CDevice::GetTagsByAddr(const char* addr, LWTAG **ppTags, int tag_count)
 {
     std::vector<LWTAG *> pVecTagOfAddr;
+    std::lock_guard<std::mutex> guard(tags_lock_);
     auto itMapT = addr_to_tags_.find(addr);
     if (itMapT == addr_to_tags_.end())
     {
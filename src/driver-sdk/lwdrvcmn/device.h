@@ -23,9 +23,20 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <atomic>
+#include <mutex>
 
 class CUserTimer;
 class CDriver;
+
+// 设备块读规则
+struct DeviceReadRule
+{
+    PFN_DrvParseAddress parser;
+    int max_block;
+    int max_gap;
+};
+
 class CDevice
 {
 private:
@@ -75,6 +86,13 @@ public:
     int GetTagsByName(const char* name, LWTAG **ppTags, int tag_count);
     int UpdateTagsData(LWTAG **tag, int tag_count);
     std::map<std::string, LWTAG *> GetALLTags() const;
+    // 点位和块读规则可能由驱动线程修改，调度线程取副本使用
+    std::vector<LWTAG *> GetTags() const;
+    unsigned int GetTagVersion() const { return tag_version_; }
+
+    // block read rule, used to plan the reads of each poll group
+    void SetReadRule(PFN_DrvParseAddress parser, int max_block, int max_gap);
+    DeviceReadRule GetReadRule() const;
 
     LWDEVICE* GetDeviceInterface() { return device_info_; }
 public:
@@ -89,6 +107,12 @@ private:
     std::map<std::string, std::vector<LWTAG *>> addr_to_tags_;
 
     std::vector<CUserTimer*> vec_timers;
+
+    mutable std::mutex tags_lock_; // 保护点位表和块读规则
+    std::atomic<unsigned int> tag_version_{0}; // 点位或块读规则变化时递增，轮询调度据此重新规划
+    PFN_DrvParseAddress read_parser_ = nullptr;
+    int read_max_block_ = 0;
+    int read_max_gap_ = 0;
 private:
     LWDEVICE *device_info_;
     std::string device_name_;
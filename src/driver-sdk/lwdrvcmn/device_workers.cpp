@@ -0,0 +1,197 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: device_workers.cpp .
+*
+* Date: 2026-03-09
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#include "device_workers.h"
+
+#include "lwlog/lwlog.h"
+
+extern CLWLog g_logger;
+
+CDeviceWorkers::CDeviceWorkers()
+    : active_num_(0), next_worker_(0), inflight_(0), max_inflight_(0), stop_(false)
+{
+}
+
+CDeviceWorkers::~CDeviceWorkers()
+{
+    Stop();
+}
+
+int CDeviceWorkers::Resize(int worker_num, int max_inflight)
+{
+    if (worker_num <= 0) {
+        Stop();
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(inflight_lock_);
+        if (workers_.empty()) {
+            inflight_ = 0;
+        }
+        stop_ = false;
+        max_inflight_ = max_inflight;
+    }
+    inflight_cond_.notify_all();
+
+    // 还没退出的退役线程重新启用，不够时再新建
+    for (int i = static_cast<int>(workers_.size()); i < worker_num; i++) {
+        std::unique_ptr<Worker> worker(new Worker());
+        worker->thread = std::thread(&CDeviceWorkers::WorkerMain, this, worker.get());
+        workers_.push_back(std::move(worker));
+    }
+    active_num_ = worker_num;
+    next_worker_ = 0;
+    ReapRetired();
+
+    g_logger.LogMessage(LW_LOGLEVEL_INFO, "Device workers: %d, retiring: %d, max inflight devices: %d",
+        worker_num, static_cast<int>(workers_.size() - active_num_), max_inflight > 0 ? max_inflight : worker_num);
+    return worker_num;
+}
+
+void CDeviceWorkers::ReapRetired()
+{
+    for (size_t i = active_num_; i < workers_.size();) {
+        Worker *worker = workers_[i].get();
+        {
+            std::lock_guard<std::mutex> guard(worker->lock);
+            if (worker->running || !worker->tasks.empty()) {
+                // 设备还卡在这个线程上，之后的任务继续投递到这里，保证同一设备串行
+                i++;
+                continue;
+            }
+            worker->exit = true;
+        }
+        worker->cond.notify_all();
+        worker->thread.join();
+
+        // 空闲线程上的设备在下次投递时重新分配
+        for (auto it = affinity_.begin(); it != affinity_.end();) {
+            if (it->second == worker) {
+                it = affinity_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        workers_.erase(workers_.begin() + i);
+    }
+}
+
+void CDeviceWorkers::Stop()
+{
+    if (workers_.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(inflight_lock_);
+        stop_ = true;
+    }
+    inflight_cond_.notify_all();
+
+    for (auto &worker : workers_) {
+        {
+            std::lock_guard<std::mutex> guard(worker->lock);
+            worker->tasks.clear();
+        }
+        worker->cond.notify_all();
+    }
+    for (auto &worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    workers_.clear();
+    affinity_.clear();
+    active_num_ = 0;
+    next_worker_ = 0;
+}
+
+void CDeviceWorkers::Post(CDevice *device, std::function<void()> task)
+{
+    if (workers_.size() > active_num_) {
+        ReapRetired();
+    }
+    if (active_num_ == 0) {
+        task();
+        return;
+    }
+
+    Worker *worker;
+    auto it = affinity_.find(device);
+    if (it == affinity_.end()) {
+        worker = workers_[next_worker_++ % active_num_].get();
+        affinity_.emplace(device, worker);
+    } else {
+        worker = it->second;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(worker->lock);
+        worker->tasks.push_back(std::move(task));
+    }
+    worker->cond.notify_one();
+}
+
+bool CDeviceWorkers::AcquireInflight()
+{
+    std::unique_lock<std::mutex> guard(inflight_lock_);
+    inflight_cond_.wait(guard, [this] {
+        return stop_ || max_inflight_ <= 0 || inflight_ < max_inflight_;
+    });
+    if (stop_) {
+        return false;
+    }
+    inflight_++;
+    return true;
+}
+
+void CDeviceWorkers::ReleaseInflight()
+{
+    {
+        std::lock_guard<std::mutex> guard(inflight_lock_);
+        inflight_--;
+    }
+    inflight_cond_.notify_one();
+}
+
+void CDeviceWorkers::WorkerMain(Worker *worker)
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(worker->lock);
+            worker->cond.wait(guard, [this, worker] {
+                return !worker->tasks.empty() || stop_ || worker->exit;
+            });
+            if (worker->tasks.empty()) {
+                return;
+            }
+            task = std::move(worker->tasks.front());
+            worker->tasks.pop_front();
+            worker->running = true;
+        }
+
+        // 限制同时访问设备的个数，超出时在此等待
+        if (!AcquireInflight()) {
+            return;
+        }
+        task();
+        ReleaseInflight();
+
+        std::lock_guard<std::mutex> guard(worker->lock);
+        worker->running = false;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: device_workers.h .
+*
+* Date: 2026-03-09
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CDevice;
+
+// 设备 I/O 工作线程池：同一设备固定在一个线程上串行执行，不同设备并行
+class CDeviceWorkers
+{
+public:
+    CDeviceWorkers();
+    ~CDeviceWorkers();
+
+    // 启动或调整工作线程，max_inflight 为同时访问设备的最大个数，<= 0 表示不限制。
+    // 运行中调整不等待正在执行的任务：多出的线程空闲后才退出，其上的设备之后重新分配
+    int Resize(int worker_num, int max_inflight);
+    // 等待正在执行的任务结束，丢弃未执行的任务
+    void Stop();
+
+    bool IsRunning() const { return active_num_ > 0; }
+    int GetWorkerNum() const { return static_cast<int>(active_num_); }
+
+    // 投递设备任务，首次出现的设备按轮转分配线程
+    void Post(CDevice *device, std::function<void()> task);
+
+private:
+    struct Worker
+    {
+        std::thread thread;
+        std::mutex lock;
+        std::condition_variable cond;
+        std::deque<std::function<void()>> tasks;
+        bool running = false;   // 正在执行任务
+        bool exit = false;      // 退役线程空闲后退出
+    };
+
+    void WorkerMain(Worker *worker);
+    void ReapRetired();
+    bool AcquireInflight();
+    void ReleaseInflight();
+
+private:
+    std::vector<std::unique_ptr<Worker>> workers_; // 前 active_num_ 个接收新设备，其余等待退役
+    size_t active_num_;
+    std::map<CDevice *, Worker *> affinity_; // 只在投递线程中访问
+    size_t next_worker_;
+
+    std::mutex inflight_lock_;
+    std::condition_variable inflight_cond_;
+    int inflight_;
+    int max_inflight_;
+    std::atomic<bool> stop_;
+};
@@ -121,6 +121,7 @@ int DrvFramework::LoadDrvFuncs()
             dll_path.c_str(), dlerror());
         goto FAILED;
     }
+    pfnOnReadTags_ = (PFN_OnReadTags)dlsym(drv_handle_, "OnReadTags");
     pfnOnControl_ = (PFN_OnControl)dlsym(drv_handle_, "OnControl");
     pfnGetVersion_ = (PFN_GetVersion)dlsym(drv_handle_, "GetVersion");
 #else
@@ -133,6 +134,7 @@ int DrvFramework::LoadDrvFuncs()
     pfnInitDevice_ = InitDevice;
     pfnUnInitDevice_ = UnInitDevice;
     pfnOnTimer_ = OnTimer;
+    pfnOnReadTags_ = nullptr;
     pfnOnControl_ = OnControl;
 #endif
     return 0;
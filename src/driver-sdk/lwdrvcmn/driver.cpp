@@ -25,6 +25,7 @@
 #include "platform_sdk/status.hpp"
 #include "platform_sdk/timer.h"
 #include "drvdto.hpp"
+#include "json_writer.h"
 #include "vsoa_dto/core/Types.hpp"
 #include <cmath>
 
@@ -59,11 +60,23 @@ void CDriver::OnDatagramServerConnect(void *arg, ipc_client_auto_t *cliauto, boo
     // TODO: InitTags2NodeServer!!! 
     if (connect)
     {
+        // 新连接的 node_server 没有任何点位值，下次更新时全部上送
+        driver->tag_filter_.Reset();
         g_logger.LogMessage(LW_LOGLEVEL_INFO, "Init all tags to node_server");
         driver->UpdateTags2NodeServer();
     }
 }
 
+void CDriver::OnBatchDrop(void *arg, ipc_client_t *client)
+{
+    CDriver *driver = static_cast<CDriver*>(arg);
+
+    // 已记为上送的值随合并发送的批次丢失，全部点位下次更新时重新上送
+    g_logger.LogMessage(LW_LOGLEVEL_WARN, "Datagram batch to node_server %s dropped, resending all tags",
+        driver->node_server_srvname_.c_str());
+    driver->tag_filter_.Reset();
+}
+
 int CDriver::HandleWriteCmd(std::string tag_name, std::string tag_value)
 {
     LWTAG *tag = nullptr;
@@ -79,42 +92,65 @@ int CDriver::HandleWriteCmd(std::string tag_name, std::string tag_value)
 
 void CDriver::UpdateTagsData(LWTAG **tag, int tag_count)
 {
-    vsoa::List<vsoa::Object<DataValueDto>> data_list = vsoa::List<vsoa::Object<DataValueDto>>::createShared();
     auto now = chrono::system_clock::now();
     long long time = chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch()).count();
 
+    // 工程量变换在驱动侧只做一次，各消费者直接使用工程量
+    thread_local std::vector<double> eng_values;
+    thread_local std::vector<uint8_t> eng_scaled;
+    eng_values.resize(tag_count);
+    eng_scaled.resize(tag_count);
+    tag_transform_.Apply(tag, tag_count, eng_values.data(), eng_scaled.data());
+
+    // 未变化或在死区内的点位不上送，全部未变化时不做序列化
+    thread_local CTagFilter::Batch filter_batch;
+    if (tag_filter_.Filter(tag, tag_count, eng_values.data(), eng_scaled.data(), time, &filter_batch) == 0)
+    {
+        return;
+    }
+
+    // 直接写 JSON，缓冲区按线程复用，格式与 DataValueDto 列表的序列化结果相同
+    thread_local CJsonWriter writer;
+    writer.Clear();
+    writer.BeginArray();
     for (int i = 0; i < tag_count; i++)
     {
-        auto data_dto = vsoa::Object<DataValueDto>::createShared();
-        data_dto->name = tag[i]->name;
-        data_dto->value = DRV_FRAMEWORK->GetTagDataValueToString(tag[i]->data_type, tag[i]->data_length, tag[i]->data);
-        if (tag[i]->time_milli == 0)
+        if (!filter_batch.send[i])
         {
-            data_dto->time = time;
+            continue;
         }
-        else
+        writer.BeginObject();
+        if (tag[i]->name != nullptr)
         {
-            data_dto->time = tag[i]->time_milli;
+            writer.Key("name");
+            writer.String(tag[i]->name);
         }
-        data_dto->quality = "1";
-        data_list->push_back(data_dto);
-    }
-    if (obj_mapper_ != nullptr)
-    {
-        vsoa::String json_data = obj_mapper_->writeToString(data_list);
-        ipc_payload_t payload 
+        writer.Key("value");
+        if (eng_scaled[i])
         {
-            .data = (void*)json_data->c_str(),
-            .data_len = json_data->length()
-        };
-        if (client_handle_ != nullptr)
+            writer.ScaledValue(tag[i]->data_type, eng_values[i]);
+        }
+        else
         {
-            ipc_client_datagram(client_handle_, &pub_url_, &payload);
+            writer.TagValue(tag[i]->data_type, tag[i]->data_length, tag[i]->data);
         }
+        writer.Key("time");
+        writer.UInt(tag[i]->time_milli == 0 ? time : tag[i]->time_milli);
+        writer.Key("quality");
+        writer.String("1", 1);
+        writer.EndObject();
     }
-    else
+    writer.EndArray();
+
+    ipc_payload_t payload 
     {
-        g_logger.LogMessage(LW_LOGLEVEL_ERROR, "obj_mapper_ is nullptr in UpdateTagsData");
+        .data = (void*)writer.Data(),
+        .data_len = writer.Size()
+    };
+    // 只有发出去或已进入合并批次的值才记为已上送，批次之后发送失败时由 OnBatchDrop 重置过滤状态
+    if (client_handle_ != nullptr && ipc_client_datagram(client_handle_, &pub_url_, &payload))
+    {
+        tag_filter_.Commit(tag, tag_count, time, filter_batch);
     }
 }
 int CDriver::OnStart()
@@ -157,6 +193,11 @@ int CDriver::OnStart()
         return -1;
     }
     ipc_client_auto_setup(client_auto_, OnDatagramServerConnect, this);
+    // 数据报优先走共享内存环形缓冲区，node_server 不支持时自动回退到 socket
+    ipc_client_set_shm(ipc_client_auto_handle(client_auto_), true);
+    // 小数据报合并发送，累计 16KB 或 1ms 后刷出
+    ipc_client_set_on_batch_drop(ipc_client_auto_handle(client_auto_), OnBatchDrop, this);
+    ipc_client_batch(ipc_client_auto_handle(client_auto_), 16 * 1024, 1000);
     if (!ipc_client_auto_start(client_auto_, node_server_path_.c_str(), NULL, 0, 1000, 1000, 1000))
     {
         g_logger.LogMessage(LW_LOGLEVEL_ERROR, "Start client to server %s failed",
@@ -336,6 +377,9 @@ void CDriver::InitDriverInterface ()
     }
     driver_info_->device_count = device_num_;
 
+    // 点位配置已重新加载，按新的配置计算变换参数
+    tag_transform_.Reset();
+
 }
 
 void CDriver::UpdateTags2NodeServer()
@@ -372,6 +416,7 @@ void CDriver::UpdateTags2NodeServer()
     if (client_handle_ != nullptr)
     {
         ipc_client_datagram(client_handle_, &init_url_, &init_payload);
+        ipc_client_flush(client_handle_);
     }
     else
     {
@@ -389,6 +434,7 @@ void CDriver::DestroyDevices()
         device_pair.second->Stop();
     }
     devices_.clear();
+    tag_transform_.Reset();
     return;
 }
 
@@ -14,6 +14,8 @@
 #pragma once
 
 #include "device.h"
+#include "tag_transform.h"
+#include "tag_filter.h"
 #include <string>
 
 #include "lwdrvcmn.h"
@@ -45,6 +47,8 @@ public:
     void InitDriverInterface();
     int HandleWriteCmd(std::string tag_name, std::string tag_value);
     void UpdateTagsData(LWTAG **tag, int tag_count);
+    void SetIntegrityPeriod(int period_ms) { tag_filter_.SetIntegrityPeriod(period_ms); }
+    void SetTagDeadband(LWTAG *tag, double deadband) { tag_filter_.SetDeadband(tag, deadband); }
     void UpdateTags2NodeServer();
     // 下发控制命令
     void PostControlCmd(CDevice *device, LWTAG *tag, std::string tag_value);
@@ -65,6 +69,7 @@ private:
     static void OnWriteCmd(vsoa_sdk::server::CliRpcInfo& cli, const void* dto, size_t len, void* arg);
     static void OnServerCmd(vsoa_sdk::server::CliRpcInfo& cli, const void* dto, size_t len, void* arg);
     static void OnNodeserverCb(void *arg, ipc_client_t *client, ipc_url_t *url, ipc_payload_t *payload);
+    static void OnBatchDrop(void *arg, ipc_client_t *client);
 
 private:
     int LWDRIVER_Reset(LWDRIVER *pDriver);
@@ -99,4 +104,6 @@ private:
     ipc_client_auto_t *client_auto_ = nullptr;
     ipc_client_t *client_handle_ = nullptr; // client handle for vsoa server
     std::shared_ptr<vsoa::parser::json::mapping::ObjectMapper> obj_mapper_ = nullptr;
+    CTagTransform tag_transform_; // 上送前的工程量变换
+    CTagFilter tag_filter_; // 上送前的变化检测和死区过滤
 };
@@ -24,6 +24,10 @@ typedef long (*PFN_UnInitDevice)(LWDEVICE *pDevice);
 typedef void (*PFN_OnDeviceConnStateChanged)(LWDEVICE *pDevice, int nConnectState);
 
 typedef long (*PFN_OnTimer)(LWDEVICE *pDevice, DRVTIMER *timeInfo);
+// 可选：按轮询组读取点位，由框架按点位的 polling_interval 调度。
+// 未导出时框架不轮询，OnTimer 只用于驱动自己通过 drv_create_timer 创建的定时器。
+// 在轮询工作线程中调用，线程约定见 lwdrvcmn.h 中的 drv_set_poll_concurrency
+typedef long (*PFN_OnReadTags)(LWDEVICE *pDevice, LWTAG **ppTags, int nTagCount, DRVTIMER *timeInfo);
 typedef long (*PFN_OnControl)(LWDEVICE *pDevice, LWTAG *pTag, const char *szStrValue, int nBinValueLen, long lCmdId);
 
 typedef long (*PFN_UnInitDriver)(LWDRIVER *pDriver);
@@ -39,6 +43,7 @@ class DrvFramework
         pfnUnInitDevice_ = nullptr;
         pfnOnDeviceConnStateChanged_ = nullptr;
         pfnOnTimer_ = nullptr;
+        pfnOnReadTags_ = nullptr;
         pfnOnControl_ = nullptr;
         pfnGetVersion_ = nullptr;
     }
@@ -56,6 +61,7 @@ public:
     PFN_UnInitDevice     pfnUnInitDevice_;
     PFN_OnDeviceConnStateChanged     pfnOnDeviceConnStateChanged_;
     PFN_OnTimer          pfnOnTimer_;
+    PFN_OnReadTags       pfnOnReadTags_;
     PFN_OnControl        pfnOnControl_;
     PFN_GetVersion       pfnGetVersion_;
 
@@ -0,0 +1,327 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: json_writer.cpp .
+*
+* Date: 2026-03-18
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#include "json_writer.h"
+
+#include "lwdrvcmn.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const char kHex[] = "0123456789ABCDEF";
+
+// 解码一个 UTF-8 字符，返回字节数，非法序列返回 0
+size_t DecodeUtf8(const unsigned char *p, size_t len, uint32_t *code)
+{
+    size_t num;
+    uint32_t c;
+    if ((p[0] & 0xE0) == 0xC0) {
+        num = 2;
+        c = p[0] & 0x1F;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        num = 3;
+        c = p[0] & 0x0F;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        num = 4;
+        c = p[0] & 0x07;
+    } else {
+        return 0;
+    }
+    if (num > len) {
+        return 0;
+    }
+    for (size_t i = 1; i < num; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        c = (c << 6) | (p[i] & 0x3F);
+    }
+    *code = c;
+    return num;
+}
+
+} // namespace
+
+void CJsonWriter::Clear()
+{
+    buf_.clear();
+    first_ = true;
+    after_key_ = false;
+}
+
+void CJsonWriter::Separator()
+{
+    if (after_key_) {
+        after_key_ = false;
+    } else if (!first_) {
+        buf_.push_back(',');
+    }
+    first_ = false;
+}
+
+void CJsonWriter::Key(const char *key)
+{
+    Separator();
+    buf_.push_back('"');
+    Escape(key, strlen(key));
+    buf_.append("\":", 2);
+    after_key_ = true;
+}
+
+void CJsonWriter::String(const char *str)
+{
+    String(str, str ? strlen(str) : 0);
+}
+
+void CJsonWriter::String(const char *str, size_t len)
+{
+    Separator();
+    buf_.push_back('"');
+    Escape(str, len);
+    buf_.push_back('"');
+}
+
+void CJsonWriter::Int(int64_t value)
+{
+    Separator();
+    AppendInteger(value);
+}
+
+void CJsonWriter::UInt(uint64_t value)
+{
+    Separator();
+    AppendInteger(value);
+}
+
+void CJsonWriter::Fixed(double value)
+{
+    Separator();
+    AppendFixed(value);
+}
+
+void CJsonWriter::ScaledValue(int data_type, double value)
+{
+    Separator();
+    buf_.push_back('"');
+
+    switch (data_type) {
+    case TAG_DT_BOOL:
+        // 与 TagValue 相同，同一点位有无变换时格式一致
+        if (value != 0) {
+            buf_.append("true", 4);
+        } else {
+            buf_.append("false", 5);
+        }
+        break;
+    case TAG_DT_INT8:
+    case TAG_DT_UINT8:
+    case TAG_DT_INT16:
+    case TAG_DT_UINT16:
+    case TAG_DT_INT32:
+    case TAG_DT_UINT32:
+    case TAG_DT_INT64:
+    case TAG_DT_UINT64:
+        // 超出 64 位整数范围时饱和，避免未定义的转换
+        value = std::round(value);
+        if (std::isnan(value)) {
+            AppendFixed(value);
+        } else if (value >= 18446744073709551616.0) {
+            AppendInteger(UINT64_MAX);
+        } else if (value >= 9223372036854775808.0) {
+            AppendInteger((uint64_t)value);
+        } else if (value <= -9223372036854775808.0) {
+            AppendInteger(INT64_MIN);
+        } else {
+            AppendInteger((int64_t)value);
+        }
+        break;
+    default:
+        AppendFixed(value);
+        break;
+    }
+
+    buf_.push_back('"');
+}
+
+template <typename T>
+void CJsonWriter::AppendInteger(T value)
+{
+    char tmp[24];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    buf_.append(tmp, res.ptr - tmp);
+}
+
+void CJsonWriter::AppendFixed(double value)
+{
+    // 最大的 double 定点表示有 309 位整数
+    char tmp[320];
+    auto res = std::to_chars(tmp, tmp + sizeof(tmp), value, std::chars_format::fixed, 6);
+    buf_.append(tmp, res.ptr - tmp);
+}
+
+void CJsonWriter::Escape(const char *str, size_t len)
+{
+    // 转义规则与 vsoa 序列化器的 FLAG_ESCAPE_ALL 相同
+    const unsigned char *p = (const unsigned char *)str;
+    size_t i = 0;
+    while (i < len) {
+        // 连续的普通字符一次追加
+        size_t start = i;
+        while (i < len && p[i] >= 0x20 && p[i] < 0x80 && p[i] != '"' && p[i] != '\\' && p[i] != '/') {
+            i++;
+        }
+        if (i > start) {
+            buf_.append(str + start, i - start);
+            if (i == len) {
+                break;
+            }
+        }
+
+        unsigned char c = p[i];
+        switch (c) {
+        case '"':  buf_.append("\\\"", 2); i++; continue;
+        case '\\': buf_.append("\\\\", 2); i++; continue;
+        case '/':  buf_.append("\\/", 2); i++; continue;
+        case '\b': buf_.append("\\b", 2); i++; continue;
+        case '\f': buf_.append("\\f", 2); i++; continue;
+        case '\n': buf_.append("\\n", 2); i++; continue;
+        case '\r': buf_.append("\\r", 2); i++; continue;
+        case '\t': buf_.append("\\t", 2); i++; continue;
+        default:
+            break;
+        }
+
+        uint32_t code = c;
+        size_t num = 1;
+        if (c >= 0x80) {
+            num = DecodeUtf8(p + i, len - i, &code);
+            if (num == 0) {
+                // 非法 UTF-8 字节原样输出
+                buf_.push_back((char)c);
+                i++;
+                continue;
+            }
+        }
+
+        char esc[12];
+        size_t esc_len = 0;
+        auto put_u16 = [&esc, &esc_len](uint32_t v) {
+            esc[esc_len++] = '\\';
+            esc[esc_len++] = 'u';
+            esc[esc_len++] = kHex[(v >> 12) & 0xF];
+            esc[esc_len++] = kHex[(v >> 8) & 0xF];
+            esc[esc_len++] = kHex[(v >> 4) & 0xF];
+            esc[esc_len++] = kHex[v & 0xF];
+        };
+        if (code < 0x10000) {
+            put_u16(code);
+        } else {
+            code -= 0x10000;
+            put_u16(0xD800 + (code >> 10));
+            put_u16(0xDC00 + (code & 0x3FF));
+        }
+        buf_.append(esc, esc_len);
+        i += num;
+    }
+}
+
+void CJsonWriter::TagValue(int data_type, int data_len, const char *data)
+{
+    Separator();
+    buf_.push_back('"');
+
+    // data 由驱动按数据类型写入，地址不保证对齐
+    switch (data ? data_type : -1) {
+    case TAG_DT_BOOL:
+        if (*(const unsigned char *)data) {
+            buf_.append("true", 4);
+        } else {
+            buf_.append("false", 5);
+        }
+        break;
+    case TAG_DT_INT8: {
+        int8_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger((int)v);
+        break;
+    }
+    case TAG_DT_UINT8: {
+        uint8_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger((unsigned)v);
+        break;
+    }
+    case TAG_DT_INT16: {
+        int16_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger(v);
+        break;
+    }
+    case TAG_DT_UINT16: {
+        uint16_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger(v);
+        break;
+    }
+    case TAG_DT_INT32: {
+        int32_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger(v);
+        break;
+    }
+    case TAG_DT_UINT32: {
+        uint32_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger(v);
+        break;
+    }
+    case TAG_DT_INT64: {
+        int64_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger(v);
+        break;
+    }
+    case TAG_DT_UINT64: {
+        uint64_t v;
+        memcpy(&v, data, sizeof(v));
+        AppendInteger(v);
+        break;
+    }
+    case TAG_DT_FLOAT: {
+        float v;
+        memcpy(&v, data, sizeof(v));
+        AppendFixed(v);
+        break;
+    }
+    case TAG_DT_DOUBLE: {
+        double v;
+        memcpy(&v, data, sizeof(v));
+        AppendFixed(v);
+        break;
+    }
+    case TAG_DT_TEXT:
+    case TAG_DT_BLOB:
+        if (data_len > 0) {
+            Escape(data, data_len);
+        }
+        break;
+    default:
+        break;
+    }
+
+    buf_.push_back('"');
+}
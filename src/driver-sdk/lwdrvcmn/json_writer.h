@@ -0,0 +1,64 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: json_writer.h .
+*
+* Date: 2026-03-18
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 流式 JSON 写入：直接追加到内部缓冲区，Clear 后容量保留，稳定运行时不再分配内存。
+// 不做结构校验，调用者负责 Begin/End 配对
+class CJsonWriter
+{
+public:
+    CJsonWriter() = default;
+    ~CJsonWriter() = default;
+
+    void Clear();
+    void Reserve(size_t size) { buf_.reserve(size); }
+
+    const char *Data() const { return buf_.data(); }
+    size_t Size() const { return buf_.size(); }
+
+    void BeginArray() { Separator(); buf_.push_back('['); first_ = true; }
+    void EndArray() { buf_.push_back(']'); first_ = false; }
+    void BeginObject() { Separator(); buf_.push_back('{'); first_ = true; }
+    void EndObject() { buf_.push_back('}'); first_ = false; }
+
+    void Key(const char *key);
+    void String(const char *str);
+    void String(const char *str, size_t len);
+    void Int(int64_t value);
+    void UInt(uint64_t value);
+
+    // 点位值按数据类型格式化成字符串值，格式与 DrvFramework::GetTagDataValueToString 一致
+    void TagValue(int data_type, int data_len, const char *data);
+    // 工程量按点位数据类型格式化成字符串值：整数和布尔类型四舍五入后按整数输出，其余固定 6 位小数
+    void ScaledValue(int data_type, double value);
+    // 浮点数固定 6 位小数，与 std::to_string 一致
+    void Fixed(double value);
+
+private:
+    void Separator();
+    void Escape(const char *str, size_t len);
+    void AppendFixed(double value);
+    template <typename T>
+    void AppendInteger(T value);
+
+private:
+    std::string buf_;
+    bool first_ = true; // 当前容器中还没有元素
+    bool after_key_ = false; // 刚写完键，值前不需要逗号
+};
@@ -18,6 +18,7 @@
 #include "lwlog/lwlog.h"
 #include "device.h"
 #include "maintask.h"
+#include "read_planner.h"
 
 #include <sstream>
 
@@ -267,4 +268,88 @@ int drv_settagdata_binary(LWTAG *tag, void *value, int value_len, unsigned int t
     memcpy(tag->data, value, value_len);
     tag->data[value_len] = '\0'; // Ensure null-termination for string types
     return 0; // Success
-}
\ No newline at end of file
+}
+LWDRIVER_EXPORTS void *drv_create_read_plan(PFN_DrvParseAddress parser, int max_block, int max_gap)
+{
+    if (parser == nullptr) {
+        g_logger.LogMessage(LW_LOGLEVEL_ERROR, "drv_create_read_plan: parser is null");
+        return nullptr;
+    }
+
+    return new CReadPlanner(parser, max_block, max_gap);
+}
+
+LWDRIVER_EXPORTS int drv_read_plan_add_tags(void *plan, LWTAG **tags, int tag_count)
+{
+    if (plan == nullptr || tags == nullptr || tag_count <= 0) {
+        return 0;
+    }
+
+    return static_cast<CReadPlanner *>(plan)->AddTags(tags, tag_count);
+}
+
+LWDRIVER_EXPORTS int drv_read_plan_get_blocks(void *plan, DRVREADBLOCK **blocks)
+{
+    if (plan == nullptr) {
+        return 0;
+    }
+
+    return static_cast<CReadPlanner *>(plan)->GetBlocks(blocks);
+}
+
+LWDRIVER_EXPORTS void drv_destroy_read_plan(void *plan)
+{
+    delete static_cast<CReadPlanner *>(plan);
+}
+
+LWDRIVER_EXPORTS int drv_set_read_rule(LWDEVICE *device, PFN_DrvParseAddress parser, int max_block, int max_gap)
+{
+    if (device == nullptr || device->_pInternalRef == nullptr) {
+        return -1;
+    }
+
+    CDevice *pDevice = (CDevice *)device->_pInternalRef;
+    pDevice->SetReadRule(parser, max_block, max_gap);
+    return 0;
+}
+
+LWDRIVER_EXPORTS int drv_get_timer_blocks(DRVTIMER *timer, DRVREADBLOCK **blocks)
+{
+    if (timer == nullptr || timer->ptr_user_data[1] == nullptr) {
+        if (blocks) {
+            *blocks = nullptr;
+        }
+        return 0;
+    }
+
+    if (blocks) {
+        *blocks = (DRVREADBLOCK *)timer->ptr_user_data[1];
+    }
+    return timer->int_user_data[1];
+}
+
+LWDRIVER_EXPORTS int drv_set_poll_concurrency(int worker_num, int max_inflight_devices)
+{
+    if (worker_num < 0 || max_inflight_devices < 0) {
+        return -1;
+    }
+
+    MAINTASK->SetPollConcurrency(worker_num, max_inflight_devices);
+    return 0;
+}
+
+LWDRIVER_EXPORTS int drv_set_integrity_period(int period_ms)
+{
+    MAINTASK->SetIntegrityPeriod(period_ms);
+    return 0;
+}
+
+LWDRIVER_EXPORTS int drv_set_tag_deadband(LWTAG *tag, double deadband)
+{
+    if (tag == nullptr || deadband < 0) {
+        return -1;
+    }
+
+    MAINTASK->SetTagDeadband(tag, deadband);
+    return 0;
+}
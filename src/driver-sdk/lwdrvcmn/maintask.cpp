@@ -24,8 +24,10 @@
 extern CLWLog g_logger;
 
 #include "lwcomm/lwcomm.h"
+#include <chrono>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -114,21 +116,30 @@ void CMainTask::svc_thread_main(void *arg)
 {
     CMainTask *pThis = static_cast<CMainTask *>(arg);
     if (pThis) {
-        pThis->OnStart();
+        // 配置或驱动启动失败时不调度轮询，驱动回调依赖的设备和连接都未就绪
+        int ret = pThis->OnStart();
+        if (ret != 0) {
+            g_logger.LogMessage(LW_LOGLEVEL_ERROR, "Main task start failed: %d, tag polling disabled", ret);
+            return;
+        }
+        int group_num = pThis->poll_scheduler_.Build(pThis->drive_info_.GetDevices());
+        g_logger.LogMessage(LW_LOGLEVEL_INFO, "Poll scheduler started, group count: %d", group_num);
         // Main task logic goes here
         while (!pThis->bstop_) {
-            // Perform periodic tasks, e.g., polling devices, processing data, etc.
-            std::this_thread::sleep_for(std::chrono::seconds(3));
-            for (auto &device : pThis->drive_info_.GetDevices()) {
-                // Poll each device
-            }
+            // Poll the tag groups that are due, then wait for the next wheel tick
+            int wait_ms = pThis->poll_scheduler_.RunPending();
 
             // find and process write commands
             std::string write_cmds;
             pThis->ProcessWriteCmds(write_cmds);
+
+            if (wait_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms));
+            }
         }
         // Cleanup and stop the driver
         g_logger.LogMessage(LW_LOGLEVEL_INFO, "Stopping main task...");
+        pThis->poll_scheduler_.Clear();
         pThis->OnStop();
     } 
 }
@@ -155,6 +166,27 @@ std::string dataTypeToString(int data_type) {
     }
 }
 
+// 复制资源管理器创建点位时没有带上的配置：轮询周期和工程量变换参数
+static void CopyTagConfig(LWTAG *dst, const LWTAG *src)
+{
+    if (src->polling_interval > 0) {
+        dst->polling_interval = src->polling_interval;
+    }
+    dst->point_type = src->point_type;
+    dst->transfer_type = src->transfer_type;
+    dst->linear_raw_min = src->linear_raw_min;
+    dst->linear_raw_max = src->linear_raw_max;
+    dst->linear_eng_min = src->linear_eng_min;
+    dst->linear_eng_max = src->linear_eng_max;
+    dst->advanced_algo_lib = src->advanced_algo_lib ? strdup(src->advanced_algo_lib) : nullptr;
+    dst->advanced_param1 = src->advanced_param1 ? strdup(src->advanced_param1) : nullptr;
+    dst->advanced_param2 = src->advanced_param2 ? strdup(src->advanced_param2) : nullptr;
+    dst->advanced_param3 = src->advanced_param3 ? strdup(src->advanced_param3) : nullptr;
+    dst->advanced_param4 = src->advanced_param4 ? strdup(src->advanced_param4) : nullptr;
+    dst->enable_control = src->enable_control;
+    dst->enable_history = src->enable_history;
+}
+
 int CMainTask::LoadConfig()
 {
     try {
@@ -255,13 +287,16 @@ int CMainTask::LoadConfig()
                                 auto tag = device->pptags[j];
                                 if (tag) {
                                     // 使用资源管理器添加点位到设备
-                                    RESOURCE_MANAGER.GetDriverManager()->GetDeviceManager()->AddTagToDevice(
+                                    LWTAG *tag_info = RESOURCE_MANAGER.GetDriverManager()->GetDeviceManager()->AddTagToDevice(
                                         device->name ? device->name : "",
                                         tag->name ? tag->name : "",
                                         tag->address ? tag->address : "",
                                         tag->data_type,
                                         tag->len_bit
                                     );
+                                    if (tag_info) {
+                                        CopyTagConfig(tag_info, tag);
+                                    }
                                     ++tag_num_;
                                 }
                             }
@@ -17,6 +17,7 @@
 #include "drvframework.h"
 #include "lwdrvcmn.h"
 #include "driver.h"
+#include "poll_scheduler.h"
 #include "lwlog/lwlog.h"
 #include "lwcomm/lwcomm.h"
 #include <map>
@@ -34,6 +35,9 @@ public:
 
     int CalcDriverTagDataSize(unsigned int *pnTagCount, unsigned int *pnTagDataSize, unsigned int *pnTagMaxDataSize);
     int ProcessWriteCmds(std::string &strCmds);
+    void SetPollConcurrency(int worker_num, int max_inflight) { poll_scheduler_.SetConcurrency(worker_num, max_inflight); }
+    void SetIntegrityPeriod(int period_ms) { drive_info_.SetIntegrityPeriod(period_ms); }
+    void SetTagDeadband(LWTAG *tag, double deadband) { drive_info_.SetTagDeadband(tag, deadband); }
 private:
 
     // 线程初始化
@@ -59,6 +63,7 @@ private:
     CDriver drive_info_;
     int     tag_num_; // 该驱动的tag点个数
     int     device_num_; // 该驱动的设备数量
+    CPollScheduler poll_scheduler_; // 按点位周期轮询设备
 };
 
 #define MAINTASK CMainTask::GetInstance()
@@ -0,0 +1,382 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: poll_scheduler.cpp .
+*
+* Date: 2026-03-02
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#include "poll_scheduler.h"
+
+#include "device.h"
+#include "drvframework.h"
+#include "lwlog/lwlog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+extern CLWLog g_logger;
+
+CPollScheduler::CPollScheduler()
+    : worker_num_(1), max_inflight_(0), reconfigure_(false),
+      wheel_(kWheelSlots), clock_(SteadyClockUs), start_us_(SteadyClockUs()),
+      cur_tick_(0), stats_start_us_(0)
+{
+}
+
+CPollScheduler::~CPollScheduler()
+{
+    Clear();
+}
+
+void CPollScheduler::Clear()
+{
+    // 先停工作线程，队列中的任务引用着轮询组
+    workers_.Stop();
+    for (auto &slot : wheel_) {
+        slot.clear();
+    }
+    groups_.clear();
+    device_stats_.clear();
+    retired_groups_.clear();
+    retired_stats_.clear();
+    tag_versions_.clear();
+    cur_tick_ = 0;
+}
+
+void CPollScheduler::RetireGroups()
+{
+    // 重建时不停工作线程，卡在超时上的设备不阻塞其他设备的新计划
+    for (auto &slot : wheel_) {
+        slot.clear();
+    }
+    for (auto &group : groups_) {
+        if (group->busy) {
+            retired_groups_.push_back(std::move(group));
+        }
+    }
+    groups_.clear();
+    for (auto &stats : device_stats_) {
+        retired_stats_.push_back(std::move(stats));
+    }
+    device_stats_.clear();
+    tag_versions_.clear();
+    ReleaseRetired();
+}
+
+void CPollScheduler::ReleaseRetired()
+{
+    // busy 在读取结束时最后清除，之后工作线程不再访问该组
+    retired_groups_.erase(std::remove_if(retired_groups_.begin(), retired_groups_.end(),
+        [](const std::unique_ptr<PollGroup> &group) { return !group->busy; }), retired_groups_.end());
+    if (retired_groups_.empty()) {
+        retired_stats_.clear();
+    }
+}
+
+uint64_t CPollScheduler::SteadyClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t CPollScheduler::ElapsedUs() const
+{
+    return clock_() - start_us_;
+}
+
+void CPollScheduler::SetClock(PFN_SchedulerClock clock)
+{
+    clock_ = clock ? clock : SteadyClockUs;
+    start_us_ = clock_();
+}
+
+void CPollScheduler::SetConcurrency(int worker_num, int max_inflight)
+{
+    worker_num_ = worker_num;
+    max_inflight_ = max_inflight;
+    reconfigure_ = true;
+}
+
+int CPollScheduler::Build(const std::map<std::string, CDevice*> &devices)
+{
+    RetireGroups();
+    devices_ = devices;
+    reconfigure_ = false;
+
+    // 只轮询导出 OnReadTags 的驱动，其余驱动仍用 drv_create_timer 的定时器自行轮询
+    if (DRV_FRAMEWORK->pfnOnReadTags_ == nullptr) {
+        g_logger.LogMessage(LW_LOGLEVEL_INFO, "Driver does not export OnReadTags, tags are polled by driver timers");
+        return 0;
+    }
+
+    // 时间基准在调度器生命周期内不变，重建后从当前 tick 继续，旧组的读取仍按同一基准计时
+    uint64_t now_us = ElapsedUs();
+    cur_tick_ = now_us / (kTickMs * 1000);
+    stats_start_us_ = now_us;
+
+    // 按周期收集轮询组，用于计算相位
+    std::map<int, std::vector<PollGroup *>> by_interval;
+
+    for (auto &device_pair : devices) {
+        CDevice *device = device_pair.second;
+        if (device == nullptr) {
+            continue;
+        }
+
+        tag_versions_.emplace_back(device, device->GetTagVersion());
+        std::unique_ptr<DeviceCycleStats> stats(new DeviceCycleStats());
+        stats->device = device;
+
+        std::map<int, PollGroup *> device_groups;
+        for (LWTAG *tag : device->GetTags()) {
+            if (tag == nullptr) {
+                continue;
+            }
+            int interval = tag->polling_interval > 0 ? tag->polling_interval : kDefaultIntervalMs;
+
+            auto it = device_groups.find(interval);
+            if (it == device_groups.end()) {
+                std::unique_ptr<PollGroup> group(new PollGroup());
+                group->device = device;
+                group->device_stats = stats.get();
+                group->interval_ms = interval;
+                group->interval_ticks = std::max<uint64_t>(1, (interval + kTickMs / 2) / kTickMs);
+                it = device_groups.emplace(interval, group.get()).first;
+                by_interval[interval].push_back(group.get());
+                groups_.push_back(std::move(group));
+            }
+            it->second->tags.push_back(tag);
+        }
+        if (!device_groups.empty()) {
+            device_stats_.push_back(std::move(stats));
+        }
+    }
+
+    // 同周期的组均匀分布在一个周期内，避免同时到期
+    for (auto &interval_pair : by_interval) {
+        auto &vec_groups = interval_pair.second;
+        uint64_t count = vec_groups.size();
+        for (uint64_t k = 0; k < count; k++) {
+            PollGroup *group = vec_groups[k];
+            uint64_t phase_ticks = group->interval_ticks * k / count;
+
+            group->phase_ms = static_cast<int>(phase_ticks * kTickMs);
+            group->due_tick = cur_tick_ + phase_ticks;
+
+            memset(&group->timer_info, 0, sizeof(group->timer_info));
+            group->timer_info.period_ms = group->interval_ms;
+            group->timer_info.phase_ms = group->phase_ms;
+            group->timer_info.internal_ref = group;
+            PlanBlocks(group);
+
+            Schedule(group);
+            g_logger.LogMessage(LW_LOGLEVEL_INFO, "Poll group: device %s, interval %d ms, phase %d ms, tags %d",
+                group->device->GetDeviceName().c_str(), group->interval_ms, group->phase_ms,
+                static_cast<int>(group->tags.size()));
+        }
+    }
+
+    // 每个设备固定在一个工作线程上。默认一个线程，所有设备串行轮询；
+    // 驱动设为 0 时每个设备一个线程，最多 kAutoMaxWorkers 个，更多的设备按轮转共用线程。
+    // 没有轮询组时保留现有线程，等待其中的读取结束
+    if (!groups_.empty()) {
+        int worker_num = worker_num_;
+        if (worker_num <= 0) {
+            worker_num = std::min(static_cast<int>(device_stats_.size()), static_cast<int>(kAutoMaxWorkers));
+        }
+        workers_.Resize(worker_num, max_inflight_);
+    }
+
+    return static_cast<int>(groups_.size());
+}
+
+void CPollScheduler::PlanBlocks(PollGroup *group)
+{
+    CDevice *device = group->device;
+    DeviceReadRule rule = device->GetReadRule();
+    if (rule.parser == nullptr) {
+        return;
+    }
+
+    group->planner.reset(new CReadPlanner(rule.parser, rule.max_block, rule.max_gap));
+    int failed = group->planner->AddTags(group->tags.data(), static_cast<int>(group->tags.size()));
+    if (failed > 0) {
+        g_logger.LogMessage(LW_LOGLEVEL_WARN, "Device %s: %d tags with unparsable address are not block read",
+            device->GetDeviceName().c_str(), failed);
+    }
+
+    DRVREADBLOCK *blocks = nullptr;
+    group->timer_info.int_user_data[1] = group->planner->GetBlocks(&blocks);
+    group->timer_info.ptr_user_data[1] = blocks;
+    g_logger.LogMessage(LW_LOGLEVEL_INFO, "Device %s, interval %d ms: %d tags planned into %d block reads",
+        device->GetDeviceName().c_str(), group->interval_ms, static_cast<int>(group->tags.size()) - failed,
+        group->timer_info.int_user_data[1]);
+}
+
+bool CPollScheduler::TagsChanged() const
+{
+    for (auto &version : tag_versions_) {
+        if (version.first->GetTagVersion() != version.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CPollScheduler::Schedule(PollGroup *group)
+{
+    wheel_[group->due_tick % kWheelSlots].push_back(group);
+}
+
+void CPollScheduler::UpdateMax(std::atomic<uint64_t> &max, uint64_t value)
+{
+    uint64_t cur = max.load();
+    while (value > cur && !max.compare_exchange_weak(cur, value)) {
+    }
+}
+
+void CPollScheduler::Dispatch(PollGroup *group)
+{
+    if (group->busy.exchange(true)) {
+        // 上一次读取还没完成（设备超时等），本周期不再排队
+        group->missed++;
+    } else {
+        uint64_t due_us = start_us_ + group->due_tick * kTickMs * 1000;
+        workers_.Post(group->device, [this, group, due_us] {
+            Poll(group, due_us);
+        });
+    }
+
+    // 保持相位对齐，跳过已经错过的周期而不是连续补读
+    uint64_t now_tick = ElapsedUs() / (kTickMs * 1000);
+    group->due_tick += group->interval_ticks;
+    if (group->due_tick <= now_tick) {
+        uint64_t missed = (now_tick - group->due_tick) / group->interval_ticks + 1;
+        group->due_tick += missed * group->interval_ticks;
+        group->missed += missed;
+    }
+    Schedule(group);
+}
+
+void CPollScheduler::Poll(PollGroup *group, uint64_t due_us)
+{
+    LWDEVICE *device_if = group->device->GetDeviceInterface();
+    uint64_t begin_us = clock_();
+
+    DRV_FRAMEWORK->pfnOnReadTags_(device_if, group->tags.data(),
+        static_cast<int>(group->tags.size()), &group->timer_info);
+
+    uint64_t end_us = clock_();
+    uint64_t cost_us = end_us - begin_us;
+    group->polls++;
+    group->window_polls++;
+    group->cost_total_us += cost_us;
+    UpdateMax(group->cost_max_us, cost_us);
+    if (cost_us > static_cast<uint64_t>(group->interval_ms) * 1000) {
+        group->overruns++;
+        g_logger.LogMessage(LW_LOGLEVEL_DEBUG, "Poll overrun: device %s, interval %d ms, cost %d ms",
+            group->device->GetDeviceName().c_str(), group->interval_ms, static_cast<int>(cost_us / 1000));
+    }
+
+    DeviceCycleStats *stats = group->device_stats;
+    uint64_t cycle_us = end_us > due_us ? end_us - due_us : 0;
+    stats->cycles++;
+    stats->cycle_total_us += cycle_us;
+    stats->cycle_last_us = cycle_us;
+    UpdateMax(stats->cycle_max_us, cycle_us);
+
+    group->busy = false;
+}
+
+int CPollScheduler::RunPending()
+{
+    // 点位、块读规则或并发配置变化后重新分组和规划
+    if (reconfigure_.exchange(false) || TagsChanged()) {
+        std::map<std::string, CDevice*> devices = devices_;
+        g_logger.LogMessage(LW_LOGLEVEL_INFO, "Poll configuration changed, rebuilding poll groups");
+        Build(devices);
+    }
+
+    if (!retired_groups_.empty()) {
+        ReleaseRetired();
+    }
+
+    if (groups_.empty()) {
+        return kIdleWaitMs;
+    }
+
+    uint64_t now_us = ElapsedUs();
+    uint64_t now_tick = now_us / (kTickMs * 1000);
+
+    while (cur_tick_ <= now_tick) {
+        // 槽内还可能有后续轮次的组，只取出已到期的
+        auto &slot = wheel_[cur_tick_ % kWheelSlots];
+        due_.clear();
+        for (size_t i = 0; i < slot.size();) {
+            if (slot[i]->due_tick <= cur_tick_) {
+                due_.push_back(slot[i]);
+                slot[i] = slot.back();
+                slot.pop_back();
+            } else {
+                i++;
+            }
+        }
+        cur_tick_++;
+
+        for (PollGroup *group : due_) {
+            Dispatch(group);
+        }
+    }
+
+    now_us = ElapsedUs();
+    if (now_us - stats_start_us_ >= static_cast<uint64_t>(kStatsPeriodMs) * 1000) {
+        LogStats(now_us - stats_start_us_);
+        stats_start_us_ = now_us;
+    }
+
+    uint64_t next_us = cur_tick_ * kTickMs * 1000;
+    if (next_us <= now_us) {
+        return 0;
+    }
+    return static_cast<int>((next_us - now_us + 999) / 1000);
+}
+
+void CPollScheduler::LogStats(uint64_t elapsed_us)
+{
+    if (elapsed_us == 0) {
+        return;
+    }
+
+    for (auto &group : groups_) {
+        uint64_t polls = group->polls;
+        double configured = 1000.0 / group->interval_ms;
+        double achieved = group->window_polls.exchange(0) * 1000000.0 / elapsed_us;
+        uint64_t avg_us = polls ? group->cost_total_us / polls : 0;
+
+        // 实际速率低于配置的 90% 视为跟不上
+        int level = achieved < configured * 0.9 ? LW_LOGLEVEL_WARN : LW_LOGLEVEL_INFO;
+        g_logger.LogMessage(level, "Poll stats: device %s, interval %d ms, rate %.2f/%.2f Hz, "
+            "polls %llu, overruns %llu, missed %llu, cost avg %llu us, max %llu us",
+            group->device->GetDeviceName().c_str(), group->interval_ms, achieved, configured,
+            (unsigned long long)polls, (unsigned long long)group->overruns.load(),
+            (unsigned long long)group->missed.load(), (unsigned long long)avg_us,
+            (unsigned long long)group->cost_max_us.load());
+    }
+
+    for (auto &stats : device_stats_) {
+        uint64_t cycles = stats->cycles;
+        uint64_t avg_us = cycles ? stats->cycle_total_us / cycles : 0;
+        g_logger.LogMessage(LW_LOGLEVEL_INFO, "Device cycle: device %s, cycles %llu, last %llu us, avg %llu us, max %llu us",
+            stats->device->GetDeviceName().c_str(), (unsigned long long)cycles,
+            (unsigned long long)stats->cycle_last_us.load(), (unsigned long long)avg_us,
+            (unsigned long long)stats->cycle_max_us.load());
+    }
+}
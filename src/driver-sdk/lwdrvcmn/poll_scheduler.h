@@ -0,0 +1,133 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: poll_scheduler.h .
+*
+* Date: 2026-03-02
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#pragma once
+
+#include "lwdrvcmn.h"
+#include "read_planner.h"
+#include "device_workers.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CDevice;
+
+// 调度时钟，返回单调递增的微秒数
+typedef uint64_t (*PFN_SchedulerClock)();
+
+// 设备统计：一次轮询从到期到完成的周期时间，包含排队和等待并发名额的时间
+struct DeviceCycleStats
+{
+    CDevice *device;
+    std::atomic<uint64_t> cycles{0};
+    std::atomic<uint64_t> cycle_total_us{0};
+    std::atomic<uint64_t> cycle_max_us{0};
+    std::atomic<uint64_t> cycle_last_us{0};
+};
+
+// 轮询组：同一设备上轮询周期相同的点位
+struct PollGroup
+{
+    CDevice *device;
+    DeviceCycleStats *device_stats;
+    int interval_ms;                // 配置的轮询周期
+    int phase_ms;                   // 相位偏移，错开同周期的组
+    std::vector<LWTAG *> tags;
+    DRVTIMER timer_info;            // 传给驱动读回调的周期信息
+    std::unique_ptr<CReadPlanner> planner; // 设备设置了块读规则时的块读计划
+
+    uint64_t interval_ticks;
+    uint64_t due_tick;              // 下次到期的绝对 tick
+    std::atomic<bool> busy{false};  // 上一次读取还在工作线程中
+
+    // 统计信息，由工作线程更新
+    std::atomic<uint64_t> polls{0};         // 累计读取次数
+    std::atomic<uint64_t> overruns{0};      // 单次读取耗时超过周期的次数
+    std::atomic<uint64_t> missed{0};        // 因上次未完成或延迟被跳过的周期数
+    std::atomic<uint64_t> cost_total_us{0};
+    std::atomic<uint64_t> cost_max_us{0};
+    std::atomic<uint64_t> window_polls{0};  // 当前统计窗口内的读取次数
+};
+
+// 轮询调度器：按 (设备, 周期) 分组，由哈希时间轮驱动
+class CPollScheduler
+{
+public:
+    CPollScheduler();
+    ~CPollScheduler();
+
+    // 根据点位的 polling_interval 建立轮询组并计算相位
+    int Build(const std::map<std::string, CDevice*> &devices);
+    void Clear();
+
+    // 设置工作线程数和同时访问设备的最大个数，默认一个线程，0 表示自动，下次调度时生效
+    void SetConcurrency(int worker_num, int max_inflight);
+    int GetWorkerNum() const { return workers_.GetWorkerNum(); }
+
+    // 派发所有到期的轮询组，返回距下一个 tick 的等待毫秒数
+    int RunPending();
+
+    // 输出各组实际速率与配置速率
+    void LogStats(uint64_t elapsed_us);
+
+    size_t GetGroupNum() const { return groups_.size(); }
+    const std::vector<std::unique_ptr<PollGroup>> &GetGroups() const { return groups_; }
+
+    // 替换调度时钟并重新取时间基准，nullptr 恢复 steady_clock，需在 Build 之前设置
+    void SetClock(PFN_SchedulerClock clock);
+
+public:
+    static const int kTickMs = 10;              // 时间轮精度
+    static const int kWheelSlots = 512;         // 时间轮槽数，约 5 秒一圈
+    static const int kDefaultIntervalMs = 1000; // 点位未配置周期时使用
+    static const int kIdleWaitMs = 1000;        // 没有轮询组时的等待时间
+    static const int kStatsPeriodMs = 60000;    // 统计输出周期
+    static const int kAutoMaxWorkers = 32;      // 自动配置时的最大工作线程数
+
+private:
+    void RetireGroups();
+    void ReleaseRetired();
+    void Schedule(PollGroup *group);
+    void PlanBlocks(PollGroup *group);
+    bool TagsChanged() const;
+    void Dispatch(PollGroup *group);
+    // due_us 及读取耗时均为时钟的绝对值，不受重建影响
+    void Poll(PollGroup *group, uint64_t due_us);
+    static void UpdateMax(std::atomic<uint64_t> &max, uint64_t value);
+    uint64_t ElapsedUs() const;
+    static uint64_t SteadyClockUs();
+
+private:
+    std::map<std::string, CDevice*> devices_;
+    std::vector<std::pair<CDevice *, unsigned int>> tag_versions_; // 建组时各设备的点位版本
+    std::vector<std::unique_ptr<PollGroup>> groups_;
+    std::vector<std::unique_ptr<DeviceCycleStats>> device_stats_;
+    // 重建前的组，还有读取在工作线程中排队或执行，结束后释放
+    std::vector<std::unique_ptr<PollGroup>> retired_groups_;
+    std::vector<std::unique_ptr<DeviceCycleStats>> retired_stats_;
+    CDeviceWorkers workers_;
+    std::atomic<int> worker_num_;
+    std::atomic<int> max_inflight_;
+    std::atomic<bool> reconfigure_;
+    std::vector<std::vector<PollGroup *>> wheel_;
+    PFN_SchedulerClock clock_;
+    uint64_t start_us_;             // 构造或 SetClock 时的时钟值，tick 从这里开始计，之后不再修改
+    std::vector<PollGroup *> due_;  // 当前 tick 到期的组，复用避免分配
+    uint64_t cur_tick_;             // 下一个待处理的 tick
+    uint64_t stats_start_us_;
+};
@@ -0,0 +1,129 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: read_planner.cpp .
+*
+* Date: 2026-03-05
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#include "read_planner.h"
+
+#include "lwlog/lwlog.h"
+
+#include <algorithm>
+#include <climits>
+
+extern CLWLog g_logger;
+
+CReadPlanner::CReadPlanner(PFN_DrvParseAddress parser, int max_block, int max_gap)
+    : parser_(parser),
+      max_block_(max_block > 0 ? max_block : INT_MAX),
+      max_gap_(max_gap > 0 ? max_gap : 0)
+{
+}
+
+void CReadPlanner::Clear()
+{
+    entries_.clear();
+    blocks_.clear();
+    block_tags_.clear();
+    block_offsets_.clear();
+}
+
+int CReadPlanner::AddTags(LWTAG **tags, int tag_count)
+{
+    int failed = 0;
+
+    for (int i = 0; i < tag_count; i++) {
+        TagAddr entry;
+        entry.tag = tags[i];
+        if (entry.tag == nullptr) {
+            continue;
+        }
+        if (parser_ == nullptr || parser_(entry.tag, &entry.addr) != 0 || entry.addr.length <= 0) {
+            g_logger.LogMessage(LW_LOGLEVEL_DEBUG, "Read planner: cannot parse address %s of tag %s",
+                entry.tag->address ? entry.tag->address : "", entry.tag->name ? entry.tag->name : "");
+            failed++;
+            continue;
+        }
+        entries_.push_back(entry);
+    }
+
+    Replan();
+    return failed;
+}
+
+void CReadPlanner::Replan()
+{
+    // 同一区内按起始地址排序，长的在前，便于合并重叠地址
+    std::sort(entries_.begin(), entries_.end(), [](const TagAddr &a, const TagAddr &b) {
+        if (a.addr.area != b.addr.area) {
+            return a.addr.area < b.addr.area;
+        }
+        if (a.addr.offset != b.addr.offset) {
+            return a.addr.offset < b.addr.offset;
+        }
+        return a.addr.length > b.addr.length;
+    });
+
+    blocks_.clear();
+    block_tags_.clear();
+    block_offsets_.clear();
+    block_tags_.reserve(entries_.size());
+    block_offsets_.reserve(entries_.size());
+
+    // 贪心合并：空洞不超过 max_gap 且合并后不超过 max_block 时并入当前块，
+    // 完全落在当前块内的点位不增加读取长度，总是并入
+    for (size_t i = 0; i < entries_.size(); i++) {
+        const DRVADDR &addr = entries_[i].addr;
+        long long end = (long long)addr.offset + addr.length;
+
+        if (!blocks_.empty()) {
+            DRVREADBLOCK &block = blocks_.back();
+            long long block_end = (long long)block.offset + block.length;
+            long long new_end = std::max(block_end, end);
+            if (addr.area == block.area && addr.offset <= block_end + max_gap_ &&
+                (new_end == block_end || new_end - block.offset <= max_block_)) {
+                block.length = (int)(new_end - block.offset);
+                block.tag_count++;
+                block_tags_.push_back(entries_[i].tag);
+                block_offsets_.push_back(addr.offset - block.offset);
+                continue;
+            }
+        }
+
+        // 开始新块，超过 max_block 的单个点位独占一块
+        DRVREADBLOCK block;
+        block.area = addr.area;
+        block.offset = addr.offset;
+        block.length = addr.length;
+        block.tag_count = 1;
+        block.pptags = nullptr;
+        block.tag_offsets = nullptr;
+        blocks_.push_back(block);
+        block_tags_.push_back(entries_[i].tag);
+        block_offsets_.push_back(0);
+    }
+
+    // 所有点位都已写入，再回填各块指向的数组位置
+    size_t pos = 0;
+    for (auto &block : blocks_) {
+        block.pptags = block_tags_.data() + pos;
+        block.tag_offsets = block_offsets_.data() + pos;
+        pos += block.tag_count;
+    }
+}
+
+int CReadPlanner::GetBlocks(DRVREADBLOCK **blocks)
+{
+    if (blocks) {
+        *blocks = blocks_.empty() ? nullptr : blocks_.data();
+    }
+    return static_cast<int>(blocks_.size());
+}
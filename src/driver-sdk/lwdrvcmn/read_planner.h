@@ -0,0 +1,52 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: read_planner.h .
+*
+* Date: 2026-03-05
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#pragma once
+
+#include "lwdrvcmn.h"
+
+#include <vector>
+
+// 块读规划：把相邻地址的点位合并为尽量少的块读请求
+class CReadPlanner
+{
+public:
+    CReadPlanner(PFN_DrvParseAddress parser, int max_block, int max_gap);
+    ~CReadPlanner() = default;
+
+    // 添加点位并重新规划，返回地址无法解析的点位个数
+    int AddTags(LWTAG **tags, int tag_count);
+    void Clear();
+
+    // 获取块读请求列表，返回块个数
+    int GetBlocks(DRVREADBLOCK **blocks);
+
+private:
+    void Replan();
+
+private:
+    struct TagAddr
+    {
+        LWTAG *tag;
+        DRVADDR addr;
+    };
+
+    PFN_DrvParseAddress parser_;
+    int max_block_; // 单块最大地址单位数
+    int max_gap_; // 可跨越的最大地址空洞
+    std::vector<TagAddr> entries_; // 按 (area, offset) 排序
+    std::vector<DRVREADBLOCK> blocks_;
+    std::vector<LWTAG *> block_tags_; // 各块的 pptags 指向这里
+    std::vector<int> block_offsets_; // 各块的 tag_offsets 指向这里
+};
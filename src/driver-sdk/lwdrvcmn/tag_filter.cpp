@@ -0,0 +1,128 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: tag_filter.cpp .
+*
+* Date: 2026-03-16
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#include "tag_filter.h"
+
+#include "tag_transform.h"
+
+#include <cmath>
+
+CTagFilter::CTagFilter()
+    : generation_(0), integrity_ms_(kDefaultIntegrityMs)
+{
+}
+
+uint64_t CTagFilter::HashData(const char *data, int len)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < len; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void CTagFilter::SetDeadband(LWTAG *tag, double deadband)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    Shadow &shadow = shadows_[tag];
+    shadow.deadband = deadband > 0 ? deadband : 0;
+}
+
+int CTagFilter::Filter(LWTAG **tags, int tag_count, const double *eng, const uint8_t *scaled,
+                       uint64_t now_ms, Batch *batch)
+{
+    int integrity_ms = integrity_ms_;
+    int send_num = 0;
+
+    batch->send.resize(tag_count);
+    batch->hash.resize(tag_count);
+    batch->value.resize(tag_count);
+    batch->quality.resize(tag_count);
+
+    std::lock_guard<std::mutex> guard(lock_);
+    batch->generation = generation_;
+    for (int i = 0; i < tag_count; i++) {
+        LWTAG *tag = tags[i];
+        batch->send[i] = 0;
+        if (tag == nullptr) {
+            continue;
+        }
+
+        // 新点位值初始化为零，sent 为假，第一次必定上送
+        Shadow &shadow = shadows_[tag];
+        uint64_t hash = tag->data ? HashData(tag->data, tag->data_length) : 0;
+
+        double value = 0;
+        bool numeric = false;
+        if (scaled && scaled[i]) {
+            value = eng[i];
+            numeric = true;
+        } else if (shadow.deadband > 0) {
+            numeric = CTagTransform::ReadRawValue(tag, &value);
+        }
+
+        bool changed;
+        if (!shadow.sent || shadow.quality != tag->quantity) {
+            changed = true;
+        } else if (integrity_ms > 0 && now_ms - shadow.sent_ms >= (uint64_t)integrity_ms) {
+            changed = true;
+        } else if (shadow.deadband > 0 && numeric) {
+            // 与上次上送的值比较，缓慢漂移累计超过死区后也会上送
+            changed = std::fabs(value - shadow.value) > shadow.deadband;
+        } else {
+            changed = hash != shadow.hash;
+        }
+
+        if (changed) {
+            batch->send[i] = 1;
+            batch->hash[i] = hash;
+            batch->value[i] = value;
+            batch->quality[i] = tag->quantity;
+            send_num++;
+        }
+    }
+
+    return send_num;
+}
+
+void CTagFilter::Commit(LWTAG **tags, int tag_count, uint64_t now_ms, const Batch &batch)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    if (batch.generation != generation_) {
+        // 发送后接收端重连过，新的连接没有收到这些值
+        return;
+    }
+    for (int i = 0; i < tag_count && i < (int)batch.send.size(); i++) {
+        if (!batch.send[i] || tags[i] == nullptr) {
+            continue;
+        }
+        Shadow &shadow = shadows_[tags[i]];
+        shadow.hash = batch.hash[i];
+        shadow.value = batch.value[i];
+        shadow.sent_ms = now_ms;
+        shadow.quality = batch.quality[i];
+        shadow.sent = true;
+    }
+}
+
+void CTagFilter::Reset()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    for (auto &shadow : shadows_) {
+        shadow.second.sent = false;
+    }
+    generation_++;
+}
@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: tag_filter.h .
+*
+* Date: 2026-03-16
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#pragma once
+
+#include "lwdrvcmn.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 上送过滤：点位值未变化（或变化在死区内）时不再上送，完整性周期到了再补发一次
+class CTagFilter
+{
+public:
+    CTagFilter();
+    ~CTagFilter() = default;
+
+    // 完整性周期，<= 0 表示只在变化时上送
+    void SetIntegrityPeriod(int period_ms) { integrity_ms_ = period_ms; }
+    int GetIntegrityPeriod() const { return integrity_ms_; }
+
+    // 死区，单位与上送值相同（有工程量变换时为工程量），0 表示任何变化都上送
+    void SetDeadband(LWTAG *tag, double deadband);
+
+    // 一次上送的候选点位，按线程复用
+    struct Batch
+    {
+        std::vector<uint8_t> send; // send[i] 置位表示第 i 个点位需要上送
+        std::vector<uint64_t> hash;
+        std::vector<double> value;
+        std::vector<int> quality;
+        uint64_t generation = 0;
+    };
+
+    // 选出需要上送的点位，返回个数。eng/scaled 为工程量变换的结果，可以为空。
+    // 只比较不记录，上送成功后再调用 Commit，失败时下次仍会上送
+    int Filter(LWTAG **tags, int tag_count, const double *eng, const uint8_t *scaled,
+               uint64_t now_ms, Batch *batch);
+    // 记录已经上送的值，期间调用过 Reset 时忽略
+    void Commit(LWTAG **tags, int tag_count, uint64_t now_ms, const Batch &batch);
+    // 接收端重新连接或已提交的值随批次丢失后调用，所有点位下次都会上送，保留死区配置
+    void Reset();
+
+public:
+    static const int kDefaultIntegrityMs = 60000;
+
+private:
+    // 上次上送时的点位影子
+    struct Shadow
+    {
+        uint64_t hash; // 原始数据的哈希
+        double value; // 上送的数值，用于死区判断
+        double deadband;
+        uint64_t sent_ms;
+        int quality;
+        bool sent; // 已经上送过
+    };
+
+    static uint64_t HashData(const char *data, int len);
+
+private:
+    std::mutex lock_;
+    std::unordered_map<LWTAG *, Shadow> shadows_;
+    uint64_t generation_; // Reset 时递增
+    std::atomic<int> integrity_ms_;
+};
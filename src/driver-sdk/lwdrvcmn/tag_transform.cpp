@@ -0,0 +1,309 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: tag_transform.cpp .
+*
+* Date: 2026-03-12
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#include "tag_transform.h"
+
+#include "drvframework.h"
+#include "lwlog/lwlog.h"
+#include "lwcomm/lwcomm.h"
+
+#include <algorithm>
+#include <cstring>
+#include <dlfcn.h>
+
+extern CLWLog g_logger;
+
+CTagTransform::CTagTransform()
+{
+}
+
+CTagTransform::~CTagTransform()
+{
+    DestroyParams();
+
+    for (auto &plugin : plugins_) {
+        if (plugin.second && plugin.second->handle) {
+            dlclose(plugin.second->handle);
+        }
+    }
+    plugins_.clear();
+}
+
+void CTagTransform::DestroyParams()
+{
+    for (auto &param : params_) {
+        Plugin *plugin = param.second.plugin;
+        if (plugin && plugin->destroy && param.second.ctx) {
+            plugin->destroy(param.second.ctx);
+        }
+    }
+    params_.clear();
+}
+
+void CTagTransform::Reset()
+{
+    // 参数以 LWTAG 指针为键，点位重建后地址可能被复用，配置也可能已经改变
+    std::lock_guard<std::mutex> guard(lock_);
+    DestroyParams();
+}
+
+void CTagTransform::ScaleLinear(const double *__restrict raw, const double *__restrict gain,
+                                const double *__restrict offset, const double *__restrict lo,
+                                const double *__restrict hi, double *__restrict out, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        out[i] = std::min(std::max(raw[i] * gain[i] + offset[i], lo[i]), hi[i]);
+    }
+}
+
+bool CTagTransform::ReadRawValue(const LWTAG *tag, double *value)
+{
+    if (tag->data == nullptr) {
+        return false;
+    }
+
+    // data 由驱动按数据类型写入，地址不保证对齐
+    switch (tag->data_type) {
+    case TAG_DT_BOOL:
+        *value = *(const unsigned char *)tag->data ? 1.0 : 0.0;
+        return true;
+    case TAG_DT_INT8: {
+        int8_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = v;
+        return true;
+    }
+    case TAG_DT_UINT8: {
+        uint8_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = v;
+        return true;
+    }
+    case TAG_DT_INT16: {
+        int16_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = v;
+        return true;
+    }
+    case TAG_DT_UINT16: {
+        uint16_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = v;
+        return true;
+    }
+    case TAG_DT_INT32: {
+        int32_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = v;
+        return true;
+    }
+    case TAG_DT_UINT32: {
+        uint32_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = v;
+        return true;
+    }
+    case TAG_DT_INT64: {
+        int64_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = (double)v;
+        return true;
+    }
+    case TAG_DT_UINT64: {
+        uint64_t v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = (double)v;
+        return true;
+    }
+    case TAG_DT_FLOAT: {
+        float v;
+        memcpy(&v, tag->data, sizeof(v));
+        *value = v;
+        return true;
+    }
+    case TAG_DT_DOUBLE:
+        memcpy(value, tag->data, sizeof(*value));
+        return true;
+    default:
+        return false;
+    }
+}
+
+CTagTransform::Plugin *CTagTransform::LoadPlugin(const std::string &lib)
+{
+    auto it = plugins_.find(lib);
+    if (it != plugins_.end()) {
+        return it->second.get();
+    }
+
+    // 先在驱动目录下查找，再交给系统搜索路径
+    std::vector<std::string> paths;
+    if (lib.find(LW_OS_DIR_SEPARATOR_CHAR) == std::string::npos) {
+        std::string drv_path = DRV_FRAMEWORK->GetDrvPath();
+        paths.push_back(drv_path + LW_OS_DIR_SEPARATOR + lib);
+        paths.push_back(drv_path + LW_OS_DIR_SEPARATOR + "lib" + lib + ".so");
+    }
+    paths.push_back(lib);
+
+    void *handle = nullptr;
+    for (auto &path : paths) {
+        handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle) {
+            break;
+        }
+    }
+    if (handle == nullptr) {
+        g_logger.LogMessage(LW_LOGLEVEL_ERROR, "Failed to load algorithm library %s: %s", lib.c_str(), dlerror());
+        plugins_[lib] = nullptr;
+        return nullptr;
+    }
+
+    std::unique_ptr<Plugin> plugin(new Plugin());
+    plugin->handle = handle;
+    plugin->create = (PFN_AlgoCreate)dlsym(handle, LWALGO_CREATE_SYMBOL);
+    plugin->transform = (PFN_AlgoTransform)dlsym(handle, LWALGO_TRANSFORM_SYMBOL);
+    plugin->destroy = (PFN_AlgoDestroy)dlsym(handle, LWALGO_DESTROY_SYMBOL);
+    if (plugin->create == nullptr || plugin->transform == nullptr) {
+        g_logger.LogMessage(LW_LOGLEVEL_ERROR, "Algorithm library %s does not export %s and %s",
+            lib.c_str(), LWALGO_CREATE_SYMBOL, LWALGO_TRANSFORM_SYMBOL);
+        dlclose(handle);
+        plugins_[lib] = nullptr;
+        return nullptr;
+    }
+
+    g_logger.LogMessage(LW_LOGLEVEL_INFO, "Algorithm library %s loaded", lib.c_str());
+    Plugin *ret = plugin.get();
+    plugins_[lib] = std::move(plugin);
+    return ret;
+}
+
+const CTagTransform::TagParam &CTagTransform::Lookup(LWTAG *tag)
+{
+    auto it = params_.find(tag);
+    if (it != params_.end()) {
+        return it->second;
+    }
+
+    TagParam param;
+    param.transfer_type = TAG_TRANSFER_NONE;
+    param.gain = 1.0;
+    param.offset = 0.0;
+    param.eng_lo = std::min(tag->linear_eng_min, tag->linear_eng_max);
+    param.eng_hi = std::max(tag->linear_eng_min, tag->linear_eng_max);
+    param.plugin = nullptr;
+    param.ctx = nullptr;
+
+    if (tag->transfer_type == TAG_TRANSFER_LINEAR) {
+        double raw_span = tag->linear_raw_max - tag->linear_raw_min;
+        if (raw_span != 0.0) {
+            param.transfer_type = TAG_TRANSFER_LINEAR;
+            param.gain = (tag->linear_eng_max - tag->linear_eng_min) / raw_span;
+            param.offset = tag->linear_eng_min - tag->linear_raw_min * param.gain;
+        } else {
+            g_logger.LogMessage(LW_LOGLEVEL_WARN, "Tag %s: linear raw range is empty, scaling ignored", tag->name);
+        }
+    } else if (tag->transfer_type == TAG_TRANSFER_ADVANCED) {
+        if (tag->advanced_algo_lib && tag->advanced_algo_lib[0]) {
+            param.plugin = LoadPlugin(tag->advanced_algo_lib);
+        }
+        if (param.plugin) {
+            param.ctx = param.plugin->create(tag->advanced_param1, tag->advanced_param2,
+                tag->advanced_param3, tag->advanced_param4);
+        }
+        if (param.ctx) {
+            param.transfer_type = TAG_TRANSFER_ADVANCED;
+        } else {
+            g_logger.LogMessage(LW_LOGLEVEL_WARN, "Tag %s: algorithm %s unavailable, raw value is sent",
+                tag->name, tag->advanced_algo_lib ? tag->advanced_algo_lib : "");
+        }
+    }
+
+    return params_.emplace(tag, param).first->second;
+}
+
+int CTagTransform::Apply(LWTAG **tags, int tag_count, double *eng, uint8_t *scaled)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+
+    raw_.resize(tag_count);
+    gain_.resize(tag_count);
+    offset_.resize(tag_count);
+    lo_.resize(tag_count);
+    hi_.resize(tag_count);
+    out_.resize(tag_count);
+    index_.resize(tag_count);
+    algo_items_.clear();
+
+    // 收集线性缩放点位的原始值和参数
+    size_t linear_num = 0;
+    for (int i = 0; i < tag_count; i++) {
+        scaled[i] = 0;
+        if (tags[i] == nullptr || tags[i]->transfer_type == TAG_TRANSFER_NONE) {
+            continue;
+        }
+        const TagParam &param = Lookup(tags[i]);
+        double raw;
+        if (param.transfer_type == TAG_TRANSFER_NONE || !ReadRawValue(tags[i], &raw)) {
+            continue;
+        }
+        if (param.transfer_type == TAG_TRANSFER_LINEAR) {
+            raw_[linear_num] = raw;
+            gain_[linear_num] = param.gain;
+            offset_[linear_num] = param.offset;
+            lo_[linear_num] = param.eng_lo;
+            hi_[linear_num] = param.eng_hi;
+            index_[linear_num] = i;
+            linear_num++;
+        } else {
+            algo_items_.push_back({param.plugin, param.ctx, raw, i});
+        }
+    }
+
+    int done = 0;
+    ScaleLinear(raw_.data(), gain_.data(), offset_.data(), lo_.data(), hi_.data(), out_.data(), linear_num);
+    for (size_t k = 0; k < linear_num; k++) {
+        eng[index_[k]] = out_[k];
+        scaled[index_[k]] = 1;
+    }
+    done += static_cast<int>(linear_num);
+
+    // 同一插件的点位合并成一次调用
+    std::stable_sort(algo_items_.begin(), algo_items_.end(), [](const AlgoItem &a, const AlgoItem &b) {
+        return a.plugin < b.plugin;
+    });
+    for (size_t begin = 0; begin < algo_items_.size();) {
+        Plugin *plugin = algo_items_[begin].plugin;
+        size_t end = begin;
+        ctxs_.clear();
+        while (end < algo_items_.size() && algo_items_[end].plugin == plugin) {
+            ctxs_.push_back(algo_items_[end].ctx);
+            raw_[end - begin] = algo_items_[end].raw;
+            end++;
+        }
+
+        int count = static_cast<int>(end - begin);
+        if (plugin->transform(ctxs_.data(), raw_.data(), out_.data(), count) == 0) {
+            for (size_t k = begin; k < end; k++) {
+                eng[algo_items_[k].index] = out_[k - begin];
+                scaled[algo_items_[k].index] = 1;
+            }
+            done += count;
+        } else {
+            g_logger.LogMessage(LW_LOGLEVEL_DEBUG, "Algorithm transform of %d tags failed, raw values are sent", count);
+        }
+        begin = end;
+    }
+
+    return done;
+}
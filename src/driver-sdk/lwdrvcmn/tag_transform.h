@@ -0,0 +1,94 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: tag_transform.h .
+*
+* Date: 2026-03-12
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+#pragma once
+
+#include "lwdrvcmn.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 工程量变换：点位上送前按 transfer_type 做线性缩放或调用算法插件
+class CTagTransform
+{
+public:
+    CTagTransform();
+    ~CTagTransform();
+
+    // 批量变换，scaled[i] 为真时 eng[i] 为第 i 个点位的工程量，返回变换的点位个数
+    int Apply(LWTAG **tags, int tag_count, double *eng, uint8_t *scaled);
+
+    // 清除按点位缓存的变换参数并销毁插件实例，点位或配置重建后调用
+    void Reset();
+
+    // out = raw * gain + offset 并限制在 [lo, hi] 内，参数按点位展开成数组，便于编译器向量化
+    static void ScaleLinear(const double *raw, const double *gain, const double *offset,
+                            const double *lo, const double *hi, double *out, size_t count);
+
+    // 按数据类型读取点位原始值，文本和二进制类型返回 false
+    static bool ReadRawValue(const LWTAG *tag, double *value);
+
+private:
+    struct Plugin
+    {
+        void *handle;
+        PFN_AlgoCreate create;
+        PFN_AlgoTransform transform;
+        PFN_AlgoDestroy destroy;
+    };
+
+    // 每个点位首次出现时计算一次的变换参数
+    struct TagParam
+    {
+        int transfer_type;
+        double gain;
+        double offset;
+        double eng_lo; // 工程量范围，线性缩放的结果限制在其中
+        double eng_hi;
+        Plugin *plugin;
+        void *ctx;
+    };
+
+    struct AlgoItem
+    {
+        Plugin *plugin;
+        void *ctx;
+        double raw;
+        int index;
+    };
+
+    const TagParam &Lookup(LWTAG *tag);
+    Plugin *LoadPlugin(const std::string &lib);
+    void DestroyParams();
+
+private:
+    std::mutex lock_; // 插件调用也在锁内，插件不需要可重入
+    std::unordered_map<LWTAG *, TagParam> params_;
+    std::map<std::string, std::unique_ptr<Plugin>> plugins_; // 加载失败的库保存为空，避免重复加载
+
+    // 批处理暂存区，复用避免每次分配
+    std::vector<double> raw_;
+    std::vector<double> gain_;
+    std::vector<double> offset_;
+    std::vector<double> lo_;
+    std::vector<double> hi_;
+    std::vector<double> out_;
+    std::vector<int> index_;
+    std::vector<AlgoItem> algo_items_;
+    std::vector<void *> ctxs_;
+};
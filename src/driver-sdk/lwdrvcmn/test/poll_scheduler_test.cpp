@@ -0,0 +1,466 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: poll_scheduler_test.cpp .
+*
+* Date: 2026-03-20
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+// 轮询调度单元测试：用假时钟驱动时间轮，检查相位错开、超过一圈的周期、超时和跳过周期的统计，
+// 设备卡住时的重建，以及只导出 OnTimer 的驱动不被框架轮询。
+// 用法: poll_scheduler_test
+
+#include "../device.h"
+#include "../drvframework.h"
+#include "../poll_scheduler.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  check failed: %s (line %d)\n", #cond, __LINE__);      \
+            ok = false;                                                     \
+        }                                                                   \
+    } while (0)
+
+struct ReadRecord
+{
+    LWDEVICE *device;
+    int period_ms;
+    int phase_ms;
+    uint64_t at_us;
+};
+
+static std::atomic<uint64_t> g_now_us(0);
+static std::mutex g_records_lock;
+static std::vector<ReadRecord> g_records;
+
+// 卡住的设备：读回调阻塞到 g_release，模拟等待 recv_timeout
+static LWDEVICE *g_block_device = nullptr;
+static std::atomic<bool> g_blocked(false);
+static std::atomic<bool> g_release(false);
+
+static uint64_t FakeClock()
+{
+    return g_now_us;
+}
+
+static long TestReadTags(LWDEVICE *device, LWTAG **tags, int tag_count, DRVTIMER *timer_info)
+{
+    {
+        std::lock_guard<std::mutex> guard(g_records_lock);
+        g_records.push_back({device, timer_info->period_ms, timer_info->phase_ms, g_now_us.load()});
+    }
+    if (device == g_block_device) {
+        g_blocked = true;
+        while (!g_release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        g_blocked = false;
+    }
+    return 0;
+}
+
+static std::atomic<int> g_timer_calls(0);
+
+static long TestOnTimer(LWDEVICE *device, DRVTIMER *timer_info)
+{
+    g_timer_calls++;
+    return 0;
+}
+
+// 测试设备及其点位
+struct TestDevice
+{
+    CDevice device;
+    std::vector<std::string> names;
+    std::vector<LWTAG> tags;
+};
+
+static void MakeDevice(TestDevice *dev, const std::string &name, const std::vector<int> &intervals)
+{
+    dev->device.InitDeviceInfo(nullptr, name, "", "", "", "", "", "", "");
+    dev->names.reserve(intervals.size());
+    dev->tags.resize(intervals.size());
+    for (size_t i = 0; i < intervals.size(); i++) {
+        dev->names.push_back(name + "_tag" + std::to_string(i));
+        LWTAG *tag = &dev->tags[i];
+        memset(tag, 0, sizeof(*tag));
+        tag->name = const_cast<char *>(dev->names[i].c_str());
+        tag->address = const_cast<char *>(dev->names[i].c_str());
+        tag->data_type = TAG_DT_INT32;
+        tag->polling_interval = intervals[i];
+    }
+    for (auto &tag : dev->tags) {
+        dev->device.AddTagOfDevice(&tag);
+    }
+}
+
+static PollGroup *FindGroup(CPollScheduler &scheduler, CDevice *device, int interval_ms)
+{
+    for (auto &group : scheduler.GetGroups()) {
+        if (group->device == device && group->interval_ms == interval_ms) {
+            return group.get();
+        }
+    }
+    return nullptr;
+}
+
+static void WaitIdle(CPollScheduler &scheduler)
+{
+    for (;;) {
+        bool busy = false;
+        for (auto &group : scheduler.GetGroups()) {
+            busy = busy || group->busy;
+        }
+        if (!busy) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// 按 tick 推进假时钟，每个 tick 调度一次并等待读取完成
+static void RunFor(CPollScheduler &scheduler, uint64_t duration_ms)
+{
+    for (uint64_t i = 0; i < duration_ms / CPollScheduler::kTickMs; i++) {
+        scheduler.RunPending();
+        WaitIdle(scheduler);
+        g_now_us += CPollScheduler::kTickMs * 1000;
+    }
+}
+
+static std::vector<ReadRecord> TakeRecords(LWDEVICE *device)
+{
+    std::lock_guard<std::mutex> guard(g_records_lock);
+    std::vector<ReadRecord> records;
+    for (auto &record : g_records) {
+        if (record.device == device) {
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+// 同周期的组在周期内均匀错开，超过时间轮一圈的周期在正确的轮次到期
+static bool TestWheelAndPhase()
+{
+    bool ok = true;
+    printf("=== Testing Timing Wheel And Phase ===\n");
+
+    TestDevice dev_a, dev_b, dev_c, dev_d;
+    MakeDevice(&dev_a, "dev_a", {100, 100});
+    MakeDevice(&dev_b, "dev_b", {100});
+    MakeDevice(&dev_c, "dev_c", {100, 1000});
+    MakeDevice(&dev_d, "dev_d", {7000});
+    std::map<std::string, CDevice *> devices = {
+        {"dev_a", &dev_a.device}, {"dev_b", &dev_b.device},
+        {"dev_c", &dev_c.device}, {"dev_d", &dev_d.device}};
+
+    g_records.clear();
+    g_now_us = 1000000000ULL;
+
+    CPollScheduler scheduler;
+    scheduler.SetClock(FakeClock);
+    uint64_t start_us = g_now_us;
+    CHECK(scheduler.Build(devices) == 5);
+    // 默认一个工作线程，驱动不打开并行轮询时与以前一样串行
+    CHECK(scheduler.GetWorkerNum() == 1);
+
+    // 100ms 的三个组依次错开三分之一周期，同设备同周期的点位合为一组
+    PollGroup *group_a = FindGroup(scheduler, &dev_a.device, 100);
+    PollGroup *group_b = FindGroup(scheduler, &dev_b.device, 100);
+    PollGroup *group_c = FindGroup(scheduler, &dev_c.device, 100);
+    PollGroup *group_slow = FindGroup(scheduler, &dev_c.device, 1000);
+    PollGroup *group_d = FindGroup(scheduler, &dev_d.device, 7000);
+    CHECK(group_a && group_b && group_c && group_slow && group_d);
+    if (!ok) {
+        printf("Timing wheel and phase test FAILED\n");
+        return false;
+    }
+    CHECK(group_a->tags.size() == 2);
+    CHECK(group_a->phase_ms == 0);
+    CHECK(group_b->phase_ms == 30);
+    CHECK(group_c->phase_ms == 60);
+    CHECK(group_slow->phase_ms == 0);
+    CHECK(group_d->phase_ms == 0);
+
+    RunFor(scheduler, 15000);
+
+    // 每次读取都在自己的相位上，周期信息随读回调传给驱动
+    struct Expect { TestDevice *dev; int period_ms; int phase_ms; size_t polls; };
+    Expect expects[] = {
+        {&dev_a, 100, 0, 150}, {&dev_b, 100, 30, 150}, {&dev_d, 7000, 0, 3}};
+    for (auto &expect : expects) {
+        auto records = TakeRecords(expect.dev->device.GetDeviceInterface());
+        CHECK(records.size() == expect.polls);
+        for (size_t i = 0; i < records.size(); i++) {
+            uint64_t expect_us = start_us + (expect.phase_ms + i * expect.period_ms) * 1000ULL;
+            CHECK(records[i].at_us == expect_us);
+            CHECK(records[i].period_ms == expect.period_ms);
+            CHECK(records[i].phase_ms == expect.phase_ms);
+        }
+    }
+    CHECK(group_c->polls == 150);
+    CHECK(group_slow->polls == 15);
+
+    for (auto &group : scheduler.GetGroups()) {
+        CHECK(group->missed == 0);
+        CHECK(group->overruns == 0);
+    }
+
+    printf("Timing wheel and phase test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 卡住的设备：未完成时到期的周期记为 missed，读取耗时超过周期记为 overrun；
+// 调度线程自身延迟时跳过错过的周期而不是补读，并保持相位
+static bool TestOverrunAndMissed()
+{
+    bool ok = true;
+    printf("\n=== Testing Overrun And Missed Cycles ===\n");
+
+    TestDevice dev;
+    MakeDevice(&dev, "dev_stuck", {100});
+    std::map<std::string, CDevice *> devices = {{"dev_stuck", &dev.device}};
+
+    g_records.clear();
+    g_now_us = 5000000000ULL;
+    g_block_device = dev.device.GetDeviceInterface();
+    g_release = false;
+
+    CPollScheduler scheduler;
+    scheduler.SetClock(FakeClock);
+    uint64_t start_us = g_now_us;
+    CHECK(scheduler.Build(devices) == 1);
+    PollGroup *group = scheduler.GetGroups()[0].get();
+
+    // t=0 的读取卡住 350ms，期间 100/200/300ms 的周期到期
+    scheduler.RunPending();
+    while (!g_blocked) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    for (int i = 0; i < 35; i++) {
+        g_now_us += CPollScheduler::kTickMs * 1000;
+        scheduler.RunPending();
+    }
+    g_release = true;
+    WaitIdle(scheduler);
+
+    CHECK(group->polls == 1);
+    CHECK(group->missed == 3);
+    CHECK(group->overruns == 1);
+    CHECK(group->cost_max_us == 350000);
+    CHECK(group->device_stats->cycles == 1);
+    CHECK(group->device_stats->cycle_max_us == 350000);
+
+    // 调度线程停顿 1 秒：下一个到期的 400ms 周期只读一次，400ms 之后到 1350ms 的 9 个周期被跳过
+    g_now_us += 1000 * 1000;
+    scheduler.RunPending();
+    WaitIdle(scheduler);
+    CHECK(group->polls == 2);
+    CHECK(group->missed == 12);
+    CHECK(group->overruns == 1);
+
+    // 相位不变，下一次在 1400ms 读取
+    g_now_us += 40 * 1000;
+    RunFor(scheduler, 20);
+    auto records = TakeRecords(g_block_device);
+    CHECK(records.size() == 3);
+    if (records.size() == 3) {
+        CHECK(records[0].at_us == start_us);
+        CHECK(records[1].at_us == start_us + 1350000);
+        CHECK(records[2].at_us == start_us + 1400000);
+    }
+
+    g_block_device = nullptr;
+    printf("Overrun and missed test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+static void WaitGroupIdle(const PollGroup *group)
+{
+    while (group->busy) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// 推进一个 tick，只等待 group 的读取完成
+static void StepExcept(CPollScheduler &scheduler, CDevice *stuck)
+{
+    scheduler.RunPending();
+    for (auto &group : scheduler.GetGroups()) {
+        if (group->device != stuck) {
+            WaitGroupIdle(group.get());
+        }
+    }
+    g_now_us += CPollScheduler::kTickMs * 1000;
+}
+
+// 设备卡住时修改并发配置或增加点位：重建不等待卡住的读取，其他设备按新计划继续轮询，
+// 卡住设备的新读取排在旧读取之后，旧的组在读取结束后释放
+static bool TestRebuildWhileStuck()
+{
+    bool ok = true;
+    printf("\n=== Testing Rebuild While Device Stuck ===\n");
+
+    TestDevice dev_ok, dev_stuck;
+    MakeDevice(&dev_ok, "dev_ok", {100});
+    MakeDevice(&dev_stuck, "dev_stuck", {100});
+    std::map<std::string, CDevice *> devices = {{"dev_ok", &dev_ok.device}, {"dev_stuck", &dev_stuck.device}};
+
+    g_records.clear();
+    g_now_us = 9000000000ULL;
+    g_block_device = dev_stuck.device.GetDeviceInterface();
+    g_release = false;
+
+    // 打开并行轮询，卡住的设备不影响其他设备
+    CPollScheduler scheduler;
+    scheduler.SetClock(FakeClock);
+    scheduler.SetConcurrency(0, 0);
+    CHECK(scheduler.Build(devices) == 2);
+    CHECK(scheduler.GetWorkerNum() == 2);
+    for (int i = 0; i < 10; i++) {
+        StepExcept(scheduler, &dev_stuck.device);
+    }
+    while (!g_blocked) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    // 不能等卡住的读取结束，超时后放行避免测试挂住
+    std::thread releaser([] {
+        std::this_thread::sleep_for(std::chrono::seconds(3));
+        g_release = true;
+    });
+
+    // 跨越重建的读取按同一时间基准计时
+    PollGroup *old_stuck = FindGroup(scheduler, &dev_stuck.device, 100);
+    CHECK(old_stuck != nullptr);
+    uint64_t stuck_due_us = 0;
+    {
+        std::lock_guard<std::mutex> guard(g_records_lock);
+        for (auto &record : g_records) {
+            if (record.device == g_block_device) {
+                stuck_due_us = record.at_us;
+            }
+        }
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    scheduler.SetConcurrency(1, 0);
+    StepExcept(scheduler, &dev_stuck.device);
+    LWTAG extra;
+    std::string extra_name = "dev_ok_extra";
+    memset(&extra, 0, sizeof(extra));
+    extra.name = const_cast<char *>(extra_name.c_str());
+    extra.address = const_cast<char *>(extra_name.c_str());
+    extra.polling_interval = 100;
+    dev_ok.device.AddTagOfDevice(&extra);
+    for (int i = 0; i < 20; i++) {
+        StepExcept(scheduler, &dev_stuck.device);
+    }
+    auto cost = std::chrono::steady_clock::now() - begin;
+
+    CHECK(!g_release);
+    CHECK(cost < std::chrono::seconds(1));
+    CHECK(scheduler.GetGroupNum() == 2);
+    PollGroup *group_ok = FindGroup(scheduler, &dev_ok.device, 100);
+    PollGroup *group_stuck = FindGroup(scheduler, &dev_stuck.device, 100);
+    CHECK(group_ok && group_stuck);
+    if (group_ok && group_stuck) {
+        CHECK(group_ok->tags.size() == 2);
+        CHECK(group_ok->polls == 2);
+        CHECK(group_stuck->polls == 0);
+        CHECK(group_stuck->busy);
+    }
+    size_t ok_polls = TakeRecords(dev_ok.device.GetDeviceInterface()).size();
+    CHECK(ok_polls == 4);
+
+    // 放行后旧组的耗时等于卡住期间假时钟的推进量，不会因重建回绕；旧组在下次调度时释放
+    releaser.join();
+    if (old_stuck) {
+        WaitGroupIdle(old_stuck);
+        uint64_t stuck_us = g_now_us - stuck_due_us;
+        CHECK(old_stuck->polls == 1);
+        CHECK(old_stuck->cost_max_us == stuck_us);
+        CHECK(old_stuck->overruns == 1);
+        CHECK(old_stuck->device_stats->cycle_max_us <= stuck_us);
+    }
+
+    // 卡住设备按新计划读取
+    RunFor(scheduler, 10);
+    if (group_stuck) {
+        CHECK(group_stuck->polls == 1);
+    }
+    CHECK(TakeRecords(g_block_device).size() == 2);
+
+    g_block_device = nullptr;
+    printf("Rebuild while stuck test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 没有 OnReadTags 时框架不建轮询组，OnTimer 只由驱动自己的定时器触发
+static bool TestTimerOnlyDriver()
+{
+    bool ok = true;
+    printf("\n=== Testing Timer Only Driver ===\n");
+
+    TestDevice dev;
+    MakeDevice(&dev, "dev_timer", {100, 1000});
+    std::map<std::string, CDevice *> devices = {{"dev_timer", &dev.device}};
+
+    DRV_FRAMEWORK->pfnOnReadTags_ = nullptr;
+    DRV_FRAMEWORK->pfnOnTimer_ = TestOnTimer;
+    g_timer_calls = 0;
+    g_now_us = 1000000000ULL;
+
+    CPollScheduler scheduler;
+    scheduler.SetClock(FakeClock);
+    CHECK(scheduler.Build(devices) == 0);
+    CHECK(scheduler.GetGroupNum() == 0);
+    RunFor(scheduler, 2000);
+    CHECK(g_timer_calls == 0);
+
+    DRV_FRAMEWORK->pfnOnTimer_ = nullptr;
+    DRV_FRAMEWORK->pfnOnReadTags_ = TestReadTags;
+    printf("Timer only driver test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    DRV_FRAMEWORK->pfnOnReadTags_ = TestReadTags;
+
+    bool wheel_passed = TestWheelAndPhase();
+    bool overrun_passed = TestOverrunAndMissed();
+    bool rebuild_passed = TestRebuildWhileStuck();
+    bool timer_passed = TestTimerOnlyDriver();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Timing wheel and phase test: %s\n", wheel_passed ? "PASSED" : "FAILED");
+    printf("Overrun and missed test: %s\n", overrun_passed ? "PASSED" : "FAILED");
+    printf("Rebuild while stuck test: %s\n", rebuild_passed ? "PASSED" : "FAILED");
+    printf("Timer only driver test: %s\n", timer_passed ? "PASSED" : "FAILED");
+
+    if (wheel_passed && overrun_passed && rebuild_passed && timer_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    }
+    printf("\nSome tests FAILED!\n");
+    return 1;
+}
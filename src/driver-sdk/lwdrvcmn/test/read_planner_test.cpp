@@ -0,0 +1,313 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: read_planner_test.cpp .
+*
+* Date: 2026-03-20
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+// 块读规划单元测试：检查块长度和空洞上限、重叠地址、分区以及超过块长度的点位。
+// 用法: read_planner_test
+
+#include "../read_planner.h"
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  check failed: %s (line %d)\n", #cond, __LINE__);      \
+            ok = false;                                                     \
+        }                                                                   \
+    } while (0)
+
+// 测试地址格式 "area:offset:length"
+static int ParseTestAddress(LWTAG *tag, DRVADDR *addr)
+{
+    if (sscanf(tag->address, "%d:%d:%d", &addr->area, &addr->offset, &addr->length) != 3) {
+        return -1;
+    }
+    return 0;
+}
+
+// 期望的块：起始地址、长度及按顺序覆盖的点位下标
+struct ExpectBlock
+{
+    int area;
+    int offset;
+    int length;
+    std::vector<int> tags;
+};
+
+class TestTags
+{
+public:
+    LWTAG *Add(const char *address)
+    {
+        addresses_.push_back(address);
+        tags_.emplace_back();
+        LWTAG *tag = &tags_.back();
+        memset(tag, 0, sizeof(*tag));
+        tag->name = const_cast<char *>(addresses_.back().c_str());
+        tag->address = const_cast<char *>(addresses_.back().c_str());
+        ptrs_.push_back(tag);
+        return tag;
+    }
+
+    LWTAG **Data() { return ptrs_.data(); }
+    int Count() const { return static_cast<int>(ptrs_.size()); }
+    LWTAG *At(int index) { return ptrs_[index]; }
+
+    // 按 tags 中的下标检查各块，tag_offsets 由点位地址推出
+    bool CheckBlocks(CReadPlanner &planner, const std::vector<ExpectBlock> &expects)
+    {
+        bool ok = true;
+        DRVREADBLOCK *blocks = nullptr;
+        int block_num = planner.GetBlocks(&blocks);
+        CHECK(block_num == static_cast<int>(expects.size()));
+        if (!ok) {
+            return false;
+        }
+        for (int i = 0; i < block_num; i++) {
+            const DRVREADBLOCK &block = blocks[i];
+            const ExpectBlock &expect = expects[i];
+            CHECK(block.area == expect.area);
+            CHECK(block.offset == expect.offset);
+            CHECK(block.length == expect.length);
+            CHECK(block.tag_count == static_cast<int>(expect.tags.size()));
+            for (int k = 0; k < block.tag_count && k < static_cast<int>(expect.tags.size()); k++) {
+                DRVADDR addr;
+                LWTAG *tag = At(expect.tags[k]);
+                ParseTestAddress(tag, &addr);
+                CHECK(block.pptags[k] == tag);
+                CHECK(block.tag_offsets[k] == addr.offset - block.offset);
+                CHECK(block.tag_offsets[k] + addr.length <= block.length);
+            }
+        }
+        return ok;
+    }
+
+private:
+    std::deque<std::string> addresses_;
+    std::deque<LWTAG> tags_;
+    std::vector<LWTAG *> ptrs_;
+};
+
+// 连续地址按 max_block 切块
+static bool TestMaxBlock()
+{
+    bool ok = true;
+    printf("=== Testing Max Block ===\n");
+
+    TestTags tags;
+    char address[32];
+    for (int i = 0; i < 20; i++) {
+        snprintf(address, sizeof(address), "3:%d:1", 100 + i);
+        tags.Add(address);
+    }
+
+    CReadPlanner planner(ParseTestAddress, 8, 0);
+    CHECK(planner.AddTags(tags.Data(), tags.Count()) == 0);
+    ok = tags.CheckBlocks(planner, {
+        {3, 100, 8, {0, 1, 2, 3, 4, 5, 6, 7}},
+        {3, 108, 8, {8, 9, 10, 11, 12, 13, 14, 15}},
+        {3, 116, 4, {16, 17, 18, 19}}}) && ok;
+
+    // max_block <= 0 表示不限制
+    CReadPlanner unlimited(ParseTestAddress, 0, 0);
+    unlimited.AddTags(tags.Data(), tags.Count());
+    ok = tags.CheckBlocks(unlimited, {
+        {3, 100, 20, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19}}}) && ok;
+
+    printf("Max block test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 不超过 max_gap 的空洞一起读掉，更大的空洞开始新块
+static bool TestMaxGap()
+{
+    bool ok = true;
+    printf("\n=== Testing Max Gap ===\n");
+
+    TestTags tags;
+    tags.Add("3:0:2");
+    tags.Add("3:5:1");   // 空洞 3，等于 max_gap
+    tags.Add("3:9:1");   // 空洞 3
+    tags.Add("3:14:1");  // 空洞 4，超过 max_gap
+    tags.Add("3:15:2");  // 紧邻
+
+    CReadPlanner planner(ParseTestAddress, 100, 3);
+    CHECK(planner.AddTags(tags.Data(), tags.Count()) == 0);
+    ok = tags.CheckBlocks(planner, {
+        {3, 0, 10, {0, 1, 2}},
+        {3, 14, 3, {3, 4}}}) && ok;
+
+    // max_gap 为 0 时只合并紧邻地址
+    CReadPlanner adjacent(ParseTestAddress, 100, 0);
+    adjacent.AddTags(tags.Data(), tags.Count());
+    ok = tags.CheckBlocks(adjacent, {
+        {3, 0, 2, {0}},
+        {3, 5, 1, {1}},
+        {3, 9, 1, {2}},
+        {3, 14, 3, {3, 4}}}) && ok;
+
+    // 合并空洞后超过 max_block 时不合并
+    CReadPlanner limited(ParseTestAddress, 8, 3);
+    limited.AddTags(tags.Data(), tags.Count());
+    ok = tags.CheckBlocks(limited, {
+        {3, 0, 6, {0, 1}},
+        {3, 9, 1, {2}},
+        {3, 14, 3, {3, 4}}}) && ok;
+
+    printf("Max gap test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 重叠地址（如同一寄存器的不同解释）合并进同一块，块覆盖最长的点位
+static bool TestOverlap()
+{
+    bool ok = true;
+    printf("\n=== Testing Overlapping Tags ===\n");
+
+    TestTags tags;
+    tags.Add("3:12:1");
+    tags.Add("3:10:2");
+    tags.Add("3:10:4");
+    tags.Add("3:11:4");
+    tags.Add("3:10:2");  // 同一地址的第二个点位
+
+    CReadPlanner planner(ParseTestAddress, 10, 0);
+    CHECK(planner.AddTags(tags.Data(), tags.Count()) == 0);
+    DRVREADBLOCK *blocks = nullptr;
+    CHECK(planner.GetBlocks(&blocks) == 1);
+    if (blocks) {
+        CHECK(blocks[0].offset == 10);
+        CHECK(blocks[0].length == 5);
+        CHECK(blocks[0].tag_count == 5);
+        // 长的点位排在前面
+        CHECK(blocks[0].pptags[0] == tags.At(2));
+        CHECK(blocks[0].pptags[blocks[0].tag_count - 1] == tags.At(0));
+    }
+
+    printf("Overlapping tags test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 不同区的地址即使数值相邻也不合并，块按 (area, offset) 排序
+static bool TestAreaSplit()
+{
+    bool ok = true;
+    printf("\n=== Testing Area Split ===\n");
+
+    TestTags tags;
+    tags.Add("4:1:1");
+    tags.Add("3:0:1");
+    tags.Add("4:0:1");
+    tags.Add("3:1:1");
+    tags.Add("1:2:1");
+
+    CReadPlanner planner(ParseTestAddress, 100, 10);
+    CHECK(planner.AddTags(tags.Data(), tags.Count()) == 0);
+    ok = tags.CheckBlocks(planner, {
+        {1, 2, 1, {4}},
+        {3, 0, 2, {1, 3}},
+        {4, 0, 2, {2, 0}}}) && ok;
+
+    printf("Area split test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 超过 max_block 的点位独占一块，被它覆盖的点位并入该块，不再单独读取
+static bool TestOversizeTag()
+{
+    bool ok = true;
+    printf("\n=== Testing Oversize Tag ===\n");
+
+    TestTags tags;
+    tags.Add("3:0:1");
+    tags.Add("3:1:10");  // 超过 max_block
+    tags.Add("3:4:2");   // 在上一个点位内
+    tags.Add("3:11:1");
+    tags.Add("3:12:1");
+
+    CReadPlanner planner(ParseTestAddress, 4, 0);
+    CHECK(planner.AddTags(tags.Data(), tags.Count()) == 0);
+    ok = tags.CheckBlocks(planner, {
+        {3, 0, 1, {0}},
+        {3, 1, 10, {1, 2}},
+        {3, 11, 2, {3, 4}}}) && ok;
+
+    printf("Oversize tag test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 无法解析的地址不参与规划，再次添加点位时与已有点位一起重新规划
+static bool TestUnparsableAndAppend()
+{
+    bool ok = true;
+    printf("\n=== Testing Unparsable Address And Append ===\n");
+
+    TestTags tags;
+    tags.Add("3:0:1");
+    tags.Add("bad");
+    tags.Add("3:5:0");  // 长度为 0
+    tags.Add("3:2:1");
+
+    CReadPlanner planner(ParseTestAddress, 100, 0);
+    DRVREADBLOCK *blocks = nullptr;
+    CHECK(planner.GetBlocks(&blocks) == 0);
+    CHECK(blocks == nullptr);
+
+    CHECK(planner.AddTags(tags.Data(), tags.Count()) == 2);
+    ok = tags.CheckBlocks(planner, {
+        {3, 0, 1, {0}},
+        {3, 2, 1, {3}}}) && ok;
+
+    // 补上空缺的地址后两块合并
+    tags.Add("3:1:1");
+    LWTAG *added[] = {tags.At(4), nullptr};
+    CHECK(planner.AddTags(added, 2) == 0);
+    ok = tags.CheckBlocks(planner, {
+        {3, 0, 3, {0, 4, 3}}}) && ok;
+
+    planner.Clear();
+    CHECK(planner.GetBlocks(&blocks) == 0);
+
+    printf("Unparsable address and append test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    bool block_passed = TestMaxBlock();
+    bool gap_passed = TestMaxGap();
+    bool overlap_passed = TestOverlap();
+    bool area_passed = TestAreaSplit();
+    bool oversize_passed = TestOversizeTag();
+    bool append_passed = TestUnparsableAndAppend();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Max block test: %s\n", block_passed ? "PASSED" : "FAILED");
+    printf("Max gap test: %s\n", gap_passed ? "PASSED" : "FAILED");
+    printf("Overlapping tags test: %s\n", overlap_passed ? "PASSED" : "FAILED");
+    printf("Area split test: %s\n", area_passed ? "PASSED" : "FAILED");
+    printf("Oversize tag test: %s\n", oversize_passed ? "PASSED" : "FAILED");
+    printf("Unparsable address and append test: %s\n", append_passed ? "PASSED" : "FAILED");
+
+    if (block_passed && gap_passed && overlap_passed && area_passed && oversize_passed && append_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    }
+    printf("\nSome tests FAILED!\n");
+    return 1;
+}
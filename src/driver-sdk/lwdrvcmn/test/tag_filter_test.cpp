@@ -0,0 +1,227 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: tag_filter_test.cpp .
+*
+* Date: 2026-03-20
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+// 上送过滤单元测试：检查变化检测、死区、完整性周期，以及发送失败和重连后的补发。
+// 用法: tag_filter_test
+
+#include "../tag_filter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  check failed: %s (line %d)\n", #cond, __LINE__);      \
+            ok = false;                                                     \
+        }                                                                   \
+    } while (0)
+
+// 测试点位，值为 int32
+struct TestTag
+{
+    LWTAG tag;
+    int32_t raw;
+    std::string name;
+
+    explicit TestTag(const char *tag_name)
+        : raw(0), name(tag_name)
+    {
+        memset(&tag, 0, sizeof(tag));
+        tag.name = const_cast<char *>(name.c_str());
+        tag.address = const_cast<char *>(name.c_str());
+        tag.data_type = TAG_DT_INT32;
+        tag.data = reinterpret_cast<char *>(&raw);
+        tag.data_length = sizeof(raw);
+    }
+};
+
+// 模拟 UpdateTagsData：过滤后发送，link_up 为假时发送失败，不提交。返回上送的点位数
+static int Update(CTagFilter &filter, TestTag &tag, uint64_t now_ms, bool link_up)
+{
+    LWTAG *tags[] = {&tag.tag};
+    CTagFilter::Batch batch;
+    int send_num = filter.Filter(tags, 1, nullptr, nullptr, now_ms, &batch);
+    if (send_num > 0 && link_up) {
+        filter.Commit(tags, 1, now_ms, batch);
+    }
+    return send_num;
+}
+
+// 值或质量变化时上送，未变化时不上送
+static bool TestChange()
+{
+    bool ok = true;
+    printf("=== Testing Change Detection ===\n");
+
+    CTagFilter filter;
+    filter.SetIntegrityPeriod(0);
+    TestTag level("level");
+
+    CHECK(Update(filter, level, 0, true) == 1);  // 第一次必定上送
+    CHECK(Update(filter, level, 10, true) == 0);
+    level.raw = 5;
+    CHECK(Update(filter, level, 20, true) == 1);
+    CHECK(Update(filter, level, 30, true) == 0);
+    level.tag.quantity = 1;
+    CHECK(Update(filter, level, 40, true) == 1);
+    CHECK(Update(filter, level, 50, true) == 0);
+
+    // 批量过滤中的空指针跳过，结果按下标对应
+    TestTag other("other");
+    LWTAG *tags[] = {&level.tag, nullptr, &other.tag};
+    CTagFilter::Batch batch;
+    CHECK(filter.Filter(tags, 3, nullptr, nullptr, 60, &batch) == 1);
+    CHECK(!batch.send[0] && !batch.send[1] && batch.send[2]);
+
+    printf("Change detection test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 与上次上送的值比较死区，缓慢漂移累计超过死区后上送
+static bool TestDeadband()
+{
+    bool ok = true;
+    printf("\n=== Testing Deadband ===\n");
+
+    CTagFilter filter;
+    filter.SetIntegrityPeriod(0);
+    TestTag flow("flow");
+    filter.SetDeadband(&flow.tag, 2.5);
+
+    flow.raw = 100;
+    CHECK(Update(filter, flow, 0, true) == 1);
+    flow.raw = 102;
+    CHECK(Update(filter, flow, 10, true) == 0);
+    flow.raw = 97;
+    CHECK(Update(filter, flow, 20, true) == 1);
+    flow.raw = 99;
+    CHECK(Update(filter, flow, 30, true) == 0);
+
+    // 工程量优先于原始值
+    LWTAG *tags[] = {&flow.tag};
+    double eng = 97.5;
+    uint8_t scaled = 1;
+    CTagFilter::Batch batch;
+    CHECK(filter.Filter(tags, 1, &eng, &scaled, 40, &batch) == 0);
+    eng = 100.5;
+    CHECK(filter.Filter(tags, 1, &eng, &scaled, 40, &batch) == 1);
+
+    printf("Deadband test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 完整性周期到期后未变化的值也上送，周期 <= 0 时关闭
+static bool TestIntegrity()
+{
+    bool ok = true;
+    printf("\n=== Testing Integrity Period ===\n");
+
+    CTagFilter filter;
+    filter.SetIntegrityPeriod(1000);
+    TestTag level("level");
+
+    CHECK(Update(filter, level, 0, true) == 1);
+    CHECK(Update(filter, level, 999, true) == 0);
+    CHECK(Update(filter, level, 1000, true) == 1);
+    CHECK(Update(filter, level, 1500, true) == 0);
+
+    filter.SetIntegrityPeriod(0);
+    CHECK(Update(filter, level, 1000000, true) == 0);
+
+    printf("Integrity period test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 发送失败的变化不记录，直到发送成功前每次都上送；重连后所有点位重新上送
+static bool TestDropThenReconnect()
+{
+    bool ok = true;
+    printf("\n=== Testing Drop Then Reconnect ===\n");
+
+    // 关闭完整性周期，补发只能依赖提交和重置
+    CTagFilter filter;
+    filter.SetIntegrityPeriod(0);
+    TestTag level("level");
+    TestTag flow("flow");
+    filter.SetDeadband(&flow.tag, 2.5);
+
+    CHECK(Update(filter, level, 0, true) == 1);
+    CHECK(Update(filter, flow, 0, true) == 1);
+
+    // 断线期间的变化发送失败
+    level.raw = 7;
+    CHECK(Update(filter, level, 10, false) == 1);
+    CHECK(Update(filter, level, 20, false) == 1);
+    flow.raw = 10;
+    CHECK(Update(filter, flow, 20, false) == 1);
+
+    // 重连：未发出的变化仍然上送，未变化的点位也重新上送
+    filter.Reset();
+    CHECK(Update(filter, level, 30, true) == 1);
+    CHECK(Update(filter, level, 40, true) == 0);
+    CHECK(Update(filter, flow, 30, true) == 1);
+
+    // 重置后死区配置保留
+    flow.raw = 12;
+    CHECK(Update(filter, flow, 50, true) == 0);
+
+    TestTag idle("idle");
+    CHECK(Update(filter, idle, 50, true) == 1);
+    filter.Reset();
+    CHECK(Update(filter, idle, 60, true) == 1);
+
+    // 过滤后、提交前发生重连，提交作废，新连接仍会收到该值
+    level.raw = 8;
+    LWTAG *tags[] = {&level.tag};
+    CTagFilter::Batch batch;
+    CHECK(filter.Filter(tags, 1, nullptr, nullptr, 70, &batch) == 1);
+    filter.Reset();
+    filter.Commit(tags, 1, 70, batch);
+    CHECK(Update(filter, level, 80, true) == 1);
+    CHECK(Update(filter, level, 90, true) == 0);
+
+    // 已进入合并批次并提交，批次之后发送失败：丢弃通知重置后重新上送
+    level.raw = 9;
+    CHECK(Update(filter, level, 100, true) == 1);
+    CHECK(Update(filter, level, 110, true) == 0);
+    filter.Reset();
+    CHECK(Update(filter, level, 120, true) == 1);
+    CHECK(Update(filter, level, 130, true) == 0);
+
+    printf("Drop then reconnect test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    bool change_passed = TestChange();
+    bool deadband_passed = TestDeadband();
+    bool integrity_passed = TestIntegrity();
+    bool reconnect_passed = TestDropThenReconnect();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Change detection test: %s\n", change_passed ? "PASSED" : "FAILED");
+    printf("Deadband test: %s\n", deadband_passed ? "PASSED" : "FAILED");
+    printf("Integrity period test: %s\n", integrity_passed ? "PASSED" : "FAILED");
+    printf("Drop then reconnect test: %s\n", reconnect_passed ? "PASSED" : "FAILED");
+
+    if (change_passed && deadband_passed && integrity_passed && reconnect_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    }
+    printf("\nSome tests FAILED!\n");
+    return 1;
+}
@@ -0,0 +1,197 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: tag_json_bench.cpp .
+*
+* Date: 2026-03-18
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+// 点位上送序列化基准：比较 DataValueDto + ObjectMapper 与 CJsonWriter 每个点位的内存分配次数和耗时。
+// 用法: tag_json_bench [batch_count] [rounds]
+
+#include "../drvdto.hpp"
+#include "../json_writer.h"
+#include "../lwdrvcmn.h"
+
+#include "vsoa_dto/parser/json/mapping/ObjectMapper.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+static std::atomic<unsigned long> g_alloc_count(0);
+
+void *operator new(size_t size)
+{
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+
+struct BenchTags
+{
+    std::vector<LWTAG> tags;
+    std::vector<LWTAG *> ptrs;
+    std::vector<std::string> names;
+    std::vector<double> values;
+};
+
+// 与 DrvFramework::GetTagDataValueToString 相同的格式化，避免链接整个驱动框架
+static std::string ValueToString(const LWTAG *tag)
+{
+    switch (tag->data_type) {
+    case TAG_DT_INT32:
+        return std::to_string(*(int32_t *)tag->data);
+    case TAG_DT_DOUBLE:
+        return std::to_string(*(double *)tag->data);
+    case TAG_DT_TEXT:
+        return std::string(tag->data, tag->data_length);
+    default:
+        return std::string();
+    }
+}
+
+static void MakeTags(BenchTags *bench, int count)
+{
+    bench->tags.assign(count, LWTAG());
+    bench->ptrs.resize(count);
+    bench->names.resize(count);
+    bench->values.resize(count);
+    for (int i = 0; i < count; i++) {
+        LWTAG *tag = &bench->tags[i];
+        memset(tag, 0, sizeof(*tag));
+        bench->names[i] = "device1.channel" + std::to_string(i % 8) + ".tag" + std::to_string(i);
+        tag->name = (char *)bench->names[i].c_str();
+        bench->values[i] = i * 1.25;
+        tag->data = (char *)&bench->values[i];
+        if (i % 3 == 0) {
+            tag->data_type = TAG_DT_INT32;
+            tag->data_length = sizeof(int32_t);
+            *(int32_t *)tag->data = i * 7;
+        } else if (i % 3 == 1) {
+            tag->data_type = TAG_DT_DOUBLE;
+            tag->data_length = sizeof(double);
+        } else {
+            tag->data_type = TAG_DT_TEXT;
+            tag->data_length = 7;
+            memcpy(tag->data, "run/ok\"", 7);
+        }
+        tag->time_milli = 1773800000000ULL + i;
+        bench->ptrs[i] = tag;
+    }
+}
+
+static std::string SerializeDto(vsoa::parser::json::mapping::ObjectMapper *mapper, LWTAG **tags, int count)
+{
+    auto data_list = vsoa::List<vsoa::Object<DataValueDto>>::createShared();
+    for (int i = 0; i < count; i++) {
+        auto data_dto = vsoa::Object<DataValueDto>::createShared();
+        data_dto->name = tags[i]->name;
+        data_dto->value = ValueToString(tags[i]);
+        data_dto->time = tags[i]->time_milli;
+        data_dto->quality = "1";
+        data_list->push_back(data_dto);
+    }
+    vsoa::String json_data = mapper->writeToString(data_list);
+    return *json_data;
+}
+
+static void SerializeWriter(CJsonWriter *writer, LWTAG **tags, int count)
+{
+    writer->Clear();
+    writer->BeginArray();
+    for (int i = 0; i < count; i++) {
+        writer->BeginObject();
+        writer->Key("name");
+        writer->String(tags[i]->name);
+        writer->Key("value");
+        writer->TagValue(tags[i]->data_type, tags[i]->data_length, tags[i]->data);
+        writer->Key("time");
+        writer->UInt(tags[i]->time_milli);
+        writer->Key("quality");
+        writer->String("1", 1);
+        writer->EndObject();
+    }
+    writer->EndArray();
+}
+
+int main(int argc, char *argv[])
+{
+    int batch = argc > 1 ? atoi(argv[1]) : 1000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 200;
+    if (batch <= 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [batch_count] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    auto config = vsoa::parser::json::mapping::Serializer::Config::createShared();
+    config->includeNullFields = false;
+    auto mapper = vsoa::parser::json::mapping::ObjectMapper::createShared(
+        config, vsoa::parser::json::mapping::Deserializer::Config::createShared());
+
+    BenchTags bench;
+    MakeTags(&bench, batch);
+    LWTAG **tags = bench.ptrs.data();
+
+    // 两种路径的输出必须一致
+    CJsonWriter writer;
+    std::string expect = SerializeDto(mapper.get(), tags, batch);
+    SerializeWriter(&writer, tags, batch);
+    if (expect != std::string(writer.Data(), writer.Size())) {
+        fprintf(stderr, "output mismatch\nDTO:    %.200s\nwriter: %.200s\n", expect.c_str(),
+            std::string(writer.Data(), writer.Size()).c_str());
+        return 1;
+    }
+
+    size_t total = 0;
+    unsigned long alloc_start = g_alloc_count.load();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        total += SerializeDto(mapper.get(), tags, batch).size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    unsigned long dto_allocs = g_alloc_count.load() - alloc_start;
+
+    alloc_start = g_alloc_count.load();
+    auto t2 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        SerializeWriter(&writer, tags, batch);
+        total += writer.Size();
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    unsigned long writer_allocs = g_alloc_count.load() - alloc_start;
+
+    double tag_num = (double)batch * rounds;
+    double dto_ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    double writer_ns = std::chrono::duration<double, std::nano>(t3 - t2).count();
+    printf("batch=%d rounds=%d payload=%zu bytes\n", batch, rounds, expect.size());
+    printf("%-12s %14s %12s\n", "path", "allocs/tag", "ns/tag");
+    printf("%-12s %14.3f %12.1f\n", "dto", dto_allocs / tag_num, dto_ns / tag_num);
+    printf("%-12s %14.3f %12.1f\n", "writer", writer_allocs / tag_num, writer_ns / tag_num);
+    return total == 0;
+}
@@ -0,0 +1,276 @@
+/*
+* Copyright (c) 2025 ACOAUTO Team.
+* All rights reserved.
+*
+* Detailed license information can be found in the LICENSE file.
+*
+* File: tag_transform_test.cpp .
+*
+* Date: 2026-03-20
+*
+* Author: Yan.chaodong <yanchaodong@acoinfo.com>
+*
+*/
+
+// 工程量变换单元测试：检查线性缩放的计算、工程量范围限制、参数缓存的重置以及上送值的格式。
+// 用法: tag_transform_test
+
+#include "../json_writer.h"
+#include "../tag_transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("  check failed: %s (line %d)\n", #cond, __LINE__);      \
+            ok = false;                                                     \
+        }                                                                   \
+    } while (0)
+
+static bool Near(double a, double b)
+{
+    return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b));
+}
+
+// 测试点位，原始值存放在 raw 中
+struct TestTag
+{
+    LWTAG tag;
+    char raw[16];
+    std::string name;
+
+    TestTag(const char *tag_name, int data_type, double raw_min, double raw_max, double eng_min, double eng_max)
+        : name(tag_name)
+    {
+        memset(&tag, 0, sizeof(tag));
+        memset(raw, 0, sizeof(raw));
+        tag.name = const_cast<char *>(name.c_str());
+        tag.address = const_cast<char *>(name.c_str());
+        tag.data_type = data_type;
+        tag.transfer_type = TAG_TRANSFER_LINEAR;
+        tag.linear_raw_min = raw_min;
+        tag.linear_raw_max = raw_max;
+        tag.linear_eng_min = eng_min;
+        tag.linear_eng_max = eng_max;
+        // 数据地址故意不对齐
+        tag.data = raw + 1;
+    }
+
+    template <typename T>
+    void Set(T value)
+    {
+        memcpy(raw + 1, &value, sizeof(value));
+        tag.data_length = sizeof(value);
+    }
+};
+
+// 对单个点位做一次变换，返回是否缩放
+static bool ApplyOne(CTagTransform &transform, TestTag &tag, double *eng)
+{
+    LWTAG *tags[] = {&tag.tag};
+    uint8_t scaled = 0;
+    transform.Apply(tags, 1, eng, &scaled);
+    return scaled != 0;
+}
+
+// eng = (raw - raw_min) * (eng_max - eng_min) / (raw_max - raw_min) + eng_min
+static bool TestLinearMath()
+{
+    bool ok = true;
+    printf("=== Testing Linear Math ===\n");
+
+    CTagTransform transform;
+    double eng = 0;
+
+    TestTag adc("adc", TAG_DT_UINT16, 0, 4095, 0, 100);
+    adc.Set<uint16_t>(2048);
+    CHECK(ApplyOne(transform, adc, &eng));
+    CHECK(Near(eng, 2048 * 100.0 / 4095));
+
+    // 4-20mA 映射到 -50..150
+    TestTag current("current", TAG_DT_FLOAT, 4, 20, -50, 150);
+    current.Set<float>(12.0f);
+    CHECK(ApplyOne(transform, current, &eng));
+    CHECK(Near(eng, 50.0));
+
+    TestTag signed16("signed16", TAG_DT_INT16, -32768, 32767, -1, 1);
+    signed16.Set<int16_t>(-32768);
+    CHECK(ApplyOne(transform, signed16, &eng));
+    CHECK(Near(eng, -1.0));
+    signed16.Set<int16_t>(32767);
+    CHECK(ApplyOne(transform, signed16, &eng));
+    CHECK(Near(eng, 1.0));
+
+    // 反向范围：raw 增大时工程量减小
+    TestTag reverse("reverse", TAG_DT_INT32, 0, 1000, 100, 0);
+    reverse.Set<int32_t>(250);
+    CHECK(ApplyOne(transform, reverse, &eng));
+    CHECK(Near(eng, 75.0));
+
+    TestTag wide("wide", TAG_DT_INT64, 0, 1e12, 0, 1);
+    wide.Set<int64_t>(250000000000LL);
+    CHECK(ApplyOne(transform, wide, &eng));
+    CHECK(Near(eng, 0.25));
+
+    // 批量变换中混合不缩放的点位，结果按下标对应
+    TestTag plain("plain", TAG_DT_INT32, 0, 0, 0, 0);
+    plain.tag.transfer_type = TAG_TRANSFER_NONE;
+    plain.Set<int32_t>(7);
+    TestTag empty_range("empty_range", TAG_DT_INT32, 10, 10, 0, 100);
+    empty_range.Set<int32_t>(10);
+    TestTag text("text", TAG_DT_TEXT, 0, 10, 0, 100);
+    text.Set<char>('5');
+    LWTAG *tags[] = {&plain.tag, &adc.tag, &empty_range.tag, nullptr, &text.tag, &reverse.tag};
+    double engs[6] = {0};
+    uint8_t scaled[6] = {1, 1, 1, 1, 1, 1};
+    CHECK(transform.Apply(tags, 6, engs, scaled) == 2);
+    CHECK(!scaled[0] && scaled[1] && !scaled[2] && !scaled[3] && !scaled[4] && scaled[5]);
+    CHECK(Near(engs[1], 2048 * 100.0 / 4095));
+    CHECK(Near(engs[5], 75.0));
+
+    printf("Linear math test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 原始值超出范围时工程量限制在 [eng_min, eng_max] 内，反向范围同样适用
+static bool TestClamping()
+{
+    bool ok = true;
+    printf("\n=== Testing Clamping ===\n");
+
+    CTagTransform transform;
+    double eng = 0;
+
+    TestTag current("current", TAG_DT_FLOAT, 4, 20, 0, 100);
+    current.Set<float>(0.0f);  // 断线
+    CHECK(ApplyOne(transform, current, &eng));
+    CHECK(eng == 0.0);
+    current.Set<float>(24.0f);
+    CHECK(ApplyOne(transform, current, &eng));
+    CHECK(eng == 100.0);
+    current.Set<float>(20.0f);
+    CHECK(ApplyOne(transform, current, &eng));
+    CHECK(Near(eng, 100.0));
+
+    TestTag reverse("reverse", TAG_DT_INT32, 0, 1000, 100, 0);
+    reverse.Set<int32_t>(-500);
+    CHECK(ApplyOne(transform, reverse, &eng));
+    CHECK(eng == 100.0);
+    reverse.Set<int32_t>(5000);
+    CHECK(ApplyOne(transform, reverse, &eng));
+    CHECK(eng == 0.0);
+
+    // 直接调用向量化的缩放函数
+    double raw[] = {-10, 0, 5, 10, 20};
+    double gain[] = {2, 2, 2, 2, 2};
+    double offset[] = {1, 1, 1, 1, 1};
+    double lo[] = {0, 0, 0, 0, 0};
+    double hi[] = {15, 15, 15, 15, 15};
+    double out[5];
+    CTagTransform::ScaleLinear(raw, gain, offset, lo, hi, out, 5);
+    CHECK(out[0] == 0 && out[1] == 1 && out[2] == 11 && out[3] == 15 && out[4] == 15);
+
+    printf("Clamping test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+// 参数按点位缓存，Reset 后按点位的新配置重新计算
+static bool TestReset()
+{
+    bool ok = true;
+    printf("\n=== Testing Parameter Reset ===\n");
+
+    CTagTransform transform;
+    double eng = 0;
+
+    TestTag level("level", TAG_DT_UINT16, 0, 1000, 0, 10);
+    level.Set<uint16_t>(500);
+    CHECK(ApplyOne(transform, level, &eng));
+    CHECK(Near(eng, 5.0));
+
+    level.tag.linear_eng_max = 20;
+    CHECK(ApplyOne(transform, level, &eng));
+    CHECK(Near(eng, 5.0));
+
+    transform.Reset();
+    CHECK(ApplyOne(transform, level, &eng));
+    CHECK(Near(eng, 10.0));
+
+    level.tag.transfer_type = TAG_TRANSFER_NONE;
+    transform.Reset();
+    CHECK(!ApplyOne(transform, level, &eng));
+
+    printf("Parameter reset test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+static std::string FormatScaled(int data_type, double value)
+{
+    CJsonWriter writer;
+    writer.ScaledValue(data_type, value);
+    return std::string(writer.Data(), writer.Size());
+}
+
+// 整数类型的工程量四舍五入后按整数上送，浮点类型保留 6 位小数，布尔类型与原始值一样上送 true/false
+static bool TestScaledFormat()
+{
+    bool ok = true;
+    printf("\n=== Testing Scaled Value Format ===\n");
+
+    CHECK(FormatScaled(TAG_DT_INT32, 12.0) == "\"12\"");
+    CHECK(FormatScaled(TAG_DT_UINT16, 12.5) == "\"13\"");
+    CHECK(FormatScaled(TAG_DT_INT16, -2.5) == "\"-3\"");
+    CHECK(FormatScaled(TAG_DT_INT8, 0.4) == "\"0\"");
+    CHECK(FormatScaled(TAG_DT_BOOL, 1.0) == "\"true\"");
+    CHECK(FormatScaled(TAG_DT_BOOL, 0.0) == "\"false\"");
+    CHECK(FormatScaled(TAG_DT_BOOL, 0.4) == "\"true\"");
+    CHECK(FormatScaled(TAG_DT_UINT64, 1e19) == "\"10000000000000000000\"");
+    CHECK(FormatScaled(TAG_DT_UINT64, 1e30) == "\"18446744073709551615\"");
+    CHECK(FormatScaled(TAG_DT_INT64, -1e30) == "\"-9223372036854775808\"");
+    CHECK(FormatScaled(TAG_DT_FLOAT, 12.0) == "\"12.000000\"");
+    CHECK(FormatScaled(TAG_DT_DOUBLE, -0.125) == "\"-0.125000\"");
+
+    // 同一布尔点位有无变换时格式相同
+    char raw_bool = 1;
+    CJsonWriter raw_writer;
+    raw_writer.TagValue(TAG_DT_BOOL, 1, &raw_bool);
+    CHECK(std::string(raw_writer.Data(), raw_writer.Size()) == FormatScaled(TAG_DT_BOOL, 1.0));
+
+    // 与 TagValue 相同，值以字符串写入对象
+    CJsonWriter writer;
+    writer.BeginObject();
+    writer.Key("value");
+    writer.ScaledValue(TAG_DT_INT32, 75.0);
+    writer.EndObject();
+    CHECK(std::string(writer.Data(), writer.Size()) == "{\"value\":\"75\"}");
+
+    printf("Scaled value format test %s\n", ok ? "PASSED" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    bool math_passed = TestLinearMath();
+    bool clamp_passed = TestClamping();
+    bool reset_passed = TestReset();
+    bool format_passed = TestScaledFormat();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Linear math test: %s\n", math_passed ? "PASSED" : "FAILED");
+    printf("Clamping test: %s\n", clamp_passed ? "PASSED" : "FAILED");
+    printf("Parameter reset test: %s\n", reset_passed ? "PASSED" : "FAILED");
+    printf("Scaled value format test: %s\n", format_passed ? "PASSED" : "FAILED");
+
+    if (math_passed && clamp_passed && reset_passed && format_passed) {
+        printf("\nAll tests PASSED!\n");
+        return 0;
+    }
+    printf("\nSome tests FAILED!\n");
+    return 1;
+}
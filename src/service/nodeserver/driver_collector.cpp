@@ -29,6 +29,10 @@
 #include "dds/dds_manager.h"
 #include "../../common/dto/TagDataDto.hpp"
 #include <string>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
 
 #ifndef LW_NAME_MAXLEN
 #define LW_NAME_MAXLEN          128
@@ -97,40 +101,44 @@ void DriverCollector::OnDatagramCb(void *arg, ipc_server_t *server, ipc_cli_id_t
 {
     DriverCollector* collector = (DriverCollector*)arg;
     if (std::string(url->url, url->url_len) == collector->publish_url_) {
-        vsoa::List<vsoa::Object<DataValueDto> > dto;
-        g_logger.LogMessage(LW_LOGLEVEL_DEBUG, "OnDatagramCb: server %s, url is %s, msg is %.*s",
-            collector->server_name_.c_str(), collector->publish_url_.c_str(), payload->data_len, (char*)payload->data);
-        // Recv publish data here.
-        try {
-            dto = collector->obj_mapper_->readFromString<vsoa::List<vsoa::Object<DataValueDto> > >(
-                vsoa::String((char*)payload->data, payload->data_len)
-            );
-        } catch (vsoa::parser::ParsingError &e) {
-            g_logger.LogMessage(LW_LOGLEVEL_WARN, "OnDatagramCb: parse %.*s to DataValueDto failed: %s",
-                payload->data_len, payload->data, e.what());
-            return;
-        }
         // Prepare DDS tag data list
         edge_framework::dto::TagDataList tag_data_list;
-        
-        auto it_dto = dto->begin();
-        for (; it_dto != dto->end(); it_dto++) {
-            // parse time as milliseconds if provided
-            uint64_t ts = 0;
-            if ((*it_dto)->time) ts = (*it_dto)->time.getValue(0);
-            
-            // Store to RTDB
-            DATA_CENTER->GetRTDB()->setTag((*it_dto)->name->c_str(), (*it_dto)->value->c_str(), ts, "", "");
-            
-            // Add to DDS publish list
-            auto tag_data = edge_framework::dto::TagDataDto::createShared(
-                (*it_dto)->name->c_str(),
-                (*it_dto)->value->c_str(),
-                ts
-            );
-            tag_data_list.push_back(tag_data);
-        }
-        
+
+        // 批量数据报逐条解析, 合并为一次 DDS 发布
+        do {
+            vsoa::List<vsoa::Object<DataValueDto> > dto;
+            g_logger.LogMessage(LW_LOGLEVEL_DEBUG, "OnDatagramCb: server %s, url is %s, msg is %.*s",
+                collector->server_name_.c_str(), collector->publish_url_.c_str(), payload->data_len, (char*)payload->data);
+            // Recv publish data here.
+            try {
+                dto = collector->obj_mapper_->readFromString<vsoa::List<vsoa::Object<DataValueDto> > >(
+                    vsoa::String((char*)payload->data, payload->data_len)
+                );
+            } catch (vsoa::parser::ParsingError &e) {
+                g_logger.LogMessage(LW_LOGLEVEL_WARN, "OnDatagramCb: parse %.*s to DataValueDto failed: %s",
+                    payload->data_len, payload->data, e.what());
+                continue;
+            }
+
+            auto it_dto = dto->begin();
+            for (; it_dto != dto->end(); it_dto++) {
+                // parse time as milliseconds if provided
+                uint64_t ts = 0;
+                if ((*it_dto)->time) ts = (*it_dto)->time.getValue(0);
+
+                // Store to RTDB
+                DATA_CENTER->GetRTDB()->setTag((*it_dto)->name->c_str(), (*it_dto)->value->c_str(), ts, "", "");
+
+                // Add to DDS publish list
+                auto tag_data = edge_framework::dto::TagDataDto::createShared(
+                    (*it_dto)->name->c_str(),
+                    (*it_dto)->value->c_str(),
+                    ts
+                );
+                tag_data_list.push_back(tag_data);
+            }
+        } while (ipc_server_dat_next(server, payload));
+
         // Publish via DDS
         if (!tag_data_list.empty() && DDS_MANAGER->IsRunning()) {
             bool publish_success = DDS_MANAGER->PublishTagData(tag_data_list, "/tags/update");
@@ -233,15 +241,44 @@ int DriverCollector::OnStop()
 void DriverCollector::SrvThreadMain(void* arg)
 {
     DriverCollector* collector = (DriverCollector*)arg;
-    int cnt, max_fd;
-    fd_set fds;
+    int cnt, max_fd, max_wfd;
+    fd_set fds, wfds;
     struct timespec timeout = { 1, 0 };
+#ifdef __linux__
+    // epoll 反应器: 只处理就绪 fd 的回调, 客户端增减和发送积压的可写事件由 lwipcssn 维护
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd >= 0 && ipc_server_epoll_add(collector->server_, epfd)) {
+        struct epoll_event events[64];
+        while (!collector->bstop_) {
+            cnt = epoll_wait(epfd, events, 64, 1000);
+            for (int i = 0; i < cnt; i++) {
+                ipc_event_dispatch(events[i].data.ptr, events[i].events);
+            }
+        }
+        ipc_server_epoll_del(collector->server_);
+        close(epfd);
+        return;
+    }
+    if (epfd >= 0) {
+        close(epfd);
+    }
+    g_logger.LogMessage(LW_LOGLEVEL_WARN, "DriverCollector epoll setup failed, fall back to select");
+#endif
     while (!collector->bstop_) {
         FD_ZERO(&fds);
+        FD_ZERO(&wfds);
         max_fd = ipc_server_fds(collector->server_, &fds);
+        // 仅当有客户端发送队列积压时才等待可写事件
+        max_wfd = ipc_server_wfds(collector->server_, &wfds);
+        if (max_wfd > max_fd) {
+            max_fd = max_wfd;
+        }
 
-        cnt = pselect(max_fd + 1, &fds, NULL, NULL, &timeout, NULL);
+        cnt = pselect(max_fd + 1, &fds, max_wfd >= 0 ? &wfds : NULL, NULL, &timeout, NULL);
         if (cnt > 0) {
+            if (max_wfd >= 0) {
+                ipc_server_output_fds(collector->server_, &wfds);
+            }
             ipc_server_input_fds(collector->server_, &fds);
         }
     }